@@ -13,6 +13,7 @@ set(CPP_FILES
   mitkMaskImageFilter.cpp
   mitkMovieGenerator.cpp
   mitkNonBlockingAlgorithm.cpp
+  mitkNonBlockingAlgorithmScheduler.cpp
   mitkPadImageFilter.cpp
   mitkPlaneFit.cpp
   mitkPlaneLandmarkProjector.cpp
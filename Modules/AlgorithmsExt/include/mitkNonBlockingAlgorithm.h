@@ -28,6 +28,7 @@ found in the LICENSE file.
 #include "mitkImage.h"
 #include "mitkSurface.h"
 
+#include <atomic>
 #include <mutex>
 #include <stdexcept>
 #include <string>
@@ -201,7 +202,15 @@ namespace mitk
     void StartAlgorithm();         // for those who want to trigger calculations on their own
                                    // --> need for an OPTION: manual/automatic starting
     void StartBlockingAlgorithm(); // for those who want to trigger calculations on their own
-    void StopAlgorithm();
+    void StopAlgorithm();          // waits until a requested calculation has ended
+
+    /// Removes a requested calculation from the NonBlockingAlgorithmScheduler and asks a running one to stop.
+    /// A cancelled calculation reports neither success nor failure.
+    void CancelAlgorithm();
+
+    /// Runs with a higher priority are started first by the NonBlockingAlgorithmScheduler. Default is 0.
+    itkSetMacro(Priority, int);
+    itkGetConstMacro(Priority, int);
 
     void TriggerParameterModified(const itk::EventObject &);
 
@@ -219,15 +228,19 @@ namespace mitk
     virtual bool ReadyToRun();
 
     virtual bool ThreadedUpdateFunction();   // will be called from a thread after calling StartAlgorithm
+                                             // should return early if IsCancelRequested()
     virtual void ThreadedUpdateSuccessful(); // will be called after the ThreadedUpdateFunction() returned
     virtual void ThreadedUpdateFailed();     // will when ThreadedUpdateFunction() returns false
 
+    /// True if the running calculation was cancelled or superseded by a newer request.
+    bool IsCancelRequested() const;
+
     PropertyList::Pointer m_Parameters;
 
     WeakPointer<DataStorage> m_DataStorage;
 
   private:
-    static itk::ITK_THREAD_RETURN_TYPE StaticNonBlockingAlgorithmThread(ThreadParameters *param);
+    friend class NonBlockingAlgorithmScheduler;
 
     typedef std::map<std::string, unsigned long> MapTypeStringUInt;
 
@@ -235,10 +248,8 @@ namespace mitk
 
     std::mutex m_ParameterListMutex;
 
-    int m_UpdateRequests;
-    ThreadParameters m_ThreadParameters;
-    std::thread m_Thread;
-
+    int m_Priority;
+    std::atomic<bool> m_CancelRequested;
     bool m_KillRequest;
   };
 
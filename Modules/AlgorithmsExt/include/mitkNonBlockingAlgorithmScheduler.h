@@ -0,0 +1,183 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITK_NON_BLOCKING_ALGORITHM_SCHEDULER_H_INCLUDED
+#define MITK_NON_BLOCKING_ALGORITHM_SCHEDULER_H_INCLUDED
+
+#include "MitkAlgorithmsExtExports.h"
+
+#include <itkSmartPointer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mitk
+{
+  class NonBlockingAlgorithm;
+
+  /*!
+    \brief Process-wide scheduler that runs the ThreadedUpdateFunction() of all NonBlockingAlgorithm instances.
+
+    Instead of spawning a thread per algorithm, all runs are executed by a small, shared pool of worker
+    threads (the algorithms themselves are usually multi-threaded by ITK/VTK, so few workers are enough
+    to keep the CPU busy without oversubscribing it).
+
+    - Runs are ordered by the priority of the algorithm (higher first) and then by request time.
+    - Requests are coalesced: an algorithm is never queued twice. A new request for an algorithm that is
+      running supersedes that run, i.e. the run is asked to cancel and the algorithm is executed once more
+      afterwards. Superseded or cancelled runs do not report a result.
+    - Cancellation is cooperative: ThreadedUpdateFunction() implementations should poll
+      NonBlockingAlgorithm::IsCancelRequested() and return early.
+    - Every finished run is recorded with its waiting and running time. Recent runs and statistics
+      aggregated per algorithm class can be queried, e.g. by plugins that want to display them.
+
+    \sa NonBlockingAlgorithm
+  */
+  class MITKALGORITHMSEXT_EXPORT NonBlockingAlgorithmScheduler
+  {
+  public:
+    enum class TaskResult
+    {
+      Succeeded,
+      Failed,
+      Cancelled
+    };
+
+    /// Timing of a single finished run. Times are given in milliseconds.
+    struct TaskRecord
+    {
+      std::string AlgorithmName;
+      int Priority;
+      double WaitTime;
+      double RunTime;
+      TaskResult Result;
+    };
+
+    /// Statistics of all runs of one algorithm class. Times are given in milliseconds.
+    struct AlgorithmStatistics
+    {
+      unsigned long NumberOfRuns = 0;
+      unsigned long NumberOfFailedRuns = 0;
+      unsigned long NumberOfCancelledRuns = 0;
+      /// requests that were merged into an already queued or running request
+      unsigned long NumberOfCoalescedRequests = 0;
+      double TotalWaitTime = 0.0;
+      double TotalRunTime = 0.0;
+      double MaximumRunTime = 0.0;
+    };
+
+    using StatisticsMapType = std::map<std::string, AlgorithmStatistics>;
+
+    /// This class is a singleton.
+    static NonBlockingAlgorithmScheduler *GetInstance();
+
+    /// Queues a run of the algorithm (or coalesces it with a queued/running one).
+    void Submit(NonBlockingAlgorithm *algorithm);
+
+    /// Runs the algorithm in the calling thread. A queued run is served by this call,
+    /// a running one is waited for.
+    void Execute(NonBlockingAlgorithm *algorithm);
+
+    /// Removes a queued run and asks a running run of the algorithm to stop.
+    void Cancel(NonBlockingAlgorithm *algorithm);
+
+    /// Blocks until the algorithm is neither queued nor running. A queued run is served by this call
+    /// instead of waiting for a free worker, so algorithms may wait for others from a worker thread.
+    void Wait(NonBlockingAlgorithm *algorithm);
+
+    /// Indicates if the algorithm is queued or running.
+    bool IsScheduled(const NonBlockingAlgorithm *algorithm) const;
+
+    /// Default is 2, at least one worker is used. Workers are started on demand. If the number is
+    /// reduced, surplus workers finish their current run and stop.
+    void SetNumberOfWorkers(unsigned int numberOfWorkers);
+    unsigned int GetNumberOfWorkers() const;
+
+    /// Number of worker threads that are started, idle or busy.
+    unsigned int GetNumberOfStartedWorkers() const;
+
+    /// The most recent finished runs, oldest first.
+    std::vector<TaskRecord> GetRecentTasks() const;
+    StatisticsMapType GetStatistics() const;
+    void ResetStatistics();
+
+    ~NonBlockingAlgorithmScheduler();
+
+  protected:
+    /// Purposely hidden - singleton
+    NonBlockingAlgorithmScheduler();
+
+  private:
+    using ClockType = std::chrono::steady_clock;
+
+    struct AlgorithmState
+    {
+      itk::SmartPointer<NonBlockingAlgorithm> Algorithm;
+      bool IsQueued = false;
+      bool IsRunning = false;
+      bool RerunRequested = false;
+      int Priority = 0;
+      std::uint64_t Ticket = 0;
+      ClockType::time_point QueueTime;
+    };
+
+    struct QueueEntry
+    {
+      int Priority;
+      std::uint64_t Ticket;
+      NonBlockingAlgorithm *Algorithm;
+
+      bool operator<(const QueueEntry &other) const;
+    };
+
+    NonBlockingAlgorithmScheduler(const NonBlockingAlgorithmScheduler &) = delete;
+    NonBlockingAlgorithmScheduler &operator=(const NonBlockingAlgorithmScheduler &) = delete;
+
+    void Enqueue(AlgorithmState &state);
+    void StartWorkers();
+    void WorkerLoop();
+    bool HasSurplusWorkers() const;
+    void JoinRetiredWorkers();
+
+    /// Runs the algorithm, state must be marked running. Expects the lock to be held and returns with it held.
+    void Run(AlgorithmState &state, std::unique_lock<std::mutex> &lock);
+
+    void RecordCoalescedRequest(const NonBlockingAlgorithm *algorithm);
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_WorkAvailable;
+    std::condition_variable m_StateChanged;
+
+    std::map<const NonBlockingAlgorithm *, AlgorithmState> m_States;
+    std::vector<QueueEntry> m_Queue;
+    std::uint64_t m_NextTicket;
+
+    std::vector<std::thread> m_Workers;
+    /// workers that left WorkerLoop() because the number of workers was reduced
+    std::vector<std::thread::id> m_RetiredWorkers;
+    unsigned int m_NumberOfWorkers;
+    bool m_Stop;
+
+    std::deque<TaskRecord> m_RecentTasks;
+    StatisticsMapType m_Statistics;
+  };
+
+} // namespace
+
+#endif
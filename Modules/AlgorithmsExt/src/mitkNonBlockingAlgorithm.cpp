@@ -11,21 +11,21 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkNonBlockingAlgorithm.h"
-#include "mitkCallbackFromGUIThread.h"
 #include "mitkDataStorage.h"
+#include "mitkNonBlockingAlgorithmScheduler.h"
 #include <itkCommand.h>
 
 namespace mitk
 {
-  NonBlockingAlgorithm::NonBlockingAlgorithm() : m_UpdateRequests(0), m_KillRequest(false)
+  NonBlockingAlgorithm::NonBlockingAlgorithm() : m_Priority(0), m_CancelRequested(false), m_KillRequest(false)
   {
     m_Parameters = PropertyList::New();
   }
 
   NonBlockingAlgorithm::~NonBlockingAlgorithm()
   {
-    if (m_Thread.joinable())
-      m_Thread.join();
+    // the scheduler keeps a reference as long as a calculation is requested,
+    // so there is nothing to wait for here
   }
 
   void mitk::NonBlockingAlgorithm::SetDataStorage(DataStorage &storage) { m_DataStorage = &storage; }
@@ -82,8 +82,12 @@ namespace mitk
   void NonBlockingAlgorithm::Reset() { Initialize(); }
   void NonBlockingAlgorithm::StartBlockingAlgorithm()
   {
-    StartAlgorithm();
-    StopAlgorithm();
+    if (!ReadyToRun())
+      return;
+    if (m_KillRequest)
+      return;
+
+    NonBlockingAlgorithmScheduler::GetInstance()->Execute(this);
   }
 
   void NonBlockingAlgorithm::StartAlgorithm()
@@ -93,66 +97,18 @@ namespace mitk
     if (m_KillRequest)
       return; // someone wants us to die
 
-    m_ParameterListMutex.lock();
-    m_ThreadParameters.m_Algorithm = this;
-    ++m_UpdateRequests;
-    m_ParameterListMutex.unlock();
-    if (m_Thread.joinable()) // thread already running. But something obviously wants us to recalculate the output
-    {
-      return; // thread already running
-    }
-
-    // spawn a thread that calls ThreadedUpdateFunction(), and ThreadedUpdateFinished() on us
-    m_Thread = std::thread(StaticNonBlockingAlgorithmThread, &m_ThreadParameters);
+    // the scheduler calls ThreadedUpdateFunction() from one of its threads, and ThreadedUpdateSuccessful() or
+    // ThreadedUpdateFailed() on us
+    NonBlockingAlgorithmScheduler::GetInstance()->Submit(this);
   }
 
   void NonBlockingAlgorithm::StopAlgorithm()
   {
-    if (m_Thread.joinable())
-      m_Thread.join(); // waits for the thread to terminate on its own
-  }
-
-  // a static function to call a member of NonBlockingAlgorithm from inside an ITK thread
-  itk::ITK_THREAD_RETURN_TYPE NonBlockingAlgorithm::StaticNonBlockingAlgorithmThread(ThreadParameters *param)
-  {
-    NonBlockingAlgorithm::Pointer algorithm = param->m_Algorithm;
-    // this UserData tells us, which BubbleTool's method to call
-    if (!algorithm)
-    {
-      return itk::ITK_THREAD_RETURN_DEFAULT_VALUE;
-    }
-
-    algorithm->m_ParameterListMutex.lock();
-    while (algorithm->m_UpdateRequests > 0)
-    {
-      algorithm->m_UpdateRequests = 0;
-      algorithm->m_ParameterListMutex.unlock();
-
-      // actually call the methods that do the work
-      if (algorithm->ThreadedUpdateFunction()) // returns a bool for success/failure
-      {
-        itk::ReceptorMemberCommand<NonBlockingAlgorithm>::Pointer command =
-          itk::ReceptorMemberCommand<NonBlockingAlgorithm>::New();
-        command->SetCallbackFunction(algorithm, &NonBlockingAlgorithm::ThreadedUpdateSuccessful);
-        CallbackFromGUIThread::GetInstance()->CallThisFromGUIThread(command);
-        // algorithm->ThreadedUpdateSuccessful();
-      }
-      else
-      {
-        itk::ReceptorMemberCommand<NonBlockingAlgorithm>::Pointer command =
-          itk::ReceptorMemberCommand<NonBlockingAlgorithm>::New();
-        command->SetCallbackFunction(algorithm, &NonBlockingAlgorithm::ThreadedUpdateFailed);
-        CallbackFromGUIThread::GetInstance()->CallThisFromGUIThread(command);
-        // algorithm->ThreadedUpdateFailed();
-      }
-
-      algorithm->m_ParameterListMutex.lock();
-    }
-    algorithm->m_ParameterListMutex.unlock();
-
-    return ITK_THREAD_RETURN_DEFAULT_VALUE;
+    NonBlockingAlgorithmScheduler::GetInstance()->Wait(this); // waits for the calculation to terminate on its own
   }
 
+  void NonBlockingAlgorithm::CancelAlgorithm() { NonBlockingAlgorithmScheduler::GetInstance()->Cancel(this); }
+  bool NonBlockingAlgorithm::IsCancelRequested() const { return m_CancelRequested; }
   void NonBlockingAlgorithm::TriggerParameterModified(const itk::EventObject &) { StartAlgorithm(); }
   bool NonBlockingAlgorithm::ReadyToRun()
   {
@@ -164,7 +120,6 @@ namespace mitk
   void NonBlockingAlgorithm::ThreadedUpdateSuccessful(const itk::EventObject &)
   {
     ThreadedUpdateSuccessful();
-    m_ThreadParameters.m_Algorithm = nullptr;
   }
 
   void NonBlockingAlgorithm::ThreadedUpdateSuccessful()
@@ -177,7 +132,6 @@ namespace mitk
   void NonBlockingAlgorithm::ThreadedUpdateFailed(const itk::EventObject &)
   {
     ThreadedUpdateFailed();
-    m_ThreadParameters.m_Algorithm = nullptr; // delete
   }
 
   void NonBlockingAlgorithm::ThreadedUpdateFailed()
@@ -0,0 +1,440 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkNonBlockingAlgorithmScheduler.h"
+#include "mitkCallbackFromGUIThread.h"
+#include "mitkNonBlockingAlgorithm.h"
+#include <mitkLogMacros.h>
+
+#include <itkCommand.h>
+
+#include <algorithm>
+
+namespace
+{
+  const std::size_t MaximumNumberOfRecentTasks = 100;
+
+  /// Calls the result notification of an algorithm from the GUI thread. Holds a reference to the
+  /// algorithm, so that algorithms that were started and then released by their creator stay alive until then.
+  class AlgorithmResultCommand : public itk::Command
+  {
+  public:
+    typedef AlgorithmResultCommand Self;
+    typedef itk::Command Superclass;
+    typedef itk::SmartPointer<Self> Pointer;
+    itkNewMacro(Self);
+
+    void SetResult(mitk::NonBlockingAlgorithm *algorithm, bool success)
+    {
+      m_Algorithm = algorithm;
+      m_Success = success;
+    }
+
+    void Execute(itk::Object *, const itk::EventObject &event) override
+    {
+      this->Execute(static_cast<const itk::Object *>(nullptr), event);
+    }
+
+    void Execute(const itk::Object *, const itk::EventObject &event) override
+    {
+      if (m_Algorithm.IsNull())
+        return;
+
+      if (m_Success)
+        m_Algorithm->ThreadedUpdateSuccessful(event);
+      else
+        m_Algorithm->ThreadedUpdateFailed(event);
+
+      m_Algorithm = nullptr;
+    }
+
+  protected:
+    AlgorithmResultCommand() : m_Success(false) {}
+
+  private:
+    mitk::NonBlockingAlgorithm::Pointer m_Algorithm;
+    bool m_Success;
+  };
+
+  double ToMilliseconds(std::chrono::steady_clock::duration duration)
+  {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+}
+
+namespace mitk
+{
+  bool NonBlockingAlgorithmScheduler::QueueEntry::operator<(const QueueEntry &other) const
+  {
+    // std::push_heap/pop_heap keep the greatest element first: higher priority, then earlier request
+    if (Priority != other.Priority)
+      return Priority < other.Priority;
+
+    return Ticket > other.Ticket;
+  }
+
+  NonBlockingAlgorithmScheduler *NonBlockingAlgorithmScheduler::GetInstance()
+  {
+    static NonBlockingAlgorithmScheduler instance;
+    return &instance;
+  }
+
+  NonBlockingAlgorithmScheduler::NonBlockingAlgorithmScheduler() : m_NextTicket(0), m_NumberOfWorkers(2), m_Stop(false)
+  {
+  }
+
+  NonBlockingAlgorithmScheduler::~NonBlockingAlgorithmScheduler()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Stop = true;
+      m_Queue.clear();
+    }
+    m_WorkAvailable.notify_all();
+
+    for (auto &worker : m_Workers)
+    {
+      if (worker.joinable())
+        worker.join();
+    }
+  }
+
+  void NonBlockingAlgorithmScheduler::Submit(NonBlockingAlgorithm *algorithm)
+  {
+    if (nullptr == algorithm)
+      return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Stop)
+      return;
+
+    auto &state = m_States[algorithm];
+    state.Algorithm = algorithm;
+
+    if (state.IsQueued)
+    { // the queued run will use the current parameters anyway
+      this->RecordCoalescedRequest(algorithm);
+      if (state.Priority != algorithm->GetPriority())
+      { // requeue with the new priority, the old entry becomes stale
+        state.Priority = algorithm->GetPriority();
+        m_Queue.push_back({state.Priority, state.Ticket, algorithm});
+        std::push_heap(m_Queue.begin(), m_Queue.end());
+        m_WorkAvailable.notify_one();
+      }
+      return;
+    }
+
+    if (state.IsRunning)
+    { // the running calculation is outdated, run again as soon as it has stopped
+      this->RecordCoalescedRequest(algorithm);
+      state.RerunRequested = true;
+      algorithm->m_CancelRequested = true;
+      return;
+    }
+
+    this->Enqueue(state);
+  }
+
+  void NonBlockingAlgorithmScheduler::Execute(NonBlockingAlgorithm *algorithm)
+  {
+    if (nullptr == algorithm)
+      return;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    auto iter = m_States.find(algorithm);
+    if (iter != m_States.end() && iter->second.IsRunning)
+    {
+      this->RecordCoalescedRequest(algorithm);
+      iter->second.RerunRequested = false;
+      algorithm->m_CancelRequested = true;
+    }
+
+    m_StateChanged.wait(lock, [this, algorithm]() {
+      auto stateIter = m_States.find(algorithm);
+      return stateIter == m_States.end() || !stateIter->second.IsRunning;
+    });
+
+    auto &state = m_States[algorithm];
+    state.Algorithm = algorithm;
+    if (state.IsQueued)
+    { // served by this run
+      this->RecordCoalescedRequest(algorithm);
+      state.IsQueued = false;
+    }
+    state.Priority = algorithm->GetPriority();
+    state.QueueTime = ClockType::now();
+    state.IsRunning = true;
+
+    this->Run(state, lock);
+  }
+
+  void NonBlockingAlgorithmScheduler::Cancel(NonBlockingAlgorithm *algorithm)
+  {
+    NonBlockingAlgorithm::Pointer releasedAlgorithm;
+
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+
+      auto iter = m_States.find(algorithm);
+      if (iter == m_States.end())
+        return;
+
+      auto &state = iter->second;
+      state.IsQueued = false;
+
+      if (state.IsRunning)
+      {
+        state.RerunRequested = false;
+        algorithm->m_CancelRequested = true;
+        return;
+      }
+
+      // release outside of the lock, it might be the last reference
+      releasedAlgorithm = state.Algorithm;
+      m_States.erase(iter);
+    }
+
+    m_StateChanged.notify_all();
+  }
+
+  void NonBlockingAlgorithmScheduler::Wait(NonBlockingAlgorithm *algorithm)
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+      auto iter = m_States.find(algorithm);
+      if (iter == m_States.end())
+        return;
+
+      auto &state = iter->second;
+      if (state.IsQueued)
+      { // serve the run instead of waiting for a worker, all workers might be waiting themselves
+        state.IsQueued = false;
+        state.IsRunning = true;
+        this->Run(state, lock);
+      }
+      else
+      {
+        m_StateChanged.wait(lock);
+      }
+    }
+  }
+
+  bool NonBlockingAlgorithmScheduler::IsScheduled(const NonBlockingAlgorithm *algorithm) const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_States.find(algorithm) != m_States.end();
+  }
+
+  void NonBlockingAlgorithmScheduler::SetNumberOfWorkers(unsigned int numberOfWorkers)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_NumberOfWorkers = std::max(1u, numberOfWorkers);
+      if (!m_Queue.empty())
+        this->StartWorkers();
+    }
+
+    // idle surplus workers stop, busy ones after their current run
+    m_WorkAvailable.notify_all();
+  }
+
+  unsigned int NonBlockingAlgorithmScheduler::GetNumberOfWorkers() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_NumberOfWorkers;
+  }
+
+  unsigned int NonBlockingAlgorithmScheduler::GetNumberOfStartedWorkers() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return static_cast<unsigned int>(m_Workers.size() - m_RetiredWorkers.size());
+  }
+
+  std::vector<NonBlockingAlgorithmScheduler::TaskRecord> NonBlockingAlgorithmScheduler::GetRecentTasks() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return std::vector<TaskRecord>(m_RecentTasks.begin(), m_RecentTasks.end());
+  }
+
+  NonBlockingAlgorithmScheduler::StatisticsMapType NonBlockingAlgorithmScheduler::GetStatistics() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Statistics;
+  }
+
+  void NonBlockingAlgorithmScheduler::ResetStatistics()
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_RecentTasks.clear();
+    m_Statistics.clear();
+  }
+
+  void NonBlockingAlgorithmScheduler::Enqueue(AlgorithmState &state)
+  {
+    state.IsQueued = true;
+    state.Ticket = m_NextTicket++;
+    state.Priority = state.Algorithm->GetPriority();
+    state.QueueTime = ClockType::now();
+
+    m_Queue.push_back({state.Priority, state.Ticket, state.Algorithm.GetPointer()});
+    std::push_heap(m_Queue.begin(), m_Queue.end());
+
+    this->StartWorkers();
+    m_WorkAvailable.notify_one();
+  }
+
+  void NonBlockingAlgorithmScheduler::StartWorkers()
+  {
+    this->JoinRetiredWorkers();
+
+    while (m_Workers.size() < m_NumberOfWorkers)
+    {
+      m_Workers.emplace_back(&NonBlockingAlgorithmScheduler::WorkerLoop, this);
+    }
+  }
+
+  void NonBlockingAlgorithmScheduler::WorkerLoop()
+  {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    while (true)
+    {
+      m_WorkAvailable.wait(lock, [this]() { return m_Stop || !m_Queue.empty() || this->HasSurplusWorkers(); });
+      if (m_Stop)
+        return;
+
+      if (this->HasSurplusWorkers())
+      {
+        m_RetiredWorkers.push_back(std::this_thread::get_id());
+        if (!m_Queue.empty())
+          m_WorkAvailable.notify_one(); // the notification might have been meant for another worker
+        return;
+      }
+
+      std::pop_heap(m_Queue.begin(), m_Queue.end());
+      const auto entry = m_Queue.back();
+      m_Queue.pop_back();
+
+      auto iter = m_States.find(entry.Algorithm);
+      if (iter == m_States.end() || !iter->second.IsQueued || iter->second.Ticket != entry.Ticket ||
+          iter->second.Priority != entry.Priority)
+        continue; // stale entry of a coalesced or cancelled request
+
+      iter->second.IsQueued = false;
+      iter->second.IsRunning = true;
+      this->Run(iter->second, lock);
+    }
+  }
+
+  bool NonBlockingAlgorithmScheduler::HasSurplusWorkers() const
+  {
+    return m_Workers.size() - m_RetiredWorkers.size() > m_NumberOfWorkers;
+  }
+
+  void NonBlockingAlgorithmScheduler::JoinRetiredWorkers()
+  {
+    // retired workers hold no lock anymore once they are found here, joining them does not block for long
+    for (const auto &id : m_RetiredWorkers)
+    {
+      auto worker = std::find_if(m_Workers.begin(), m_Workers.end(), [&id](const std::thread &t) { return t.get_id() == id; });
+      if (worker != m_Workers.end())
+      {
+        worker->join();
+        m_Workers.erase(worker);
+      }
+    }
+    m_RetiredWorkers.clear();
+  }
+
+  void NonBlockingAlgorithmScheduler::Run(AlgorithmState &state, std::unique_lock<std::mutex> &lock)
+  {
+    NonBlockingAlgorithm::Pointer algorithm = state.Algorithm;
+    TaskRecord record;
+    record.AlgorithmName = algorithm->GetNameOfClass();
+    record.Priority = state.Priority;
+    const auto queueTime = state.QueueTime;
+
+    algorithm->m_CancelRequested = false;
+    lock.unlock();
+
+    const auto startTime = ClockType::now();
+    bool success = false;
+    try
+    {
+      success = algorithm->ThreadedUpdateFunction();
+    }
+    catch (const std::exception &e)
+    {
+      MITK_ERROR << "Calculation of " << record.AlgorithmName << " failed: " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Calculation of " << record.AlgorithmName << " failed.";
+    }
+    const auto endTime = ClockType::now();
+
+    const bool cancelled = algorithm->m_CancelRequested;
+    if (!cancelled)
+    {
+      auto command = AlgorithmResultCommand::New();
+      command->SetResult(algorithm, success);
+      CallbackFromGUIThread::GetInstance()->CallThisFromGUIThread(command);
+    }
+
+    record.WaitTime = ToMilliseconds(startTime - queueTime);
+    record.RunTime = ToMilliseconds(endTime - startTime);
+    record.Result = cancelled ? TaskResult::Cancelled : (success ? TaskResult::Succeeded : TaskResult::Failed);
+
+    lock.lock();
+
+    auto &statistics = m_Statistics[record.AlgorithmName];
+    ++statistics.NumberOfRuns;
+    if (TaskResult::Failed == record.Result)
+      ++statistics.NumberOfFailedRuns;
+    if (TaskResult::Cancelled == record.Result)
+      ++statistics.NumberOfCancelledRuns;
+    statistics.TotalWaitTime += record.WaitTime;
+    statistics.TotalRunTime += record.RunTime;
+    statistics.MaximumRunTime = std::max(statistics.MaximumRunTime, record.RunTime);
+
+    m_RecentTasks.push_back(record);
+    if (m_RecentTasks.size() > MaximumNumberOfRecentTasks)
+      m_RecentTasks.pop_front();
+
+    // states of running algorithms are never removed by others
+    state.IsRunning = false;
+    if (state.RerunRequested && !m_Stop)
+    {
+      state.RerunRequested = false;
+      this->Enqueue(state);
+    }
+    else if (!state.IsQueued)
+    {
+      m_States.erase(algorithm.GetPointer());
+    }
+    m_StateChanged.notify_all();
+
+    // release outside of the lock, it might be the last reference
+    lock.unlock();
+    algorithm = nullptr;
+    lock.lock();
+  }
+
+  void NonBlockingAlgorithmScheduler::RecordCoalescedRequest(const NonBlockingAlgorithm *algorithm)
+  {
+    ++m_Statistics[algorithm->GetNameOfClass()].NumberOfCoalescedRequests;
+  }
+
+} // namespace
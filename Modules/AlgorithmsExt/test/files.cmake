@@ -9,6 +9,7 @@ set(MODULE_TESTS
   mitkUnstructuredGridClusteringFilterTest.cpp
   mitkUnstructuredGridToUnstructuredGridFilterTest.cpp
   mitkCropTimestepsImageFilterTest.cpp
+  mitkNonBlockingAlgorithmSchedulerTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
@@ -0,0 +1,303 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+// MITK includes
+#include <mitkCallbackFromGUIThread.h>
+#include <mitkNonBlockingAlgorithm.h>
+#include <mitkNonBlockingAlgorithmScheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  /// Executes the callbacks directly in the thread that requests them.
+  class ImmediateCallbackFromGUIThread : public mitk::CallbackFromGUIThreadImplementation
+  {
+  public:
+    void CallThisFromGUIThread(itk::Command *command, itk::EventObject *event) override
+    {
+      if (nullptr != event)
+      {
+        command->Execute(static_cast<const itk::Object *>(nullptr), *event);
+        delete event;
+      }
+      else
+      {
+        const itk::NoEvent dummyEvent;
+        command->Execute(static_cast<const itk::Object *>(nullptr), dummyEvent);
+      }
+    }
+  };
+
+  class TestAlgorithm : public mitk::NonBlockingAlgorithm
+  {
+  public:
+    mitkClassMacro(TestAlgorithm, mitk::NonBlockingAlgorithm);
+    mitkAlgorithmNewMacro(TestAlgorithm);
+
+    std::atomic<int> Runs;
+    std::atomic<int> Successes;
+    std::atomic<bool> Started;
+    std::atomic<bool> Block;
+    std::atomic<bool> StopOnCancel;
+    std::vector<std::string> *StartOrder = nullptr;
+    std::mutex *StartOrderMutex = nullptr;
+    std::string Name;
+    /// started and waited for from ThreadedUpdateFunction()
+    Pointer Dependency;
+    std::thread::id ThreadId;
+
+  protected:
+    TestAlgorithm() : Runs(0), Successes(0), Started(false), Block(false), StopOnCancel(true) {}
+
+    bool ThreadedUpdateFunction() override
+    {
+      if (nullptr != StartOrder)
+      {
+        std::lock_guard<std::mutex> lock(*StartOrderMutex);
+        StartOrder->push_back(Name);
+      }
+
+      ThreadId = std::this_thread::get_id();
+      if (Dependency.IsNotNull())
+      {
+        Dependency->StartAlgorithm();
+        Dependency->StopAlgorithm();
+      }
+
+      ++Runs;
+      Started = true;
+      while (Block && !(StopOnCancel && this->IsCancelRequested()))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+      return true;
+    }
+
+    void ThreadedUpdateSuccessful() override { ++Successes; }
+  };
+
+  void WaitUntilStarted(const TestAlgorithm *algorithm)
+  {
+    while (!algorithm->Started)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+class mitkNonBlockingAlgorithmSchedulerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNonBlockingAlgorithmSchedulerTestSuite);
+  MITK_TEST(StartBlockingAlgorithm_RunsAndRecordsTiming);
+  MITK_TEST(StartAlgorithm_CoalescesSupersededRequests);
+  MITK_TEST(CancelAlgorithm_StopsRunningCalculation);
+  MITK_TEST(Priority_HigherPriorityStartsFirst);
+  MITK_TEST(StopAlgorithm_FromWorkerOnQueuedAlgorithm_RunsItInline);
+  MITK_TEST(SetNumberOfWorkers_Reduced_StopsSurplusWorkers);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  ImmediateCallbackFromGUIThread m_Callback;
+  mitk::NonBlockingAlgorithmScheduler *m_Scheduler;
+
+public:
+  void setUp() override
+  {
+    mitk::CallbackFromGUIThread::RegisterImplementation(&m_Callback);
+    m_Scheduler = mitk::NonBlockingAlgorithmScheduler::GetInstance();
+    m_Scheduler->ResetStatistics();
+  }
+
+  void tearDown() override
+  {
+    m_Scheduler->SetNumberOfWorkers(2);
+    mitk::CallbackFromGUIThread::RegisterImplementation(nullptr);
+  }
+
+  /// Idle surplus workers stop asynchronously.
+  void WaitUntilAtMostStartedWorkers(unsigned int numberOfWorkers)
+  {
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (m_Scheduler->GetNumberOfStartedWorkers() > numberOfWorkers && std::chrono::steady_clock::now() < timeout)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CPPUNIT_ASSERT(m_Scheduler->GetNumberOfStartedWorkers() <= numberOfWorkers);
+  }
+
+  void StartBlockingAlgorithm_RunsAndRecordsTiming()
+  {
+    auto algorithm = TestAlgorithm::New();
+    algorithm->StartBlockingAlgorithm();
+
+    CPPUNIT_ASSERT_EQUAL(1, algorithm->Runs.load());
+    CPPUNIT_ASSERT_EQUAL(1, algorithm->Successes.load());
+    CPPUNIT_ASSERT(!m_Scheduler->IsScheduled(algorithm));
+
+    const auto tasks = m_Scheduler->GetRecentTasks();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), tasks.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("TestAlgorithm"), tasks.back().AlgorithmName);
+    CPPUNIT_ASSERT(mitk::NonBlockingAlgorithmScheduler::TaskResult::Succeeded == tasks.back().Result);
+    CPPUNIT_ASSERT(tasks.back().RunTime >= 0.0);
+
+    const auto statistics = m_Scheduler->GetStatistics();
+    CPPUNIT_ASSERT_EQUAL(1ul, statistics.at("TestAlgorithm").NumberOfRuns);
+  }
+
+  void StartAlgorithm_CoalescesSupersededRequests()
+  {
+    auto algorithm = TestAlgorithm::New();
+    algorithm->Block = true;
+    algorithm->StopOnCancel = false;
+
+    algorithm->StartAlgorithm();
+    WaitUntilStarted(algorithm);
+    for (int i = 0; i < 5; ++i)
+      algorithm->StartAlgorithm();
+    CPPUNIT_ASSERT(m_Scheduler->IsScheduled(algorithm));
+
+    algorithm->Block = false;
+    algorithm->StopAlgorithm();
+
+    // the first run was superseded and does not report, all later requests were served by one run
+    CPPUNIT_ASSERT_EQUAL(2, algorithm->Runs.load());
+    CPPUNIT_ASSERT_EQUAL(1, algorithm->Successes.load());
+
+    const auto statistics = m_Scheduler->GetStatistics().at("TestAlgorithm");
+    CPPUNIT_ASSERT_EQUAL(2ul, statistics.NumberOfRuns);
+    CPPUNIT_ASSERT_EQUAL(1ul, statistics.NumberOfCancelledRuns);
+    CPPUNIT_ASSERT_EQUAL(5ul, statistics.NumberOfCoalescedRequests);
+  }
+
+  void CancelAlgorithm_StopsRunningCalculation()
+  {
+    auto algorithm = TestAlgorithm::New();
+    algorithm->Block = true;
+
+    algorithm->StartAlgorithm();
+    WaitUntilStarted(algorithm);
+    algorithm->CancelAlgorithm();
+    algorithm->StopAlgorithm();
+
+    CPPUNIT_ASSERT_EQUAL(1, algorithm->Runs.load());
+    CPPUNIT_ASSERT_EQUAL(0, algorithm->Successes.load());
+    CPPUNIT_ASSERT(!m_Scheduler->IsScheduled(algorithm));
+    CPPUNIT_ASSERT(mitk::NonBlockingAlgorithmScheduler::TaskResult::Cancelled ==
+                   m_Scheduler->GetRecentTasks().back().Result);
+  }
+
+  void Priority_HigherPriorityStartsFirst()
+  {
+    std::vector<std::string> startOrder;
+    std::mutex startOrderMutex;
+
+    // occupy all workers
+    std::vector<TestAlgorithm::Pointer> blockers;
+    for (unsigned int i = 0; i < m_Scheduler->GetNumberOfWorkers(); ++i)
+    {
+      auto blocker = TestAlgorithm::New();
+      blocker->Block = true;
+      blocker->StopOnCancel = false;
+      blocker->StartAlgorithm();
+      WaitUntilStarted(blocker);
+      blockers.push_back(blocker);
+    }
+
+    auto low = TestAlgorithm::New();
+    low->Name = "low";
+    auto high = TestAlgorithm::New();
+    high->Name = "high";
+    high->SetPriority(5);
+    for (auto algorithm : {low, high})
+    {
+      algorithm->StartOrder = &startOrder;
+      algorithm->StartOrderMutex = &startOrderMutex;
+      algorithm->StartAlgorithm();
+    }
+
+    for (auto &blocker : blockers)
+    {
+      blocker->Block = false;
+      blocker->StopAlgorithm();
+    }
+    low->StopAlgorithm();
+    high->StopAlgorithm();
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), startOrder.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("high"), startOrder.front());
+  }
+
+  void StopAlgorithm_FromWorkerOnQueuedAlgorithm_RunsItInline()
+  {
+    m_Scheduler->SetNumberOfWorkers(1);
+    WaitUntilAtMostStartedWorkers(1);
+
+    // the only worker runs the algorithm, which waits for its queued dependency
+    auto dependency = TestAlgorithm::New();
+    auto algorithm = TestAlgorithm::New();
+    algorithm->Dependency = dependency;
+
+    algorithm->StartAlgorithm();
+
+    // not StopAlgorithm(), that would run a still queued algorithm in this thread
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (m_Scheduler->IsScheduled(algorithm) && std::chrono::steady_clock::now() < timeout)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CPPUNIT_ASSERT_MESSAGE("Waiting for a queued algorithm on the only worker does not deadlock.", !m_Scheduler->IsScheduled(algorithm));
+
+    CPPUNIT_ASSERT(algorithm->ThreadId != std::this_thread::get_id());
+    CPPUNIT_ASSERT_EQUAL(1, algorithm->Runs.load());
+    CPPUNIT_ASSERT_EQUAL(1, dependency->Runs.load());
+    CPPUNIT_ASSERT_MESSAGE("The waiting worker runs the dependency.", algorithm->ThreadId == dependency->ThreadId);
+    CPPUNIT_ASSERT(!m_Scheduler->IsScheduled(dependency));
+  }
+
+  void SetNumberOfWorkers_Reduced_StopsSurplusWorkers()
+  {
+    m_Scheduler->SetNumberOfWorkers(3);
+
+    // occupy three workers
+    std::vector<TestAlgorithm::Pointer> blockers;
+    for (int i = 0; i < 3; ++i)
+    {
+      auto blocker = TestAlgorithm::New();
+      blocker->Block = true;
+      blocker->StartAlgorithm();
+      WaitUntilStarted(blocker);
+      blockers.push_back(blocker);
+    }
+    CPPUNIT_ASSERT_EQUAL(3u, m_Scheduler->GetNumberOfStartedWorkers());
+
+    // busy workers stop after their run
+    m_Scheduler->SetNumberOfWorkers(1);
+    CPPUNIT_ASSERT_EQUAL(3u, m_Scheduler->GetNumberOfStartedWorkers());
+    for (auto &blocker : blockers)
+    {
+      blocker->Block = false;
+      blocker->StopAlgorithm();
+    }
+    WaitUntilAtMostStartedWorkers(1);
+    CPPUNIT_ASSERT_EQUAL(1u, m_Scheduler->GetNumberOfStartedWorkers());
+
+    // the remaining worker still serves requests
+    auto algorithm = TestAlgorithm::New();
+    algorithm->StartAlgorithm();
+    algorithm->StopAlgorithm();
+    CPPUNIT_ASSERT_EQUAL(1, algorithm->Runs.load());
+    CPPUNIT_ASSERT_EQUAL(1u, m_Scheduler->GetNumberOfStartedWorkers());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNonBlockingAlgorithmScheduler)
@@ -253,6 +253,29 @@ public:
    in the unit tests.*/
   static std::string GenerateLegacyFeatureNameWOEncoding(const FeatureID& id);
 
+  /** Quantifiers are shared between all feature instances that are initialized with the same image, mask and
+  quantifier settings (see InitializeQuantifier()). Call this to release the cached quantifiers and quantized
+  images (see GetQuantizedImage()), e.g. after the feature extraction of a data set is finished.*/
+  static void ClearQuantifierCache();
+
+  /** Releases only the cached quantifiers and quantized images of the passed image (used as image or mask), so that
+  concurrent extractions of other images keep theirs.*/
+  static void ClearQuantifierCache(const Image* image);
+
+  /** Pixel type of the bin index images returned by GetQuantizedImage().*/
+  typedef int QuantizedPixelType;
+
+  /** Bin index of NaN voxels in the images returned by GetQuantizedImage().*/
+  static const QuantizedPixelType InvalidBinIndex;
+
+  /** Returns an image that contains the bin index floor((intensity - minimum) / binsize) of every voxel,
+  using the minimum and bin size of the passed quantifier. The indices are not limited to [0, bins - 1] and
+  the mask is not applied, so that every feature class can treat voxels outside of the intensity range and the
+  mask as before. The image is computed once and shared between all feature instances that quantize the same
+  image with the same quantifier settings, e.g. all texture feature classes of one extraction run. It is
+  released by ClearQuantifierCache().*/
+  static Image::ConstPointer GetQuantizedImage(const Image* image, const IntensityQuantifier* quantifier);
+
 protected:
   std::vector<double> SplitDouble(std::string str, char delimiter);
 
@@ -267,7 +290,9 @@ protected:
   * This method will be called by SetParameters(...) after ConfigureQuantifierSettingsByParameters() was called.*/
   virtual void ConfigureSettingsByParameters(const ParametersType& parameters);
 
-  /**Initializes the quantifier gigen the quantifier relevant variables and the passed arguments.*/
+  /**Initializes the quantifier gigen the quantifier relevant variables and the passed arguments.
+  * If a quantifier was already initialized for the same image, mask and settings (e.g. by another feature class),
+  * it is reused instead of determining the intensity range again.*/
   void InitializeQuantifier(const Image* image, const Image* mask, unsigned int defaultBins = 256);
 
   /** Helper that encodes the quantifier parameters in a string (e.g. used for the legacy feature name)*/
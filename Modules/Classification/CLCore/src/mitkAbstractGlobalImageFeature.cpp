@@ -13,8 +13,17 @@ found in the LICENSE file.
 #include <mitkAbstractGlobalImageFeature.h>
 
 #include <mitkImageCast.h>
+#include <mitkImageAccessByItk.h>
 #include <mitkITKImageImport.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <algorithm>
+#include <cmath>
+#include <deque>
 #include <iterator>
+#include <limits>
+#include <mutex>
+#include <tuple>
 
 
 bool mitk::FeatureID::operator < (const FeatureID& rh) const
@@ -43,6 +52,188 @@ mitk::FeatureID mitk::CreateFeatureID(FeatureID templateID, std::string name)
   return newID;
 }
 
+namespace
+{
+  /** Identifies a quantifier by its input data and all settings that are evaluated by
+   * AbstractGlobalImageFeature::InitializeQuantifier. The MTimes ensure that modified
+   * or reallocated images are not matched by accident.*/
+  struct QuantifierCacheKey
+  {
+    const mitk::Image* Image;
+    itk::ModifiedTimeType ImageMTime;
+    const mitk::Image* Mask;
+    itk::ModifiedTimeType MaskMTime;
+    bool UseMinimum;
+    double Minimum;
+    bool UseMaximum;
+    double Maximum;
+    bool UseBinsize;
+    double Binsize;
+    bool UseBins;
+    int Bins;
+    bool IgnoreMask;
+    unsigned int DefaultBins;
+
+    bool operator==(const QuantifierCacheKey& rh) const
+    {
+      return std::tie(Image, ImageMTime, Mask, MaskMTime, UseMinimum, Minimum, UseMaximum, Maximum, UseBinsize, Binsize, UseBins, Bins, IgnoreMask, DefaultBins) ==
+        std::tie(rh.Image, rh.ImageMTime, rh.Mask, rh.MaskMTime, rh.UseMinimum, rh.Minimum, rh.UseMaximum, rh.Maximum, rh.UseBinsize, rh.Binsize, rh.UseBins, rh.Bins, rh.IgnoreMask, rh.DefaultBins);
+    }
+  };
+
+  /** Quantifiers that were initialized recently. All feature classes of one
+   * extraction run (e.g. CLGlobalImageFeatures) share the same image, mask and usually
+   * the same histogram settings, so the intensity range has to be determined only once.*/
+  class QuantifierCache
+  {
+  public:
+    static QuantifierCache& GetInstance()
+    {
+      static QuantifierCache instance;
+      return instance;
+    }
+
+    mitk::IntensityQuantifier::Pointer Find(const QuantifierCacheKey& key)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (const auto& entry : m_Entries)
+      {
+        if (entry.first == key)
+          return entry.second;
+      }
+      return nullptr;
+    }
+
+    void Insert(const QuantifierCacheKey& key, mitk::IntensityQuantifier::Pointer quantifier)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Entries.emplace_back(key, quantifier);
+      while (m_Entries.size() > MaximumNumberOfEntries)
+        m_Entries.pop_front();
+    }
+
+    void Clear()
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Entries.clear();
+    }
+
+    void Remove(const mitk::Image* image)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(),
+        [image](const auto& entry) { return entry.first.Image == image || entry.first.Mask == image; }), m_Entries.end());
+    }
+
+  private:
+    static const std::size_t MaximumNumberOfEntries = 32;
+
+    std::mutex m_Mutex;
+    std::deque<std::pair<QuantifierCacheKey, mitk::IntensityQuantifier::Pointer>> m_Entries;
+  };
+
+  /** Identifies a quantized image by its input image and the quantifier settings that determine the bin indices.*/
+  struct QuantizedImageCacheKey
+  {
+    const mitk::Image* Image;
+    itk::ModifiedTimeType ImageMTime;
+    double Minimum;
+    double Binsize;
+
+    bool operator==(const QuantizedImageCacheKey& rh) const
+    {
+      return std::tie(Image, ImageMTime, Minimum, Binsize) == std::tie(rh.Image, rh.ImageMTime, rh.Minimum, rh.Binsize);
+    }
+  };
+
+  /** Quantized images that were computed recently. Each of them has the size of an int image of the input,
+   * so only a few are kept. All texture feature classes of one extraction run use the same one.*/
+  class QuantizedImageCache
+  {
+  public:
+    static QuantizedImageCache& GetInstance()
+    {
+      static QuantizedImageCache instance;
+      return instance;
+    }
+
+    mitk::Image::ConstPointer Find(const QuantizedImageCacheKey& key)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      for (const auto& entry : m_Entries)
+      {
+        if (entry.first == key)
+          return entry.second;
+      }
+      return nullptr;
+    }
+
+    void Insert(const QuantizedImageCacheKey& key, mitk::Image::ConstPointer image)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Entries.emplace_back(key, image);
+      while (m_Entries.size() > MaximumNumberOfEntries)
+        m_Entries.pop_front();
+    }
+
+    void Clear()
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Entries.clear();
+    }
+
+    void Remove(const mitk::Image* image)
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(),
+        [image](const auto& entry) { return entry.first.Image == image; }), m_Entries.end());
+    }
+
+  private:
+    static const std::size_t MaximumNumberOfEntries = 2;
+
+    std::mutex m_Mutex;
+    std::deque<std::pair<QuantizedImageCacheKey, mitk::Image::ConstPointer>> m_Entries;
+  };
+}
+
+template<typename TPixel, unsigned int VImageDimension>
+static void
+QuantizeImage(const itk::Image<TPixel, VImageDimension>* itkImage, double minimum, double binsize, mitk::Image::Pointer& result)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> QuantizedImageType;
+
+  typename QuantizedImageType::Pointer quantizedImage = QuantizedImageType::New();
+  quantizedImage->CopyInformation(itkImage);
+  quantizedImage->SetRegions(itkImage->GetLargestPossibleRegion());
+  quantizedImage->Allocate();
+
+  // Indices are limited to the range of the pixel type only, InvalidBinIndex is reserved for NaN
+  const double lowestIndex = std::numeric_limits<mitk::AbstractGlobalImageFeature::QuantizedPixelType>::lowest() + 1.0;
+  const double highestIndex = std::numeric_limits<mitk::AbstractGlobalImageFeature::QuantizedPixelType>::max();
+
+  itk::ImageRegionConstIterator<ImageType> imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+  itk::ImageRegionIterator<QuantizedImageType> quantizedIter(quantizedImage, quantizedImage->GetLargestPossibleRegion());
+  while (!imageIter.IsAtEnd())
+  {
+    double intensity = imageIter.Get();
+    if (intensity != intensity)
+    {
+      quantizedIter.Set(mitk::AbstractGlobalImageFeature::InvalidBinIndex);
+    }
+    else
+    {
+      double index = std::floor((intensity - minimum) / binsize);
+      quantizedIter.Set(static_cast<mitk::AbstractGlobalImageFeature::QuantizedPixelType>(std::max(lowestIndex, std::min(index, highestIndex))));
+    }
+    ++imageIter;
+    ++quantizedIter;
+  }
+
+  result = mitk::GrabItkImageMemory(quantizedImage);
+}
+
 static void
 ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
   int direction,
@@ -253,8 +444,50 @@ void mitk::AbstractGlobalImageFeature::ConfigureSettingsByParameters(const Param
   //Override to change behavior.
 }
 
+const mitk::AbstractGlobalImageFeature::QuantizedPixelType mitk::AbstractGlobalImageFeature::InvalidBinIndex =
+  std::numeric_limits<mitk::AbstractGlobalImageFeature::QuantizedPixelType>::lowest();
+
+void mitk::AbstractGlobalImageFeature::ClearQuantifierCache()
+{
+  QuantifierCache::GetInstance().Clear();
+  QuantizedImageCache::GetInstance().Clear();
+}
+
+void mitk::AbstractGlobalImageFeature::ClearQuantifierCache(const Image* image)
+{
+  QuantifierCache::GetInstance().Remove(image);
+  QuantizedImageCache::GetInstance().Remove(image);
+}
+
+mitk::Image::ConstPointer mitk::AbstractGlobalImageFeature::GetQuantizedImage(const Image* image, const IntensityQuantifier* quantifier)
+{
+  if (nullptr == image || nullptr == quantifier)
+    mitkThrow() << "Cannot quantize image. Image or quantifier is not set.";
+
+  QuantizedImageCacheKey key = { image, image->GetMTime(), quantifier->GetMinimum(), quantifier->GetBinsize() };
+
+  auto quantizedImage = QuantizedImageCache::GetInstance().Find(key);
+  if (quantizedImage.IsNotNull())
+    return quantizedImage;
+
+  Image::Pointer newImage;
+  AccessByItk_3(image, QuantizeImage, quantifier->GetMinimum(), quantifier->GetBinsize(), newImage);
+
+  QuantizedImageCache::GetInstance().Insert(key, newImage.GetPointer());
+  return newImage.GetPointer();
+}
+
 void  mitk::AbstractGlobalImageFeature::InitializeQuantifier(const Image* image, const Image* mask, unsigned int defaultBins)
 {
+  QuantifierCacheKey key = { image, image->GetMTime(), mask, nullptr != mask ? mask->GetMTime() : 0,
+    GetUseMinimumIntensity(), GetMinimumIntensity(), GetUseMaximumIntensity(), GetMaximumIntensity(),
+    GetUseBinsize(), GetBinsize(), GetUseBins(), GetBins(), GetIgnoreMask(), defaultBins };
+
+  // Quantifiers are never changed after their initialization, so they can be shared
+  m_Quantifier = QuantifierCache::GetInstance().Find(key);
+  if (m_Quantifier.IsNotNull())
+    return;
+
   m_Quantifier = IntensityQuantifier::New();
   if (GetUseMinimumIntensity() && GetUseMaximumIntensity() && GetUseBinsize())
     m_Quantifier->InitializeByBinsizeAndMaximum(GetMinimumIntensity(), GetMaximumIntensity(), GetBinsize());
@@ -295,6 +528,8 @@ void  mitk::AbstractGlobalImageFeature::InitializeQuantifier(const Image* image,
     m_Quantifier->InitializeByImage(image, GetBins());
   else
     m_Quantifier->InitializeByImageRegion(image, mask, defaultBins);
+
+  QuantifierCache::GetInstance().Insert(key, m_Quantifier);
 }
 
 std::string mitk::AbstractGlobalImageFeature::GenerateLegacyFeatureName(const FeatureID& id) const
@@ -38,24 +38,22 @@ found in the LICENSE file.
 #include <mitkGIFIntensityVolumeHistogramFeatures.h>
 #include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
 #include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
-#include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkITKImageImport.h>
-#include <mitkConvert2Dto3DImageFilter.h>
 
 #include <mitkCLResultWriter.h>
 #include <mitkCLResultXMLWriter.h>
+#include <mitkGlobalImageFeaturesBatch.h>
 #include <mitkVersion.h>
 
+#include <atomic>
 #include <iostream>
 #include <locale>
+#include <memory>
+#include <mutex>
+#include <thread>
 
-#include <itkImageDuplicator.h>
-#include <itkImageRegionIterator.h>
-
-
-#include "itkNearestNeighborInterpolateImageFunction.h"
-#include "itkResampleImageFilter.h"
+#include <itkMultiThreaderBase.h>
 
 #include <QApplication>
 #include <mitkStandaloneDataStorage.h>
@@ -83,99 +81,6 @@ private:
   charT m_Sep;
 };
 
-template<typename TPixel, unsigned int VImageDimension>
-void
-ResampleImage(itk::Image<TPixel, VImageDimension>* itkImage, float resolution, mitk::Image::Pointer& newImage)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::ResampleImageFilter<ImageType, ImageType> ResampleFilterType;
-
-  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
-  auto spacing = itkImage->GetSpacing();
-  auto size = itkImage->GetLargestPossibleRegion().GetSize();
-
-  for (unsigned int i = 0; i < VImageDimension; ++i)
-  {
-    size[i] = size[i] / (1.0*resolution)*(1.0*spacing[i])+1.0;
-  }
-  spacing.Fill(resolution);
-
-  resampler->SetInput(itkImage);
-  resampler->SetSize(size);
-  resampler->SetOutputSpacing(spacing);
-  resampler->SetOutputOrigin(itkImage->GetOrigin());
-  resampler->SetOutputDirection(itkImage->GetDirection());
-  resampler->Update();
-
-  newImage->InitializeByItk(resampler->GetOutput());
-  mitk::GrabItkImageMemory(resampler->GetOutput(), newImage);
-}
-
-
-template<typename TPixel, unsigned int VImageDimension>
-static void
-CreateNoNaNMask(itk::Image<TPixel, VImageDimension>* itkValue, mitk::Image::Pointer mask, mitk::Image::Pointer& newMask)
-{
-  typedef itk::Image< TPixel, VImageDimension>                 LFloatImageType;
-  typedef itk::Image< unsigned short, VImageDimension>          LMaskImageType;
-  typename LMaskImageType::Pointer itkMask = LMaskImageType::New();
-
-  mitk::CastToItkImage(mask, itkMask);
-
-  typedef itk::ImageDuplicator< LMaskImageType > DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage(itkMask);
-  duplicator->Update();
-
-  auto tmpMask = duplicator->GetOutput();
-
-  itk::ImageRegionIterator<LMaskImageType> mask1Iter(itkMask, itkMask->GetLargestPossibleRegion());
-  itk::ImageRegionIterator<LMaskImageType> mask2Iter(tmpMask, tmpMask->GetLargestPossibleRegion());
-  itk::ImageRegionIterator<LFloatImageType> imageIter(itkValue, itkValue->GetLargestPossibleRegion());
-  while (!mask1Iter.IsAtEnd())
-  {
-    mask2Iter.Set(0);
-    if (mask1Iter.Value() > 0)
-    {
-      // Is not NaN
-      if (imageIter.Value() == imageIter.Value())
-      {
-        mask2Iter.Set(1);
-      }
-    }
-    ++mask1Iter;
-    ++mask2Iter;
-    ++imageIter;
-  }
-
-  newMask->InitializeByItk(tmpMask);
-  mitk::GrabItkImageMemory(tmpMask, newMask);
-}
-
-template<typename TPixel, unsigned int VImageDimension>
-static void
-ResampleMask(itk::Image<TPixel, VImageDimension>* itkMoving, mitk::Image::Pointer ref, mitk::Image::Pointer& newMask)
-{
-  typedef itk::Image< TPixel, VImageDimension>          LMaskImageType;
-  typedef itk::NearestNeighborInterpolateImageFunction< LMaskImageType> NearestNeighborInterpolateImageFunctionType;
-  typedef itk::ResampleImageFilter<LMaskImageType, LMaskImageType> ResampleFilterType;
-
-  typename NearestNeighborInterpolateImageFunctionType::Pointer nn_interpolator = NearestNeighborInterpolateImageFunctionType::New();
-  typename LMaskImageType::Pointer itkRef = LMaskImageType::New();
-  mitk::CastToItkImage(ref, itkRef);
-
-
-  typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
-  resampler->SetInput(itkMoving);
-  resampler->SetReferenceImage(itkRef);
-  resampler->UseReferenceImageOn();
-  resampler->SetInterpolator(nn_interpolator);
-  resampler->Update();
-
-  newMask->InitializeByItk(resampler->GetOutput());
-  mitk::GrabItkImageMemory(resampler->GetOutput(), newMask);
-}
-
 static void
 ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
                         mitk::Image::Pointer maskNoNaN, mitk::Image::Pointer morphMask,
@@ -359,7 +264,7 @@ void SaveSliceOrImageAsPNG(mitk::Image::Pointer image, mitk::Image::Pointer mask
   }
 }
 
-int main(int argc, char* argv[])
+static std::vector<mitk::AbstractGlobalImageFeature::Pointer> CreateFeatureCalculators()
 {
   // Commented : Updated to a common interface, include, if possible, mask is type unsigned short, uses Quantification, Comments
   //                                 Name follows standard scheme with Class Name::Feature Name
@@ -398,6 +303,117 @@ int main(int argc, char* argv[])
   features.push_back(gldzCalculator.GetPointer());
   features.push_back(ipCalculator.GetPointer());
   features.push_back(ngtdCalculator.GetPointer());
+  return features;
+}
+
+static void ConfigureFeatureCalculators(std::vector<mitk::AbstractGlobalImageFeature::Pointer>& features, const mitk::cl::GlobalImageFeaturesParameter& param, const std::map<std::string, us::Any>& parsedArgs, int direction)
+{
+  for (auto cFeature : features)
+  {
+    if (param.defineGlobalMinimumIntensity)
+    {
+      cFeature->SetMinimumIntensity(param.globalMinimumIntensity);
+      cFeature->SetUseMinimumIntensity(true);
+    }
+    if (param.defineGlobalMaximumIntensity)
+    {
+      cFeature->SetMaximumIntensity(param.globalMaximumIntensity);
+      cFeature->SetUseMaximumIntensity(true);
+    }
+    if (param.defineGlobalNumberOfBins)
+    {
+      cFeature->SetBins(param.globalNumberOfBins);
+      MITK_INFO << param.globalNumberOfBins;
+    }
+    cFeature->SetParameters(parsedArgs);
+    cFeature->SetDirection(direction);
+    cFeature->SetEncodeParametersInFeaturePrefix(param.encodeParameter);
+  }
+}
+
+/** Processes all cases of the batch manifest that are not contained in the output yet. The cases are
+ * grouped by their image and the groups are distributed over a fixed number of worker threads, so
+ * that each image is loaded only once even if several masks refer to it.*/
+static int RunBatch(const mitk::cl::GlobalImageFeaturesParameter& param, const std::map<std::string, us::Any>& parsedArgs, int direction)
+{
+  if (parsedArgs.count("slice-wise") || param.writePNGScreenshots || param.writeAnalysisImage || param.writeAnalysisMask || !param.outputXMLPath.empty())
+  {
+    MITK_ERROR << "Slice-wise processing, screenshots, XML output and saving the analysed images are not supported in batch mode.";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<mitk::cl::GlobalImageFeaturesBatchCase> cases;
+  std::unique_ptr<mitk::cl::GlobalImageFeaturesBatchWriter> writer;
+  try
+  {
+    cases = mitk::cl::ReadGlobalImageFeaturesBatch(param.batchPath);
+    writer.reset(new mitk::cl::GlobalImageFeaturesBatchWriter(param.outputPath));
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_ERROR << e.GetDescription();
+    return EXIT_FAILURE;
+  }
+  if (param.useDecimalPoint)
+  {
+    writer->SetDecimalPoint(param.decimalPoint);
+  }
+
+  std::vector<mitk::cl::GlobalImageFeaturesBatchCase> openCases;
+  for (const auto& batchCase : cases)
+  {
+    if (!writer->IsCaseFinished(batchCase.caseID))
+    {
+      openCases.push_back(batchCase);
+    }
+  }
+  MITK_INFO << "Batch: " << cases.size() - openCases.size() << " of " << cases.size() << " cases are already contained in the output.";
+
+  auto groups = mitk::cl::GroupGlobalImageFeaturesBatchByImage(openCases);
+  if (groups.empty())
+  {
+    return EXIT_SUCCESS;
+  }
+
+  unsigned int numberOfCores = std::max(1u, std::thread::hardware_concurrency());
+  unsigned int numberOfWorkers = param.batchThreads > 0 ? param.batchThreads : numberOfCores;
+  numberOfWorkers = std::min<unsigned int>(numberOfWorkers, groups.size());
+  // The cases already use all cores, so the threading within the feature classes is reduced accordingly
+  itk::MultiThreaderBase::SetGlobalDefaultNumberOfThreads(std::max(1u, numberOfCores / numberOfWorkers));
+
+  std::atomic<std::size_t> nextGroup(0);
+  std::atomic<unsigned int> failedCases(0);
+  std::mutex ioMutex;
+
+  auto worker = [&]()
+  {
+    // Feature calculators keep the state of their current calculation and may not be shared between threads
+    auto features = CreateFeatureCalculators();
+    ConfigureFeatureCalculators(features, param, parsedArgs, direction);
+
+    for (std::size_t groupIndex = nextGroup++; groupIndex < groups.size(); groupIndex = nextGroup++)
+    {
+      failedCases += mitk::cl::CalculateGlobalImageFeaturesBatchGroup(groups[groupIndex], param, features, *writer, ioMutex);
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < numberOfWorkers; ++i)
+  {
+    workers.emplace_back(worker);
+  }
+  for (auto& thread : workers)
+  {
+    thread.join();
+  }
+
+  MITK_INFO << "Batch: " << writer->GetNumberOfFinishedCases() << " of " << cases.size() << " cases finished, " << failedCases.load() << " failed.";
+  return failedCases == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> features = CreateFeatureCalculators();
 
   mitkCommandLineParser parser;
   parser.setArgumentPrefix("--", "-");
@@ -455,6 +471,23 @@ int main(int argc, char* argv[])
   }
 
 
+  int direction = 0;
+  if (parsedArgs.count("direction"))
+  {
+    direction = mitk::cl::splitDouble(parsedArgs["direction"].ToString(), ';')[0];
+  }
+
+  if (param.useBatch)
+  {
+    return RunBatch(param, parsedArgs, direction);
+  }
+
+  if (param.imagePath.empty() || param.maskPath.empty())
+  {
+    MITK_ERROR << "Either an image and a mask or a batch manifest are required.";
+    return EXIT_FAILURE;
+  }
+
   //representing the original loaded image data without any prepropcessing that might come.
   mitk::Image::Pointer loadedImage = mitk::IOUtil::Load<mitk::Image>(param.imagePath);
   //representing the original loaded mask data without any prepropcessing that might come.
@@ -463,102 +496,26 @@ int main(int argc, char* argv[])
   mitk::Image::Pointer image = loadedImage;
   mitk::Image::Pointer mask = loadedMask;
 
-  mitk::Image::Pointer tmpImage = loadedImage;
-  mitk::Image::Pointer tmpMask = loadedMask;
-
   mitk::Image::Pointer morphMask = mask;
   if (param.useMorphMask)
   {
     morphMask = mitk::IOUtil::Load<mitk::Image>(param.morphPath);
   }
 
-  log << " Check for Dimensions -";
-  if ((image->GetDimension() != mask->GetDimension()))
-  {
-    MITK_INFO << "Dimension of image does not match. ";
-    MITK_INFO << "Correct one image, may affect the result";
-    if (image->GetDimension() == 2)
-    {
-      mitk::Convert2Dto3DImageFilter::Pointer multiFilter2 = mitk::Convert2Dto3DImageFilter::New();
-      multiFilter2->SetInput(tmpImage);
-      multiFilter2->Update();
-      image = multiFilter2->GetOutput();
-    }
-    if (mask->GetDimension() == 2)
-    {
-      mitk::Convert2Dto3DImageFilter::Pointer multiFilter3 = mitk::Convert2Dto3DImageFilter::New();
-      multiFilter3->SetInput(tmpMask);
-      multiFilter3->Update();
-      mask = multiFilter3->GetOutput();
-    }
-  }
-
   int writeDirection = 0;
   if (parsedArgs.count("output-mode"))
   {
     writeDirection = us::any_cast<int>(parsedArgs["output-mode"]);
   }
 
-  log << " Check for Resolution -";
-  if (param.resampleToFixIsotropic)
-  {
-    mitk::Image::Pointer newImage = mitk::Image::New();
-    AccessByItk_2(image, ResampleImage, param.resampleResolution, newImage);
-    image = newImage;
-  }
-
-  log << " Resample if required -";
-  if (param.resampleMask)
+  if (!mitk::cl::PrepareGlobalImageFeaturesImageAndMask(param, image, mask, log))
   {
-    mitk::Image::Pointer newMaskImage = mitk::Image::New();
-    AccessByItk_2(mask, ResampleMask, image, newMaskImage);
-    mask = newMaskImage;
-  }
-
-  if ( ! mitk::Equal(mask->GetGeometry(0)->GetOrigin(), image->GetGeometry(0)->GetOrigin()))
-  {
-    MITK_INFO << "Not equal Origins";
-    if (param.ensureSameSpace)
-    {
-      MITK_INFO << "Warning!";
-      MITK_INFO << "The origin of the input image and the mask do not match. They are";
-      MITK_INFO << "now corrected. Please check to make sure that the images still match";
-      image->GetGeometry(0)->SetOrigin(mask->GetGeometry(0)->GetOrigin());
-    } else
-    {
-      return -1;
-    }
-  }
-
-  log << " Check for Equality -";
-  if ( ! mitk::Equal(mask->GetGeometry(0)->GetSpacing(), image->GetGeometry(0)->GetSpacing()))
-  {
-    MITK_INFO << "Not equal Spacing";
-    if (param.ensureSameSpace)
-    {
-      MITK_INFO << "Warning!";
-      MITK_INFO << "The spacing of the mask was set to match the spacing of the input image.";
-      MITK_INFO << "This might cause unintended spacing of the mask image";
-      image->GetGeometry(0)->SetSpacing(mask->GetGeometry(0)->GetSpacing());
-    } else
-    {
-      MITK_INFO << "The spacing of the mask and the input images is not equal.";
-      MITK_INFO << "Terminating the programm. You may use the '-fi' option";
-      return -1;
-    }
-  }
-
-  int direction = 0;
-  if (parsedArgs.count("direction"))
-  {
-    direction = mitk::cl::splitDouble(parsedArgs["direction"].ToString(), ';')[0];
+    return -1;
   }
 
   MITK_INFO << "Start creating Mask without NaN";
 
-  mitk::Image::Pointer maskNoNaN = mitk::Image::New();
-  AccessByItk_2(image, CreateNoNaNMask,  mask, maskNoNaN);
-  //CreateNoNaNMask(mask, image, maskNoNaN);
+  mitk::Image::Pointer maskNoNaN = mitk::cl::CreateGlobalImageFeaturesNoNaNMask(image, mask);
 
 
   bool sliceWise = false;
@@ -582,27 +539,7 @@ int main(int argc, char* argv[])
   }
 
   log << " Configure features -";
-  for (auto cFeature : features)
-  {
-    if (param.defineGlobalMinimumIntensity)
-    {
-      cFeature->SetMinimumIntensity(param.globalMinimumIntensity);
-      cFeature->SetUseMinimumIntensity(true);
-    }
-    if (param.defineGlobalMaximumIntensity)
-    {
-      cFeature->SetMaximumIntensity(param.globalMaximumIntensity);
-      cFeature->SetUseMaximumIntensity(true);
-    }
-    if (param.defineGlobalNumberOfBins)
-    {
-      cFeature->SetBins(param.globalNumberOfBins);
-      MITK_INFO << param.globalNumberOfBins;
-    }
-    cFeature->SetParameters(parsedArgs);
-    cFeature->SetDirection(direction);
-    cFeature->SetEncodeParametersInFeaturePrefix(param.encodeParameter);
-  }
+  ConfigureFeatureCalculators(features, param, parsedArgs, direction);
 
   bool addDescription = parsedArgs.count("description");
   mitk::cl::FeatureResultWriter writer(param.outputPath, writeDirection);
@@ -676,6 +613,8 @@ int main(int argc, char* argv[])
       cFeature->SetMorphMask(cMorphMask);
       cFeature->CalculateAndAppendFeatures(cImage, cMask, cMaskNoNaN, stats, !param.calculateAllFeatures);
     }
+    // every slice is a new image, so the quantized images are not reused afterwards
+    mitk::AbstractGlobalImageFeature::ClearQuantifierCache();
 
     for (std::size_t i = 0; i < stats.size(); ++i)
     {
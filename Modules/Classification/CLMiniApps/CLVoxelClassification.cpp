@@ -355,15 +355,8 @@ int main(int argc, char* argv[])
     //////////////////////////////////////////////////////////////////////////////
     // If required do test
     //////////////////////////////////////////////////////////////////////////////
-    MITK_INFO << "Convert Test data";
-    auto testDataX = mitk::DCUtilities::DC3dDToMatrixXd(testCollection,modalities, testMask);
-
     MITK_INFO << "Predict Test Data";
-    auto testDataNewY = forest->Predict(testDataX);
-    auto testDataNewProb = forest->GetPointWiseProbabilities();
-    //MITK_INFO << testDataNewY;
-
-    auto maxClassValue = testDataNewProb.cols();
+    auto maxClassValue = forest->GetRandomForest().class_count();
     std::vector<std::string> names;
     for (int i = 0; i < maxClassValue; ++i)
     {
@@ -371,11 +364,13 @@ int main(int argc, char* argv[])
       MITK_INFO << name;
       names.push_back(name);
     }
-    //names.push_back("prob-1");
-    //names.push_back("prob-2");
 
-    mitk::DCUtilities::MatrixToDC3d(testDataNewY, testCollection, resultMask, testMask);
-    mitk::DCUtilities::MatrixToDC3d(testDataNewProb, testCollection, names, testMask);
+    // Classify the test data block by block instead of converting all voxels into one feature matrix
+    auto classifyBlock = [&forest](const Eigen::MatrixXd &features, Eigen::MatrixXi &labels, Eigen::MatrixXd &probabilities)
+    {
+      forest->PredictBlock(features, labels, probabilities);
+    };
+    mitk::DCUtilities::ClassifyDC3dBlockwise(testCollection, modalities, testMask, resultMask, names, 65536, classifyBlock);
     MITK_INFO << "Converted predicted data";
     //forest.SetMaskName(testMask);
     //forest.SetCollection(testCollection);
@@ -0,0 +1,132 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkGlobalImageFeaturesBatch_h
+#define mitkGlobalImageFeaturesBatch_h
+
+#include "MitkCLUtilitiesExports.h"
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <mitkAbstractGlobalImageFeature.h>
+#include <mitkGlobalImageFeaturesParameter.h>
+#include <mitkImage.h>
+
+namespace mitk
+{
+  namespace cl
+  {
+    /** One image / mask pair of a batch run. The case ID identifies the case in the output. */
+    struct MITKCLUTILITIES_EXPORT GlobalImageFeaturesBatchCase
+    {
+      std::string caseID;
+      std::string imagePath;
+      std::string maskPath;
+      std::string morphMaskPath;
+    };
+
+    /**
+    * \brief Reads a case manifest for batch processing.
+    *
+    * Each line describes one case as "CaseID;Image;Mask" with an optional fourth column
+    * for the morphological mask. Empty lines and lines starting with '#' are ignored.
+    * Throws an mitk::Exception if the file cannot be read, a line is incomplete or a case ID
+    * is used twice.
+    */
+    MITKCLUTILITIES_EXPORT std::vector<GlobalImageFeaturesBatchCase> ReadGlobalImageFeaturesBatch(const std::string& manifestPath);
+
+    /**
+    * \brief Groups the cases by their image path, so that each image has to be loaded only once.
+    * The order of the first occurrence of each image is kept.
+    */
+    MITKCLUTILITIES_EXPORT std::vector<std::vector<GlobalImageFeaturesBatchCase>> GroupGlobalImageFeaturesBatchByImage(const std::vector<GlobalImageFeaturesBatchCase>& cases);
+
+    /**
+    * \brief Thread-safe writer for the results of a batch run.
+    *
+    * The results are stored as table with one row per case and one column per feature.
+    * Every row is written and flushed as soon as its case is finished and ends with
+    * "EndOfMeasurement", so that an interrupted run leaves only complete rows behind (and
+    * at most one truncated row). If the output file already exists, truncated rows are removed
+    * and the header and the IDs of all complete rows are read on construction. IsCaseFinished()
+    * can be used to skip these cases when the run is resumed.
+    * All rows have the features of the header, which is written with the first row.
+    */
+    class MITKCLUTILITIES_EXPORT GlobalImageFeaturesBatchWriter
+    {
+    public:
+      explicit GlobalImageFeaturesBatchWriter(const std::string& outputPath);
+      ~GlobalImageFeaturesBatchWriter();
+
+      void SetDecimalPoint(char decimal);
+
+      bool IsCaseFinished(const std::string& caseID) const;
+      std::size_t GetNumberOfFinishedCases() const;
+
+      /** Appends the row of the case. The header is written together with the first row of a new file.
+      * Throws an mitk::Exception (and writes nothing) if the features do not match the header.*/
+      void AddCase(const GlobalImageFeaturesBatchCase& batchCase, const mitk::AbstractGlobalImageFeature::FeatureListType& stats);
+
+    private:
+      std::string m_Separator;
+      std::ofstream m_Output;
+      bool m_HeaderWritten;
+      std::vector<std::string> m_FeatureNames;
+      bool m_UseSpecialDecimalPoint;
+      char m_DecimalPoint;
+      std::set<std::string> m_FinishedCases;
+      mutable std::mutex m_Mutex;
+    };
+
+    /** Images of a batch group that are prepared once and shared by all cases of the group.
+    * The key indicates if the image was converted to 3D to match the dimension of the mask.*/
+    typedef std::map<bool, mitk::Image::Pointer> GlobalImageFeaturesPreparedImages;
+
+    /**
+    * \brief Ensures that image and mask have the same dimension, resolution and space as requested by the parameters.
+    *
+    * If preparedImages is passed, the conversion to 3D and the isotropic resampling of the image are done only once
+    * and reused for further masks of the same image. Corrections of origin or spacing are applied to an image that
+    * shares the pixel data but owns its geometry (see ShareImageWithOwnGeometry()), thus neither the passed nor
+    * the prepared images are modified.
+    * Returns false if image and mask do not match and may not be corrected.
+    */
+    MITKCLUTILITIES_EXPORT bool PrepareGlobalImageFeaturesImageAndMask(const GlobalImageFeaturesParameter& param, mitk::Image::Pointer& image,
+      mitk::Image::Pointer& mask, std::ostream& log, GlobalImageFeaturesPreparedImages* preparedImages = nullptr);
+
+    /** \brief Returns a copy of the mask without the voxels that are NaN in the image. */
+    MITKCLUTILITIES_EXPORT mitk::Image::Pointer CreateGlobalImageFeaturesNoNaNMask(const mitk::Image* image, const mitk::Image* mask);
+
+    /** \brief Returns an image that shares the pixel data of the passed image but owns a copy of its geometry. */
+    MITKCLUTILITIES_EXPORT mitk::Image::Pointer ShareImageWithOwnGeometry(const mitk::Image* image);
+
+    /**
+    * \brief Calculates the features of all cases of a group (see GroupGlobalImageFeaturesBatchByImage()) and adds them to the writer.
+    *
+    * The image is loaded and prepared once for all cases of the group. Failed cases are logged and not written.
+    * Files are loaded while ioMutex is locked, because the readers are not guaranteed to be thread-safe.
+    * The feature calculators keep the state of their current calculation and may not be used by several groups concurrently.
+    * \return the number of failed cases
+    */
+    MITKCLUTILITIES_EXPORT unsigned int CalculateGlobalImageFeaturesBatchGroup(const std::vector<GlobalImageFeaturesBatchCase>& group,
+      const GlobalImageFeaturesParameter& param, const std::vector<mitk::AbstractGlobalImageFeature::Pointer>& features,
+      GlobalImageFeaturesBatchWriter& writer, std::mutex& ioMutex);
+  }
+}
+
+#endif //mitkGlobalImageFeaturesBatch_h
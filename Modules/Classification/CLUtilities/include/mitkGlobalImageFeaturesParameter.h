@@ -37,6 +37,10 @@ namespace mitk
       std::string outputPath;
       std::string outputXMLPath;
 
+      bool useBatch;
+      std::string batchPath;
+      int batchThreads;
+
       std::string morphPath;
       std::string morphName;
       bool useMorphMask;
@@ -21,6 +21,8 @@ found in the LICENSE file.
 #include <itkEnhancedScalarImageToTextureFeaturesFilter.h>
 #include <itkShapedNeighborhoodIterator.h>
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkMultiThreaderBase.h>
 
 // STL
 #include <sstream>
@@ -209,52 +211,40 @@ double mitk::CoocurenceMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
+/** Fills the matrix of one offset from the shared quantized image. Only voxels inside the mask
+ * are counted, and the bin indices are limited to the bins of the matrix.*/
+template<unsigned int VImageDimension>
 void
-CalculateCoOcMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
+CalculateCoOcMatrix(const itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension>* quantizedImage,
                     const itk::Image<unsigned short, VImageDimension>* mask,
                     itk::Offset<VImageDimension> offset,
-                    int range,
                     mitk::CoocurenceMatrixHolder &holder)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> QuantizedImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef itk::ShapedNeighborhoodIterator<ImageType> ShapeIterType;
-  typedef itk::ShapedNeighborhoodIterator<MaskImageType> ShapeMaskIterType;
-  typedef itk::ImageRegionConstIterator<ImageType> ConstIterType;
-  typedef itk::ImageRegionConstIterator<MaskImageType> ConstMaskIterType;
-
-
-  itk::Size<VImageDimension> radius;
-  radius.Fill(range+1);
-  ShapeIterType imageOffsetIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
-  ShapeMaskIterType maskOffsetIter(radius, mask, mask->GetLargestPossibleRegion());
-  imageOffsetIter.ActivateOffset(offset);
-  maskOffsetIter.ActivateOffset(offset);
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
-  ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
-  //  iterator.GetIndex() + ci.GetNeighborhoodOffset()
-  auto region = mask->GetLargestPossibleRegion();
-
 
-  while (!maskIter.IsAtEnd())
+  auto region = quantizedImage->GetLargestPossibleRegion();
+  itk::ImageRegionConstIteratorWithIndex<QuantizedImageType> indexIter(quantizedImage, region);
+  itk::ImageRegionConstIterator<MaskImageType> maskIter(mask, mask->GetLargestPossibleRegion());
+  while (!indexIter.IsAtEnd())
   {
-    auto ciMask = maskOffsetIter.Begin();
-    auto ciValue = imageOffsetIter.Begin();
-    if (maskIter.Value() > 0 &&
-      ciMask.Get() > 0 &&
-      imageIter.Get() == imageIter.Get() &&
-      ciValue.Get() == ciValue.Get() &&
-      region.IsInside(maskOffsetIter.GetIndex() + ciMask.GetNeighborhoodOffset()))
+    int i = indexIter.Get();
+    if (maskIter.Value() > 0 && i != mitk::AbstractGlobalImageFeature::InvalidBinIndex)
     {
-      int i = holder.IntensityToIndex(imageIter.Get());
-      int j = holder.IntensityToIndex(ciValue.Get());
-      holder.m_Matrix(i, j) += 1;
-      holder.m_Matrix(j, i) += 1;
+      auto neighbourIndex = indexIter.GetIndex() + offset;
+      if (region.IsInside(neighbourIndex))
+      {
+        int j = quantizedImage->GetPixel(neighbourIndex);
+        if (mask->GetPixel(neighbourIndex) > 0 && j != mitk::AbstractGlobalImageFeature::InvalidBinIndex)
+        {
+          i = std::max(0, std::min(i, holder.m_NumberOfBins - 1));
+          j = std::max(0, std::min(j, holder.m_NumberOfBins - 1));
+          holder.m_Matrix(i, j) += 1;
+          holder.m_Matrix(j, i) += 1;
+        }
+      }
     }
-    ++imageOffsetIter;
-    ++maskOffsetIter;
-    ++imageIter;
+    ++indexIter;
     ++maskIter;
   }
 }
@@ -421,88 +411,98 @@ void CalculateFeatures(
 
 template<typename TPixel, unsigned int VImageDimension>
 void
-CalculateCoocurenceFeatures(const itk::Image<TPixel, VImageDimension>* itkImage, const mitk::Image* mask, mitk::GIFCooccurenceMatrix2::FeatureListType & featureList, mitk::GIFCooccurenceMatrix2Configuration config)
+CalculateCoocurenceFeatures(const itk::Image<TPixel, VImageDimension>*, const mitk::Image* mask, const mitk::Image* quantizedImage, mitk::GIFCooccurenceMatrix2::FeatureListType & featureList, const std::vector<mitk::GIFCooccurenceMatrix2Configuration>& configs)
 {
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> QuantizedImageType;
   typedef itk::Neighborhood<TPixel, VImageDimension > NeighborhoodType;
   typedef itk::Offset<VImageDimension> OffsetType;
 
+  if (configs.empty())
+    return;
+
   ///////////////////////////////////////////////////////////////////////////////////////////////
-  double rangeMin = config.MinimumIntensity;
-  double rangeMax = config.MaximumIntensity;
-  int numberOfBins = config.Bins;
+  // All configurations share the quantifier settings and differ only in the range
+  double rangeMin = configs.front().MinimumIntensity;
+  double rangeMax = configs.front().MaximumIntensity;
+  int numberOfBins = configs.front().Bins;
 
   typename MaskType::Pointer maskImage = MaskType::New();
   mitk::CastToItkImage(mask, maskImage);
 
-  //Find possible directions
-  std::vector < itk::Offset<VImageDimension> > offsetVector;
-  NeighborhoodType hood;
-  hood.SetRadius(1);
-  unsigned int        centerIndex = hood.GetCenterNeighborhoodIndex();
-  OffsetType          offset;
-  for (unsigned int d = 0; d < centerIndex; d++)
+  typename QuantizedImageType::Pointer itkQuantizedImage = QuantizedImageType::New();
+  mitk::CastToItkImage(quantizedImage, itkQuantizedImage);
+
+  mitk::CoocurenceMatrixHolder quantizationHolder(rangeMin, rangeMax, numberOfBins);
+
+  auto multiThreader = itk::MultiThreaderBase::New();
+
+  for (const auto& config : configs)
   {
-    offset = hood.GetOffset(d);
-    bool useOffset = true;
-    for (unsigned int i = 0; i < VImageDimension; ++i)
+    MITK_INFO << "Start calculating coocurence with range " << config.range << "....";
+
+    //Find possible directions
+    std::vector < itk::Offset<VImageDimension> > offsetVector;
+    NeighborhoodType hood;
+    hood.SetRadius(1);
+    unsigned int        centerIndex = hood.GetCenterNeighborhoodIndex();
+    OffsetType          offset;
+    for (unsigned int d = 0; d < centerIndex; d++)
     {
-      offset[i] *= config.range;
-      if (config.direction == i + 2 && offset[i] != 0)
+      offset = hood.GetOffset(d);
+      bool useOffset = true;
+      for (unsigned int i = 0; i < VImageDimension; ++i)
       {
-        useOffset = false;
+        offset[i] *= config.range;
+        if (config.direction == i + 2 && offset[i] != 0)
+        {
+          useOffset = false;
+        }
+      }
+      if (useOffset)
+      {
+        offsetVector.push_back(offset);
       }
     }
-    if (useOffset)
+    if (config.direction == 1)
     {
-      offsetVector.push_back(offset);
+      offsetVector.clear();
+      offset[0] = 0;
+      offset[1] = 0;
+      offset[2] = 1;
     }
-  }
-  if (config.direction == 1)
-  {
-    offsetVector.clear();
-    offset[0] = 0;
-    offset[1] = 0;
-    offset[2] = 1;
-  }
 
-  std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
-  mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
-  mitk::CoocurenceMatrixFeatures overallFeature;
-  for (std::size_t i = 0; i < offsetVector.size(); ++i)
-  {
-    if (config.direction > 1)
+    // Each offset gets its own matrix, so the offsets can be processed in parallel without locking
+    std::vector<mitk::CoocurenceMatrixHolder> holders(offsetVector.size(), quantizationHolder);
+    std::vector<mitk::CoocurenceMatrixFeatures> offsetResults(offsetVector.size());
+    multiThreader->ParallelizeArray(0, offsetVector.size(), [&](itk::SizeValueType i)
     {
-      if (offsetVector[i][config.direction - 2] != 0)
-      {
-        continue;
-      }
+      CalculateCoOcMatrix<VImageDimension>(itkQuantizedImage, maskImage, offsetVector[i], holders[i]);
+      CalculateFeatures(holders[i], offsetResults[i]);
+    }, nullptr);
+
+    std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
+    mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
+    mitk::CoocurenceMatrixFeatures overallFeature;
+    for (std::size_t i = 0; i < offsetVector.size(); ++i)
+    {
+      holderOverall.m_Matrix += holders[i].m_Matrix;
+      resultVector.push_back(offsetResults[i]);
     }
+    CalculateFeatures(holderOverall, overallFeature);
+    //NormalizeMatrixFeature(overallFeature, offsetVector.size());
 
 
-    offset = offsetVector[i];
-    mitk::CoocurenceMatrixHolder holder(rangeMin, rangeMax, numberOfBins);
-    mitk::CoocurenceMatrixFeatures coocResults;
-    CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
-    holderOverall.m_Matrix += holder.m_Matrix;
-    CalculateFeatures(holder, coocResults);
-    resultVector.push_back(coocResults);
-  }
-  CalculateFeatures(holderOverall, overallFeature);
-  //NormalizeMatrixFeature(overallFeature, offsetVector.size());
-
+    mitk::CoocurenceMatrixFeatures featureMean;
+    mitk::CoocurenceMatrixFeatures featureStd;
+    CalculateMeanAndStdDevFeatures(resultVector, featureMean, featureStd);
 
-  mitk::CoocurenceMatrixFeatures featureMean;
-  mitk::CoocurenceMatrixFeatures featureStd;
-  CalculateMeanAndStdDevFeatures(resultVector, featureMean, featureStd);
+    MatrixFeaturesTo(overallFeature, "Overall ", config, featureList);
+    MatrixFeaturesTo(featureMean, "Mean ", config, featureList);
+    MatrixFeaturesTo(featureStd, "Std.Dev. ", config, featureList);
 
-  std::ostringstream  ss;
-  ss << config.range;
-  std::string strRange = ss.str();
-
-  MatrixFeaturesTo(overallFeature, "Overall ", config, featureList);
-  MatrixFeaturesTo(featureMean, "Mean ", config, featureList);
-  MatrixFeaturesTo(featureStd, "Std.Dev. ", config, featureList);
+    MITK_INFO << "Finished calculating coocurence with range " << config.range << "....";
+  }
 }
 
 static
@@ -652,10 +652,9 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFCooccurenceMatrix2::D
 
   InitializeQuantifier(image, mask);
 
+  std::vector<GIFCooccurenceMatrix2Configuration> configs;
   for (const auto& range: m_Ranges)
   {
-    MITK_INFO << "Start calculating coocurence with range " << range << "....";
-
     GIFCooccurenceMatrix2Configuration config;
     config.direction = GetDirection();
     config.range = range;
@@ -663,12 +662,13 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFCooccurenceMatrix2::D
     config.MaximumIntensity = GetQuantifier()->GetMaximum();
     config.Bins = GetQuantifier()->GetBins();
     config.id = this->CreateTemplateFeatureID(std::to_string(range), { {GetOptionPrefix() + "::range", range} });
-
-    AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList, config);
-
-    MITK_INFO << "Finished calculating coocurence with range " << range << "....";
+    configs.push_back(config);
   }
 
+  // The matrices of all ranges are computed from the quantized image that is shared with other feature classes
+  auto quantizedImage = GetQuantizedImage(image, GetQuantifier());
+  AccessByItk_n(image, CalculateCoocurenceFeatures, (mask, quantizedImage.GetPointer(), featureList, configs));
+
   return featureList;
 }
 
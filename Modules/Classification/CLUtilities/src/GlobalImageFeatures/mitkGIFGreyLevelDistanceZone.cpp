@@ -38,6 +38,7 @@ namespace mitk{
     double MinimumIntensity;
     double MaximumIntensity;
     int Bins;
+    Image::ConstPointer QuantizedImage;
     FeatureID id;
   };
 
@@ -47,6 +48,7 @@ namespace mitk{
     GreyLevelDistanceZoneMatrixHolder(mitk::IntensityQuantifier::Pointer quantifier, int number, int maxSize);
 
     int IntensityToIndex(double intensity);
+    int BinIndexToIndex(int binIndex);
 
     int m_NumberOfBins;
     int m_MaximumSize;
@@ -98,17 +100,23 @@ int mitk::GreyLevelDistanceZoneMatrixHolder::IntensityToIndex(double intensity)
   return m_Quantifier->IntensityToIndex(intensity);
 }
 
+int mitk::GreyLevelDistanceZoneMatrixHolder::BinIndexToIndex(int binIndex)
+{
+  // Same limits as IntensityToIndex, NaN voxels (InvalidBinIndex) end up in the first bin as well
+  return std::max(0, std::min(binIndex, static_cast<int>(m_Quantifier->GetBins()) - 1));
+}
 
-template<typename TPixel, unsigned int VImageDimension>
+
+template<unsigned int VImageDimension>
 int
-CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
+CalculateGlSZMatrix(const itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension>* quantizedImage,
                     const itk::Image<unsigned short, VImageDimension>* mask,
                     const itk::Image<unsigned short, VImageDimension>* distanceImage,
                     std::vector<itk::Offset<VImageDimension> > offsets,
                     bool estimateLargestRegion,
                     mitk::GreyLevelDistanceZoneMatrixHolder &holder)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
   typedef typename ImageType::IndexType IndexType;
 
@@ -120,7 +128,7 @@ CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
   newRegion.SetSize(region.GetSize());
   newRegion.SetIndex(region.GetIndex());
 
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+  ConstIterType imageIter(quantizedImage, quantizedImage->GetLargestPossibleRegion());
   ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
 
   typename MaskImageType::Pointer visitedImage = MaskImageType::New();
@@ -135,7 +143,7 @@ CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
   {
     if (maskIter.Value() > 0 )
     {
-      auto startIntensityIndex = holder.IntensityToIndex(imageIter.Value());
+      auto startIntensityIndex = holder.BinIndexToIndex(imageIter.Value());
       std::vector<IndexType> indices;
       indices.push_back(maskIter.GetIndex());
       unsigned int steps = 0;
@@ -152,7 +160,7 @@ CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
         }
 
         auto wasVisited = visitedImage->GetPixel(currentIndex);
-        auto newIntensityIndex = holder.IntensityToIndex(itkImage->GetPixel(currentIndex));
+        auto newIntensityIndex = holder.BinIndexToIndex(quantizedImage->GetPixel(currentIndex));
         auto isInMask = mask->GetPixel(currentIndex);
 
         if ((isInMask > 0) &&
@@ -354,9 +362,10 @@ void static CalculateFeatures(
 
 template<typename TPixel, unsigned int VImageDimension>
 static void
-CalculateGreyLevelDistanceZoneFeatures(const itk::Image<TPixel, VImageDimension>* itkImage, const mitk::Image* mask, mitk::GIFGreyLevelDistanceZone::FeatureListType & featureList, mitk::GreyLevelDistanceZoneConfiguration config)
+CalculateGreyLevelDistanceZoneFeatures(const itk::Image<TPixel, VImageDimension>*, const mitk::Image* mask, mitk::GIFGreyLevelDistanceZone::FeatureListType & featureList, mitk::GreyLevelDistanceZoneConfiguration config)
 {
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> QuantizedImageType;
   typedef itk::Neighborhood<TPixel, VImageDimension > NeighborhoodType;
   typedef itk::Offset<VImageDimension> OffsetType;
 
@@ -370,6 +379,9 @@ CalculateGreyLevelDistanceZoneFeatures(const itk::Image<TPixel, VImageDimension>
   typename MaskType::Pointer maskImage = MaskType::New();
   mitk::CastToItkImage(mask, maskImage);
 
+  typename QuantizedImageType::Pointer quantizedImage = QuantizedImageType::New();
+  mitk::CastToItkImage(config.QuantizedImage, quantizedImage);
+
   //Find possible directions
   std::vector < itk::Offset<VImageDimension> > offsetVector;
   NeighborhoodType hood;
@@ -405,7 +417,7 @@ CalculateGreyLevelDistanceZoneFeatures(const itk::Image<TPixel, VImageDimension>
   std::vector<mitk::GreyLevelDistanceZoneFeatures> resultVector;
   mitk::GreyLevelDistanceZoneMatrixHolder holderOverall(config.Quantifier, config.Bins, maximumDistance + 1);
   mitk::GreyLevelDistanceZoneFeatures overallFeature;
-  CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, distanceImage, offsetVector, false, holderOverall);
+  CalculateGlSZMatrix<VImageDimension>(quantizedImage, maskImage, distanceImage, offsetVector, false, holderOverall);
   CalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config, featureList);
@@ -453,6 +465,7 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFGreyLevelDistanceZone
   config.Bins = GetQuantifier()->GetBins();
   config.id = this->CreateTemplateFeatureID();
   config.Quantifier = GetQuantifier();
+  config.QuantizedImage = GetQuantizedImage(image, GetQuantifier());
 
   AccessByItk_3(image, CalculateGreyLevelDistanceZoneFeatures, mask, featureList, config);
 
@@ -31,6 +31,7 @@ namespace mitk
     double MinimumIntensity;
     double MaximumIntensity;
     int Bins;
+    Image::ConstPointer QuantizedImage;
     FeatureID id;
   };
 
@@ -153,15 +154,15 @@ double mitk::GreyLevelSizeZoneMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
+template<unsigned int VImageDimension>
 static int
-CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
+CalculateGlSZMatrix(const itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension>* quantizedImage,
                     const itk::Image<unsigned short, VImageDimension>* mask,
                     std::vector<itk::Offset<VImageDimension> > offsets,
                     bool estimateLargestRegion,
                     mitk::GreyLevelSizeZoneMatrixHolder &holder)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
   typedef typename ImageType::IndexType IndexType;
 
@@ -173,7 +174,7 @@ CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
   newRegion.SetSize(region.GetSize());
   newRegion.SetIndex(region.GetIndex());
 
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
+  ConstIterType imageIter(quantizedImage, quantizedImage->GetLargestPossibleRegion());
   ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
 
   typename MaskImageType::Pointer visitedImage = MaskImageType::New();
@@ -187,7 +188,7 @@ CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
   {
     if (maskIter.Value() > 0 )
     {
-      auto startIntensityIndex = holder.IntensityToIndex(imageIter.Value());
+      auto startIntensityIndex = imageIter.Value();
       std::vector<IndexType> indices;
       indices.push_back(maskIter.GetIndex());
       unsigned int steps = 0;
@@ -203,7 +204,7 @@ CalculateGlSZMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
         }
 
         auto wasVisited = visitedImage->GetPixel(currentIndex);
-        auto newIntensityIndex = holder.IntensityToIndex(itkImage->GetPixel(currentIndex));
+        auto newIntensityIndex = quantizedImage->GetPixel(currentIndex);
         auto isInMask = mask->GetPixel(currentIndex);
 
         if ((isInMask > 0) &&
@@ -327,9 +328,10 @@ static void CalculateFeatures(
 
 template<typename TPixel, unsigned int VImageDimension>
 static void
-CalculateGreyLevelSizeZoneFeatures(const itk::Image<TPixel, VImageDimension>* itkImage, const mitk::Image* mask, mitk::GIFGreyLevelSizeZone::FeatureListType & featureList, mitk::GIFGreyLevelSizeZoneConfiguration config)
+CalculateGreyLevelSizeZoneFeatures(const itk::Image<TPixel, VImageDimension>*, const mitk::Image* mask, mitk::GIFGreyLevelSizeZone::FeatureListType & featureList, mitk::GIFGreyLevelSizeZoneConfiguration config)
 {
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> QuantizedImageType;
   typedef itk::Neighborhood<TPixel, VImageDimension > NeighborhoodType;
   typedef itk::Offset<VImageDimension> OffsetType;
 
@@ -341,6 +343,9 @@ CalculateGreyLevelSizeZoneFeatures(const itk::Image<TPixel, VImageDimension>* it
   typename MaskType::Pointer maskImage = MaskType::New();
   mitk::CastToItkImage(mask, maskImage);
 
+  typename QuantizedImageType::Pointer quantizedImage = QuantizedImageType::New();
+  mitk::CastToItkImage(config.QuantizedImage, quantizedImage);
+
   //Find possible directions
   std::vector < itk::Offset<VImageDimension> > offsetVector;
   NeighborhoodType hood;
@@ -375,10 +380,10 @@ CalculateGreyLevelSizeZoneFeatures(const itk::Image<TPixel, VImageDimension>* it
 
   std::vector<mitk::GreyLevelSizeZoneFeatures> resultVector;
   mitk::GreyLevelSizeZoneMatrixHolder tmpHolder(rangeMin, rangeMax, numberOfBins, 3);
-  int largestRegion = CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, true, tmpHolder);
+  int largestRegion = CalculateGlSZMatrix<VImageDimension>(quantizedImage, maskImage, offsetVector, true, tmpHolder);
   mitk::GreyLevelSizeZoneMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins,largestRegion);
   mitk::GreyLevelSizeZoneFeatures overallFeature;
-  CalculateGlSZMatrix<TPixel, VImageDimension>(itkImage, maskImage, offsetVector, false, holderOverall);
+  CalculateGlSZMatrix<VImageDimension>(quantizedImage, maskImage, offsetVector, false, holderOverall);
   CalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config, featureList);
@@ -414,6 +419,7 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFGreyLevelSizeZone::Do
   config.MinimumIntensity = GetQuantifier()->GetMinimum();
   config.MaximumIntensity = GetQuantifier()->GetMaximum();
   config.Bins = GetQuantifier()->GetBins();
+  config.QuantizedImage = GetQuantizedImage(image, GetQuantifier());
   config.id = this->CreateTemplateFeatureID();
 
   AccessByItk_3(image, CalculateGreyLevelSizeZoneFeatures, mask, featureList, config);
@@ -23,25 +23,34 @@ found in the LICENSE file.
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkNeighborhoodIterator.h>
 // STL
+#include <algorithm>
 #include <limits>
 
 struct GIFNeighbourhoodGreyToneDifferenceParameter
 {
   int Range = 1;
   mitk::IntensityQuantifier::Pointer quantifier;
+  mitk::Image::ConstPointer quantizedImage;
   mitk::FeatureID id;
 };
 
 template<typename TPixel, unsigned int VImageDimension>
 static void
-CalculateIntensityPeak(const itk::Image<TPixel, VImageDimension>* itkImage, const mitk::Image* mask, GIFNeighbourhoodGreyToneDifferenceParameter params, mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType & featureList)
+CalculateIntensityPeak(const itk::Image<TPixel, VImageDimension>*, const mitk::Image* mask, GIFNeighbourhoodGreyToneDifferenceParameter params, mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::FeatureListType & featureList)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
 
   typename MaskType::Pointer itkMask = MaskType::New();
   mitk::CastToItkImage(mask, itkMask);
 
+  typename ImageType::Pointer itkImage = ImageType::New();
+  mitk::CastToItkImage(params.quantizedImage, itkImage);
+
+  // Same limits as IntensityQuantifier::IntensityToIndex, NaN voxels (InvalidBinIndex) end up in the first bin as well
+  const int lastBin = static_cast<int>(params.quantifier->GetBins()) - 1;
+  auto binIndexToIndex = [lastBin](int binIndex) { return static_cast<unsigned int>(std::max(0, std::min(binIndex, lastBin))); };
+
   typename ImageType::SizeType regionSize;
   regionSize.Fill(params.Range);
 
@@ -60,7 +69,7 @@ CalculateIntensityPeak(const itk::Image<TPixel, VImageDimension>* itkImage, cons
     {
       int localCount = 0;
       double localMean = 0;
-      unsigned int localIndex = params.quantifier->IntensityToIndex(iter.GetCenterPixel());
+      unsigned int localIndex = binIndexToIndex(iter.GetCenterPixel());
       for (itk::SizeValueType i = 0; i < iter.Size(); ++i)
       {
         if (i == (iter.Size() / 2))
@@ -68,7 +77,7 @@ CalculateIntensityPeak(const itk::Image<TPixel, VImageDimension>* itkImage, cons
         if (iterMask.GetPixel(i) > 0)
         {
           ++localCount;
-          localMean += params.quantifier->IntensityToIndex(iter.GetPixel(i)) + 1;
+          localMean += binIndexToIndex(iter.GetPixel(i)) + 1;
         }
       }
       if (localCount > 0)
@@ -176,6 +185,7 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFNeighbourhoodGreyTone
   GIFNeighbourhoodGreyToneDifferenceParameter params;
   params.Range = GetRange();
   params.quantifier = GetQuantifier();
+  params.quantizedImage = GetQuantizedImage(image, GetQuantifier());
   params.id = this->CreateTemplateFeatureID();
 
   AccessByItk_3(image, CalculateIntensityPeak, mask, params, featureList);
@@ -35,6 +35,7 @@ struct GIFNeighbouringGreyLevelDependenceFeatureConfiguration
   double MinimumIntensity;
   double MaximumIntensity;
   int Bins;
+  mitk::Image::ConstPointer QuantizedImage;
   mitk::FeatureID id;
 };
 
@@ -195,16 +196,16 @@ double mitk::NGLDMMatrixHolder::IndexToMaxIntensity(int index)
   return m_MinimumRange + (index + 1) * m_Stepsize;
 }
 
-template<typename TPixel, unsigned int VImageDimension>
+template<unsigned int VImageDimension>
 void
-CalculateNGLDMMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
+CalculateNGLDMMatrix(const itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension>* quantizedImage,
                     const itk::Image<unsigned short, VImageDimension>* mask,
                     int alpha,
                     int range,
                     unsigned int direction,
                     mitk::NGLDMMatrixHolder &holder)
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
   typedef itk::ConstNeighborhoodIterator<ImageType> ShapeIterType;
   typedef itk::ConstNeighborhoodIterator<MaskImageType> ShapeMaskIterType;
@@ -222,7 +223,7 @@ CalculateNGLDMMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
     radius[direction - 2] = 0;
   }
 
-  ShapeIterType imageIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
+  ShapeIterType imageIter(radius, quantizedImage, quantizedImage->GetLargestPossibleRegion());
   ShapeMaskIterType maskIter(radius, mask, mask->GetLargestPossibleRegion());
 
   auto region = mask->GetLargestPossibleRegion();
@@ -235,9 +236,9 @@ CalculateNGLDMMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
     int sameValues = 0;
     bool completeNeighbourhood = true;
 
-    int i = holder.IntensityToIndex(imageIter.GetCenterPixel());
+    int i = imageIter.GetCenterPixel();
 
-    if ((imageIter.GetCenterPixel() != imageIter.GetCenterPixel()) ||
+    if ((i == mitk::AbstractGlobalImageFeature::InvalidBinIndex) ||
       (maskIter.GetCenterPixel() < 1))
     {
       ++imageIter;
@@ -257,15 +258,14 @@ CalculateNGLDMMatrix(const itk::Image<TPixel, VImageDimension>* itkImage,
         continue;
       }
       bool isInBounds;
-      auto jIntensity = imageIter.GetPixel(position, isInBounds);
+      int j = imageIter.GetPixel(position, isInBounds);
       auto jMask = maskIter.GetPixel(position, isInBounds);
-      if (jMask < 1 || (jIntensity != jIntensity) || ( ! isInBounds))
+      if (jMask < 1 || (j == mitk::AbstractGlobalImageFeature::InvalidBinIndex) || ( ! isInBounds))
       {
         completeNeighbourhood = false;
         continue;
       }
 
-      int j = holder.IntensityToIndex(jIntensity);
       holder.m_NumberOfNeighbourVoxels += 1;
       if (std::abs(i - j) <= alpha)
       {
@@ -391,9 +391,10 @@ void LocalCalculateFeatures(
 
 template<typename TPixel, unsigned int VImageDimension>
 void
-CalculateCoocurenceFeatures(const itk::Image<TPixel, VImageDimension>* itkImage, const mitk::Image* mask, mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType & featureList, GIFNeighbouringGreyLevelDependenceFeatureConfiguration config)
+CalculateCoocurenceFeatures(const itk::Image<TPixel, VImageDimension>*, const mitk::Image* mask, mitk::GIFNeighbouringGreyLevelDependenceFeature::FeatureListType & featureList, GIFNeighbouringGreyLevelDependenceFeatureConfiguration config)
 {
   typedef itk::Image<unsigned short, VImageDimension> MaskType;
+  typedef itk::Image<mitk::AbstractGlobalImageFeature::QuantizedPixelType, VImageDimension> QuantizedImageType;
 
   double rangeMin = config.MinimumIntensity;
   double rangeMax = config.MaximumIntensity;
@@ -402,6 +403,9 @@ CalculateCoocurenceFeatures(const itk::Image<TPixel, VImageDimension>* itkImage,
   typename MaskType::Pointer maskImage = MaskType::New();
   mitk::CastToItkImage(mask, maskImage);
 
+  typename QuantizedImageType::Pointer quantizedImage = QuantizedImageType::New();
+  mitk::CastToItkImage(config.QuantizedImage, quantizedImage);
+
   std::vector<mitk::NGLDMMatrixFeatures> resultVector;
   int numberofDependency = 37;
   if (VImageDimension == 2)
@@ -409,7 +413,7 @@ CalculateCoocurenceFeatures(const itk::Image<TPixel, VImageDimension>* itkImage,
 
   mitk::NGLDMMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins, numberofDependency);
   mitk::NGLDMMatrixFeatures overallFeature;
-  CalculateNGLDMMatrix<TPixel, VImageDimension>(itkImage, maskImage, config.alpha, config.range, config.direction, holderOverall);
+  CalculateNGLDMMatrix<VImageDimension>(quantizedImage, maskImage, config.alpha, config.range, config.direction, holderOverall);
   LocalCalculateFeatures(holderOverall, overallFeature);
 
   MatrixFeaturesTo(overallFeature, config, featureList);
@@ -452,6 +456,7 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFNeighbouringGreyLevel
   FeatureListType featureList;
 
   this->InitializeQuantifier(image, mask);
+  auto quantizedImage = GetQuantizedImage(image, GetQuantifier());
   for (const auto& range : m_Ranges)
   {
     MITK_INFO << "Start calculating NGLD with range " << range << "....";
@@ -463,6 +468,7 @@ mitk::AbstractGlobalImageFeature::FeatureListType mitk::GIFNeighbouringGreyLevel
     config.MinimumIntensity = GetQuantifier()->GetMinimum();
     config.MaximumIntensity = GetQuantifier()->GetMaximum();
     config.Bins = GetQuantifier()->GetBins();
+    config.QuantizedImage = quantizedImage;
 
     config.id = this->CreateTemplateFeatureID(std::to_string(range), { {GetOptionPrefix() + "::range", range} });
 
@@ -0,0 +1,570 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkGlobalImageFeaturesBatch.h>
+
+#include <mitkConvert2Dto3DImageFilter.h>
+#include <mitkExceptionMacro.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkIOUtil.h>
+#include <mitkITKImageImport.h>
+
+#include <itkImageDuplicator.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkNearestNeighborInterpolateImageFunction.h>
+#include <itkResampleImageFilter.h>
+#include <itksys/SystemTools.hxx>
+
+#include <iostream>
+#include <locale>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+
+namespace
+{
+  const std::string EndOfMeasurement = "EndOfMeasurement";
+
+  template <class charT>
+  class punct_facet : public std::numpunct<charT> {
+  public:
+    punct_facet(charT sep) :
+      m_Sep(sep)
+    {
+
+    }
+  protected:
+    charT do_decimal_point() const override { return m_Sep; }
+  private:
+    charT m_Sep;
+  };
+
+  std::string Trim(const std::string& value)
+  {
+    auto first = value.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+      return "";
+    auto last = value.find_last_not_of(" \t\r");
+    return value.substr(first, last - first + 1);
+  }
+
+  /** Unlike mitk::cl::splitString, this keeps empty columns and whitespace within paths. */
+  std::vector<std::string> SplitColumns(const std::string& line, char delimiter)
+  {
+    std::vector<std::string> columns;
+    std::stringstream ss(line);
+    std::string column;
+    while (std::getline(ss, column, delimiter))
+    {
+      columns.push_back(column);
+    }
+    return columns;
+  }
+
+  bool IsHeader(const std::string& line, const std::string& separator)
+  {
+    return line.compare(0, 7, "CaseID" + separator) == 0;
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void ResampleImage(const itk::Image<TPixel, VImageDimension>* itkImage, float resolution, mitk::Image::Pointer& newImage)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::ResampleImageFilter<ImageType, ImageType> ResampleFilterType;
+
+    typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+    auto spacing = itkImage->GetSpacing();
+    auto size = itkImage->GetLargestPossibleRegion().GetSize();
+
+    for (unsigned int i = 0; i < VImageDimension; ++i)
+    {
+      size[i] = size[i] / (1.0*resolution)*(1.0*spacing[i])+1.0;
+    }
+    spacing.Fill(resolution);
+
+    resampler->SetInput(itkImage);
+    resampler->SetSize(size);
+    resampler->SetOutputSpacing(spacing);
+    resampler->SetOutputOrigin(itkImage->GetOrigin());
+    resampler->SetOutputDirection(itkImage->GetDirection());
+    resampler->Update();
+
+    newImage->InitializeByItk(resampler->GetOutput());
+    mitk::GrabItkImageMemory(resampler->GetOutput(), newImage);
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void CreateNoNaNMask(const itk::Image<TPixel, VImageDimension>* itkValue, const mitk::Image* mask, mitk::Image::Pointer& newMask)
+  {
+    typedef itk::Image< TPixel, VImageDimension>                 LFloatImageType;
+    typedef itk::Image< unsigned short, VImageDimension>          LMaskImageType;
+    typename LMaskImageType::Pointer itkMask = LMaskImageType::New();
+
+    mitk::CastToItkImage(mask, itkMask);
+
+    typedef itk::ImageDuplicator< LMaskImageType > DuplicatorType;
+    typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
+    duplicator->SetInputImage(itkMask);
+    duplicator->Update();
+
+    auto tmpMask = duplicator->GetOutput();
+
+    itk::ImageRegionConstIterator<LMaskImageType> mask1Iter(itkMask, itkMask->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<LMaskImageType> mask2Iter(tmpMask, tmpMask->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<LFloatImageType> imageIter(itkValue, itkValue->GetLargestPossibleRegion());
+    while (!mask1Iter.IsAtEnd())
+    {
+      mask2Iter.Set(0);
+      if (mask1Iter.Value() > 0)
+      {
+        // Is not NaN
+        if (imageIter.Value() == imageIter.Value())
+        {
+          mask2Iter.Set(1);
+        }
+      }
+      ++mask1Iter;
+      ++mask2Iter;
+      ++imageIter;
+    }
+
+    newMask->InitializeByItk(tmpMask);
+    mitk::GrabItkImageMemory(tmpMask, newMask);
+  }
+
+  template<typename TPixel, unsigned int VImageDimension>
+  void ResampleMask(const itk::Image<TPixel, VImageDimension>* itkMoving, const mitk::Image* ref, mitk::Image::Pointer& newMask)
+  {
+    typedef itk::Image< TPixel, VImageDimension>          LMaskImageType;
+    typedef itk::NearestNeighborInterpolateImageFunction< LMaskImageType> NearestNeighborInterpolateImageFunctionType;
+    typedef itk::ResampleImageFilter<LMaskImageType, LMaskImageType> ResampleFilterType;
+
+    typename NearestNeighborInterpolateImageFunctionType::Pointer nn_interpolator = NearestNeighborInterpolateImageFunctionType::New();
+    typename LMaskImageType::Pointer itkRef = LMaskImageType::New();
+    mitk::CastToItkImage(ref, itkRef);
+
+    typename ResampleFilterType::Pointer resampler = ResampleFilterType::New();
+    resampler->SetInput(itkMoving);
+    resampler->SetReferenceImage(itkRef);
+    resampler->UseReferenceImageOn();
+    resampler->SetInterpolator(nn_interpolator);
+    resampler->Update();
+
+    newMask->InitializeByItk(resampler->GetOutput());
+    mitk::GrabItkImageMemory(resampler->GetOutput(), newMask);
+  }
+
+  mitk::Image::Pointer ConvertTo3D(mitk::Image* image)
+  {
+    auto filter = mitk::Convert2Dto3DImageFilter::New();
+    filter->SetInput(image);
+    filter->Update();
+    return filter->GetOutput();
+  }
+}
+
+std::vector<mitk::cl::GlobalImageFeaturesBatchCase> mitk::cl::ReadGlobalImageFeaturesBatch(const std::string& manifestPath)
+{
+  std::ifstream manifest(manifestPath);
+  if (!manifest.is_open())
+  {
+    mitkThrow() << "Could not open batch manifest " << manifestPath;
+  }
+
+  std::vector<GlobalImageFeaturesBatchCase> cases;
+  std::set<std::string> caseIDs;
+  std::string line;
+  unsigned int lineNumber = 0;
+  while (std::getline(manifest, line))
+  {
+    ++lineNumber;
+    line = Trim(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    auto columns = SplitColumns(line, ';');
+    if (columns.size() < 3)
+    {
+      mitkThrow() << "Line " << lineNumber << " of batch manifest " << manifestPath << " does not contain CaseID, Image and Mask.";
+    }
+
+    GlobalImageFeaturesBatchCase batchCase;
+    batchCase.caseID = Trim(columns[0]);
+    batchCase.imagePath = Trim(columns[1]);
+    batchCase.maskPath = Trim(columns[2]);
+    if (columns.size() > 3)
+    {
+      batchCase.morphMaskPath = Trim(columns[3]);
+    }
+
+    if (!caseIDs.insert(batchCase.caseID).second)
+    {
+      mitkThrow() << "Case ID " << batchCase.caseID << " is used more than once in batch manifest " << manifestPath;
+    }
+    cases.push_back(batchCase);
+  }
+  return cases;
+}
+
+std::vector<std::vector<mitk::cl::GlobalImageFeaturesBatchCase>> mitk::cl::GroupGlobalImageFeaturesBatchByImage(const std::vector<GlobalImageFeaturesBatchCase>& cases)
+{
+  std::vector<std::vector<GlobalImageFeaturesBatchCase>> groups;
+  std::map<std::string, std::size_t> groupOfImage;
+  for (const auto& batchCase : cases)
+  {
+    auto iter = groupOfImage.find(batchCase.imagePath);
+    if (iter == groupOfImage.end())
+    {
+      iter = groupOfImage.emplace(batchCase.imagePath, groups.size()).first;
+      groups.emplace_back();
+    }
+    groups[iter->second].push_back(batchCase);
+  }
+  return groups;
+}
+
+mitk::cl::GlobalImageFeaturesBatchWriter::GlobalImageFeaturesBatchWriter(const std::string& outputPath) :
+  m_Separator(";"),
+  m_HeaderWritten(false),
+  m_UseSpecialDecimalPoint(false),
+  m_DecimalPoint('.')
+{
+  std::vector<std::string> completeLines;
+  bool removeLines = false;
+  {
+    std::ifstream existingOutput(outputPath);
+    std::string line;
+    while (std::getline(existingOutput, line))
+    {
+      // Rows without end marker were interrupted while writing and are calculated again
+      auto columns = SplitColumns(line, m_Separator[0]);
+      bool isComplete = columns.size() > 1 && columns.back() == EndOfMeasurement;
+      if (IsHeader(line, m_Separator))
+      {
+        isComplete = isComplete && !m_HeaderWritten && columns.size() >= 4;
+        if (isComplete)
+        {
+          m_FeatureNames.assign(columns.begin() + 3, columns.end() - 1);
+          m_HeaderWritten = true;
+        }
+      }
+      else
+      {
+        isComplete = isComplete && m_HeaderWritten;
+        if (isComplete)
+        {
+          m_FinishedCases.insert(columns.front());
+        }
+      }
+
+      if (isComplete)
+      {
+        completeLines.push_back(line);
+      }
+      removeLines = removeLines || !isComplete || existingOutput.eof();
+    }
+  }
+
+  if (removeLines)
+  {
+    // Replace the output at once, so that complete rows are not lost if the run is interrupted now
+    const std::string tmpPath = outputPath + ".tmp";
+    {
+      std::ofstream cleanedOutput(tmpPath, std::ios::trunc);
+      for (const auto& line : completeLines)
+      {
+        cleanedOutput << line << std::endl;
+      }
+      if (!cleanedOutput.good())
+      {
+        mitkThrow() << "Could not write batch output " << tmpPath;
+      }
+    }
+    if (!itksys::SystemTools::RenameFile(tmpPath, outputPath))
+    {
+      mitkThrow() << "Could not replace batch output " << outputPath;
+    }
+  }
+
+  m_Output.open(outputPath, std::ios::app);
+  if (!m_Output.is_open())
+  {
+    mitkThrow() << "Could not open batch output " << outputPath;
+  }
+}
+
+mitk::cl::GlobalImageFeaturesBatchWriter::~GlobalImageFeaturesBatchWriter()
+{
+  m_Output.close();
+}
+
+void mitk::cl::GlobalImageFeaturesBatchWriter::SetDecimalPoint(char decimal)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_UseSpecialDecimalPoint = true;
+  m_DecimalPoint = decimal;
+}
+
+bool mitk::cl::GlobalImageFeaturesBatchWriter::IsCaseFinished(const std::string& caseID) const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_FinishedCases.count(caseID) > 0;
+}
+
+std::size_t mitk::cl::GlobalImageFeaturesBatchWriter::GetNumberOfFinishedCases() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_FinishedCases.size();
+}
+
+void mitk::cl::GlobalImageFeaturesBatchWriter::AddCase(const GlobalImageFeaturesBatchCase& batchCase, const mitk::AbstractGlobalImageFeature::FeatureListType& stats)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  std::ostringstream row;
+  if (m_UseSpecialDecimalPoint)
+  {
+    row.imbue(std::locale(std::cout.getloc(), new punct_facet<char>(m_DecimalPoint)));
+  }
+
+  std::vector<std::string> featureNames;
+  for (const auto& stat : stats)
+  {
+    featureNames.push_back(stat.first.legacyName);
+  }
+
+  if (!m_HeaderWritten)
+  {
+    row << "CaseID" << m_Separator << "Image" << m_Separator << "Mask" << m_Separator;
+    for (const auto& name : featureNames)
+    {
+      row << name << m_Separator;
+    }
+    row << EndOfMeasurement << m_Separator << std::endl;
+  }
+  else if (featureNames != m_FeatureNames)
+  {
+    mitkThrow() << "Features of case " << batchCase.caseID << " do not match the header of the batch output ("
+      << featureNames.size() << " instead of " << m_FeatureNames.size() << " features).";
+  }
+
+  row << batchCase.caseID << m_Separator << batchCase.imagePath << m_Separator << batchCase.maskPath << m_Separator;
+  for (const auto& stat : stats)
+  {
+    row << stat.second << m_Separator;
+  }
+  row << EndOfMeasurement << m_Separator << std::endl;
+
+  // Write the row at once and flush it, so that it is complete if the run is interrupted afterwards
+  m_Output << row.str();
+  m_Output.flush();
+  m_FinishedCases.insert(batchCase.caseID);
+  if (!m_HeaderWritten)
+  {
+    m_FeatureNames = featureNames;
+    m_HeaderWritten = true;
+  }
+}
+
+mitk::Image::Pointer mitk::cl::ShareImageWithOwnGeometry(const mitk::Image* image)
+{
+  auto sharedImage = mitk::Image::New();
+  sharedImage->Initialize(image->GetPixelType(), image->GetDimension(), image->GetDimensions());
+  sharedImage->SetClonedTimeGeometry(image->GetTimeGeometry());
+
+  mitk::ImageReadAccessor accessor(image);
+  sharedImage->SetImportChannel(const_cast<void*>(accessor.GetData()), 0, mitk::Image::ReferenceMemory);
+  // The referenced memory stays valid as long as the data of the shared image is used
+  sharedImage->GetChannelData(0)->SetMemoryOwner(std::make_shared<mitk::Image::ConstPointer>(image));
+  return sharedImage;
+}
+
+bool mitk::cl::PrepareGlobalImageFeaturesImageAndMask(const GlobalImageFeaturesParameter& param, mitk::Image::Pointer& image,
+  mitk::Image::Pointer& mask, std::ostream& log, GlobalImageFeaturesPreparedImages* preparedImages)
+{
+  log << " Check for Dimensions -";
+  bool convertImage = false;
+  if ((image->GetDimension() != mask->GetDimension()))
+  {
+    MITK_INFO << "Dimension of image does not match. ";
+    MITK_INFO << "Correct one image, may affect the result";
+    convertImage = image->GetDimension() == 2;
+    if (mask->GetDimension() == 2)
+    {
+      mask = ConvertTo3D(mask);
+    }
+  }
+
+  log << " Check for Resolution -";
+  mitk::Image::Pointer preparedImage;
+  if (nullptr != preparedImages && preparedImages->count(convertImage) > 0)
+  {
+    preparedImage = preparedImages->at(convertImage);
+  }
+  else
+  {
+    preparedImage = convertImage ? ConvertTo3D(image) : image;
+    if (param.resampleToFixIsotropic)
+    {
+      mitk::Image::Pointer newImage = mitk::Image::New();
+      AccessByItk_2(preparedImage, ResampleImage, param.resampleResolution, newImage);
+      preparedImage = newImage;
+    }
+    if (nullptr != preparedImages)
+    {
+      (*preparedImages)[convertImage] = preparedImage;
+    }
+  }
+  image = preparedImage;
+
+  log << " Resample if required -";
+  if (param.resampleMask)
+  {
+    mitk::Image::Pointer newMaskImage = mitk::Image::New();
+    AccessByItk_2(mask, ResampleMask, image.GetPointer(), newMaskImage);
+    mask = newMaskImage;
+  }
+
+  if ( ! mitk::Equal(mask->GetGeometry(0)->GetOrigin(), image->GetGeometry(0)->GetOrigin()))
+  {
+    MITK_INFO << "Not equal Origins";
+    if (param.ensureSameSpace)
+    {
+      MITK_INFO << "Warning!";
+      MITK_INFO << "The origin of the input image and the mask do not match. They are";
+      MITK_INFO << "now corrected. Please check to make sure that the images still match";
+      if (image == preparedImage)
+      {
+        image = ShareImageWithOwnGeometry(preparedImage);
+      }
+      image->GetGeometry(0)->SetOrigin(mask->GetGeometry(0)->GetOrigin());
+    } else
+    {
+      return false;
+    }
+  }
+
+  log << " Check for Equality -";
+  if ( ! mitk::Equal(mask->GetGeometry(0)->GetSpacing(), image->GetGeometry(0)->GetSpacing()))
+  {
+    MITK_INFO << "Not equal Spacing";
+    if (param.ensureSameSpace)
+    {
+      MITK_INFO << "Warning!";
+      MITK_INFO << "The spacing of the mask was set to match the spacing of the input image.";
+      MITK_INFO << "This might cause unintended spacing of the mask image";
+      if (image == preparedImage)
+      {
+        image = ShareImageWithOwnGeometry(preparedImage);
+      }
+      image->GetGeometry(0)->SetSpacing(mask->GetGeometry(0)->GetSpacing());
+    } else
+    {
+      MITK_INFO << "The spacing of the mask and the input images is not equal.";
+      MITK_INFO << "Terminating the programm. You may use the '-fi' option";
+      return false;
+    }
+  }
+  return true;
+}
+
+mitk::Image::Pointer mitk::cl::CreateGlobalImageFeaturesNoNaNMask(const mitk::Image* image, const mitk::Image* mask)
+{
+  mitk::Image::Pointer maskNoNaN = mitk::Image::New();
+  AccessByItk_2(image, CreateNoNaNMask, mask, maskNoNaN);
+  return maskNoNaN;
+}
+
+unsigned int mitk::cl::CalculateGlobalImageFeaturesBatchGroup(const std::vector<GlobalImageFeaturesBatchCase>& group,
+  const GlobalImageFeaturesParameter& param, const std::vector<mitk::AbstractGlobalImageFeature::Pointer>& features,
+  GlobalImageFeaturesBatchWriter& writer, std::mutex& ioMutex)
+{
+  if (group.empty())
+  {
+    return 0;
+  }
+
+  mitk::Image::Pointer loadedImage;
+  try
+  {
+    std::lock_guard<std::mutex> lock(ioMutex);
+    loadedImage = mitk::IOUtil::Load<mitk::Image>(group.front().imagePath);
+  }
+  catch (const std::exception& e)
+  {
+    MITK_ERROR << "Could not load image " << group.front().imagePath << ": " << e.what();
+    return static_cast<unsigned int>(group.size());
+  }
+
+  // Converted and resampled versions of the image are shared by all cases of the group
+  GlobalImageFeaturesPreparedImages preparedImages;
+  std::ostream noLog(nullptr);
+  unsigned int failedCases = 0;
+  // the quantized images are shared by the cases of the group and released once the group is finished
+  std::set<const mitk::Image*> processedImages;
+
+  for (const auto& batchCase : group)
+  {
+    try
+    {
+      mitk::Image::Pointer mask;
+      mitk::Image::Pointer morphMask;
+      {
+        std::lock_guard<std::mutex> lock(ioMutex);
+        mask = mitk::IOUtil::Load<mitk::Image>(batchCase.maskPath);
+        if (!batchCase.morphMaskPath.empty())
+        {
+          morphMask = mitk::IOUtil::Load<mitk::Image>(batchCase.morphMaskPath);
+        }
+      }
+      if (morphMask.IsNull())
+      {
+        morphMask = mask;
+      }
+
+      mitk::Image::Pointer image = loadedImage;
+      if (!PrepareGlobalImageFeaturesImageAndMask(param, image, mask, noLog, &preparedImages))
+      {
+        MITK_ERROR << "Image and mask of case " << batchCase.caseID << " do not match.";
+        ++failedCases;
+        continue;
+      }
+
+      auto maskNoNaN = CreateGlobalImageFeaturesNoNaNMask(image, mask);
+      processedImages.insert(image);
+
+      mitk::AbstractGlobalImageFeature::FeatureListType stats;
+      for (auto cFeature : features)
+      {
+        cFeature->SetMorphMask(morphMask);
+        cFeature->CalculateAndAppendFeatures(image, mask, maskNoNaN, stats, !param.calculateAllFeatures);
+      }
+      writer.AddCase(batchCase, stats);
+      MITK_INFO << "Finished case " << batchCase.caseID;
+    }
+    catch (const std::exception& e)
+    {
+      MITK_ERROR << "Could not process case " << batchCase.caseID << ": " << e.what();
+      ++failedCases;
+    }
+  }
+
+  for (auto processedImage : processedImages)
+  {
+    mitk::AbstractGlobalImageFeature::ClearQuantifierCache(processedImage);
+  }
+  return failedCases;
+}
@@ -29,13 +29,15 @@ static bool fileExists(const std::string& filename)
 
 void mitk::cl::GlobalImageFeaturesParameter::AddParameter(mitkCommandLineParser &parser)
 {
-  // Required Parameter
-  parser.addArgument("image",   "i", mitkCommandLineParser::Image, "Input Image", "Path to the input image file", us::Any(), false, false, false, mitkCommandLineParser::Input);
-  parser.addArgument("mask", "m", mitkCommandLineParser::Image, "Input Mask", "Path to the mask Image that specifies the area over for the statistic (Values = 1)", us::Any(), false, false, false, mitkCommandLineParser::Input);
+  // Required Parameter (image and mask are given by the manifest in batch mode)
+  parser.addArgument("image",   "i", mitkCommandLineParser::Image, "Input Image", "Path to the input image file", us::Any(), true, false, false, mitkCommandLineParser::Input);
+  parser.addArgument("mask", "m", mitkCommandLineParser::Image, "Input Mask", "Path to the mask Image that specifies the area over for the statistic (Values = 1)", us::Any(), true, false, false, mitkCommandLineParser::Input);
   parser.addArgument("morph-mask", "morph", mitkCommandLineParser::Image, "Morphological Image Mask", "Path to the mask Image that specifies the area over for the statistic (Values = 1)", us::Any(), true, false, false, mitkCommandLineParser::Input);
   parser.addArgument("output",  "o", mitkCommandLineParser::File, "Output text file", "Path to output file. The output statistic is appended to this file.", us::Any(), false, false, false, mitkCommandLineParser::Output);
 
   // Optional Parameter
+  parser.addArgument("batch", "batch", mitkCommandLineParser::File, "Case manifest", "Path to a manifest with one case per line (CaseID;Image;Mask[;MorphMask]). All cases are processed by a single call; cases that are already contained in the output are skipped.", us::Any(), true, false, false, mitkCommandLineParser::Input);
+  parser.addArgument("batch-threads", "batch-threads", mitkCommandLineParser::Int, "Int", "Number of cases that are processed in parallel in batch mode. Default: number of cores.", us::Any());
   parser.addArgument("xml-output", "x", mitkCommandLineParser::File, "XML result file", "Path where the results should be stored as XML result file. ", us::Any(), true, false, false, mitkCommandLineParser::Input);
   parser.addArgument("logfile",    "log",         mitkCommandLineParser::File, "Text Logfile", "Path to the location of the target log file. ", us::Any(), true, false, false, mitkCommandLineParser::Input);
   parser.addArgument("save-image", "save-image",  mitkCommandLineParser::File, "Output Image", "If spezified, the image that is used for the analysis is saved to this location.", us::Any(), true, false, false, mitkCommandLineParser::Output);
@@ -75,10 +77,22 @@ void mitk::cl::GlobalImageFeaturesParameter::ParseFileLocations(std::map<std::st
   //
   // Read input and output file informations
   //
-  imagePath = parsedArgs["image"].ToString();
-  maskPath = parsedArgs["mask"].ToString();
+  imagePath = parsedArgs.count("image") ? parsedArgs["image"].ToString() : "";
+  maskPath = parsedArgs.count("mask") ? parsedArgs["mask"].ToString() : "";
   outputPath = parsedArgs["output"].ToString();
 
+  useBatch = false;
+  batchThreads = 0;
+  if (parsedArgs.count("batch"))
+  {
+    useBatch = true;
+    batchPath = parsedArgs["batch"].ToString();
+  }
+  if (parsedArgs.count("batch-threads"))
+  {
+    batchThreads = us::any_cast<int>(parsedArgs["batch-threads"]);
+  }
+
   imageFolder = itksys::SystemTools::GetFilenamePath(imagePath);
   imageName = itksys::SystemTools::GetFilenameName(imagePath);
   maskFolder = itksys::SystemTools::GetFilenamePath(maskPath);
@@ -11,8 +11,10 @@ set(MODULE_TESTS
   mitkGIFLocalIntensityTest.cpp
   mitkGIFNeighbourhoodGreyToneDifferenceFeaturesTest.cpp
   mitkGIFNeighbouringGreyLevelDependenceFeatureTest.cpp
+  mitkGIFSharedQuantizationTest.cpp
   mitkGIFVolumetricDensityStatisticsTest.cpp
   mitkGIFVolumetricStatisticsTest.cpp
+  mitkGlobalImageFeaturesBatchTest.cpp
   #mitkSmoothedClassProbabilitesTest.cpp
   #mitkGlobalFeaturesTest.cpp
 )
@@ -23,6 +23,7 @@ class mitkGIFCooc2TestSuite : public mitk::TestFixture
 
   MITK_TEST(ImageDescription_PhantomTest_3D);
   MITK_TEST(ImageDescription_PhantomTest_2D);
+  MITK_TEST(MultipleRanges_SharedQuantifierTest);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -242,6 +243,51 @@ public:
     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SliceWise Mean Co-occurenced Based Features::Mean Second Row-Column Entropy with Large IBSI Phantom Image", 2.24761, results["SliceWise Mean Co-occurenced Based Features::Mean Second Row-Column Entropy"], 0.001);
   }
 
+
+  void MultipleRanges_SharedQuantifierTest()
+  {
+    auto createCalculator = []()
+    {
+      mitk::GIFCooccurenceMatrix2::Pointer featureCalculator = mitk::GIFCooccurenceMatrix2::New();
+      featureCalculator->SetUseBinsize(true);
+      featureCalculator->SetBinsize(1.0);
+      featureCalculator->SetUseMinimumIntensity(true);
+      featureCalculator->SetUseMaximumIntensity(true);
+      featureCalculator->SetMinimumIntensity(0.5);
+      featureCalculator->SetMaximumIntensity(6.5);
+      return featureCalculator;
+    };
+
+    auto combinedCalculator = createCalculator();
+    combinedCalculator->SetRanges({ 1.0, 2.0 });
+    auto combinedList = combinedCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    auto range1Calculator = createCalculator();
+    range1Calculator->SetRange(1.0);
+    auto range1List = range1Calculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    auto range2Calculator = createCalculator();
+    range2Calculator->SetRange(2.0);
+    auto range2List = range2Calculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+
+    CPPUNIT_ASSERT_MESSAGE("Quantifier is shared between feature instances with identical settings.",
+      combinedCalculator->GetQuantifier() == range1Calculator->GetQuantifier() && combinedCalculator->GetQuantifier() == range2Calculator->GetQuantifier());
+
+    auto separateList = range1List;
+    separateList.insert(separateList.end(), range2List.begin(), range2List.end());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("All ranges are calculated in one call.", separateList.size(), combinedList.size());
+    for (std::size_t i = 0; i < combinedList.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Features are identical to the separate calculation.", combinedList[i].first == separateList[i].first);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Feature values are identical to the separate calculation.", separateList[i].second, combinedList[i].second, 1e-9);
+    }
+
+    mitk::AbstractGlobalImageFeature::ClearQuantifierCache();
+    auto uncachedCalculator = createCalculator();
+    uncachedCalculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    CPPUNIT_ASSERT_MESSAGE("Quantifier is initialized again after clearing the cache.", uncachedCalculator->GetQuantifier() != range1Calculator->GetQuantifier());
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkGIFCooc2 )
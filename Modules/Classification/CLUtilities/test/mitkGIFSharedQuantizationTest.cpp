@@ -0,0 +1,136 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+
+#include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkGIFGreyLevelDistanceZone.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+#include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
+#include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+
+#include <map>
+
+class mitkGIFSharedQuantizationTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGIFSharedQuantizationTestSuite);
+
+  MITK_TEST(TextureFeatures_QuantizeOnceTest);
+  MITK_TEST(ClearQuantifierCache_OfImage_KeepsOtherImages);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Large;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
+
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> CreateCalculators()
+  {
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> calculators;
+    calculators.push_back(mitk::GIFCooccurenceMatrix2::New().GetPointer());
+    calculators.push_back(mitk::GIFGreyLevelSizeZone::New().GetPointer());
+    calculators.push_back(mitk::GIFGreyLevelDistanceZone::New().GetPointer());
+    calculators.push_back(mitk::GIFNeighbouringGreyLevelDependenceFeature::New().GetPointer());
+    calculators.push_back(mitk::GIFNeighbourhoodGreyToneDifferenceFeatures::New().GetPointer());
+
+    for (auto& calculator : calculators)
+    {
+      calculator->SetUseBinsize(true);
+      calculator->SetBinsize(1.0);
+      calculator->SetUseMinimumIntensity(true);
+      calculator->SetUseMaximumIntensity(true);
+      calculator->SetMinimumIntensity(0.5);
+      calculator->SetMaximumIntensity(6.5);
+    }
+    return calculators;
+  }
+
+public:
+
+  void setUp(void) override
+  {
+    mitk::AbstractGlobalImageFeature::ClearQuantifierCache();
+    m_IBSI_Phantom_Image_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd"));
+    m_IBSI_Phantom_Mask_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd"));
+  }
+
+  void tearDown(void) override
+  {
+    mitk::AbstractGlobalImageFeature::ClearQuantifierCache();
+  }
+
+  void ClearQuantifierCache_OfImage_KeepsOtherImages()
+  {
+    auto calculator = this->CreateCalculators().front();
+    calculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large);
+    auto otherImage = m_IBSI_Phantom_Image_Large->Clone();
+
+    auto quantizedImage = mitk::AbstractGlobalImageFeature::GetQuantizedImage(m_IBSI_Phantom_Image_Large, calculator->GetQuantifier());
+    auto otherQuantizedImage = mitk::AbstractGlobalImageFeature::GetQuantizedImage(otherImage, calculator->GetQuantifier());
+
+    mitk::AbstractGlobalImageFeature::ClearQuantifierCache(m_IBSI_Phantom_Image_Large);
+
+    CPPUNIT_ASSERT_MESSAGE("The quantized image of the cleared image is computed again.",
+      quantizedImage != mitk::AbstractGlobalImageFeature::GetQuantizedImage(m_IBSI_Phantom_Image_Large, calculator->GetQuantifier()));
+    CPPUNIT_ASSERT_MESSAGE("The quantized image of another image is kept.",
+      otherQuantizedImage == mitk::AbstractGlobalImageFeature::GetQuantizedImage(otherImage, calculator->GetQuantifier()));
+  }
+
+  void TextureFeatures_QuantizeOnceTest()
+  {
+    // All feature classes of one run share a single quantized image
+    mitk::Image::ConstPointer quantizedImage;
+    std::map<std::string, double> sharedResults;
+    for (auto& calculator : this->CreateCalculators())
+    {
+      for (const auto& valuePair : calculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large))
+        sharedResults[valuePair.first.featureClass + "::" + valuePair.first.name] = valuePair.second;
+
+      auto calculatorQuantizedImage = mitk::AbstractGlobalImageFeature::GetQuantizedImage(m_IBSI_Phantom_Image_Large, calculator->GetQuantifier());
+      if (quantizedImage.IsNull())
+        quantizedImage = calculatorQuantizedImage;
+      CPPUNIT_ASSERT_MESSAGE("Feature classes with identical quantifier settings share the quantized image.", quantizedImage == calculatorQuantizedImage);
+    }
+
+    // Each feature class on its own, quantizing the image again
+    std::map<std::string, double> separateResults;
+    for (auto& calculator : this->CreateCalculators())
+    {
+      mitk::AbstractGlobalImageFeature::ClearQuantifierCache();
+      for (const auto& valuePair : calculator->CalculateFeatures(m_IBSI_Phantom_Image_Large, m_IBSI_Phantom_Mask_Large))
+        separateResults[valuePair.first.featureClass + "::" + valuePair.first.name] = valuePair.second;
+    }
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Shared and separate quantization calculate the same features.", separateResults.size(), sharedResults.size());
+    for (const auto& result : separateResults)
+    {
+      CPPUNIT_ASSERT_MESSAGE(result.first + " is calculated with shared quantization.", sharedResults.find(result.first) != sharedResults.end());
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(result.first + " is identical with shared quantization.", result.second, sharedResults[result.first], 1e-9);
+    }
+
+    // Reference values of the feature class tests (IBSI, 3D Comb)
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Joint Maximum", 0.509, sharedResults["Co-occurenced Based Features::Overall Joint Maximum"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Co-occurenced Based Features::Overall Contrast", 5.118, sharedResults["Co-occurenced Based Features::Overall Contrast"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Grey Level Size Zone::Small Zone Emphasis", 0.255, sharedResults["Grey Level Size Zone::Small Zone Emphasis"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Grey Level Size Zone::High Grey Level Emphasis", 15.6, sharedResults["Grey Level Size Zone::High Grey Level Emphasis"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Grey Level Distance Zone::Low Grey Level Emphasis", 0.253, sharedResults["Grey Level Distance Zone::Low Grey Level Emphasis"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Grey Level Distance Zone::High Grey Level Emphasis", 15.6, sharedResults["Grey Level Distance Zone::High Grey Level Emphasis"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbouring Grey Level Dependence::Low Dependence Emphasis", 0.045, sharedResults["Neighbouring Grey Level Dependence::Low Dependence Emphasis"], 0.001);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbouring Grey Level Dependence::High Grey Level Count Emphasis", 7.66, sharedResults["Neighbouring Grey Level Dependence::High Grey Level Count Emphasis"], 0.01);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Contrast", 0.584, sharedResults["Neighbourhood Grey Tone Difference::Contrast"], 0.01);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Neighbourhood Grey Tone Difference::Strength", 0.763, sharedResults["Neighbourhood Grey Tone Difference::Strength"], 0.01);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGIFSharedQuantization)
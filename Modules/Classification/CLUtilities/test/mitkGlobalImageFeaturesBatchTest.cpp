@@ -0,0 +1,366 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+
+#include <mitkGlobalImageFeaturesBatch.h>
+#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+class mitkGlobalImageFeaturesBatchTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGlobalImageFeaturesBatchTestSuite);
+
+  MITK_TEST(ReadManifest_Test);
+  MITK_TEST(ReadInvalidManifest_Test);
+  MITK_TEST(GroupByImage_Test);
+  MITK_TEST(ResumeOutput_Test);
+  MITK_TEST(MismatchingFeatures_Test);
+  MITK_TEST(PrepareSharedImage_Test);
+  MITK_TEST(CalculateGroup_Test);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::vector<std::string> m_TemporaryFiles;
+
+  std::string CreateFile(const std::string& content)
+  {
+    std::ofstream stream;
+    auto path = mitk::IOUtil::CreateTemporaryFile(stream, "batch-XXXXXX.csv");
+    stream << content;
+    stream.close();
+    m_TemporaryFiles.push_back(path);
+    return path;
+  }
+
+  mitk::AbstractGlobalImageFeature::FeatureListType CreateStats(double value)
+  {
+    mitk::FeatureID id;
+    id.featureClass = "Test";
+    id.name = "Value";
+    id.legacyName = "Test::Value";
+    return { std::make_pair(id, value) };
+  }
+
+  std::vector<std::string> ReadLines(const std::string& path)
+  {
+    std::ifstream stream(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(stream, line))
+    {
+      lines.push_back(line);
+    }
+    return lines;
+  }
+
+  std::vector<std::string> SplitRow(const std::string& row)
+  {
+    std::vector<std::string> columns;
+    std::stringstream ss(row);
+    std::string column;
+    while (std::getline(ss, column, ';'))
+    {
+      columns.push_back(column);
+    }
+    return columns;
+  }
+
+  mitk::Image::Pointer CreateImage(const mitk::Point3D& origin, double spacing)
+  {
+    unsigned int dimensions[3] = { 6, 6, 6 };
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    mitk::Vector3D spacingVector;
+    spacingVector.Fill(spacing);
+    image->GetGeometry()->SetSpacing(spacingVector);
+    image->GetGeometry()->SetOrigin(origin);
+
+    mitk::ImageWriteAccessor accessor(image);
+    auto data = static_cast<float*>(accessor.GetData());
+    for (unsigned int i = 0; i < dimensions[0] * dimensions[1] * dimensions[2]; ++i)
+    {
+      data[i] = i % 7;
+    }
+    return image;
+  }
+
+  mitk::cl::GlobalImageFeaturesParameter CreateParameter()
+  {
+    mitk::cl::GlobalImageFeaturesParameter param;
+    param.ensureSameSpace = false;
+    param.resampleMask = false;
+    param.resampleToFixIsotropic = false;
+    param.resampleResolution = 1.0;
+    param.calculateAllFeatures = true;
+    return param;
+  }
+
+public:
+
+  void tearDown() override
+  {
+    for (const auto& path : m_TemporaryFiles)
+    {
+      std::remove(path.c_str());
+    }
+    m_TemporaryFiles.clear();
+  }
+
+  void ReadManifest_Test()
+  {
+    auto path = CreateFile("# CaseID;Image;Mask\n"
+      "case1;/data/image 1.nrrd;/data/mask1.nrrd\n"
+      "\n"
+      "case2 ; /data/image2.nrrd ; /data/mask2.nrrd ; /data/morph2.nrrd\r\n");
+
+    auto cases = mitk::cl::ReadGlobalImageFeaturesBatch(path);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Comments and empty lines are ignored.", std::size_t(2), cases.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("case1"), cases[0].caseID);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Paths may contain spaces.", std::string("/data/image 1.nrrd"), cases[0].imagePath);
+    CPPUNIT_ASSERT(cases[0].morphMaskPath.empty());
+    CPPUNIT_ASSERT_EQUAL(std::string("case2"), cases[1].caseID);
+    CPPUNIT_ASSERT_EQUAL(std::string("/data/mask2.nrrd"), cases[1].maskPath);
+    CPPUNIT_ASSERT_EQUAL(std::string("/data/morph2.nrrd"), cases[1].morphMaskPath);
+  }
+
+  void ReadInvalidManifest_Test()
+  {
+    auto incompletePath = CreateFile("case1;/data/image1.nrrd\n");
+    CPPUNIT_ASSERT_THROW(mitk::cl::ReadGlobalImageFeaturesBatch(incompletePath), mitk::Exception);
+
+    auto duplicatePath = CreateFile("case1;/data/image1.nrrd;/data/mask1.nrrd\ncase1;/data/image1.nrrd;/data/mask2.nrrd\n");
+    CPPUNIT_ASSERT_THROW(mitk::cl::ReadGlobalImageFeaturesBatch(duplicatePath), mitk::Exception);
+  }
+
+  void GroupByImage_Test()
+  {
+    std::vector<mitk::cl::GlobalImageFeaturesBatchCase> cases = {
+      { "a", "image1", "mask1", "" },
+      { "b", "image2", "mask2", "" },
+      { "c", "image1", "mask3", "" } };
+
+    auto groups = mitk::cl::GroupGlobalImageFeaturesBatchByImage(cases);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), groups.size());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), groups[0].size());
+    CPPUNIT_ASSERT_EQUAL(std::string("a"), groups[0][0].caseID);
+    CPPUNIT_ASSERT_EQUAL(std::string("c"), groups[0][1].caseID);
+    CPPUNIT_ASSERT_EQUAL(std::string("b"), groups[1][0].caseID);
+  }
+
+  void ResumeOutput_Test()
+  {
+    auto path = CreateFile("");
+    {
+      mitk::cl::GlobalImageFeaturesBatchWriter writer(path);
+      CPPUNIT_ASSERT_EQUAL(std::size_t(0), writer.GetNumberOfFinishedCases());
+      writer.AddCase({ "case1", "image1", "mask1", "" }, CreateStats(1.5));
+      writer.AddCase({ "case2", "image1", "mask2", "" }, CreateStats(2.5));
+    }
+
+    // Simulate a run that was interrupted while writing the third row
+    {
+      std::ofstream stream(path, std::ios::app);
+      stream << "case3;image2;mask3;3.";
+    }
+
+    {
+      mitk::cl::GlobalImageFeaturesBatchWriter writer(path);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Complete rows are recognized as finished cases.", std::size_t(2), writer.GetNumberOfFinishedCases());
+      CPPUNIT_ASSERT(writer.IsCaseFinished("case1"));
+      CPPUNIT_ASSERT(writer.IsCaseFinished("case2"));
+      CPPUNIT_ASSERT_MESSAGE("Truncated rows are calculated again.", !writer.IsCaseFinished("case3"));
+      writer.AddCase({ "case3", "image2", "mask3", "" }, CreateStats(3.5));
+    }
+
+    auto lines = ReadLines(path);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Header, two rows and the resumed row are stored, the truncated row is removed.", std::size_t(4), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("CaseID;Image;Mask;Test::Value;EndOfMeasurement;"), lines[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("case1;image1;mask1;1.5;EndOfMeasurement;"), lines[1]);
+    CPPUNIT_ASSERT_EQUAL(std::string("case2;image1;mask2;2.5;EndOfMeasurement;"), lines[2]);
+    CPPUNIT_ASSERT_EQUAL(std::string("case3;image2;mask3;3.5;EndOfMeasurement;"), lines[3]);
+
+    mitk::cl::GlobalImageFeaturesBatchWriter resumedWriter(path);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), resumedWriter.GetNumberOfFinishedCases());
+  }
+
+  void MismatchingFeatures_Test()
+  {
+    auto path = CreateFile("");
+    {
+      mitk::cl::GlobalImageFeaturesBatchWriter writer(path);
+      writer.AddCase({ "case1", "image1", "mask1", "" }, CreateStats(1.5));
+
+      auto otherStats = CreateStats(2.5);
+      otherStats.front().first.legacyName = "Test::OtherValue";
+      CPPUNIT_ASSERT_THROW(writer.AddCase({ "case2", "image1", "mask2", "" }, otherStats), mitk::Exception);
+
+      auto moreStats = CreateStats(2.5);
+      moreStats.push_back(CreateStats(3.5).front());
+      CPPUNIT_ASSERT_THROW(writer.AddCase({ "case2", "image1", "mask2", "" }, moreStats), mitk::Exception);
+      CPPUNIT_ASSERT_MESSAGE("Cases with mismatching features are not finished.", !writer.IsCaseFinished("case2"));
+    }
+
+    // The header of a resumed output is used as well
+    {
+      mitk::cl::GlobalImageFeaturesBatchWriter writer(path);
+      auto otherStats = CreateStats(2.5);
+      otherStats.front().first.legacyName = "Test::OtherValue";
+      CPPUNIT_ASSERT_THROW(writer.AddCase({ "case2", "image1", "mask2", "" }, otherStats), mitk::Exception);
+      writer.AddCase({ "case2", "image1", "mask2", "" }, CreateStats(2.5));
+    }
+
+    auto lines = ReadLines(path);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Rows with mismatching features are not written.", std::size_t(3), lines.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("case2;image1;mask2;2.5;EndOfMeasurement;"), lines[2]);
+  }
+
+  void PrepareSharedImage_Test()
+  {
+    mitk::Point3D imageOrigin;
+    mitk::FillVector3D(imageOrigin, 0.0, 0.0, 0.0);
+    mitk::Point3D origin1;
+    mitk::FillVector3D(origin1, 1.0, 0.0, 0.0);
+    mitk::Point3D origin2;
+    mitk::FillVector3D(origin2, 0.0, 2.0, 0.0);
+
+    auto loadedImage = CreateImage(imageOrigin, 2.0);
+    auto param = CreateParameter();
+    param.ensureSameSpace = true;
+    param.resampleToFixIsotropic = true;
+
+    mitk::cl::GlobalImageFeaturesPreparedImages preparedImages;
+    std::ostream noLog(nullptr);
+
+    mitk::Image::Pointer image1 = loadedImage;
+    mitk::Image::Pointer mask1 = CreateImage(origin1, 1.0);
+    CPPUNIT_ASSERT(mitk::cl::PrepareGlobalImageFeaturesImageAndMask(param, image1, mask1, noLog, &preparedImages));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), preparedImages.size());
+    auto resampledImage = preparedImages.begin()->second;
+
+    mitk::Image::Pointer image2 = loadedImage;
+    mitk::Image::Pointer mask2 = CreateImage(origin2, 1.0);
+    CPPUNIT_ASSERT(mitk::cl::PrepareGlobalImageFeaturesImageAndMask(param, image2, mask2, noLog, &preparedImages));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), preparedImages.size());
+    CPPUNIT_ASSERT_MESSAGE("Image is resampled once for all cases.", resampledImage == preparedImages.begin()->second);
+
+    CPPUNIT_ASSERT_MESSAGE("Each case has its own geometry.", image1 != image2);
+    CPPUNIT_ASSERT(mitk::Equal(origin1, image1->GetGeometry()->GetOrigin()));
+    CPPUNIT_ASSERT(mitk::Equal(origin2, image2->GetGeometry()->GetOrigin()));
+    CPPUNIT_ASSERT_MESSAGE("Loaded image is not modified.", mitk::Equal(imageOrigin, loadedImage->GetGeometry()->GetOrigin()));
+    CPPUNIT_ASSERT_MESSAGE("Prepared image is not modified.", mitk::Equal(imageOrigin, resampledImage->GetGeometry()->GetOrigin()));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, image1->GetGeometry()->GetSpacing()[0], mitk::eps);
+
+    {
+      mitk::ImageReadAccessor resampledAccessor(resampledImage);
+      mitk::ImageReadAccessor accessor1(image1);
+      mitk::ImageReadAccessor accessor2(image2);
+      CPPUNIT_ASSERT_MESSAGE("Cases share the pixel data of the prepared image.", resampledAccessor.GetData() == accessor1.GetData());
+      CPPUNIT_ASSERT(resampledAccessor.GetData() == accessor2.GetData());
+    }
+
+    // The shared pixel data stays valid without the prepared images
+    const auto expectedMask = mitk::cl::CreateGlobalImageFeaturesNoNaNMask(resampledImage, mask2);
+    preparedImages.clear();
+    resampledImage = nullptr;
+    image1 = nullptr;
+    auto maskNoNaN = mitk::cl::CreateGlobalImageFeaturesNoNaNMask(image2, mask2);
+    CPPUNIT_ASSERT(mitk::Equal(*expectedMask, *maskNoNaN, mitk::eps, true));
+  }
+
+  void CalculateGroup_Test()
+  {
+    const auto imagePath = GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd");
+    const auto maskPath = GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd");
+
+    // Second mask with a shifted origin, thus the geometry of the image is corrected for this case only
+    auto shiftedMask = mitk::IOUtil::Load<mitk::Image>(maskPath);
+    auto origin = shiftedMask->GetGeometry()->GetOrigin();
+    origin[0] += 3.0;
+    shiftedMask->GetGeometry()->SetOrigin(origin);
+    std::ofstream maskStream;
+    const auto shiftedMaskPath = mitk::IOUtil::CreateTemporaryFile(maskStream, "mask-XXXXXX.nrrd");
+    maskStream.close();
+    m_TemporaryFiles.push_back(shiftedMaskPath);
+    mitk::IOUtil::Save(shiftedMask, shiftedMaskPath);
+
+    std::vector<mitk::cl::GlobalImageFeaturesBatchCase> group = {
+      { "case1", imagePath, maskPath, "" },
+      { "case2", imagePath, shiftedMaskPath, "" },
+      { "case3", imagePath, shiftedMaskPath + ".missing.nrrd", "" },
+      { "case4", imagePath, maskPath, "" } };
+
+    auto calculator = mitk::GIFFirstOrderStatistics::New();
+    calculator->SetUseBinsize(true);
+    calculator->SetBinsize(1);
+    calculator->SetUseMinimumIntensity(true);
+    calculator->SetUseMaximumIntensity(true);
+    calculator->SetMinimumIntensity(0.5);
+    calculator->SetMaximumIntensity(6.5);
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> features = { calculator.GetPointer() };
+
+    auto param = CreateParameter();
+    param.ensureSameSpace = true;
+
+    auto path = CreateFile("");
+    std::mutex ioMutex;
+    {
+      mitk::cl::GlobalImageFeaturesBatchWriter writer(path);
+      auto failedCases = mitk::cl::CalculateGlobalImageFeaturesBatchGroup(group, param, features, writer, ioMutex);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Case with missing mask fails.", 1u, failedCases);
+      CPPUNIT_ASSERT_EQUAL(std::size_t(3), writer.GetNumberOfFinishedCases());
+      CPPUNIT_ASSERT(!writer.IsCaseFinished("case3"));
+    }
+
+    auto lines = ReadLines(path);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Header and the rows of the finished cases are stored.", std::size_t(4), lines.size());
+    auto header = SplitRow(lines[0]);
+    auto row1 = SplitRow(lines[1]);
+    auto row2 = SplitRow(lines[2]);
+    auto row4 = SplitRow(lines[3]);
+    CPPUNIT_ASSERT_EQUAL(std::string("case1"), row1[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("case2"), row2[0]);
+    CPPUNIT_ASSERT_EQUAL(std::string("case4"), row4[0]);
+    CPPUNIT_ASSERT_EQUAL(header.size(), row1.size());
+    CPPUNIT_ASSERT_EQUAL(header.size(), row2.size());
+
+    std::size_t meanColumn = 0;
+    for (std::size_t i = 3; i < header.size(); ++i)
+    {
+      if (header[i].size() >= 6 && header[i].compare(header[i].size() - 6, 6, "::Mean") == 0)
+      {
+        meanColumn = i;
+        break;
+      }
+    }
+    CPPUNIT_ASSERT_MESSAGE("Mean is part of the header.", meanColumn > 0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("First Order::Mean with Large IBSI Phantom Image", 2.15, std::stod(row1[meanColumn]), 0.01);
+
+    // Correcting the origin of case 2 does not change the features and does not affect the following cases
+    for (std::size_t i = 3; i < header.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(header[i] + " of the case with corrected origin.", row1[i], row2[i]);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(header[i] + " of the case after the corrected origin.", row1[i], row4[i]);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGlobalImageFeaturesBatch)
@@ -21,6 +21,8 @@ found in the LICENSE file.
 
 #include <mitkBaseData.h>
 
+#include <memory>
+
 namespace mitk
 {
   class MITKCLVIGRARANDOMFOREST_EXPORT VigraRandomForestClassifier : public AbstractClassifier
@@ -42,6 +44,20 @@ namespace mitk
     Eigen::MatrixXi Predict(const Eigen::MatrixXd &X) override;
     Eigen::MatrixXi PredictWeighted(const Eigen::MatrixXd &X);
 
+    /**
+    * \brief Predicts labels and probabilities of X with a flattened copy of the forest.
+    *
+    * The rows are evaluated in small batches, each tree is applied to all rows of a batch before
+    * the next tree is used. The tree weights are applied like in PredictWeighted() (without rounding
+    * the votes), so the result equals Predict() as long as all weights are one.
+    * In contrast to Predict(), the results are written into the given matrices and the member
+    * results are not changed. This allows to classify large images block by block without
+    * keeping the features of all voxels in memory. The flattened forest is built whenever the forest
+    * changes (Train(), OnlineTrain(), SetRandomForest()), thus PredictBlock() may be called from several
+    * threads at once.
+    */
+    void PredictBlock(const Eigen::MatrixXd &X, Eigen::MatrixXi &labels, Eigen::MatrixXd &probabilities);
+
 
     bool SupportsPointWiseWeight() override;
     bool SupportsPointWiseProbability() override;
@@ -75,12 +91,16 @@ namespace mitk
     struct PredictionData;
     struct EigenToVigraTransform;
     struct Parameter;
+    struct FlatForest;
 
     vigra::MultiArrayView<2, double> m_Probabilities;
     Eigen::MatrixXd m_TreeWeights;
 
     Parameter * m_Parameter;
     vigra::RandomForest<int> m_RandomForest;
+    std::unique_ptr<FlatForest> m_FlatForest;
+
+    void UpdateFlatForest();
 
     static itk::ITK_THREAD_RETURN_TYPE TrainTreesCallback(void *);
     static itk::ITK_THREAD_RETURN_TYPE PredictCallback(void *);
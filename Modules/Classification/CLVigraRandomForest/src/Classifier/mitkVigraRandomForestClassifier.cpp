@@ -16,6 +16,7 @@ found in the LICENSE file.
 #include <mitkImpurityLoss.h>
 #include <mitkLinearSplitting.h>
 #include <mitkProperties.h>
+#include <mitkExceptionMacro.h>
 
 // Vigra includes
 #include <vigra/random_forest.hxx>
@@ -25,6 +26,7 @@ found in the LICENSE file.
 #include <itkMultiThreaderBase.h>
 #include <itkCommand.h>
 
+#include <algorithm>
 #include <mutex>
 
 typedef mitk::ThresholdSplit<mitk::LinearSplitting< mitk::ImpurityLoss<> >,int,vigra::ClassificationTag> DefaultSplitType;
@@ -93,12 +95,88 @@ struct mitk::VigraRandomForestClassifier::PredictionData
   vigra::MultiArrayView<2, double> m_TreeWeights;
 };
 
+/**
+* Copy of all trees of the forest in two contiguous arrays. Inner nodes store the split column
+* and threshold, leaf nodes (column < 0) store the offset of their leaf weight and class
+* probabilities in LeafValues.
+*/
+struct mitk::VigraRandomForestClassifier::FlatForest
+{
+  struct Node
+  {
+    int Column;
+    double Threshold;
+    int Children[2];
+  };
+
+  std::vector<Node> Nodes;
+  std::vector<double> LeafValues;
+  std::vector<int> Roots;
+  int ClassCount = 0;
+
+  int AddNode(const vigra::RandomForest<int>::DecisionTree_t & tree, vigra::Int32 topologyIndex)
+  {
+    int nodeIndex = static_cast<int>(Nodes.size());
+    Nodes.emplace_back();
+
+    switch (tree.topology_[topologyIndex])
+    {
+    case vigra::i_ThresholdNode:
+    {
+      vigra::Node<vigra::i_ThresholdNode> node(tree.topology_, tree.parameters_, topologyIndex);
+      Nodes[nodeIndex].Column = node.column();
+      Nodes[nodeIndex].Threshold = node.threshold();
+      int left = this->AddNode(tree, node.child(0));
+      int right = this->AddNode(tree, node.child(1));
+      Nodes[nodeIndex].Children[0] = left;
+      Nodes[nodeIndex].Children[1] = right;
+      break;
+    }
+    case vigra::e_ConstProbNode:
+    {
+      vigra::Node<vigra::e_ConstProbNode> node(tree.topology_, tree.parameters_, topologyIndex);
+      Nodes[nodeIndex].Column = -1;
+      Nodes[nodeIndex].Threshold = 0;
+      Nodes[nodeIndex].Children[0] = static_cast<int>(LeafValues.size());
+      Nodes[nodeIndex].Children[1] = -1;
+      LeafValues.push_back(node.weights());
+      LeafValues.insert(LeafValues.end(), node.prob_begin(), node.prob_begin() + ClassCount);
+      break;
+    }
+    default:
+      mitkThrow() << "Random forest contains a node type that is not supported by the flattened forest: " << tree.topology_[topologyIndex];
+    }
+    return nodeIndex;
+  }
+
+  FlatForest(const vigra::RandomForest<int> & rf)
+    : ClassCount(rf.class_count())
+  {
+    for (const auto & tree : rf.trees_)
+    {
+      // The root node of vigra trees follows the two header entries of the topology
+      Roots.push_back(this->AddNode(tree, 2));
+    }
+  }
+
+  const double * GetLeaf(int tree, const Eigen::MatrixXd & X, Eigen::Index row) const
+  {
+    const Node * node = &Nodes[Roots[tree]];
+    while (node->Column >= 0)
+    {
+      node = &Nodes[node->Children[X(row, node->Column) < node->Threshold ? 0 : 1]];
+    }
+    return &LeafValues[node->Children[0]];
+  }
+};
+
 mitk::VigraRandomForestClassifier::VigraRandomForestClassifier()
   :m_Parameter(nullptr)
 {
   itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::Pointer command = itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::New();
   command->SetCallbackFunction(this, &mitk::VigraRandomForestClassifier::ConvertParameter);
   this->GetPropertyList()->AddObserver( itk::ModifiedEvent(), command );
+  this->UpdateFlatForest();
 }
 
 mitk::VigraRandomForestClassifier::~VigraRandomForestClassifier()
@@ -120,6 +198,7 @@ void mitk::VigraRandomForestClassifier::OnlineTrain(const Eigen::MatrixXd & X_in
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(Y_in.rows(),Y_in.cols()),Y_in.data());
   m_RandomForest.onlineLearn(X,Y,0,true);
+  this->UpdateFlatForest();
 }
 
 void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, const Eigen::MatrixXi &Y_in)
@@ -164,6 +243,7 @@ void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, cons
   m_RandomForest.set_options().tree_count(m_Parameter->TreeCount);
   m_RandomForest.ext_param_.class_count_ = data->m_ClassCount;
   m_RandomForest.trees_ = data->trees_;
+  this->UpdateFlatForest();
 
   // Set Tree Weights to default
   m_TreeWeights = Eigen::MatrixXd(m_Parameter->TreeCount,1);
@@ -234,6 +314,77 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::
 }
 
 
+void mitk::VigraRandomForestClassifier::PredictBlock(const Eigen::MatrixXd &X, Eigen::MatrixXi &labels, Eigen::MatrixXd &probabilities)
+{
+  if (m_FlatForest == nullptr)
+  {
+    mitkThrow() << "The random forest contains nodes that are not supported by PredictBlock(), use Predict() instead.";
+  }
+  const FlatForest & forest = *m_FlatForest;
+  const int classCount = forest.ClassCount;
+  const int treeCount = static_cast<int>(forest.Roots.size());
+  const bool useTreeWeights = m_TreeWeights.rows() == treeCount;
+  const double isSampleWeighted = m_RandomForest.options_.predict_weighted_;
+
+  labels.resize(X.rows(), 1);
+  probabilities.resize(X.rows(), classCount);
+  probabilities.setZero();
+
+  // Small enough that the features and votes of a batch stay in cache while all trees are evaluated
+  const Eigen::Index batchSize = 64;
+  const Eigen::Index numberOfBatches = (X.rows() + batchSize - 1) / batchSize;
+
+  auto predictBatch = [&](Eigen::Index batch)
+  {
+    const Eigen::Index firstRow = batch * batchSize;
+    const Eigen::Index endRow = std::min<Eigen::Index>(firstRow + batchSize, X.rows());
+
+    for (int tree = 0; tree < treeCount; ++tree)
+    {
+      const double treeWeight = useTreeWeights ? m_TreeWeights(tree, 0) : 1.0;
+      for (Eigen::Index row = firstRow; row < endRow; ++row)
+      {
+        const double * leaf = forest.GetLeaf(tree, X, row);
+        const double weight = (isSampleWeighted * leaf[0] + (1 - isSampleWeighted)) * treeWeight;
+        for (int l = 0; l < classCount; ++l)
+        {
+          probabilities(row, l) += leaf[l + 1] * weight;
+        }
+      }
+    }
+
+    for (Eigen::Index row = firstRow; row < endRow; ++row)
+    {
+      const double totalWeight = probabilities.row(row).sum();
+      if (totalWeight > 0)
+      {
+        probabilities.row(row) /= totalWeight;
+      }
+      Eigen::Index maxCol = 0;
+      probabilities.row(row).maxCoeff(&maxCol);
+      int label;
+      m_RandomForest.ext_param_.to_classlabel(static_cast<int>(maxCol), label);
+      labels(row, 0) = label;
+    }
+  };
+
+  auto threader = itk::MultiThreaderBase::New();
+  threader->ParallelizeArray(0, numberOfBatches, predictBatch, nullptr);
+}
+
+void mitk::VigraRandomForestClassifier::UpdateFlatForest()
+{
+  // Built whenever the forest changes, so PredictBlock() only reads it and may be called concurrently
+  try
+  {
+    m_FlatForest.reset(new FlatForest(m_RandomForest));
+  }
+  catch (const mitk::Exception & e)
+  {
+    MITK_WARN << e.GetDescription();
+    m_FlatForest.reset();
+  }
+}
 
 void mitk::VigraRandomForestClassifier::SetTreeWeights(Eigen::MatrixXd weights)
 {
@@ -581,6 +732,7 @@ void mitk::VigraRandomForestClassifier::SetRandomForest(const vigra::RandomFores
   this->SetSamplesPerTree(rf.options().training_set_proportion_);
   this->UseSampleWithReplacement(rf.options().sample_with_replacement_);
   this->m_RandomForest = rf;
+  this->UpdateFlatForest();
 }
 
 const vigra::RandomForest<int> & mitk::VigraRandomForestClassifier::GetRandomForest() const
@@ -23,6 +23,9 @@ found in the LICENSE file.
 #include <mitkImageCast.h>
 #include <mitkStandaloneDataStorage.h>
 
+#include <thread>
+#include <vector>
+
 class mitkVigraRandomForestTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkVigraRandomForestTestSuite  );
@@ -35,6 +38,8 @@ class mitkVigraRandomForestTestSuite : public mitk::TestFixture
   MITK_TEST(TrainThreadedDecisionForest_MatlabDataSet_shouldReturnTrue);
   MITK_TEST(PredictWeightedDecisionForest_SetWeightsToZero_shouldReturnTrue);
   MITK_TEST(TrainThreadedDecisionForest_BreastCancerDataSet_shouldReturnTrue);
+  MITK_TEST(PredictBlock_BreastCancerDataSet_EqualsPredict);
+  MITK_TEST(PredictBlock_ConcurrentCalls_EqualSingleCall);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -136,6 +141,73 @@ public:
     MITK_TEST_CONDITION(isIntervall<int>(Labels_Testing,classes,98,99),"Testvalue of cancer data set is in range.");
   }
 
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+  /*
+  The batched prediction with the flattened forest must give the same result as the vigra prediction.
+  */
+  void PredictBlock_BreastCancerDataSet_EqualsPredict()
+  {
+    auto & Features_Training = FeatureData_Cancer.first;
+    auto & Features_Testing = FeatureData_Cancer.second;
+    auto & Labels_Training = LabelData_Cancer.first;
+
+    classifier->Train(Features_Training,Labels_Training);
+    Eigen::MatrixXi classes = classifier->Predict(Features_Testing);
+    Eigen::MatrixXd probabilities = classifier->GetPointWiseProbabilities();
+
+    Eigen::MatrixXi blockClasses;
+    Eigen::MatrixXd blockProbabilities;
+    classifier->PredictBlock(Features_Testing, blockClasses, blockProbabilities);
+
+    CPPUNIT_ASSERT_EQUAL(classes.rows(), blockClasses.rows());
+    CPPUNIT_ASSERT_EQUAL(probabilities.cols(), blockProbabilities.cols());
+    CPPUNIT_ASSERT_MESSAGE("Batched prediction returns the same labels.", classes == blockClasses);
+    CPPUNIT_ASSERT_MESSAGE("Batched prediction returns the same probabilities.", probabilities.isApprox(blockProbabilities, 1e-10));
+
+    // Prediction of a subset must not depend on the other rows of the block
+    Eigen::MatrixXd firstRows = Features_Testing.topRows(10);
+    classifier->PredictBlock(firstRows, blockClasses, blockProbabilities);
+    CPPUNIT_ASSERT_MESSAGE("Batched prediction of a partial block returns the same labels.", classes.topRows(10) == blockClasses);
+  }
+
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+  /*
+  Blocks of an image are classified by several threads with the same classifier.
+  */
+  void PredictBlock_ConcurrentCalls_EqualSingleCall()
+  {
+    auto & Features_Training = FeatureData_Cancer.first;
+    auto & Features_Testing = FeatureData_Cancer.second;
+    auto & Labels_Training = LabelData_Cancer.first;
+
+    classifier->Train(Features_Training,Labels_Training);
+
+    Eigen::MatrixXi classes;
+    Eigen::MatrixXd probabilities;
+    classifier->PredictBlock(Features_Testing, classes, probabilities);
+
+    const int numberOfThreads = 4;
+    std::vector<Eigen::MatrixXi> threadClasses(numberOfThreads);
+    std::vector<Eigen::MatrixXd> threadProbabilities(numberOfThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back([&, i]() { classifier->PredictBlock(Features_Testing, threadClasses[i], threadProbabilities[i]); });
+    }
+    for (auto & thread : threads)
+    {
+      thread.join();
+    }
+
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Concurrent prediction returns the same labels.", classes == threadClasses[i]);
+      CPPUNIT_ASSERT_MESSAGE("Concurrent prediction returns the same probabilities.", probabilities == threadProbabilities[i]);
+    }
+  }
+
   // ------------------------------------------------------------------------------------------------------
   // ------------------------------------------------------------------------------------------------------
 
@@ -202,6 +202,90 @@ void mitk::DCUtilities::MatrixToDC3d(const Eigen::MatrixXi &matrix, mitk::DataCo
   return MatrixToDC3d(matrix, dc, names, mask);
 }
 
+void mitk::DCUtilities::ClassifyDC3dBlockwise(mitk::DataCollection::Pointer dc, const std::vector<std::string> &names, std::string mask,
+  const std::string &labelName, const std::vector<std::string> &probabilityNames, std::size_t blockSize, const ClassifyBlockFunctionType &classifyBlock)
+{
+  typedef mitk::DataCollectionImageIterator<double, 3> DataIterType;
+  typedef mitk::DataCollectionImageIterator<unsigned char, 3> LabelIterType;
+
+  int numberOfNames = names.size();
+  int numberOfProbabilities = probabilityNames.size();
+
+  EnsureUCharImageInDC(dc, labelName, mask);
+  for (const auto &name : probabilityNames)
+  {
+    EnsureDoubleImageInDC(dc, name, mask);
+  }
+
+  // The features are read ahead, the results are written behind with a second set of iterators
+  mitk::DataCollectionImageIterator<unsigned char, 3> maskIter(dc, mask);
+  std::vector<DataIterType> dataIter;
+  for (int i = 0; i < numberOfNames; ++i)
+  {
+    dataIter.push_back(DataIterType(dc, names[i]));
+  }
+
+  mitk::DataCollectionImageIterator<unsigned char, 3> resultMaskIter(dc, mask);
+  LabelIterType labelIter(dc, labelName);
+  std::vector<DataIterType> probabilityIter;
+  for (int i = 0; i < numberOfProbabilities; ++i)
+  {
+    probabilityIter.push_back(DataIterType(dc, probabilityNames[i]));
+  }
+
+  Eigen::MatrixXd features(blockSize, numberOfNames);
+  Eigen::MatrixXi labels;
+  Eigen::MatrixXd probabilities;
+  while (!maskIter.IsAtEnd())
+  {
+    std::size_t row = 0;
+    while (!maskIter.IsAtEnd() && row < blockSize)
+    {
+      if (maskIter.GetVoxel() > 0)
+      {
+        for (int col = 0; col < numberOfNames; ++col)
+        {
+          features(row, col) = dataIter[col].GetVoxel();
+        }
+        ++row;
+      }
+      for (int col = 0; col < numberOfNames; ++col)
+      {
+        ++(dataIter[col]);
+      }
+      ++maskIter;
+    }
+    if (row == 0)
+      break;
+
+    if (row < blockSize)
+    {
+      features.conservativeResize(row, numberOfNames);
+    }
+    classifyBlock(features, labels, probabilities);
+
+    std::size_t resultRow = 0;
+    while (resultRow < row)
+    {
+      if (resultMaskIter.GetVoxel() > 0)
+      {
+        labelIter.SetVoxel(labels(resultRow, 0));
+        for (int col = 0; col < numberOfProbabilities; ++col)
+        {
+          probabilityIter[col].SetVoxel(probabilities(resultRow, col));
+        }
+        ++resultRow;
+      }
+      ++labelIter;
+      for (int col = 0; col < numberOfProbabilities; ++col)
+      {
+        ++(probabilityIter[col]);
+      }
+      ++resultMaskIter;
+    }
+  }
+}
+
 void mitk::DCUtilities::EnsureUCharImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin)
 {
   typedef itk::Image<unsigned char, 3> FeatureImage;
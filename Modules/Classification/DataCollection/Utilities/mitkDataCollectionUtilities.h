@@ -18,6 +18,8 @@ found in the LICENSE file.
 #include <mitkDataCollection.h>
 #include <Eigen/Dense>
 
+#include <functional>
+
 namespace mitk
 {
   class MITKDATACOLLECTION_EXPORT DCUtilities
@@ -35,6 +37,18 @@ namespace mitk
     static void MatrixToDC3d(const Eigen::MatrixXd &matrix, mitk::DataCollection::Pointer dc, const std::string &names, std::string mask);
     static void MatrixToDC3d(const Eigen::MatrixXi &matrix, mitk::DataCollection::Pointer dc, const std::string &names, std::string mask);
 
+    typedef std::function<void(const Eigen::MatrixXd &features, Eigen::MatrixXi &labels, Eigen::MatrixXd &probabilities)> ClassifyBlockFunctionType;
+
+    /**
+    * \brief Classifies all voxels within the mask without creating the feature matrix of all voxels.
+    *
+    * The features of at most blockSize voxels are collected, passed to classifyBlock and the returned
+    * labels and probabilities are written into the images labelName and probabilityNames before
+    * the next block is collected. The images are created if they are missing.
+    */
+    static void ClassifyDC3dBlockwise(mitk::DataCollection::Pointer dc, const std::vector<std::string> &names, std::string mask,
+      const std::string &labelName, const std::vector<std::string> &probabilityNames, std::size_t blockSize, const ClassifyBlockFunctionType &classifyBlock);
+
     static void EnsureUCharImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin);
     static void EnsureDoubleImageInDC(mitk::DataCollection::Pointer dc, std::string name, std::string origin);
   };
@@ -36,6 +36,10 @@ namespace mitk
    * mitk::ExtractSliceFilter. It is more robust, easy to use, and produces
    * an mitk::Image with valid geometry. Generally it is not as fast as
    * mitk::ExtractSliceFilter, though.
+   *
+   * The rows of the output image are extracted in parallel by the multi-threader
+   * of the filter (see itk::ProcessObject::SetNumberOfWorkUnits()). The result
+   * does not depend on the number of threads.
    */
   class MITKCORE_EXPORT ExtractSliceFilter2 final : public ImageToImageFilter
   {
@@ -67,8 +71,6 @@ namespace mitk
     ~ExtractSliceFilter2() override;
 
     void AllocateOutputs() override;
-    // void BeforeThreadedGenerateData() override;
-    // void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) override;
     void GenerateData() override;
     void VerifyInputInformation() const override;
 
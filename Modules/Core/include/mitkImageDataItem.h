@@ -17,6 +17,8 @@ found in the LICENSE file.
 #include <MitkCoreExports.h>
 #include "mitkImageDescriptor.h"
 
+#include <memory>
+
 class vtkImageData;
 
 namespace mitk
@@ -122,6 +124,14 @@ namespace mitk
     size_t GetSize() const { return m_Size; }
     virtual void Modified() const;
 
+    /**
+     * @brief Sets an object that owns the memory of this item if the memory is not managed by the item itself
+     * (e.g. data imported with mitk::Image::ReferenceMemory). The owner is released together with the
+     * last item that references the memory, i.e. this item and its copies. Sub-items keep their parent alive.
+     */
+    void SetMemoryOwner(const std::shared_ptr<void> &owner) { m_MemoryOwner = owner; }
+    std::shared_ptr<void> GetMemoryOwner() const { return m_MemoryOwner; }
+
   protected:
 
     /**Helper function to allow friend classes to access m_Data without changing their code.
@@ -155,6 +165,8 @@ namespace mitk
     unsigned int m_Dimensions[MAX_IMAGE_DIMENSIONS];
 
     int m_Timestep;
+
+    std::shared_ptr<void> m_MemoryOwner;
   };
 
 } // namespace mitk
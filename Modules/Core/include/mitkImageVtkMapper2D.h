@@ -19,6 +19,7 @@ found in the LICENSE file.
 // MITK Rendering
 #include "mitkBaseRenderer.h"
 #include "mitkExtractSliceFilter.h"
+#include "mitkResliceCache.h"
 #include "mitkVtkMapper.h"
 
 // VTK
@@ -38,6 +39,7 @@ class vtkMitkThickSlicesFilter;
 class vtkPolyData;
 class vtkMitkApplyLevelWindowToRGBFilter;
 class vtkMitkLevelWindowFilter;
+class vtkMatrix4x4;
 
 namespace mitk
 {
@@ -111,6 +113,12 @@ namespace mitk
    * If the modality-property is set for an image, the mapper uses modality-specific default properties,
    * e.g. color maps, if they are defined.
 
+   * Resliced slices are kept in a memory-bounded cache which is shared by all image mappers (see
+   * SetResliceCacheMemoryLimit()). A slice is identified by the volume of the time step and its modified time,
+   * the plane geometry and the reslice parameters (see ResliceCache::Key). Hence, changes of e.g. the level
+   * window, the lookup table or the opacity do not trigger a reslicing, and render windows showing the same
+   * plane share one slice.
+
    * \ingroup Mapper
    */
   class MITKCORE_EXPORT ImageVtkMapper2D : public VtkMapper
@@ -134,6 +142,17 @@ namespace mitk
     vtkProp *GetVtkProp(mitk::BaseRenderer *renderer) override;
     //### end of methods of MITK-VTK rendering pipeline
 
+    /** \brief Set the maximum memory (in bytes) used by the reslice cache shared by all image mappers.
+     * The least recently used slices are discarded first. A limit of 0 disables the cache.
+     */
+    static void SetResliceCacheMemoryLimit(std::size_t limit);
+    static std::size_t GetResliceCacheMemoryLimit();
+
+    /** \brief Identifies a resliced slice. Keys are only valid for plane geometries, slices of e.g. an
+     * AbstractTransformGeometry are never cached.
+     */
+    using ResliceCacheKey = ResliceCache::Key;
+
     /** \brief Internal class holding the mapper, actor, etc. for each of the 3 2D render windows */
     /**
        * To render transveral, coronal, and sagittal, the mapper is called three times.
@@ -194,6 +213,13 @@ namespace mitk
       /** \brief mmPerPixel relation between pixel and mm. (World spacing).*/
       mitk::ScalarType *m_mmPerPixel;
 
+      /** \brief Key of m_ReslicedImage. If it does not change, the slice is not resliced again. */
+      ResliceCacheKey m_ResliceCacheKey;
+      /** \brief Reslice axes of m_ReslicedImage. */
+      vtkSmartPointer<vtkMatrix4x4> m_ResliceAxes;
+      /** \brief Spacing of m_ReslicedImage; m_mmPerPixel points to it. */
+      mitk::ScalarType m_ResliceSpacing[2];
+
       /** \brief This filter is used to apply the level window to Grayvalue and RBG(A) images. */
       vtkSmartPointer<vtkMitkLevelWindowFilter> m_LevelWindowFilter;
 
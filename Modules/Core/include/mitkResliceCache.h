@@ -0,0 +1,119 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKRESLICECACHE_H_HEADER_INCLUDED
+#define MITKRESLICECACHE_H_HEADER_INCLUDED
+
+#include <MitkCoreExports.h>
+#include <mitkBaseGeometry.h>
+#include <mitkTimeGeometry.h>
+
+#include <vtkSmartPointer.h>
+
+#include <array>
+#include <list>
+#include <mutex>
+
+class vtkImageData;
+class vtkMatrix4x4;
+
+namespace mitk
+{
+  class Image;
+  class ImageDataItem;
+
+  /**
+   * \brief Memory-bounded cache of resliced slices, the least recently used slices are discarded first.
+   *
+   * ImageVtkMapper2D shares one instance (GetInstance()) between all its render windows. The cache holds
+   * the slices by reference, so a slice must not be modified after it was inserted.
+   */
+  class MITKCORE_EXPORT ResliceCache
+  {
+  public:
+    /** \brief Identifies a resliced slice by everything its content depends on. */
+    struct MITKCORE_EXPORT Key
+    {
+      bool IsValid = false;
+      /** Slices of an owner are removed together (see Remove()). */
+      const void *Owner = nullptr;
+      /** Data item of the resliced volume, see SetVolume(). */
+      const ImageDataItem *Volume = nullptr;
+      itk::ModifiedTimeType VolumeMTime = 0;
+      TimeStepType TimeStep = 0;
+      const BaseGeometry *ReferenceGeometry = nullptr;
+      itk::ModifiedTimeType ReferenceGeometryMTime = 0;
+      /** Matrix, offset and bounds of the plane geometry. */
+      std::array<ScalarType, 18> PlaneParameters = {};
+      int InterpolationMode = 0;
+      bool InPlaneResampleExtentByGeometry = false;
+      int ThickSlicesMode = 0;
+      int ThickSlicesNum = 1;
+
+      /** \brief Sets the volume of the time step and the latest modification of its data or geometry.
+       *
+       * Writers signal changes either by ImageDataItem::Modified() or by Image::Modified(), thus both
+       * are considered.
+       */
+      void SetVolume(const Image *image, TimeStepType timeStep);
+
+      bool operator==(const Key &other) const;
+    };
+
+    struct Entry
+    {
+      Key SliceKey;
+      vtkSmartPointer<vtkImageData> Slice;
+      vtkSmartPointer<vtkMatrix4x4> ResliceAxes;
+      ScalarType Spacing[2] = {1.0, 1.0};
+      std::size_t MemorySize = 0;
+    };
+
+    static ResliceCache &GetInstance();
+
+    ResliceCache() = default;
+    ResliceCache(const ResliceCache &) = delete;
+    ResliceCache &operator=(const ResliceCache &) = delete;
+
+    /** \brief Returns true and the entry of the key, if it is cached. */
+    bool Find(const Key &key, Entry &result);
+
+    /** \brief Inserts the entry, the memory size of the entry is computed from its slice.
+     *
+     * Slices of the same owner and volume, but of an older version of the volume, are removed,
+     * since they will never be requested again.
+     */
+    void Insert(Entry entry);
+
+    /** \brief Removes all slices of the owner. */
+    void Remove(const void *owner);
+
+    void SetMemoryLimit(std::size_t limit);
+    std::size_t GetMemoryLimit();
+
+    std::size_t GetMemorySize();
+    std::size_t GetNumberOfEntries();
+
+  private:
+    template <typename TPredicate>
+    void RemoveIf(TPredicate predicate);
+
+    void Shrink();
+
+    std::list<Entry> m_Entries; // most recently used first
+    std::size_t m_MemorySize = 0;
+    std::size_t m_MemoryLimit = 128 * 1024 * 1024;
+    std::mutex m_Mutex;
+  };
+}
+
+#endif
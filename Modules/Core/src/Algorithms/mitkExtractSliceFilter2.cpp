@@ -29,6 +29,7 @@ struct mitk::ExtractSliceFilter2::Impl
   PlaneGeometry::Pointer OutputGeometry;
   mitk::ExtractSliceFilter2::Interpolator Interpolator;
   itk::Object::Pointer InterpolateImageFunction;
+  itk::TimeStamp InterpolateImageFunctionTime;
 };
 
 mitk::ExtractSliceFilter2::Impl::Impl()
@@ -75,7 +76,7 @@ namespace
   }
 
   template <typename TPixel, unsigned int VImageDimension>
-  void GenerateData(const itk::Image<TPixel, VImageDimension>* inputImage, mitk::Image* outputImage, const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion, itk::Object* interpolateImageFunction)
+  void GenerateData(const itk::Image<TPixel, VImageDimension>* inputImage, mitk::Image* outputImage, const mitk::ExtractSliceFilter2::OutputImageRegionType& outputRegion, itk::Object* interpolateImageFunction, itk::MultiThreaderBase* multiThreader)
   {
     typedef itk::Image<TPixel, VImageDimension> TInputImage;
     typedef itk::InterpolateImageFunction<TInputImage> TInterpolateImageFunction;
@@ -94,7 +95,6 @@ namespace
     auto spacingAlongXDirection = xDirection * spacing[0];
     auto spacingAlongYDirection = yDirection * spacing[1];
 
-    const std::size_t pixelSize = outputImage->GetPixelType().GetSize();
     const std::size_t width = outputGeometry->GetExtent(0);
     const std::size_t xBegin = outputRegion.GetIndex(0);
     const std::size_t yBegin = outputRegion.GetIndex(1);
@@ -102,34 +102,32 @@ namespace
     const std::size_t yEnd = yBegin + outputRegion.GetSize(1);
 
     mitk::ImageWriteAccessor writeAccess(outputImage, nullptr, mitk::ImageAccessorBase::IgnoreLock);
-    auto data = static_cast<char*>(writeAccess.GetData());
+    auto data = static_cast<TPixel*>(writeAccess.GetData());
 
     const TPixel backgroundPixel = std::numeric_limits<TPixel>::lowest();
-    TPixel pixel;
 
-    itk::ContinuousIndex<mitk::ScalarType, 3> index;
-    mitk::Point3D yPoint;
-    mitk::Point3D point;
-
-    for (std::size_t y = yBegin; y < yEnd; ++y)
+    // Rows are independent of each other. Each pixel is computed exactly as
+    // in a single-threaded run, so the result does not depend on the number
+    // of threads.
+    auto extractRow = [&](itk::SizeValueType y)
     {
-      yPoint = origin + spacingAlongYDirection * y;
+      itk::ContinuousIndex<mitk::ScalarType, 3> index;
+      mitk::Point3D point;
+
+      const mitk::Point3D yPoint = origin + spacingAlongYDirection * y;
+      TPixel* row = data + width * y;
 
       for (std::size_t x = xBegin; x < xEnd; ++x)
       {
         point = yPoint + spacingAlongXDirection * x;
 
-        if (inputImage->TransformPhysicalPointToContinuousIndex(point, index))
-        {
-          pixel = interpolator->EvaluateAtContinuousIndex(index);
-          memcpy(static_cast<void*>(data + pixelSize * (width * y + x)), static_cast<const void*>(&pixel), pixelSize);
-        }
-        else
-        {
-          memcpy(static_cast<void*>(data + pixelSize * (width * y + x)), static_cast<const void*>(&backgroundPixel), pixelSize);
-        }
+        row[x] = inputImage->TransformPhysicalPointToContinuousIndex(point, index)
+          ? static_cast<TPixel>(interpolator->EvaluateAtContinuousIndex(index))
+          : backgroundPixel;
       }
-    }
+    };
+
+    multiThreader->ParallelizeArray(yBegin, yEnd, extractRow, nullptr);
   }
 
   void VerifyInputImage(const mitk::Image* inputImage)
@@ -196,34 +194,22 @@ void mitk::ExtractSliceFilter2::AllocateOutputs()
   }
 }
 
-/*void mitk::ExtractSliceFilter2::BeforeThreadedGenerateData()
-{
-  if (nullptr != m_Impl->InterpolateImageFunction && this->GetInput()->GetMTime() < this->GetMTime())
-    return;
-
-  const auto* inputImage = this->GetInput();
-  AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, this->GetInterpolator(), m_Impl->InterpolateImageFunction);
-}
-
-void mitk::ExtractSliceFilter2::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType)
-{
-  const auto* inputImage = this->GetInput();
-  AccessFixedDimensionByItk_3(inputImage, ::GenerateData, 3, this->GetOutput(), outputRegionForThread, m_Impl->InterpolateImageFunction);
-}*/
-
 void mitk::ExtractSliceFilter2::GenerateData()
 {
-  if (nullptr != m_Impl->InterpolateImageFunction && this->GetInput()->GetMTime() < this->GetMTime())
-    return;
-
   const auto* inputImage = this->GetInput();
 
-  AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, this->GetInterpolator(), m_Impl->InterpolateImageFunction);
+  // the interpolate image function only has to be recreated if the input image was modified
+  if (nullptr == m_Impl->InterpolateImageFunction || inputImage->GetMTime() > m_Impl->InterpolateImageFunctionTime.GetMTime())
+  {
+    AccessFixedDimensionByItk_2(inputImage, CreateInterpolateImageFunction, 3, this->GetInterpolator(), m_Impl->InterpolateImageFunction);
+    m_Impl->InterpolateImageFunctionTime.Modified();
+  }
 
   this->AllocateOutputs();
   auto outputRegion = this->GetOutput()->GetLargestPossibleRegion();
 
-  AccessFixedDimensionByItk_3(inputImage, ::GenerateData, 3, this->GetOutput(), outputRegion, m_Impl->InterpolateImageFunction);
+  this->GetMultiThreader()->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  AccessFixedDimensionByItk_n(inputImage, ::GenerateData, 3, (this->GetOutput(), outputRegion, m_Impl->InterpolateImageFunction.GetPointer(), this->GetMultiThreader()));
 }
 
 void mitk::ExtractSliceFilter2::SetInput(const InputImageType* image)
@@ -177,7 +177,8 @@ mitk::ImageDataItem::ImageDataItem(const ImageDataItem &other)
     m_Size(other.m_Size),
     m_Parent(other.m_Parent),
     m_Dimension(other.m_Dimension),
-    m_Timestep(other.m_Timestep)
+    m_Timestep(other.m_Timestep),
+    m_MemoryOwner(other.m_MemoryOwner)
 {
   // copy m_Data ??
   for (int i = 0; i < MAX_IMAGE_DIMENSIONS; ++i)
@@ -55,6 +55,9 @@ found in the LICENSE file.
 #include <itkRGBAPixel.h>
 #include <mitkRenderingModeProperty.h>
 
+// STL
+#include <algorithm>
+
 namespace
 {
   bool IsBinaryImage(mitk::Image* image)
@@ -99,12 +102,24 @@ namespace
   }
 }
 
+void mitk::ImageVtkMapper2D::SetResliceCacheMemoryLimit(std::size_t limit)
+{
+  ResliceCache::GetInstance().SetMemoryLimit(limit);
+}
+
+std::size_t mitk::ImageVtkMapper2D::GetResliceCacheMemoryLimit()
+{
+  return ResliceCache::GetInstance().GetMemoryLimit();
+}
+
 mitk::ImageVtkMapper2D::ImageVtkMapper2D()
 {
 }
 
 mitk::ImageVtkMapper2D::~ImageVtkMapper2D()
 {
+  ResliceCache::GetInstance().Remove(this);
+
   // The 3D RW Mapper (PlaneGeometryDataVtkMapper3D) is listening to this event,
   // in order to delete the images from the 3D RW.
   this->InvokeEvent(itk::DeleteEvent());
@@ -204,6 +219,7 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
   // Initialize the interpolation mode for resampling; switch to nearest
   // neighbor if the input image is too small.
+  ExtractSliceFilter::ResliceInterpolation resliceInterpolation = ExtractSliceFilter::RESLICE_NEAREST;
   if ((image->GetDimension() >= 3) && (image->GetDimension(2) > 1))
   {
     VtkResliceInterpolationProperty *resliceInterpolationProperty;
@@ -218,20 +234,17 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
     switch (interpolationMode)
     {
       case VTK_RESLICE_NEAREST:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
+        resliceInterpolation = ExtractSliceFilter::RESLICE_NEAREST;
         break;
       case VTK_RESLICE_LINEAR:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_LINEAR);
+        resliceInterpolation = ExtractSliceFilter::RESLICE_LINEAR;
         break;
       case VTK_RESLICE_CUBIC:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_CUBIC);
+        resliceInterpolation = ExtractSliceFilter::RESLICE_CUBIC;
         break;
     }
   }
-  else
-  {
-    localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
-  }
+  localStorage->m_Reslicer->SetInterpolationMode(resliceInterpolation);
 
   // set the vtk output property to true, makes sure that no unneeded mitk image convertion
   // is done.
@@ -266,62 +279,131 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
   }
 
   const auto *planeGeometry = dynamic_cast<const PlaneGeometry *>(worldGeometry);
+  const auto *abstractGeometry = dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
 
-  if (thickSlicesMode > 0)
+  // everything the content of the slice depends on; as long as it does not change,
+  // e.g. level window or lookup table changes do not require to reslice the image
+  ResliceCacheKey resliceCacheKey;
+  if (nullptr != planeGeometry && nullptr == abstractGeometry)
   {
-    double dataZSpacing = 1.0;
+    resliceCacheKey.IsValid = true;
+    resliceCacheKey.Owner = this;
+    resliceCacheKey.SetVolume(image, this->GetTimestep());
+    resliceCacheKey.TimeStep = this->GetTimestep();
+    resliceCacheKey.ReferenceGeometry = planeGeometry->GetReferenceGeometry();
+    resliceCacheKey.ReferenceGeometryMTime =
+      nullptr != resliceCacheKey.ReferenceGeometry ? resliceCacheKey.ReferenceGeometry->GetMTime() : 0;
+
+    const auto &matrix = planeGeometry->GetIndexToWorldTransform()->GetMatrix();
+    const auto &offset = planeGeometry->GetIndexToWorldTransform()->GetOffset();
+    const auto &bounds = planeGeometry->GetBounds();
+    auto parameter = resliceCacheKey.PlaneParameters.begin();
+    for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+        *parameter++ = matrix[i][j];
+      *parameter++ = offset[i];
+    }
+    for (int i = 0; i < 6; ++i)
+      *parameter++ = bounds[i];
 
-    Vector3D normInIndex, normal;
+    resliceCacheKey.InterpolationMode = resliceInterpolation;
+    resliceCacheKey.InPlaneResampleExtentByGeometry = inPlaneResampleExtentByGeometry;
+    resliceCacheKey.ThickSlicesMode = thickSlicesMode;
+    resliceCacheKey.ThickSlicesNum = thickSlicesNum;
+  }
 
-    const auto *abstractGeometry =
-      dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
-    if (abstractGeometry != nullptr)
-      normal = abstractGeometry->GetPlane()->GetNormal();
-    else
+  ResliceCache::Entry cacheEntry;
+  if (resliceCacheKey == localStorage->m_ResliceCacheKey)
+  {
+    // m_ReslicedImage, m_ResliceAxes and m_ResliceSpacing are still up to date
+  }
+  else if (ResliceCache::GetInstance().Find(resliceCacheKey, cacheEntry))
+  {
+    // another render window already resliced the same plane
+    localStorage->m_ReslicedImage = cacheEntry.Slice;
+    localStorage->m_ResliceAxes->DeepCopy(cacheEntry.ResliceAxes);
+    localStorage->m_ResliceSpacing[0] = cacheEntry.Spacing[0];
+    localStorage->m_ResliceSpacing[1] = cacheEntry.Spacing[1];
+  }
+  else
+  {
+    if (thickSlicesMode > 0)
     {
-      if (planeGeometry != nullptr)
+      double dataZSpacing = 1.0;
+
+      Vector3D normInIndex, normal;
+
+      if (abstractGeometry != nullptr)
+        normal = abstractGeometry->GetPlane()->GetNormal();
+      else
       {
-        normal = planeGeometry->GetNormal();
+        if (planeGeometry != nullptr)
+        {
+          normal = planeGeometry->GetNormal();
+        }
+        else
+          return; // no fitting geometry set
       }
-      else
-        return; // no fitting geometry set
-    }
-    normal.Normalize();
+      normal.Normalize();
 
-    image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
+      image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
 
-    dataZSpacing = 1.0 / normInIndex.GetNorm();
+      dataZSpacing = 1.0 / normInIndex.GetNorm();
 
-    localStorage->m_Reslicer->SetOutputDimensionality(3);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
+      localStorage->m_Reslicer->SetOutputDimensionality(3);
+      localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
+      localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
 
-    // Do the reslicing. Modified() is called to make sure that the reslicer is
-    // executed even though the input geometry information did not change; this
-    // is necessary when the input /em data, but not the /em geometry changes.
-    localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
-    localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
+      // Do the reslicing. Modified() is called to make sure that the reslicer is
+      // executed even though the input geometry information did not change; this
+      // is necessary when the input /em data, but not the /em geometry changes.
+      localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
+      localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
 
-    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
-    localStorage->m_Reslicer->Modified();
-    localStorage->m_Reslicer->Update();
+      // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
+      localStorage->m_Reslicer->Modified();
+      localStorage->m_Reslicer->Update();
 
-    localStorage->m_TSFilter->Modified();
-    localStorage->m_TSFilter->Update();
-    localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
-  }
-  else
-  {
-    // this is needed when thick mode was enable bevore. These variable have to be reset to default values
-    localStorage->m_Reslicer->SetOutputDimensionality(2);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
-
-    localStorage->m_Reslicer->Modified();
-    // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
-    localStorage->m_Reslicer->UpdateLargestPossibleRegion();
-    localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+      localStorage->m_TSFilter->Modified();
+      localStorage->m_TSFilter->Update();
+      localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
+    }
+    else
+    {
+      // this is needed when thick mode was enable bevore. These variable have to be reset to default values
+      localStorage->m_Reslicer->SetOutputDimensionality(2);
+      localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
+      localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
+
+      localStorage->m_Reslicer->Modified();
+      // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
+      localStorage->m_Reslicer->UpdateLargestPossibleRegion();
+      localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+    }
+
+    localStorage->m_ResliceAxes->DeepCopy(localStorage->m_Reslicer->GetResliceAxes());
+    localStorage->m_ResliceSpacing[0] = localStorage->m_Reslicer->GetOutputSpacing()[0];
+    localStorage->m_ResliceSpacing[1] = localStorage->m_Reslicer->GetOutputSpacing()[1];
+
+    if (resliceCacheKey.IsValid && ResliceCache::GetInstance().GetMemoryLimit() > 0)
+    {
+      // The cache takes over the scalars of the output. Releasing the output makes the next reslicing
+      // allocate new scalars instead of overwriting the cached ones, so no copy is needed.
+      cacheEntry.SliceKey = resliceCacheKey;
+      cacheEntry.Slice = vtkSmartPointer<vtkImageData>::New();
+      cacheEntry.Slice->ShallowCopy(localStorage->m_ReslicedImage);
+      localStorage->m_ReslicedImage->ReleaseData();
+      cacheEntry.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+      cacheEntry.ResliceAxes->DeepCopy(localStorage->m_ResliceAxes);
+      cacheEntry.Spacing[0] = localStorage->m_ResliceSpacing[0];
+      cacheEntry.Spacing[1] = localStorage->m_ResliceSpacing[1];
+      ResliceCache::GetInstance().Insert(cacheEntry);
+
+      localStorage->m_ReslicedImage = cacheEntry.Slice;
+    }
   }
+  localStorage->m_ResliceCacheKey = resliceCacheKey;
 
   // Bounds information for reslicing (only reuqired if reference geometry
   // is present)
@@ -334,7 +416,7 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
   localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
 
   // get the spacing of the slice
-  localStorage->m_mmPerPixel = localStorage->m_Reslicer->GetOutputSpacing();
+  localStorage->m_mmPerPixel = localStorage->m_ResliceSpacing;
 
   // calculate minimum bounding rect of IMAGE in texture
   {
@@ -668,6 +750,7 @@ void mitk::ImageVtkMapper2D::SetToInvalidState(mitk::ImageVtkMapper2D::LocalStor
   // the latest image is used there if the plane is out of the geometry
   // see bug-13275
   localStorage->m_ReslicedImage = nullptr;
+  localStorage->m_ResliceCacheKey = ResliceCacheKey();
   localStorage->m_Mapper->SetInputData(localStorage->m_EmptyPolyData);
 }
 
@@ -1058,8 +1141,7 @@ void mitk::ImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer)
   LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
   // get the transformation matrix of the reslicer in order to render the slice as axial, coronal or saggital
   vtkSmartPointer<vtkTransform> trans = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkMatrix4x4> matrix = localStorage->m_Reslicer->GetResliceAxes();
-  trans->SetMatrix(matrix);
+  trans->SetMatrix(localStorage->m_ResliceAxes);
   // transform the plane/contour (the actual actor) to the corresponding view (axial, coronal or saggital)
   localStorage->m_ImageActor->SetUserTransform(trans);
   // transform the origin to center based coordinates, because MITK is center based.
@@ -1123,6 +1205,9 @@ mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
   m_OutlinePolyData = vtkSmartPointer<vtkPolyData>::New();
   m_ReslicedImage = vtkSmartPointer<vtkImageData>::New();
   m_EmptyPolyData = vtkSmartPointer<vtkPolyData>::New();
+  m_ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+  m_ResliceSpacing[0] = m_ResliceSpacing[1] = 1.0;
+  m_mmPerPixel = m_ResliceSpacing;
 
   // the following actions are always the same and thus can be performed
   // in the constructor for each image (i.e. the image-corresponding local storage)
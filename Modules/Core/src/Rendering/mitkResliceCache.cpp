@@ -0,0 +1,156 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkResliceCache.h"
+
+#include <mitkImage.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+#include <algorithm>
+#include <utility>
+
+void mitk::ResliceCache::Key::SetVolume(const Image *image, TimeStepType timeStep)
+{
+  const auto volume = image->GetVolumeData(timeStep);
+  const auto geometry = image->GetTimeGeometry()->GetGeometryForTimeStep(timeStep);
+
+  Volume = volume.GetPointer();
+  VolumeMTime = std::max({image->GetMTime(), image->GetPipelineMTime(), geometry->GetMTime()});
+
+  // ImageDataItem::Modified() only touches the vtkImageData of the volume
+  if (volume.IsNotNull())
+  {
+    auto *vtkImage = const_cast<vtkImageData *>(image->GetVtkImageData(timeStep));
+    if (nullptr != vtkImage)
+      VolumeMTime = std::max(VolumeMTime, vtkImage->GetMTime());
+  }
+}
+
+bool mitk::ResliceCache::Key::operator==(const Key &other) const
+{
+  return IsValid && other.IsValid && Owner == other.Owner && Volume == other.Volume &&
+         VolumeMTime == other.VolumeMTime && TimeStep == other.TimeStep &&
+         ReferenceGeometry == other.ReferenceGeometry && ReferenceGeometryMTime == other.ReferenceGeometryMTime &&
+         PlaneParameters == other.PlaneParameters && InterpolationMode == other.InterpolationMode &&
+         InPlaneResampleExtentByGeometry == other.InPlaneResampleExtentByGeometry &&
+         ThickSlicesMode == other.ThickSlicesMode && ThickSlicesNum == other.ThickSlicesNum;
+}
+
+mitk::ResliceCache &mitk::ResliceCache::GetInstance()
+{
+  static ResliceCache instance;
+  return instance;
+}
+
+bool mitk::ResliceCache::Find(const Key &key, Entry &result)
+{
+  if (!key.IsValid)
+    return false;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  // the cache only holds a few hundred slices, so a linear search is sufficient
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end(); ++iter)
+  {
+    if (iter->SliceKey == key)
+    {
+      m_Entries.splice(m_Entries.begin(), m_Entries, iter);
+      result = m_Entries.front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void mitk::ResliceCache::Insert(Entry entry)
+{
+  if (!entry.SliceKey.IsValid || nullptr == entry.Slice)
+    return;
+
+  entry.MemorySize = static_cast<std::size_t>(entry.Slice->GetActualMemorySize()) * 1024;
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  // slices of older versions of the volume will never be requested again
+  const auto &key = entry.SliceKey;
+  this->RemoveIf([&key](const Entry &other) {
+    return other.SliceKey.Owner == key.Owner &&
+           (other.SliceKey.Volume == key.Volume ? other.SliceKey.VolumeMTime != key.VolumeMTime
+                                                : other.SliceKey.TimeStep == key.TimeStep);
+  });
+
+  if (entry.MemorySize > m_MemoryLimit)
+    return;
+
+  m_MemorySize += entry.MemorySize;
+  m_Entries.push_front(std::move(entry));
+  this->Shrink();
+}
+
+void mitk::ResliceCache::Remove(const void *owner)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  this->RemoveIf([owner](const Entry &entry) { return entry.SliceKey.Owner == owner; });
+}
+
+void mitk::ResliceCache::SetMemoryLimit(std::size_t limit)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_MemoryLimit = limit;
+  this->Shrink();
+}
+
+std::size_t mitk::ResliceCache::GetMemoryLimit()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MemoryLimit;
+}
+
+std::size_t mitk::ResliceCache::GetMemorySize()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_MemorySize;
+}
+
+std::size_t mitk::ResliceCache::GetNumberOfEntries()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Entries.size();
+}
+
+template <typename TPredicate>
+void mitk::ResliceCache::RemoveIf(TPredicate predicate)
+{
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end();)
+  {
+    if (predicate(*iter))
+    {
+      m_MemorySize -= iter->MemorySize;
+      iter = m_Entries.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+}
+
+void mitk::ResliceCache::Shrink()
+{
+  while (m_MemorySize > m_MemoryLimit && !m_Entries.empty())
+  {
+    m_MemorySize -= m_Entries.back().MemorySize;
+    m_Entries.pop_back();
+  }
+}
@@ -12,12 +12,15 @@ found in the LICENSE file.
 
 #include <itkImage.h>
 #include <itkImageRegionIterator.h>
+#include <itkTimeProbe.h>
 #include <mitkExtractSliceFilter.h>
+#include <mitkExtractSliceFilter2.h>
 #include <mitkIOUtil.h>
 #include <mitkITKImageImport.h>
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkImagePixelReadAccessor.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkInteractionConst.h>
 #include <mitkNumericTypes.h>
 #include <mitkRotationOperation.h>
@@ -27,6 +30,7 @@ found in the LICENSE file.
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
+#include <thread>
 
 #include <mitkGeometry3D.h>
 
@@ -679,6 +683,102 @@ public:
 #endif
   }
 
+  /*
+   * Extracts slices rotated around the given plane with mitk::ExtractSliceFilter2 and different numbers
+   * of threads, checks that the slices do not depend on the number of threads and reports the slices per second.
+   */
+  static void TestMultiThreadedReslicing(mitk::PlaneGeometry *planeGeometry)
+  {
+    const int numberOfSlices = 20;
+
+    std::vector<mitk::PlaneGeometry::Pointer> planes;
+    for (int i = 0; i < numberOfSlices; ++i)
+    {
+      auto plane = planeGeometry->Clone();
+      mitk::Vector3D rotationAxis;
+      rotationAxis[0] = 0.3;
+      rotationAxis[1] = 0.7;
+      rotationAxis[2] = 0.1;
+      mitk::RotationOperation op(mitk::OpROTATE, plane->GetCenter(), rotationAxis, 3.0 * i);
+      plane->ExecuteOperation(&op);
+      planes.push_back(plane);
+    }
+
+    std::vector<int> numbersOfThreads;
+    const int maxNumberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int numberOfThreads = 1; numberOfThreads < maxNumberOfThreads; numberOfThreads *= 2)
+      numbersOfThreads.push_back(numberOfThreads);
+    numbersOfThreads.push_back(maxNumberOfThreads);
+
+    const std::pair<mitk::ExtractSliceFilter2::Interpolator, std::string> interpolators[] = {
+      {mitk::ExtractSliceFilter2::NearestNeighbor, "nearest"}, {mitk::ExtractSliceFilter2::Linear, "linear"}};
+
+    for (const auto &interpolator : interpolators)
+    {
+      std::vector<mitk::Image::Pointer> referenceSlices;
+
+      for (auto numberOfThreads : numbersOfThreads)
+      {
+        auto slicer = mitk::ExtractSliceFilter2::New();
+        slicer->SetInput(TestVolume);
+        slicer->SetInterpolator(interpolator.first);
+        slicer->SetNumberOfWorkUnits(numberOfThreads);
+
+        std::vector<mitk::Image::Pointer> slices;
+        itk::TimeProbe timeProbe;
+        for (const auto &plane : planes)
+        {
+          slicer->SetOutputGeometry(plane);
+          timeProbe.Start();
+          slicer->Update();
+          timeProbe.Stop();
+          slices.push_back(slicer->GetOutput()->Clone());
+        }
+
+        MITK_INFO << "ExtractSliceFilter2 (" << interpolator.second << ", " << numberOfThreads
+                  << " threads): " << numberOfSlices / timeProbe.GetTotal() << " slices/s";
+
+        if (referenceSlices.empty())
+        {
+          referenceSlices = slices;
+        }
+        else
+        {
+          MITK_TEST_CONDITION(AreSlicesEqual(referenceSlices, slices),
+                              "ExtractSliceFilter2 (" << interpolator.second << ") with " << numberOfThreads
+                                                      << " threads yields the single-threaded result");
+        }
+      }
+    }
+  }
+
+  static bool AreSlicesEqual(const std::vector<mitk::Image::Pointer> &slices1,
+                             const std::vector<mitk::Image::Pointer> &slices2)
+  {
+    if (slices1.size() != slices2.size())
+      return false;
+
+    for (std::size_t i = 0; i < slices1.size(); ++i)
+    {
+      mitk::Image *slice1 = slices1[i];
+      mitk::Image *slice2 = slices2[i];
+
+      if (slice1->GetDimension(0) != slice2->GetDimension(0) || slice1->GetDimension(1) != slice2->GetDimension(1) ||
+          slice1->GetPixelType() != slice2->GetPixelType())
+        return false;
+
+      mitk::ImageReadAccessor readAccess1(slice1);
+      mitk::ImageReadAccessor readAccess2(slice2);
+      const std::size_t size =
+        slice1->GetDimension(0) * slice1->GetDimension(1) * slice1->GetPixelType().GetSize();
+
+      if (0 != memcmp(readAccess1.GetData(), readAccess2.GetData(), size))
+        return false;
+    }
+
+    return true;
+  }
+
   // the test result of the sphere reslice
   struct SliceProperties
   {
@@ -939,6 +1039,9 @@ int mitkExtractSliceFilterTest(int /*argc*/, char * /*argv*/ [])
   mitkExtractSliceFilterTestClass::TestSlice(obliquePlane, "Testing oblique plane");
 /* end oblique plane */
 
+  /* multi-threaded reslicing */
+  mitkExtractSliceFilterTestClass::TestMultiThreadedReslicing(obliquePlane);
+
 #ifdef SHOW_SLICE_IN_RENDER_WINDOW
   /*================ #BEGIN vtk render code ================*/
 
@@ -11,6 +11,8 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include <array>
+#include <memory>
+#include <vector>
 
 #include "mitkTestFixture.h"
 #include "mitkTestingMacros.h"
@@ -25,6 +27,7 @@ class mitkImageDataItemTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkImageDataItemTestSuite);
   MITK_TEST(TestAccessOnHugeImage);
+  MITK_TEST(TestMemoryOwnerOutlivesImage);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -65,6 +68,32 @@ public:
       exit(77);
     }
   }
+
+  void TestMemoryOwnerOutlivesImage()
+  {
+    auto image = mitk::Image::New();
+    std::array<unsigned int, 3> dimensions = {{ 4, 4, 4 }};
+    image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions.data());
+
+    auto buffer = std::make_shared<std::vector<unsigned char>>(64, 7);
+    std::weak_ptr<std::vector<unsigned char>> weakBuffer = buffer;
+    CPPUNIT_ASSERT(image->SetImportChannel(buffer->data(), 0, mitk::Image::ReferenceMemory));
+    image->GetChannelData(0)->SetMemoryOwner(buffer);
+    buffer = nullptr;
+
+    auto slice = image->GetSliceData(2);
+    auto channelCopy = image->GetChannelData(0)->Clone();
+    CPPUNIT_ASSERT_MESSAGE("Copies of the item share the memory owner.", channelCopy->GetMemoryOwner() != nullptr);
+
+    image = nullptr;
+    CPPUNIT_ASSERT_MESSAGE("Memory is kept as long as items reference it.", !weakBuffer.expired());
+
+    channelCopy = nullptr;
+    CPPUNIT_ASSERT_MESSAGE("Sub-items keep the memory alive.", !weakBuffer.expired());
+
+    slice = nullptr;
+    CPPUNIT_ASSERT_MESSAGE("Memory owner is released with the last item.", weakBuffer.expired());
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkImageDataItem)
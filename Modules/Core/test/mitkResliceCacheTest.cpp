@@ -0,0 +1,158 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkImage.h>
+#include <mitkImageDataItem.h>
+#include <mitkResliceCache.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+class mitkResliceCacheTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkResliceCacheTestSuite);
+  MITK_TEST(Find_InsertedKey_ReturnsCachedSlice);
+  MITK_TEST(Find_OtherKey_Misses);
+  MITK_TEST(SetVolume_ModifiedVolume_InvalidatesSlices);
+  MITK_TEST(Insert_ExceedingMemoryLimit_RemovesLeastRecentlyUsed);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  const int m_Owner = 0;
+
+  mitk::ResliceCache::Key CreateKey(double planeOffset)
+  {
+    mitk::ResliceCache::Key key;
+    key.IsValid = true;
+    key.Owner = &m_Owner;
+    key.SetVolume(m_Image, 0);
+    key.PlaneParameters[3] = planeOffset;
+    return key;
+  }
+
+  mitk::ResliceCache::Entry CreateEntry(const mitk::ResliceCache::Key &key)
+  {
+    mitk::ResliceCache::Entry entry;
+    entry.SliceKey = key;
+    entry.Slice = vtkSmartPointer<vtkImageData>::New();
+    entry.Slice->SetDimensions(64, 64, 1);
+    entry.Slice->AllocateScalars(VTK_FLOAT, 1);
+    entry.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+    return entry;
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[3] = {8, 8, 8};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+  }
+
+  void tearDown() override
+  {
+    m_Image = nullptr;
+  }
+
+  void Find_InsertedKey_ReturnsCachedSlice()
+  {
+    mitk::ResliceCache cache;
+    auto entry = CreateEntry(CreateKey(0.0));
+    cache.Insert(entry);
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), cache.GetNumberOfEntries());
+    CPPUNIT_ASSERT(cache.GetMemorySize() >= 64 * 64 * sizeof(float));
+
+    mitk::ResliceCache::Entry result;
+    CPPUNIT_ASSERT(cache.Find(CreateKey(0.0), result));
+    CPPUNIT_ASSERT_MESSAGE("The cache holds the slice without copying it.", entry.Slice == result.Slice);
+  }
+
+  void Find_OtherKey_Misses()
+  {
+    mitk::ResliceCache cache;
+    cache.Insert(CreateEntry(CreateKey(0.0)));
+
+    mitk::ResliceCache::Entry result;
+    CPPUNIT_ASSERT_MESSAGE("Other plane", !cache.Find(CreateKey(1.0), result));
+
+    auto key = CreateKey(0.0);
+    key.ThickSlicesNum = 3;
+    CPPUNIT_ASSERT_MESSAGE("Other reslice parameters", !cache.Find(key, result));
+
+    const int otherOwner = 0;
+    key = CreateKey(0.0);
+    key.Owner = &otherOwner;
+    CPPUNIT_ASSERT_MESSAGE("Other owner", !cache.Find(key, result));
+
+    key = CreateKey(0.0);
+    key.IsValid = false;
+    CPPUNIT_ASSERT_MESSAGE("Invalid key", !cache.Find(key, result));
+
+    CPPUNIT_ASSERT(cache.Find(CreateKey(0.0), result));
+  }
+
+  void SetVolume_ModifiedVolume_InvalidatesSlices()
+  {
+    mitk::ResliceCache cache;
+    cache.Insert(CreateEntry(CreateKey(0.0)));
+    cache.Insert(CreateEntry(CreateKey(1.0)));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), cache.GetNumberOfEntries());
+
+    mitk::ResliceCache::Entry result;
+
+    // writers that only modify the data item
+    m_Image->GetVolumeData(0)->Modified();
+    CPPUNIT_ASSERT_MESSAGE("Modified volume data", !cache.Find(CreateKey(0.0), result));
+
+    cache.Insert(CreateEntry(CreateKey(0.0)));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Slices of the old version are removed.", std::size_t(1), cache.GetNumberOfEntries());
+    CPPUNIT_ASSERT(cache.Find(CreateKey(0.0), result));
+
+    // writers that modify the image
+    m_Image->Modified();
+    CPPUNIT_ASSERT_MESSAGE("Modified image", !cache.Find(CreateKey(0.0), result));
+
+    cache.Remove(&m_Owner);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetNumberOfEntries());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetMemorySize());
+  }
+
+  void Insert_ExceedingMemoryLimit_RemovesLeastRecentlyUsed()
+  {
+    mitk::ResliceCache cache;
+    cache.Insert(CreateEntry(CreateKey(0.0)));
+    const auto sliceSize = cache.GetMemorySize();
+    cache.SetMemoryLimit(2 * sliceSize);
+
+    cache.Insert(CreateEntry(CreateKey(1.0)));
+
+    mitk::ResliceCache::Entry result;
+    CPPUNIT_ASSERT(cache.Find(CreateKey(0.0), result));
+
+    cache.Insert(CreateEntry(CreateKey(2.0)));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), cache.GetNumberOfEntries());
+    CPPUNIT_ASSERT_MESSAGE("Recently used slice is kept.", cache.Find(CreateKey(0.0), result));
+    CPPUNIT_ASSERT_MESSAGE("Least recently used slice is removed.", !cache.Find(CreateKey(1.0), result));
+
+    cache.SetMemoryLimit(0);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetNumberOfEntries());
+    cache.Insert(CreateEntry(CreateKey(0.0)));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetNumberOfEntries());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkResliceCache)
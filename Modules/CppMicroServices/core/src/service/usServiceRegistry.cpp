@@ -34,6 +34,16 @@
 
 US_BEGIN_NAMESPACE
 
+namespace {
+
+// Upper bounds for the filter caches. The caches are simply cleared
+// when they are exceeded, which should not happen for typical usage
+// with a limited set of (constant) filter strings.
+const std::size_t MAX_CACHED_FILTER_EXPRESSIONS = 1024;
+const std::size_t MAX_CACHED_FILTER_RESULTS_PER_CLASS = 256;
+
+}
+
 ServicePropertiesImpl ServiceRegistry::CreateServiceProperties(const ServiceProperties& in,
                                                                const std::vector<std::string>& classes,
                                                                bool isFactory, bool isPrototypeFactory,
@@ -81,6 +91,8 @@ void ServiceRegistry::Clear()
   services.clear();
   serviceRegistrations.clear();
   classServices.clear();
+  filterExpressions.clear();
+  filterServices.clear();
   core = nullptr;
 }
 
@@ -123,6 +135,7 @@ ServiceRegistrationBase ServiceRegistry::RegisterService(ModulePrivate* module,
           std::lower_bound(s.begin(), s.end(), res);
       s.insert(ip, res);
     }
+    InvalidateFilterCache_unlocked(classes);
   }
 
   ServiceReferenceBase r = res.GetReference(std::string());
@@ -145,6 +158,41 @@ void ServiceRegistry::UpdateServiceRegistrationOrder(const ServiceRegistrationBa
     s.erase(std::remove(s.begin(), s.end(), sr), s.end());
     s.insert(std::lower_bound(s.begin(), s.end(), sr), sr);
   }
+  InvalidateFilterCache_unlocked(classes);
+}
+
+void ServiceRegistry::InvalidateFilterCache(const std::vector<std::string>& classes)
+{
+  MutexLock lock(mutex);
+  InvalidateFilterCache_unlocked(classes);
+}
+
+void ServiceRegistry::InvalidateFilterCache_unlocked(const std::vector<std::string>& classes)
+{
+  for (std::vector<std::string>::const_iterator i = classes.begin();
+       i != classes.end(); ++i)
+  {
+    filterServices.erase(*i);
+  }
+  // queries without class name may match services of any class
+  filterServices.erase(std::string());
+}
+
+const LDAPExpr& ServiceRegistry::GetLDAPExpr_unlocked(const std::string& filter) const
+{
+  MapFilterExpressions::const_iterator i = filterExpressions.find(filter);
+  if (i != filterExpressions.end())
+  {
+    return i->second;
+  }
+
+  // parse before touching the cache, invalid filters throw
+  LDAPExpr ldap(filter);
+  if (filterExpressions.size() >= MAX_CACHED_FILTER_EXPRESSIONS)
+  {
+    filterExpressions.clear();
+  }
+  return filterExpressions.insert(std::make_pair(filter, ldap)).first->second;
 }
 
 void ServiceRegistry::Get(const std::string& clazz,
@@ -194,43 +242,88 @@ void ServiceRegistry::Get(const std::string& clazz, const std::string& filter,
 
 void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string& filter,
                           ModulePrivate* module, std::vector<ServiceReferenceBase>& res) const
+{
+  const std::vector<ServiceRegistrationBase>* matches = nullptr;
+  if (filter.empty())
+  {
+    if (clazz.empty())
+    {
+      matches = &serviceRegistrations;
+    }
+    else
+    {
+      MapClassServices::const_iterator it = classServices.find(clazz);
+      if (it == classServices.end())
+      {
+        return;
+      }
+      matches = &it->second;
+    }
+  }
+  else
+  {
+    MapFilterServices& cachedServices = filterServices[clazz];
+    MapFilterServices::const_iterator it = cachedServices.find(filter);
+    if (it == cachedServices.end())
+    {
+      std::vector<ServiceRegistrationBase> v;
+      GetMatching_unlocked(clazz, filter, v);
+      if (cachedServices.size() >= MAX_CACHED_FILTER_RESULTS_PER_CLASS)
+      {
+        cachedServices.clear();
+      }
+      it = cachedServices.insert(std::make_pair(filter, v)).first;
+    }
+    matches = &it->second;
+  }
+
+  for (std::vector<ServiceRegistrationBase>::const_iterator s = matches->begin();
+       s != matches->end(); ++s)
+  {
+    res.push_back(s->GetReference(clazz));
+  }
+
+  if (!res.empty())
+  {
+    if (module != nullptr)
+    {
+      core->serviceHooks.FilterServiceReferences(module->moduleContext, clazz, filter, res);
+    }
+    else
+    {
+      core->serviceHooks.FilterServiceReferences(nullptr, clazz, filter, res);
+    }
+  }
+}
+
+void ServiceRegistry::GetMatching_unlocked(const std::string& clazz, const std::string& filter,
+                                           std::vector<ServiceRegistrationBase>& res) const
 {
   std::vector<ServiceRegistrationBase>::const_iterator s;
   std::vector<ServiceRegistrationBase>::const_iterator send;
   std::vector<ServiceRegistrationBase> v;
-  LDAPExpr ldap;
   if (clazz.empty())
   {
-    if (!filter.empty())
+    LDAPExpr::ObjectClassSet matched;
+    if (GetLDAPExpr_unlocked(filter).GetMatchedObjectClasses(matched))
     {
-      ldap = LDAPExpr(filter);
-      LDAPExpr::ObjectClassSet matched;
-      if (ldap.GetMatchedObjectClasses(matched))
+      for(LDAPExpr::ObjectClassSet::const_iterator className = matched.begin();
+          className != matched.end(); ++className)
       {
-        v.clear();
-        for(LDAPExpr::ObjectClassSet::const_iterator className = matched.begin();
-            className != matched.end(); ++className)
-        {
-          MapClassServices::const_iterator i = classServices.find(*className);
-          if (i != classServices.end())
-          {
-            std::copy(i->second.begin(), i->second.end(), std::back_inserter(v));
-          }
-        }
-        if (!v.empty())
+        MapClassServices::const_iterator i = classServices.find(*className);
+        if (i != classServices.end())
         {
-          s = v.begin();
-          send = v.end();
-        }
-        else
-        {
-          return;
+          std::copy(i->second.begin(), i->second.end(), std::back_inserter(v));
         }
       }
+      if (!v.empty())
+      {
+        s = v.begin();
+        send = v.end();
+      }
       else
       {
-        s = serviceRegistrations.begin();
-        send = serviceRegistrations.end();
+        return;
       }
     }
     else
@@ -251,31 +344,14 @@ void ServiceRegistry::Get_unlocked(const std::string& clazz, const std::string&
     {
       return;
     }
-    if (!filter.empty())
-    {
-      ldap = LDAPExpr(filter);
-    }
   }
 
+  const LDAPExpr& ldap = GetLDAPExpr_unlocked(filter);
   for (; s != send; ++s)
   {
-    ServiceReferenceBase sri = s->GetReference(clazz);
-
-    if (filter.empty() || ldap.Evaluate(s->d->properties, false))
+    if (ldap.Evaluate(s->d->properties, false))
     {
-      res.push_back(sri);
-    }
-  }
-
-  if (!res.empty())
-  {
-    if (module != nullptr)
-    {
-      core->serviceHooks.FilterServiceReferences(module->moduleContext, clazz, filter, res);
-    }
-    else
-    {
-      core->serviceHooks.FilterServiceReferences(nullptr, clazz, filter, res);
+      res.push_back(*s);
     }
   }
 }
@@ -287,6 +363,7 @@ void ServiceRegistry::RemoveServiceRegistration(const ServiceRegistrationBase& s
   assert(sr.d->properties.Value(ServiceConstants::OBJECTCLASS()).Type() == typeid(std::vector<std::string>));
   const std::vector<std::string>& classes = ref_any_cast<std::vector<std::string> >(
         sr.d->properties.Value(ServiceConstants::OBJECTCLASS()));
+  InvalidateFilterCache_unlocked(classes);
   services.erase(sr);
   serviceRegistrations.erase(std::remove(serviceRegistrations.begin(), serviceRegistrations.end(), sr),
                              serviceRegistrations.end());
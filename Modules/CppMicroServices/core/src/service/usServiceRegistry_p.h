@@ -27,6 +27,7 @@
 #include "usServiceRegistration.h"
 
 #include "usThreads_p.h"
+#include "usLDAPExpr_p.h"
 
 US_BEGIN_NAMESPACE
 
@@ -169,6 +170,14 @@ public:
    */
   void GetUsedByModule(Module* m, std::vector<ServiceRegistrationBase>& serviceRegs) const;
 
+  /**
+   * Discard cached filter results which may be affected by a
+   * change of the properties of a service.
+   *
+   * @param classes The class names of the modified service.
+   */
+  void InvalidateFilterCache(const std::vector<std::string>& classes);
+
 private:
 
   friend class ServiceHooks;
@@ -178,6 +187,38 @@ private:
   void Get_unlocked(const std::string& clazz, const std::string& filter,
                     ModulePrivate* module, std::vector<ServiceReferenceBase>& serviceRefs) const;
 
+  /**
+   * Get all registrations implementing a certain class which match
+   * the given non-empty property filter.
+   */
+  void GetMatching_unlocked(const std::string& clazz, const std::string& filter,
+                            std::vector<ServiceRegistrationBase>& serviceRegs) const;
+
+  /**
+   * Get the compiled LDAP expression for a filter string. Parsed
+   * filters are cached, since the same filters are used over and over.
+   */
+  const LDAPExpr& GetLDAPExpr_unlocked(const std::string& filter) const;
+
+  void InvalidateFilterCache_unlocked(const std::vector<std::string>& classes);
+
+  typedef US_UNORDERED_MAP_TYPE<std::string, LDAPExpr> MapFilterExpressions;
+  typedef US_UNORDERED_MAP_TYPE<std::string, std::vector<ServiceRegistrationBase> > MapFilterServices;
+  typedef US_UNORDERED_MAP_TYPE<std::string, MapFilterServices> MapClassFilterServices;
+
+  /**
+   * Cache of compiled LDAP expressions, indexed by filter string.
+   */
+  mutable MapFilterExpressions filterExpressions;
+
+  /**
+   * Cache of filter results, indexed by class name (empty for queries
+   * without class name) and filter string. The matching registrations
+   * are ordered like in classServices. Entries of a class are discarded
+   * when a service of this class is registered, modified or unregistered.
+   */
+  mutable MapClassFilterServices filterServices;
+
   // purposely not implemented
   ServiceRegistry(const ServiceRegistry&);
   ServiceRegistry& operator=(const ServiceRegistry&);
@@ -46,6 +46,7 @@ US_USE_NAMESPACE
 #error High precision timer support nod available on this platform
 #endif
 
+#include <sstream>
 #include <vector>
 
 class HighPrecisionTimer
@@ -205,6 +206,7 @@ public:
   void TestRegisterServices();
 
   void TestModifyServices();
+  void TestGetFilteredServices();
   void TestUnregisterServices();
 
 private:
@@ -217,6 +219,7 @@ private:
   void AddListeners(int n);
   void RegisterServices(int n);
   void ModifyServices();
+  std::size_t GetFilteredServices(int n);
   void UnregisterServices();
 
 };
@@ -385,6 +388,33 @@ void ServiceRegistryPerformanceTest::ModifyServices()
   }
 }
 
+void ServiceRegistryPerformanceTest::TestGetFilteredServices()
+{
+  const int nQueries = 1000;
+  Log() << "Query " << nQueries << " times for one of " << nServices
+        << " services with a property filter\n";
+
+  HighPrecisionTimer t;
+  t.Start();
+  std::size_t nFound = GetFilteredServices(nQueries);
+  long long ms = t.ElapsedMilli();
+  Log() << "queries took " << ms << "ms\n";
+  US_TEST_CONDITION_REQUIRED(nFound == static_cast<std::size_t>(nQueries),
+                             "Each filtered query must return exactly one service");
+}
+
+std::size_t ServiceRegistryPerformanceTest::GetFilteredServices(int n)
+{
+  std::size_t nFound = 0;
+  for(int i = 0; i < n; i++)
+  {
+    std::stringstream ss;
+    ss << "(perf.service.value=" << (i % 10) * 2 << ")";
+    nFound += mc->GetServiceReferences<IPerfTestService>(ss.str()).size();
+  }
+  return nFound;
+}
+
 void ServiceRegistryPerformanceTest::TestUnregisterServices()
 {
   Log() << "Unregister all services, and check that we get #of services ("
@@ -421,6 +451,7 @@ int usServiceRegistryPerformanceTest(int /*argc*/, char* /*argv*/[])
   perfTest.TestAddListeners();
   perfTest.TestRegisterServices();
   perfTest.TestModifyServices();
+  perfTest.TestGetFilteredServices();
   perfTest.TestUnregisterServices();
   perfTest.CleanupTestCase();
 
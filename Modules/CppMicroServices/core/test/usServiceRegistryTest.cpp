@@ -127,6 +127,59 @@ void TestServicePropertiesUpdate()
   US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>().empty(), "Testing service count")
 }
 
+void TestFilteredServiceReferences()
+{
+  struct TestServiceA : public ITestServiceA
+  {
+  };
+
+  ModuleContext* context = GetModuleContext();
+
+  TestServiceA s1;
+  ServiceProperties props;
+  props["mime"] = std::string("application/dicom");
+
+  ServiceRegistration<ITestServiceA> reg1 = context->RegisterService<ITestServiceA>(&s1, props);
+
+  const std::string filter = "(mime=application/dicom)";
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>(filter).size() == 1, "Testing filtered service count")
+  // repeated queries are answered from the filter cache
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>(filter).size() == 1, "Testing cached filtered service count")
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences("", "(&(objectclass=ITestServiceA)" + filter + ")").size() == 1, "Testing filtered service count without class")
+
+  // registering a service must invalidate cached results
+  TestServiceA s2;
+  ServiceRegistration<ITestServiceA> reg2 = context->RegisterService<ITestServiceA>(&s2, props);
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>(filter).size() == 2, "Testing filtered service count after registration")
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences("", "(&(objectclass=ITestServiceA)" + filter + ")").size() == 2, "Testing filtered service count without class after registration")
+
+  // modifying properties must invalidate cached results
+  props["mime"] = std::string("image/nrrd");
+  reg1.SetProperties(props);
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>(filter).size() == 1, "Testing filtered service count after modification")
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>("(mime=image/nrrd)").size() == 1, "Testing filtered service count for modified property")
+
+  // unregistering a service must invalidate cached results
+  reg2.Unregister();
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>(filter).empty(), "Testing filtered service count after unregistration")
+
+  // invalid filters must still be reported on each call
+  for (int i = 0; i < 2; ++i)
+  {
+    try
+    {
+      context->GetServiceReferences<ITestServiceA>("(mime=image/nrrd");
+      US_TEST_FAILED_MSG(<< "Invalid filter did not throw")
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+  }
+
+  reg1.Unregister();
+  US_TEST_CONDITION_REQUIRED(context->GetServiceReferences<ITestServiceA>("(mime=image/nrrd)").empty(), "Testing filtered service count after unregistering all")
+}
+
 
 int usServiceRegistryTest(int /*argc*/, char* /*argv*/[])
 {
@@ -135,6 +188,7 @@ int usServiceRegistryTest(int /*argc*/, char* /*argv*/[])
   TestServiceInterfaceId();
   TestMultipleServiceRegistrations();
   TestServicePropertiesUpdate();
+  TestFilteredServiceReferences();
 
   US_TEST_END()
 }
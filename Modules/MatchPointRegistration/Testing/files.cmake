@@ -1,4 +1,5 @@
 SET(MODULE_TESTS
   mitkTimeFramesRegistrationHelperTest.cpp
+  mitkImageMappingHelperTest.cpp
   itkStitchImageFilterTest.cpp
 )
\ No newline at end of file
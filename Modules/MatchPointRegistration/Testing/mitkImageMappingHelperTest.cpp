@@ -0,0 +1,184 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+#include "mitkImageMappingHelper.h"
+
+#include <mitkITKImageImport.h>
+#include <mitkImage.h>
+
+#include <mapRegistration.h>
+#include <mapRegistrationManipulator.h>
+#include <mapPreCachedRegistrationKernel.h>
+#include <mapNullRegistrationKernel.h>
+
+#include <itkDisplacementFieldTransform.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <cmath>
+
+class mitkImageMappingHelperTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageMappingHelperTestSuite);
+  MITK_TEST(Map_WithMappingFieldCache_EqualsUncached);
+  MITK_TEST(Map_MappingFieldCache_IsBoundedBySize);
+  MITK_TEST(Map_OtherRegistration_ComputesNewMappingField);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<float, 3> ImageType;
+  typedef ::map::core::Registration<3, 3> RegistrationType;
+  typedef itk::DisplacementFieldTransform<double, 3> DisplacementTransformType;
+
+  mitk::Image::Pointer m_Input;
+  RegistrationType::Pointer m_Registration;
+  DisplacementTransformType::Pointer m_InverseTransform;
+
+  /** Image with a smooth pattern, so that the interpolation is not trivial.*/
+  mitk::Image::Pointer CreateInput()
+  {
+    ImageType::SizeType size;
+    size.Fill(20);
+    ImageType::Pointer image = ImageType::New();
+    image->SetRegions(size);
+    ImageType::SpacingType spacing;
+    spacing[0] = 1.0;
+    spacing[1] = 1.5;
+    spacing[2] = 2.0;
+    image->SetSpacing(spacing);
+    image->Allocate();
+
+    for (itk::ImageRegionIteratorWithIndex<ImageType> iter(image, image->GetLargestPossibleRegion()); !iter.IsAtEnd(); ++iter)
+    {
+      const auto index = iter.GetIndex();
+      iter.Set(100.0 * std::sin(0.3 * index[0]) * std::cos(0.2 * index[1]) + 5.0 * index[2]);
+    }
+
+    return mitk::ImportItkImage(image)->Clone();
+  }
+
+  /** Deformable registration (displacement field), thus map() cannot use a matrix for the mapping.*/
+  void CreateRegistration(double amplitude)
+  {
+    typedef DisplacementTransformType::DisplacementFieldType FieldType;
+    FieldType::SizeType size;
+    size.Fill(12);
+    FieldType::SpacingType spacing;
+    spacing.Fill(3.0);
+    FieldType::Pointer field = FieldType::New();
+    field->SetRegions(size);
+    field->SetSpacing(spacing);
+    field->Allocate();
+
+    for (itk::ImageRegionIteratorWithIndex<FieldType> iter(field, field->GetLargestPossibleRegion()); !iter.IsAtEnd(); ++iter)
+    {
+      const auto index = iter.GetIndex();
+      FieldType::PixelType displacement;
+      displacement[0] = amplitude * std::sin(0.5 * index[1]);
+      displacement[1] = amplitude * std::cos(0.4 * index[2]);
+      displacement[2] = 0.5 * amplitude;
+      iter.Set(displacement);
+    }
+
+    m_InverseTransform = DisplacementTransformType::New();
+    m_InverseTransform->SetDisplacementField(field);
+
+    auto inverseKernel = ::map::core::PreCachedRegistrationKernel<3, 3>::New();
+    inverseKernel->setTransformModel(m_InverseTransform);
+
+    m_Registration = RegistrationType::New();
+    ::map::core::RegistrationManipulator<RegistrationType> manipulator(m_Registration);
+    manipulator.setInverseMapping(inverseKernel);
+    manipulator.setDirectMapping(::map::core::NullRegistrationKernel<3, 3>::New());
+  }
+
+  mitk::Image::Pointer Map(mitk::ImageMappingHelper::MappingFieldCache* cache)
+  {
+    return mitk::ImageMappingHelper::map(m_Input, m_Registration, false, -1000, nullptr, false, 0,
+      mitk::ImageMappingInterpolator::Linear, cache);
+  }
+
+public:
+  void setUp() override
+  {
+    m_Input = CreateInput();
+    CreateRegistration(2.5);
+  }
+
+  void tearDown() override
+  {
+    m_Input = nullptr;
+    m_Registration = nullptr;
+    m_InverseTransform = nullptr;
+  }
+
+  void Map_WithMappingFieldCache_EqualsUncached()
+  {
+    auto uncached = Map(nullptr);
+
+    mitk::ImageMappingHelper::MappingFieldCache cache;
+    auto firstCached = Map(&cache);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Mapping field is cached.", std::size_t(1), cache.GetNumberOfFields());
+    CPPUNIT_ASSERT_MESSAGE("Cache reports the size of the field.", cache.GetSize() > 0);
+
+    auto secondCached = Map(&cache);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Cached mapping field is reused.", std::size_t(1), cache.GetNumberOfFields());
+
+    CPPUNIT_ASSERT_MESSAGE("Mapping with a newly computed field equals the mapping without cache.",
+      mitk::Equal(*uncached, *firstCached, 1e-4, true));
+    CPPUNIT_ASSERT_MESSAGE("Mapping with a cached field equals the mapping without cache.",
+      mitk::Equal(*uncached, *secondCached, 1e-4, true));
+
+    cache.Clear();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetNumberOfFields());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetSize());
+  }
+
+  void Map_MappingFieldCache_IsBoundedBySize()
+  {
+    auto uncached = Map(nullptr);
+
+    mitk::ImageMappingHelper::MappingFieldCache tooSmallCache(1024);
+    auto result = Map(&tooSmallCache);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Fields larger than the cache are not cached.", std::size_t(0), tooSmallCache.GetNumberOfFields());
+    CPPUNIT_ASSERT_MESSAGE("Mapping without fitting cache equals the mapping without cache.",
+      mitk::Equal(*uncached, *result, 1e-4, true));
+
+    mitk::ImageMappingHelper::MappingFieldCache cache;
+    Map(&cache);
+    const auto fieldSize = cache.GetSize();
+    CPPUNIT_ASSERT(fieldSize > 0);
+
+    cache.SetMaximumSize(fieldSize - 1);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Reducing the maximum size removes fields.", std::size_t(0), cache.GetNumberOfFields());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), cache.GetSize());
+  }
+
+  void Map_OtherRegistration_ComputesNewMappingField()
+  {
+    mitk::ImageMappingHelper::MappingFieldCache cache;
+    auto before = Map(&cache);
+    const auto fieldSize = cache.GetSize();
+
+    CreateRegistration(-1.5);
+    auto uncached = Map(nullptr);
+    auto cached = Map(&cache);
+
+    CPPUNIT_ASSERT_MESSAGE("Field of the new registration is computed.", mitk::Equal(*uncached, *cached, 1e-4, true));
+    CPPUNIT_ASSERT_MESSAGE("Different registrations yield different results.", !mitk::Equal(*before, *cached, 1e-4, false));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Cache holds the fields of both registrations.", 2 * fieldSize, cache.GetSize());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageMappingHelper)
@@ -14,6 +14,20 @@ found in the LICENSE file.
 #include "mitkTestFixture.h"
 
 #include "mitkTimeFramesRegistrationHelper.h"
+#include "mitkMultiModalTransDefaultRegistrationAlgorithm.h"
+
+#include <mitkITKImageImport.h>
+#include <mitkImage.h>
+#include <mitkImageTimeSelector.h>
+
+#include <mapAlgorithmEvents.h>
+#include <mapDiscreteElements.h>
+
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
 
 class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
 {
@@ -24,12 +38,76 @@ class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
   MITK_TEST(SetErrorValue_GetErrorValue);
   MITK_TEST(SetAllowUnregPixels_GetAllowUnregPixels);
   MITK_TEST(SetInterpolatorType_GetInterpolatorType);
+  MITK_TEST(SetNumberOfThreads_GetNumberOfThreads);
   MITK_TEST(Set_Get_Clear_IgnoreList);
+  MITK_TEST(Generate_Serial_ForwardsAlgorithmEvents);
+  MITK_TEST(Generate_Parallel_EqualsSerial);
+  MITK_TEST(Generate_Parallel_ForwardsCloneAlgorithmEvents);
   CPPUNIT_TEST_SUITE_END();
 private:
+  typedef map::core::discrete::Elements<3>::InternalImageType FrameImageType;
+  typedef mitk::MultiModalTranslationDefaultRegistrationAlgorithm<FrameImageType> AlgorithmType;
+
   mitk::TimeFramesRegistrationHelper::Pointer frameRegHelper;
   mitk::TimeFramesRegistrationHelper::IgnoreListType ignoreList;
 
+  /** 3D+t image with a gaussian blob that moves along the x axis from frame to frame.*/
+  mitk::Image::Pointer Create4DImage(unsigned int timeSteps)
+  {
+    mitk::Image::Pointer image = mitk::Image::New();
+
+    for (unsigned int t = 0; t < timeSteps; ++t)
+    {
+      FrameImageType::SizeType size;
+      size.Fill(24);
+      FrameImageType::Pointer frame = FrameImageType::New();
+      frame->SetRegions(size);
+      frame->Allocate();
+
+      for (itk::ImageRegionIteratorWithIndex<FrameImageType> iter(frame, frame->GetLargestPossibleRegion()); !iter.IsAtEnd(); ++iter)
+      {
+        const auto index = iter.GetIndex();
+        const double dx = index[0] - (10.0 + t);
+        const double dy = index[1] - 12.0;
+        const double dz = index[2] - 12.0;
+        iter.Set(100.0 * std::exp(-(dx * dx + dy * dy + dz * dz) / 18.0));
+      }
+
+      if (0 == t)
+      {
+        mitk::Image::Pointer firstFrame = mitk::ImportItkImage(frame);
+        image->Initialize(firstFrame->GetPixelType(), *(firstFrame->GetGeometry()), 1, timeSteps);
+      }
+      image->SetVolume(frame->GetBufferPointer(), t);
+    }
+
+    return image;
+  }
+
+  /** Registers all frames and records the comments of the frame events of the helper.*/
+  mitk::Image::Pointer RegisterFrames(const mitk::Image* image, unsigned int numberOfThreads,
+                                      std::vector<std::string>& frameEvents)
+  {
+    AlgorithmType::Pointer algorithm = AlgorithmType::New();
+
+    mitk::TimeFramesRegistrationHelper::Pointer helper = mitk::TimeFramesRegistrationHelper::New();
+    helper->Set4DImage(image);
+    helper->SetAlgorithm(algorithm);
+    helper->SetNumberOfThreads(numberOfThreads);
+    helper->SetIgnoreList({ 2 });
+
+    helper->AddObserver(mitk::FrameRegistrationEvent(), [&frameEvents](const itk::EventObject& event)
+    {
+      frameEvents.push_back(dynamic_cast<const mitk::FrameRegistrationEvent&>(event).getComment());
+    });
+    helper->AddObserver(mitk::FrameMappingEvent(), [&frameEvents](const itk::EventObject& event)
+    {
+      frameEvents.push_back(dynamic_cast<const mitk::FrameMappingEvent&>(event).getComment());
+    });
+
+    return helper->GetRegisteredImage();
+  }
+
 public:
   void setUp() override
   {
@@ -87,6 +165,13 @@ public:
                                  mitk::ImageMappingInterpolator::NearestNeighbor, frameRegHelper->GetInterpolatorType());
   }
 
+  void SetNumberOfThreads_GetNumberOfThreads()
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on default value", 1u, frameRegHelper->GetNumberOfThreads());
+    frameRegHelper->SetNumberOfThreads(4);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on changed value", 4u, frameRegHelper->GetNumberOfThreads());
+  }
+
   void Set_Get_Clear_IgnoreList()
   {
     CPPUNIT_ASSERT(frameRegHelper->GetIgnoreList().empty());
@@ -102,6 +187,75 @@ public:
     CPPUNIT_ASSERT(frameRegHelper->GetIgnoreList().empty());
   }
 
+  void Generate_Serial_ForwardsAlgorithmEvents()
+  {
+    mitk::Image::Pointer image = this->Create4DImage(3);
+
+    AlgorithmType::Pointer algorithm = AlgorithmType::New();
+    unsigned int algorithmEvents = 0;
+    algorithm->AddObserver(itk::AnyEvent(), [&algorithmEvents](const itk::EventObject&) { ++algorithmEvents; });
+
+    frameRegHelper->Set4DImage(image);
+    frameRegHelper->SetAlgorithm(algorithm);
+    frameRegHelper->GetRegisteredImage();
+
+    CPPUNIT_ASSERT_MESSAGE("Observers of the set algorithm receive its events.", algorithmEvents > 0);
+  }
+
+  void Generate_Parallel_ForwardsCloneAlgorithmEvents()
+  {
+    mitk::Image::Pointer image = this->Create4DImage(4);
+
+    AlgorithmType::Pointer algorithm = AlgorithmType::New();
+    unsigned int algorithmEvents = 0;
+    algorithm->AddObserver(itk::AnyEvent(), [&algorithmEvents](const itk::EventObject&) { ++algorithmEvents; });
+
+    unsigned int forwardedEvents = 0;
+    frameRegHelper->AddObserver(::map::events::AlgorithmEvent(),
+                                [&forwardedEvents](const itk::EventObject&) { ++forwardedEvents; });
+
+    frameRegHelper->Set4DImage(image);
+    frameRegHelper->SetAlgorithm(algorithm);
+    frameRegHelper->SetNumberOfThreads(3);
+    frameRegHelper->GetRegisteredImage();
+
+    CPPUNIT_ASSERT_MESSAGE("The clones register the frames.", algorithmEvents == 0);
+    CPPUNIT_ASSERT_MESSAGE("Observers of the helper receive the events of the clones.", forwardedEvents > 0);
+  }
+
+  void Generate_Parallel_EqualsSerial()
+  {
+    const unsigned int timeSteps = 6;
+    mitk::Image::Pointer image = this->Create4DImage(timeSteps);
+
+    std::vector<std::string> serialEvents;
+    mitk::Image::Pointer serialResult = this->RegisterFrames(image, 1, serialEvents);
+
+    std::vector<std::string> parallelEvents;
+    mitk::Image::Pointer parallelResult = this->RegisterFrames(image, 3, parallelEvents);
+
+    CPPUNIT_ASSERT(serialEvents == parallelEvents);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2 * (timeSteps - 2)), serialEvents.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("Registred frame #1"), serialEvents.front());
+    CPPUNIT_ASSERT_EQUAL(std::string("Mapped frame #5"), serialEvents.back());
+
+    for (unsigned int t = 0; t < timeSteps; ++t)
+    {
+      mitk::ImageTimeSelector::Pointer serialSelector = mitk::ImageTimeSelector::New();
+      serialSelector->SetInput(serialResult);
+      serialSelector->SetTimeNr(t);
+      serialSelector->UpdateLargestPossibleRegion();
+
+      mitk::ImageTimeSelector::Pointer parallelSelector = mitk::ImageTimeSelector::New();
+      parallelSelector->SetInput(parallelResult);
+      parallelSelector->SetTimeNr(t);
+      parallelSelector->UpdateLargestPossibleRegion();
+
+      CPPUNIT_ASSERT_MESSAGE("Frame #" + std::to_string(t) + " of the concurrent registration equals the serial one.",
+                             mitk::Equal(*(serialSelector->GetOutput()), *(parallelSelector->GetOutput()), 1e-3, true));
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkTimeFramesRegistrationHelper)
@@ -23,6 +23,9 @@ found in the LICENSE file.
 
 #include "MitkMatchPointRegistrationExports.h"
 
+#include <memory>
+#include <vector>
+
 namespace mitk
 {
   struct ImageMappingInterpolator
@@ -47,6 +50,51 @@ namespace mitk
     typedef ::mitk::Image InputImageType;
     typedef ::mitk::Image ResultImageType;
 
+    /**Cache for the dense mapping fields that map() computes for registrations without a matrix based
+     * inverse kernel (e.g. deformable 3D registrations). Such a field stores the inverse mapping of every
+     * voxel of a result grid; it is reused if further images or time steps are mapped with the same (unmodified)
+     * registration into the same result grid.
+     * The cache is owned by the caller, thus it only lives as long as the caller needs it. Its size is
+     * bounded by bytes: least recently used fields are removed if the bound is exceeded and fields that are
+     * larger than the bound are not cached at all (map() uses the MatchPoint mapping task in this case).
+     * The cache may be used by several threads concurrently.*/
+    class MITKMATCHPOINTREGISTRATION_EXPORT MappingFieldCache
+    {
+    public:
+      /**Default bound of the cache size in bytes.*/
+      static const std::size_t DefaultMaximumSize;
+
+      explicit MappingFieldCache(std::size_t maximumSize = DefaultMaximumSize);
+      ~MappingFieldCache();
+
+      MappingFieldCache(const MappingFieldCache&) = delete;
+      MappingFieldCache& operator=(const MappingFieldCache&) = delete;
+
+      /**Sets the bound of the cache size in bytes. Fields are removed if the cache exceeds the new bound.*/
+      void SetMaximumSize(std::size_t maximumSize);
+      std::size_t GetMaximumSize() const;
+
+      /**Size of all cached fields in bytes.*/
+      std::size_t GetSize() const;
+      std::size_t GetNumberOfFields() const;
+
+      /**Removes all cached fields.*/
+      void Clear();
+
+      /**Mapping field of one registration and result grid. Defined and used by the implementation of map().*/
+      struct Field;
+
+      /**Returns the field of the registration for the result grid described by gridKey, or nullptr if it is
+       * not cached (or the registration was modified since the field was computed).*/
+      std::shared_ptr<const Field> GetField(const RegistrationType* registration, const std::vector<double>& gridKey) const;
+      /**Adds the field to the cache, unless it is larger than the maximum size.*/
+      void AddField(const std::shared_ptr<const Field>& field);
+
+    private:
+      struct Impl;
+      std::unique_ptr<Impl> m_Impl;
+    };
+
     /**Helper that maps a given input image
      * @param input Image that should be mapped.
      * @param registration Pointer to the registration instance that should be used for mapping
@@ -56,6 +104,9 @@ namespace mitk
      * @param throwOnMappingError Indicates if mapping should fail with an exception (true), if the registration does not cover/support the whole requested region for mapping into the result image.
      * @param errorValue Indicates the value that should be used if an mapping error occurs (and throwOnMappingError is false).
      * @param interpolatorType Indicates the type of interpolation strategy that should be used.
+     * @param mappingFieldCache Optional cache for the dense mapping fields of registrations without a matrix based
+     * inverse kernel (see MappingFieldCache). If it is not set, such a field is only computed to map the time steps of
+     * a dynamic image and released when map() returns.
      * @pre input must be valid
      * @pre registration must be valid
      * @pre Dimensionality of the registration must match with the input imageinput must be valid
@@ -65,7 +116,8 @@ namespace mitk
     MITKMATCHPOINTREGISTRATION_EXPORT ResultImageType::Pointer map(const InputImageType* input, const RegistrationType* registration,
       bool throwOnOutOfInputAreaError = false, const double& paddingValue = 0,
       const ResultImageGeometryType* resultGeometry = nullptr,
-      bool throwOnMappingError = true, const double& errorValue = 0, mitk::ImageMappingInterpolator::Type interpolatorType = mitk::ImageMappingInterpolator::Linear);
+      bool throwOnMappingError = true, const double& errorValue = 0, mitk::ImageMappingInterpolator::Type interpolatorType = mitk::ImageMappingInterpolator::Linear,
+      MappingFieldCache* mappingFieldCache = nullptr);
 
     /**Helper that maps a given input image.
      * @overload
@@ -77,6 +129,9 @@ namespace mitk
      * @param throwOnMappingError Indicates if mapping should fail with an exception (true), if the registration does not cover/support the whole requested region for mapping into the result image.
      * @param errorValue Indicates the value that should be used if an mapping error occurs (and throwOnMappingError is false).
      * @param interpolatorType Indicates the type of interpolation strategy that should be used.
+     * @param mappingFieldCache Optional cache for the dense mapping fields of registrations without a matrix based
+     * inverse kernel (see MappingFieldCache). If it is not set, such a field is only computed to map the time steps of
+     * a dynamic image and released when map() returns.
      * @pre input must be valid
      * @pre registration must be valid
      * @pre Dimensionality of the registration must match with the input imageinput must be valid
@@ -86,7 +141,8 @@ namespace mitk
     MITKMATCHPOINTREGISTRATION_EXPORT ResultImageType::Pointer map(const InputImageType* input, const MITKRegistrationType* registration,
       bool throwOnOutOfInputAreaError = false, const double& paddingValue = 0,
       const ResultImageGeometryType* resultGeometry = nullptr,
-      bool throwOnMappingError = true, const double& errorValue = 0, mitk::ImageMappingInterpolator::Type interpolatorType = mitk::ImageMappingInterpolator::Linear);
+      bool throwOnMappingError = true, const double& errorValue = 0, mitk::ImageMappingInterpolator::Type interpolatorType = mitk::ImageMappingInterpolator::Linear,
+      MappingFieldCache* mappingFieldCache = nullptr);
 
     /**Method clones the input image and applies the registration by applying it to the Geometry3D of the image.
     Thus this method only produces a result if the passed registration has an direct mapping kernel that
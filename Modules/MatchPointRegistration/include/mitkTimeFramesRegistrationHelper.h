@@ -39,6 +39,16 @@ namespace mitk
    * - mitk::FrameRegistrationEvent: when ever a frame was registered.
    * - mitk::FrameMappingEvent: when ever a frame was mapped registered.
    * - itk::ProgressEvent: when ever a new frame was added to the result image.
+   *
+   * The events of the helper are always invoked in frame order.
+   * Per default the frames are registered serially with the set algorithm, so observers of the algorithm receive
+   * all of its events (e.g. iteration and level events). If more than one thread is requested (see
+   * SetNumberOfThreads()), frames are registered concurrently, each by its own clone of the algorithm
+   * (see CloneAlgorithm()). The clones only share the meta properties of the set algorithm. Their algorithm events
+   * are not sent to observers of the set algorithm, but forwarded to the observers of the helper (interleaved
+   * for concurrent frames). The registered frames are added to the result image in frame order and the events are
+   * invoked one after another (but possibly from different threads).
+   * If the algorithm cannot be cloned, the frames are processed serially with the set algorithm.
    */
   class MITKMATCHPOINTREGISTRATION_EXPORT TimeFramesRegistrationHelper : public itk::Object
   {
@@ -78,6 +88,11 @@ namespace mitk
     itkSetMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
     itkGetConstMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
 
+    /** Maximum number of frames that are registered concurrently. 1 (default) registers the frames serially
+     * with the set algorithm. 0 indicates that the global default number of threads of ITK will be used.*/
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
     /** cleares the ignore list. Therefore all frames will be processed.*/
     void ClearIgnoreList();
     void SetIgnoreList(const IgnoreListType& il);
@@ -110,6 +125,7 @@ namespace mitk
       m_AllowUnregPixels(true),
       m_ErrorValue(0),
       m_InterpolatorType(mitk::ImageMappingInterpolator::Linear),
+      m_NumberOfThreads(1),
       m_Progress(0)
     {
       m_4DImage = nullptr;
@@ -119,9 +135,16 @@ namespace mitk
 
     ~TimeFramesRegistrationHelper() override {};
 
-    RegistrationPointer DoFrameRegistration(const mitk::Image* movingFrame,
+    RegistrationPointer DoFrameRegistration(RegistrationAlgorithmBaseType* algorithm, const mitk::Image* movingFrame,
                                             const mitk::Image* targetFrame, const mitk::Image* targetMask) const;
 
+    /** Creates a new instance of the algorithm with the same settings as m_Algorithm, so that frames can be
+    * registered concurrently. The default implementation creates another instance of the algorithm class and
+    * copies all readable and writable meta properties. Settings that are not exposed as meta properties and the
+    * observers of m_Algorithm are not copied. Returns nullptr if the algorithm cannot be cloned
+    * (e.g. because it offers no meta property interface). In this case the frames are processed serially.*/
+    virtual RegistrationAlgorithmPointer CloneAlgorithm() const;
+
     mitk::Image::Pointer DoFrameMapping(const mitk::Image* movingFrame, const RegistrationType* reg,
                                         const mitk::Image* targetFrame) const;
 
@@ -152,6 +175,8 @@ namespace mitk
     /** Type of interpolator. Only relevant for images and if m_doGeometryRefinement is false. */
     mitk::ImageMappingInterpolator::Type m_InterpolatorType;
 
+    unsigned int m_NumberOfThreads;
+
     double m_Progress;
   };
 
@@ -16,6 +16,9 @@ found in the LICENSE file.
 #include <itkBSplineInterpolateImageFunction.h>
 #include <itkWindowedSincInterpolateImageFunction.h>
 
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkMultiThreaderBase.h>
+
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkGeometry3D.h>
@@ -27,6 +30,11 @@ found in the LICENSE file.
 #include "mitkImageMappingHelper.h"
 #include "mitkRegistrationHelper.h"
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
 template <typename TImage >
 typename ::itk::InterpolateImageFunction< TImage >::Pointer generateInterpolator(mitk::ImageMappingInterpolator::Type interpolatorType)
 {
@@ -68,10 +76,288 @@ typename ::itk::InterpolateImageFunction< TImage >::Pointer generateInterpolator
   return result;
 };
 
+struct mitk::ImageMappingHelper::MappingFieldCache::Field
+{
+  virtual ~Field() = default;
+
+  /** Memory used by the field in bytes.*/
+  virtual std::size_t GetSize() const = 0;
+
+  RegistrationType::ConstPointer registration;
+  itk::ModifiedTimeType registrationMTime = 0;
+  std::vector<double> gridKey;
+};
+
+struct mitk::ImageMappingHelper::MappingFieldCache::Impl
+{
+  mutable std::mutex mutex;
+  /** Cached fields, the most recently used first.*/
+  mutable std::deque<std::shared_ptr<const Field>> fields;
+  std::size_t maximumSize = 0;
+  std::size_t size = 0;
+
+  /** Removes the least recently used fields until the cache does not exceed the maximum size. Mutex must be locked.*/
+  void Shrink()
+  {
+    while (size > maximumSize)
+    {
+      size -= fields.back()->GetSize();
+      fields.pop_back();
+    }
+  }
+};
+
+const std::size_t mitk::ImageMappingHelper::MappingFieldCache::DefaultMaximumSize = 512 * 1024 * 1024;
+
+mitk::ImageMappingHelper::MappingFieldCache::MappingFieldCache(std::size_t maximumSize) : m_Impl(new Impl)
+{
+  m_Impl->maximumSize = maximumSize;
+}
+
+mitk::ImageMappingHelper::MappingFieldCache::~MappingFieldCache() = default;
+
+void mitk::ImageMappingHelper::MappingFieldCache::SetMaximumSize(std::size_t maximumSize)
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  m_Impl->maximumSize = maximumSize;
+  m_Impl->Shrink();
+}
+
+std::size_t mitk::ImageMappingHelper::MappingFieldCache::GetMaximumSize() const
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  return m_Impl->maximumSize;
+}
+
+std::size_t mitk::ImageMappingHelper::MappingFieldCache::GetSize() const
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  return m_Impl->size;
+}
+
+std::size_t mitk::ImageMappingHelper::MappingFieldCache::GetNumberOfFields() const
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  return m_Impl->fields.size();
+}
+
+void mitk::ImageMappingHelper::MappingFieldCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  m_Impl->fields.clear();
+  m_Impl->size = 0;
+}
+
+std::shared_ptr<const mitk::ImageMappingHelper::MappingFieldCache::Field>
+  mitk::ImageMappingHelper::MappingFieldCache::GetField(const RegistrationType* registration, const std::vector<double>& gridKey) const
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  for (auto pos = m_Impl->fields.begin(); pos != m_Impl->fields.end(); ++pos)
+  {
+    if ((*pos)->registration.GetPointer() == registration && (*pos)->registrationMTime == registration->GetMTime()
+        && (*pos)->gridKey == gridKey)
+    {
+      //move to the front; the last entry is removed first.
+      auto field = *pos;
+      m_Impl->fields.erase(pos);
+      m_Impl->fields.push_front(field);
+      return field;
+    }
+  }
+  return nullptr;
+}
+
+void mitk::ImageMappingHelper::MappingFieldCache::AddField(const std::shared_ptr<const Field>& field)
+{
+  std::lock_guard<std::mutex> lock(m_Impl->mutex);
+  if (nullptr == field || field->GetSize() > m_Impl->maximumSize)
+  {
+    return;
+  }
+
+  //a field of an older version of the registration for the same grid is obsolete
+  for (auto pos = m_Impl->fields.begin(); pos != m_Impl->fields.end(); ++pos)
+  {
+    if ((*pos)->registration == field->registration && (*pos)->gridKey == field->gridKey)
+    {
+      m_Impl->size -= (*pos)->GetSize();
+      m_Impl->fields.erase(pos);
+      break;
+    }
+  }
+
+  m_Impl->fields.push_front(field);
+  m_Impl->size += field->GetSize();
+  m_Impl->Shrink();
+}
+
+namespace
+{
+  /** Dense field of the inverse mapping (result/target space -> input/moving space) of a registration
+   * for every voxel of a result grid.*/
+  template <unsigned int VImageDimension>
+  struct MappingField : public mitk::ImageMappingHelper::MappingFieldCache::Field
+  {
+    typedef ::itk::Point<double, VImageDimension> PointType;
+
+    /** Memory needed by the field of a grid with the passed number of voxels.*/
+    static std::size_t GetSize(std::size_t numberOfVoxels)
+    {
+      return numberOfVoxels * (sizeof(PointType) + sizeof(unsigned char));
+    }
+
+    std::size_t GetSize() const override
+    {
+      return GetSize(points.size());
+    }
+
+    std::vector<PointType> points;
+    /** Indicates if the registration supports the mapping of the respective voxel.
+     * (unsigned char instead of bool, because it is written concurrently.)*/
+    std::vector<unsigned char> valid;
+  };
+
+  template <typename TImage>
+  std::vector<double> generateGridKey(const TImage* grid)
+  {
+    std::vector<double> key;
+    for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+    {
+      key.push_back(grid->GetOrigin()[i]);
+      key.push_back(grid->GetSpacing()[i]);
+      key.push_back(grid->GetLargestPossibleRegion().GetIndex()[i]);
+      key.push_back(grid->GetLargestPossibleRegion().GetSize()[i]);
+      for (unsigned int j = 0; j < TImage::ImageDimension; ++j)
+      {
+        key.push_back(grid->GetDirection()[i][j]);
+      }
+    }
+    return key;
+  }
+
+  /** Returns the mapping field of the registration for the grid of the passed image. The field is computed
+   * (multi-threaded) and added to the cache if it is not cached yet.*/
+  template <typename TImage, typename TRegistration>
+  std::shared_ptr<const MappingField<TImage::ImageDimension>> getMappingField(const TRegistration* registration, const TImage* grid,
+    mitk::ImageMappingHelper::MappingFieldCache& cache)
+  {
+    typedef MappingField<TImage::ImageDimension> FieldType;
+    const std::vector<double> gridKey = generateGridKey(grid);
+
+    auto cachedField = std::dynamic_pointer_cast<const FieldType>(cache.GetField(registration, gridKey));
+    if (cachedField)
+    {
+      return cachedField;
+    }
+
+    auto field = std::make_shared<FieldType>();
+    field->registration = registration;
+    field->registrationMTime = registration->GetMTime();
+    field->gridKey = gridKey;
+
+    const auto region = grid->GetLargestPossibleRegion();
+    field->points.resize(region.GetNumberOfPixels());
+    field->valid.resize(region.GetNumberOfPixels(), 0);
+
+    //Lazy kernels generate their field with the first mapping request. Generate it now,
+    //so that all voxels can be mapped concurrently.
+    const_cast<TRegistration*>(registration)->precomputeInverseMapping();
+
+    auto mapRegion = [&](const typename TImage::RegionType& subRegion)
+    {
+      typename FieldType::PointType targetPoint;
+      for (::itk::ImageRegionConstIteratorWithIndex<TImage> pos(grid, subRegion); !pos.IsAtEnd(); ++pos)
+      {
+        const auto offset = grid->ComputeOffset(pos.GetIndex());
+        grid->TransformIndexToPhysicalPoint(pos.GetIndex(), targetPoint);
+        field->valid[offset] = registration->mapPointInverse(targetPoint, field->points[offset]) ? 1 : 0;
+      }
+    };
+
+    ::itk::MultiThreaderBase::New()->template ParallelizeImageRegion<TImage::ImageDimension>(region, mapRegion, nullptr);
+
+    cache.AddField(field);
+    return field;
+  }
+
+  /** Resamples the input into the (allocated) result image by interpolating the input at the points of the
+   * mapping field. The handling of pixels that cannot be mapped or are outside of the input follows
+   * the settings of map::core::ImageMappingTask.*/
+  template <typename TImage>
+  void resampleWithMappingField(const TImage* input, TImage* result, const MappingField<TImage::ImageDimension>& field,
+    ::itk::InterpolateImageFunction<TImage>* interpolator, bool throwOnOutOfInputAreaError, const double& paddingValue,
+    bool throwOnMappingError, const double& errorValue)
+  {
+    typedef typename TImage::PixelType PixelType;
+    typedef typename ::itk::InterpolateImageFunction<TImage>::OutputType OutputType;
+
+    interpolator->SetInputImage(input);
+
+    const OutputType minValue = static_cast<OutputType>(::itk::NumericTraits<PixelType>::NonpositiveMin());
+    const OutputType maxValue = static_cast<OutputType>(::itk::NumericTraits<PixelType>::max());
+
+    std::atomic<bool> mappingError(false);
+    std::atomic<bool> outOfInputAreaError(false);
+
+    auto resampleRegion = [&](const typename TImage::RegionType& subRegion)
+    {
+      typename ::itk::InterpolateImageFunction<TImage>::ContinuousIndexType inputIndex;
+      for (::itk::ImageRegionIteratorWithIndex<TImage> pos(result, subRegion); !pos.IsAtEnd(); ++pos)
+      {
+        const auto offset = result->ComputeOffset(pos.GetIndex());
+        if (!field.valid[offset])
+        {
+          if (throwOnMappingError)
+          {
+            mappingError = true;
+          }
+          pos.Set(static_cast<PixelType>(errorValue));
+          continue;
+        }
+
+        input->TransformPhysicalPointToContinuousIndex(field.points[offset], inputIndex);
+        if (interpolator->IsInsideBuffer(inputIndex))
+        {
+          OutputType value = interpolator->EvaluateAtContinuousIndex(inputIndex);
+          value = std::min(std::max(value, minValue), maxValue);
+          pos.Set(static_cast<PixelType>(value));
+        }
+        else
+        {
+          if (throwOnOutOfInputAreaError)
+          {
+            outOfInputAreaError = true;
+          }
+          pos.Set(static_cast<PixelType>(paddingValue));
+        }
+      }
+    };
+
+    ::itk::MultiThreaderBase::New()->template ParallelizeImageRegion<TImage::ImageDimension>(result->GetLargestPossibleRegion(), resampleRegion, nullptr);
+
+    if (mappingError)
+    {
+      mitkThrow() << "Cannot map image. Registration does not support the mapping of the whole requested result region.";
+    }
+    if (outOfInputAreaError)
+    {
+      mitkThrow() << "Cannot map image. Input image does not cover the whole requested result region.";
+    }
+  }
+
+  /** Mapping fields pay off for registrations whose inverse kernel is not a (cheap) matrix transformation.*/
+  bool useMappingField(const mitk::ImageMappingHelper::RegistrationType* registration)
+  {
+    return registration->getTargetDimensions() == 3 && registration->getMovingDimensions() == 3
+      && mitk::MITKRegistrationHelper::getAffineMatrix(registration, true).IsNull();
+  }
+}
+
 template <typename TPixelType, unsigned int VImageDimension >
 void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::ImageMappingHelper::ResultImageType::Pointer& result, const mitk::ImageMappingHelper::RegistrationType*& registration,
   bool throwOnOutOfInputAreaError, const double& paddingValue, const mitk::ImageMappingHelper::ResultImageGeometryType*& resultGeometry,
-  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType,
+  mitk::ImageMappingHelper::MappingFieldCache* mappingFieldCache)
 {
   typedef ::map::core::Registration<VImageDimension,VImageDimension> ConcreteRegistrationType;
   typedef ::map::core::ImageMappingTask<ConcreteRegistrationType, ::itk::Image<TPixelType,VImageDimension>, ::itk::Image<TPixelType,VImageDimension> > MappingTaskType;
@@ -115,15 +401,16 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
 
   //check/create resultDescriptor
   /////////////////////////
+  typename ResultImageDescriptorType::PointType origin;
+  typename ResultImageDescriptorType::SizeType size;
+  typename ResultImageDescriptorType::SpacingType fieldSpacing;
+  typename ResultImageDescriptorType::DirectionType matrix;
+  typename ::itk::Image<TPixelType, VImageDimension>::SizeType gridSize;
+
   if (resultGeometry)
   {
     resultDescriptor = ResultImageDescriptorType::New();
 
-    typename ResultImageDescriptorType::PointType origin;
-    typename ResultImageDescriptorType::SizeType size;
-    typename ResultImageDescriptorType::SpacingType fieldSpacing;
-    typename ResultImageDescriptorType::DirectionType matrix;
-
     mitk::ImageMappingHelper::ResultImageGeometryType::BoundsArrayType geoBounds = resultGeometry->GetBounds();
     mitk::Vector3D geoSpacing = resultGeometry->GetSpacing();
     mitk::Point3D geoOrigin = resultGeometry->GetOrigin();
@@ -134,6 +421,7 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
       origin[i] = static_cast<typename ResultImageDescriptorType::PointType::ValueType>(geoOrigin[i]);
       fieldSpacing[i] = static_cast<typename ResultImageDescriptorType::SpacingType::ValueType>(geoSpacing[i]);
       size[i] = static_cast<typename ResultImageDescriptorType::SizeType::SizeValueType>(geoBounds[(2*i)+1]-geoBounds[2*i])*fieldSpacing[i];
+      gridSize[i] = static_cast<typename ::itk::Image<TPixelType, VImageDimension>::SizeType::SizeValueType>(geoBounds[(2*i)+1]-geoBounds[2*i]);
     }
 
     //Matrix extraction
@@ -205,6 +493,39 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
   typedef ::itk::InterpolateImageFunction< ::itk::Image<TPixelType,VImageDimension> > BaseInterpolatorType;
   typename BaseInterpolatorType::Pointer interpolator = generateInterpolator< ::itk::Image<TPixelType,VImageDimension> >(interpolatorType);
   assert(interpolator.IsNotNull());
+
+  if (nullptr != mappingFieldCache && useMappingField(registration))
+  {
+    //The registration is evaluated once per result voxel and the field is reused for further
+    //time steps/images with the same registration and result grid, as long as it fits into the cache.
+    typedef ::itk::Image<TPixelType, VImageDimension> ImageType;
+    typename ImageType::Pointer resultImage = ImageType::New();
+    if (resultGeometry)
+    {
+      resultImage->SetOrigin(origin);
+      resultImage->SetSpacing(fieldSpacing);
+      resultImage->SetDirection(matrix);
+      resultImage->SetRegions(gridSize);
+    }
+    else
+    {
+      resultImage->CopyInformation(input);
+      resultImage->SetRegions(input->GetLargestPossibleRegion());
+    }
+
+    const auto numberOfVoxels = resultImage->GetLargestPossibleRegion().GetNumberOfPixels();
+    if (MappingField<VImageDimension>::GetSize(numberOfVoxels) <= mappingFieldCache->GetMaximumSize())
+    {
+      resultImage->Allocate();
+
+      auto field = getMappingField(castedReg, resultImage.GetPointer(), *mappingFieldCache);
+      resampleWithMappingField<ImageType>(input, resultImage, *field, interpolator, throwOnOutOfInputAreaError, paddingValue,
+        throwOnMappingError, errorValue);
+
+      mitk::CastToMitkImage<>(resultImage, result);
+      return;
+    }
+  }
   spTask->setImageInterpolator(interpolator);
   spTask->setInputImage(input);
   spTask->setRegistration(castedReg);
@@ -221,7 +542,8 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
 mitk::ImageMappingHelper::ResultImageType::Pointer
   mitk::ImageMappingHelper::map(const InputImageType* input, const RegistrationType* registration,
   bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
-  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType,
+  MappingFieldCache* mappingFieldCache)
 {
   if (!registration)
   {
@@ -236,11 +558,15 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
 
   if(input->GetTimeSteps()==1)
   { //map the image and done
-    AccessByItk_n(input, doMITKMap, (result, registration, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType));
+    AccessByItk_n(input, doMITKMap, (result, registration, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType, mappingFieldCache));
   }
   else
   { //map every time step and compose
 
+    //without a cache of the caller, a mapping field is only kept while the time steps are mapped.
+    MappingFieldCache timeStepsCache;
+    MappingFieldCache* timeStepsMappingFieldCache = nullptr != mappingFieldCache ? mappingFieldCache : &timeStepsCache;
+
     mitk::TimeGeometry::ConstPointer timeGeometry = input->GetTimeGeometry();
     mitk::TimeGeometry::Pointer mappedTimeGeometry = timeGeometry->Clone();
 
@@ -262,7 +588,7 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
 
       InputImageType::Pointer timeStepInput = imageTimeSelector->GetOutput();
       ResultImageType::Pointer timeStepResult;
-      AccessByItk_n(timeStepInput, doMITKMap, (timeStepResult, registration, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType));
+      AccessByItk_n(timeStepInput, doMITKMap, (timeStepResult, registration, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType, timeStepsMappingFieldCache));
       mitk::ImageReadAccessor readAccess(timeStepResult);
       result->SetVolume(readAccess.GetData(),i);
     }
@@ -274,7 +600,8 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
 mitk::ImageMappingHelper::ResultImageType::Pointer
   mitk::ImageMappingHelper::map(const InputImageType* input, const MITKRegistrationType* registration,
   bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
-  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type)
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType,
+  MappingFieldCache* mappingFieldCache)
 {
   if (!registration)
   {
@@ -289,7 +616,7 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
     mitkThrow() << "Cannot map image. Passed image pointer is nullptr.";
   }
 
-  ResultImageType::Pointer result = map(input, registration->GetRegistration(), throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue);
+  ResultImageType::Pointer result = map(input, registration->GetRegistration(), throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType, mappingFieldCache);
   return result;
 }
 
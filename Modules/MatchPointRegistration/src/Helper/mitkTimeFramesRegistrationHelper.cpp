@@ -19,6 +19,16 @@ found in the LICENSE file.
 #include <mitkMaskedAlgorithmHelper.h>
 #include <mitkMAPAlgorithmHelper.h>
 
+#include <mapAlgorithmEvents.h>
+#include <mapMetaPropertyAlgorithmInterface.h>
+
+#include <itkMultiThreaderBase.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
 mitk::Image::Pointer
 mitk::TimeFramesRegistrationHelper::GetFrameImage(const mitk::Image* image,
     mitk::TimePointType timePoint) const
@@ -56,51 +66,209 @@ mitk::TimeFramesRegistrationHelper::Generate()
     }
   }
 
-  double progressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
+  const unsigned int timeSteps = this->m_4DImage->GetTimeSteps();
+  double progressDelta = 1.0 / ((timeSteps - 1) * 3.0);
   m_Progress = 0.0;
 
-  //process the frames
-  for (unsigned int i = 1; i < this->m_4DImage->GetTimeSteps(); ++i)
+  unsigned int numberOfThreads = m_NumberOfThreads;
+  if (numberOfThreads == 0)
   {
-    Image::Pointer movingFrame = GetFrameImage(this->m_4DImage, i);
-    Image::Pointer mappedFrame;
+    numberOfThreads = itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads();
+  }
+  numberOfThreads = std::min(numberOfThreads, timeSteps - 1);
 
-    IgnoreListType::iterator finding = std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i);
+  //forwards the algorithm events of the clones to the observers of the helper, one event at a time
+  std::mutex forwardMutex;
+  auto cloneAlgorithm = [&]()
+  {
+    RegistrationAlgorithmPointer clone = this->CloneAlgorithm();
+    if (clone.IsNotNull())
+    {
+      clone->AddObserver(::map::events::AlgorithmEvent(), [this, &forwardMutex](const itk::EventObject& event)
+      {
+        std::lock_guard<std::mutex> lock(forwardMutex);
+        this->InvokeEvent(event);
+      });
+    }
+    return clone;
+  };
 
+  //algorithms that are currently not used by a frame registration
+  std::vector<RegistrationAlgorithmPointer> idleAlgorithms;
+  if (numberOfThreads > 1)
+  {
+    RegistrationAlgorithmPointer clone = cloneAlgorithm();
+    if (clone.IsNull())
+    {
+      numberOfThreads = 1;
+    }
+    else
+    {
+      idleAlgorithms.push_back(clone);
+    }
+  }
+  if (numberOfThreads == 1)
+  {
+    idleAlgorithms.push_back(m_Algorithm);
+  }
 
-    if (finding == m_IgnoreList.end())
+  /* The mutex guards the frame extraction from the input, the algorithm pool, the frame states, the progress,
+   * the event invocation and the result image. Registration and mapping run unguarded.*/
+  enum class FrameState { Pending, Registered, Mapped, Ignored };
+
+  std::mutex mutex;
+  std::vector<Image::Pointer> mappedFrames(timeSteps);
+  std::vector<FrameState> frameStates(timeSteps, FrameState::Pending);
+  unsigned int nextFrameToStore = 1;
+  bool registrationEventInvoked = false;
+  std::exception_ptr error;
+
+  /* Invokes the events of all frames up to the first pending frame and stores their results, so observers
+   * see the events in frame order, regardless of the order in which concurrent frames finish.
+   * Must be called with locked mutex.*/
+  auto invokeFrameEvents = [&]()
+  {
+    while (nextFrameToStore < timeSteps && frameStates[nextFrameToStore] != FrameState::Pending)
     {
-      //frame should be processed
-      RegistrationPointer reg = DoFrameRegistration(movingFrame, targetFrame, mask);
+      const FrameState state = frameStates[nextFrameToStore];
+
+      if (state != FrameState::Ignored && !registrationEventInvoked)
+      {
+        m_Progress += progressDelta;
+        this->InvokeEvent(::mitk::FrameRegistrationEvent(nullptr,
+                          "Registred frame #" + ::map::core::convert::toStr(nextFrameToStore)));
+        registrationEventInvoked = true;
+      }
+
+      if (state == FrameState::Registered)
+      {
+        break;
+      }
+
+      if (state == FrameState::Mapped)
+      {
+        m_Progress += progressDelta;
+        this->InvokeEvent(::mitk::FrameMappingEvent(nullptr,
+                          "Mapped frame #" + ::map::core::convert::toStr(nextFrameToStore)));
+
+        Image::Pointer mappedFrame = mappedFrames[nextFrameToStore];
+        mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
+                                         mitk::Image::ReferenceMemory));
+
+        this->m_Registered4DImage->SetVolume(accessor.GetData(), nextFrameToStore);
+        this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), nextFrameToStore);
+
+        mappedFrames[nextFrameToStore] = nullptr;
+        m_Progress += progressDelta;
+      }
+      else
+      {
+        m_Progress += 3 * progressDelta;
+      }
+
+      this->InvokeEvent(::itk::ProgressEvent());
+      ++nextFrameToStore;
+      registrationEventInvoked = false;
+    }
+  };
 
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameRegistrationEvent(nullptr,
-                        "Registred frame #" +::map::core::convert::toStr(i)));
+  auto processFrame = [&](unsigned int i)
+  {
+    RegistrationAlgorithmPointer algorithm;
+    Image::Pointer movingFrame;
+    bool ignored = std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i) != m_IgnoreList.end();
 
-      mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (error)
+      {
+        return;
+      }
+
+      if (ignored)
+      {
+        frameStates[i] = FrameState::Ignored;
+        invokeFrameEvents();
+        return;
+      }
+
+      movingFrame = GetFrameImage(this->m_4DImage, i);
+
+      if (!idleAlgorithms.empty())
+      {
+        algorithm = idleAlgorithms.back();
+        idleAlgorithms.pop_back();
+      }
+      else
+      {
+        algorithm = cloneAlgorithm();
+      }
+    }
 
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameMappingEvent(nullptr,
-                        "Mapped frame #" + ::map::core::convert::toStr(i)));
+    try
+    {
+      if (algorithm.IsNull())
+      {
+        mitkThrow() << "Cannot register image. Algorithm could not be cloned for frame #" << i;
+      }
 
-      mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
-                                       mitk::Image::ReferenceMemory));
+      //frame should be processed
+      RegistrationPointer reg = DoFrameRegistration(algorithm, movingFrame, targetFrame, mask);
 
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        frameStates[i] = FrameState::Registered;
+        invokeFrameEvents();
+      }
 
-      this->m_Registered4DImage->SetVolume(accessor.GetData(), i);
-      this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), i);
+      Image::Pointer mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
 
-      m_Progress += progressDelta;
+      std::lock_guard<std::mutex> lock(mutex);
+      idleAlgorithms.push_back(algorithm);
+      mappedFrames[i] = mappedFrame;
+      frameStates[i] = FrameState::Mapped;
+      invokeFrameEvents();
     }
-    else
+    catch (...)
     {
-      m_Progress += 3 * progressDelta;
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error)
+      {
+        error = std::current_exception();
+      }
     }
+  };
 
-    this->InvokeEvent(::itk::ProgressEvent());
-
+  //process the frames
+  if (numberOfThreads > 1)
+  {
+    //every work unit takes the next unprocessed frame, so frames are started in order and
+    //only few mapped frames have to wait for their predecessors before they can be stored.
+    std::atomic<unsigned int> nextFrameToProcess(1);
+    auto processFrames = [&](itk::SizeValueType)
+    {
+      for (unsigned int i = nextFrameToProcess++; i < timeSteps; i = nextFrameToProcess++)
+      {
+        processFrame(i);
+      }
+    };
+
+    itk::MultiThreaderBase::Pointer threader = itk::MultiThreaderBase::New();
+    threader->SetNumberOfWorkUnits(numberOfThreads);
+    threader->ParallelizeArray(0, numberOfThreads, processFrames, nullptr);
+  }
+  else
+  {
+    for (unsigned int i = 1; i < timeSteps; ++i)
+    {
+      processFrame(i);
+    }
   }
 
+  if (error)
+  {
+    std::rethrow_exception(error);
+  }
 };
 
 mitk::Image::Pointer
@@ -131,22 +299,57 @@ mitk::TimeFramesRegistrationHelper::ClearIgnoreList()
 
 
 mitk::TimeFramesRegistrationHelper::RegistrationPointer
-mitk::TimeFramesRegistrationHelper::DoFrameRegistration(const mitk::Image* movingFrame,
-    const mitk::Image* targetFrame, const mitk::Image* targetMask) const
+mitk::TimeFramesRegistrationHelper::DoFrameRegistration(RegistrationAlgorithmBaseType* algorithm,
+    const mitk::Image* movingFrame, const mitk::Image* targetFrame, const mitk::Image* targetMask) const
 {
-  mitk::MAPAlgorithmHelper algHelper(m_Algorithm);
+  mitk::MAPAlgorithmHelper algHelper(algorithm);
   algHelper.SetAllowImageCasting(true);
   algHelper.SetData(movingFrame, targetFrame);
 
   if (targetMask)
   {
-    mitk::MaskedAlgorithmHelper maskHelper(m_Algorithm);
+    mitk::MaskedAlgorithmHelper maskHelper(algorithm);
     maskHelper.SetMasks(nullptr, targetMask);
   }
 
   return algHelper.GetRegistration();
 };
 
+mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmPointer
+mitk::TimeFramesRegistrationHelper::CloneAlgorithm() const
+{
+  typedef ::map::algorithm::facet::MetaPropertyAlgorithmInterface MetaInterfaceType;
+
+  const MetaInterfaceType* sourceMeta = dynamic_cast<const MetaInterfaceType*>(m_Algorithm.GetPointer());
+  if (!sourceMeta)
+  {
+    return nullptr;
+  }
+
+  ::itk::LightObject::Pointer another = m_Algorithm->CreateAnother();
+  RegistrationAlgorithmPointer clone = dynamic_cast<RegistrationAlgorithmBaseType*>(another.GetPointer());
+  MetaInterfaceType* cloneMeta = dynamic_cast<MetaInterfaceType*>(clone.GetPointer());
+  if (!cloneMeta)
+  {
+    return nullptr;
+  }
+
+  MetaInterfaceType::MetaPropertyVectorType infos = cloneMeta->getPropertyInfos();
+  for (const auto& info : infos)
+  {
+    if (info->isReadable() && info->isWritable())
+    {
+      MetaInterfaceType::MetaPropertyPointer property = sourceMeta->getProperty(info);
+      if (property.IsNull() || !cloneMeta->setProperty(info, property))
+      {
+        return nullptr;
+      }
+    }
+  }
+
+  return clone;
+};
+
 mitk::Image::Pointer mitk::TimeFramesRegistrationHelper::DoFrameMapping(
   const mitk::Image* movingFrame, const RegistrationType* reg, const mitk::Image* targetFrame) const
 {
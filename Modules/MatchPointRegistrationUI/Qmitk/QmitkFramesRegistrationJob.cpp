@@ -41,8 +41,11 @@ const map::algorithm::RegistrationAlgorithmBase *QmitkFramesRegistrationJob::Get
   return m_spLoadedAlgorithm;
 };
 
-void QmitkFramesRegistrationJob::OnMapAlgorithmEvent(::itk::Object *, const itk::EventObject &event)
+void QmitkFramesRegistrationJob::OnMapAlgorithmEvent(::itk::Object *caller, const itk::EventObject &event)
 {
+  // events of concurrently registered frames are forwarded by the helper; their counts are not meaningful
+  const bool isLoadedAlgorithmEvent = caller == this->m_spLoadedAlgorithm.GetPointer();
+
   const map::events::AlgorithmEvent *pAlgEvent = dynamic_cast<const map::events::AlgorithmEvent *>(&event);
   const map::events::AlgorithmIterationEvent *pIterationEvent =
     dynamic_cast<const map::events::AlgorithmIterationEvent *>(&event);
@@ -116,7 +119,7 @@ void QmitkFramesRegistrationJob::OnMapAlgorithmEvent(::itk::Object *, const itk:
     map::algorithm::facet::IterativeAlgorithmInterface::IterationCountType count = 0;
     bool hasCount = false;
 
-    if (pIterative && pIterative->hasIterationCount())
+    if (isLoadedAlgorithmEvent && pIterative && pIterative->hasIterationCount())
     {
       hasCount = true;
       count = pIterative->getCurrentIteration();
@@ -133,7 +136,7 @@ void QmitkFramesRegistrationJob::OnMapAlgorithmEvent(::itk::Object *, const itk:
     bool hasCount = false;
     QString info = QString::fromStdString(pLevelEvent->getComment());
 
-    if (pResAlg && pResAlg->hasLevelCount())
+    if (isLoadedAlgorithmEvent && pResAlg && pResAlg->hasLevelCount())
     {
       count = pResAlg->getCurrentLevel() + 1;
       hasCount = true;
@@ -149,7 +152,7 @@ void QmitkFramesRegistrationJob::OnMapAlgorithmEvent(::itk::Object *, const itk:
 }
 
 QmitkFramesRegistrationJob::QmitkFramesRegistrationJob(map::algorithm::RegistrationAlgorithmBase *pAlgorithm)
-  : m_TargetDataUID("Missing target UID"), m_spLoadedAlgorithm(pAlgorithm)
+  : m_TargetDataUID("Missing target UID"), m_NumberOfThreads(0), m_spLoadedAlgorithm(pAlgorithm)
 {
   m_MappedName = "Unnamed RegJob";
 
@@ -181,6 +184,7 @@ void QmitkFramesRegistrationJob::run()
     m_helper->SetErrorValue(this->m_errorValue);
     m_helper->SetPaddingValue(this->m_paddingValue);
     m_helper->SetInterpolatorType(this->m_InterpolatorType);
+    m_helper->SetNumberOfThreads(this->m_NumberOfThreads);
 
     m_helper->AddObserver(::map::events::AnyMatchPointEvent(), m_spCommand);
     m_helper->AddObserver(::itk::ProgressEvent(), m_spCommand);
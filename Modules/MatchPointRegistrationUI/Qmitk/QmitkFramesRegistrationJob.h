@@ -76,6 +76,9 @@ public:
   mitk::TimeFramesRegistrationHelper::IgnoreListType m_IgnoreList;
   mitk::NodeUIDType m_TargetDataUID;
   mitk::NodeUIDType m_TargetMaskDataUID;
+  /** Maximum number of frames registered concurrently (see mitk::TimeFramesRegistrationHelper::SetNumberOfThreads).
+   * 0 (default) uses the global default number of threads of ITK.*/
+  unsigned int m_NumberOfThreads;
 
   const map::algorithm::RegistrationAlgorithmBase *GetLoadedAlgorithm() const;
 
@@ -15,6 +15,7 @@ found in the LICENSE file.
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "mitkExceptionMacro.h"
 
@@ -32,6 +33,78 @@ namespace mitk
   };
 
 
+  /*!
+   *	@brief		Formula that was parsed once by @ref FormulaParser::compile and can be
+   *				evaluated repeatedly without parsing the string again.
+   *	@details	The formula is stored as a sequence of instructions for a stack machine.
+   *				Variables are referenced by their index in the list of variable names that
+   *				was passed to @ref FormulaParser::compile. Constant sub expressions are
+   *				already evaluated while compiling.
+   */
+  class MITKMODELFIT_EXPORT CompiledFormula
+  {
+  public:
+    using ValueType = double;
+    using UnaryFunctionType = ValueType(*)(ValueType);
+
+    enum class OpCode
+    {
+      Constant,
+      Variable,
+      Add,
+      Subtract,
+      Multiply,
+      Divide,
+      Negate,
+      Function
+    };
+
+    struct Instruction
+    {
+      OpCode op;
+      ValueType value;
+      std::size_t variable;
+      UnaryFunctionType function;
+    };
+
+    using ProgramType = std::vector<Instruction>;
+
+    CompiledFormula();
+    CompiledFormula(const ProgramType& program, std::size_t numberOfVariables);
+
+    /*!
+     *	@brief					Evaluates the formula for one set of variable values.
+     *	@param[in] variables	Values of all variables in the order of the compiled names.
+     *	@throw FormulaParserException	If the formula is empty.
+     */
+    ValueType evaluate(const ValueType* variables) const;
+
+    /*!
+     *	@brief					Evaluates the formula for all values of one variable (e.g. all
+     *							time points of a signal) at once, all other variables are fixed.
+     *	@details				Every instruction is applied to the whole grid before the next one
+     *							is executed, so the instructions are only dispatched once per call.
+     *	@param[in] variables	Values of all variables in the order of the compiled names. The
+     *							value of @b gridVariable is ignored.
+     *	@param[in] gridVariable	Index of the variable that takes the values of @b grid.
+     *	@param[in] grid			Values of the grid variable.
+     *	@param[in] gridSize		Number of values in @b grid and @b results.
+     *	@param[out] results		The value of the formula at every grid position.
+     *	@throw FormulaParserException	If the formula is empty.
+     */
+    void evaluate(const ValueType* variables, std::size_t gridVariable, const ValueType* grid,
+      std::size_t gridSize, ValueType* results) const;
+
+    std::size_t getNumberOfVariables() const;
+    const ProgramType& getProgram() const;
+
+  private:
+    ProgramType m_Program;
+    /*! @brief Maximum number of values on the stack while evaluating the program. */
+    std::size_t m_StackSize;
+    std::size_t m_NumberOfVariables;
+  };
+
   /*!
    *	@brief		This class offers the functionality to evaluate simple mathematical formula
    *				strings (e.g. <code>"3.5 + 4 * x * sin(x) - 1 / 2"</code>).
@@ -98,6 +171,18 @@ namespace mitk
      */
     ValueType lookupVariable(const std::string var);
 
+    /*!
+     *	@brief				Parses the @b input string once and returns a formula that can be
+     *						evaluated repeatedly without parsing the string again. The grammar is
+     *						the same as for @ref FormulaParser::parse.
+     *	@param[in] input	The string to be compiled.
+     *	@param[in] variableNames	Names of the variables the formula may use. Their index is
+     *						used to pass the values to @ref CompiledFormula::evaluate.
+     *	@throw FormulaParserException	If the string cannot be parsed or uses a variable that
+     *						is not contained in @b variableNames.
+     */
+    static CompiledFormula compile(const std::string& input, const std::vector<std::string>& variableNames);
+
   private:
     /*! @brief Map that holds the values that will replace the variables during evaluation. */
     const VariableMapType* m_Variables;
@@ -15,10 +15,14 @@ found in the LICENSE file.
 
 #include "mitkModelBase.h"
 
+#include <memory>
+#include <mutex>
+
 #include "MitkModelFitExports.h"
 
 namespace mitk
 {
+  class CompiledFormula;
 
   /** Model that can parse a user specified function string and uses it as model function
   that is represented by the model instance.
@@ -98,6 +102,15 @@ namespace mitk
     /**Number of parameters the model should offer / the function string contains.*/
     ParametersSizeType m_NumberOfParameters;
 
+    /**Returns the compiled function string. It is only parsed again if the function string
+    or the number of parameters has changed since the last call.*/
+    std::shared_ptr<const CompiledFormula> GetCompiledFunction() const;
+
+    mutable std::shared_ptr<const CompiledFormula> m_CompiledFunction;
+    mutable FunctionStringType m_CompiledFunctionString;
+    mutable ParametersSizeType m_CompiledNumberOfParameters;
+    mutable std::mutex m_CompiledFunctionMutex;
+
     //No copy constructor allowed
     GenericParamModel(const Self& source);
     void operator=(const Self&);  //purposely not implemented
@@ -58,6 +58,9 @@ protected:
 
     virtual MeasureType CalcMeasure(const ParametersType &parameters, const SignalType& signal) const = 0;
 
+    /** Checks the size of the signal against the sample and calls CalcMeasure().*/
+    MeasureType CalcCheckedMeasure(const ParametersType &parameters, const SignalType& signal) const;
+
     MVModelFitCostFunction() : m_DerivativeStepLength(1e-5)
     {
     }
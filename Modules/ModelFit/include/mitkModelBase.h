@@ -74,6 +74,9 @@ namespace mitk
     typedef double DerivedParameterValueType;
     typedef std::map<ParameterNameType, DerivedParameterValueType> DerivedParameterMapType;
 
+    typedef std::vector<ParametersType> ParametersBatchType;
+    typedef std::vector<ModelResultType> ModelResultBatchType;
+
     /**Default implementation returns a scale of 1.0 for every defined parameter.*/
     ParamterScaleMapType GetParameterScales() const override;
 
@@ -168,10 +171,20 @@ namespace mitk
 
     ModelResultType GetSignal(const ParametersType& parameters) const;
 
+    /** Computes the signals for several parameter sets at once (e.g. the perturbed parameters
+     * of a numerical derivative). The result contains one signal per passed parameter set in the
+     * same order. The results equal the ones of GetSignal() for every single parameter set.*/
+    ModelResultBatchType GetSignalBatch(const ParametersBatchType& parameterSets) const;
+
   protected:
 
     virtual ModelResultType ComputeModelfunction(const ParametersType& parameters) const = 0;
 
+    /** Helper function called by GetSignalBatch(). The default implementation calls
+     * ComputeModelfunction() for every parameter set. Reimplement in derived classes that
+     * can share work between the parameter sets (e.g. by integrating them together).*/
+    virtual ModelResultBatchType ComputeModelfunctionBatch(const ParametersBatchType& parameterSets) const;
+
     /** Member is called by GetSignal() before ComputeModelfunction(). It indicates if model is in a valid state and
      * ready to compute the signal. The default implementation checks nothing and always returns true.
      * Reimplement to realize special behavior for derived classes.
@@ -18,6 +18,8 @@ found in the LICENSE file.
 #include "mitkFormulaParser.h"
 #include "mitkFresnel.h"
 
+#include <algorithm>
+
 namespace qi = boost::spirit::qi;
 namespace ascii = boost::spirit::ascii;
 namespace phx = boost::phoenix;
@@ -109,6 +111,34 @@ namespace mitk
     return static_cast<T>(fresnel_c(x) / boost::math::constants::root_two_div_pi<T>());
   }
 
+  /*!
+   *	@brief	Helper structure that maps strings to function calls so that parsing e.g.
+   *			@c "cos(0)" actually calls the @c std::cos function with parameter @c 1 so it
+   *			returns @c 0.
+   */
+  class UnaryFunctionSymbols :
+    public qi::symbols<typename std::iterator_traits<Iter>::value_type, FormulaParser::ValueType(*)(FormulaParser::ValueType)>
+  {
+  public:
+    /*!
+     *	@brief Constructs the structure, this is where the mapping takes place.
+     */
+    UnaryFunctionSymbols()
+    {
+      this->add
+      ("abs", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::abs))
+        ("exp", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::exp)) // @TODO: exp ignores division by zero
+        ("sin", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::sin))
+        ("cos", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::cos))
+        ("tan", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::tan))
+        ("sind", &sind)
+        ("cosd", &cosd)
+        ("tand", &tand)
+        ("fresnelS", &fresnelS)
+        ("fresnelC", &fresnelC);
+    }
+  };
+
   /*!
    *	@brief		The grammar that defines the language (i.e. what is allowed) for the parser.
    */
@@ -156,33 +186,7 @@ namespace mitk
       }
     };
 
-    /*!
-     *	@brief	Helper structure that maps strings to function calls so that parsing e.g.
-     *			@c "cos(0)" actually calls the @c std::cos function with parameter @c 1 so it
-     *			returns @c 0.
-     */
-    class unaryFunction_ :
-      public qi::symbols<typename std::iterator_traits<Iter>::value_type, FormulaParser::ValueType(*)(FormulaParser::ValueType)>
-    {
-    public:
-      /*!
-       *	@brief Constructs the structure, this is where the mapping takes place.
-       */
-      unaryFunction_()
-      {
-        this->add
-        ("abs", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::abs))
-          ("exp", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::exp)) // @TODO: exp ignores division by zero
-          ("sin", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::sin))
-          ("cos", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::cos))
-          ("tan", static_cast<FormulaParser::ValueType(*)(FormulaParser::ValueType)>(&std::tan))
-          ("sind", &sind)
-          ("cosd", &cosd)
-          ("tand", &tand)
-          ("fresnelS", &fresnelS)
-          ("fresnelC", &fresnelC);
-      }
-    } unaryFunction;
+    UnaryFunctionSymbols unaryFunction;
 
   public:
     /*!
@@ -237,6 +241,301 @@ namespace mitk
     qi::rule<Iter, FormulaParser::ValueType(), Skipper> primary;
   };
 
+  /*!
+   *	@brief	Part of a compiled formula that is synthesized while parsing. It is a struct and
+   *			not the instruction vector itself, because boost::spirit treats container attributes
+   *			differently.
+   */
+  struct ProgramFragment
+  {
+    CompiledFormula::ProgramType instructions;
+  };
+
+  /*!
+   *	@brief	Returns true if the fragment only pushes a constant (which can be folded).
+   */
+  inline bool isConstant(const ProgramFragment& fragment)
+  {
+    return fragment.instructions.size() == 1 && fragment.instructions.front().op == CompiledFormula::OpCode::Constant;
+  }
+
+  inline CompiledFormula::Instruction makeInstruction(CompiledFormula::OpCode op)
+  {
+    CompiledFormula::Instruction instruction;
+    instruction.op = op;
+    instruction.value = 0;
+    instruction.variable = 0;
+    instruction.function = nullptr;
+    return instruction;
+  }
+
+  inline CompiledFormula::ValueType applyBinary(CompiledFormula::OpCode op, CompiledFormula::ValueType a, CompiledFormula::ValueType b)
+  {
+    switch (op)
+    {
+    case CompiledFormula::OpCode::Add:
+      return a + b;
+    case CompiledFormula::OpCode::Subtract:
+      return a - b;
+    case CompiledFormula::OpCode::Multiply:
+      return a * b;
+    default:
+      return a / b;
+    }
+  }
+
+  ProgramFragment makeConstant(FormulaParser::ValueType value)
+  {
+    ProgramFragment result;
+    result.instructions.push_back(makeInstruction(CompiledFormula::OpCode::Constant));
+    result.instructions.back().value = value;
+    return result;
+  }
+
+  ProgramFragment makeNegation(const ProgramFragment& operand)
+  {
+    if (isConstant(operand))
+    {
+      return makeConstant(-operand.instructions.front().value);
+    }
+    ProgramFragment result = operand;
+    result.instructions.push_back(makeInstruction(CompiledFormula::OpCode::Negate));
+    return result;
+  }
+
+  ProgramFragment makeFunctionCall(CompiledFormula::UnaryFunctionType function, const ProgramFragment& operand)
+  {
+    if (isConstant(operand))
+    {
+      return makeConstant(function(operand.instructions.front().value));
+    }
+    ProgramFragment result = operand;
+    result.instructions.push_back(makeInstruction(CompiledFormula::OpCode::Function));
+    result.instructions.back().function = function;
+    return result;
+  }
+
+  ProgramFragment makeBinary(const ProgramFragment& left, const ProgramFragment& right, CompiledFormula::OpCode op)
+  {
+    if (isConstant(left) && isConstant(right))
+    {
+      return makeConstant(applyBinary(op, left.instructions.front().value, right.instructions.front().value));
+    }
+    ProgramFragment result = left;
+    result.instructions.insert(result.instructions.end(), right.instructions.begin(), right.instructions.end());
+    result.instructions.push_back(makeInstruction(op));
+    return result;
+  }
+
+  /*!
+   *	@brief		The same language as @ref Grammar, but instead of evaluating the formula the
+   *				grammar synthesizes the instructions of a @ref CompiledFormula.
+   */
+  class CompileGrammar : public qi::grammar<Iter, ProgramFragment(), Skipper>
+  {
+    UnaryFunctionSymbols unaryFunction;
+    const std::vector<std::string>& m_VariableNames;
+
+  public:
+    /*!
+     *	@brief						Constructs the grammar.
+     *	@param[in] variableNames	The names of the variables that may be used in the formula.
+     */
+    CompileGrammar(const std::vector<std::string>& variableNames) : CompileGrammar::base_type(start), m_VariableNames(variableNames)
+    {
+      using qi::_val;
+      using qi::_1;
+      using qi::_2;
+      using qi::char_;
+      using qi::alpha;
+      using qi::alnum;
+      using qi::double_;
+      using qi::as_string;
+      using OpCode = CompiledFormula::OpCode;
+
+      start = expression > qi::eoi;
+
+      expression = term[_val = _1]
+        >> *(('+' >> term[_val = phx::bind(&makeBinary, _val, _1, OpCode::Add)])
+          | ('-' >> term[_val = phx::bind(&makeBinary, _val, _1, OpCode::Subtract)]));
+
+      term = factor[_val = _1]
+        >> *(('*' >> factor[_val = phx::bind(&makeBinary, _val, _1, OpCode::Multiply)])
+          | ('/' >> factor[_val = phx::bind(&makeBinary, _val, _1, OpCode::Divide)]));
+
+      factor = primary[_val = _1];
+
+      variable = as_string[alpha >> *(alnum | char_('_'))]
+        [_val = phx::bind(&CompileGrammar::lookupVariable, this, _1)];
+
+      primary = double_[_val = phx::bind(&makeConstant, _1)]
+        | '(' >> expression[_val = _1] >> ')'
+        | ('-' >> primary[_val = phx::bind(&makeNegation, _1)])
+        | ('+' >> primary[_val = _1])
+        | (unaryFunction >> '(' >> expression >> ')')[_val = phx::bind(&makeFunctionCall, _1, _2)]
+        | variable[_val = _1];
+    }
+
+    /*!
+     *	@brief			Returns the fragment that pushes the variable with the given name.
+     *	@throw FormulaParserException	If the variable name is unknown.
+     */
+    ProgramFragment lookupVariable(const std::string& var) const
+    {
+      auto pos = std::find(m_VariableNames.begin(), m_VariableNames.end(), var);
+      if (pos == m_VariableNames.end())
+      {
+        mitkThrowException(FormulaParserException) << "No variable '" << var << "' defined in lookup";
+      }
+
+      ProgramFragment result;
+      result.instructions.push_back(makeInstruction(CompiledFormula::OpCode::Variable));
+      result.instructions.back().variable = static_cast<std::size_t>(pos - m_VariableNames.begin());
+      return result;
+    }
+
+    /*! the rules of the grammar. */
+    qi::rule<Iter, ProgramFragment(), Skipper> start;
+    qi::rule<Iter, ProgramFragment(), Skipper> expression;
+    qi::rule<Iter, ProgramFragment(), Skipper> term;
+    qi::rule<Iter, ProgramFragment(), Skipper> factor;
+    qi::rule<Iter, ProgramFragment(), Skipper> variable;
+    qi::rule<Iter, ProgramFragment(), Skipper> primary;
+  };
+
+  CompiledFormula::CompiledFormula() : m_StackSize(0), m_NumberOfVariables(0)
+  {}
+
+  CompiledFormula::CompiledFormula(const ProgramType& program, std::size_t numberOfVariables)
+    : m_Program(program), m_StackSize(0), m_NumberOfVariables(numberOfVariables)
+  {
+    std::size_t depth = 0;
+    for (const auto& instruction : m_Program)
+    {
+      switch (instruction.op)
+      {
+      case OpCode::Constant:
+      case OpCode::Variable:
+        ++depth;
+        break;
+      case OpCode::Negate:
+      case OpCode::Function:
+        break;
+      default:
+        --depth;
+      }
+      m_StackSize = std::max(m_StackSize, depth);
+    }
+  }
+
+  CompiledFormula::ValueType CompiledFormula::evaluate(const ValueType* variables) const
+  {
+    ValueType result = 0;
+    this->evaluate(variables, m_NumberOfVariables, nullptr, 1, &result);
+    return result;
+  }
+
+  void CompiledFormula::evaluate(const ValueType* variables, std::size_t gridVariable, const ValueType* grid,
+    std::size_t gridSize, ValueType* results) const
+  {
+    if (m_Program.empty())
+    {
+      mitkThrowException(FormulaParserException) << "Cannot evaluate an empty formula.";
+    }
+    if (gridSize == 0)
+    {
+      return;
+    }
+
+    // Every stack slot holds the values of all grid positions
+    std::vector<ValueType> stack(m_StackSize * gridSize);
+    ValueType* top = stack.data();
+
+    for (const auto& instruction : m_Program)
+    {
+      switch (instruction.op)
+      {
+      case OpCode::Constant:
+        std::fill_n(top, gridSize, instruction.value);
+        top += gridSize;
+        break;
+      case OpCode::Variable:
+        if (instruction.variable == gridVariable)
+        {
+          std::copy_n(grid, gridSize, top);
+        }
+        else
+        {
+          std::fill_n(top, gridSize, variables[instruction.variable]);
+        }
+        top += gridSize;
+        break;
+      case OpCode::Negate:
+      {
+        ValueType* operand = top - gridSize;
+        for (std::size_t i = 0; i < gridSize; ++i)
+          operand[i] = -operand[i];
+        break;
+      }
+      case OpCode::Function:
+      {
+        ValueType* operand = top - gridSize;
+        for (std::size_t i = 0; i < gridSize; ++i)
+          operand[i] = instruction.function(operand[i]);
+        break;
+      }
+      case OpCode::Add:
+      {
+        ValueType* left = top - 2 * gridSize;
+        const ValueType* right = top - gridSize;
+        for (std::size_t i = 0; i < gridSize; ++i)
+          left[i] += right[i];
+        top -= gridSize;
+        break;
+      }
+      case OpCode::Subtract:
+      {
+        ValueType* left = top - 2 * gridSize;
+        const ValueType* right = top - gridSize;
+        for (std::size_t i = 0; i < gridSize; ++i)
+          left[i] -= right[i];
+        top -= gridSize;
+        break;
+      }
+      case OpCode::Multiply:
+      {
+        ValueType* left = top - 2 * gridSize;
+        const ValueType* right = top - gridSize;
+        for (std::size_t i = 0; i < gridSize; ++i)
+          left[i] *= right[i];
+        top -= gridSize;
+        break;
+      }
+      case OpCode::Divide:
+      {
+        ValueType* left = top - 2 * gridSize;
+        const ValueType* right = top - gridSize;
+        for (std::size_t i = 0; i < gridSize; ++i)
+          left[i] /= right[i];
+        top -= gridSize;
+        break;
+      }
+      }
+    }
+
+    std::copy_n(stack.data(), gridSize, results);
+  }
+
+  std::size_t CompiledFormula::getNumberOfVariables() const
+  {
+    return m_NumberOfVariables;
+  }
+
+  const CompiledFormula::ProgramType& CompiledFormula::getProgram() const
+  {
+    return m_Program;
+  }
+
 
   FormulaParser::FormulaParser(const VariableMapType* variables) : m_Variables(variables)
   {}
@@ -270,6 +569,35 @@ namespace mitk
     return result;
   };
 
+  CompiledFormula FormulaParser::compile(const std::string& input, const std::vector<std::string>& variableNames)
+  {
+    std::string::const_iterator iter = input.begin();
+    std::string::const_iterator end = input.end();
+    ProgramFragment result;
+
+    try
+    {
+      if (!qi::phrase_parse(iter, end, CompileGrammar(variableNames), ascii::space, result))
+      {
+        mitkThrowException(FormulaParserException) << "Could not parse '" << input <<
+          "': Grammar could not be applied to the input " << "at all.";
+      }
+    }
+    catch (qi::expectation_failure<Iter>& e)
+    {
+      std::string parsed = "";
+
+      for (Iter i = input.begin(); i != e.first; i++)
+      {
+        parsed += *i;
+      }
+      mitkThrowException(FormulaParserException) << "Error while parsing '" << input <<
+        "': Unexpected character '" << *e.first << "' after '" << parsed << "'";
+    }
+
+    return CompiledFormula(result.instructions, variableNames.size());
+  }
+
   FormulaParser::ValueType FormulaParser::lookupVariable(const std::string var)
   {
     if (m_Variables == nullptr)
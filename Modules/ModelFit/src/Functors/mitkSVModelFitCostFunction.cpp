@@ -22,12 +22,17 @@ mitk::SVModelFitCostFunction::MeasureType mitk::SVModelFitCostFunction::GetValue
 
   SignalType signal = m_Model->GetSignal(parameter);
 
+  measure = CalcCheckedMeasure(parameter, signal);
+
+  return measure;
+}
+
+mitk::SVModelFitCostFunction::MeasureType mitk::SVModelFitCostFunction::CalcCheckedMeasure(const ParametersType &parameter, const SignalType &signal) const
+{
   if(signal.GetSize() != m_Sample.GetSize()) itkExceptionMacro("Signal size does not matche sample size!");
   if(signal.GetSize() == 0)  itkExceptionMacro("Signal is empty!");
 
-  measure = CalcMeasure(parameter, signal);
-
-  return measure;
+  return CalcMeasure(parameter, signal);
 }
 
 void mitk::SVModelFitCostFunction::GetDerivative (const ParametersType &parameters, DerivativeType &derivative) const
@@ -36,17 +41,28 @@ void mitk::SVModelFitCostFunction::GetDerivative (const ParametersType &paramete
 
   derivative.SetSize(paramCount);
 
+  /* All perturbed parameter sets are passed to the model at once, so that models
+   * can evaluate them together (e.g. numeric models integrate them in one pass).*/
+  ModelBase::ParametersBatchType parameterSets(2 * paramCount, parameters);
+  for ( ParametersType::SizeValueType i = 0; i < paramCount; i++ )
+  {
+    parameterSets[2 * i][i] -= m_DerivativeStepLength;
+    parameterSets[2 * i + 1][i] += m_DerivativeStepLength;
+  }
+
+  ModelBase::ModelResultBatchType signals = m_Model->GetSignalBatch(parameterSets);
+
   for ( ParametersType::SizeValueType i = 0; i < paramCount; i++ )
   {
     ParametersType newParameters = parameters;
     newParameters[i] -= m_DerivativeStepLength;
 
-    MeasureType e0 = GetValue(newParameters);
+    MeasureType e0 = CalcCheckedMeasure(newParameters, signals[2 * i]);
 
     newParameters = parameters;
     newParameters[i] += m_DerivativeStepLength;
 
-    MeasureType e1 = GetValue(newParameters);
+    MeasureType e1 = CalcCheckedMeasure(newParameters, signals[2 * i + 1]);
 
     derivative[i] = (e1 - e0) / ( 2 * m_DerivativeStepLength );
   }
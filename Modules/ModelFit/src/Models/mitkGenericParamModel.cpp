@@ -35,7 +35,7 @@ std::string mitk::GenericParamModel::GetXName() const
   return "x";
 };
 
-mitk::GenericParamModel::GenericParamModel(): m_FunctionString(""), m_NumberOfParameters(1)
+mitk::GenericParamModel::GenericParamModel(): m_FunctionString(""), m_NumberOfParameters(1), m_CompiledNumberOfParameters(0)
 {
 };
 
@@ -91,32 +91,40 @@ mitk::GenericParamModel::GetNumberOfParameters() const
   return m_NumberOfParameters;
 };
 
+std::shared_ptr<const mitk::CompiledFormula>
+mitk::GenericParamModel::GetCompiledFunction() const
+{
+  std::lock_guard<std::mutex> lock(m_CompiledFunctionMutex);
+
+  if (!m_CompiledFunction || m_CompiledFunctionString != m_FunctionString || m_CompiledNumberOfParameters != m_NumberOfParameters)
+  {
+    // x is always the first variable, the parameters follow in their order
+    std::vector<std::string> variableNames = this->GetParameterNames();
+    variableNames.insert(variableNames.begin(), GetXName());
+
+    m_CompiledFunction = std::make_shared<const CompiledFormula>(FormulaParser::compile(m_FunctionString, variableNames));
+    m_CompiledFunctionString = m_FunctionString;
+    m_CompiledNumberOfParameters = m_NumberOfParameters;
+  }
+
+  return m_CompiledFunction;
+}
+
 mitk::GenericParamModel::ModelResultType
 mitk::GenericParamModel::ComputeModelfunction(const ParametersType& parameters) const
 {
   unsigned int timeSteps = m_TimeGrid.GetSize();
   ModelResultType signal(timeSteps);
 
-  std::map<std::string, double> parameterMap;
-  parameterMap.insert(std::make_pair(GetXName(), 0.0));
+  auto function = this->GetCompiledFunction();
 
-  auto paramNames = this->GetParameterNames();
-  for (ParametersType::size_type i = 0; i < parameters.size(); ++i)
+  std::vector<CompiledFormula::ValueType> variables(function->getNumberOfVariables(), 0.0);
+  for (ParametersType::size_type i = 0; i < parameters.size() && i + 1 < variables.size(); ++i)
   {
-    parameterMap.insert(std::make_pair(paramNames[i], parameters[i]));
+    variables[i + 1] = parameters[i];
   }
 
-  FormulaParser formulaParser(&parameterMap);
-
-  TimeGridType::const_iterator timeGridEnd = m_TimeGrid.end();
-  ModelResultType::iterator signalPos = signal.begin();
-
-  for (TimeGridType::const_iterator gridPos = m_TimeGrid.begin(); gridPos != timeGridEnd;
-       ++gridPos, ++signalPos)
-  {
-    parameterMap[GetXName()] = *gridPos;
-    *signalPos = formulaParser.parse(m_FunctionString);
-  }
+  function->evaluate(variables.data(), 0, m_TimeGrid.data_block(), timeSteps, signal.data_block());
 
   return signal;
 };
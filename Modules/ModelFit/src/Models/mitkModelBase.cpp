@@ -146,6 +146,46 @@ mitk::ModelBase::ModelResultType mitk::ModelBase::GetSignal(const ParametersType
   return signal;
 }
 
+mitk::ModelBase::ModelResultBatchType mitk::ModelBase::GetSignalBatch(const ParametersBatchType& parameterSets) const
+{
+  for (const auto& parameters : parameterSets)
+  {
+    if (parameters.size() != this->GetNumberOfParameters())
+    {
+      itkExceptionMacro("Passed parameter set has wrong size for model. Cannot evaluate model. Required size: "
+                        << this->GetNumberOfParameters() << "; passed parameters: " << parameters);
+    }
+  }
+
+  std::string error;
+
+  if (!ValidateModel(error))
+  {
+    itkExceptionMacro("Cannot evaluate model and return signal. Model is in an invalid state. Validation error: "
+                      << error);
+  }
+
+  if (parameterSets.empty())
+  {
+    return ModelResultBatchType();
+  }
+
+  return ComputeModelfunctionBatch(parameterSets);
+}
+
+mitk::ModelBase::ModelResultBatchType mitk::ModelBase::ComputeModelfunctionBatch(const ParametersBatchType& parameterSets) const
+{
+  ModelResultBatchType signals;
+  signals.reserve(parameterSets.size());
+
+  for (const auto& parameters : parameterSets)
+  {
+    signals.push_back(ComputeModelfunction(parameters));
+  }
+
+  return signals;
+}
+
 bool mitk::ModelBase::ValidateModel(std::string& /*error*/) const
 {
   return true;
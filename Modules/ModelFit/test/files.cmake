@@ -12,5 +12,6 @@ SET(MODULE_TESTS
   mitkMVConstrainedCostFunctionDecoratorTest.cpp
   mitkConcreteModelFactoryBaseTest.cpp
   mitkFormulaParserTest.cpp
+  mitkGenericParamModelTest.cpp
   mitkModelFitResultRelationRuleTest.cpp
 )
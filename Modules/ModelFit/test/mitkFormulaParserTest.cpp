@@ -211,6 +211,45 @@ public:
 
     delete parser;
   }
+
+  static void TestCompile()
+  {
+    std::vector<std::string> names = { "x", "test" };
+
+    // errors are detected while compiling
+    MITK_TEST_FOR_EXCEPTION(FormulaParserException, FormulaParser::compile("", names));
+    MITK_TEST_FOR_EXCEPTION(FormulaParserException, FormulaParser::compile("5=", names));
+    MITK_TEST_FOR_EXCEPTION(FormulaParserException, FormulaParser::compile("a", names));
+    MITK_TEST_FOR_EXCEPTION(FormulaParserException, CompiledFormula().evaluate(nullptr));
+
+    std::map<std::string, double> varMap;
+    varMap["x"] = 0.25;
+    varMap["test"] = 17;
+    FormulaParser parser(&varMap);
+    double values[] = { 0.25, 17 };
+
+    const std::vector<std::string> formulas = { "-7 + +1 - -1", "(1+2)*(4-2)", "2*test-test",
+      "test*exp(-1.0*x*test)+3", "abs(-x) / (test - 2*x)", "sind(test) + cosd(x) * fresnelC(x)" };
+
+    bool equal = true;
+    for (const auto& formula : formulas)
+    {
+      equal = equal && std::abs(FormulaParser::compile(formula, names).evaluate(values) - parser.parse(formula)) < 1e-12;
+    }
+    MITK_TEST_CONDITION_REQUIRED(equal,
+      "Testing if compiled formulas produce the same results as parse");
+
+    MITK_TEST_CONDITION_REQUIRED(FormulaParser::compile("(1+2)*(4-2)", names).getProgram().size() == 1,
+      "Testing if constant expressions are folded");
+
+    // evaluation for a whole grid
+    CompiledFormula formula = FormulaParser::compile("test*x - x", names);
+    double grid[] = { 0, 1, 2, 3 };
+    double results[4];
+    formula.evaluate(values, 0, grid, 4, results);
+    MITK_TEST_CONDITION_REQUIRED(results[0] == 0 && results[1] == 16 && results[2] == 32 && results[3] == 48,
+      "Testing if grid evaluation produces the correct results");
+  }
 };
 
 int mitkFormulaParserTest(int, char *[])
@@ -220,6 +259,7 @@ int mitkFormulaParserTest(int, char *[])
   FormulaParserTests::TestConstructor();
   FormulaParserTests::TestLookupVariable();
   FormulaParserTests::TestParse();
+  FormulaParserTests::TestCompile();
 
   MITK_TEST_END();
 }
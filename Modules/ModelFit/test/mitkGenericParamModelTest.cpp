@@ -0,0 +1,91 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <chrono>
+#include <cmath>
+
+#include "mitkTestingMacros.h"
+
+#include "mitkGenericParamModel.h"
+#include "mitkExpDecayOffsetModel.h"
+
+int mitkGenericParamModelTest(int  /*argc*/, char*[] /*argv[]*/)
+{
+  MITK_TEST_BEGIN("GenericParamModel")
+
+  const unsigned int numberOfTimeSteps = 100;
+  mitk::ModelBase::TimeGridType grid(numberOfTimeSteps);
+  for (unsigned int i = 0; i < numberOfTimeSteps; ++i)
+  {
+    grid[i] = i * 0.1;
+  }
+
+  mitk::ExpDecayOffsetModel::Pointer expDecayModel = mitk::ExpDecayOffsetModel::New();
+  expDecayModel->SetTimeGrid(grid);
+
+  mitk::GenericParamModel::Pointer genericModel = mitk::GenericParamModel::New();
+  genericModel->SetTimeGrid(grid);
+  genericModel->SetNumberOfParameters(3);
+  genericModel->SetFunctionString(expDecayModel->GetFunctionString());
+
+  mitk::ModelBase::ParametersType parameters(3);
+  parameters[0] = 10;
+  parameters[1] = 0.5;
+  parameters[2] = 2;
+
+  //Compare the signal of the generic model with the hard-coded model
+  auto expDecaySignal = expDecayModel->GetSignal(parameters);
+  auto genericSignal = genericModel->GetSignal(parameters);
+  bool equal = expDecaySignal.GetSize() == genericSignal.GetSize();
+  for (unsigned int i = 0; equal && i < numberOfTimeSteps; ++i)
+  {
+    equal = std::abs(expDecaySignal[i] - genericSignal[i]) < 1e-10;
+  }
+  MITK_TEST_CONDITION(equal, "Generic model computes the same signal as ExpDecayOffsetModel.");
+
+  //Changes of the function string must be respected
+  genericModel->SetFunctionString("a+b*x-c");
+  genericSignal = genericModel->GetSignal(parameters);
+  MITK_TEST_CONDITION(std::abs(genericSignal[10] - (10 + 0.5 * grid[10] - 2)) < 1e-10, "Changed function string is used.");
+
+  genericModel->SetNumberOfParameters(2);
+  MITK_TEST_FOR_EXCEPTION(itk::ExceptionObject, genericModel->GetSignal(parameters));
+
+  //Benchmark: evaluate both models as often as a fit of a small image would do
+  genericModel->SetNumberOfParameters(3);
+  genericModel->SetFunctionString(expDecayModel->GetFunctionString());
+
+  const unsigned int numberOfEvaluations = 10000;
+  double checksum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < numberOfEvaluations; ++i)
+  {
+    parameters[1] = 0.5 + i * 1e-5;
+    checksum += expDecayModel->GetSignal(parameters)[1];
+  }
+  auto expDecayDuration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < numberOfEvaluations; ++i)
+  {
+    parameters[1] = 0.5 + i * 1e-5;
+    checksum -= genericModel->GetSignal(parameters)[1];
+  }
+  auto genericDuration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  MITK_INFO << "Duration of " << numberOfEvaluations << " evaluations with " << numberOfTimeSteps << " time steps: ExpDecayOffsetModel "
+    << expDecayDuration << " ms, GenericParamModel " << genericDuration << " ms";
+  MITK_TEST_CONDITION(std::abs(checksum) < 1e-6, "Benchmark evaluations of both models are equal.");
+
+  MITK_TEST_END()
+}
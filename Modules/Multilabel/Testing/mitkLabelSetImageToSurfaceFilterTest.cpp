@@ -0,0 +1,177 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkLabelSetImageToSurfaceFilter.h>
+#include <mitkSurface.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <vtkPolyData.h>
+
+#include <algorithm>
+
+class mitkLabelSetImageToSurfaceFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLabelSetImageToSurfaceFilterTestSuite);
+  MITK_TEST(GenerateAllLabels_OneSurfacePerLabel);
+  MITK_TEST(RequestedLabel_OnlyThisSurface);
+  MITK_TEST(AnisotropicSpacing_SurfaceInWorldCoordinates);
+  MITK_TEST(Smoothing_SigmaInMillimeters);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+
+  void FillCube(mitk::ImagePixelWriteAccessor<unsigned short, 3> &accessor,
+                unsigned int from,
+                unsigned int to,
+                unsigned short label)
+  {
+    itk::Index<3> index;
+    for (index[2] = from; index[2] <= to; ++index[2])
+      for (index[1] = from; index[1] <= to; ++index[1])
+        for (index[0] = from; index[0] <= to; ++index[0])
+          accessor.SetPixelByIndex(index, label);
+  }
+
+  /** Checks that the surface lies around the cube of the given index range (by default spacing 1, origin 0). */
+  void CheckSurfaceAroundCube(mitk::Surface *surface,
+                              double from,
+                              double to,
+                              const mitk::Vector3D &spacing = mitk::Vector3D(1.0),
+                              const mitk::Point3D &origin = mitk::Point3D(0.0))
+  {
+    auto polyData = surface->GetVtkPolyData();
+    CPPUNIT_ASSERT(nullptr != polyData);
+    CPPUNIT_ASSERT(polyData->GetNumberOfPoints() > 0);
+
+    double bounds[6];
+    polyData->GetBounds(bounds);
+    for (int i = 0; i < 3; ++i)
+    {
+      const double lower = origin[i] + from * spacing[i];
+      const double upper = origin[i] + to * spacing[i];
+      CPPUNIT_ASSERT(bounds[2 * i] > lower - 1.5 * spacing[i] && bounds[2 * i] < lower);
+      CPPUNIT_ASSERT(bounds[2 * i + 1] > upper && bounds[2 * i + 1] < upper + 1.5 * spacing[i]);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[3] = {24, 24, 24};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<unsigned short>(), 3, dimensions);
+
+    mitk::ImagePixelWriteAccessor<unsigned short, 3> accessor(m_Image);
+    std::fill(accessor.GetData(), accessor.GetData() + 24 * 24 * 24, 0);
+    this->FillCube(accessor, 3, 7, 1);
+    this->FillCube(accessor, 13, 19, 4);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void GenerateAllLabels_OneSurfacePerLabel()
+  {
+    auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), filter->GetAvailableLabels().size());
+    CPPUNIT_ASSERT_EQUAL(125ul, filter->GetAvailableLabels().at(1));
+    CPPUNIT_ASSERT_EQUAL(343ul, filter->GetAvailableLabels().at(4));
+
+    CPPUNIT_ASSERT_EQUAL(2u, static_cast<unsigned int>(filter->GetNumberOfIndexedOutputs()));
+    CPPUNIT_ASSERT_EQUAL(mitk::LabelSetImageToSurfaceFilter::LabelType(1), filter->GetLabelOfOutput(0));
+    CPPUNIT_ASSERT_EQUAL(mitk::LabelSetImageToSurfaceFilter::LabelType(4), filter->GetLabelOfOutput(1));
+
+    this->CheckSurfaceAroundCube(filter->GetOutput(0), 3, 7);
+    this->CheckSurfaceAroundCube(filter->GetOutput(1), 13, 19);
+  }
+
+  void RequestedLabel_OnlyThisSurface()
+  {
+    auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->SetRequestedLabel(4);
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(1u, static_cast<unsigned int>(filter->GetNumberOfIndexedOutputs()));
+    CPPUNIT_ASSERT_EQUAL(mitk::LabelSetImageToSurfaceFilter::LabelType(4), filter->GetLabelOfOutput(0));
+    this->CheckSurfaceAroundCube(filter->GetOutput(), 13, 19);
+
+    filter->SetRequestedLabel(2);
+    CPPUNIT_ASSERT_THROW(filter->Update(), itk::ExceptionObject);
+  }
+
+  void AnisotropicSpacing_SurfaceInWorldCoordinates()
+  {
+    mitk::Vector3D spacing;
+    spacing[0] = 0.5;
+    spacing[1] = 1.0;
+    spacing[2] = 3.0;
+    mitk::Point3D origin;
+    origin[0] = 10.0;
+    origin[1] = -5.0;
+    origin[2] = 2.0;
+
+    auto image = m_Image->Clone();
+    image->SetSpacing(spacing);
+    image->SetOrigin(origin);
+
+    auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(image);
+    filter->SetRequestedLabel(4);
+    filter->SetUseSmoothing(1);
+    filter->SetSigma(0.5);
+    filter->Update();
+
+    this->CheckSurfaceAroundCube(filter->GetOutput(), 13, 19, spacing, origin);
+  }
+
+  void Smoothing_SigmaInMillimeters()
+  {
+    // twice the spacing and twice the sigma smooth the same voxels, so the surface only scales by 2
+    auto generateSurface = [this](double spacing, float sigma) {
+      auto image = m_Image->Clone();
+      image->SetSpacing(mitk::Vector3D(spacing));
+
+      auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+      filter->SetInput(image);
+      filter->SetRequestedLabel(4);
+      filter->SetUseSmoothing(1);
+      filter->SetSigma(sigma);
+      filter->Update();
+
+      mitk::Surface::Pointer surface = filter->GetOutput();
+      surface->DisconnectPipeline();
+      return surface;
+    };
+
+    auto surface = generateSurface(1.0, 1.0f);
+    auto scaledSurface = generateSurface(2.0, 2.0f);
+
+    CPPUNIT_ASSERT_EQUAL(surface->GetVtkPolyData()->GetNumberOfPoints(),
+                         scaledSurface->GetVtkPolyData()->GetNumberOfPoints());
+
+    double bounds[6];
+    double scaledBounds[6];
+    surface->GetVtkPolyData()->GetBounds(bounds);
+    scaledSurface->GetVtkPolyData()->GetBounds(scaledBounds);
+    for (int i = 0; i < 6; ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0 * bounds[i], scaledBounds[i], 1e-3);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImageToSurfaceFilter)
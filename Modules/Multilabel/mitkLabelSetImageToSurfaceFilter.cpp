@@ -17,23 +17,24 @@ found in the LICENSE file.
 
 // itk
 #include <itkAntiAliasBinaryImageFilter.h>
-#include <itkAutoCropLabelMapFilter.h>
-#include <itkBinaryThresholdImageFilter.h>
-#include <itkLabelImageToLabelMapFilter.h>
-#include <itkLabelMap.h>
-#include <itkLabelMapToLabelImageFilter.h>
-#include <itkLabelObject.h>
-#include <itkNumericTraits.h>
+#include <itkImageRegionIterator.h>
+#include <itkImageScanlineConstIterator.h>
+#include <itkMultiThreaderBase.h>
 #include <itkSmoothingRecursiveGaussianImageFilter.h>
 
 // vtk
 #include <vtkCleanPolyData.h>
-#include <vtkImageChangeInformation.h>
+#include <vtkFloatArray.h>
+#include <vtkFlyingEdges3D.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
-#include <vtkMarchingCubes.h>
+#include <vtkPointData.h>
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 mitk::LabelSetImageToSurfaceFilter::LabelSetImageToSurfaceFilter()
   : m_GenerateAllLabels(false), m_RequestedLabel(1), m_BackgroundLabel(0), m_UseSmoothing(0), m_Sigma(0.1)
 {
@@ -82,57 +83,226 @@ void mitk::LabelSetImageToSurfaceFilter::GenerateData()
   AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
 }
 
+namespace
+{
+  template <unsigned int VDimension>
+  struct LabelExtent
+  {
+    itk::Index<VDimension> Min;
+    itk::Index<VDimension> Max;
+    unsigned long Count = 0;
+
+    /** Adds a run of pixels along the first axis. */
+    void AddRun(const itk::Index<VDimension> &start, unsigned long length)
+    {
+      auto end = start;
+      end[0] += length - 1;
+      for (unsigned int d = 0; d < VDimension; ++d)
+      {
+        Min[d] = 0 == Count ? start[d] : std::min(Min[d], start[d]);
+        Max[d] = 0 == Count ? end[d] : std::max(Max[d], end[d]);
+      }
+      Count += length;
+    }
+
+    void Merge(const LabelExtent &other)
+    {
+      if (0 == other.Count)
+        return;
+
+      for (unsigned int d = 0; d < VDimension; ++d)
+      {
+        Min[d] = 0 == Count ? other.Min[d] : std::min(Min[d], other.Min[d]);
+        Max[d] = 0 == Count ? other.Max[d] : std::max(Max[d], other.Max[d]);
+      }
+      Count += other.Count;
+    }
+  };
+
+  /**
+   * Determines the bounding boxes and the pixel counts of all values in the image with one scan.
+   * Blocks of slices are scanned in parallel.
+   */
+  template <typename TPixel, unsigned int VDimension>
+  std::map<TPixel, LabelExtent<VDimension>> ComputeLabelExtents(const itk::Image<TPixel, VDimension> *input)
+  {
+    typedef itk::Image<TPixel, VDimension> ImageType;
+    typedef std::map<TPixel, LabelExtent<VDimension>> ExtentMapType;
+
+    const auto largestRegion = input->GetLargestPossibleRegion();
+    const auto numberOfSlices = largestRegion.GetSize(VDimension - 1);
+    const auto numberOfBlocks = std::min<itk::SizeValueType>(
+      numberOfSlices, 4 * itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+
+    ExtentMapType extents;
+    std::mutex extentsMutex;
+
+    auto multiThreader = itk::MultiThreaderBase::New();
+    multiThreader->SetNumberOfWorkUnits(itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+    multiThreader->ParallelizeArray(
+      0,
+      numberOfBlocks,
+      [&](itk::SizeValueType block) {
+        auto blockRegion = largestRegion;
+        const auto firstSlice = block * numberOfSlices / numberOfBlocks;
+        const auto endSlice = (block + 1) * numberOfSlices / numberOfBlocks;
+        blockRegion.SetIndex(VDimension - 1, largestRegion.GetIndex(VDimension - 1) + firstSlice);
+        blockRegion.SetSize(VDimension - 1, endSlice - firstSlice);
+
+        // runs of equal values are added at once, to avoid a map lookup per pixel
+        ExtentMapType blockExtents;
+        itk::ImageScanlineConstIterator<ImageType> iter(input, blockRegion);
+        while (!iter.IsAtEnd())
+        {
+          while (!iter.IsAtEndOfLine())
+          {
+            const TPixel value = iter.Get();
+            const auto runStart = iter.GetIndex();
+            unsigned long runLength = 0;
+            while (!iter.IsAtEndOfLine() && iter.Get() == value)
+            {
+              ++runLength;
+              ++iter;
+            }
+            blockExtents[value].AddRun(runStart, runLength);
+          }
+          iter.NextLine();
+        }
+
+        std::lock_guard<std::mutex> lock(extentsMutex);
+        for (const auto &blockExtent : blockExtents)
+          extents[blockExtent.first].Merge(blockExtent.second);
+      },
+      nullptr);
+
+    return extents;
+  }
+}
+
+mitk::LabelSetImageToSurfaceFilter::LabelType mitk::LabelSetImageToSurfaceFilter::GetLabelOfOutput(unsigned int idx) const
+{
+  auto iter = m_IndexToLabels.find(idx);
+  if (iter == m_IndexToLabels.end())
+    mitkThrow() << "No surface was generated for output " << idx << ".";
+
+  return iter->second;
+}
+
 template <typename TPixel, unsigned int VDimension>
 void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPixel, VDimension> *input,
                                                             mitk::Surface * /*surface*/)
 {
-  typedef itk::Image<TPixel, VDimension> ImageType;
+  typedef itk::ImageRegion<VDimension> RegionType;
 
-  typedef itk::BinaryThresholdImageFilter<ImageType, ImageType> BinaryThresholdFilterType;
-  typedef itk::LabelObject<TPixel, VDimension> LabelObjectType;
-  typedef itk::LabelMap<LabelObjectType> LabelMapType;
-  typedef itk::LabelImageToLabelMapFilter<ImageType, LabelMapType> Image2LabelMapType;
-  typedef itk::AutoCropLabelMapFilter<LabelMapType> AutoCropType;
-  typedef itk::LabelMapToLabelImageFilter<LabelMapType, ImageType> LabelMap2ImageType;
+  const auto extents = ComputeLabelExtents(input);
 
-  typedef itk::Image<float, VDimension> RealImageType;
+  m_AvailableLabels.clear();
+  m_IndexToLabels.clear();
 
-  typedef itk::AntiAliasBinaryImageFilter<ImageType, RealImageType> AntiAliasFilterType;
-  typedef itk::SmoothingRecursiveGaussianImageFilter<RealImageType, RealImageType> GaussianFilterType;
+  std::vector<TPixel> labels;
+  std::vector<RegionType> regions;
+  for (const auto &extent : extents)
+  {
+    if (static_cast<int>(extent.first) == m_BackgroundLabel)
+      continue;
+
+    m_AvailableLabels[static_cast<LabelType>(extent.first)] = extent.second.Count;
+
+    if (!m_GenerateAllLabels && static_cast<int>(extent.first) != m_RequestedLabel)
+      continue;
+
+    // crop to the label with a border, like itk::AutoCropLabelMapFilter does
+    RegionType region;
+    for (unsigned int d = 0; d < VDimension; ++d)
+    {
+      region.SetIndex(d, extent.second.Min[d] - 3);
+      region.SetSize(d, extent.second.Max[d] - extent.second.Min[d] + 7);
+    }
+    region.Crop(input->GetLargestPossibleRegion());
+
+    labels.push_back(extent.first);
+    regions.push_back(region);
+  }
+
+  if (labels.empty() && !m_GenerateAllLabels)
+    throw itk::ExceptionObject(__FILE__, __LINE__, "marching cubes has failed.");
+
+  // transformation from the spacing scaled index coordinates used by marching cubes to world coordinates
+  const auto *geometry = this->GetInput()->GetGeometry();
+  const mitk::Vector3D spacing = geometry->GetSpacing();
+  vtkSmartPointer<vtkMatrix4x4> vtkmatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  geometry->GetVtkTransform()->GetMatrix(vtkmatrix);
+  double(*matrix)[4] = vtkmatrix->Element;
+
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      matrix[i][j] /= spacing[j];
+
+  std::vector<vtkSmartPointer<vtkPolyData>> surfaces(labels.size());
+
+  if (1 == labels.size())
+  { // a single label may use all threads within its filters
+    surfaces[0] = this->GenerateLabelSurface(
+      input, labels[0], regions[0], matrix, itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+  }
+  else if (!labels.empty())
+  {
+    // one label per work unit, the filters of a label run single threaded
+    auto multiThreader = itk::MultiThreaderBase::New();
+    multiThreader->SetNumberOfWorkUnits(itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+    multiThreader->ParallelizeArray(
+      0,
+      labels.size(),
+      [&](itk::SizeValueType i) { surfaces[i] = this->GenerateLabelSurface(input, labels[i], regions[i], matrix, 1); },
+      nullptr);
+  }
+
+  if (!m_GenerateAllLabels && (surfaces.empty() || 0 == surfaces[0]->GetNumberOfPoints()))
+    throw itk::ExceptionObject(__FILE__, __LINE__, "marching cubes has failed.");
 
-  typename BinaryThresholdFilterType::Pointer thresholdFilter = BinaryThresholdFilterType::New();
-  thresholdFilter->SetInput(input);
-  thresholdFilter->SetLowerThreshold(m_RequestedLabel);
-  thresholdFilter->SetUpperThreshold(m_RequestedLabel);
-  thresholdFilter->SetOutsideValue(0);
-  thresholdFilter->SetInsideValue(1);
-  //  thresholdFilter->ReleaseDataFlagOn();
-  thresholdFilter->Update();
+  this->SetNumberOfIndexedOutputs(surfaces.size());
+  for (unsigned int i = 0; i < surfaces.size(); ++i)
+  {
+    if (nullptr == this->GetOutput(i))
+      this->SetNthOutput(i, this->MakeOutput(i));
 
-  typename Image2LabelMapType::Pointer image2label = Image2LabelMapType::New();
-  image2label->SetInput(thresholdFilter->GetOutput());
+    this->GetOutput(i)->SetVtkPolyData(surfaces[i], 0);
+    m_IndexToLabels[i] = static_cast<LabelType>(labels[i]);
+  }
+}
 
-  typename AutoCropType::SizeType border;
-  border[0] = 3;
-  border[1] = 3;
-  border[2] = 3;
+template <typename TPixel, unsigned int VDimension>
+vtkSmartPointer<vtkPolyData> mitk::LabelSetImageToSurfaceFilter::GenerateLabelSurface(
+  const itk::Image<TPixel, VDimension> *input,
+  TPixel label,
+  const itk::ImageRegion<VDimension> &region,
+  double matrix[4][4],
+  unsigned int numberOfWorkUnits)
+{
+  typedef itk::Image<TPixel, VDimension> ImageType;
+  typedef itk::Image<float, VDimension> RealImageType;
 
-  typename AutoCropType::Pointer autoCropFilter = AutoCropType::New();
-  autoCropFilter->SetInput(image2label->GetOutput());
-  autoCropFilter->SetCropBorder(border);
-  autoCropFilter->InPlaceOn();
+  typedef itk::AntiAliasBinaryImageFilter<ImageType, RealImageType> AntiAliasFilterType;
+  typedef itk::SmoothingRecursiveGaussianImageFilter<RealImageType, RealImageType> GaussianFilterType;
 
-  typename LabelMap2ImageType::Pointer label2image = LabelMap2ImageType::New();
-  label2image->SetInput(autoCropFilter->GetOutput());
+  // binary image of the label, cropped to its region; keeps spacing and origin, so sigma is given in mm
+  auto binaryImage = ImageType::New();
+  binaryImage->CopyInformation(input);
+  binaryImage->SetRegions(region);
+  binaryImage->Allocate();
 
-  label2image->Update();
+  itk::ImageRegionConstIterator<ImageType> inputIter(input, region);
+  itk::ImageRegionIterator<ImageType> binaryIter(binaryImage, region);
+  for (; !inputIter.IsAtEnd(); ++inputIter, ++binaryIter)
+    binaryIter.Set(inputIter.Get() == label ? 1 : 0);
 
   typename AntiAliasFilterType::Pointer antiAliasFilter = AntiAliasFilterType::New();
-  antiAliasFilter->SetInput(label2image->GetOutput());
+  antiAliasFilter->SetInput(binaryImage);
   antiAliasFilter->SetMaximumRMSError(0.001);
   antiAliasFilter->SetNumberOfLayers(3);
   antiAliasFilter->SetUseImageSpacing(false);
   antiAliasFilter->SetNumberOfIterations(40);
+  antiAliasFilter->SetNumberOfWorkUnits(numberOfWorkUnits);
 
   antiAliasFilter->Update();
 
@@ -143,6 +313,7 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
     typename GaussianFilterType::Pointer gaussianFilter = GaussianFilterType::New();
     gaussianFilter->SetSigma(m_Sigma);
     gaussianFilter->SetInput(antiAliasFilter->GetOutput());
+    gaussianFilter->SetNumberOfWorkUnits(numberOfWorkUnits);
     gaussianFilter->Update();
     result = gaussianFilter->GetOutput();
   }
@@ -153,62 +324,45 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
 
   result->DisconnectPipeline();
 
-  typename ImageType::RegionType cropRegion;
-  cropRegion = autoCropFilter->GetOutput()->GetLargestPossibleRegion();
-
-  const typename ImageType::IndexType &cropIndex = cropRegion.GetIndex();
+  // wrap the result for vtk; origin and spacing are given in spacing scaled index coordinates
+  const auto &resultRegion = result->GetBufferedRegion();
+  const auto &spacing = input->GetSpacing();
 
-  m_ResultImage = mitk::Image::New();
-  mitk::CastToMitkImage(result, m_ResultImage);
+  vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+  scalars->SetArray(result->GetBufferPointer(), resultRegion.GetNumberOfPixels(), 1);
 
-  mitk::BaseGeometry *newGeometry = m_ResultImage->GetSlicedGeometry();
-  mitk::Point3D origin;
-  vtk2itk(cropIndex, origin);
-  this->GetInput()->GetGeometry()->IndexToWorld(origin, origin);
-  newGeometry->SetOrigin(origin);
+  vtkSmartPointer<vtkImageData> vtkimage = vtkSmartPointer<vtkImageData>::New();
+  vtkimage->SetDimensions(resultRegion.GetSize(0), resultRegion.GetSize(1), resultRegion.GetSize(2));
+  vtkimage->SetSpacing(spacing[0], spacing[1], spacing[2]);
+  vtkimage->SetOrigin(resultRegion.GetIndex(0) * spacing[0],
+                      resultRegion.GetIndex(1) * spacing[1],
+                      resultRegion.GetIndex(2) * spacing[2]);
+  vtkimage->GetPointData()->SetScalars(scalars);
 
-  auto *vtkimage = m_ResultImage->GetVtkImageData(0);
-
-  vtkSmartPointer<vtkImageChangeInformation> indexCoordinatesImageFilter =
-    vtkSmartPointer<vtkImageChangeInformation>::New();
-  indexCoordinatesImageFilter->SetInputData(vtkimage);
-  indexCoordinatesImageFilter->SetOutputOrigin(0.0, 0.0, 0.0);
-
-  vtkSmartPointer<vtkMarchingCubes> marching = vtkSmartPointer<vtkMarchingCubes>::New();
+  vtkSmartPointer<vtkFlyingEdges3D> marching = vtkSmartPointer<vtkFlyingEdges3D>::New();
   marching->ComputeScalarsOff();
   marching->ComputeNormalsOn();
-  marching->ComputeGradientsOn();
-  marching->SetInputConnection(indexCoordinatesImageFilter->GetOutputPort());
+  marching->ComputeGradientsOff();
+  marching->SetInputData(vtkimage);
   marching->SetValue(0, 0.0);
 
   marching->Update();
 
   vtkPolyData *polydata = marching->GetOutput();
 
-  if ((!polydata) || (!polydata->GetNumberOfPoints()))
-    throw itk::ExceptionObject(__FILE__, __LINE__, "marching cubes has failed.");
-
-  mitk::Vector3D spacing = newGeometry->GetSpacing();
+  if (!polydata || !polydata->GetNumberOfPoints())
+    return vtkSmartPointer<vtkPolyData>::New();
 
   vtkPoints *points = polydata->GetPoints();
-  vtkMatrix4x4 *vtkmatrix = vtkMatrix4x4::New();
-  newGeometry->GetVtkTransform()->GetMatrix(vtkmatrix);
-  double(*matrix)[4] = vtkmatrix->Element;
-
-  for (int i = 0; i < 3; ++i)
-    for (int j = 0; j < 3; ++j)
-      matrix[i][j] /= spacing[j];
-
-  unsigned int n = points->GetNumberOfPoints();
+  const vtkIdType n = points->GetNumberOfPoints();
   double point[3];
 
-  for (unsigned int i = 0; i < n; i++)
+  for (vtkIdType i = 0; i < n; i++)
   {
     points->GetPoint(i, point);
     mitkVtkLinearTransformPoint(matrix, point, point);
     points->SetPoint(i, point);
   }
-  vtkmatrix->Delete();
 
   vtkSmartPointer<vtkCleanPolyData> cleanPolyDataFilter = vtkSmartPointer<vtkCleanPolyData>::New();
   cleanPolyDataFilter->SetInputData(polydata);
@@ -219,6 +373,5 @@ void mitk::LabelSetImageToSurfaceFilter::InternalProcessing(const itk::Image<TPi
   cleanPolyDataFilter->PointMergingOn();
   cleanPolyDataFilter->Update();
 
-  mitk::Surface::Pointer output = this->GetOutput(0);
-  output->SetVtkPolyData(cleanPolyDataFilter->GetOutput(), 0);
+  return cleanPolyDataFilter->GetOutput();
 }
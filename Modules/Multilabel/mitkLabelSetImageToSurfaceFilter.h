@@ -19,6 +19,8 @@ found in the LICENSE file.
 #include <mitkSurfaceSource.h>
 
 #include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
 
 #include <itkImage.h>
 
@@ -29,7 +31,10 @@ namespace mitk
   /**
    * Generates surface meshes from a labelset image.
    * If you want to calculate a surface representation for all available labels,
-   * you may call GenerateAllLabelsOn().
+   * you may call GenerateAllLabelsOn(). Then the filter has one output per label that has
+   * pixels in the image (see GetLabelOfOutput()). The bounding boxes of all labels are
+   * determined by a single scan of the image, and the surfaces of the labels are generated
+   * concurrently, each only on the region of its label.
    */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceFilter : public SurfaceSource
   {
@@ -105,6 +110,18 @@ namespace mitk
      */
     itkSetMacro(Sigma, float);
 
+    /**
+     * Returns the label whose surface is provided by the output with the given index.
+     * Only valid after the filter was updated.
+     */
+    LabelType GetLabelOfOutput(unsigned int idx) const;
+
+    /**
+     * Returns the number of pixels of every label (except the background) found in the input.
+     * Only valid after the filter was updated.
+     */
+    itkGetConstReferenceMacro(AvailableLabels, LabelMapType);
+
   protected:
     LabelSetImageToSurfaceFilter();
 
@@ -124,11 +141,21 @@ namespace mitk
       out[2] = z;
     }
 
-    mitk::Image::Pointer m_ResultImage;
-
     template <typename TPixel, unsigned int VImageDimension>
     void InternalProcessing(const itk::Image<TPixel, VImageDimension> *input, mitk::Surface *surface);
 
+    /**
+    * Generates the surface of a single label, only regarding the passed region of the input.
+    * The matrix transforms from the spacing scaled index coordinates of the input to world coordinates.
+    * Returns an empty poly data if the label has no surface.
+    */
+    template <typename TPixel, unsigned int VImageDimension>
+    vtkSmartPointer<vtkPolyData> GenerateLabelSurface(const itk::Image<TPixel, VImageDimension> *input,
+                                                      TPixel label,
+                                                      const itk::ImageRegion<VImageDimension> &region,
+                                                      double matrix[4][4],
+                                                      unsigned int numberOfWorkUnits);
+
     bool m_GenerateAllLabels;
 
     int m_RequestedLabel;
@@ -15,8 +15,11 @@ found in the LICENSE file.
 
 #include "MitkPharmacokineticsExports.h"
 #include "mitkModelBase.h"
+#include "mitkAIFConvolutionEngine.h"
 #include "itkArray2D.h"
 
+#include <mutex>
+
 namespace mitk
 {
 
@@ -91,6 +94,12 @@ namespace mitk
 
     void PrintSelf(std::ostream& os, ::itk::Indent indent) const override;
 
+    /** Returns the convolution engine for the current model time grid and AIF settings.
+     * The engine is fetched again via AIFConvolutionEngine::GetSharedEngine() only if the model
+     * was modified since the last call, so models that are evaluated repeatedly (e.g. while fitting)
+     * neither interpolate the AIF nor recompute its integrals for each evaluation.*/
+    std::shared_ptr<const AIFConvolutionEngine> GetAIFConvolutionEngine() const;
+
     void SetStaticParameter(const ParameterNameType& name,
                                     const StaticParameterValuesType& values) override;
 
@@ -102,7 +111,9 @@ namespace mitk
 
 
   private:
-
+    mutable std::shared_ptr<const AIFConvolutionEngine> m_AIFConvolutionEngine;
+    mutable itk::ModifiedTimeType m_AIFConvolutionEngineMTime;
+    mutable std::mutex m_AIFConvolutionEngineMutex;
 
     //No copy constructor allowed
     AIFBasedModelBase(const Self& source);
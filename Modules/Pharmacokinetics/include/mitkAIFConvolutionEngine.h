@@ -0,0 +1,85 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkAIFConvolutionEngine_h
+#define mitkAIFConvolutionEngine_h
+
+#include "mitkModelBase.h"
+
+#include <memory>
+#include <vector>
+
+#include "MitkPharmacokineticsExports.h"
+
+namespace mitk
+{
+  /** \class AIFConvolutionEngine
+   * \brief Convolutes an aterial input function (AIF) with exponential or constant residue functions.
+   *
+   * The AIF is interpolated to the model time grid once. All terms of the convolution that only depend
+   * on the time grid and the AIF (slopes, offsets and the integral of the AIF) are precomputed when the
+   * engine is created. Each convolution then only needs one recursion over the time grid. On a regular
+   * time grid the exponential of the step is computed only once per convolution.
+   * The engine is immutable after construction and can therefore be used by several threads and models
+   * at the same time. Use GetSharedEngine() to reuse engines of identical settings, e.g. for all voxels
+   * of a pixel based fit.
+   * The results are identical to convoluteAIFWithExponential() and convoluteAIFWithConstant() of
+   * mitkConvolutionHelper.h.*/
+  class MITKPHARMACOKINETICS_EXPORT AIFConvolutionEngine
+  {
+  public:
+    typedef ModelBase::TimeGridType TimeGridType;
+    typedef itk::Array<double> AterialInputFunctionType;
+    typedef itk::Array<double> ConvolutionResultType;
+
+    /** Creates the engine for the passed model time grid. If aifTimeGrid is empty, the AIF values are
+     * assumed to be defined on the model time grid, otherwise they are interpolated to it.*/
+    AIFConvolutionEngine(const TimeGridType& timeGrid, const AterialInputFunctionType& aifValues, const TimeGridType& aifTimeGrid);
+
+    /** Returns an engine for the passed settings. Engines of the last used settings are kept in a small
+     * thread-safe cache, so models with identical settings share one engine.*/
+    static std::shared_ptr<const AIFConvolutionEngine> GetSharedEngine(const TimeGridType& timeGrid, const AterialInputFunctionType& aifValues, const TimeGridType& aifTimeGrid);
+
+    /** Removes all engines from the cache used by GetSharedEngine().*/
+    static void ClearSharedEngines();
+
+    /** Checks if the engine was created for the passed settings.*/
+    bool IsCreatedFor(const TimeGridType& timeGrid, const AterialInputFunctionType& aifValues, const TimeGridType& aifTimeGrid) const;
+
+    const TimeGridType& GetTimeGrid() const;
+
+    /** Returns the AIF interpolated to the model time grid.*/
+    const AterialInputFunctionType& GetAterialInputFunction() const;
+
+    /** Convolutes the AIF with the residue function R(t) = exp(-lambda*t).*/
+    ConvolutionResultType ConvoluteWithExponential(double lambda) const;
+
+    /** Convolutes the AIF with a constant residue function.*/
+    ConvolutionResultType ConvoluteWithConstant(double constant) const;
+
+  private:
+    TimeGridType m_TimeGrid;
+    AterialInputFunctionType m_SourceAIFValues;
+    TimeGridType m_SourceAIFTimeGrid;
+    AterialInputFunctionType m_AIF;
+
+    /** Per time step i (between timeGrid(i) and timeGrid(i+1)): step width and slope of the AIF.*/
+    std::vector<double> m_StepWidths;
+    std::vector<double> m_Slopes;
+    /** Integral of the AIF (as used by convoluteAIFWithConstant) up to each time point.*/
+    ConvolutionResultType m_AIFIntegral;
+    /** Step width if all time steps are equal, otherwise 0.*/
+    double m_RegularStepWidth;
+  };
+}
+
+#endif
@@ -105,7 +105,7 @@ inline    itk::Array<double> wrap1d(itk::Array<double> kernel)
 
     }
 
-  inline itk::Array<double> convoluteAIFWithExponential(mitk::ModelBase::TimeGridType timeGrid, mitk::AIFBasedModelBase::AterialInputFunctionType aif, double lambda)
+  inline itk::Array<double> convoluteAIFWithExponential(const mitk::ModelBase::TimeGridType& timeGrid, const mitk::AIFBasedModelBase::AterialInputFunctionType& aif, double lambda)
   {
       /** @brief Iterative Formula to Convolve aif(t) with an exponential Residuefunction R(t) = exp(lambda*t)
        **/
@@ -129,7 +129,7 @@ inline    itk::Array<double> wrap1d(itk::Array<double> kernel)
   }
 
 
-  inline itk::Array<double> convoluteAIFWithConstant(mitk::ModelBase::TimeGridType timeGrid, mitk::AIFBasedModelBase::AterialInputFunctionType aif, double constant)
+  inline itk::Array<double> convoluteAIFWithConstant(const mitk::ModelBase::TimeGridType& timeGrid, const mitk::AIFBasedModelBase::AterialInputFunctionType& aif, double constant)
   {
       /** @brief Iterative Formula to Convolve aif(t) with a constant value by linear interpolation of the Aif between sampling points
        **/
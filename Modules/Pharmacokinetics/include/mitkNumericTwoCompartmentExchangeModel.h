@@ -105,6 +105,10 @@ namespace mitk
 
     ModelResultType ComputeModelfunction(const ParametersType& parameters) const override;
 
+    /** Integrates all parameter sets together in one ODE system, so the AIF is prepared and
+     * interpolated only once for all sets. The results equal the ones of ComputeModelfunction().*/
+    ModelResultBatchType ComputeModelfunctionBatch(const ParametersBatchType& parameterSets) const override;
+
     void SetStaticParameter(const ParameterNameType& name, const StaticParameterValuesType& values) override;
     StaticParameterValuesType GetStaticParameterValue(const ParameterNameType& name) const override;
 
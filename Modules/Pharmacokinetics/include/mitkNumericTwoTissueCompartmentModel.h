@@ -82,6 +82,10 @@ namespace mitk
 
     ModelResultType ComputeModelfunction(const ParametersType& parameters) const override;
 
+    /** Integrates all parameter sets together in one ODE system, so the AIF is prepared and
+     * interpolated only once for all sets. The results equal the ones of ComputeModelfunction().*/
+    ModelResultBatchType ComputeModelfunctionBatch(const ParametersBatchType& parameterSets) const override;
+
     void PrintSelf(std::ostream& os, ::itk::Indent indent) const override;
 
   private:
@@ -15,6 +15,9 @@ found in the LICENSE file.
 
 #include "mitkNumericTwoCompartmentExchangeModel.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace mitk{
 /** @class TwoCompartmentExchangeModelDifferentialEquations
  * @brief Helper Class for NumericTwoCompartmentExchangeModel: Defines the differential equations (Mass Balance Equations) in the 2 Compartment Exchange model.
@@ -34,31 +37,56 @@ public:
     typedef std::vector< double > AIFType;
 
     /** @brief Functor for differential equation of Physiological Pharmacokinetic Brix Model
-     * Takes current state x = x(t) and time t and calculates the corresponding dxdt = dx/dt
+     * Takes current state x = x(t) and time t and calculates the corresponding dxdt = dx/dt.
+     * Several parameter sets can be integrated at once. The state then stores Cp of all
+     * parameter sets followed by Ce of all parameter sets (x = [Cp_0..Cp_n-1, Ce_0..Ce_n-1]),
+     * so that the AIF is only interpolated once per evaluation.
     */
     void operator() (const mitk::NumericTwoCompartmentExchangeModel::state_type &x, mitk::NumericTwoCompartmentExchangeModel::state_type &dxdt, const double t)
     {
-        double Ca_t = InterpolateAIFToCurrentTimeStep(t);
+        const double Ca_t = InterpolateAIFToCurrentTimeStep(t);
+        const std::size_t count = this->F.size();
 
-//        dxdt[0] = -(this->FVP + this->PSVP)*x[0] - this->PSVP*x[1]+this->FVP*Ca_t;
-        dxdt[0] = (1/this->vp) * ( this->F*(Ca_t - x[0]) - this->PS*(x[0] - x[1]) );
-        dxdt[1] = (1/this->ve) * this->PS * (x[0] - x[1]);
+        const double* Cp = x.data();
+        const double* Ce = Cp + count;
+        double* dCp = dxdt.data();
+        double* dCe = dCp + count;
 
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            dCp[i] = this->inverseVp[i] * ( this->F[i]*(Ca_t - Cp[i]) - this->PS[i]*(Cp[i] - Ce[i]) );
+            dCe[i] = this->inverseVe[i] * this->PS[i] * (Cp[i] - Ce[i]);
+        }
     }
 
-    TwoCompartmentExchangeModelDifferentialEquations() : F(0), PS(0), ve(0), vp(0), m_AIF(0), m_AIFTimeGrid(0)
+    TwoCompartmentExchangeModelDifferentialEquations() : m_AIF(0), m_AIFTimeGrid(0)
     {
     }
 
-    /** @brief Initialize class with parameters F/Vp, PS/Vp, fi and fp that are free fit parameters*/
+    /** @brief Initialize class with parameters F/Vp, PS/Vp, fi and fp that are free fit parameters.
+     * Removes all previously added parameter sets.*/
     void initialize(double Fp, double ps, double fi, double fp)
     {
-        this->F = Fp;
-        this->PS = ps;
-        this->ve = fi;
-        this->vp = fp;
+        this->F.clear();
+        this->PS.clear();
+        this->inverseVe.clear();
+        this->inverseVp.clear();
+        this->addParameterSet(Fp, ps, fi, fp);
     }
 
+    /** @brief Adds a further parameter set that is integrated together with the already added ones.*/
+    void addParameterSet(double Fp, double ps, double fi, double fp)
+    {
+        this->F.push_back(Fp);
+        this->PS.push_back(ps);
+        this->inverseVe.push_back(1 / fi);
+        this->inverseVp.push_back(1 / fp);
+    }
+
+    std::size_t getNumberOfParameterSets() const
+    {
+        return this->F.size();
+    }
 
     void setAIF(AIFType &aif)
     {
@@ -73,10 +101,10 @@ public:
 
 private:
 
-    double F;
-    double PS;
-    double ve;
-    double vp;
+    std::vector<double> F;
+    std::vector<double> PS;
+    std::vector<double> inverseVe;
+    std::vector<double> inverseVp;
 
     AIFType m_AIF;
     AIFType m_AIFTimeGrid;
@@ -86,21 +114,24 @@ private:
      * The numerical integration of ODEINT is performed on an adaptive timegrid (adaptive step size dt) different from the time grid of the AIF and model function.
      * Thus, the AIF value Ca(t) has to be interpolated from the set AIF
      */
-    double InterpolateAIFToCurrentTimeStep(double t)
+    double InterpolateAIFToCurrentTimeStep(double t) const
     {
+        //first grid point that is not before t
+        AIFType::const_iterator posITime = std::lower_bound(m_AIFTimeGrid.begin(), m_AIFTimeGrid.end(), t);
+        if (posITime == m_AIFTimeGrid.end())
+        {
+            --posITime;
+        }
+        AIFType::const_iterator posValue = m_AIF.begin() + (posITime - m_AIFTimeGrid.begin());
+
         double lastValue = m_AIF[0];
         double lastTime = std::numeric_limits<double>::min();
-
-        AIFType::const_iterator posITime = m_AIFTimeGrid.begin();
-        AIFType::const_iterator posValue = m_AIF.begin();
-
-        while(t > *posITime)
+        if (posITime != m_AIFTimeGrid.begin())
         {
-            lastValue = *posValue;
-            lastTime = *posITime;
-            ++posValue;
-            ++posITime;
+            lastValue = *(posValue - 1);
+            lastTime = *(posITime - 1);
         }
+
         double weightLast = 1 - (t - lastTime)/(*posITime - lastTime);
         double weightNext = 1- (*posITime - t)/(*posITime - lastTime);
         double result = weightLast * lastValue + weightNext * (*posValue);
@@ -14,6 +14,9 @@ found in the LICENSE file.
 #define MITKTWOTISSUECOMPARTMENTMODELDIFFERENTIALEQUATIONS_H
 #include "mitkNumericTwoTissueCompartmentModel.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace mitk{
 /** @class TwoTissueCompartmentModelDifferentialEquations
  * @brief Helper Class for NumericTwoTissueCompartment Model: Defines the differential equations (Mass Balance Equations) in the
@@ -36,29 +39,56 @@ public:
     typedef std::vector< double > AIFType;
 
     /** @brief Functor for differential equation of Two Tissue Compartment Model
-     * Takes current state x = x(t) and time t and calculates the corresponding dxdt = dx/dt
+     * Takes current state x = x(t) and time t and calculates the corresponding dxdt = dx/dt.
+     * Several parameter sets can be integrated at once. The state then stores C1 of all
+     * parameter sets followed by C2 of all parameter sets (x = [C1_0..C1_n-1, C2_0..C2_n-1]),
+     * so that the AIF is only interpolated once per evaluation.
     */
     void operator() (const mitk::NumericTwoTissueCompartmentModel::state_type &x, mitk::NumericTwoTissueCompartmentModel::state_type &dxdt, const double t)
     {
-        double Ca_t = InterpolateAIFToCurrentTimeStep(t);
+        const double Ca_t = InterpolateAIFToCurrentTimeStep(t);
+        const std::size_t count = this->K1.size();
+
+        const double* C1 = x.data();
+        const double* C2 = C1 + count;
+        double* dC1 = dxdt.data();
+        double* dC2 = dC1 + count;
 
-        dxdt[0] = this->K1*Ca_t-(this->k2+this->k3)*x[0] + this->k4*x[1];
-        dxdt[1] = this->k3*x[0] - this->k4*x[1];
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            dC1[i] = this->K1[i]*Ca_t-(this->k2[i]+this->k3[i])*C1[i] + this->k4[i]*C2[i];
+            dC2[i] = this->k3[i]*C1[i] - this->k4[i]*C2[i];
+        }
     }
 
-    TwoTissueCompartmentModelDifferentialEquations() : K1(0), k2(0), k3(0), k4(0), m_AIF(0), m_AIFTimeGrid(0)
+    TwoTissueCompartmentModelDifferentialEquations() : m_AIF(0), m_AIFTimeGrid(0)
     {
     }
 
-    /** @brief Initialize class with parameters K1, k2, k3 and k4 that are free fit parameters*/
+    /** @brief Initialize class with parameters K1, k2, k3 and k4 that are free fit parameters.
+     * Removes all previously added parameter sets.*/
     void initialize(double k_1, double k_2, double k_3, double k_4)
     {
-        this->K1 = k_1;
-        this->k2 = k_2;
-        this->k3 = k_3;
-        this->k4 = k_4;
+        this->K1.clear();
+        this->k2.clear();
+        this->k3.clear();
+        this->k4.clear();
+        this->addParameterSet(k_1, k_2, k_3, k_4);
     }
 
+    /** @brief Adds a further parameter set that is integrated together with the already added ones.*/
+    void addParameterSet(double k_1, double k_2, double k_3, double k_4)
+    {
+        this->K1.push_back(k_1);
+        this->k2.push_back(k_2);
+        this->k3.push_back(k_3);
+        this->k4.push_back(k_4);
+    }
+
+    std::size_t getNumberOfParameterSets() const
+    {
+        return this->K1.size();
+    }
 
     void setAIF(AIFType &aif)
     {
@@ -73,10 +103,10 @@ public:
 
 private:
 
-    double K1;
-    double k2;
-    double k3;
-    double k4;
+    std::vector<double> K1;
+    std::vector<double> k2;
+    std::vector<double> k3;
+    std::vector<double> k4;
 
     AIFType m_AIF;
     AIFType m_AIFTimeGrid;
@@ -86,21 +116,24 @@ private:
      * The numerical integration of ODEINT is performed on an adaptive timegrid (adaptive step size dt) different from the time grid of the AIF and model function.
      * Thus, the AIF value Ca(t) has to be interpolated from the set AIF
      */
-    double InterpolateAIFToCurrentTimeStep(double t)
+    double InterpolateAIFToCurrentTimeStep(double t) const
     {
+        //first grid point that is not before t
+        AIFType::const_iterator posITime = std::lower_bound(m_AIFTimeGrid.begin(), m_AIFTimeGrid.end(), t);
+        if (posITime == m_AIFTimeGrid.end())
+        {
+            --posITime;
+        }
+        AIFType::const_iterator posValue = m_AIF.begin() + (posITime - m_AIFTimeGrid.begin());
+
         double lastValue = m_AIF[0];
         double lastTime = std::numeric_limits<double>::min();
-
-        AIFType::const_iterator posITime = m_AIFTimeGrid.begin();
-        AIFType::const_iterator posValue = m_AIF.begin();
-
-        while(t > *posITime)
+        if (posITime != m_AIFTimeGrid.begin())
         {
-            lastValue = *posValue;
-            lastTime = *posITime;
-            ++posValue;
-            ++posITime;
+            lastValue = *(posValue - 1);
+            lastTime = *(posITime - 1);
         }
+
         double weightLast = 1 - (t - lastTime)/(*posITime - lastTime);
         double weightNext = 1- (*posITime - t)/(*posITime - lastTime);
         double result = weightLast * lastValue + weightNext * (*posValue);
@@ -0,0 +1,148 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkAIFConvolutionEngine.h"
+#include "mitkTimeGridHelper.h"
+
+#include <cmath>
+#include <deque>
+#include <mutex>
+
+namespace
+{
+  /** Number of engines kept by GetSharedEngine(). One fit session usually uses one setting.*/
+  const std::size_t MaximumNumberOfSharedEngines = 8;
+
+  std::mutex sharedEnginesMutex;
+  std::deque<std::shared_ptr<const mitk::AIFConvolutionEngine>> sharedEngines;
+}
+
+mitk::AIFConvolutionEngine::AIFConvolutionEngine(const TimeGridType& timeGrid, const AterialInputFunctionType& aifValues, const TimeGridType& aifTimeGrid)
+  : m_TimeGrid(timeGrid), m_SourceAIFValues(aifValues), m_SourceAIFTimeGrid(aifTimeGrid), m_RegularStepWidth(0.0)
+{
+  if (aifTimeGrid.empty())
+  {
+    m_AIF = aifValues;
+  }
+  else
+  {
+    m_AIF = mitk::InterpolateSignalToNewTimeGrid(aifValues, aifTimeGrid, timeGrid);
+  }
+
+  const unsigned int timeSteps = m_TimeGrid.GetSize();
+  m_AIFIntegral.SetSize(timeSteps);
+  m_AIFIntegral.fill(0.0);
+
+  if (timeSteps < 2)
+  {
+    return;
+  }
+
+  m_StepWidths.resize(timeSteps - 1);
+  m_Slopes.resize(timeSteps - 1);
+  m_RegularStepWidth = m_TimeGrid(1) - m_TimeGrid(0);
+
+  for (unsigned int i = 0; i < timeSteps - 1; ++i)
+  {
+    const double dt = m_TimeGrid(i + 1) - m_TimeGrid(i);
+    const double m = (m_AIF(i + 1) - m_AIF(i)) / dt;
+    m_StepWidths[i] = dt;
+    m_Slopes[i] = m;
+
+    if (dt != m_RegularStepWidth)
+    {
+      m_RegularStepWidth = 0.0;
+    }
+
+    m_AIFIntegral(i + 1) = m_AIFIntegral(i) + (m_AIF(i)*dt + m*m_TimeGrid(i)*dt + m / 2 * (m_TimeGrid(i + 1)*m_TimeGrid(i + 1) - m_TimeGrid(i)*m_TimeGrid(i)));
+  }
+}
+
+std::shared_ptr<const mitk::AIFConvolutionEngine> mitk::AIFConvolutionEngine::GetSharedEngine(const TimeGridType& timeGrid, const AterialInputFunctionType& aifValues, const TimeGridType& aifTimeGrid)
+{
+  {
+    std::lock_guard<std::mutex> lock(sharedEnginesMutex);
+    for (const auto& engine : sharedEngines)
+    {
+      if (engine->IsCreatedFor(timeGrid, aifValues, aifTimeGrid))
+      {
+        return engine;
+      }
+    }
+  }
+
+  // Create the engine without holding the lock; if another thread was faster, both engines are equal.
+  auto engine = std::make_shared<const AIFConvolutionEngine>(timeGrid, aifValues, aifTimeGrid);
+
+  std::lock_guard<std::mutex> lock(sharedEnginesMutex);
+  sharedEngines.push_front(engine);
+  if (sharedEngines.size() > MaximumNumberOfSharedEngines)
+  {
+    sharedEngines.pop_back();
+  }
+  return engine;
+}
+
+void mitk::AIFConvolutionEngine::ClearSharedEngines()
+{
+  std::lock_guard<std::mutex> lock(sharedEnginesMutex);
+  sharedEngines.clear();
+}
+
+bool mitk::AIFConvolutionEngine::IsCreatedFor(const TimeGridType& timeGrid, const AterialInputFunctionType& aifValues, const TimeGridType& aifTimeGrid) const
+{
+  return m_TimeGrid == timeGrid && m_SourceAIFValues == aifValues && m_SourceAIFTimeGrid == aifTimeGrid;
+}
+
+const mitk::AIFConvolutionEngine::TimeGridType& mitk::AIFConvolutionEngine::GetTimeGrid() const
+{
+  return m_TimeGrid;
+}
+
+const mitk::AIFConvolutionEngine::AterialInputFunctionType& mitk::AIFConvolutionEngine::GetAterialInputFunction() const
+{
+  return m_AIF;
+}
+
+mitk::AIFConvolutionEngine::ConvolutionResultType mitk::AIFConvolutionEngine::ConvoluteWithExponential(double lambda) const
+{
+  const unsigned int timeSteps = m_TimeGrid.GetSize();
+  ConvolutionResultType convolution(timeSteps);
+  convolution.fill(0.0);
+
+  const double regularEdt = exp(-lambda * m_RegularStepWidth);
+  const bool isRegular = m_RegularStepWidth != 0.0;
+  const double lambdaSquare = lambda * lambda;
+
+  for (unsigned int i = 0; i + 1 < timeSteps; ++i)
+  {
+    const double t0 = m_TimeGrid(i);
+    const double t1 = m_TimeGrid(i + 1);
+    const double m = m_Slopes[i];
+    const double edt = isRegular ? regularEdt : exp(-lambda * m_StepWidths[i]);
+
+    convolution(i + 1) = edt * convolution(i)
+                         + (m_AIF(i) - m*t0) / lambda * (1 - edt)
+                         + m / lambdaSquare * ((lambda * t1 - 1) - edt*(lambda*t0 - 1));
+  }
+  return convolution;
+}
+
+mitk::AIFConvolutionEngine::ConvolutionResultType mitk::AIFConvolutionEngine::ConvoluteWithConstant(double constant) const
+{
+  ConvolutionResultType convolution(m_AIFIntegral.GetSize());
+  for (unsigned int i = 0; i < m_AIFIntegral.GetSize(); ++i)
+  {
+    convolution(i) = constant * m_AIFIntegral(i);
+  }
+  return convolution;
+}
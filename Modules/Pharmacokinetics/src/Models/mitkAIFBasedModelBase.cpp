@@ -46,7 +46,7 @@ std::string mitk::AIFBasedModelBase::GetYAxisUnit() const
   return "";
 }
 
-mitk::AIFBasedModelBase::AIFBasedModelBase()
+mitk::AIFBasedModelBase::AIFBasedModelBase() : m_AIFConvolutionEngineMTime(0)
 {
 }
 
@@ -81,6 +81,21 @@ mitk::AIFBasedModelBase::GetAterialInputFunction(TimeGridType CurrentTimeGrid) c
   }
 }
 
+std::shared_ptr<const mitk::AIFConvolutionEngine>
+mitk::AIFBasedModelBase::GetAIFConvolutionEngine() const
+{
+  std::lock_guard<std::mutex> lock(m_AIFConvolutionEngineMutex);
+
+  if (!m_AIFConvolutionEngine || m_AIFConvolutionEngineMTime != this->GetMTime())
+  {
+    m_AIFConvolutionEngine = AIFConvolutionEngine::GetSharedEngine(this->m_TimeGrid,
+      m_AterialInputFunctionValues, m_AterialInputFunctionTimeGrid);
+    m_AIFConvolutionEngineMTime = this->GetMTime();
+  }
+
+  return m_AIFConvolutionEngine;
+}
+
 mitk::AIFBasedModelBase::ParameterNamesType mitk::AIFBasedModelBase::GetStaticParameterNames() const
 {
   ParameterNamesType result;
@@ -11,7 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkExtendedOneTissueCompartmentModel.h"
-#include "mitkConvolutionHelper.h"
+#include "mitkAIFConvolutionEngine.h"
 #include <vnl/algo/vnl_fft_1d.h>
 #include <fstream>
 
@@ -88,8 +88,8 @@ mitk::ExtendedOneTissueCompartmentModel::ModelResultType mitk::ExtendedOneTissue
     itkExceptionMacro("No Time Grid Set! Cannot Calculate Signal");
   }
 
-  AterialInputFunctionType aterialInputFunction;
-  aterialInputFunction = GetAterialInputFunction(this->m_TimeGrid);
+  auto convolutionEngine = this->GetAIFConvolutionEngine();
+  const AterialInputFunctionType& aterialInputFunction = convolutionEngine->GetAterialInputFunction();
 
 
 
@@ -102,8 +102,7 @@ mitk::ExtendedOneTissueCompartmentModel::ModelResultType mitk::ExtendedOneTissue
 
 
 
-  mitk::ModelBase::ModelResultType convolution = mitk::convoluteAIFWithExponential(this->m_TimeGrid,
-      aterialInputFunction, k2);
+  mitk::ModelBase::ModelResultType convolution = convolutionEngine->ConvoluteWithExponential(k2);
 
   //Signal that will be returned by ComputeModelFunction
   mitk::ModelBase::ModelResultType signal(timeSteps);
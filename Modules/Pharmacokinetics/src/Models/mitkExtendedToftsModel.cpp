@@ -11,7 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkExtendedToftsModel.h"
-#include "mitkConvolutionHelper.h"
+#include "mitkAIFConvolutionEngine.h"
 #include <vnl/algo/vnl_fft_1d.h>
 #include <fstream>
 
@@ -113,8 +113,8 @@ mitk::ExtendedToftsModel::ModelResultType mitk::ExtendedToftsModel::ComputeModel
     itkExceptionMacro("No Time Grid Set! Cannot Calculate Signal");
   }
 
-  AterialInputFunctionType aterialInputFunction;
-  aterialInputFunction = GetAterialInputFunction(this->m_TimeGrid);
+  auto convolutionEngine = this->GetAIFConvolutionEngine();
+  const AterialInputFunctionType& aterialInputFunction = convolutionEngine->GetAterialInputFunction();
 
 
 
@@ -133,8 +133,7 @@ mitk::ExtendedToftsModel::ModelResultType mitk::ExtendedToftsModel::ComputeModel
 
   double lambda =  ktrans / ve;
 
-  mitk::ModelBase::ModelResultType convolution = mitk::convoluteAIFWithExponential(this->m_TimeGrid,
-      aterialInputFunction, lambda);
+  mitk::ModelBase::ModelResultType convolution = convolutionEngine->ConvoluteWithExponential(lambda);
 
   //Signal that will be returned by ComputeModelFunction
   mitk::ModelBase::ModelResultType signal(timeSteps);
@@ -144,7 +143,7 @@ mitk::ExtendedToftsModel::ModelResultType mitk::ExtendedToftsModel::ComputeModel
   mitk::ModelBase::ModelResultType::const_iterator res = convolution.begin();
 
 
-  for (AterialInputFunctionType::iterator Cp = aterialInputFunction.begin();
+  for (AterialInputFunctionType::const_iterator Cp = aterialInputFunction.begin();
        Cp != aterialInputFunction.end(); ++res, ++signalPos, ++Cp)
   {
     *signalPos = (*Cp) * vp + ktrans * (*res);
@@ -162,6 +162,13 @@ mitk::NumericTwoCompartmentExchangeModel::GetParameterUnits() const
 mitk::NumericTwoCompartmentExchangeModel::ModelResultType
 mitk::NumericTwoCompartmentExchangeModel::ComputeModelfunction(const ParametersType& parameters)
 const
+{
+  return this->ComputeModelfunctionBatch(ParametersBatchType(1, parameters)).front();
+}
+
+mitk::NumericTwoCompartmentExchangeModel::ModelResultBatchType
+mitk::NumericTwoCompartmentExchangeModel::ComputeModelfunctionBatch(const ParametersBatchType& parameterSets)
+const
 {
   typedef itk::Array<double> ConcentrationCurveType;
   typedef std::vector<double> ConcentrationVectorType;
@@ -188,30 +195,32 @@ const
   mitk::TwoCompartmentExchangeModelDifferentialEquations::AIFType gridODE = grid;
   gridODE.push_back(grid[timeSteps - 1] + (grid[timeSteps - 1] - grid[timeSteps - 2]));
 
-
-
-  //Model Parameters
-  double F = (double) parameters[POSITION_PARAMETER_F] / 6000.0;
-  double PS  = (double) parameters[POSITION_PARAMETER_PS] / 6000.0;
-  double ve = (double) parameters[POSITION_PARAMETER_ve];
-  double vp = (double) parameters[POSITION_PARAMETER_vp];
-
-
-  /** @brief Initialize class TwoCompartmentExchangeModelDifferentialEquations defining the differential equations. AIF and Grid must be set so that at step t the aterial Concentration Ca(t) can be interpolated from AIF*/
+  /** @brief Initialize class TwoCompartmentExchangeModelDifferentialEquations defining the differential equations. AIF and Grid must be set so that at step t the aterial Concentration Ca(t) can be interpolated from AIF.
+   * All parameter sets are integrated together, so the AIF is interpolated only once per evaluation of the equations.*/
   mitk::TwoCompartmentExchangeModelDifferentialEquations ode;
-  ode.initialize(F, PS, ve, vp);
   ode.setAIF(aifODE);
   ode.setAIFTimeGrid(gridODE);
 
-  state_type x(2);
-  x[0] = 0.0;
-  x[1] = 0.0;
+  const std::size_t setCount = parameterSets.size();
+  for (const auto& parameters : parameterSets)
+  {
+    //Model Parameters
+    double F = (double) parameters[POSITION_PARAMETER_F] / 6000.0;
+    double PS  = (double) parameters[POSITION_PARAMETER_PS] / 6000.0;
+    double ve = (double) parameters[POSITION_PARAMETER_ve];
+    double vp = (double) parameters[POSITION_PARAMETER_vp];
+
+    ode.addParameterSet(F, PS, ve, vp);
+  }
+
+  /** @brief State of all parameter sets: Cp of all sets followed by Ce of all sets*/
+  state_type x(2 * setCount, 0.0);
   typedef boost::numeric::odeint::runge_kutta_cash_karp54<state_type> error_stepper_type;
   //typedef boost::numeric::odeint::runge_kutta4< state_type > stepper_type;
 
-  /** @brief Results of odeeint x[0] and x[1]*/
-  ConcentrationVectorType Cp;
-  ConcentrationVectorType Ce;
+  /** @brief Results of odeeint x[0] and x[1] for every parameter set*/
+  std::vector<ConcentrationVectorType> Cp(setCount);
+  std::vector<ConcentrationVectorType> Ce(setCount);
   ConcentrationVectorType odeTimeGrid;
 
   error_stepper_type stepper;
@@ -226,40 +235,49 @@ const
   for (double t = 0.0; t < this->m_TimeGrid(this->m_TimeGrid.GetSize() - 1) - 2*dt; t += dt)
   {
     stepper.do_step(ode, x, t, dt);
-    Cp.push_back(x[0]);
-    Ce.push_back(x[1]);
+    for (std::size_t i = 0; i < setCount; ++i)
+    {
+      Cp[i].push_back(x[i]);
+      Ce[i].push_back(x[setCount + i]);
+    }
     odeTimeGrid.push_back(t);
   }
 
-  /** @brief transfom result of Differential equations back to itk::Array and interpolate to m_TimeGrid (they are calculated on a different grid defined by stepsize of odeint)*/
-  ConcentrationCurveType plasmaConcentration = mitk::convertParameterToArray(Cp);
-  ConcentrationCurveType EESConcentration = mitk::convertParameterToArray(Ce);
   ConcentrationCurveType rungeKuttaTimeGrid = mitk::convertParameterToArray(odeTimeGrid);
 
-  mitk::ModelBase::ModelResultType C_Plasma = mitk::InterpolateSignalToNewTimeGrid(plasmaConcentration, rungeKuttaTimeGrid, m_TimeGrid);
-  mitk::ModelBase::ModelResultType C_EES = mitk::InterpolateSignalToNewTimeGrid(EESConcentration, rungeKuttaTimeGrid, m_TimeGrid);
+  ModelResultBatchType signals;
+  signals.reserve(setCount);
 
+  for (std::size_t i = 0; i < setCount; ++i)
+  {
+    double ve = (double) parameterSets[i][POSITION_PARAMETER_ve];
+    double vp = (double) parameterSets[i][POSITION_PARAMETER_vp];
 
-  //Signal that will be returned by ComputeModelFunction
-  mitk::ModelBase::ModelResultType signal(timeSteps);
-  signal.fill(0.0);
+    /** @brief transfom result of Differential equations back to itk::Array and interpolate to m_TimeGrid (they are calculated on a different grid defined by stepsize of odeint)*/
+    ConcentrationCurveType plasmaConcentration = mitk::convertParameterToArray(Cp[i]);
+    ConcentrationCurveType EESConcentration = mitk::convertParameterToArray(Ce[i]);
 
-  mitk::ModelBase::ModelResultType::iterator signalPos = signal.begin();
-  mitk::ModelBase::ModelResultType::const_iterator CePos = C_EES.begin();
+    mitk::ModelBase::ModelResultType C_Plasma = mitk::InterpolateSignalToNewTimeGrid(plasmaConcentration, rungeKuttaTimeGrid, m_TimeGrid);
+    mitk::ModelBase::ModelResultType C_EES = mitk::InterpolateSignalToNewTimeGrid(EESConcentration, rungeKuttaTimeGrid, m_TimeGrid);
 
-  mitk::ModelBase::ModelResultType::const_iterator t = this->m_TimeGrid.begin();
-  mitk::ModelBase::ModelResultType::const_iterator Cin = aterialInputFunction.begin();
 
+    //Signal that will be returned by ComputeModelFunction
+    mitk::ModelBase::ModelResultType signal(timeSteps);
+    signal.fill(0.0);
 
+    mitk::ModelBase::ModelResultType::iterator signalPos = signal.begin();
+    mitk::ModelBase::ModelResultType::const_iterator CePos = C_EES.begin();
 
-  for (mitk::ModelBase::ModelResultType::const_iterator CpPos = C_Plasma.begin();
-       CpPos != C_Plasma.end(); ++CpPos, ++CePos, ++signalPos, ++t, ++Cin)
-  {
-    *signalPos = vp * (*CpPos) + ve * (*CePos);
+    for (mitk::ModelBase::ModelResultType::const_iterator CpPos = C_Plasma.begin();
+         CpPos != C_Plasma.end(); ++CpPos, ++CePos, ++signalPos)
+    {
+      *signalPos = vp * (*CpPos) + ve * (*CePos);
+    }
 
+    signals.push_back(signal);
   }
 
-  return signal;
+  return signals;
 
 }
 
@@ -99,6 +99,12 @@ mitk::NumericTwoTissueCompartmentModel::GetParameterUnits() const
 
 mitk::NumericTwoTissueCompartmentModel::ModelResultType
 mitk::NumericTwoTissueCompartmentModel::ComputeModelfunction(const ParametersType& parameters) const
+{
+  return this->ComputeModelfunctionBatch(ParametersBatchType(1, parameters)).front();
+}
+
+mitk::NumericTwoTissueCompartmentModel::ModelResultBatchType
+mitk::NumericTwoTissueCompartmentModel::ComputeModelfunctionBatch(const ParametersBatchType& parameterSets) const
 {
   typedef itk::Array<double> ConcentrationCurveType;
   typedef std::vector<double> ConcentrationVectorType;
@@ -125,29 +131,32 @@ mitk::NumericTwoTissueCompartmentModel::ComputeModelfunction(const ParametersTyp
   mitk::TwoTissueCompartmentModelDifferentialEquations::AIFType gridODE = grid;
   gridODE.push_back(grid[timeSteps - 1] + (grid[timeSteps - 1] - grid[timeSteps - 2]));
 
-  //Model Parameters
-  double K1 = (double)parameters[POSITION_PARAMETER_K1] / 60.0;
-  double k2 = (double)parameters[POSITION_PARAMETER_k2] / 60.0;
-  double k3 = (double)parameters[POSITION_PARAMETER_k3] / 60.0;
-  double k4 = (double)parameters[POSITION_PARAMETER_k4] / 60.0;
-  double VB = parameters[POSITION_PARAMETER_VB];
-
-
-  /** @brief Initialize class TwpTissueCompartmentModelDifferentialEquations defining the differential equations. AIF and Grid must be set so that at step t the aterial Concentration Ca(t) can be interpolated from AIF*/
+  /** @brief Initialize class TwpTissueCompartmentModelDifferentialEquations defining the differential equations. AIF and Grid must be set so that at step t the aterial Concentration Ca(t) can be interpolated from AIF.
+   * All parameter sets are integrated together, so the AIF is interpolated only once per evaluation of the equations.*/
   mitk::TwoTissueCompartmentModelDifferentialEquations ode;
-  ode.initialize(K1, k2, k3, k4);
   ode.setAIF(aifODE);
   ode.setAIFTimeGrid(gridODE);
 
-  state_type x(2);
-  x[0] = 0.0;
-  x[1] = 0.0;
+  const std::size_t setCount = parameterSets.size();
+  for (const auto& parameters : parameterSets)
+  {
+    //Model Parameters
+    double K1 = (double)parameters[POSITION_PARAMETER_K1] / 60.0;
+    double k2 = (double)parameters[POSITION_PARAMETER_k2] / 60.0;
+    double k3 = (double)parameters[POSITION_PARAMETER_k3] / 60.0;
+    double k4 = (double)parameters[POSITION_PARAMETER_k4] / 60.0;
+
+    ode.addParameterSet(K1, k2, k3, k4);
+  }
+
+  /** @brief State of all parameter sets: C1 of all sets followed by C2 of all sets*/
+  state_type x(2 * setCount, 0.0);
   typedef boost::numeric::odeint::runge_kutta_cash_karp54<state_type> error_stepper_type;
   //typedef boost::numeric::odeint::runge_kutta4< state_type > stepper_type;
 
-  /** @brief Results of odeeint x[0] and x[1]*/
-  ConcentrationVectorType C1;
-  ConcentrationVectorType C2;
+  /** @brief Results of odeeint x[0] and x[1] for every parameter set*/
+  std::vector<ConcentrationVectorType> C1(setCount);
+  std::vector<ConcentrationVectorType> C2(setCount);
   ConcentrationVectorType odeTimeGrid;
 
   error_stepper_type stepper;
@@ -160,38 +169,52 @@ mitk::NumericTwoTissueCompartmentModel::ComputeModelfunction(const ParametersTyp
   for (double t = 0.0; t < T; t += dt)
   {
     stepper.do_step(ode, x, t, dt);
-    C1.push_back(x[0]);
-    C2.push_back(x[1]);
+    for (std::size_t i = 0; i < setCount; ++i)
+    {
+      C1[i].push_back(x[i]);
+      C2[i].push_back(x[setCount + i]);
+    }
     odeTimeGrid.push_back(t);
 
   }
 
-  /** @brief transfom result of Differential equations back to itk::Array and interpolate to m_TimeGrid (they are calculated on a different grid defined by stepsize of odeint)*/
-  ConcentrationCurveType ConcentrationCompartment1 = mitk::convertParameterToArray(C1);
-  ConcentrationCurveType ConcentrationCompartment2 = mitk::convertParameterToArray(C2);
   ConcentrationCurveType rungeKuttaTimeGrid = mitk::convertParameterToArray(odeTimeGrid);
 
-  mitk::ModelBase::ModelResultType C_1 = mitk::InterpolateSignalToNewTimeGrid(
-      ConcentrationCompartment1, rungeKuttaTimeGrid, m_TimeGrid);
-  mitk::ModelBase::ModelResultType C_2 = mitk::InterpolateSignalToNewTimeGrid(
-      ConcentrationCompartment2, rungeKuttaTimeGrid, m_TimeGrid);
+  ModelResultBatchType signals;
+  signals.reserve(setCount);
+
+  for (std::size_t i = 0; i < setCount; ++i)
+  {
+    double VB = parameterSets[i][POSITION_PARAMETER_VB];
 
+    /** @brief transfom result of Differential equations back to itk::Array and interpolate to m_TimeGrid (they are calculated on a different grid defined by stepsize of odeint)*/
+    ConcentrationCurveType ConcentrationCompartment1 = mitk::convertParameterToArray(C1[i]);
+    ConcentrationCurveType ConcentrationCompartment2 = mitk::convertParameterToArray(C2[i]);
 
-  //Signal that will be returned by ComputeModelFunction
-  mitk::ModelBase::ModelResultType signal(timeSteps);
-  signal.fill(0.0);
-  mitk::ModelBase::ModelResultType::iterator signalPos = signal.begin();
-  mitk::ModelBase::ModelResultType::const_iterator C1Pos = C_1.begin();
-  mitk::ModelBase::ModelResultType::const_iterator C2Pos = C_2.begin();
+    mitk::ModelBase::ModelResultType C_1 = mitk::InterpolateSignalToNewTimeGrid(
+        ConcentrationCompartment1, rungeKuttaTimeGrid, m_TimeGrid);
+    mitk::ModelBase::ModelResultType C_2 = mitk::InterpolateSignalToNewTimeGrid(
+        ConcentrationCompartment2, rungeKuttaTimeGrid, m_TimeGrid);
 
 
-  for (AterialInputFunctionType::const_iterator aifpos = aterialInputFunction.begin();
-       aifpos != aterialInputFunction.end(); ++aifpos, ++C1Pos, ++C2Pos, ++signalPos)
-  {
-    *signalPos = VB * (*aifpos) + (1 - VB) * (*C1Pos + *C2Pos);
+    //Signal that will be returned by ComputeModelFunction
+    mitk::ModelBase::ModelResultType signal(timeSteps);
+    signal.fill(0.0);
+    mitk::ModelBase::ModelResultType::iterator signalPos = signal.begin();
+    mitk::ModelBase::ModelResultType::const_iterator C1Pos = C_1.begin();
+    mitk::ModelBase::ModelResultType::const_iterator C2Pos = C_2.begin();
+
+
+    for (AterialInputFunctionType::const_iterator aifpos = aterialInputFunction.begin();
+         aifpos != aterialInputFunction.end(); ++aifpos, ++C1Pos, ++C2Pos, ++signalPos)
+    {
+      *signalPos = VB * (*aifpos) + (1 - VB) * (*C1Pos + *C2Pos);
+    }
+
+    signals.push_back(signal);
   }
 
-  return signal;
+  return signals;
 
 }
 
@@ -11,7 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkOneTissueCompartmentModel.h"
-#include "mitkConvolutionHelper.h"
+#include "mitkAIFConvolutionEngine.h"
 #include <vnl/algo/vnl_fft_1d.h>
 #include <fstream>
 
@@ -84,8 +84,7 @@ mitk::OneTissueCompartmentModel::ModelResultType mitk::OneTissueCompartmentModel
     itkExceptionMacro("No Time Grid Set! Cannot Calculate Signal");
   }
 
-  AterialInputFunctionType aterialInputFunction;
-  aterialInputFunction = GetAterialInputFunction(this->m_TimeGrid);
+  auto convolutionEngine = this->GetAIFConvolutionEngine();
 
 
 
@@ -97,8 +96,7 @@ mitk::OneTissueCompartmentModel::ModelResultType mitk::OneTissueCompartmentModel
 
 
 
-  mitk::ModelBase::ModelResultType convolution = mitk::convoluteAIFWithExponential(this->m_TimeGrid,
-      aterialInputFunction, k2);
+  mitk::ModelBase::ModelResultType convolution = convolutionEngine->ConvoluteWithExponential(k2);
 
   //Signal that will be returned by ComputeModelFunction
   mitk::ModelBase::ModelResultType signal(timeSteps);
@@ -11,7 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkTwoTissueCompartmentFDGModel.h"
-#include "mitkConvolutionHelper.h"
+#include "mitkAIFConvolutionEngine.h"
 #include <fstream>
 const std::string mitk::TwoTissueCompartmentFDGModel::MODEL_DISPLAY_NAME = "Two Tissue Compartment Model for FDG (Sokoloff Model)";
 
@@ -92,8 +92,8 @@ mitk::TwoTissueCompartmentFDGModel::ComputeModelfunction(const ParametersType& p
     itkExceptionMacro("No Time Grid Set! Cannot Calculate Signal");
   }
 
-  AterialInputFunctionType aterialInputFunction;
-  aterialInputFunction = GetAterialInputFunction(this->m_TimeGrid);
+  auto convolutionEngine = this->GetAIFConvolutionEngine();
+  const AterialInputFunctionType& aterialInputFunction = convolutionEngine->GetAterialInputFunction();
 
 
   unsigned int timeSteps = this->m_TimeGrid.GetSize();
@@ -109,9 +109,8 @@ mitk::TwoTissueCompartmentFDGModel::ComputeModelfunction(const ParametersType& p
 
   double lambda = k2+k3;
   //double lambda2 = -alpha2;
-  mitk::ModelBase::ModelResultType exp = mitk::convoluteAIFWithExponential(this->m_TimeGrid,
-                                          aterialInputFunction, lambda);
-  mitk::ModelBase::ModelResultType CA = mitk::convoluteAIFWithConstant(this->m_TimeGrid, aterialInputFunction, k3);
+  mitk::ModelBase::ModelResultType exp = convolutionEngine->ConvoluteWithExponential(lambda);
+  mitk::ModelBase::ModelResultType CA = convolutionEngine->ConvoluteWithConstant(k3);
 
 
   //Signal that will be returned by ComputeModelFunction
@@ -11,7 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkTwoTissueCompartmentModel.h"
-#include "mitkConvolutionHelper.h"
+#include "mitkAIFConvolutionEngine.h"
 #include <fstream>
 const std::string mitk::TwoTissueCompartmentModel::MODEL_DISPLAY_NAME = "Two Tissue Compartment Model";
 
@@ -103,8 +103,8 @@ mitk::TwoTissueCompartmentModel::ComputeModelfunction(const ParametersType& para
     itkExceptionMacro("No Time Grid Set! Cannot Calculate Signal");
   }
 
-  AterialInputFunctionType aterialInputFunction;
-  aterialInputFunction = GetAterialInputFunction(this->m_TimeGrid);
+  auto convolutionEngine = this->GetAIFConvolutionEngine();
+  const AterialInputFunctionType& aterialInputFunction = convolutionEngine->GetAterialInputFunction();
 
 
   unsigned int timeSteps = this->m_TimeGrid.GetSize();
@@ -123,10 +123,8 @@ mitk::TwoTissueCompartmentModel::ComputeModelfunction(const ParametersType& para
 
   //double lambda1 = -alpha1;
   //double lambda2 = -alpha2;
-  mitk::ModelBase::ModelResultType exp1 = mitk::convoluteAIFWithExponential(this->m_TimeGrid,
-                                          aterialInputFunction, alpha1);
-  mitk::ModelBase::ModelResultType exp2 = mitk::convoluteAIFWithExponential(this->m_TimeGrid,
-                                          aterialInputFunction, alpha2);
+  mitk::ModelBase::ModelResultType exp1 = convolutionEngine->ConvoluteWithExponential(alpha1);
+  mitk::ModelBase::ModelResultType exp2 = convolutionEngine->ConvoluteWithExponential(alpha2);
 
 
   //Signal that will be returned by ComputeModelFunction
@@ -0,0 +1,129 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+//MITK includes
+#include "mitkAIFConvolutionEngine.h"
+#include "mitkConvolutionHelper.h"
+#include "mitkTimeGridHelper.h"
+
+class mitkAIFConvolutionEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkAIFConvolutionEngineTestSuite);
+  MITK_TEST(RegularTimeGridTest);
+  MITK_TEST(IrregularTimeGridTest);
+  MITK_TEST(InterpolatedAIFTest);
+  MITK_TEST(SharedEngineTest);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::ModelBase::TimeGridType m_grid;
+  mitk::AIFConvolutionEngine::AterialInputFunctionType m_aif;
+
+  mitk::AIFConvolutionEngine::AterialInputFunctionType GenerateAIF(const mitk::ModelBase::TimeGridType& grid) const
+  {
+    mitk::AIFConvolutionEngine::AterialInputFunctionType aif(grid.GetSize());
+    for (unsigned int i = 0; i < grid.GetSize(); ++i)
+    {
+      aif[i] = grid[i] < 50 ? 0 : 3.99 * exp(-0.144 * grid[i]) + 4.78 * exp(-0.0111 * grid[i]);
+    }
+    return aif;
+  }
+
+  void CheckEngine(const mitk::AIFConvolutionEngine& engine, const mitk::ModelBase::TimeGridType& grid, const mitk::AIFConvolutionEngine::AterialInputFunctionType& aif)
+  {
+    for (double lambda : { 0.001, 0.01, 0.5 })
+    {
+      auto reference = mitk::convoluteAIFWithExponential(grid, aif, lambda);
+      auto result = engine.ConvoluteWithExponential(lambda);
+      CPPUNIT_ASSERT_EQUAL(reference.GetSize(), result.GetSize());
+      for (unsigned int i = 0; i < reference.GetSize(); ++i)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Exponential convolution equals convoluteAIFWithExponential.", reference[i], result[i], 1e-10);
+      }
+    }
+
+    auto reference = mitk::convoluteAIFWithConstant(grid, aif, 0.3);
+    auto result = engine.ConvoluteWithConstant(0.3);
+    for (unsigned int i = 0; i < reference.GetSize(); ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Constant convolution equals convoluteAIFWithConstant.", reference[i], result[i], 1e-10);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_grid.SetSize(22);
+    for (int i = 0; i < 22; ++i)
+    {
+      m_grid[i] = 14.0 * i;
+    }
+    m_aif = GenerateAIF(m_grid);
+  }
+
+  void tearDown() override
+  {
+    mitk::AIFConvolutionEngine::ClearSharedEngines();
+  }
+
+  void RegularTimeGridTest()
+  {
+    mitk::AIFConvolutionEngine engine(m_grid, m_aif, mitk::ModelBase::TimeGridType());
+    CPPUNIT_ASSERT(engine.GetAterialInputFunction() == m_aif);
+    CheckEngine(engine, m_grid, m_aif);
+  }
+
+  void IrregularTimeGridTest()
+  {
+    mitk::ModelBase::TimeGridType grid(22);
+    for (int i = 0; i < 22; ++i)
+    {
+      grid[i] = 0.5 * i * i + 2 * i;
+    }
+    auto aif = GenerateAIF(grid);
+
+    mitk::AIFConvolutionEngine engine(grid, aif, mitk::ModelBase::TimeGridType());
+    CheckEngine(engine, grid, aif);
+  }
+
+  void InterpolatedAIFTest()
+  {
+    auto modelGrid = mitk::GenerateSupersampledTimeGrid(m_grid, 3);
+    auto interpolatedAIF = mitk::InterpolateSignalToNewTimeGrid(m_aif, m_grid, modelGrid);
+
+    mitk::AIFConvolutionEngine engine(modelGrid, m_aif, m_grid);
+    CPPUNIT_ASSERT(engine.GetAterialInputFunction() == interpolatedAIF);
+    CheckEngine(engine, modelGrid, interpolatedAIF);
+  }
+
+  void SharedEngineTest()
+  {
+    auto engine = mitk::AIFConvolutionEngine::GetSharedEngine(m_grid, m_aif, m_grid);
+    CPPUNIT_ASSERT_MESSAGE("Engines of identical settings are shared.", engine == mitk::AIFConvolutionEngine::GetSharedEngine(m_grid, m_aif, m_grid));
+
+    auto otherAIF = m_aif;
+    otherAIF[10] += 1;
+    auto otherEngine = mitk::AIFConvolutionEngine::GetSharedEngine(m_grid, otherAIF, m_grid);
+    CPPUNIT_ASSERT_MESSAGE("Changed AIF leads to a new engine.", engine != otherEngine);
+    CPPUNIT_ASSERT(otherEngine->IsCreatedFor(m_grid, otherAIF, m_grid));
+    CPPUNIT_ASSERT(!otherEngine->IsCreatedFor(m_grid, m_aif, m_grid));
+
+    mitk::AIFConvolutionEngine::ClearSharedEngines();
+    CPPUNIT_ASSERT_MESSAGE("Cleared engines are created again.", engine != mitk::AIFConvolutionEngine::GetSharedEngine(m_grid, m_aif, m_grid));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkAIFConvolutionEngine)
@@ -0,0 +1,223 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+// Testing
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+//MITK includes
+#include "mitkVector.h"
+#include "mitkNumericTwoCompartmentExchangeModel.h"
+#include "mitkNumericTwoTissueCompartmentModel.h"
+
+#include <vector>
+
+class mitkNumericTwoCompartmentExchangeModelTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkNumericTwoCompartmentExchangeModelTestSuite);
+  MITK_TEST(GetSignalBatchTest);
+  MITK_TEST(GetSignalBatchTwoTissueTest);
+  MITK_TEST(GetSignalBatchWrongSizeTest);
+  MITK_TEST(GetSignalBatchReferenceTest);
+  MITK_TEST(GetSignalBatchTwoTissueReferenceTest);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::ModelBase::TimeGridType m_grid;
+  mitk::AIFBasedModelBase::AterialInputFunctionType m_arterialInputFunction;
+  mitk::NumericTwoCompartmentExchangeModel::Pointer m_testmodel;
+
+  mitk::ModelBase::ParametersBatchType CreateParameterSets(const mitk::ModelBase::ParametersType& parameters) const
+  {
+    //parameter sets like they are used for the numerical derivative
+    mitk::ModelBase::ParametersBatchType parameterSets(2 * parameters.size() + 1, parameters);
+    for (unsigned int i = 0; i < parameters.size(); ++i)
+    {
+      parameterSets[2 * i][i] *= 0.9;
+      parameterSets[2 * i + 1][i] *= 1.1;
+    }
+    return parameterSets;
+  }
+
+  void CheckBatch(const mitk::ModelBase* model, const mitk::ModelBase::ParametersBatchType& parameterSets) const
+  {
+    auto signals = model->GetSignalBatch(parameterSets);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Checking number of signals.", parameterSets.size(), signals.size());
+
+    for (std::size_t i = 0; i < parameterSets.size(); ++i)
+    {
+      auto signal = model->GetSignal(parameterSets[i]);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Checking signal size.", signal.size(), signals[i].size());
+      for (unsigned int j = 0; j < signal.size(); ++j)
+      {
+        CPPUNIT_ASSERT_EQUAL_MESSAGE("Checking that batch and single evaluation are identical.", signal[j], signals[i][j]);
+      }
+    }
+  }
+
+  /** Compares the signals of the batch with reference signals. Only the first numberOfSamples time points are checked.*/
+  void CheckReference(const mitk::ModelBase* model, const mitk::ModelBase::ParametersBatchType& parameterSets,
+    const std::vector<std::vector<double>>& references, unsigned int numberOfSamples) const
+  {
+    auto signals = model->GetSignalBatch(parameterSets);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Checking number of signals.", parameterSets.size(), signals.size());
+
+    for (std::size_t i = 0; i < parameterSets.size(); ++i)
+    {
+      for (unsigned int j = 0; j < numberOfSamples; ++j)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Checking signal against the reference.", references[i][j], signals[i][j], 1e-12);
+      }
+    }
+  }
+
+  /** Reference signals of the implementation that integrated every parameter set on its own (step size 0.05).*/
+  const std::vector<std::vector<double>> m_ExchangeReferences = {
+    { 0, 0, 0, 0, 1.142533709918181e-06, 0.057579227667379614, 0.10359020688413771, 0.11560291196107467,
+      0.12129288463668791, 0.12508903978023667, 0.12781373347965758, 0.12971317457207354, 0.13092742614444178,
+      0.1315653494334334, 0.13171829480528197, 0.13146404308935977, 0.130868980442399, 0.12998977527270636,
+      0.12887478524779938, 0.12756525733834537, 0.12609635440318706 },
+    { 0, 0, 0, 0, 1.9591728877586453e-06, 0.10492491851380387, 0.19987659015999645, 0.22999909892987805,
+      0.24353738561157648, 0.25022417346652892, 0.25258921336648421, 0.25171993032203666, 0.24833604776052892,
+      0.24300246112137824, 0.23618177468760906, 0.22825543014579036, 0.21953735837488311, 0.21028479409108652,
+      0.20070731941691375, 0.190974515923511, 0.18122245202772613 } };
+
+  /** Reference signals of the implementation that integrated every parameter set on its own.*/
+  const std::vector<std::vector<double>> m_TwoTissueReferences = {
+    { 0, 0, 0, 0, 6.2133537171183197e-06, 0.23060127692983631, 0.42473088060174247, 0.57608241832325902,
+      0.6921290053964434, 0.77914576072493369, 0.8423949820869937, 0.88628220522045587, 0.91448868319356658,
+      0.93008393180863547, 0.93562130967918145, 0.93321914798001604, 0.92462957386210531, 0.91129685673212935,
+      0.89440683794823739, 0.87492877503101052, 0.85365073551120407, 0.83120958257601663 },
+    { 0, 0, 0, 0, 9.4186593686696449e-06, 0.40418091403300715, 0.69868552094960923, 0.93555065388120418,
+      1.1242642787599031, 1.272852308286039, 1.3880974855077521, 1.4757254737244059, 1.5405635061357956,
+      1.586675667970129, 1.6174782265671501, 1.6358379209679605, 1.6441556992207376, 1.6444380304849009,
+      1.6383576102322743, 1.6273050127309441, 1.6124326190935161, 1.5946920687489636 } };
+
+public:
+  void setUp() override
+  {
+    m_grid.SetSize(22);
+    m_arterialInputFunction.SetSize(22);
+
+    for (int i = 0; i < 22; ++i)
+    {
+      // time grid in seconds, 14s between frames
+      m_grid[i] = (double)14 * i;
+    }
+
+    // AIF from Weinmann, H. J., Laniado, M., and W.Mutzel (1984). Pharmacokinetics of GD - DTPA / dimeglumine after intravenous injection into healthy volunteers. Phys Chem Phys Med NMR, 16(2) : 167-72.
+    int D = 1;
+    double a1 = 3.99;
+    double m1 = 0.144;
+    double a2 = 4.78;
+    double m2 = 0.0111;
+
+    for (int i = 0; i < 22; ++i)
+    {
+      if (i < 5)
+        m_arterialInputFunction[i] = 0;
+      else
+        m_arterialInputFunction[i] = D * (a1 * exp(-m1 * m_grid[i]) + a2 * exp(-m2 * m_grid[i]));
+    }
+
+    m_testmodel = mitk::NumericTwoCompartmentExchangeModel::New();
+    m_testmodel->SetTimeGrid(m_grid);
+    m_testmodel->SetAterialInputFunctionValues(m_arterialInputFunction);
+    m_testmodel->SetAterialInputFunctionTimeGrid(m_grid);
+    m_testmodel->SetODEINTStepSize(0.05);
+  }
+
+  void tearDown() override
+  {
+    m_testmodel = nullptr;
+  }
+
+  mitk::ModelBase::ParametersType GetExchangeParameters() const
+  {
+    mitk::ModelBase::ParametersType parameters(4);
+    parameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_F] = 35.0;
+    parameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_PS] = 5.0;
+    parameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_ve] = 0.5;
+    parameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_vp] = 0.05;
+    return parameters;
+  }
+
+  void GetSignalBatchTest()
+  {
+    CheckBatch(m_testmodel, CreateParameterSets(GetExchangeParameters()));
+  }
+
+  void GetSignalBatchTwoTissueTest()
+  {
+    mitk::NumericTwoTissueCompartmentModel::Pointer model = mitk::NumericTwoTissueCompartmentModel::New();
+    model->SetTimeGrid(m_grid);
+    model->SetAterialInputFunctionValues(m_arterialInputFunction);
+    model->SetAterialInputFunctionTimeGrid(m_grid);
+
+    mitk::ModelBase::ParametersType parameters(5);
+    parameters[mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_K1] = 0.5;
+    parameters[mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k2] = 0.3;
+    parameters[mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k3] = 0.1;
+    parameters[mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k4] = 0.05;
+    parameters[mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_VB] = 0.05;
+
+    CheckBatch(model, CreateParameterSets(parameters));
+  }
+
+  void GetSignalBatchWrongSizeTest()
+  {
+    mitk::ModelBase::ParametersBatchType parameterSets(2, GetExchangeParameters());
+    parameterSets[1].SetSize(3);
+    CPPUNIT_ASSERT_THROW(m_testmodel->GetSignalBatch(parameterSets), itk::ExceptionObject);
+
+    CPPUNIT_ASSERT_MESSAGE("Checking empty batch.", m_testmodel->GetSignalBatch(mitk::ModelBase::ParametersBatchType()).empty());
+  }
+
+  void GetSignalBatchReferenceTest()
+  {
+    mitk::ModelBase::ParametersType secondParameters(4);
+    secondParameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_F] = 60.0;
+    secondParameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_PS] = 12.0;
+    secondParameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_ve] = 0.3;
+    secondParameters[mitk::NumericTwoCompartmentExchangeModel::POSITION_PARAMETER_vp] = 0.1;
+
+    // the integration stops before the last time point, so the last sample is not checked
+    CheckReference(m_testmodel, { GetExchangeParameters() }, m_ExchangeReferences, 21);
+    CheckReference(m_testmodel, { GetExchangeParameters(), secondParameters }, m_ExchangeReferences, 21);
+  }
+
+  void GetSignalBatchTwoTissueReferenceTest()
+  {
+    mitk::NumericTwoTissueCompartmentModel::Pointer model = mitk::NumericTwoTissueCompartmentModel::New();
+    model->SetTimeGrid(m_grid);
+    model->SetAterialInputFunctionValues(m_arterialInputFunction);
+    model->SetAterialInputFunctionTimeGrid(m_grid);
+
+    mitk::ModelBase::ParametersBatchType parameterSets(2, mitk::ModelBase::ParametersType(5));
+    parameterSets[0][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_K1] = 0.5;
+    parameterSets[0][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k2] = 0.3;
+    parameterSets[0][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k3] = 0.1;
+    parameterSets[0][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k4] = 0.05;
+    parameterSets[0][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_VB] = 0.05;
+    parameterSets[1][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_K1] = 0.8;
+    parameterSets[1][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k2] = 0.2;
+    parameterSets[1][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k3] = 0.15;
+    parameterSets[1][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_k4] = 0.02;
+    parameterSets[1][mitk::NumericTwoTissueCompartmentModel::POSITION_PARAMETER_VB] = 0.1;
+
+    CheckReference(model, { parameterSets[0] }, m_TwoTissueReferences, 22);
+    CheckReference(model, parameterSets, m_TwoTissueReferences, 22);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkNumericTwoCompartmentExchangeModel)
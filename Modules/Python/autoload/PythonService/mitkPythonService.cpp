@@ -41,6 +41,8 @@ found in the LICENSE file.
 
 #include <mitkExceptionMacro.h>
 
+#include <memory>
+
 #ifndef WIN32
 #include <dlfcn.h>
 #endif
@@ -237,13 +239,183 @@ void mitk::PythonService::NotifyObserver(const std::string &command)
   }
 }
 
+namespace
+{
+  bool DetermineNumpyType(const mitk::PixelType& pixelType, NPY_TYPES& npy_type, std::string& sitk_type)
+  {
+    auto ioPixelType = pixelType.GetPixelType();
+
+    // default pixeltype: unsigned short
+    npy_type = NPY_USHORT;
+    sitk_type = "sitkUInt8";
+    if( ioPixelType == itk::IOPixelEnum::SCALAR )
+    {
+      if( pixelType.GetComponentType() == itk::IOComponentEnum::DOUBLE ) {
+        npy_type = NPY_DOUBLE;
+        sitk_type = "sitkFloat64";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::FLOAT ) {
+        npy_type = NPY_FLOAT;
+        sitk_type = "sitkFloat32";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::SHORT) {
+        npy_type = NPY_SHORT;
+        sitk_type = "sitkInt16";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::CHAR ) {
+        npy_type = NPY_BYTE;
+        sitk_type = "sitkInt8";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::INT ) {
+        npy_type = NPY_INT;
+        sitk_type = "sitkInt32";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::LONG ) {
+        npy_type = NPY_LONG;
+        sitk_type = "sitkInt64";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UCHAR ) {
+        npy_type = NPY_UBYTE;
+        sitk_type = "sitkUInt8";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UINT ) {
+        npy_type = NPY_UINT;
+        sitk_type = "sitkUInt32";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::ULONG ) {
+        npy_type = NPY_LONG;
+        sitk_type = "sitkUInt64";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::USHORT ) {
+        npy_type = NPY_USHORT;
+        sitk_type = "sitkUInt16";
+      }
+    }
+    else if ( ioPixelType == itk::IOPixelEnum::VECTOR ||
+              ioPixelType == itk::IOPixelEnum::RGB ||
+              ioPixelType == itk::IOPixelEnum::RGBA
+              )
+    {
+      if( pixelType.GetComponentType() == itk::IOComponentEnum::DOUBLE ) {
+        npy_type = NPY_DOUBLE;
+        sitk_type = "sitkVectorFloat64";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::FLOAT ) {
+        npy_type = NPY_FLOAT;
+        sitk_type = "sitkVectorFloat32";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::SHORT) {
+        npy_type = NPY_SHORT;
+        sitk_type = "sitkVectorInt16";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::CHAR ) {
+        npy_type = NPY_BYTE;
+        sitk_type = "sitkVectorInt8";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::INT ) {
+        npy_type = NPY_INT;
+        sitk_type = "sitkVectorInt32";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::LONG ) {
+        npy_type = NPY_LONG;
+        sitk_type = "sitkVectorInt64";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UCHAR ) {
+        npy_type = NPY_UBYTE;
+        sitk_type = "sitkVectorUInt8";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UINT ) {
+        npy_type = NPY_UINT;
+        sitk_type = "sitkVectorUInt32";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::ULONG ) {
+        npy_type = NPY_LONG;
+        sitk_type = "sitkVectorUInt64";
+      } else if( pixelType.GetComponentType() == itk::IOComponentEnum::USHORT ) {
+        npy_type = NPY_USHORT;
+        sitk_type = "sitkVectorUInt16";
+      }
+    }
+    else {
+      MITK_WARN << "not a recognized pixeltype";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Base object of the numpy views of image data. It keeps the image and its channel data alive as long as a
+   * numpy array referencing it exists in python. It holds no lock on the data: python variables may live
+   * arbitrarily long, and a held read lock would block every later write access to the image. Writes to the
+   * image are therefore visible in the (read-only) numpy array.
+   */
+  struct NumpyViewOwner
+  {
+    NumpyViewOwner(const mitk::Image* image, const mitk::Image::ImageDataItemPointer& channelData)
+      : m_Image(image), m_ChannelData(channelData)
+    {
+    }
+
+    mitk::Image::ConstPointer m_Image;
+    mitk::Image::ImageDataItemPointer m_ChannelData;
+  };
+
+  void DeleteNumpyViewOwner(PyObject* capsule)
+  {
+    delete static_cast<NumpyViewOwner*>(PyCapsule_GetPointer(capsule, nullptr));
+  }
+
+  /**
+   * Creates a read-only numpy array that references the channel data of the image instead of copying it.
+   * Like the arrays of sitk.GetArrayFromImage, the array is indexed in reversed order of the first
+   * "dimension" image dimensions with the components as last index of vector images.
+   * \return a new reference or nullptr if the pixel type is not supported
+   */
+  PyObject* CreateNumpyView(mitk::Image* image, unsigned int dimension)
+  {
+    NPY_TYPES npy_type;
+    std::string sitk_type;
+    if (!DetermineNumpyType(image->GetPixelType(), npy_type, sitk_type))
+      return nullptr;
+
+    const unsigned int* imgDim = image->GetDimensions();
+    const unsigned int nrComponents = image->GetPixelType().GetNumberOfComponents();
+    std::vector<npy_intp> npy_dims;
+    for (unsigned int i = dimension; i > 0; --i)
+      npy_dims.push_back(imgDim[i - 1]);
+    if (nrComponents > 1)
+      npy_dims.push_back(nrComponents);
+
+    import_array1(nullptr);
+
+    auto owner = std::make_unique<NumpyViewOwner>(image, image->GetChannelData(0));
+    void* data = nullptr;
+    {
+      // only waits for running writes, the buffer stays valid as long as the owner references the data item
+      mitk::ImageReadAccessor accessor(image, owner->m_ChannelData);
+      data = const_cast<void*>(accessor.GetData());
+    }
+
+    PyObject* capsule = PyCapsule_New(owner.get(), nullptr, DeleteNumpyViewOwner);
+    if (capsule == nullptr)
+      return nullptr;
+    owner.release();
+
+    PyObject* npyArray = PyArray_SimpleNewFromData(static_cast<int>(npy_dims.size()), npy_dims.data(), npy_type, data);
+    if (npyArray == nullptr)
+    {
+      Py_DECREF(capsule);
+      return nullptr;
+    }
+
+    PyArray_CLEARFLAGS(reinterpret_cast<PyArrayObject*>(npyArray), NPY_ARRAY_WRITEABLE);
+
+    // steals the reference of the capsule
+    PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(npyArray), capsule);
+    return npyArray;
+  }
+
+  /** Releases the python objects owning the pixel buffer of an adopted image. */
+  void ReleasePythonBufferOwner(PyObject* bufferOwner)
+  {
+    if (!Py_IsInitialized())
+      return;
+
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_XDECREF(bufferOwner);
+    PyGILState_Release(state);
+  }
+}
+
 bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const std::string &stdvarName)
 {
   QString varName = QString::fromStdString( stdvarName );
   QString command;
   unsigned int* imgDim = image->GetDimensions();
-  int npy_nd = 1;
-
   // access python module
   PyObject *pyMod = PyImport_AddModule("__main__");
   // global dictionary
@@ -251,10 +423,11 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   const mitk::Vector3D spacing = image->GetGeometry()->GetSpacing();
   const mitk::Point3D origin = image->GetGeometry()->GetOrigin();
   mitk::PixelType pixelType = image->GetPixelType();
-  auto ioPixelType = image->GetPixelType().GetPixelType();
-  PyObject* npyArray = nullptr;
-  mitk::ImageReadAccessor racc(image);
-  void* array = const_cast<void*>(racc.GetData());
+
+  NPY_TYPES npy_type;
+  std::string sitk_type;
+  if (!DetermineNumpyType(pixelType, npy_type, sitk_type))
+    return false;
 
   mitk::Vector3D xDirection;
   mitk::Vector3D yDirection;
@@ -270,10 +443,6 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   mitk::FillVector3D(yDirection, transform[1][0]/s[0], transform[1][1]/s[1], transform[1][2]/s[2]);
   mitk::FillVector3D(zDirection, transform[2][0]/s[0], transform[2][1]/s[1], transform[2][2]/s[2]);
 
-  // save the total number of elements here (since the numpy array is one dimensional)
-  npy_intp* npy_dims = new npy_intp[1];
-  npy_dims[0] = imgDim[0];
-
   /**
    * Build a string in the format [1024,1028,1]
    * to describe the dimensionality. This is needed for simple itk
@@ -288,102 +457,19 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
   {
     dimensionString.append(QString(","));
     dimensionString.append(QString::number(imgDim[i]));
-    npy_dims[0] *= imgDim[i];
   }
   dimensionString.append("]");
 
-
-  // the next line is necessary for vectorimages
-  npy_dims[0] *= pixelType.GetNumberOfComponents();
-
-  // default pixeltype: unsigned short
-  NPY_TYPES npy_type  = NPY_USHORT;
-  std::string sitk_type = "sitkUInt8";
-  if( ioPixelType == itk::IOPixelEnum::SCALAR )
-  {
-    if( pixelType.GetComponentType() == itk::IOComponentEnum::DOUBLE ) {
-      npy_type = NPY_DOUBLE;
-      sitk_type = "sitkFloat64";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::FLOAT ) {
-      npy_type = NPY_FLOAT;
-      sitk_type = "sitkFloat32";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::SHORT) {
-      npy_type = NPY_SHORT;
-      sitk_type = "sitkInt16";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::CHAR ) {
-      npy_type = NPY_BYTE;
-      sitk_type = "sitkInt8";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::INT ) {
-      npy_type = NPY_INT;
-      sitk_type = "sitkInt32";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::LONG ) {
-      npy_type = NPY_LONG;
-      sitk_type = "sitkInt64";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UCHAR ) {
-      npy_type = NPY_UBYTE;
-      sitk_type = "sitkUInt8";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UINT ) {
-      npy_type = NPY_UINT;
-      sitk_type = "sitkUInt32";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::ULONG ) {
-      npy_type = NPY_LONG;
-      sitk_type = "sitkUInt64";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::USHORT ) {
-      npy_type = NPY_USHORT;
-      sitk_type = "sitkUInt16";
-    }
-  }
-  else if ( ioPixelType == itk::IOPixelEnum::VECTOR ||
-            ioPixelType == itk::IOPixelEnum::RGB ||
-            ioPixelType == itk::IOPixelEnum::RGBA
-            )
-  {
-    if( pixelType.GetComponentType() == itk::IOComponentEnum::DOUBLE ) {
-      npy_type = NPY_DOUBLE;
-      sitk_type = "sitkVectorFloat64";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::FLOAT ) {
-      npy_type = NPY_FLOAT;
-      sitk_type = "sitkVectorFloat32";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::SHORT) {
-      npy_type = NPY_SHORT;
-      sitk_type = "sitkVectorInt16";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::CHAR ) {
-      npy_type = NPY_BYTE;
-      sitk_type = "sitkVectorInt8";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::INT ) {
-      npy_type = NPY_INT;
-      sitk_type = "sitkVectorInt32";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::LONG ) {
-      npy_type = NPY_LONG;
-      sitk_type = "sitkVectorInt64";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UCHAR ) {
-      npy_type = NPY_UBYTE;
-      sitk_type = "sitkVectorUInt8";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::UINT ) {
-      npy_type = NPY_UINT;
-      sitk_type = "sitkVectorUInt32";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::ULONG ) {
-      npy_type = NPY_LONG;
-      sitk_type = "sitkVectorUInt64";
-    } else if( pixelType.GetComponentType() == itk::IOComponentEnum::USHORT ) {
-      npy_type = NPY_USHORT;
-      sitk_type = "sitkVectorUInt16";
-    }
-  }
-  else {
-    MITK_WARN << "not a recognized pixeltype";
+  // read-only view on the image data, so the only copy is the one into the buffer of the sitk image
+  PyObject* npyArray = CreateNumpyView(image, 3);
+  if (npyArray == nullptr)
     return false;
-  }
-
-  // creating numpy array
-  import_array1 (true);
-  npyArray = PyArray_SimpleNewFromData(npy_nd,npy_dims,npy_type,array);
 
   // add temp array it to the python dictionary to access it in python code
   const int status = PyDict_SetItemString( pyDict,QString("%1_numpy_array")
                                            .arg(varName).toStdString().c_str(),
                                            npyArray );
-
+  Py_DECREF(npyArray);
 
   // sanity check
   if ( status != 0 )
@@ -414,17 +500,38 @@ bool mitk::PythonService::CopyToPythonAsSimpleItkImage(mitk::Image *image, const
       );
   // directly access the cpp api from the lib
   command.append( QString("_SimpleITK._SetImageFromArray(%1_numpy_array,%1)\n").arg(varName) );
-  command.append( QString("del %1_numpy_array").arg(varName) );
 
   MITK_DEBUG("PythonService") << "Issuing python command " << command.toStdString();
 
 
   this->Execute( command.toStdString(), IPythonService::MULTI_LINE_COMMAND );
 
+  // removed here instead of by the command, so the view is released even if the command failed
+  const std::string arrayName = QString("%1_numpy_array").arg(varName).toStdString();
+  if (PyDict_GetItemString(pyDict, arrayName.c_str()) != nullptr)
+    PyDict_DelItemString(pyDict, arrayName.c_str());
+
   return true;
 }
 
 
+bool mitk::PythonService::ShareToPythonAsNumpyArray(mitk::Image *image, const std::string &stdvarName)
+{
+  // access python module
+  PyObject *pyMod = PyImport_AddModule("__main__");
+  // global dictionary
+  PyObject *pyDict = PyModule_GetDict(pyMod);
+
+  PyObject* npyArray = CreateNumpyView(image, image->GetDimension());
+  if (npyArray == nullptr)
+    return false;
+
+  const int status = PyDict_SetItemString(pyDict, stdvarName.c_str(), npyArray);
+  Py_DECREF(npyArray);
+
+  return status == 0;
+}
+
 mitk::PixelType DeterminePixelType(const std::string& pythonPixeltype, unsigned long nrComponents, int dimensions)
 {
   typedef itk::RGBPixel< unsigned char > UCRGBPixelType;
@@ -524,6 +631,16 @@ mitk::PixelType DeterminePixelType(const std::string& pythonPixeltype, unsigned
 }
 
 mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std::string &stdvarName)
+{
+  return this->ImportSimpleItkImageFromPython(stdvarName, false);
+}
+
+mitk::Image::Pointer mitk::PythonService::AdoptSimpleItkImageFromPython(const std::string &stdvarName)
+{
+  return this->ImportSimpleItkImageFromPython(stdvarName, true);
+}
+
+mitk::Image::Pointer mitk::PythonService::ImportSimpleItkImageFromPython(const std::string &stdvarName, bool referenceBuffer)
 {
   double*ds = nullptr;
   // access python module
@@ -536,7 +653,15 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
   QString command;
   QString varName = QString::fromStdString( stdvarName );
 
-  command.append( QString("%1_numpy_array = sitk.GetArrayFromImage(%1)\n").arg(varName) );
+  // a view avoids copying the buffer into numpy (older SimpleITK versions only provide a copy). An adopted
+  // buffer is taken from a shallow copy of the image, which SimpleITK detaches as soon as "varName" is modified.
+  QString sourceName = varName;
+  if (referenceBuffer)
+  {
+    sourceName = QString("%1_sitk_image").arg(varName);
+    command.append( QString("%1 = sitk.Image(%2)\n").arg(sourceName).arg(varName) );
+  }
+  command.append( QString("%1_numpy_array = getattr(sitk, 'GetArrayViewFromImage', sitk.GetArrayFromImage)(%2)\n").arg(varName).arg(sourceName) );
   command.append( QString("%1_spacing = numpy.asarray(%1.GetSpacing())\n").arg(varName) );
   command.append( QString("%1_origin = numpy.asarray(%1.GetOrigin())\n").arg(varName) );
   command.append( QString("%1_dtype = %1_numpy_array.dtype.name\n").arg(varName) );
@@ -567,17 +692,29 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
 
   mitk::PixelType pixelType = DeterminePixelType(dtype, nr_Components, nr_dimensions);
 
-  unsigned int* dimensions = new unsigned int[nr_dimensions];
+  std::vector<unsigned int> dimensions(nr_dimensions);
   // fill backwards , nd data saves dimensions in opposite direction
   for( unsigned i = 0; i < nr_dimensions; ++i )
   {
     dimensions[i] = PyArray_DIMS(py_data)[nr_dimensions - 1 - i];
   }
 
-  mitkImage->Initialize(pixelType, nr_dimensions, dimensions);
-
+  mitkImage->Initialize(pixelType, nr_dimensions, dimensions.data());
 
-  mitkImage->SetChannel(PyArray_DATA(py_data));
+  if (referenceBuffer)
+  {
+    // the image and the view own the buffer. They are released together with the channel data, which
+    // may outlive the mitk image (e.g. if sub-items of it are still referenced).
+    PyObject* py_image = PyDict_GetItemString(pyDict,sourceName.toStdString().c_str() );
+    std::shared_ptr<void> bufferOwner(PyTuple_Pack(2, py_image, reinterpret_cast<PyObject*>(py_data)),
+                                      [](void* owner) { ReleasePythonBufferOwner(static_cast<PyObject*>(owner)); });
+    mitkImage->SetImportChannel(PyArray_DATA(py_data), 0, mitk::Image::ReferenceMemory);
+    mitkImage->GetChannelData(0)->SetMemoryOwner(bufferOwner);
+  }
+  else
+  {
+    mitkImage->SetChannel(PyArray_DATA(py_data));
+  }
 
 
   ds = reinterpret_cast<double*>(PyArray_DATA(py_spacing));
@@ -629,11 +766,13 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
   command.append( QString("del %1_origin\n").arg(varName) );
   command.append( QString("del %1_direction\n").arg(varName) );
   command.append( QString("del %1_nrComponents\n").arg(varName) );
+  if (referenceBuffer)
+  {
+    command.append( QString("del %1\n").arg(sourceName) );
+  }
   MITK_DEBUG("PythonService") << "Issuing python command " << command.toStdString();
   this->Execute(command.toStdString(), IPythonService::MULTI_LINE_COMMAND );
 
-  delete[] dimensions;
-
 
   return mitkImage;
 }
@@ -654,10 +793,6 @@ bool mitk::PythonService::CopyToPythonAsCvImage( mitk::Image* image, const std::
   mitk::ImageReadAccessor racc(image);
   void* array = (void*) racc.GetData();
 
-  // save the total number of elements here (since the numpy array is one dimensional)
-  npy_intp* npy_dims = new npy_intp[1];
-  npy_dims[0] = imgDim[0];
-
   /**
    * Build a string in the format [1024,1028,1]
    * to describe the dimensionality. This is needed for simple itk
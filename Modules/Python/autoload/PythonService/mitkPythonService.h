@@ -68,6 +68,12 @@ namespace mitk
       /// \see IPythonService::CopyItkImageFromPython()
       mitk::Image::Pointer CopySimpleItkImageFromPython( const std::string& varName ) override;
       ///
+      /// \see IPythonService::ShareToPythonAsNumpyArray()
+      bool ShareToPythonAsNumpyArray( mitk::Image* image, const std::string& varName ) override;
+      ///
+      /// \see IPythonService::AdoptSimpleItkImageFromPython()
+      mitk::Image::Pointer AdoptSimpleItkImageFromPython( const std::string& varName ) override;
+      ///
       /// \see IPythonService::IsOpenCvPythonWrappingAvailable()
       bool IsOpenCvPythonWrappingAvailable() override;
       ///
@@ -96,6 +102,10 @@ namespace mitk
   protected:
 
   private:
+      ///
+      /// shared implementation of CopySimpleItkImageFromPython() and AdoptSimpleItkImageFromPython()
+      mitk::Image::Pointer ImportSimpleItkImageFromPython( const std::string& varName, bool referenceBuffer );
+
       QList<PythonCommandObserver*> m_Observer;
       ctkAbstractPythonManager m_PythonManager;
       bool m_ItkWrappingAvailable;
@@ -111,6 +111,19 @@ namespace mitk
         /// copies an itk image from the python process that is named "varName"
         /// \return the image or 0 if copying was not possible
         virtual mitk::Image::Pointer CopySimpleItkImageFromPython( const std::string& varName ) = 0;
+        ///
+        /// makes the pixel data of an mitk image available as read-only numpy array "varName"
+        /// without copying it. The array keeps the image data alive as long as it exists in python.
+        /// It holds no access lock, so later writes to the image are visible in the array.
+        /// \return true if the array was created, else false
+        virtual bool ShareToPythonAsNumpyArray( mitk::Image* image, const std::string& varName ) = 0;
+        ///
+        /// like CopySimpleItkImageFromPython(), but the returned image references the pixel buffer
+        /// of the itk image "varName" instead of copying it. The python objects owning the buffer are
+        /// released together with the image data, i.e. when neither the returned image nor any of its
+        /// data items are referenced anymore. Writing to the returned image is not supported.
+        /// \return the image or 0 if adopting was not possible
+        virtual mitk::Image::Pointer AdoptSimpleItkImageFromPython( const std::string& varName ) = 0;
 
         ///
         /// \return true, if OpenCv wrapping is available, false otherwise
@@ -19,25 +19,138 @@ found in the LICENSE file.
 #include <mitkIPythonService.h>
 #include <QmitkPythonSnippets.h>
 #include <mitkIPythonService.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <array>
+#include <memory>
+#include <string>
 
 class mitkPythonTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkPythonTestSuite);
   MITK_TEST(TestPython);
+  MITK_TEST(TestCopySimpleItkImageRoundTrip);
+  MITK_TEST(TestAdoptSimpleItkImageRoundTrip);
+  MITK_TEST(TestShareToPythonAsNumpyArray);
   CPPUNIT_TEST_SUITE_END();
 
+private:
+  mitk::IPythonService* m_PythonService;
+
+  /** Float image with distinct pixel values x + 10*y + 100*z and a non-trivial geometry. */
+  mitk::Image::Pointer CreateImage(double& sumOfPixels)
+  {
+    std::array<unsigned int, 3> dimensions = {{ 4, 5, 6 }};
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions.data());
+
+    mitk::Vector3D spacing;
+    mitk::FillVector3D(spacing, 0.5, 1.0, 2.0);
+    image->GetGeometry()->SetSpacing(spacing);
+    mitk::Point3D origin;
+    mitk::FillVector3D(origin, 1.0, 2.0, 3.0);
+    image->GetGeometry()->SetOrigin(origin);
+
+    sumOfPixels = 0.0;
+    mitk::ImageWriteAccessor writeAccess(image);
+    auto data = static_cast<float*>(writeAccess.GetData());
+    for (unsigned int z = 0; z < dimensions[2]; ++z)
+      for (unsigned int y = 0; y < dimensions[1]; ++y)
+        for (unsigned int x = 0; x < dimensions[0]; ++x)
+        {
+          const float value = x + 10.0f * y + 100.0f * z;
+          data[x + dimensions[0] * (y + dimensions[1] * z)] = value;
+          sumOfPixels += value;
+        }
+
+    return image;
+  }
+
 public:
 
-  void TestPython()
+  void setUp() override
   {
     us::ModuleContext* context = us::GetModuleContext();
-    us::ServiceReference<mitk::IPythonService> m_PythonServiceRef = context->GetServiceReference<mitk::IPythonService>();
-    mitk::IPythonService* m_PythonService = dynamic_cast<mitk::IPythonService*> ( context->GetService<mitk::IPythonService>(m_PythonServiceRef) );
+    us::ServiceReference<mitk::IPythonService> pythonServiceRef = context->GetServiceReference<mitk::IPythonService>();
+    m_PythonService = dynamic_cast<mitk::IPythonService*> ( context->GetService<mitk::IPythonService>(pythonServiceRef) );
     mitk::IPythonService::ForceLoadModule();
+  }
 
+  void TestPython()
+  {
     std::string result = m_PythonService->Execute( "5+5", mitk::IPythonService::EVAL_COMMAND );
     MITK_TEST_CONDITION( result == "10", "Testing if running python code 5+5 results in 10" );
   }
+
+  void TestCopySimpleItkImageRoundTrip()
+  {
+    if (!m_PythonService->IsSimpleItkPythonWrappingAvailable())
+      return;
+
+    double sumOfPixels = 0.0;
+    auto image = CreateImage(sumOfPixels);
+
+    CPPUNIT_ASSERT(m_PythonService->CopyToPythonAsSimpleItkImage(image, "mitk_image"));
+    CPPUNIT_ASSERT_EQUAL(std::string("123.0"), m_PythonService->Execute("float(mitk_image.GetPixel(3,2,1))", mitk::IPythonService::EVAL_COMMAND));
+
+    auto result = m_PythonService->CopySimpleItkImageFromPython("mitk_image");
+    m_PythonService->Execute("del mitk_image");
+
+    CPPUNIT_ASSERT(result.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Image copied to python and back equals the original.", mitk::Equal(*image, *result, mitk::eps, true));
+  }
+
+  void TestAdoptSimpleItkImageRoundTrip()
+  {
+    if (!m_PythonService->IsSimpleItkPythonWrappingAvailable())
+      return;
+
+    double sumOfPixels = 0.0;
+    auto image = CreateImage(sumOfPixels);
+
+    CPPUNIT_ASSERT(m_PythonService->CopyToPythonAsSimpleItkImage(image, "mitk_image"));
+    auto result = m_PythonService->AdoptSimpleItkImageFromPython("mitk_image");
+    CPPUNIT_ASSERT(result.IsNotNull());
+    CPPUNIT_ASSERT_MESSAGE("Adopted image owns the python buffer.", nullptr != result->GetChannelData(0)->GetMemoryOwner());
+
+    // the buffer stays valid if python deletes and modifies its variables
+    m_PythonService->Execute("mitk_image = sitk.Image(mitk_image)\nmitk_image[0,0,0] = -1.0\ndel mitk_image", mitk::IPythonService::MULTI_LINE_COMMAND);
+    CPPUNIT_ASSERT_MESSAGE("Adopted image equals the original.", mitk::Equal(*image, *result, mitk::eps, true));
+
+    // the python buffer is released together with the data of the adopted image, not with the image itself
+    auto volume = result->GetVolumeData(0);
+    std::weak_ptr<void> bufferOwner = result->GetChannelData(0)->GetMemoryOwner();
+    result = nullptr;
+    CPPUNIT_ASSERT_MESSAGE("Buffer is kept while data of the adopted image is referenced.", !bufferOwner.expired());
+    volume = nullptr;
+    CPPUNIT_ASSERT_MESSAGE("Buffer is released with the data of the adopted image.", bufferOwner.expired());
+  }
+
+  void TestShareToPythonAsNumpyArray()
+  {
+    double sumOfPixels = 0.0;
+    auto image = CreateImage(sumOfPixels);
+
+    CPPUNIT_ASSERT(m_PythonService->ShareToPythonAsNumpyArray(image, "mitk_array"));
+    CPPUNIT_ASSERT_EQUAL(std::string("(6, 5, 4)"), m_PythonService->Execute("mitk_array.shape", mitk::IPythonService::EVAL_COMMAND));
+    CPPUNIT_ASSERT_EQUAL(std::string("False"), m_PythonService->Execute("mitk_array.flags.writeable", mitk::IPythonService::EVAL_COMMAND));
+    CPPUNIT_ASSERT_EQUAL(std::string("123.0"), m_PythonService->Execute("float(mitk_array[1,2,3])", mitk::IPythonService::EVAL_COMMAND));
+
+    // the array holds no lock, writing to the image does not wait until python deletes it
+    {
+      mitk::ImageWriteAccessor writeAccess(image);
+      static_cast<float*>(writeAccess.GetData())[3 + 4 * (2 + 5 * 1)] = -1.0f;
+    }
+    sumOfPixels -= 124.0;
+    CPPUNIT_ASSERT_EQUAL(std::string("-1.0"), m_PythonService->Execute("float(mitk_array[1,2,3])", mitk::IPythonService::EVAL_COMMAND));
+
+    // the array keeps the image data alive after the image was released in c++
+    image = nullptr;
+    const double sumInPython = std::stod(m_PythonService->Execute("float(mitk_array.sum(dtype='float64'))", mitk::IPythonService::EVAL_COMMAND));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(sumOfPixels, sumInPython, 1e-6);
+    CPPUNIT_ASSERT(!m_PythonService->PythonErrorOccured());
+    m_PythonService->Execute("del mitk_array");
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkPython)
@@ -0,0 +1,259 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkBlockwiseSurfaceGenerator.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageToSurfaceFilter.h>
+
+#include <itkMultiThreaderBase.h>
+
+#include <vtkAppendPolyData.h>
+#include <vtkCleanPolyData.h>
+#include <vtkDataArray.h>
+#include <vtkDecimatePro.h>
+#include <vtkImageData.h>
+#include <vtkLinearTransform.h>
+#include <vtkMarchingCubes.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPointData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkQuadricDecimation.h>
+#include <vtkSmoothPolyDataFilter.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  /** Everything needed to create a block of the image, determined once before the blocks are processed in parallel. */
+  struct VolumeInfo
+  {
+    char *Scalars;
+    int ScalarType;
+    int ScalarSize;
+    int Dimensions[3];
+    double Spacing[3];
+  };
+
+  /**
+   * Surface of the slices [firstSlice, lastSlice] in spacing scaled index coordinates.
+   * Vertices on the open borders of the block are neither moved nor removed.
+   */
+  vtkSmartPointer<vtkPolyData> GenerateBlockSurface(const VolumeInfo &volume,
+                                                    int firstSlice,
+                                                    int lastSlice,
+                                                    double threshold,
+                                                    double decimation,
+                                                    unsigned int smoothingIterations)
+  {
+    // the block references the slices of the image, nothing is copied
+    const vtkIdType sliceSize = static_cast<vtkIdType>(volume.Dimensions[0]) * volume.Dimensions[1];
+
+    auto scalars = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(volume.ScalarType));
+    scalars->SetNumberOfComponents(1);
+    scalars->SetVoidArray(volume.Scalars + firstSlice * sliceSize * volume.ScalarSize,
+                          (lastSlice - firstSlice + 1) * sliceSize,
+                          1);
+
+    auto block = vtkSmartPointer<vtkImageData>::New();
+    block->SetExtent(0, volume.Dimensions[0] - 1, 0, volume.Dimensions[1] - 1, firstSlice, lastSlice);
+    block->SetSpacing(volume.Spacing[0], volume.Spacing[1], volume.Spacing[2]);
+    block->SetOrigin(0.0, 0.0, 0.0);
+    block->GetPointData()->SetScalars(scalars);
+
+    auto marchingCubes = vtkSmartPointer<vtkMarchingCubes>::New();
+    marchingCubes->ComputeScalarsOff();
+    marchingCubes->ComputeNormalsOff();
+    marchingCubes->SetInputData(block);
+    marchingCubes->SetValue(0, threshold);
+    marchingCubes->Update();
+
+    vtkSmartPointer<vtkPolyData> polyData = marchingCubes->GetOutput();
+
+    if (0 == polyData->GetNumberOfPoints() || 0 == polyData->GetNumberOfCells())
+      return polyData;
+
+    if (smoothingIterations > 0)
+    {
+      auto smoother = vtkSmartPointer<vtkSmoothPolyDataFilter>::New();
+      smoother->SetInputData(polyData);
+      smoother->SetNumberOfIterations(smoothingIterations);
+      smoother->SetRelaxationFactor(0.1);
+      smoother->SetFeatureAngle(60);
+      smoother->FeatureEdgeSmoothingOff();
+      smoother->BoundarySmoothingOff();
+      smoother->SetConvergence(0);
+      smoother->Update();
+
+      polyData = smoother->GetOutput();
+    }
+
+    if (decimation > 0.0 && decimation < 1.0)
+    {
+      // vtkQuadricDecimation would move the block borders, vtkDecimatePro only removes vertices
+      auto decimate = vtkSmartPointer<vtkDecimatePro>::New();
+      decimate->SetInputData(polyData);
+      decimate->SetTargetReduction(decimation);
+      decimate->PreserveTopologyOn();
+      decimate->SplittingOff();
+      decimate->BoundaryVertexDeletionOff();
+      decimate->Update();
+
+      polyData = decimate->GetOutput();
+    }
+
+    return polyData;
+  }
+
+  vtkSmartPointer<vtkPolyData> GenerateSurfaceInOnePiece(mitk::Image *image,
+                                                         double threshold,
+                                                         double decimation,
+                                                         unsigned int smoothingIterations)
+  {
+    auto imageToSurfaceFilter = mitk::ImageToSurfaceFilter::New();
+    imageToSurfaceFilter->SetInput(image);
+    imageToSurfaceFilter->SetThreshold(threshold);
+    imageToSurfaceFilter->SetSmooth(smoothingIterations > 0);
+    imageToSurfaceFilter->SetSmoothIteration(static_cast<int>(smoothingIterations));
+    imageToSurfaceFilter->SetDecimate(mitk::ImageToSurfaceFilter::NoDecimation);
+    imageToSurfaceFilter->Update();
+
+    vtkSmartPointer<vtkPolyData> polyData = imageToSurfaceFilter->GetOutput()->GetVtkPolyData();
+
+    if (decimation > 0.0 && decimation < 1.0)
+    {
+      auto quadricDecimation = vtkSmartPointer<vtkQuadricDecimation>::New();
+      quadricDecimation->SetInputData(polyData);
+      quadricDecimation->SetTargetReduction(decimation);
+      quadricDecimation->AttributeErrorMetricOn();
+      quadricDecimation->GlobalWarningDisplayOff();
+      quadricDecimation->Update();
+
+      auto cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+      cleaner->SetInputConnection(quadricDecimation->GetOutputPort());
+      cleaner->PieceInvariantOn();
+      cleaner->ConvertLinesToPointsOn();
+      cleaner->ConvertStripsToPolysOn();
+      cleaner->PointMergingOn();
+      cleaner->Update();
+
+      polyData = cleaner->GetOutput();
+    }
+
+    return polyData;
+  }
+
+  vtkSmartPointer<vtkPolyData> ComputeNormals(vtkPolyData *polyData)
+  {
+    auto normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+    normals->SetInputData(polyData);
+    normals->SetFeatureAngle(360.0);
+    normals->AutoOrientNormalsOn();
+    normals->FlipNormalsOff();
+    normals->Update();
+
+    return normals->GetOutput();
+  }
+}
+
+mitk::BlockwiseSurfaceGenerator::BlockwiseSurfaceGenerator()
+  : m_Threshold(1.0), m_Decimation(0.0), m_SmoothingIterations(50), m_BlockSize(64)
+{
+}
+
+mitk::BlockwiseSurfaceGenerator::~BlockwiseSurfaceGenerator()
+{
+}
+
+vtkSmartPointer<vtkPolyData> mitk::BlockwiseSurfaceGenerator::Generate(Image *image) const
+{
+  if (nullptr == image || 3 != image->GetDimension())
+    mitkThrow() << "BlockwiseSurfaceGenerator requires a 3D image.";
+
+  vtkImageData *vtkImage = image->GetVtkImageData(0);
+
+  if (nullptr == vtkImage || 1 != vtkImage->GetNumberOfScalarComponents())
+    mitkThrow() << "BlockwiseSurfaceGenerator requires an image with scalar pixels.";
+
+  VolumeInfo volume;
+  volume.Scalars = static_cast<char *>(vtkImage->GetScalarPointer());
+  volume.ScalarType = vtkImage->GetScalarType();
+  volume.ScalarSize = vtkImage->GetScalarSize();
+  vtkImage->GetDimensions(volume.Dimensions);
+  vtkImage->GetSpacing(volume.Spacing);
+
+  // neighboring blocks share one slice
+  const int numberOfBlocks =
+    0 == m_BlockSize ? 1 : std::max(1, (volume.Dimensions[2] - 2) / static_cast<int>(m_BlockSize) + 1);
+
+  if (1 == numberOfBlocks)
+    return ComputeNormals(GenerateSurfaceInOnePiece(image, m_Threshold, m_Decimation, m_SmoothingIterations));
+
+  std::vector<vtkSmartPointer<vtkPolyData>> blockSurfaces(numberOfBlocks);
+
+  auto multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfBlocks,
+    [&](itk::SizeValueType block) {
+      const int firstSlice = static_cast<int>(block * m_BlockSize);
+      const int lastSlice = std::min(firstSlice + static_cast<int>(m_BlockSize), volume.Dimensions[2] - 1);
+      blockSurfaces[block] =
+        GenerateBlockSurface(volume, firstSlice, lastSlice, m_Threshold, m_Decimation, m_SmoothingIterations);
+    },
+    nullptr);
+
+  // stitch the blocks, the vertices on common slices are identical
+  auto append = vtkSmartPointer<vtkAppendPolyData>::New();
+  for (const auto &blockSurface : blockSurfaces)
+    append->AddInputData(blockSurface);
+
+  auto cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+  cleaner->SetInputConnection(append->GetOutputPort());
+  cleaner->SetTolerance(0.0);
+  cleaner->PointMergingOn();
+  cleaner->ConvertLinesToPointsOff();
+  cleaner->ConvertPolysToLinesOff();
+  cleaner->ConvertStripsToPolysOff();
+  cleaner->Update();
+
+  vtkSmartPointer<vtkPolyData> polyData = cleaner->GetOutput();
+
+  // transformation from the spacing scaled index coordinates to world coordinates
+  if (polyData->GetNumberOfPoints() > 0)
+  {
+    const mitk::Vector3D spacing = image->GetGeometry()->GetSpacing();
+
+    auto vtkmatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    image->GetGeometry()->GetVtkTransform()->GetMatrix(vtkmatrix);
+    double(*matrix)[4] = vtkmatrix->Element;
+
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        matrix[i][j] /= spacing[j];
+
+    vtkPoints *points = polyData->GetPoints();
+    const vtkIdType n = points->GetNumberOfPoints();
+    double point[3];
+
+    for (vtkIdType i = 0; i < n; ++i)
+    {
+      points->GetPoint(i, point);
+      mitkVtkLinearTransformPoint(matrix, point, point);
+      points->SetPoint(i, point);
+    }
+  }
+
+  return ComputeNormals(polyData);
+}
@@ -0,0 +1,79 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkBlockwiseSurfaceGenerator_h_Included
+#define mitkBlockwiseSurfaceGenerator_h_Included
+
+#include "mitkImage.h"
+#include <MitkSegmentationExports.h>
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+namespace mitk
+{
+  /**
+   * \brief Generates a smoothed and decimated iso-surface of a 3D image in blocks of slices.
+   *
+   * The image is split into blocks of BlockSize slices along its third axis. Neighboring blocks share
+   * one slice, so the marching cubes surfaces of two blocks meet in exactly the same vertices at their
+   * common slice. Every block is surfaced, smoothed and decimated on its own, in parallel. Smoothing and
+   * decimation keep the vertices on the block borders where they are (vtkSmoothPolyDataFilter without
+   * boundary smoothing, vtkDecimatePro without boundary vertex deletion), so the blocks are stitched into
+   * one watertight mesh by merging coincident points.
+   *
+   * If BlockSize is 0 or the image fits into a single block, the surface is generated in one piece and
+   * decimated by vtkQuadricDecimation, as ShowSegmentationAsSmoothedSurface always did before.
+   *
+   * The resulting surface is given in world coordinates and has point normals.
+   */
+  class MITKSEGMENTATION_EXPORT BlockwiseSurfaceGenerator : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(BlockwiseSurfaceGenerator, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /** Iso value of the surface. */
+    itkSetMacro(Threshold, double);
+    itkGetConstMacro(Threshold, double);
+
+    /** Target reduction of the decimation in [0, 1). A value of 0 disables decimation. */
+    itkSetMacro(Decimation, double);
+    itkGetConstMacro(Decimation, double);
+
+    /** Number of iterations of the surface smoothing. A value of 0 disables smoothing. */
+    itkSetMacro(SmoothingIterations, unsigned int);
+    itkGetConstMacro(SmoothingIterations, unsigned int);
+
+    /** Number of slices per block. 0 generates the surface in one piece. */
+    itkSetMacro(BlockSize, unsigned int);
+    itkGetConstMacro(BlockSize, unsigned int);
+
+    /**
+     * \brief Generates the surface of the first time step of a 3D image.
+     * \pre image is a 3D image with scalar pixels.
+     */
+    vtkSmartPointer<vtkPolyData> Generate(Image *image) const;
+
+  protected:
+    BlockwiseSurfaceGenerator();
+    ~BlockwiseSurfaceGenerator() override;
+
+  private:
+    double m_Threshold;
+    double m_Decimation;
+    unsigned int m_SmoothingIterations;
+    unsigned int m_BlockSize;
+  };
+}
+
+#endif
@@ -0,0 +1,321 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkIncrementalRegionGrower_h_Included
+#define mitkIncrementalRegionGrower_h_Included
+
+#include <itkImage.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace mitk
+{
+  /** \brief Common base of all IncrementalRegionGrower types, so that tools can keep one of any pixel type. */
+  class IncrementalRegionGrowerBase
+  {
+  public:
+    virtual ~IncrementalRegionGrowerBase() = default;
+  };
+
+  /**
+   * \brief Connected threshold region growing that only touches the grown region and its border.
+   *
+   * Grows the region of all pixels that are face connected to the seed and whose values lie inside of a
+   * threshold window, like itk::ConnectedThresholdImageFilter. Instead of processing the whole image, a
+   * queue based scanline flood fill visits only the pixels of the region and its direct neighbors.
+   *
+   * The state of the pixels is kept between calls of Update(), so that interactive tools can change the
+   * threshold window continuously:
+   * - If the window is widened, growing continues from the rejected border pixels of the current region.
+   * - Otherwise (narrowed or shifted window), the region is filled again from the seed. Only the pixels
+   *   touched before are reset, so the costs stay proportional to the size of the region.
+   *
+   * Works for images of any dimension, the scanlines run along the first axis.
+   *
+   * \warning The grower references the pixel buffer of the image, which must neither change nor be
+   * released while it is used.
+   */
+  template <typename TImage>
+  class IncrementalRegionGrower : public IncrementalRegionGrowerBase
+  {
+  public:
+    using ImageType = TImage;
+    using PixelType = typename ImageType::PixelType;
+    using IndexType = typename ImageType::IndexType;
+    using RegionType = typename ImageType::RegionType;
+    static constexpr unsigned int ImageDimension = ImageType::ImageDimension;
+
+    IncrementalRegionGrower() : m_SeedOffset(0), m_Lower(0), m_Upper(0), m_NumberOfPixels(0) {}
+
+    /** Sets the image and the seed and discards the current region. */
+    void Initialize(const ImageType *image, const IndexType &seed)
+    {
+      m_Buffer = image->GetBufferPointer();
+      m_BufferedRegion = image->GetBufferedRegion();
+
+      itk::OffsetValueType stride = 1;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        m_Size[d] = static_cast<itk::OffsetValueType>(m_BufferedRegion.GetSize(d));
+        m_Strides[d] = stride;
+        stride *= m_Size[d];
+      }
+
+      m_State.assign(static_cast<std::size_t>(stride), Unvisited);
+      m_Touched.clear();
+      m_Frontier.clear();
+      m_NumberOfPixels = 0;
+      m_HasRegion = false;
+
+      m_Seed = seed;
+      m_SeedOffset = m_BufferedRegion.IsInside(seed) ? this->ComputeOffset(seed) : -1;
+    }
+
+    /** Was the grower initialized with the pixel buffer of this image and this seed? */
+    bool IsInitialized(const ImageType *image, const IndexType &seed) const
+    {
+      return nullptr != m_Buffer && image->GetBufferPointer() == m_Buffer &&
+             image->GetBufferedRegion() == m_BufferedRegion && seed == m_Seed;
+    }
+
+    /** Grows the region for the threshold window [lower, upper]. */
+    void Update(PixelType lower, PixelType upper)
+    {
+      if (nullptr == m_Buffer)
+        return;
+
+      const bool widened = m_HasRegion && 0 < m_NumberOfPixels && lower <= m_Lower && m_Upper <= upper;
+
+      m_Lower = lower;
+      m_Upper = upper;
+      m_HasRegion = true;
+
+      std::vector<itk::OffsetValueType> queue;
+
+      if (widened)
+      {
+        // continue from the border pixels that are inside of the window now
+        std::vector<itk::OffsetValueType> frontier;
+        frontier.swap(m_Frontier);
+
+        for (auto offset : frontier)
+        {
+          if (Rejected != m_State[offset])
+            continue;
+
+          if (this->IsInWindow(offset))
+            queue.push_back(offset);
+          else
+            m_Frontier.push_back(offset);
+        }
+      }
+      else
+      {
+        this->Reset();
+
+        if (0 <= m_SeedOffset && this->IsInWindow(m_SeedOffset))
+          queue.push_back(m_SeedOffset);
+      }
+
+      this->Fill(queue);
+    }
+
+    /** Number of pixels of the region. */
+    std::size_t GetNumberOfPixels() const { return m_NumberOfPixels; }
+
+    bool IsInside(const IndexType &index) const
+    {
+      return m_BufferedRegion.IsInside(index) && Inside == m_State[this->ComputeOffset(index)];
+    }
+
+    /** Smallest region that contains all pixels of the region (size 0 if the region is empty). */
+    RegionType GetBoundingBox() const
+    {
+      RegionType boundingBox;
+      if (0 == m_NumberOfPixels)
+        return boundingBox;
+
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        boundingBox.SetIndex(d, m_BufferedRegion.GetIndex(d) + m_Min[d]);
+        boundingBox.SetSize(d, static_cast<itk::SizeValueType>(m_Max[d] - m_Min[d] + 1));
+      }
+      return boundingBox;
+    }
+
+  private:
+    enum PixelState : unsigned char
+    {
+      Unvisited = 0,
+      Inside,
+      Rejected // outside of the window, but a neighbor of the region
+    };
+
+    itk::OffsetValueType ComputeOffset(const IndexType &index) const
+    {
+      itk::OffsetValueType offset = 0;
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+        offset += (index[d] - m_BufferedRegion.GetIndex(d)) * m_Strides[d];
+      return offset;
+    }
+
+    itk::OffsetValueType GetCoordinate(itk::OffsetValueType offset, unsigned int d) const
+    {
+      return (offset / m_Strides[d]) % m_Size[d];
+    }
+
+    bool IsInWindow(itk::OffsetValueType offset) const
+    {
+      const PixelType value = m_Buffer[offset];
+      return m_Lower <= value && value <= m_Upper;
+    }
+
+    void Reset()
+    {
+      for (auto offset : m_Touched)
+        m_State[offset] = Unvisited;
+
+      m_Touched.clear();
+      m_Frontier.clear();
+      m_NumberOfPixels = 0;
+    }
+
+    void Reject(itk::OffsetValueType offset)
+    {
+      if (Unvisited != m_State[offset])
+        return;
+
+      m_State[offset] = Rejected;
+      m_Touched.push_back(offset);
+      m_Frontier.push_back(offset);
+    }
+
+    /** Can the pixel be added to the region? Rejected pixels are checked again, the window might have grown. */
+    bool IsCandidate(itk::OffsetValueType offset) const
+    {
+      return Inside != m_State[offset] && this->IsInWindow(offset);
+    }
+
+    void Fill(std::vector<itk::OffsetValueType> &queue)
+    {
+      while (!queue.empty())
+      {
+        const auto offset = queue.back();
+        queue.pop_back();
+
+        if (!this->IsCandidate(offset))
+          continue;
+
+        // expand the span along the scanline
+        const auto lineStart = offset - this->GetCoordinate(offset, 0);
+        auto begin = offset - lineStart;
+        auto end = begin + 1;
+
+        while (0 < begin && this->IsCandidate(lineStart + begin - 1))
+          --begin;
+        while (end < m_Size[0] && this->IsCandidate(lineStart + end))
+          ++end;
+
+        if (0 < begin && Inside != m_State[lineStart + begin - 1])
+          this->Reject(lineStart + begin - 1);
+        if (end < m_Size[0] && Inside != m_State[lineStart + end])
+          this->Reject(lineStart + end);
+
+        for (auto x = begin; x < end; ++x)
+        {
+          if (Unvisited == m_State[lineStart + x])
+            m_Touched.push_back(lineStart + x);
+          m_State[lineStart + x] = Inside;
+        }
+        this->AddToBoundingBox(lineStart, begin, end);
+        m_NumberOfPixels += static_cast<std::size_t>(end - begin);
+
+        // queue one pixel per run of candidates in the neighboring scanlines
+        for (unsigned int d = 1; d < ImageDimension; ++d)
+        {
+          const auto coordinate = this->GetCoordinate(lineStart, d);
+
+          for (int direction = -1; direction <= 1; direction += 2)
+          {
+            if (coordinate + direction < 0 || coordinate + direction >= m_Size[d])
+              continue;
+
+            const auto neighborLineStart = lineStart + direction * m_Strides[d];
+            bool inRun = false;
+
+            for (auto x = begin; x < end; ++x)
+            {
+              const auto neighbor = neighborLineStart + x;
+
+              if (Inside == m_State[neighbor])
+              {
+                inRun = false;
+              }
+              else if (this->IsInWindow(neighbor))
+              {
+                if (!inRun)
+                  queue.push_back(neighbor);
+                inRun = true;
+              }
+              else
+              {
+                this->Reject(neighbor);
+                inRun = false;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    void AddToBoundingBox(itk::OffsetValueType lineStart, itk::OffsetValueType begin, itk::OffsetValueType end)
+    {
+      itk::OffsetValueType lineMin[ImageDimension];
+      itk::OffsetValueType lineMax[ImageDimension];
+
+      lineMin[0] = begin;
+      lineMax[0] = end - 1;
+      for (unsigned int d = 1; d < ImageDimension; ++d)
+        lineMin[d] = lineMax[d] = this->GetCoordinate(lineStart, d);
+
+      for (unsigned int d = 0; d < ImageDimension; ++d)
+      {
+        m_Min[d] = 0 == m_NumberOfPixels ? lineMin[d] : std::min(m_Min[d], lineMin[d]);
+        m_Max[d] = 0 == m_NumberOfPixels ? lineMax[d] : std::max(m_Max[d], lineMax[d]);
+      }
+    }
+
+    const PixelType *m_Buffer = nullptr;
+    RegionType m_BufferedRegion;
+    itk::OffsetValueType m_Size[ImageDimension];
+    itk::OffsetValueType m_Strides[ImageDimension];
+
+    IndexType m_Seed;
+    itk::OffsetValueType m_SeedOffset;
+    PixelType m_Lower;
+    PixelType m_Upper;
+    bool m_HasRegion = false;
+
+    std::vector<unsigned char> m_State;
+    /** All pixels that are not Unvisited, to reset them without clearing the whole state buffer. */
+    std::vector<itk::OffsetValueType> m_Touched;
+    /** Rejected pixels, may contain pixels that were added to the region later on. */
+    std::vector<itk::OffsetValueType> m_Frontier;
+
+    std::size_t m_NumberOfPixels;
+    itk::OffsetValueType m_Min[ImageDimension];
+    itk::OffsetValueType m_Max[ImageDimension];
+  };
+}
+
+#endif
@@ -0,0 +1,376 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkOtsuHistogram.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageAccessByItk.h>
+
+#include <itkScalarImageToHistogramGenerator.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  using HistogramType = mitk::OtsuHistogram::HistogramType;
+
+  /** Prefix sums of the histogram, so that the contribution of any class of bins takes constant time. */
+  class ClassTerms
+  {
+  public:
+    explicit ClassTerms(const HistogramType *histogram)
+      : m_Frequencies(histogram->GetSize(0)),
+        m_FrequencySums(histogram->GetSize(0) + 1, 0.0),
+        m_MeasurementSums(histogram->GetSize(0) + 1, 0.0)
+    {
+      for (std::size_t bin = 0; bin < m_Frequencies.size(); ++bin)
+      {
+        const double frequency = histogram->GetFrequency(bin, 0);
+        m_Frequencies[bin] = frequency;
+        m_FrequencySums[bin + 1] = m_FrequencySums[bin] + frequency;
+        m_MeasurementSums[bin + 1] = m_MeasurementSums[bin] + frequency * histogram->GetMeasurement(bin, 0);
+      }
+
+      m_TotalFrequency = m_FrequencySums.back();
+    }
+
+    std::size_t GetNumberOfBins() const { return m_Frequencies.size(); }
+
+    double GetTotalFrequency() const { return m_TotalFrequency; }
+
+    /** Frequency of the bin relative to the total frequency. */
+    double GetFrequency(std::size_t bin) const { return m_Frequencies[bin] / m_TotalFrequency; }
+
+    /** Weight times squared mean of the class of bins [first, last], the summand of the between-class variance. */
+    double operator()(std::size_t first, std::size_t last) const
+    {
+      const double frequency = m_FrequencySums[last + 1] - m_FrequencySums[first];
+      if (frequency <= 0.0)
+        return 0.0;
+
+      const double measurement = m_MeasurementSums[last + 1] - m_MeasurementSums[first];
+      return measurement * measurement / (frequency * m_TotalFrequency);
+    }
+
+  private:
+    std::vector<double> m_Frequencies;
+    std::vector<double> m_FrequencySums;
+    std::vector<double> m_MeasurementSums;
+    double m_TotalFrequency;
+  };
+
+  using ThresholdBinsType = std::vector<std::size_t>;
+
+  /** Between-class variance of the thresholds, weighted by the valley emphasis factor if requested. */
+  double ComputeObjective(const ClassTerms &terms, const ThresholdBinsType &thresholdBins, bool valleyEmphasis)
+  {
+    double variance = 0.0;
+    double thresholdFrequency = 0.0;
+    std::size_t first = 0;
+
+    for (auto bin : thresholdBins)
+    {
+      variance += terms(first, bin);
+      thresholdFrequency += terms.GetFrequency(bin);
+      first = bin + 1;
+    }
+
+    variance += terms(first, terms.GetNumberOfBins() - 1);
+
+    return valleyEmphasis ? variance * (1.0 - thresholdFrequency) : variance;
+  }
+
+  /**
+   * Threshold bins that maximize the between-class variance minus penalty times the frequencies of the threshold
+   * bins. best[j][t] is the best value of the classes up to threshold j, if threshold j lies at bin t.
+   */
+  ThresholdBinsType MaximizePenalizedVariance(const ClassTerms &terms, std::size_t numberOfThresholds, double penalty)
+  {
+    const std::size_t lastThresholdBin = terms.GetNumberOfBins() - 2;
+
+    std::vector<std::vector<double>> best(numberOfThresholds, std::vector<double>(lastThresholdBin + 1));
+    std::vector<std::vector<std::size_t>> previousBins(numberOfThresholds,
+                                                       std::vector<std::size_t>(lastThresholdBin + 1, 0));
+
+    for (std::size_t t = 0; t <= lastThresholdBin; ++t)
+      best[0][t] = terms(0, t) - penalty * terms.GetFrequency(t);
+
+    for (std::size_t j = 1; j < numberOfThresholds; ++j)
+    {
+      for (std::size_t t = j; t <= lastThresholdBin; ++t)
+      {
+        double bestValue = -std::numeric_limits<double>::max();
+
+        for (std::size_t s = j - 1; s < t; ++s)
+        {
+          const double value = best[j - 1][s] + terms(s + 1, t);
+          if (value > bestValue)
+          {
+            bestValue = value;
+            previousBins[j][t] = s;
+          }
+        }
+
+        best[j][t] = bestValue - penalty * terms.GetFrequency(t);
+      }
+    }
+
+    ThresholdBinsType thresholdBins(numberOfThresholds);
+    double bestValue = -std::numeric_limits<double>::max();
+
+    for (std::size_t t = numberOfThresholds - 1; t <= lastThresholdBin; ++t)
+    {
+      const double value = best[numberOfThresholds - 1][t] + terms(t + 1, lastThresholdBin + 1);
+      if (value > bestValue)
+      {
+        bestValue = value;
+        thresholdBins.back() = t;
+      }
+    }
+
+    for (std::size_t j = numberOfThresholds - 1; j > 0; --j)
+      thresholdBins[j - 1] = previousBins[j][thresholdBins[j]];
+
+    return thresholdBins;
+  }
+
+  /** Partial partition of the bins into classes, the last class ends at a threshold bin. */
+  struct Candidate
+  {
+    double ThresholdFrequency;
+    double Variance;
+    std::size_t PreviousBin;
+    std::size_t PreviousCandidate;
+  };
+
+  /**
+   * Threshold bins that maximize the between-class variance times (1 - frequencies of the threshold bins).
+   * fronts[j][t] keeps the candidates for threshold j at bin t that are not dominated by another candidate,
+   * i.e. sorted by ascending threshold frequency with ascending variance. Candidates that cannot beat the best
+   * known partition even with the best possible remaining classes are dropped.
+   */
+  ThresholdBinsType MaximizeValleyEmphasizedVariance(const ClassTerms &terms, std::size_t numberOfThresholds)
+  {
+    const std::size_t lastThresholdBin = terms.GetNumberOfBins() - 2;
+
+    // Partitions that trade variance for threshold frequency provide the initial lower bound.
+    ThresholdBinsType bestThresholdBins = MaximizePenalizedVariance(terms, numberOfThresholds, 0.0);
+    const double maximumVariance = ComputeObjective(terms, bestThresholdBins, false);
+    double lowerBound = ComputeObjective(terms, bestThresholdBins, true);
+
+    for (double penalty : {0.5, 1.0, 2.0, 4.0, 8.0})
+    {
+      auto thresholdBins = MaximizePenalizedVariance(terms, numberOfThresholds, penalty * maximumVariance);
+      const double objective = ComputeObjective(terms, thresholdBins, true);
+
+      if (objective > lowerBound)
+      {
+        lowerBound = objective;
+        bestThresholdBins = thresholdBins;
+      }
+    }
+
+    // remainingVariance[j][t] is the best variance of the classes after threshold j at bin t
+    std::vector<std::vector<double>> remainingVariance(numberOfThresholds,
+                                                       std::vector<double>(lastThresholdBin + 1, 0.0));
+
+    for (std::size_t t = 0; t <= lastThresholdBin; ++t)
+      remainingVariance[numberOfThresholds - 1][t] = terms(t + 1, lastThresholdBin + 1);
+
+    for (std::size_t j = numberOfThresholds - 1; j > 0; --j)
+    {
+      for (std::size_t t = 0; t <= lastThresholdBin; ++t)
+      {
+        double variance = 0.0;
+        for (std::size_t u = t + 1; u <= lastThresholdBin; ++u)
+          variance = std::max(variance, terms(t + 1, u) + remainingVariance[j][u]);
+
+        remainingVariance[j - 1][t] = variance;
+      }
+    }
+
+    auto isPromising = [&](const Candidate &candidate, std::size_t j, std::size_t t) {
+      return (candidate.Variance + remainingVariance[j][t]) * (1.0 - candidate.ThresholdFrequency) > lowerBound;
+    };
+
+    std::vector<std::vector<std::vector<Candidate>>> fronts(
+      numberOfThresholds, std::vector<std::vector<Candidate>>(lastThresholdBin + 1));
+
+    for (std::size_t t = 0; t <= lastThresholdBin; ++t)
+    {
+      const Candidate candidate = {terms.GetFrequency(t), terms(0, t), 0, 0};
+      if (isPromising(candidate, 0, t))
+        fronts[0][t].push_back(candidate);
+    }
+
+    std::vector<Candidate> candidates;
+
+    for (std::size_t j = 1; j < numberOfThresholds; ++j)
+    {
+      for (std::size_t t = j; t <= lastThresholdBin; ++t)
+      {
+        candidates.clear();
+
+        for (std::size_t s = j - 1; s < t; ++s)
+        {
+          const double classVariance = terms(s + 1, t);
+          const auto &previousFront = fronts[j - 1][s];
+
+          for (std::size_t i = 0; i < previousFront.size(); ++i)
+          {
+            const Candidate candidate = {previousFront[i].ThresholdFrequency + terms.GetFrequency(t),
+                                         previousFront[i].Variance + classVariance,
+                                         s,
+                                         i};
+
+            if (isPromising(candidate, j, t))
+              candidates.push_back(candidate);
+          }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+          return a.ThresholdFrequency < b.ThresholdFrequency ||
+                 (a.ThresholdFrequency == b.ThresholdFrequency && a.Variance > b.Variance);
+        });
+
+        auto &front = fronts[j][t];
+        for (const auto &candidate : candidates)
+        {
+          if (front.empty() || candidate.Variance > front.back().Variance)
+            front.push_back(candidate);
+        }
+      }
+    }
+
+    std::size_t bestBin = 0;
+    std::size_t bestCandidate = 0;
+    bool found = false;
+
+    for (std::size_t t = numberOfThresholds - 1; t <= lastThresholdBin; ++t)
+    {
+      const auto &front = fronts[numberOfThresholds - 1][t];
+
+      for (std::size_t i = 0; i < front.size(); ++i)
+      {
+        const double objective =
+          (front[i].Variance + terms(t + 1, lastThresholdBin + 1)) * (1.0 - front[i].ThresholdFrequency);
+
+        if (objective > lowerBound)
+        {
+          lowerBound = objective;
+          bestBin = t;
+          bestCandidate = i;
+          found = true;
+        }
+      }
+    }
+
+    if (found)
+    {
+      for (std::size_t j = numberOfThresholds; j > 0; --j)
+      {
+        bestThresholdBins[j - 1] = bestBin;
+
+        const auto &candidate = fronts[j - 1][bestBin][bestCandidate];
+        bestBin = candidate.PreviousBin;
+        bestCandidate = candidate.PreviousCandidate;
+      }
+    }
+
+    return bestThresholdBins;
+  }
+}
+
+mitk::OtsuHistogram::OtsuHistogram() : m_NumberOfBins(128)
+{
+}
+
+mitk::OtsuHistogram::~OtsuHistogram()
+{
+}
+
+void mitk::OtsuHistogram::Initialize(const Image *image)
+{
+  if (nullptr == image)
+    mitkThrow() << "OtsuHistogram requires an image.";
+
+  AccessByItk(image, ComputeHistogram);
+  this->Modified();
+}
+
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::OtsuHistogram::ComputeHistogram(const itk::Image<TPixel, VImageDimension> *image)
+{
+  using GeneratorType = itk::Statistics::ScalarImageToHistogramGenerator<itk::Image<TPixel, VImageDimension>>;
+
+  auto generator = GeneratorType::New();
+  generator->SetInput(image);
+  generator->SetNumberOfBins(m_NumberOfBins);
+  generator->Compute();
+
+  m_Histogram = generator->GetOutput();
+}
+
+void mitk::OtsuHistogram::SetHistogram(const HistogramType *histogram)
+{
+  if (histogram == m_Histogram)
+    return;
+
+  m_Histogram = histogram;
+
+  if (nullptr != histogram)
+    m_NumberOfBins = static_cast<unsigned int>(histogram->GetSize(0));
+
+  this->Modified();
+}
+
+const mitk::OtsuHistogram::HistogramType *mitk::OtsuHistogram::GetHistogram() const
+{
+  return m_Histogram;
+}
+
+mitk::OtsuHistogram::ThresholdsType mitk::OtsuHistogram::ComputeThresholds(unsigned int numberOfThresholds,
+                                                                           bool valleyEmphasis) const
+{
+  return ComputeThresholds(m_Histogram, numberOfThresholds, valleyEmphasis);
+}
+
+mitk::OtsuHistogram::ThresholdsType mitk::OtsuHistogram::ComputeThresholds(const HistogramType *histogram,
+                                                                           unsigned int numberOfThresholds,
+                                                                           bool valleyEmphasis)
+{
+  if (nullptr == histogram)
+    mitkThrow() << "OtsuHistogram has to be initialized before thresholds can be computed.";
+
+  if (histogram->GetSize(0) <= numberOfThresholds)
+    mitkThrow() << "OtsuHistogram cannot compute " << numberOfThresholds << " thresholds from "
+                << histogram->GetSize(0) << " bins.";
+
+  ThresholdsType thresholds;
+
+  if (0 == numberOfThresholds)
+    return thresholds;
+
+  const ClassTerms terms(histogram);
+
+  if (terms.GetTotalFrequency() <= 0.0)
+    mitkThrow() << "OtsuHistogram cannot compute thresholds of an empty histogram.";
+
+  const auto thresholdBins = valleyEmphasis ? MaximizeValleyEmphasizedVariance(terms, numberOfThresholds)
+                                            : MaximizePenalizedVariance(terms, numberOfThresholds, 0.0);
+
+  for (auto bin : thresholdBins)
+    thresholds.push_back(histogram->GetBinMax(0, bin));
+
+  return thresholds;
+}
@@ -0,0 +1,93 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkOtsuHistogram_h_Included
+#define mitkOtsuHistogram_h_Included
+
+#include "mitkImage.h"
+#include <MitkSegmentationExports.h>
+
+#include <itkHistogram.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * \brief Histogram of an image and the multiple Otsu thresholds that can be derived from it.
+   *
+   * Initialize() computes the histogram once, like itk::OtsuMultipleThresholdsImageFilter does. Afterwards,
+   * thresholds for any number of classes, with or without valley emphasis, are computed from the histogram
+   * alone, so changing these parameters does not touch the image again.
+   *
+   * Instead of trying all combinations of threshold bins like itk::OtsuMultipleThresholdsCalculator, the
+   * thresholds are found by dynamic programming over the bins: the best partition of the bins up to a bin
+   * into j classes only depends on the best partitions into j - 1 classes. This takes O(L^2 * k) for L bins
+   * and k thresholds. Valley emphasis weights the whole between-class variance by the frequencies of all
+   * threshold bins, so partitions with different threshold frequencies cannot be compared early. For it, the
+   * dynamic program keeps all partitions that are not worse in both variance and threshold frequency and
+   * discards those that cannot beat a known partition. The thresholds are the same as those of
+   * itk::OtsuMultipleThresholdsCalculator (up to ties).
+   *
+   * HistogramType is the histogram type of ImageStatisticsContainer, so histograms can be exchanged with the
+   * image statistics.
+   */
+  class MITKSEGMENTATION_EXPORT OtsuHistogram : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(OtsuHistogram, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    using HistogramType = itk::Statistics::Histogram<double>;
+    using ThresholdsType = std::vector<double>;
+
+    /** Number of bins of the histogram computed by Initialize(). */
+    itkSetMacro(NumberOfBins, unsigned int);
+    itkGetConstMacro(NumberOfBins, unsigned int);
+
+    /**
+     * \brief Computes the histogram of the image with NumberOfBins bins between its minimum and maximum.
+     * \pre image is a 2D or 3D image with scalar pixels.
+     */
+    void Initialize(const Image *image);
+
+    /** Uses a histogram that was computed before, e.g. by ImageStatisticsCalculator. */
+    void SetHistogram(const HistogramType *histogram);
+    const HistogramType *GetHistogram() const;
+
+    /**
+     * \brief Thresholds that maximize the between-class variance of the histogram, in ascending order.
+     * Every threshold is the upper bound of a bin. Values up to the first threshold belong to the first class,
+     * values above the last threshold to the last class.
+     * \throw mitk::Exception if there is no histogram or it has not more bins than numberOfThresholds.
+     */
+    ThresholdsType ComputeThresholds(unsigned int numberOfThresholds, bool valleyEmphasis) const;
+
+    /** \sa ComputeThresholds(unsigned int, bool) const */
+    static ThresholdsType ComputeThresholds(const HistogramType *histogram,
+                                            unsigned int numberOfThresholds,
+                                            bool valleyEmphasis);
+
+  protected:
+    OtsuHistogram();
+    ~OtsuHistogram() override;
+
+  private:
+    template <typename TPixel, unsigned int VImageDimension>
+    void ComputeHistogram(const itk::Image<TPixel, VImageDimension> *image);
+
+    unsigned int m_NumberOfBins;
+    HistogramType::ConstPointer m_Histogram;
+  };
+}
+
+#endif
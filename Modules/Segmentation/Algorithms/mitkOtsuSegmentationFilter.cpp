@@ -11,35 +11,33 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkOtsuSegmentationFilter.h"
-#include "itkOtsuMultipleThresholdsImageFilter.h"
+#include "itkThresholdLabelerImageFilter.h"
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 
 struct paramContainer
 {
-  paramContainer(unsigned int numThresholds, bool useValley, unsigned int numBins, mitk::Image::Pointer image)
-    : m_NumberOfThresholds(numThresholds), m_ValleyEmphasis(useValley), m_NumberOfBins(numBins), m_Image(image)
+  paramContainer(const mitk::OtsuHistogram::ThresholdsType &thresholds, mitk::Image::Pointer image)
+    : m_Thresholds(thresholds), m_Image(image)
   {
   }
 
-  unsigned int m_NumberOfThresholds;
-  bool m_ValleyEmphasis;
-  unsigned int m_NumberOfBins;
+  mitk::OtsuHistogram::ThresholdsType m_Thresholds;
   mitk::Image::Pointer m_Image;
 };
 
 template <typename TPixel, unsigned int VImageDimension>
-void AccessItkOtsuFilter(const itk::Image<TPixel, VImageDimension> *itkImage, paramContainer params)
+void AccessItkThresholdLabeler(const itk::Image<TPixel, VImageDimension> *itkImage, paramContainer params)
 {
   typedef itk::Image<TPixel, VImageDimension> itkInputImageType;
   typedef itk::Image<mitk::OtsuSegmentationFilter::OutputPixelType, VImageDimension> itkOutputImageType;
-  typedef itk::OtsuMultipleThresholdsImageFilter<itkInputImageType, itkOutputImageType> OtsuFilterType;
+  typedef itk::ThresholdLabelerImageFilter<itkInputImageType, itkOutputImageType> LabelerType;
 
-  typename OtsuFilterType::Pointer filter = OtsuFilterType::New();
-  filter->SetNumberOfThresholds(params.m_NumberOfThresholds);
+  typename LabelerType::Pointer filter = LabelerType::New();
   filter->SetInput(itkImage);
-  filter->SetValleyEmphasis(params.m_ValleyEmphasis);
-  filter->SetNumberOfHistogramBins(params.m_NumberOfBins);
+  filter->SetRealThresholds(
+    typename LabelerType::RealThresholdVector(params.m_Thresholds.begin(), params.m_Thresholds.end()));
+  filter->SetLabelOffset(0);
 
   try
   {
@@ -47,7 +45,7 @@ void AccessItkOtsuFilter(const itk::Image<TPixel, VImageDimension> *itkImage, pa
   }
   catch (...)
   {
-    mitkThrow() << "itkOtsuFilter error.";
+    mitkThrow() << "itkThresholdLabeler error.";
   }
 
   mitk::CastToMitkImage<itkOutputImageType>(filter->GetOutput(), params.m_Image);
@@ -62,11 +60,42 @@ namespace mitk
   }
 
   OtsuSegmentationFilter::~OtsuSegmentationFilter() {}
+
+  void OtsuSegmentationFilter::SetHistogram(const OtsuHistogram *histogram)
+  {
+    if (histogram == m_Histogram)
+      return;
+
+    m_Histogram = histogram;
+    m_HistogramInput = nullptr;
+    this->Modified();
+  }
+
+  const OtsuHistogram *OtsuSegmentationFilter::GetHistogram() const
+  {
+    return m_Histogram;
+  }
+
   void OtsuSegmentationFilter::GenerateData()
   {
     mitk::Image::ConstPointer mitkImage = GetInput();
-    AccessByItk_n(mitkImage,
-                  AccessItkOtsuFilter,
-                  (paramContainer(m_NumberOfThresholds, m_ValleyEmphasis, m_NumberOfBins, this->GetOutput())));
+
+    // histograms computed by the filter itself are only valid for the unmodified input
+    const bool inputChanged = m_HistogramInput.IsNotNull() &&
+                              (m_HistogramInput != mitkImage || m_HistogramInputMTime != mitkImage->GetMTime());
+
+    if (m_Histogram.IsNull() || m_Histogram->GetNumberOfBins() != m_NumberOfBins || inputChanged)
+    {
+      auto histogram = OtsuHistogram::New();
+      histogram->SetNumberOfBins(m_NumberOfBins);
+      histogram->Initialize(mitkImage);
+      m_Histogram = histogram;
+      m_HistogramInput = mitkImage;
+      m_HistogramInputMTime = mitkImage->GetMTime();
+    }
+
+    const auto thresholds = m_Histogram->ComputeThresholds(m_NumberOfThresholds, m_ValleyEmphasis);
+
+    AccessByItk_n(mitkImage, AccessItkThresholdLabeler, (paramContainer(thresholds, this->GetOutput())));
   }
 }
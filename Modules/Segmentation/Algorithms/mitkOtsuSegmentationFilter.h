@@ -17,6 +17,7 @@ found in the LICENSE file.
 #include "mitkITKImageImport.h"
 #include "mitkImage.h"
 #include "mitkImageToImageFilter.h"
+#include "mitkOtsuHistogram.h"
 
 #include "itkImage.h"
 
@@ -29,7 +30,9 @@ namespace mitk
 
     This class being an mitk::ImageToImageFilter performs a multiple threshold otsu image segmentation based on the
     image histogram.
-    Internally, the itk::OtsuMultipleThresholdsImageFilter is used.
+    The thresholds are computed by mitk::OtsuHistogram, the image is labeled by the itk::ThresholdLabelerImageFilter.
+    The histogram of the input is kept, so that an update with another number of thresholds or valley emphasis only
+    searches the thresholds again. A histogram of the input that was computed before can be set as well.
 
     $Author: somebody$
   */
@@ -53,9 +56,15 @@ namespace mitk
         return;
       }
       m_NumberOfThresholds = number;
+      this->Modified();
+    }
+
+    void SetValleyEmphasis(bool useValley)
+    {
+      m_ValleyEmphasis = useValley;
+      this->Modified();
     }
 
-    void SetValleyEmphasis(bool useValley) { m_ValleyEmphasis = useValley; }
     void SetNumberOfBins(unsigned int number)
     {
       if (number < 1)
@@ -64,8 +73,15 @@ namespace mitk
         return;
       }
       m_NumberOfBins = number;
+      this->Modified();
     }
 
+    /** \brief Histogram of the input with NumberOfBins bins. It is computed during the update if it is not set
+      * or its number of bins differs. The caller is responsible that a set histogram belongs to the input.
+      */
+    void SetHistogram(const OtsuHistogram *histogram);
+    const OtsuHistogram *GetHistogram() const;
+
   protected:
     OtsuSegmentationFilter();
     ~OtsuSegmentationFilter() override;
@@ -76,6 +92,10 @@ namespace mitk
     unsigned int m_NumberOfThresholds;
     bool m_ValleyEmphasis;
     unsigned int m_NumberOfBins;
+    OtsuHistogram::ConstPointer m_Histogram;
+    /** Input the histogram was computed for by the filter, nullptr for a histogram that was set. */
+    Image::ConstPointer m_HistogramInput;
+    itk::ModifiedTimeType m_HistogramInputMTime = 0;
 
   }; // class
 
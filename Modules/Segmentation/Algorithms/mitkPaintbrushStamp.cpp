@@ -0,0 +1,345 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkPaintbrushStamp.h"
+
+#include <mitkImageAccessByItk.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkLabelSetImage.h>
+
+#include <vtkImageData.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+  /** Pixels [Begin, End) of a slice row that are covered by a stroke segment. */
+  struct RowSpan
+  {
+    int Begin = std::numeric_limits<int>::max();
+    int End = std::numeric_limits<int>::min();
+  };
+
+  /** Decides which existing pixel values may be overwritten, see mitk::ContourModelUtils::FillSliceInSlice(). */
+  struct PaintRule
+  {
+    enum class Mode
+    {
+      Overwrite,
+      SkipLocked,
+      EraseActive
+    };
+
+    Mode PaintMode = Mode::Overwrite;
+    std::vector<bool> Locked;
+    mitk::Label::PixelType ActiveValue = 0;
+
+    template <typename TPixel>
+    bool IsWritable(TPixel existingValue) const
+    {
+      switch (PaintMode)
+      {
+        case Mode::SkipLocked:
+        {
+          const auto value = static_cast<long long>(existingValue);
+          return value < 0 || value >= static_cast<long long>(Locked.size()) || !Locked[value];
+        }
+        case Mode::EraseActive:
+          return existingValue == static_cast<TPixel>(ActiveValue);
+        default:
+          return true;
+      }
+    }
+  };
+
+  PaintRule CreatePaintRule(const mitk::Image *workingImage, int paintingPixelValue)
+  {
+    PaintRule rule;
+    auto labelImage = dynamic_cast<const mitk::LabelSetImage *>(workingImage);
+    if (nullptr == labelImage)
+      return rule;
+
+    const auto activeLayer = labelImage->GetActiveLayer();
+    if (paintingPixelValue == labelImage->GetExteriorLabel()->GetValue())
+    {
+      rule.PaintMode = PaintRule::Mode::EraseActive;
+      rule.ActiveValue = labelImage->GetActiveLabel(activeLayer)->GetValue();
+      return rule;
+    }
+
+    rule.PaintMode = PaintRule::Mode::SkipLocked;
+    auto labelSet = labelImage->GetLabelSet(activeLayer);
+    for (auto it = labelSet->IteratorConstBegin(); it != labelSet->IteratorConstEnd(); ++it)
+    {
+      if (it->second->GetLocked())
+      {
+        if (rule.Locked.size() <= it->first)
+          rule.Locked.resize(it->first + 1, false);
+        rule.Locked[it->first] = true;
+      }
+    }
+    return rule;
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void PaintRowSpans(itk::Image<TPixel, VImageDimension> *slice,
+                     const std::vector<RowSpan> &rows,
+                     int firstRow,
+                     const PaintRule &rule,
+                     int paintingPixelValue)
+  {
+    const auto width = static_cast<int>(slice->GetLargestPossibleRegion().GetSize(0));
+    const auto value = static_cast<TPixel>(paintingPixelValue);
+    TPixel *buffer = slice->GetBufferPointer();
+
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      TPixel *row = buffer + static_cast<std::size_t>(firstRow + static_cast<int>(i)) * width;
+      for (int x = rows[i].Begin; x < rows[i].End; ++x)
+      {
+        if (rule.IsWritable(row[x]))
+          row[x] = value;
+      }
+    }
+  }
+
+  mitk::PaintbrushStamp::MaskType ComputeMask(int size)
+  {
+    // Same criterion as the brush contour of the PaintbrushTool: a pixel belongs to the brush if its center lies
+    // within the circle of diameter size around the brush center. For even sizes the center is shifted by half a
+    // pixel, so the pixel the mouse points to is the upper left one of the central four.
+    const double center = size % 2 == 0 ? 0.5 : 0.0;
+    const double squaredRadius = 0.25 * size * size;
+
+    mitk::PaintbrushStamp::MaskType mask;
+    for (int y = -size; y <= size; ++y)
+    {
+      mitk::PaintbrushStamp::Span span = {y, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()};
+      for (int x = -size; x <= size; ++x)
+      {
+        if ((x - center) * (x - center) + (y - center) * (y - center) <= squaredRadius)
+        {
+          span.Begin = std::min(span.Begin, x);
+          span.End = std::max(span.End, x + 1);
+        }
+      }
+      if (span.Begin < span.End)
+        mask.push_back(span);
+    }
+    return mask;
+  }
+}
+
+mitk::PaintbrushStamp::PaintbrushStamp() : m_Size(0), m_Mask(nullptr)
+{
+  this->SetSize(1);
+  this->ResetDirtyRegion();
+}
+
+mitk::PaintbrushStamp::~PaintbrushStamp()
+{
+}
+
+const mitk::PaintbrushStamp::MaskType &mitk::PaintbrushStamp::GetMaskOfSize(int size)
+{
+  static std::mutex mutex;
+  static std::map<int, std::unique_ptr<MaskType>> masks;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &mask = masks[size];
+  if (nullptr == mask)
+    mask.reset(new MaskType(ComputeMask(size)));
+  return *mask;
+}
+
+void mitk::PaintbrushStamp::SetSize(int size)
+{
+  size = std::max(1, size);
+  if (size == m_Size)
+    return;
+
+  m_Size = size;
+  m_Mask = &GetMaskOfSize(size);
+  this->Modified();
+}
+
+const mitk::PaintbrushStamp::MaskType &mitk::PaintbrushStamp::GetMask() const
+{
+  return *m_Mask;
+}
+
+bool mitk::PaintbrushStamp::IsDirty() const
+{
+  return m_DirtyRegion.GetNumberOfPixels() > 0;
+}
+
+void mitk::PaintbrushStamp::ResetDirtyRegion()
+{
+  m_DirtyRegion = RegionType();
+}
+
+mitk::PaintbrushStamp::RegionType mitk::PaintbrushStamp::Paint(
+  Image *slice, const Image *workingImage, const IndexType &from, const IndexType &to, int paintingPixelValue)
+{
+  if (nullptr == slice || slice->GetDimension() != 2)
+    mitkThrow() << "PaintbrushStamp can only paint into 2D slices.";
+
+  const auto &mask = *m_Mask;
+  const int width = static_cast<int>(slice->GetDimension(0));
+  const int height = static_cast<int>(slice->GetDimension(1));
+
+  // Union of the stamps at all positions of the Bresenham line. The brush is convex and every mask row contains
+  // the central column, so the stamps of neighbouring line positions overlap and each row of the union is one span.
+  const int firstRow = static_cast<int>(std::min(from[1], to[1])) + mask.front().Row;
+  const int lastRow = static_cast<int>(std::max(from[1], to[1])) + mask.back().Row;
+  std::vector<RowSpan> rows(lastRow - firstRow + 1);
+
+  int x = static_cast<int>(from[0]);
+  int y = static_cast<int>(from[1]);
+  const int endX = static_cast<int>(to[0]);
+  const int endY = static_cast<int>(to[1]);
+  const int dx = std::abs(endX - x);
+  const int dy = -std::abs(endY - y);
+  const int stepX = x < endX ? 1 : -1;
+  const int stepY = y < endY ? 1 : -1;
+  int error = dx + dy;
+
+  while (true)
+  {
+    for (const auto &span : mask)
+    {
+      auto &row = rows[y + span.Row - firstRow];
+      row.Begin = std::min(row.Begin, x + span.Begin);
+      row.End = std::max(row.End, x + span.End);
+    }
+
+    if (x == endX && y == endY)
+      break;
+
+    const int doubledError = 2 * error;
+    if (doubledError >= dy)
+    {
+      error += dy;
+      x += stepX;
+    }
+    if (doubledError <= dx)
+    {
+      error += dx;
+      y += stepY;
+    }
+  }
+
+  // clip to the slice
+  const int firstVisibleRow = std::max(firstRow, 0);
+  const int lastVisibleRow = std::min(lastRow, height - 1);
+  if (firstVisibleRow > lastVisibleRow)
+    return RegionType();
+
+  std::vector<RowSpan> visibleRows(rows.begin() + (firstVisibleRow - firstRow), rows.begin() + (lastVisibleRow - firstRow + 1));
+  int minX = width;
+  int maxX = -1;
+  for (auto &row : visibleRows)
+  {
+    row.Begin = std::max(row.Begin, 0);
+    row.End = std::min(row.End, width);
+    if (row.Begin < row.End)
+    {
+      minX = std::min(minX, row.Begin);
+      maxX = std::max(maxX, row.End - 1);
+    }
+  }
+  if (minX > maxX)
+    return RegionType();
+
+  const auto rule = CreatePaintRule(workingImage, paintingPixelValue);
+  AccessFixedDimensionByItk_n(slice, PaintRowSpans, 2, (visibleRows, firstVisibleRow, rule, paintingPixelValue));
+
+  slice->GetVtkImageData()->Modified();
+  slice->Modified();
+
+  RegionType::IndexType regionIndex = {{minX, firstVisibleRow}};
+  RegionType::SizeType regionSize = {{static_cast<RegionType::SizeValueType>(maxX - minX + 1),
+                                      static_cast<RegionType::SizeValueType>(lastVisibleRow - firstVisibleRow + 1)}};
+  RegionType region(regionIndex, regionSize);
+
+  if (this->IsDirty())
+  {
+    RegionType::IndexType dirtyIndex;
+    RegionType::SizeType dirtySize;
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      const auto begin = std::min(m_DirtyRegion.GetIndex(i), region.GetIndex(i));
+      const auto end = std::max(m_DirtyRegion.GetUpperIndex()[i], region.GetUpperIndex()[i]);
+      dirtyIndex[i] = begin;
+      dirtySize[i] = static_cast<RegionType::SizeValueType>(end - begin + 1);
+    }
+    m_DirtyRegion = RegionType(dirtyIndex, dirtySize);
+  }
+  else
+  {
+    m_DirtyRegion = region;
+  }
+
+  return region;
+}
+
+mitk::Image::Pointer mitk::PaintbrushStamp::ExtractRegion(const Image *slice, const RegionType &region)
+{
+  if (nullptr == slice || slice->GetDimension() != 2)
+    mitkThrow() << "PaintbrushStamp can only extract regions of 2D slices.";
+
+  const auto width = slice->GetDimension(0);
+  RegionType sliceRegion;
+  sliceRegion.SetSize(0, width);
+  sliceRegion.SetSize(1, slice->GetDimension(1));
+  if (0 == region.GetNumberOfPixels() || !sliceRegion.IsInside(region))
+    mitkThrow() << "Region " << region << " is not inside of the slice.";
+
+  // geometry of the region: the index of an image geometry is the pixel center
+  auto planeGeometry = slice->GetSlicedGeometry()->GetPlaneGeometry(0)->Clone();
+  Point3D regionIndex;
+  FillVector3D(regionIndex, region.GetIndex(0), region.GetIndex(1), 0);
+  Point3D regionOrigin;
+  planeGeometry->IndexToWorld(regionIndex, regionOrigin);
+  planeGeometry->SetOrigin(regionOrigin);
+
+  BoundingBox::BoundsArrayType bounds;
+  bounds[0] = bounds[2] = bounds[4] = 0;
+  bounds[1] = region.GetSize(0);
+  bounds[3] = region.GetSize(1);
+  bounds[5] = 1;
+  planeGeometry->SetBounds(bounds);
+
+  auto regionSlice = Image::New();
+  regionSlice->Initialize(slice->GetPixelType(), 1, *planeGeometry);
+
+  const auto pixelSize = slice->GetPixelType().GetSize();
+  const auto rowSize = region.GetSize(0) * pixelSize;
+  ImageReadAccessor readAccess(slice);
+  ImageWriteAccessor writeAccess(regionSlice);
+  auto source = static_cast<const char *>(readAccess.GetData());
+  auto target = static_cast<char *>(writeAccess.GetData());
+  for (std::size_t y = 0; y < region.GetSize(1); ++y)
+  {
+    const auto sourceOffset = ((region.GetIndex(1) + y) * width + region.GetIndex(0)) * pixelSize;
+    std::memcpy(target + y * rowSize, source + sourceOffset, rowSize);
+  }
+
+  return regionSlice;
+}
@@ -0,0 +1,100 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkPaintbrushStamp_h_Included
+#define mitkPaintbrushStamp_h_Included
+
+#include "mitkImage.h"
+#include <MitkSegmentationExports.h>
+
+#include <itkImageRegion.h>
+
+namespace mitk
+{
+  /**
+   * \brief Raster paint engine of the PaintbrushTool.
+   *
+   * Paints circular brush stamps directly into the pixel buffer of a 2D working slice. The brush mask is
+   * precomputed once per brush size as one span per row. A stroke segment between two mouse positions is
+   * the union of the stamps at all positions of the Bresenham line between them. As the brush is convex,
+   * this union is a single span per row, so every pixel of the segment is written exactly once, without
+   * rasterizing a contour.
+   *
+   * The pixels written are the same ones mitk::ContourModelUtils::FillContourInSlice writes for the brush
+   * contour of the PaintbrushTool, including the handling of locked labels and erasing of LabelSetImages.
+   *
+   * All bounding boxes of painted segments are accumulated in a dirty region until ResetDirtyRegion() is called.
+   */
+  class MITKSEGMENTATION_EXPORT PaintbrushStamp : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(PaintbrushStamp, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    using IndexType = itk::Index<2>;
+    using RegionType = itk::ImageRegion<2>;
+
+    /** Pixels [Begin, End) of a row of the brush mask, relative to the brush position. */
+    struct Span
+    {
+      int Row;
+      int Begin;
+      int End;
+    };
+    using MaskType = std::vector<Span>;
+
+    /** Diameter of the brush in pixels. Even sizes are centered at the upper left corner of the brush position. */
+    void SetSize(int size);
+    itkGetConstMacro(Size, int);
+
+    /** Spans of the brush mask of the current size, ordered by row. */
+    const MaskType &GetMask() const;
+
+    /**
+     * \brief Paints the stroke segment from one brush position to another (both inclusive).
+     *
+     * \param slice 2D image that is painted.
+     * \param workingImage Image the slice was extracted from. Locked labels of its active layer are not
+     * overwritten if it is a LabelSetImage. Painting its exterior label value only erases the active label.
+     * \param paintingPixelValue Value written into the slice.
+     * \return the region of the slice that was touched (empty if the segment is outside of the slice).
+     */
+    RegionType Paint(Image *slice, const Image *workingImage, const IndexType &from, const IndexType &to, int paintingPixelValue);
+
+    /** Bounding box of all regions touched since the last call of ResetDirtyRegion(). */
+    itkGetConstReferenceMacro(DirtyRegion, RegionType);
+    bool IsDirty() const;
+    void ResetDirtyRegion();
+
+    /**
+     * \brief Copies the region of a 2D slice into a new slice.
+     *
+     * The geometry of the copy covers only the region, so writing the copy back into the volume
+     * (e.g. by mitk::SegTool2D::WriteSliceToVolume) only touches the pixels of the region.
+     */
+    static Image::Pointer ExtractRegion(const Image *slice, const RegionType &region);
+
+    /** Mask of a brush of the given size. Masks are computed once and shared by all instances. */
+    static const MaskType &GetMaskOfSize(int size);
+
+  protected:
+    PaintbrushStamp();
+    ~PaintbrushStamp() override;
+
+  private:
+    int m_Size;
+    const MaskType *m_Mask;
+    RegionType m_DirtyRegion;
+  };
+}
+
+#endif
@@ -12,15 +12,98 @@ found in the LICENSE file.
 
 #include "mitkShapeBasedInterpolationAlgorithm.h"
 #include "mitkImageAccessByItk.h"
-#include "mitkImageCast.h"
-#include <mitkITKImageImport.h>
 
-#include <itkFastChamferDistanceImageFilter.h>
-#include <itkInvertIntensityImageFilter.h>
-#include <itkIsoContourDistanceImageFilter.h>
-#include <itkSubtractImageFilter.h>
+#include <itkMultiThreaderBase.h>
 
-#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  // arbitrary maximum distance, pixels farther away from the contour get this distance
+  const float MaximumDistance = 101.0f;
+
+  /**
+   * Squared Euclidean distance of every pixel to the nearest pixel with feature[i] == featureValue,
+   * computed with the separable algorithm of Meijster, Roerdink and Hesselink (2000).
+   * Pixels without any feature pixel in the slice get a huge distance.
+   */
+  void SquaredDistanceTransform(const std::vector<unsigned char> &feature,
+                                unsigned char featureValue,
+                                unsigned int width,
+                                unsigned int height,
+                                std::vector<float> &result)
+  {
+    const float infinity = static_cast<float>(width + height);
+    result.resize(feature.size());
+
+    // first phase: vertical distances, processed row by row so that the inner loops run over contiguous memory
+    for (unsigned int x = 0; x < width; ++x)
+      result[x] = featureValue == feature[x] ? 0.0f : infinity;
+
+    for (unsigned int y = 1; y < height; ++y)
+    {
+      const unsigned char *featureRow = feature.data() + y * width;
+      const float *previousRow = result.data() + (y - 1) * width;
+      float *row = result.data() + y * width;
+      for (unsigned int x = 0; x < width; ++x)
+        row[x] = featureValue == featureRow[x] ? 0.0f : previousRow[x] + 1.0f;
+    }
+
+    for (unsigned int y = height - 1; y > 0; --y)
+    {
+      const float *nextRow = result.data() + y * width;
+      float *row = result.data() + (y - 1) * width;
+      for (unsigned int x = 0; x < width; ++x)
+        row[x] = std::min(row[x], nextRow[x] + 1.0f);
+    }
+
+    // second phase: lower envelope of the parabolas of every row
+    std::vector<double> f(width);
+    std::vector<unsigned int> v(width);
+    std::vector<double> z(width + 1);
+
+    // position where the parabolas of q and p intersect
+    auto intersection = [&f](unsigned int q, unsigned int p) {
+      return ((f[q] + double(q) * q) - (f[p] + double(p) * p)) / (2.0 * q - 2.0 * p);
+    };
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      float *row = result.data() + y * width;
+      for (unsigned int x = 0; x < width; ++x)
+        f[x] = static_cast<double>(row[x]) * row[x];
+
+      unsigned int k = 0;
+      v[0] = 0;
+      z[0] = -std::numeric_limits<double>::infinity();
+      z[1] = std::numeric_limits<double>::infinity();
+
+      for (unsigned int q = 1; q < width; ++q)
+      {
+        // z[0] is -infinity, so k never drops below 0
+        double s = intersection(q, v[k]);
+        while (s <= z[k])
+          s = intersection(q, v[--k]);
+
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = std::numeric_limits<double>::infinity();
+      }
+
+      k = 0;
+      for (unsigned int q = 0; q < width; ++q)
+      {
+        while (z[k + 1] < q)
+          ++k;
+        const double dx = double(q) - v[k];
+        row[q] = static_cast<float>(dx * dx + f[v[k]]);
+      }
+    }
+  }
+}
 
 mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::Interpolate(
   Image::ConstPointer lowerSlice,
@@ -28,130 +111,114 @@ mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::Interpolate(
   Image::ConstPointer upperSlice,
   unsigned int upperSliceIndex,
   unsigned int requestedIndex,
-  unsigned int /*sliceDimension*/, // commented variables are not used
+  unsigned int sliceDimension,
   Image::Pointer resultImage,
-  unsigned int /*timeStep*/,
-  Image::ConstPointer /*referenceImage*/)
+  unsigned int timeStep,
+  Image::ConstPointer /*referenceImage*/) // commented variables are not used
 {
-  auto lowerDistanceImage = this->ComputeDistanceMap(lowerSliceIndex, lowerSlice);
-  auto upperDistanceImage = this->ComputeDistanceMap(upperSliceIndex, upperSlice);
+  auto lowerDistanceMap = this->GetDistanceMap(CacheKeyType(timeStep, sliceDimension, lowerSliceIndex), lowerSlice);
+  auto upperDistanceMap = this->GetDistanceMap(CacheKeyType(timeStep, sliceDimension, upperSliceIndex), upperSlice);
 
   // calculate where the current slice is in comparison to the lower and upper neighboring slices
   float ratio = (float)(requestedIndex - lowerSliceIndex) / (float)(upperSliceIndex - lowerSliceIndex);
-  AccessFixedDimensionByItk_3(resultImage, InterpolateIntermediateSlice, 2, upperDistanceImage, lowerDistanceImage, ratio);
+  AccessFixedDimensionByItk_3(
+    resultImage, InterpolateIntermediateSlice, 2, lowerDistanceMap.get(), upperDistanceMap.get(), ratio);
 
   return resultImage;
 }
 
-mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::ComputeDistanceMap(unsigned int sliceIndex, Image::ConstPointer slice)
+mitk::ShapeBasedInterpolationAlgorithm::DistanceMapPointer mitk::ShapeBasedInterpolationAlgorithm::GetDistanceMap(
+  const CacheKeyType &key, const Image *slice)
 {
-  static const auto MAX_CACHE_SIZE = 2 * std::thread::hardware_concurrency();
+  // enough for two maps per thread, spread over all stripes
+  static const std::size_t MaximumStripeSize = std::max<std::size_t>(
+    4, 4 * itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads() / NumberOfCacheStripes);
+
+  auto &stripe = m_DistanceMapCache[std::get<2>(key) % NumberOfCacheStripes];
 
   {
-    std::lock_guard<std::mutex> lock(m_DistanceImageCacheMutex);
+    std::lock_guard<std::mutex> lock(stripe.Mutex);
 
-    if (0 != m_DistanceImageCache.count(sliceIndex))
-      return m_DistanceImageCache[sliceIndex];
+    auto iter = std::find_if(
+      stripe.Entries.begin(), stripe.Entries.end(), [&key](const auto &entry) { return entry.first == key; });
 
-    if (MAX_CACHE_SIZE < m_DistanceImageCache.size())
-      m_DistanceImageCache.clear();
+    if (iter != stripe.Entries.end())
+    {
+      stripe.Entries.splice(stripe.Entries.begin(), stripe.Entries, iter);
+      return iter->second;
+    }
   }
 
-  mitk::Image::Pointer distanceImage;
-  AccessFixedDimensionByItk_1(slice, ComputeDistanceMap, 2, distanceImage);
+  // compute outside of the lock, so other slices of the stripe are not blocked meanwhile
+  auto distanceMap = std::make_shared<DistanceMap>();
+  AccessFixedDimensionByItk_1(slice, ComputeDistanceMap, 2, distanceMap.get());
+
+  std::lock_guard<std::mutex> lock(stripe.Mutex);
+
+  auto iter = std::find_if(
+    stripe.Entries.begin(), stripe.Entries.end(), [&key](const auto &entry) { return entry.first == key; });
 
-  std::lock_guard<std::mutex> lock(m_DistanceImageCacheMutex);
+  if (iter != stripe.Entries.end())
+    return iter->second; // computed by another thread in the meantime
 
-  m_DistanceImageCache[sliceIndex] = distanceImage;
+  stripe.Entries.emplace_front(key, distanceMap);
 
-  return distanceImage;
+  if (stripe.Entries.size() > MaximumStripeSize)
+    stripe.Entries.pop_back();
+
+  return distanceMap;
 }
 
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::ShapeBasedInterpolationAlgorithm::ComputeDistanceMap(const itk::Image<TPixel, VImageDimension> *binaryImage,
-                                                                mitk::Image::Pointer &result)
+                                                                DistanceMap *result)
 {
-  typedef itk::Image<TPixel, VImageDimension> DistanceFilterInputImageType;
-
-  typedef itk::FastChamferDistanceImageFilter<DistanceFilterImageType, DistanceFilterImageType> DistanceFilterType;
-  typedef itk::IsoContourDistanceImageFilter<DistanceFilterInputImageType, DistanceFilterImageType> IsoContourType;
-  typedef itk::InvertIntensityImageFilter<DistanceFilterInputImageType> InvertIntensityImageFilterType;
-  typedef itk::SubtractImageFilter<DistanceFilterImageType, DistanceFilterImageType> SubtractImageFilterType;
-
-  typename DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
-  typename DistanceFilterType::Pointer distanceFilterInverted = DistanceFilterType::New();
-  typename IsoContourType::Pointer isoContourFilter = IsoContourType::New();
-  typename IsoContourType::Pointer isoContourFilterInverted = IsoContourType::New();
-  typename InvertIntensityImageFilterType::Pointer invertFilter = InvertIntensityImageFilterType::New();
-  typename SubtractImageFilterType::Pointer subtractImageFilter = SubtractImageFilterType::New();
-
-  // arbitrary maximum distance
-  int maximumDistance = 100;
-
-  // this assumes the image contains only 1 and 0
-  invertFilter->SetInput(binaryImage);
-  invertFilter->SetMaximum(1);
-
-  // do the processing on the image and the inverted image to get inside and outside distance
-  isoContourFilter->SetInput(binaryImage);
-  isoContourFilter->SetFarValue(maximumDistance + 1);
-  isoContourFilter->SetLevelSetValue(0);
-
-  isoContourFilterInverted->SetInput(invertFilter->GetOutput());
-  isoContourFilterInverted->SetFarValue(maximumDistance + 1);
-  isoContourFilterInverted->SetLevelSetValue(0);
-
-  distanceFilter->SetInput(isoContourFilter->GetOutput());
-  distanceFilter->SetMaximumDistance(maximumDistance);
-
-  distanceFilterInverted->SetInput(isoContourFilterInverted->GetOutput());
-  distanceFilterInverted->SetMaximumDistance(maximumDistance);
-
-  // inside distance should be negative, outside distance positive
-  subtractImageFilter->SetInput2(distanceFilter->GetOutput());
-  subtractImageFilter->SetInput1(distanceFilterInverted->GetOutput());
-  subtractImageFilter->Update();
-
-  result = mitk::GrabItkImageMemory(subtractImageFilter->GetOutput());
+  const auto size = binaryImage->GetLargestPossibleRegion().GetSize();
+  const unsigned int width = size[0];
+  const unsigned int height = size[1];
+  const std::size_t numberOfPixels = static_cast<std::size_t>(width) * height;
+
+  // every non-zero pixel belongs to the segmentation
+  std::vector<unsigned char> inside(numberOfPixels);
+  const TPixel *pixels = binaryImage->GetBufferPointer();
+  for (std::size_t i = 0; i < numberOfPixels; ++i)
+    inside[i] = 0 != pixels[i] ? 1 : 0;
+
+  std::vector<float> distanceToOutside;
+  std::vector<float> distanceToInside;
+  SquaredDistanceTransform(inside, 0, width, height, distanceToOutside);
+  SquaredDistanceTransform(inside, 1, width, height, distanceToInside);
+
+  // the contour lies half way between inside and outside pixels
+  result->Size = size;
+  result->Distances.resize(numberOfPixels);
+  float *distances = result->Distances.data();
+  for (std::size_t i = 0; i < numberOfPixels; ++i)
+  {
+    const float distance = inside[i] ? 0.5f - std::sqrt(distanceToOutside[i]) : std::sqrt(distanceToInside[i]) - 0.5f;
+    distances[i] = std::max(-MaximumDistance, std::min(MaximumDistance, distance));
+  }
 }
 
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::ShapeBasedInterpolationAlgorithm::InterpolateIntermediateSlice(itk::Image<TPixel, VImageDimension> *result,
-                                                                          const mitk::Image::Pointer &lower,
-                                                                          const mitk::Image::Pointer &upper,
+                                                                          const DistanceMap *lower,
+                                                                          const DistanceMap *upper,
                                                                           float ratio)
 {
-  typename DistanceFilterImageType::Pointer lowerITK = DistanceFilterImageType::New();
-  typename DistanceFilterImageType::Pointer upperITK = DistanceFilterImageType::New();
-
-  CastToItkImage(lower, lowerITK);
-  CastToItkImage(upper, upperITK);
-
-  itk::ImageRegionConstIteratorWithIndex<DistanceFilterImageType> lowerIter(lowerITK,
-                                                                            lowerITK->GetLargestPossibleRegion());
-
-  lowerIter.GoToBegin();
-
-  if (!lowerITK->GetLargestPossibleRegion().IsInside(upperITK->GetLargestPossibleRegion()) ||
-      !lowerITK->GetLargestPossibleRegion().IsInside(result->GetLargestPossibleRegion()))
+  if (lower->Size != upper->Size || lower->Size != result->GetLargestPossibleRegion().GetSize())
   {
     // TODO Exception etc.
     MITK_ERROR << "The regions of the slices for the 2D interpolation are not equally sized!";
     return;
   }
 
-  float weight[2] = {1.0f - ratio, ratio};
-
-  while (!lowerIter.IsAtEnd())
-  {
-    typename DistanceFilterImageType::PixelType lowerPixelVal = lowerIter.Get();
-    typename DistanceFilterImageType::PixelType upperPixelVal = upperITK->GetPixel(lowerIter.GetIndex());
+  const float weight[2] = {1.0f - ratio, ratio};
+  const float *lowerDistances = lower->Distances.data();
+  const float *upperDistances = upper->Distances.data();
+  TPixel *pixels = result->GetBufferPointer();
+  const std::size_t numberOfPixels = lower->Distances.size();
 
-    typename DistanceFilterImageType::PixelType intermediatePixelVal =
-      (weight[0] * upperPixelVal + weight[1] * lowerPixelVal > 0 ? 0 : 1);
-
-    result->SetPixel(lowerIter.GetIndex(), static_cast<TPixel>(intermediatePixelVal));
-
-    ++lowerIter;
-  }
+  for (std::size_t i = 0; i < numberOfPixels; ++i)
+    pixels[i] = weight[0] * lowerDistances[i] + weight[1] * upperDistances[i] > 0 ? 0 : 1;
 }
@@ -16,8 +16,12 @@ found in the LICENSE file.
 #include "mitkSegmentationInterpolationAlgorithm.h"
 #include <MitkSegmentationExports.h>
 
-#include <map>
+#include <array>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <tuple>
+#include <vector>
 
 namespace mitk
 {
@@ -30,6 +34,12 @@ namespace mitk
    * G.T. Herman, J. Zheng, C.A. Bucholtz: "Shape-based interpolation"
    * IEEE Computer Graphics & Applications, pp. 69-79,May 1992
    *
+   * The signed distance maps of the neighboring slices are computed with an exact Euclidean
+   * distance transform (Meijster et al.) and cached, so that interpolating many slices between
+   * the same segmented slices computes them only once. The cache is split into stripes with a
+   * mutex each and is bounded per stripe (least recently used maps are dropped), so Interpolate()
+   * can be called concurrently from many threads with little contention.
+   *
    *  Last contributor:
    *  $Author:$
    */
@@ -51,21 +61,39 @@ namespace mitk
                                  Image::ConstPointer referenceImage) override;
 
   private:
-    typedef itk::Image<mitk::ScalarType, 2> DistanceFilterImageType;
+    /** Signed distance of every pixel to the contour of a binary slice in pixels, negative inside. */
+    struct DistanceMap
+    {
+      itk::Size<2> Size;
+      std::vector<float> Distances;
+    };
 
-    template <typename TPixel, unsigned int VImageDimension>
-    void ComputeDistanceMap(const itk::Image<TPixel, VImageDimension> *, mitk::Image::Pointer &result);
+    using DistanceMapPointer = std::shared_ptr<const DistanceMap>;
+
+    /** Time step, slice dimension and slice index of a distance map. */
+    using CacheKeyType = std::tuple<unsigned int, unsigned int, unsigned int>;
+
+    struct CacheStripe
+    {
+      std::mutex Mutex;
+      /** Most recently used first. */
+      std::list<std::pair<CacheKeyType, DistanceMapPointer>> Entries;
+    };
 
-    Image::Pointer ComputeDistanceMap(unsigned int sliceIndex, Image::ConstPointer slice);
+    static constexpr std::size_t NumberOfCacheStripes = 8;
+
+    DistanceMapPointer GetDistanceMap(const CacheKeyType &key, const Image *slice);
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void ComputeDistanceMap(const itk::Image<TPixel, VImageDimension> *binaryImage, DistanceMap *result);
 
     template <typename TPixel, unsigned int VImageDimension>
     void InterpolateIntermediateSlice(itk::Image<TPixel, VImageDimension> *result,
-                                      const mitk::Image::Pointer &lowerDistanceImage,
-                                      const mitk::Image::Pointer &upperDistanceImage,
+                                      const DistanceMap *lower,
+                                      const DistanceMap *upper,
                                       float ratio);
 
-    std::map<unsigned int, Image::Pointer> m_DistanceImageCache;
-    std::mutex m_DistanceImageCacheMutex;
+    std::array<CacheStripe, NumberOfCacheStripes> m_DistanceMapCache;
   };
 
 } // namespace
@@ -12,6 +12,7 @@ found in the LICENSE file.
 
 #include "mitkShowSegmentationAsSmoothedSurface.h"
 #include "itkIntelligentBinaryClosingFilter.h"
+#include "mitkBlockwiseSurfaceGenerator.h"
 #include "mitkImageCast.h"
 #include "mitkImageToItk.h"
 #include <itkAddImageFilter.h>
@@ -25,14 +26,10 @@ found in the LICENSE file.
 #include <itkRegionOfInterestImageFilter.h>
 #include <mitkGeometry3D.h>
 #include <mitkImageTimeSelector.h>
-#include <mitkImageToSurfaceFilter.h>
 #include <mitkProgressBar.h>
 #include <mitkStatusBar.h>
 #include <mitkUIDGenerator.h>
 #include <mitkVtkRepresentationProperty.h>
-#include <vtkCleanPolyData.h>
-#include <vtkPolyDataNormals.h>
-#include <vtkQuadricDecimation.h>
 
 using namespace mitk;
 using namespace std;
@@ -69,6 +66,11 @@ void ShowSegmentationAsSmoothedSurface::Initialize(const NonBlockingAlgorithm *o
   // Valid range for closing value is [0, 1]. Higher values
   // increase closing. A value of 0 disables closing.
   SetParameter("Closing", 0.0);
+
+  // Number of slices per block. The surface is extracted, smoothed and
+  // decimated block by block in parallel. A value of 0 processes the
+  // whole volume at once (single threaded quadric decimation).
+  SetParameter("Block size", 64);
 }
 
 bool ShowSegmentationAsSmoothedSurface::ReadyToRun()
@@ -103,6 +105,9 @@ bool ShowSegmentationAsSmoothedSurface::ThreadedUpdateFunction()
   int timeNr = 0;
   GetParameter("TimeNr", timeNr);
 
+  int blockSize = 64;
+  GetParameter("Block size", blockSize);
+
   if (image->GetDimension() == 4)
     MITK_INFO << "CREATING SMOOTHED POLYGON MODEL (t = " << timeNr << ')';
   else
@@ -111,6 +116,7 @@ bool ShowSegmentationAsSmoothedSurface::ThreadedUpdateFunction()
   MITK_INFO << "  Smoothing  = " << smoothing;
   MITK_INFO << "  Decimation = " << decimation;
   MITK_INFO << "  Closing    = " << closing;
+  MITK_INFO << "  Block size = " << blockSize;
 
   Geometry3D::Pointer geometry = dynamic_cast<Geometry3D *>(image->GetGeometry()->Clone().GetPointer());
 
@@ -396,53 +402,16 @@ bool ShowSegmentationAsSmoothedSurface::ThreadedUpdateFunction()
 
   filteredImage->SetGeometry(geometry);
 
-  ImageToSurfaceFilter::Pointer imageToSurfaceFilter = ImageToSurfaceFilter::New();
-
-  imageToSurfaceFilter->SetInput(filteredImage);
-  imageToSurfaceFilter->SetThreshold(50);
-  imageToSurfaceFilter->SmoothOn();
-  imageToSurfaceFilter->SetDecimate(ImageToSurfaceFilter::NoDecimation);
-
-  m_Surface = imageToSurfaceFilter->GetOutput(0);
-
-  ProgressBar::GetInstance()->Progress(1);
-
-  // Mesh decimation
-
-  if (decimation > 0.0f && decimation < 1.0f)
-  {
-    MITK_INFO << "Quadric mesh decimation...";
-
-    vtkQuadricDecimation *quadricDecimation = vtkQuadricDecimation::New();
-    quadricDecimation->SetInputData(m_Surface->GetVtkPolyData());
-    quadricDecimation->SetTargetReduction(decimation);
-    quadricDecimation->AttributeErrorMetricOn();
-    quadricDecimation->GlobalWarningDisplayOff();
-    quadricDecimation->Update();
-
-    vtkCleanPolyData *cleaner = vtkCleanPolyData::New();
-    cleaner->SetInputConnection(quadricDecimation->GetOutputPort());
-    cleaner->PieceInvariantOn();
-    cleaner->ConvertLinesToPointsOn();
-    cleaner->ConvertStripsToPolysOn();
-    cleaner->PointMergingOn();
-    cleaner->Update();
-
-    m_Surface->SetVtkPolyData(cleaner->GetOutput());
-  }
-
-  ProgressBar::GetInstance()->Progress(1);
+  BlockwiseSurfaceGenerator::Pointer surfaceGenerator = BlockwiseSurfaceGenerator::New();
 
-  // Compute Normals
+  surfaceGenerator->SetThreshold(50);
+  surfaceGenerator->SetDecimation(decimation);
+  surfaceGenerator->SetBlockSize(static_cast<unsigned int>(max(0, blockSize)));
 
-  vtkPolyDataNormals *computeNormals = vtkPolyDataNormals::New();
-  computeNormals->SetInputData(m_Surface->GetVtkPolyData());
-  computeNormals->SetFeatureAngle(360.0f);
-  computeNormals->AutoOrientNormalsOn();
-  computeNormals->FlipNormalsOff();
-  computeNormals->Update();
+  m_Surface = Surface::New();
+  m_Surface->SetVtkPolyData(surfaceGenerator->Generate(filteredImage));
 
-  m_Surface->SetVtkPolyData(computeNormals->GetOutput());
+  ProgressBar::GetInstance()->Progress(2);
 
   return true;
 }
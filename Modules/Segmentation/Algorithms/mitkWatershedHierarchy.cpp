@@ -0,0 +1,592 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkWatershedHierarchy.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkLabel.h>
+
+#include <itkMultiThreaderBase.h>
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+
+namespace
+{
+  using BasinIdType = mitk::WatershedHierarchy::BasinIdType;
+
+  struct Volume
+  {
+    itk::OffsetValueType Dimensions[3];
+    itk::OffsetValueType Strides[3];
+  };
+
+  struct Edge
+  {
+    BasinIdType First;
+    BasinIdType Second;
+    float Pass;
+  };
+
+  class DisjointSets
+  {
+  public:
+    explicit DisjointSets(std::size_t size) : m_Parents(size), m_Sizes(size, 1)
+    {
+      std::iota(m_Parents.begin(), m_Parents.end(), BasinIdType(0));
+    }
+
+    BasinIdType Find(BasinIdType i)
+    {
+      while (m_Parents[i] != i)
+      {
+        m_Parents[i] = m_Parents[m_Parents[i]];
+        i = m_Parents[i];
+      }
+      return i;
+    }
+
+    /** Unites the sets of the roots a and b and returns the root of the united set. */
+    BasinIdType UniteRoots(BasinIdType a, BasinIdType b)
+    {
+      if (m_Sizes[a] < m_Sizes[b])
+        std::swap(a, b);
+
+      m_Parents[b] = a;
+      m_Sizes[a] += m_Sizes[b];
+      return a;
+    }
+
+  private:
+    std::vector<BasinIdType> m_Parents;
+    std::vector<std::size_t> m_Sizes;
+  };
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void CopyValues(const itk::Image<TPixel, VImageDimension> *image, std::vector<float> &values)
+  {
+    const TPixel *buffer = image->GetBufferPointer();
+    values.assign(buffer, buffer + image->GetBufferedRegion().GetNumberOfPixels());
+  }
+
+  /** Codes of the steepest descent of a pixel, 0 to 5 are the directions of ForEachNeighbor. */
+  enum Descent : unsigned char
+  {
+    Minimum = 6,
+    Flat = 7,     // no lower neighbor, not processed yet
+    InProgress = 8
+  };
+
+  /** Flag of the basin ids that refer to the exits of a tile during the tracing of the descents. */
+  const BasinIdType ExitFlag = BasinIdType(1) << 31;
+
+  /**
+   * Calls f(neighbor, direction) for all face neighbors of the pixel that lie inside of the pixel range
+   * [begin, end). The direction is 2 * axis for the lower and 2 * axis + 1 for the upper neighbor.
+   */
+  template <typename F>
+  void ForEachNeighbor(const Volume &volume,
+                       itk::OffsetValueType offset,
+                       itk::OffsetValueType begin,
+                       itk::OffsetValueType end,
+                       F f)
+  {
+    const itk::OffsetValueType coordinates[3] = {offset % volume.Dimensions[0],
+                                                 (offset / volume.Strides[1]) % volume.Dimensions[1],
+                                                 offset / volume.Strides[2]};
+
+    for (int d = 0; d < 3; ++d)
+    {
+      if (coordinates[d] > 0 && offset - volume.Strides[d] >= begin)
+        f(offset - volume.Strides[d], static_cast<unsigned char>(2 * d));
+
+      if (coordinates[d] + 1 < volume.Dimensions[d] && offset + volume.Strides[d] < end)
+        f(offset + volume.Strides[d], static_cast<unsigned char>(2 * d + 1));
+    }
+  }
+
+  itk::OffsetValueType GetNeighbor(const Volume &volume, itk::OffsetValueType offset, unsigned char direction)
+  {
+    return 0 == direction % 2 ? offset - volume.Strides[direction / 2] : offset + volume.Strides[direction / 2];
+  }
+
+  /** Points every pixel of [begin, end) to its lowest neighbor, if it is lower than the pixel itself. */
+  void FindSteepestDescents(const Volume &volume,
+                            const float *values,
+                            itk::OffsetValueType numberOfPixels,
+                            itk::OffsetValueType begin,
+                            itk::OffsetValueType end,
+                            unsigned char *descents)
+  {
+    for (auto offset = begin; offset < end; ++offset)
+    {
+      float lowest = values[offset];
+      unsigned char descent = Flat;
+
+      ForEachNeighbor(volume, offset, 0, numberOfPixels, [&](itk::OffsetValueType neighbor, unsigned char direction) {
+        if (values[neighbor] < lowest)
+        {
+          lowest = values[neighbor];
+          descent = direction;
+        }
+      });
+
+      descents[offset] = descent;
+    }
+  }
+
+  /**
+   * Processes the connected flat pixels of equal value that contain the given one. If they have a neighbor of
+   * equal value with a descent, they descend to it on the shortest path. Otherwise they are a regional minimum,
+   * which becomes a new basin.
+   */
+  void DescendFlatRegion(const Volume &volume,
+                         const float *values,
+                         itk::OffsetValueType numberOfPixels,
+                         itk::OffsetValueType start,
+                         unsigned char *descents,
+                         BasinIdType *basins,
+                         std::vector<float> &basinMinima,
+                         std::vector<itk::OffsetValueType> &region)
+  {
+    const float value = values[start];
+
+    region.assign(1, start);
+    descents[start] = InProgress;
+
+    for (std::size_t i = 0; i < region.size(); ++i)
+    {
+      ForEachNeighbor(volume, region[i], 0, numberOfPixels, [&](itk::OffsetValueType neighbor, unsigned char) {
+        if (Flat == descents[neighbor] && values[neighbor] == value)
+        {
+          descents[neighbor] = InProgress;
+          region.push_back(neighbor);
+        }
+      });
+    }
+
+    // pixels next to an exit of the region descend to it
+    std::vector<std::pair<itk::OffsetValueType, unsigned char>> exits;
+
+    for (auto pixel : region)
+    {
+      ForEachNeighbor(volume, pixel, 0, numberOfPixels, [&](itk::OffsetValueType neighbor, unsigned char direction) {
+        if (descents[neighbor] < Minimum && values[neighbor] == value && (exits.empty() || exits.back().first != pixel))
+          exits.emplace_back(pixel, direction);
+      });
+    }
+
+    if (exits.empty())
+    {
+      basinMinima.push_back(value);
+
+      for (auto pixel : region)
+      {
+        descents[pixel] = Minimum;
+        basins[pixel] = static_cast<BasinIdType>(basinMinima.size() - 1);
+      }
+
+      return;
+    }
+
+    // breadth first search from the exits, every pixel descends towards the nearest one
+    region.clear();
+
+    for (const auto &exit : exits)
+    {
+      descents[exit.first] = exit.second;
+      region.push_back(exit.first);
+    }
+
+    for (std::size_t i = 0; i < region.size(); ++i)
+    {
+      ForEachNeighbor(volume, region[i], 0, numberOfPixels, [&](itk::OffsetValueType neighbor, unsigned char direction) {
+        if (InProgress == descents[neighbor])
+        {
+          descents[neighbor] = direction ^ 1;
+          region.push_back(neighbor);
+        }
+      });
+    }
+  }
+
+  /**
+   * Follows the descents of the pixels [begin, end) to their basins. Paths that leave the range end at an exit,
+   * their pixels get the index of the exit with the ExitFlag. Returns the exits.
+   */
+  std::vector<itk::OffsetValueType> TraceDescents(const Volume &volume,
+                                                  const unsigned char *descents,
+                                                  itk::OffsetValueType begin,
+                                                  itk::OffsetValueType end,
+                                                  BasinIdType *basins)
+  {
+    std::vector<itk::OffsetValueType> exits;
+    std::unordered_map<itk::OffsetValueType, BasinIdType> exitIndices;
+    std::vector<itk::OffsetValueType> path;
+
+    for (auto offset = begin; offset < end; ++offset)
+    {
+      if (0 != basins[offset])
+        continue;
+
+      BasinIdType basin = 0;
+      auto pixel = offset;
+      path.clear();
+
+      while (true)
+      {
+        if (pixel < begin || pixel >= end)
+        {
+          auto result = exitIndices.emplace(pixel, static_cast<BasinIdType>(exits.size()));
+          if (result.second)
+            exits.push_back(pixel);
+
+          basin = ExitFlag | result.first->second;
+          break;
+        }
+
+        if (0 != basins[pixel])
+        {
+          basin = basins[pixel];
+          break;
+        }
+
+        path.push_back(pixel);
+        pixel = GetNeighbor(volume, pixel, descents[pixel]);
+      }
+
+      for (auto pathPixel : path)
+        basins[pathPixel] = basin;
+    }
+
+    return exits;
+  }
+
+  /** Lowest pass between all pairs of adjacent basins, for the pairs with a pixel in [begin, end). */
+  std::vector<Edge> FindEdges(const Volume &volume,
+                              const float *values,
+                              const BasinIdType *basins,
+                              itk::OffsetValueType begin,
+                              itk::OffsetValueType end)
+  {
+    std::unordered_map<std::uint64_t, float> passes;
+
+    for (auto offset = begin; offset < end; ++offset)
+    {
+      const itk::OffsetValueType coordinates[3] = {offset % volume.Dimensions[0],
+                                                   (offset / volume.Strides[1]) % volume.Dimensions[1],
+                                                   offset / volume.Strides[2]};
+
+      for (int d = 0; d < 3; ++d)
+      {
+        if (coordinates[d] + 1 >= volume.Dimensions[d])
+          continue;
+
+        const auto neighbor = offset + volume.Strides[d];
+
+        if (basins[offset] == basins[neighbor])
+          continue;
+
+        const auto key = (static_cast<std::uint64_t>(std::min(basins[offset], basins[neighbor])) << 32) |
+                         std::max(basins[offset], basins[neighbor]);
+        const float pass = std::max(values[offset], values[neighbor]);
+
+        auto result = passes.emplace(key, pass);
+        if (!result.second)
+          result.first->second = std::min(result.first->second, pass);
+      }
+    }
+
+    std::vector<Edge> edges;
+    edges.reserve(passes.size());
+
+    for (const auto &pass : passes)
+      edges.push_back({static_cast<BasinIdType>(pass.first >> 32), static_cast<BasinIdType>(pass.first), pass.second});
+
+    return edges;
+  }
+}
+
+mitk::WatershedHierarchy::WatershedHierarchy()
+  : m_TileSize(32), m_Progress(0.0f), m_Dimension(0), m_Dimensions{0, 0, 0}, m_Minimum(0.0f), m_Maximum(0.0f), m_NumberOfBasins(0)
+{
+}
+
+mitk::WatershedHierarchy::~WatershedHierarchy()
+{
+}
+
+void mitk::WatershedHierarchy::Initialize(const Image *image)
+{
+  if (nullptr == image || (2 != image->GetDimension() && 3 != image->GetDimension()))
+    mitkThrow() << "WatershedHierarchy requires a 2D or 3D image.";
+
+  if (1 != image->GetPixelType().GetNumberOfComponents())
+    mitkThrow() << "WatershedHierarchy requires an image with scalar pixels.";
+
+  this->UpdateProgress(0.0f);
+
+  std::vector<float> values;
+  AccessByItk_1(image, CopyValues, values);
+
+  m_Dimension = image->GetDimension();
+  m_Dimensions[0] = image->GetDimension(0);
+  m_Dimensions[1] = image->GetDimension(1);
+  m_Dimensions[2] = 3 == m_Dimension ? image->GetDimension(2) : 1;
+  m_Geometry = image->GetGeometry()->Clone();
+
+  Volume volume;
+  itk::OffsetValueType stride = 1;
+  for (int d = 0; d < 3; ++d)
+  {
+    volume.Dimensions[d] = m_Dimensions[d];
+    volume.Strides[d] = stride;
+    stride *= volume.Dimensions[d];
+  }
+
+  const auto numberOfPixels = stride;
+  const auto minmax = std::minmax_element(values.begin(), values.end());
+  m_Minimum = *minmax.first;
+  m_Maximum = *minmax.second;
+
+  // tiles of complete slices along the last axis, so that every tile is a contiguous range of pixels
+  const int tileAxis = volume.Dimensions[2] > 1 ? 2 : 1;
+  const auto numberOfSlices = volume.Dimensions[tileAxis];
+  const auto tileSize = 0 == m_TileSize ? numberOfSlices : static_cast<itk::OffsetValueType>(m_TileSize);
+  const auto numberOfTiles = (numberOfSlices + tileSize - 1) / tileSize;
+  const auto tileStride = tileSize * volume.Strides[tileAxis];
+
+  auto tileBegin = [&](itk::OffsetValueType tile) { return tile * tileStride; };
+  auto tileEnd = [&](itk::OffsetValueType tile) { return std::min((tile + 1) * tileStride, numberOfPixels); };
+
+  auto tileOf = [&](itk::OffsetValueType offset) { return offset / tileStride; };
+
+  std::vector<unsigned char> descents(static_cast<std::size_t>(numberOfPixels));
+
+  auto multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfTiles,
+    [&](itk::SizeValueType tile) {
+      FindSteepestDescents(volume, values.data(), numberOfPixels, tileBegin(tile), tileEnd(tile), descents.data());
+    },
+    nullptr);
+
+  this->UpdateProgress(0.2f);
+
+  // flat regions may span several tiles, they are rare enough to be processed sequentially
+  m_Basins.assign(static_cast<std::size_t>(numberOfPixels), 0);
+  std::vector<float> basinMinima(1, 0.0f);
+  std::vector<itk::OffsetValueType> region;
+
+  for (itk::OffsetValueType offset = 0; offset < numberOfPixels; ++offset)
+  {
+    if (Flat == descents[offset])
+      DescendFlatRegion(
+        volume, values.data(), numberOfPixels, offset, descents.data(), m_Basins.data(), basinMinima, region);
+  }
+
+  m_NumberOfBasins = basinMinima.size() - 1;
+
+  if (m_NumberOfBasins >= ExitFlag)
+    mitkThrow() << "WatershedHierarchy cannot handle more than " << ExitFlag - 1 << " basins.";
+
+  this->UpdateProgress(0.35f);
+
+  std::vector<std::vector<itk::OffsetValueType>> tileExits(numberOfTiles);
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfTiles,
+    [&](itk::SizeValueType tile) {
+      tileExits[tile] = TraceDescents(volume, descents.data(), tileBegin(tile), tileEnd(tile), m_Basins.data());
+    },
+    nullptr);
+
+  this->UpdateProgress(0.5f);
+
+  // the paths continue in the tiles of the exits
+  std::vector<std::vector<BasinIdType>> exitBasins(numberOfTiles);
+  for (itk::OffsetValueType tile = 0; tile < numberOfTiles; ++tile)
+    exitBasins[tile].assign(tileExits[tile].size(), 0);
+
+  std::vector<std::pair<itk::OffsetValueType, BasinIdType>> chain;
+
+  for (itk::OffsetValueType tile = 0; tile < numberOfTiles; ++tile)
+  {
+    for (BasinIdType exit = 0; exit < tileExits[tile].size(); ++exit)
+    {
+      auto current = std::make_pair(tile, exit);
+      BasinIdType basin = 0;
+      chain.clear();
+
+      while (0 == (basin = exitBasins[current.first][current.second]))
+      {
+        chain.push_back(current);
+
+        const auto pixel = tileExits[current.first][current.second];
+        basin = m_Basins[pixel];
+
+        if (0 == (basin & ExitFlag))
+          break;
+
+        current = std::make_pair(tileOf(pixel), basin & ~ExitFlag);
+      }
+
+      for (const auto &link : chain)
+        exitBasins[link.first][link.second] = basin;
+    }
+  }
+
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfTiles,
+    [&](itk::SizeValueType tile) {
+      for (auto offset = tileBegin(tile); offset < tileEnd(tile); ++offset)
+      {
+        if (0 != (m_Basins[offset] & ExitFlag))
+          m_Basins[offset] = exitBasins[tile][m_Basins[offset] & ~ExitFlag];
+      }
+    },
+    nullptr);
+
+  this->UpdateProgress(0.6f);
+
+  std::vector<std::vector<Edge>> tileEdges(numberOfTiles);
+
+  // the edges of a tile include the pairs with the first slice of the next tile
+  multiThreader->ParallelizeArray(
+    0,
+    numberOfTiles,
+    [&](itk::SizeValueType tile) {
+      tileEdges[tile] = FindEdges(volume, values.data(), m_Basins.data(), tileBegin(tile), tileEnd(tile));
+    },
+    nullptr);
+
+  this->UpdateProgress(0.75f);
+
+  std::vector<Edge> edges;
+  for (const auto &edgesOfTile : tileEdges)
+    edges.insert(edges.end(), edgesOfTile.begin(), edgesOfTile.end());
+
+  std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+    return std::tie(a.Pass, a.First, a.Second) < std::tie(b.Pass, b.First, b.Second);
+  });
+
+  // minimum spanning tree, the minimum of every set is the minimum of its deepest basin
+  this->UpdateProgress(0.9f);
+
+  // the spanning tree has one merge less than there are basins, this keeps the capacity of the vector tight
+  DisjointSets sets(m_NumberOfBasins + 1);
+  std::vector<Merge>().swap(m_Merges);
+  m_Merges.reserve(0 < m_NumberOfBasins ? m_NumberOfBasins - 1 : 0);
+
+  for (const auto &edge : edges)
+  {
+    const auto first = sets.Find(edge.First);
+    const auto second = sets.Find(edge.Second);
+
+    if (first == second)
+      continue;
+
+    m_Merges.push_back({edge.First, edge.Second, edge.Pass, std::max(basinMinima[first], basinMinima[second])});
+
+    const auto root = sets.UniteRoots(first, second);
+    basinMinima[root] = std::min(basinMinima[first], basinMinima[second]);
+  }
+
+  this->UpdateProgress(1.0f);
+}
+
+void mitk::WatershedHierarchy::UpdateProgress(float progress)
+{
+  m_Progress = progress;
+  this->InvokeEvent(itk::ProgressEvent());
+}
+
+std::size_t mitk::WatershedHierarchy::GetSize() const
+{
+  return m_Basins.capacity() * sizeof(BasinIdType) + m_Merges.capacity() * sizeof(Merge);
+}
+
+std::size_t mitk::WatershedHierarchy::GetNumberOfBasins() const
+{
+  return m_NumberOfBasins;
+}
+
+mitk::Image::Pointer mitk::WatershedHierarchy::GetSegmentation(double threshold, double level) const
+{
+  if (m_Basins.empty())
+    mitkThrow() << "WatershedHierarchy has to be initialized before segmentations can be requested.";
+
+  // below the threshold everything is flat, so the minima and passes are raised to it
+  const double floodThreshold = m_Minimum + threshold * (m_Maximum - m_Minimum);
+  const double floodLevel = level * (m_Maximum - std::max(floodThreshold, static_cast<double>(m_Minimum)));
+
+  DisjointSets regions(m_NumberOfBasins + 1);
+
+  for (const auto &merge : m_Merges)
+  {
+    const double pass = std::max(static_cast<double>(merge.Pass), floodThreshold);
+    const double minimum = std::max(static_cast<double>(merge.HigherMinimum), floodThreshold);
+
+    if (pass - minimum <= floodLevel)
+    {
+      const auto first = regions.Find(merge.First);
+      const auto second = regions.Find(merge.Second);
+
+      if (first != second)
+        regions.UniteRoots(first, second);
+    }
+  }
+
+  std::vector<Label::PixelType> labels(m_NumberOfBasins + 1, 0);
+  std::vector<std::size_t> regionLabels(m_NumberOfBasins + 1, 0);
+  std::size_t numberOfRegions = 0;
+
+  for (BasinIdType basin = 1; basin <= m_NumberOfBasins; ++basin)
+  {
+    const auto region = regions.Find(basin);
+
+    if (0 == regionLabels[region])
+      regionLabels[region] = ++numberOfRegions;
+
+    labels[basin] = static_cast<Label::PixelType>(regionLabels[region]);
+  }
+
+  auto segmentation = Image::New();
+  segmentation->Initialize(MakeScalarPixelType<Label::PixelType>(), m_Dimension, m_Dimensions);
+  segmentation->SetGeometry(m_Geometry->Clone());
+
+  ImageWriteAccessor accessor(segmentation);
+  auto *data = static_cast<Label::PixelType *>(accessor.GetData());
+  const std::size_t rowLength = m_Dimensions[0];
+
+  auto multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads());
+  multiThreader->ParallelizeArray(
+    0,
+    m_Dimensions[1] * m_Dimensions[2],
+    [&](itk::SizeValueType row) {
+      for (auto offset = row * rowLength; offset < (row + 1) * rowLength; ++offset)
+        data[offset] = labels[m_Basins[offset]];
+    },
+    nullptr);
+
+  return segmentation;
+}
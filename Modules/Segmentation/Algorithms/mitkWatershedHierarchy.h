@@ -0,0 +1,111 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkWatershedHierarchy_h_Included
+#define mitkWatershedHierarchy_h_Included
+
+#include "mitkImage.h"
+#include <MitkSegmentationExports.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * \brief Watershed segmentation of an image into catchment basins and their merge hierarchy.
+   *
+   * Initialize() segments the image (usually a gradient magnitude image) into the catchment basins of its
+   * regional minima: every pixel follows the steepest descent down to a minimum, pixels of flat regions
+   * descend to the nearest lower border of the region. The image is split into tiles of TileSize slices
+   * along its last axis. The descents are found and traced in parallel for all tiles, paths that leave a
+   * tile are continued afterwards. Only flat regions are processed sequentially. The basins do not depend
+   * on the tiling.
+   *
+   * All adjacent basins are merged in the order of the lowest pass between them (the minimum spanning
+   * tree of the region adjacency graph). Every merge keeps the pass height and the minimum of the shallower
+   * basin, so the saliency of a merge (height of the pass above the shallower basin) can be computed for
+   * any threshold. Thus GetSegmentation() answers arbitrary threshold and level queries without flooding
+   * the image again. Threshold and level have the meaning of itk::WatershedImageFilter:
+   * - Threshold: values below Threshold * (maximum - minimum) + minimum are considered to be flat.
+   * - Level: basins are merged if their saliency is at most Level * (maximum - threshold value).
+   *
+   * The results are similar to itk::WatershedImageFilter, but not identical.
+   */
+  class MITKSEGMENTATION_EXPORT WatershedHierarchy : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(WatershedHierarchy, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    using BasinIdType = std::uint32_t;
+
+    /** Number of slices per tile. 0 processes the image in one piece. */
+    itkSetMacro(TileSize, unsigned int);
+    itkGetConstMacro(TileSize, unsigned int);
+
+    /**
+     * \brief Segments the first time step of the image into its basins and builds the merge hierarchy.
+     * Invokes an itk::ProgressEvent after every phase, GetProgress() returns the completed fraction.
+     * \pre image is a 2D or 3D image with scalar pixels.
+     */
+    void Initialize(const Image *image);
+
+    /** Completed fraction of Initialize() in [0, 1]. */
+    itkGetConstMacro(Progress, float);
+
+    /** Number of catchment basins of the image, i.e. before any merge. */
+    std::size_t GetNumberOfBasins() const;
+
+    /** Memory held by the basins and merges in bytes. */
+    std::size_t GetSize() const;
+
+    /**
+     * \brief Labels the regions that remain for the given threshold and level, starting at 1.
+     * Labels beyond the maximum of Label::PixelType wrap around.
+     */
+    Image::Pointer GetSegmentation(double threshold, double level) const;
+
+  protected:
+    WatershedHierarchy();
+    ~WatershedHierarchy() override;
+
+  private:
+    struct Merge
+    {
+      BasinIdType First;
+      BasinIdType Second;
+      float Pass;
+      float HigherMinimum;
+    };
+
+    void UpdateProgress(float progress);
+
+    unsigned int m_TileSize;
+    float m_Progress;
+
+    unsigned int m_Dimension;
+    unsigned int m_Dimensions[3];
+    BaseGeometry::Pointer m_Geometry;
+
+    float m_Minimum;
+    float m_Maximum;
+
+    /** Basin of every pixel, the ids start at 1. */
+    std::vector<BasinIdType> m_Basins;
+    std::size_t m_NumberOfBasins;
+    /** Merges of the minimum spanning tree in ascending order of their passes. */
+    std::vector<Merge> m_Merges;
+  };
+}
+
+#endif
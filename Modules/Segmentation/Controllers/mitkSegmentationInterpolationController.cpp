@@ -22,7 +22,10 @@ found in the LICENSE file.
 #include <itkCommand.h>
 #include <itkImage.h>
 #include <itkImageSliceConstIteratorWithIndex.h>
+#include <itkMultiThreaderBase.h>
 
+#include <algorithm>
+#include <array>
 #include <thread>
 
 namespace
@@ -37,6 +40,71 @@ namespace
       object->RemoveObserver(observerTag);
     }
   }
+
+  /**
+   * Pixel counts per label in the slices of all three dimensions. The counts are kept in dense vectors,
+   * so adding a pixel is cheap; they are transferred to the (sparse) SliceOccupancyIndex afterwards.
+   */
+  class SliceCountAccumulator
+  {
+  public:
+    using LabelValueType = mitk::SliceOccupancyIndex::LabelValueType;
+
+    SliceCountAccumulator(unsigned int dim0, unsigned int dim1, unsigned int dim2)
+      : m_Dimensions({{dim0, dim1, dim2}}), m_LastLabel(0), m_LastCounts(nullptr)
+    {
+    }
+
+    void Add(LabelValueType label, const unsigned int *index, long long delta)
+    {
+      if (0 == label)
+        return;
+
+      // neighboring pixels mostly have the same label, so the last one is cached
+      if (nullptr == m_LastCounts || label != m_LastLabel)
+      {
+        auto iter = m_Counts.find(label);
+        if (iter == m_Counts.end())
+        {
+          iter = m_Counts.emplace(label, LabelCountsType()).first;
+          for (unsigned int dim = 0; dim < 3; ++dim)
+            iter->second[dim].assign(m_Dimensions[dim], 0);
+        }
+        m_LastLabel = label;
+        m_LastCounts = &iter->second;
+      }
+
+      for (unsigned int dim = 0; dim < 3; ++dim)
+        (*m_LastCounts)[dim][index[dim]] += delta;
+    }
+
+    void TransferTo(mitk::SliceOccupancyIndex &index, unsigned int timeStep) const
+    {
+      for (const auto &labelCounts : m_Counts)
+      {
+        for (unsigned int dim = 0; dim < 3; ++dim)
+        {
+          const auto &counts = labelCounts.second[dim];
+          for (unsigned int slice = 0; slice < counts.size(); ++slice)
+          {
+            if (0 != counts[slice])
+              index.AddToSlice(timeStep, dim, slice, labelCounts.first, counts[slice]);
+          }
+        }
+      }
+    }
+
+  private:
+    using LabelCountsType = std::array<std::vector<long long>, 3>;
+
+    std::array<unsigned int, 3> m_Dimensions;
+    std::map<LabelValueType, LabelCountsType> m_Counts;
+    LabelValueType m_LastLabel;
+    LabelCountsType *m_LastCounts;
+  };
+
+  // changes are transferred to the index in batches to limit the memory needed for large difference volumes
+  constexpr std::size_t MaxNumberOfPendingChanges = 1 << 20;
 }
 
 mitk::SegmentationInterpolationController::InterpolatorMapType
@@ -108,8 +176,8 @@ void mitk::SegmentationInterpolationController::BlockModified(bool block)
 
 void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Image *segmentation)
 {
-  // clear old information (remove all time steps
-  m_SegmentationCountInSlice.clear();
+  // clear old information (remove all time steps)
+  m_SliceOccupancy.Initialize(0);
 
   // delete this from the list of interpolators
   auto iter = s_InterpolatorForImage.find(segmentation);
@@ -143,17 +211,7 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
   m_SegmentationModifiedObserverTag.first = segmentation->AddObserver(itk::ModifiedEvent(), command);
   m_SegmentationModifiedObserverTag.second = true;
 
-  m_SegmentationCountInSlice.resize(m_Segmentation->GetTimeSteps());
-  for (unsigned int timeStep = 0; timeStep < m_Segmentation->GetTimeSteps(); ++timeStep)
-  {
-    m_SegmentationCountInSlice[timeStep].resize(3);
-    for (unsigned int dim = 0; dim < 3; ++dim)
-    {
-      m_SegmentationCountInSlice[timeStep][dim].clear();
-      m_SegmentationCountInSlice[timeStep][dim].resize(m_Segmentation->GetDimension(dim));
-      m_SegmentationCountInSlice[timeStep][dim].assign(m_Segmentation->GetDimension(dim), 0);
-    }
-  }
+  m_SliceOccupancy.Initialize(m_Segmentation->GetTimeSteps());
 
   s_InterpolatorForImage.insert(std::make_pair(m_Segmentation, this));
 
@@ -161,11 +219,7 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
   // scan whole image
   for (unsigned int timeStep = 0; timeStep < m_Segmentation->GetTimeSteps(); ++timeStep)
   {
-    ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
-    timeSelector->SetInput(m_Segmentation);
-    timeSelector->SetTimeNr(timeStep);
-    timeSelector->UpdateLargestPossibleRegion();
-    Image::Pointer segmentation3D = timeSelector->GetOutput();
+    auto segmentation3D = this->GetSegmentationAtTimeStep(timeStep);
     AccessFixedDimensionByItk_2(segmentation3D, ScanWholeVolume, 3, m_Segmentation, timeStep);
   }
 
@@ -211,8 +265,11 @@ void mitk::SegmentationInterpolationController::SetChangedVolume(const Image *sl
     return;
   if (sliceDiff->GetDimension() != 3)
     return;
+  if (m_Segmentation.IsNull() || timeStep >= m_SliceOccupancy.GetNumberOfTimeSteps())
+    return;
 
-  AccessFixedDimensionByItk_1(sliceDiff, ScanChangedVolume, 3, timeStep);
+  auto segmentation3D = this->GetSegmentationAtTimeStep(timeStep);
+  AccessFixedDimensionByItk_2(sliceDiff, ScanChangedVolume, 3, segmentation3D, timeStep);
 
   // PrintStatus();
   Modified();
@@ -227,9 +284,9 @@ void mitk::SegmentationInterpolationController::SetChangedSlice(const Image *sli
     return;
   if (sliceDimension > 2)
     return;
-  if (timeStep >= m_SegmentationCountInSlice.size())
+  if (m_Segmentation.IsNull() || timeStep >= m_SliceOccupancy.GetNumberOfTimeSteps())
     return;
-  if (sliceIndex >= m_SegmentationCountInSlice[timeStep][sliceDimension].size())
+  if (sliceIndex >= m_Segmentation->GetDimension(sliceDimension))
     return;
 
   unsigned int dim0(0);
@@ -258,67 +315,51 @@ void mitk::SegmentationInterpolationController::SetChangedSlice(const Image *sli
   if (!rawSlice)
     return;
 
-  AccessFixedDimensionByItk_1(
-    sliceDiff, ScanChangedSlice, 2, SetChangedSliceOptions(sliceDimension, sliceIndex, dim0, dim1, timeStep, rawSlice));
+  PixelChangeVectorType changes;
+  AccessFixedDimensionByItk_2(sliceDiff,
+                              ScanChangedSlice,
+                              2,
+                              SetChangedSliceOptions(sliceDimension, sliceIndex, dim0, dim1, timeStep, rawSlice),
+                              changes);
+
+  this->UpdateSliceOccupancy(this->GetSegmentationAtTimeStep(timeStep), changes, timeStep);
 
   Modified();
 }
 
 template <typename DATATYPE>
 void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Image<DATATYPE, 2> *,
-                                                                 const SetChangedSliceOptions &options)
+                                                                 const SetChangedSliceOptions &options,
+                                                                 PixelChangeVectorType &changes)
 {
-  auto *pixelData((DATATYPE *)options.pixelData);
-
-  unsigned int timeStep(options.timeStep);
-
-  unsigned int sliceDimension(options.sliceDimension);
-  unsigned int sliceIndex(options.sliceIndex);
-
-  if (sliceDimension > 2)
-    return;
-  if (sliceIndex >= m_SegmentationCountInSlice[timeStep][sliceDimension].size())
-    return;
+  const auto *pixelData(static_cast<const DATATYPE *>(options.pixelData));
 
-  unsigned int dim0(options.dim0);
-  unsigned int dim1(options.dim1);
+  const unsigned int dim0max = m_Segmentation->GetDimension(options.dim0);
+  const unsigned int dim1max = m_Segmentation->GetDimension(options.dim1);
 
-  int numberOfPixels(0); // number of pixels in this slice that are not 0
+  PixelChange change;
+  change.Index[options.sliceDimension] = options.sliceIndex;
 
-  unsigned int dim0max = m_SegmentationCountInSlice[timeStep][dim0].size();
-  unsigned int dim1max = m_SegmentationCountInSlice[timeStep][dim1].size();
-
-  // scan the slice from two directions
-  // and set the flags for the two dimensions of the slice
+  // only the changed pixels are relevant, all others keep their label
   for (unsigned int v = 0; v < dim1max; ++v)
   {
+    const DATATYPE *row = pixelData + v * dim0max;
     for (unsigned int u = 0; u < dim0max; ++u)
     {
-      DATATYPE value = *(pixelData + u + v * dim0max);
-
-      assert((signed)m_SegmentationCountInSlice[timeStep][dim0][u] + (signed)value >=
-             0); // just for debugging. This must always be true, otherwise some counting is going wrong
-      assert((signed)m_SegmentationCountInSlice[timeStep][dim1][v] + (signed)value >= 0);
-
-      m_SegmentationCountInSlice[timeStep][dim0][u] =
-        static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim0][u] + value);
-      m_SegmentationCountInSlice[timeStep][dim1][v] =
-        static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim1][v] + value);
-      numberOfPixels += static_cast<int>(value);
+      if (0 != row[u])
+      {
+        change.Index[options.dim0] = u;
+        change.Index[options.dim1] = v;
+        change.Difference = static_cast<double>(row[u]);
+        changes.push_back(change);
+      }
     }
   }
-
-  // flag for the dimension of the slice itself
-  assert((signed)m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] + numberOfPixels >= 0);
-  m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] += numberOfPixels;
-
-  // MITK_INFO << "scan t=" << timeStep << " from (0,0) to (" << dim0max << "," << dim1max << ") (" << pixelData << "-"
-  // << pixelData+dim0max*dim1max-1 <<  ") in slice " << sliceIndex << " found " << numberOfPixels << " pixels" <<
-  // std::endl;
 }
 
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Image<TPixel, VImageDimension> *diffImage,
+                                                                  const Image *segmentation3D,
                                                                   unsigned int timeStep)
 {
   typedef itk::ImageSliceConstIteratorWithIndex<itk::Image<TPixel, VImageDimension>> IteratorType;
@@ -327,12 +368,8 @@ void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Ima
   iter.SetFirstDirection(0);
   iter.SetSecondDirection(1);
 
-  int numberOfPixels(0); // number of pixels in this slice that are not 0
-
-  typename IteratorType::IndexType index;
-  unsigned int x = 0;
-  unsigned int y = 0;
-  unsigned int z = 0;
+  PixelChangeVectorType changes;
+  PixelChange change;
 
   iter.GoToBegin();
   while (!iter.IsAtEnd())
@@ -341,115 +378,145 @@ void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Ima
     {
       while (!iter.IsAtEndOfLine())
       {
-        index = iter.GetIndex();
+        const TPixel value = iter.Get();
+        if (0 != value)
+        {
+          const auto &index = iter.GetIndex();
+          for (unsigned int dim = 0; dim < 3; ++dim)
+            change.Index[dim] = static_cast<unsigned int>(index[dim]);
+          change.Difference = static_cast<double>(value);
+          changes.push_back(change);
+        }
+        ++iter;
+      }
+      iter.NextLine();
+    }
 
-        x = index[0];
-        y = index[1];
-        z = index[2];
+    if (MaxNumberOfPendingChanges <= changes.size())
+    {
+      this->UpdateSliceOccupancy(segmentation3D, changes, timeStep);
+      changes.clear();
+    }
+
+    iter.NextSlice();
+  }
 
-        TPixel value = iter.Get();
+  this->UpdateSliceOccupancy(segmentation3D, changes, timeStep);
+}
 
-        assert((signed)m_SegmentationCountInSlice[timeStep][0][x] + (signed)value >=
-               0); // just for debugging. This must always be true, otherwise some counting is going wrong
-        assert((signed)m_SegmentationCountInSlice[timeStep][1][y] + (signed)value >= 0);
+void mitk::SegmentationInterpolationController::UpdateSliceOccupancy(const Image *segmentation3D,
+                                                                     const PixelChangeVectorType &changes,
+                                                                     unsigned int timeStep)
+{
+  if (changes.empty() || nullptr == segmentation3D)
+    return;
 
-        m_SegmentationCountInSlice[timeStep][0][x] =
-          static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][0][x] + value);
-        m_SegmentationCountInSlice[timeStep][1][y] =
-          static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][1][y] + value);
+  AccessFixedDimensionByItk_2(segmentation3D, UpdateSliceOccupancyFromChanges, 3, changes, timeStep);
+}
 
-        numberOfPixels += static_cast<int>(value);
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::SegmentationInterpolationController::UpdateSliceOccupancyFromChanges(
+  const itk::Image<TPixel, VImageDimension> *segmentation3D, const PixelChangeVectorType &changes, unsigned int timeStep)
+{
+  const auto size = segmentation3D->GetLargestPossibleRegion().GetSize();
+  const TPixel *buffer = segmentation3D->GetBufferPointer();
 
-        ++iter;
-      }
-      iter.NextLine();
-    }
-    assert((signed)m_SegmentationCountInSlice[timeStep][2][z] + numberOfPixels >= 0);
-    m_SegmentationCountInSlice[timeStep][2][z] += numberOfPixels;
-    numberOfPixels = 0;
+  // the segmentation already contains the new values, the old ones are restored from the difference
+  SliceCountAccumulator accumulator(size[0], size[1], size[2]);
+  for (const auto &change : changes)
+  {
+    const auto newValue = static_cast<double>(
+      buffer[change.Index[0] + size[0] * (change.Index[1] + static_cast<std::size_t>(size[1]) * change.Index[2])]);
+    const auto oldValue = newValue - change.Difference;
 
-    iter.NextSlice();
+    accumulator.Add(oldValue, change.Index, -1);
+    accumulator.Add(newValue, change.Index, 1);
   }
+
+  accumulator.TransferTo(m_SliceOccupancy, timeStep);
 }
 
 template <typename DATATYPE>
-void mitk::SegmentationInterpolationController::ScanWholeVolume(const itk::Image<DATATYPE, 3> *,
+void mitk::SegmentationInterpolationController::ScanWholeVolume(const itk::Image<DATATYPE, 3> *image,
                                                                 const Image *volume,
                                                                 unsigned int timeStep)
 {
   if (!volume)
     return;
-  if (timeStep >= m_SegmentationCountInSlice.size())
+  if (timeStep >= m_SliceOccupancy.GetNumberOfTimeSteps())
     return;
 
-  ImageReadAccessor readAccess(volume, volume->GetVolumeData(timeStep));
+  const auto size = image->GetLargestPossibleRegion().GetSize();
+  const DATATYPE *rawVolume = image->GetBufferPointer();
 
-  for (unsigned int slice = 0; slice < volume->GetDimension(2); ++slice)
-  {
-    const auto *rawVolume =
-      static_cast<const DATATYPE *>(readAccess.GetData()); // we again promise not to change anything, we'll just count
-    const DATATYPE *rawSlice = rawVolume + (volume->GetDimension(0) * volume->GetDimension(1) * slice);
+  // every work unit counts a block of slices, the counts are summed up afterwards
+  const unsigned int numberOfBlocks =
+    std::max(1u, std::min(static_cast<unsigned int>(size[2]), itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads()));
+  std::vector<SliceCountAccumulator> accumulators(numberOfBlocks, SliceCountAccumulator(size[0], size[1], size[2]));
 
-    ScanChangedSlice<DATATYPE>(nullptr, SetChangedSliceOptions(2, slice, 0, 1, timeStep, rawSlice));
-  }
+  auto scanBlock = [&](itk::SizeValueType block) {
+    const auto firstSlice = static_cast<unsigned int>(block * size[2] / numberOfBlocks);
+    const auto endSlice = static_cast<unsigned int>((block + 1) * size[2] / numberOfBlocks);
+    auto &accumulator = accumulators[block];
+
+    unsigned int index[3];
+    for (index[2] = firstSlice; index[2] < endSlice; ++index[2])
+    {
+      const DATATYPE *rawSlice = rawVolume + static_cast<std::size_t>(size[0]) * size[1] * index[2];
+      for (index[1] = 0; index[1] < size[1]; ++index[1])
+      {
+        const DATATYPE *row = rawSlice + static_cast<std::size_t>(size[0]) * index[1];
+        for (index[0] = 0; index[0] < size[0]; ++index[0])
+        {
+          if (0 != row[index[0]])
+            accumulator.Add(static_cast<double>(row[index[0]]), index, 1);
+        }
+      }
+    }
+  };
+
+  auto multiThreader = itk::MultiThreaderBase::New();
+  multiThreader->SetNumberOfWorkUnits(numberOfBlocks);
+  multiThreader->ParallelizeArray(0, numberOfBlocks, scanBlock, nullptr);
+
+  for (const auto &accumulator : accumulators)
+    accumulator.TransferTo(m_SliceOccupancy, timeStep);
+}
+
+mitk::Image::ConstPointer mitk::SegmentationInterpolationController::GetSegmentationAtTimeStep(unsigned int timeStep) const
+{
+  ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
+  timeSelector->SetInput(m_Segmentation);
+  timeSelector->SetTimeNr(timeStep);
+  timeSelector->UpdateLargestPossibleRegion();
+  return timeSelector->GetOutput();
+}
+
+const mitk::SliceOccupancyIndex &mitk::SegmentationInterpolationController::GetSliceOccupancyIndex() const
+{
+  return m_SliceOccupancy;
 }
 
 void mitk::SegmentationInterpolationController::PrintStatus()
 {
   unsigned int timeStep(0); // if needed, put a loop over time steps around everyting, but beware, output will be long
 
-  MITK_INFO << "Interpolator status (timestep 0): dimensions " << m_SegmentationCountInSlice[timeStep][0].size() << " "
-            << m_SegmentationCountInSlice[timeStep][1].size() << " " << m_SegmentationCountInSlice[timeStep][2].size()
-            << std::endl;
-
-  MITK_INFO << "Slice 0: " << m_SegmentationCountInSlice[timeStep][2][0] << std::endl;
+  if (m_Segmentation.IsNull() || timeStep >= m_SliceOccupancy.GetNumberOfTimeSteps())
+    return;
 
-  // row "x"
-  for (unsigned int index = 0; index < m_SegmentationCountInSlice[timeStep][0].size(); ++index)
-  {
-    if (m_SegmentationCountInSlice[timeStep][0][index] > 0)
-      MITK_INFO << "O";
-    else
-      MITK_INFO << ".";
-  }
-  MITK_INFO << std::endl;
+  MITK_INFO << "Interpolator status (timestep 0): dimensions " << m_Segmentation->GetDimension(0) << " "
+            << m_Segmentation->GetDimension(1) << " " << m_Segmentation->GetDimension(2) << std::endl;
 
-  // rows "y" and "z" (diagonal)
-  for (unsigned int index = 1; index < m_SegmentationCountInSlice[timeStep][1].size(); ++index)
+  for (const auto label : m_SliceOccupancy.GetLabels(timeStep))
   {
-    if (m_SegmentationCountInSlice[timeStep][1][index] > 0)
-      MITK_INFO << "O";
-    else
-      MITK_INFO << ".";
-
-    if (m_SegmentationCountInSlice[timeStep][2].size() > index) // if we also have a z value here, then print it, too
+    for (unsigned int dim = 0; dim < 3; ++dim)
     {
-      for (unsigned int indent = 1; indent < index; ++indent)
-        MITK_INFO << " ";
+      std::string occupancy;
+      for (unsigned int index = 0; index < m_Segmentation->GetDimension(dim); ++index)
+        occupancy += m_SliceOccupancy.GetCount(timeStep, dim, index, label) > 0 ? 'O' : '.';
 
-      if (m_SegmentationCountInSlice[timeStep][2][index] > 0)
-        MITK_INFO << m_SegmentationCountInSlice[timeStep][2][index]; //"O";
-      else
-        MITK_INFO << ".";
+      MITK_INFO << "Label " << label << ", dimension " << dim << ": " << occupancy << std::endl;
     }
-
-    MITK_INFO << std::endl;
-  }
-
-  // z indices that are larger than the biggest y index
-  for (unsigned int index = m_SegmentationCountInSlice[timeStep][1].size();
-       index < m_SegmentationCountInSlice[timeStep][2].size();
-       ++index)
-  {
-    for (unsigned int indent = 0; indent < index; ++indent)
-      MITK_INFO << " ";
-
-    if (m_SegmentationCountInSlice[timeStep][2][index] > 0)
-      MITK_INFO << m_SegmentationCountInSlice[timeStep][2][index]; //"O";
-    else
-      MITK_INFO << ".";
-
-    MITK_INFO << std::endl;
   }
 }
 
@@ -462,7 +529,7 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   if (m_Segmentation.IsNull() || nullptr == currentPlane)
     return nullptr;
 
-  if (timeStep >= m_SegmentationCountInSlice.size())
+  if (timeStep >= m_SliceOccupancy.GetNumberOfTimeSteps())
     return nullptr;
 
   if (sliceDimension > 2)
@@ -471,45 +538,21 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
   if (0 == sliceIndex)
     return nullptr; // First slice, nothing to interpolate
 
-  const unsigned int lastSliceIndex = m_SegmentationCountInSlice[timeStep][sliceDimension].size() - 1;
+  const unsigned int lastSliceIndex = m_Segmentation->GetDimension(sliceDimension) - 1;
 
   if (lastSliceIndex <= sliceIndex)
     return nullptr; // Last slice, nothing to interpolate
 
-  if (m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] > 0)
+  if (m_SliceOccupancy.GetCount(timeStep, sliceDimension, sliceIndex) > 0)
     return nullptr; // Slice contains segmentation, nothing to interopolate
 
   unsigned int lowerBound = 0;
   unsigned int upperBound = 0;
-  bool bounds = false;
-
-  for (lowerBound = sliceIndex - 1; ; --lowerBound)
-  {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][lowerBound] > 0)
-    {
-      bounds = true;
-      break;
-    }
 
-    if (0 == lowerBound)
-      break;
-  }
-
-  if (!bounds)
+  if (!m_SliceOccupancy.FindSegmentedSliceBelow(timeStep, sliceDimension, sliceIndex, lowerBound))
     return nullptr;
 
-  bounds = false;
-
-  for (upperBound = sliceIndex + 1; upperBound <= lastSliceIndex; ++upperBound)
-  {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][upperBound] > 0)
-    {
-      bounds = true;
-      break;
-    }
-  }
-
-  if (!bounds)
+  if (!m_SliceOccupancy.FindSegmentedSliceAbove(timeStep, sliceDimension, sliceIndex, upperBound))
     return nullptr;
 
   // We have found two neighboring slices with segmentations and made sure that the current slice does not contain anything
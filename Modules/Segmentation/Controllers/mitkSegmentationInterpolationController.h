@@ -17,6 +17,7 @@ found in the LICENSE file.
 #include "mitkImage.h"
 #include <MitkSegmentationExports.h>
 #include <mitkShapeBasedInterpolationAlgorithm.h>
+#include <mitkSliceOccupancyIndex.h>
 
 #include <itkImage.h>
 #include <itkObjectFactory.h>
@@ -39,7 +40,7 @@ namespace mitk
     \ingroup ToolManagerEtAl
 
     This class keeps track of the contents of a 3D segmentation image.
-    \attention mitk::SegmentationInterpolationController assumes that the image contains pixel values of 0 and 1.
+    Pixels other than 0 are segmented, every pixel value is treated as a label of its own.
 
     After you set the segmentation image using SetSegmentationVolume(), the whole image is scanned for pixels other than
     0.
@@ -56,9 +57,9 @@ namespace mitk
     instance for a specified image. OverwriteImageFilter uses this to get to know its interpolator.
 
     SegmentationInterpolationController needs to maintain some information about the image slices (in every dimension).
-    This information is stored internally in m_SegmentationCountInSlice, which is basically three std::vectors (one for
-    each dimension).
-    Each item describes one image dimension, each vector item holds the count of pixels in "its" slice.
+    This information is stored internally in a SliceOccupancyIndex, which holds the number of pixels of each label in
+    every segmented slice. It is built in parallel when the segmentation is set and is updated only from the changed
+    pixels of the difference images afterwards.
 
     $Author$
   */
@@ -119,6 +120,9 @@ namespace mitk
       \param sliceIndex Which slice to take, in the direction specified by sliceDimension. Count starts from 0.
 
       \param timeStep Which time step is changed
+
+      The segmentation image must already contain the new pixel values, because the labels that were overwritten are
+      derived from the new values and the difference.
     */
     void SetChangedSlice(const Image *sliceDiff,
                          unsigned int sliceDimension,
@@ -147,6 +151,11 @@ namespace mitk
 
     void OnImageModified(const itk::EventObject &);
 
+    /**
+      \brief Slices that contain segmented pixels, per label and per dimension of the segmentation.
+    */
+    const SliceOccupancyIndex &GetSliceOccupancyIndex() const;
+
     /**
      * Activate/Deactivate the 2D interpolation.
     */
@@ -188,10 +197,13 @@ namespace mitk
       const void *pixelData;
     };
 
-    typedef std::vector<unsigned int> DirtyVectorType;
-    // typedef std::vector< DirtyVectorType[3] > TimeResolvedDirtyVectorType; // cannot work with C++, so next line is
-    // used for implementation
-    typedef std::vector<std::vector<DirtyVectorType>> TimeResolvedDirtyVectorType;
+    /** A changed pixel of the segmentation: its index and the difference (new value minus old value). */
+    struct PixelChange
+    {
+      unsigned int Index[3];
+      double Difference;
+    };
+    typedef std::vector<PixelChange> PixelChangeVectorType;
     typedef std::map<const Image *, SegmentationInterpolationController *> InterpolatorMapType;
 
     SegmentationInterpolationController(); // purposely hidden
@@ -199,14 +211,28 @@ namespace mitk
 
     /// internal scan of a single slice
     template <typename DATATYPE>
-    void ScanChangedSlice(const itk::Image<DATATYPE, 2> *, const SetChangedSliceOptions &options);
+    void ScanChangedSlice(const itk::Image<DATATYPE, 2> *,
+                          const SetChangedSliceOptions &options,
+                          PixelChangeVectorType &changes);
 
     template <typename TPixel, unsigned int VImageDimension>
-    void ScanChangedVolume(const itk::Image<TPixel, VImageDimension> *, unsigned int timeStep);
+    void ScanChangedVolume(const itk::Image<TPixel, VImageDimension> *,
+                           const Image *segmentation3D,
+                           unsigned int timeStep);
 
     template <typename DATATYPE>
     void ScanWholeVolume(const itk::Image<DATATYPE, 3> *, const Image *volume, unsigned int timeStep);
 
+    /// moves the pixel counts of the changed pixels from their old to their new label
+    void UpdateSliceOccupancy(const Image *segmentation3D, const PixelChangeVectorType &changes, unsigned int timeStep);
+
+    template <typename TPixel, unsigned int VImageDimension>
+    void UpdateSliceOccupancyFromChanges(const itk::Image<TPixel, VImageDimension> *segmentation3D,
+                                         const PixelChangeVectorType &changes,
+                                         unsigned int timeStep);
+
+    Image::ConstPointer GetSegmentationAtTimeStep(unsigned int timeStep) const;
+
     void PrintStatus();
 
     /**
@@ -215,15 +241,10 @@ namespace mitk
     mitk::Image::Pointer ExtractSlice(const PlaneGeometry* planeGeometry, unsigned int sliceIndex, unsigned int timeStep, bool cache = false);
 
     /**
-      An array of flags. One for each dimension of the image. A flag is set, when a slice in a certain dimension
-      has at least one pixel that is not 0 (which would mean that it has to be considered by the interpolation
-      algorithm).
-
-      E.g. flags for axial slices are stored in m_SegmentationCountInSlice[0][index].
-
-      Enhanced with time steps it is now m_SegmentationCountInSlice[timeStep][0][index]
+      Number of segmented pixels per label in the slices of every dimension and time step. A slice has to be
+      considered by the interpolation algorithm if it has at least one segmented pixel.
     */
-    TimeResolvedDirtyVectorType m_SegmentationCountInSlice;
+    SliceOccupancyIndex m_SliceOccupancy;
 
     static InterpolatorMapType s_InterpolatorForImage;
 
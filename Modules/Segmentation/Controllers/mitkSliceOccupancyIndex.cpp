@@ -0,0 +1,182 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkSliceOccupancyIndex.h"
+
+#include <mitkLogMacros.h>
+
+void mitk::SliceOccupancyIndex::Initialize(unsigned int timeSteps)
+{
+  m_Counts.clear();
+  m_Counts.resize(timeSteps);
+}
+
+unsigned int mitk::SliceOccupancyIndex::GetNumberOfTimeSteps() const
+{
+  return static_cast<unsigned int>(m_Counts.size());
+}
+
+void mitk::SliceOccupancyIndex::AddToSlice(
+  unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label, long long delta)
+{
+  if (0 == delta || 0 == label || timeStep >= m_Counts.size() || axis > 2)
+    return;
+
+  auto &axisCounts = m_Counts[timeStep][axis];
+  AddToSlice(axisCounts.AllLabels, slice, delta);
+
+  auto labelIter = axisCounts.Labels.find(label);
+  if (labelIter == axisCounts.Labels.end())
+    labelIter = axisCounts.Labels.emplace(label, SliceCountMapType()).first;
+
+  AddToSlice(labelIter->second, slice, delta);
+
+  if (labelIter->second.empty())
+    axisCounts.Labels.erase(labelIter);
+}
+
+void mitk::SliceOccupancyIndex::AddToSlice(SliceCountMapType &counts, unsigned int slice, long long delta)
+{
+  auto iter = counts.find(slice);
+  const CountType count = iter != counts.end() ? iter->second : 0;
+
+  if (delta < 0 && count < static_cast<CountType>(-delta))
+  {
+    // must never happen, otherwise some counting is going wrong
+    MITK_WARN << "Slice occupancy of slice " << slice << " would become negative. Ignoring the difference.";
+    delta = -static_cast<long long>(count);
+  }
+
+  const CountType newCount = count + delta;
+  if (0 == newCount)
+  {
+    if (iter != counts.end())
+      counts.erase(iter);
+  }
+  else if (iter != counts.end())
+  {
+    iter->second = newCount;
+  }
+  else
+  {
+    counts.emplace(slice, newCount);
+  }
+}
+
+const mitk::SliceOccupancyIndex::SliceCountMapType *mitk::SliceOccupancyIndex::GetSliceCounts(
+  unsigned int timeStep, unsigned int axis, LabelValueType label) const
+{
+  if (timeStep >= m_Counts.size() || axis > 2)
+    return nullptr;
+
+  const auto &labels = m_Counts[timeStep][axis].Labels;
+  auto iter = labels.find(label);
+  return iter != labels.end() ? &iter->second : nullptr;
+}
+
+mitk::SliceOccupancyIndex::CountType mitk::SliceOccupancyIndex::GetCount(unsigned int timeStep,
+                                                                          unsigned int axis,
+                                                                          unsigned int slice) const
+{
+  if (timeStep >= m_Counts.size() || axis > 2)
+    return 0;
+
+  const auto &counts = m_Counts[timeStep][axis].AllLabels;
+  auto iter = counts.find(slice);
+  return iter != counts.end() ? iter->second : 0;
+}
+
+mitk::SliceOccupancyIndex::CountType mitk::SliceOccupancyIndex::GetCount(unsigned int timeStep,
+                                                                          unsigned int axis,
+                                                                          unsigned int slice,
+                                                                          LabelValueType label) const
+{
+  auto counts = this->GetSliceCounts(timeStep, axis, label);
+  if (nullptr == counts)
+    return 0;
+
+  auto iter = counts->find(slice);
+  return iter != counts->end() ? iter->second : 0;
+}
+
+std::vector<mitk::SliceOccupancyIndex::LabelValueType> mitk::SliceOccupancyIndex::GetLabels(unsigned int timeStep) const
+{
+  std::vector<LabelValueType> labels;
+  if (timeStep >= m_Counts.size())
+    return labels;
+
+  // every labeled pixel lies in a slice of each axis, so one axis knows all labels
+  for (const auto &labelCounts : m_Counts[timeStep][2].Labels)
+    labels.push_back(labelCounts.first);
+
+  return labels;
+}
+
+bool mitk::SliceOccupancyIndex::FindBelow(const SliceCountMapType *counts, unsigned int slice, unsigned int &result)
+{
+  if (nullptr == counts)
+    return false;
+
+  auto iter = counts->lower_bound(slice);
+  if (iter == counts->begin())
+    return false;
+
+  result = (--iter)->first;
+  return true;
+}
+
+bool mitk::SliceOccupancyIndex::FindAbove(const SliceCountMapType *counts, unsigned int slice, unsigned int &result)
+{
+  if (nullptr == counts)
+    return false;
+
+  auto iter = counts->upper_bound(slice);
+  if (iter == counts->end())
+    return false;
+
+  result = iter->first;
+  return true;
+}
+
+bool mitk::SliceOccupancyIndex::FindSegmentedSliceBelow(unsigned int timeStep,
+                                                        unsigned int axis,
+                                                        unsigned int slice,
+                                                        unsigned int &result) const
+{
+  if (timeStep >= m_Counts.size() || axis > 2)
+    return false;
+
+  return FindBelow(&m_Counts[timeStep][axis].AllLabels, slice, result);
+}
+
+bool mitk::SliceOccupancyIndex::FindSegmentedSliceBelow(
+  unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label, unsigned int &result) const
+{
+  return FindBelow(this->GetSliceCounts(timeStep, axis, label), slice, result);
+}
+
+bool mitk::SliceOccupancyIndex::FindSegmentedSliceAbove(unsigned int timeStep,
+                                                        unsigned int axis,
+                                                        unsigned int slice,
+                                                        unsigned int &result) const
+{
+  if (timeStep >= m_Counts.size() || axis > 2)
+    return false;
+
+  return FindAbove(&m_Counts[timeStep][axis].AllLabels, slice, result);
+}
+
+bool mitk::SliceOccupancyIndex::FindSegmentedSliceAbove(
+  unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label, unsigned int &result) const
+{
+  return FindAbove(this->GetSliceCounts(timeStep, axis, label), slice, result);
+}
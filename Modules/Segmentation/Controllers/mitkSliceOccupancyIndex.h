@@ -0,0 +1,101 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkSliceOccupancyIndex_h_Included
+#define mitkSliceOccupancyIndex_h_Included
+
+#include <MitkSegmentationExports.h>
+
+#include <array>
+#include <map>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Number of segmented pixels per label in the slices of a 3D+t segmentation.
+
+    For every time step and every axis of the image, the index knows which slices (perpendicular to the axis)
+    contain pixels of which label. Only slices that contain pixels are stored, so the memory needed depends
+    on the number of segmented slices and labels and not on the size of the image. Finding the nearest
+    segmented slice above or below a given slice takes logarithmic time.
+
+    Label value 0 is the background and not counted.
+
+    \sa SegmentationInterpolationController
+  */
+  class MITKSEGMENTATION_EXPORT SliceOccupancyIndex
+  {
+  public:
+    using LabelValueType = double;
+    using CountType = unsigned long long;
+
+    /** Removes all counts and prepares the index for the given number of time steps. */
+    void Initialize(unsigned int timeSteps);
+
+    unsigned int GetNumberOfTimeSteps() const;
+
+    /**
+      \brief Changes the number of pixels of a label in a slice.
+      \param delta Number of pixels added (or removed if negative).
+    */
+    void AddToSlice(unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label, long long delta);
+
+    /** Number of segmented pixels (of any label) in a slice. */
+    CountType GetCount(unsigned int timeStep, unsigned int axis, unsigned int slice) const;
+
+    /** Number of pixels of a label in a slice. */
+    CountType GetCount(unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label) const;
+
+    /** All labels that have pixels in the time step, in ascending order. */
+    std::vector<LabelValueType> GetLabels(unsigned int timeStep) const;
+
+    /**
+      \brief Finds the nearest slice below (smaller index than) the given slice that contains segmented pixels.
+      \return false if there is no such slice.
+    */
+    bool FindSegmentedSliceBelow(unsigned int timeStep, unsigned int axis, unsigned int slice, unsigned int &result) const;
+
+    /** Like FindSegmentedSliceBelow(), but only considers pixels of the given label. */
+    bool FindSegmentedSliceBelow(
+      unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label, unsigned int &result) const;
+
+    /**
+      \brief Finds the nearest slice above (greater index than) the given slice that contains segmented pixels.
+      \return false if there is no such slice.
+    */
+    bool FindSegmentedSliceAbove(unsigned int timeStep, unsigned int axis, unsigned int slice, unsigned int &result) const;
+
+    /** Like FindSegmentedSliceAbove(), but only considers pixels of the given label. */
+    bool FindSegmentedSliceAbove(
+      unsigned int timeStep, unsigned int axis, unsigned int slice, LabelValueType label, unsigned int &result) const;
+
+  private:
+    using SliceCountMapType = std::map<unsigned int, CountType>;
+
+    struct AxisCounts
+    {
+      SliceCountMapType AllLabels;
+      std::map<LabelValueType, SliceCountMapType> Labels;
+    };
+
+    const SliceCountMapType *GetSliceCounts(unsigned int timeStep, unsigned int axis, LabelValueType label) const;
+
+    static void AddToSlice(SliceCountMapType &counts, unsigned int slice, long long delta);
+    static bool FindBelow(const SliceCountMapType *counts, unsigned int slice, unsigned int &result);
+    static bool FindAbove(const SliceCountMapType *counts, unsigned int slice, unsigned int &result);
+
+    std::vector<std::array<AxisCounts, 3>> m_Counts;
+  };
+}
+
+#endif
@@ -31,8 +31,38 @@ found in the LICENSE file.
 #include "mitkPadImageFilter.h"
 #include "mitkNodePredicateGeometry.h"
 #include "mitkSegTool2D.h"
+#include <mitkBaseRenderer.h>
+#include <mitkCallbackFromGUIThread.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkStdFunctionCommand.h>
 
-mitk::AutoSegmentationWithPreviewTool::AutoSegmentationWithPreviewTool(bool lazyDynamicPreviews): m_LazyDynamicPreviews(lazyDynamicPreviews)
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+  /** Number of slices that are computed at once by the background preview computation.
+   * Cancellation is checked between two blocks.*/
+  const unsigned int BackgroundPreviewBlockSize = 8;
+}
+
+struct mitk::AutoSegmentationWithPreviewTool::BackgroundPreview
+{
+  /** Tool that waits for the result. Only accessed in the GUI thread; reset if the tool does not wait anymore.*/
+  AutoSegmentationWithPreviewTool* Tool = nullptr;
+  /** Set in the GUI thread to stop the computation after the current block.*/
+  std::atomic<bool> Canceled{ false };
+  /** Set by the background thread if all blocks were computed.*/
+  std::atomic<bool> Finished{ false };
+  /** Private result of the background thread with a single time step. It is read in the
+   * GUI thread only after the thread has been joined.*/
+  Image::Pointer Buffer;
+  TimeStepType TimeStep = 0;
+};
+
+mitk::AutoSegmentationWithPreviewTool::AutoSegmentationWithPreviewTool(bool lazyDynamicPreviews)
+  : m_LazyDynamicPreviews(lazyDynamicPreviews)
 {
   m_ProgressCommand = ToolCommand::New();
 }
@@ -44,6 +74,7 @@ mitk::AutoSegmentationWithPreviewTool::AutoSegmentationWithPreviewTool(bool lazy
 
 mitk::AutoSegmentationWithPreviewTool::~AutoSegmentationWithPreviewTool()
 {
+  this->CancelBackgroundPreview();
 }
 
 bool mitk::AutoSegmentationWithPreviewTool::CanHandle(const BaseData* referenceData, const BaseData* workingData) const
@@ -107,6 +138,8 @@ void mitk::AutoSegmentationWithPreviewTool::Activated()
 
 void mitk::AutoSegmentationWithPreviewTool::Deactivated()
 {
+  this->CancelBackgroundPreview();
+
   this->GetToolManager()->RoiDataChanged -=
     MessageDelegate<AutoSegmentationWithPreviewTool>(this, &AutoSegmentationWithPreviewTool::OnRoiDataChanged);
 
@@ -146,6 +179,9 @@ void mitk::AutoSegmentationWithPreviewTool::ConfirmSegmentation()
     this->UpdatePreview(true);
   }
 
+  // the preview has to be complete before it is transferred
+  this->FinishBackgroundPreview();
+
   CreateResultSegmentationFromPreview();
 
   RenderingManager::GetInstance()->RequestUpdateAll();
@@ -437,6 +473,9 @@ void mitk::AutoSegmentationWithPreviewTool::OnTimePointChanged()
 
 void mitk::AutoSegmentationWithPreviewTool::UpdatePreview(bool ignoreLazyPreviewSetting)
 {
+  // the background computation of the last update works with outdated parameters
+  this->CancelBackgroundPreview();
+
   const auto inputImage = this->GetSegmentationInput();
   auto previewImage = this->GetPreviewSegmentation();
   int progress_steps = 200;
@@ -507,7 +546,11 @@ void mitk::AutoSegmentationWithPreviewTool::UpdatePreview(bool ignoreLazyPreview
 
         auto timeStep = previewImage->GetTimeGeometry()->TimePointToTimeStep(timePoint);
 
-        this->DoUpdatePreview(feedBackImage, currentSegImage, previewImage, timeStep);
+        if (nullptr != this->GetWorkingPlaneGeometry()
+          || !this->UpdateRegionalPreview(feedBackImage, currentSegImage, previewImage, timeStep))
+        {
+          this->DoUpdatePreview(feedBackImage, currentSegImage, previewImage, timeStep);
+        }
       }
       RenderingManager::GetInstance()->RequestUpdateAll();
     }
@@ -541,6 +584,235 @@ bool mitk::AutoSegmentationWithPreviewTool::IsUpdating() const
   return m_IsUpdating;
 }
 
+bool mitk::AutoSegmentationWithPreviewTool::IsUpdatingInBackground() const
+{
+  return nullptr != m_BackgroundPreview;
+}
+
+bool mitk::AutoSegmentationWithPreviewTool::SupportsRegionalPreview() const
+{
+  return false;
+}
+
+void mitk::AutoSegmentationWithPreviewTool::DoUpdatePreviewRegion(const Image* /*inputAtTimeStep*/, const Image* /*oldSegAtTimeStep*/, Image* /*previewImage*/, TimeStepType /*timeStep*/, const PreviewRegionType& /*region*/)
+{
+  mitkThrow() << "Tool does not support regional previews. DoUpdatePreviewRegion() must be implemented if SupportsRegionalPreview() returns true.";
+}
+
+void mitk::AutoSegmentationWithPreviewTool::CancelBackgroundPreview()
+{
+  if (nullptr != m_BackgroundPreview)
+  {
+    m_BackgroundPreview->Canceled = true;
+    m_BackgroundPreview->Tool = nullptr;
+  }
+
+  if (m_BackgroundPreviewThread.joinable())
+  {
+    m_BackgroundPreviewThread.join();
+  }
+
+  m_BackgroundPreview = nullptr;
+}
+
+void mitk::AutoSegmentationWithPreviewTool::FinishBackgroundPreview()
+{
+  if (m_BackgroundPreviewThread.joinable())
+  {
+    m_BackgroundPreviewThread.join();
+  }
+
+  auto backgroundPreview = m_BackgroundPreview;
+  m_BackgroundPreview = nullptr;
+  if (nullptr == backgroundPreview)
+    return;
+
+  backgroundPreview->Tool = nullptr;
+
+  auto* previewImage = this->GetPreviewSegmentation();
+  if (!backgroundPreview->Finished || nullptr == previewImage)
+    return;
+
+  {
+    ImageReadAccessor accessor(backgroundPreview->Buffer);
+    previewImage->SetVolume(accessor.GetData(), backgroundPreview->TimeStep);
+  }
+  previewImage->Modified();
+  RenderingManager::GetInstance()->RequestUpdateAll();
+}
+
+std::vector<mitk::AutoSegmentationWithPreviewTool::PreviewRegionType> mitk::AutoSegmentationWithPreviewTool::GetVisiblePreviewRegions(const Image* inputAtTimeStep) const
+{
+  std::vector<PreviewRegionType> regions;
+  const auto* geometry = inputAtTimeStep->GetGeometry();
+
+  PreviewRegionType::SizeType inputSize;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    inputSize[i] = inputAtTimeStep->GetDimension(i);
+  }
+  const PreviewRegionType inputRegion(inputSize);
+
+  for (auto* renderWindow : RenderingManager::GetInstance()->GetAllRegisteredRenderWindows())
+  {
+    auto* renderer = BaseRenderer::GetInstance(renderWindow);
+    if (nullptr == renderer || BaseRenderer::Standard2D != renderer->GetMapperID())
+      continue;
+
+    const auto* plane = renderer->GetCurrentWorldPlaneGeometry();
+    if (nullptr == plane)
+      continue;
+
+    // bounding box (in index coordinates) of the four corners of the plane
+    const Point3D origin = plane->GetOrigin();
+    const Vector3D axis0 = plane->GetAxisVector(0);
+    const Vector3D axis1 = plane->GetAxisVector(1);
+    const Point3D corners[4] = { origin, origin + axis0, origin + axis1, origin + axis0 + axis1 };
+
+    Point3D minIndex;
+    Point3D maxIndex;
+    for (unsigned int c = 0; c < 4; ++c)
+    {
+      Point3D index;
+      geometry->WorldToIndex(corners[c], index);
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        minIndex[i] = 0 == c ? index[i] : std::min(minIndex[i], index[i]);
+        maxIndex[i] = 0 == c ? index[i] : std::max(maxIndex[i], index[i]);
+      }
+    }
+
+    PreviewRegionType::IndexType regionIndex;
+    PreviewRegionType::SizeType regionSize;
+    bool isInside = true;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      const auto lower = std::max<itk::IndexValueType>(0, static_cast<itk::IndexValueType>(std::floor(minIndex[i] + 0.5)));
+      const auto upper = std::min<itk::IndexValueType>(inputSize[i] - 1, static_cast<itk::IndexValueType>(std::floor(maxIndex[i] + 0.5)));
+      if (lower > upper)
+      {
+        isInside = false;
+        break;
+      }
+      regionIndex[i] = lower;
+      regionSize[i] = upper - lower + 1;
+    }
+
+    if (isInside)
+    {
+      PreviewRegionType region(regionIndex, regionSize);
+      if (region.Crop(inputRegion))
+        regions.push_back(region);
+    }
+  }
+
+  return regions;
+}
+
+bool mitk::AutoSegmentationWithPreviewTool::UpdateRegionalPreview(const Image* inputAtTimeStep, const Image* oldSegAtTimeStep, Image* previewImage, TimeStepType timeStep)
+{
+  if (!this->SupportsRegionalPreview() || nullptr == inputAtTimeStep || 3 != inputAtTimeStep->GetDimension())
+    return false;
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (inputAtTimeStep->GetDimension(i) != previewImage->GetDimension(i))
+      return false;
+  }
+
+  const auto visibleRegions = this->GetVisiblePreviewRegions(inputAtTimeStep);
+  if (visibleRegions.empty())
+  { // nothing is shown interactively, so there is no reason to split the computation
+    PreviewRegionType::SizeType inputSize;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      inputSize[i] = inputAtTimeStep->GetDimension(i);
+    }
+    this->DoUpdatePreviewRegion(inputAtTimeStep, oldSegAtTimeStep, previewImage, timeStep, PreviewRegionType(inputSize));
+    previewImage->Modified();
+    return true;
+  }
+
+  for (const auto& region : visibleRegions)
+  {
+    this->DoUpdatePreviewRegion(inputAtTimeStep, oldSegAtTimeStep, previewImage, timeStep, region);
+  }
+  previewImage->Modified();
+
+  // The whole volume is computed in blocks of slices into a private buffer, so that the preview
+  // is not written while it is rendered. Visible slices are computed a second time, which is
+  // negligible compared to the size of the volume.
+  std::vector<PreviewRegionType> blocks;
+  const unsigned int numberOfSlices = inputAtTimeStep->GetDimension(2);
+  for (unsigned int slice = 0; slice < numberOfSlices; slice += BackgroundPreviewBlockSize)
+  {
+    PreviewRegionType::IndexType blockIndex;
+    blockIndex.Fill(0);
+    blockIndex[2] = slice;
+
+    PreviewRegionType::SizeType blockSize;
+    blockSize[0] = inputAtTimeStep->GetDimension(0);
+    blockSize[1] = inputAtTimeStep->GetDimension(1);
+    blockSize[2] = std::min(BackgroundPreviewBlockSize, numberOfSlices - slice);
+
+    blocks.emplace_back(blockIndex, blockSize);
+  }
+
+  auto backgroundPreview = std::make_shared<BackgroundPreview>();
+  backgroundPreview->Tool = this;
+  backgroundPreview->TimeStep = timeStep;
+  backgroundPreview->Buffer = Image::New();
+  backgroundPreview->Buffer->Initialize(previewImage->GetPixelType(), *(previewImage->GetGeometry(timeStep)));
+  m_BackgroundPreview = backgroundPreview;
+
+  Image::ConstPointer input = inputAtTimeStep;
+  Image::ConstPointer oldSeg = oldSegAtTimeStep;
+
+  // The thread may call the tool, because the tool joins it before it is destroyed. The callback
+  // posted to the GUI thread may be executed after the tool was destroyed, thus it only holds
+  // a weak reference to the state and reaches the tool through it.
+  m_BackgroundPreviewThread = std::thread([this, backgroundPreview, input, oldSeg, blocks]()
+  {
+    try
+    {
+      for (const auto& block : blocks)
+      {
+        if (backgroundPreview->Canceled)
+          return;
+
+        this->DoUpdatePreviewRegion(input, oldSeg, backgroundPreview->Buffer, 0, block);
+      }
+      backgroundPreview->Finished = true;
+    }
+    catch (const std::exception& e)
+    {
+      MITK_ERROR << "Background computation of the preview failed: " << e.what();
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Background computation of the preview failed.";
+    }
+
+    if (backgroundPreview->Canceled)
+      return;
+
+    std::weak_ptr<BackgroundPreview> weakBackgroundPreview = backgroundPreview;
+    auto command = StdFunctionCommand::New();
+    command->SetCommandFilter([](const itk::EventObject&) { return true; });
+    command->SetCommandAction([weakBackgroundPreview](const itk::EventObject&)
+    {
+      auto finishedPreview = weakBackgroundPreview.lock();
+      if (nullptr != finishedPreview && nullptr != finishedPreview->Tool)
+      {
+        finishedPreview->Tool->FinishBackgroundPreview();
+      }
+    });
+    CallbackFromGUIThread::GetInstance()->CallThisFromGUIThread(command, nullptr);
+  });
+
+  return true;
+}
+
 void mitk::AutoSegmentationWithPreviewTool::UpdatePrepare()
 {
   // default implementation does nothing
@@ -19,6 +19,12 @@ found in the LICENSE file.
 #include "mitkToolCommand.h"
 #include <MitkSegmentationExports.h>
 
+#include <itkImageRegion.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
 namespace mitk
 {
   /**
@@ -31,6 +37,13 @@ namespace mitk
   This class also takes care to properly transfer a confirmed preview into the segementation
   result.
 
+  Derived tools that can compute the preview voxel-wise (e.g. thresholding) may implement
+  SupportsRegionalPreview() and DoUpdatePreviewRegion(). Then UpdatePreview() first computes only
+  the slices of the segmentation input (the ROI, if one is set) that are visible in the 2D render
+  windows and returns. The rest of the volume is computed block by block in a background thread
+  into a private buffer, which replaces the preview in the GUI thread once it is complete. Every
+  new call of UpdatePreview() cancels the background computation of the previous one.
+
   \ingroup ToolManagerEtAl
   \sa mitk::Tool
   \sa QmitkInteractiveSegmentation
@@ -76,7 +89,12 @@ namespace mitk
     /** Indicate if currently UpdatePreview is triggered (true) or not (false).*/
     bool IsUpdating() const;
 
+    /** Indicate if the remaining part of a regional preview is currently computed in the background.*/
+    bool IsUpdatingInBackground() const;
+
   protected:
+    using PreviewRegionType = itk::ImageRegion<3>;
+
     ToolCommand::Pointer m_ProgressCommand;
 
     /** Member is always called if GetSegmentationInput() has changed
@@ -104,6 +122,30 @@ namespace mitk
      */
     virtual void DoUpdatePreview(const Image* inputAtTimeStep, const Image* oldSegAtTimeStep, Image* previewImage, TimeStepType timeStep) = 0;
 
+    /** Indicates if the tool implements DoUpdatePreviewRegion(). Default implementation returns false.*/
+    virtual bool SupportsRegionalPreview() const;
+
+    /** Computes the preview only for the passed index region of a 3D input and writes it into
+     * the same region of the preview image at the passed time step. Voxels outside of the region
+     * must not be touched.
+     * The function is called from the GUI thread for the visible slices and afterwards from a
+     * background thread for the whole volume (then previewImage is a private buffer with a single
+     * time step). Thus it must only read tool state that is not changed before the next
+     * UpdatePreview() (e.g. state captured in UpdatePrepare()), and it must not call Modified()
+     * on the preview image or trigger any rendering. Tools that implement it have to call
+     * CancelBackgroundPreview() in their destructor, because the background thread must not
+     * outlive the derived part of the tool.
+     * Default implementation throws; it is only called if SupportsRegionalPreview() returns true.*/
+    virtual void DoUpdatePreviewRegion(const Image* inputAtTimeStep, const Image* oldSegAtTimeStep, Image* previewImage, TimeStepType timeStep, const PreviewRegionType& region);
+
+    /** Stops a running background computation of the preview and waits until it has ended.
+     * The partial result is discarded.*/
+    void CancelBackgroundPreview();
+
+    /** Returns the regions of the input volume that are shown in the 2D render windows.
+     * They are computed first if the tool supports regional previews.*/
+    virtual std::vector<PreviewRegionType> GetVisiblePreviewRegions(const Image* inputAtTimeStep) const;
+
     AutoSegmentationWithPreviewTool(bool lazyDynamicPreviews = false); // purposely hidden
     AutoSegmentationWithPreviewTool(bool lazyDynamicPreviews, const char* interactorType, const us::Module* interactorModule = nullptr); // purposely hidden
 
@@ -143,6 +185,15 @@ namespace mitk
     void OnRoiDataChanged();
     void OnTimePointChanged();
 
+    /** Computes the preview of a single time step regionally, visible slices first.
+     * Returns false if the preview cannot be computed regionally.*/
+    bool UpdateRegionalPreview(const Image* inputAtTimeStep, const Image* oldSegAtTimeStep, Image* previewImage, TimeStepType timeStep);
+
+    struct BackgroundPreview;
+
+    /** Waits for the background computation and transfers its result into the preview image.*/
+    void FinishBackgroundPreview();
+
     /** Node that containes the preview data generated and managed by this class or derived ones.*/
     DataNode::Pointer m_PreviewSegmentationNode;
     /** The reference data recieved from ToolManager::GetReferenceData when tool was activated.*/
@@ -175,6 +226,13 @@ namespace mitk
 
     bool m_IsUpdating = false;
 
+    /** Thread that computes the preview outside of the visible slices.*/
+    std::thread m_BackgroundPreviewThread;
+    /** State of the running background computation. It is shared with the thread and, as weak
+     * reference, with the callback that is posted to the GUI thread once the computation is done,
+     * so that neither of them depends on the lifetime of the tool.*/
+    std::shared_ptr<BackgroundPreview> m_BackgroundPreview;
+
     Label::PixelType m_UserDefinedActiveLabel = 1;
 
     /** This variable indicates if for the tool a working plane geometry is defined.
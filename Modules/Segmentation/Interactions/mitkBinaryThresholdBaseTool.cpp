@@ -16,8 +16,10 @@ found in the LICENSE file.
 #include "mitkImageCast.h"
 #include "mitkImageStatisticsHolder.h"
 #include "mitkLabelSetImage.h"
+#include <mitkImageWriteAccessor.h>
 #include <itkBinaryThresholdImageFilter.h>
 #include <itkImageRegionIterator.h>
+#include <itkImageScanlineConstIterator.h>
 
 mitk::BinaryThresholdBaseTool::BinaryThresholdBaseTool()
   : m_SensibleMinimumThreshold(-100),
@@ -29,6 +31,8 @@ mitk::BinaryThresholdBaseTool::BinaryThresholdBaseTool()
 
 mitk::BinaryThresholdBaseTool::~BinaryThresholdBaseTool()
 {
+  // the background computation of the preview calls DoUpdatePreviewRegion()
+  this->CancelBackgroundPreview();
 }
 
 void mitk::BinaryThresholdBaseTool::SetThresholdValues(double lower, double upper)
@@ -93,6 +97,15 @@ void mitk::BinaryThresholdBaseTool::InitiateToolByInput()
   }
 }
 
+void mitk::BinaryThresholdBaseTool::UpdatePrepare()
+{
+  Superclass::UpdatePrepare();
+
+  m_PreviewLowerThreshold = m_LowerThreshold;
+  m_PreviewUpperThreshold = m_UpperThreshold;
+  m_PreviewLabel = this->GetUserDefinedActiveLabel();
+}
+
 void mitk::BinaryThresholdBaseTool::DoUpdatePreview(const Image* inputAtTimeStep, const Image* /*oldSegAtTimeStep*/, Image* previewImage, TimeStepType timeStep)
 {
   if (nullptr != inputAtTimeStep && nullptr != previewImage)
@@ -101,6 +114,19 @@ void mitk::BinaryThresholdBaseTool::DoUpdatePreview(const Image* inputAtTimeStep
   }
 }
 
+bool mitk::BinaryThresholdBaseTool::SupportsRegionalPreview() const
+{
+  return true;
+}
+
+void mitk::BinaryThresholdBaseTool::DoUpdatePreviewRegion(const Image* inputAtTimeStep, const Image* /*oldSegAtTimeStep*/, Image* previewImage, TimeStepType timeStep, const PreviewRegionType& region)
+{
+  if (nullptr != inputAtTimeStep && nullptr != previewImage)
+  {
+    AccessFixedDimensionByItk_n(inputAtTimeStep, ITKThresholdingRegion, 3, (previewImage, timeStep, region));
+  }
+}
+
 template <typename TPixel, unsigned int VImageDimension>
 void mitk::BinaryThresholdBaseTool::ITKThresholding(const itk::Image<TPixel, VImageDimension>* inputImage,
                                                     Image* segmentation,
@@ -112,11 +138,42 @@ void mitk::BinaryThresholdBaseTool::ITKThresholding(const itk::Image<TPixel, VIm
 
   typename ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
   filter->SetInput(inputImage);
-  filter->SetLowerThreshold(m_LowerThreshold);
-  filter->SetUpperThreshold(m_UpperThreshold);
-  filter->SetInsideValue(this->GetUserDefinedActiveLabel());
+  filter->SetLowerThreshold(m_PreviewLowerThreshold);
+  filter->SetUpperThreshold(m_PreviewUpperThreshold);
+  filter->SetInsideValue(m_PreviewLabel);
   filter->SetOutsideValue(0);
   filter->Update();
 
   segmentation->SetVolume((void *)(filter->GetOutput()->GetPixelContainer()->GetBufferPointer()), timeStep);
 }
+
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::BinaryThresholdBaseTool::ITKThresholdingRegion(const itk::Image<TPixel, VImageDimension>* inputImage,
+                                                          Image* segmentation,
+                                                          unsigned int timeStep,
+                                                          const PreviewRegionType& region)
+{
+  typedef itk::Image<TPixel, VImageDimension> ImageType;
+
+  // same conversion of the thresholds to the pixel type as itk::BinaryThresholdImageFilter does
+  const auto lowerThreshold = static_cast<TPixel>(m_PreviewLowerThreshold);
+  const auto upperThreshold = static_cast<TPixel>(m_PreviewUpperThreshold);
+  const auto insideValue = static_cast<Tool::DefaultSegmentationDataType>(m_PreviewLabel);
+
+  ImageWriteAccessor accessor(segmentation, segmentation->GetVolumeData(timeStep));
+  auto* buffer = static_cast<Tool::DefaultSegmentationDataType*>(accessor.GetData());
+
+  itk::ImageScanlineConstIterator<ImageType> inputIter(inputImage, region);
+  while (!inputIter.IsAtEnd())
+  {
+    // input and segmentation have the same size, thus the buffer offsets are the same
+    auto* output = buffer + inputImage->ComputeOffset(inputIter.GetIndex());
+    while (!inputIter.IsAtEndOfLine())
+    {
+      const auto value = inputIter.Get();
+      *output++ = (lowerThreshold <= value && value <= upperThreshold) ? insideValue : 0;
+      ++inputIter;
+    }
+    inputIter.NextLine();
+  }
+}
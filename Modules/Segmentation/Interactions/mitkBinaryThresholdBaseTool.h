@@ -54,18 +54,33 @@ namespace mitk
     itkGetMacro(SensibleMaximumThreshold, ScalarType);
 
     void InitiateToolByInput() override;
+    void UpdatePrepare() override;
     void DoUpdatePreview(const Image* inputAtTimeStep, const Image* oldSegAtTimeStep, Image* previewImage, TimeStepType timeStep) override;
 
+    bool SupportsRegionalPreview() const override;
+    void DoUpdatePreviewRegion(const Image* inputAtTimeStep, const Image* oldSegAtTimeStep, Image* previewImage, TimeStepType timeStep, const PreviewRegionType& region) override;
+
     template <typename TPixel, unsigned int VImageDimension>
     void ITKThresholding(const itk::Image<TPixel, VImageDimension>* inputImage,
       Image* segmentation, unsigned int timeStep);
 
+    template <typename TPixel, unsigned int VImageDimension>
+    void ITKThresholdingRegion(const itk::Image<TPixel, VImageDimension>* inputImage,
+      Image* segmentation, unsigned int timeStep, const PreviewRegionType& region);
+
   private:
     ScalarType m_SensibleMinimumThreshold;
     ScalarType m_SensibleMaximumThreshold;
     ScalarType m_LowerThreshold;
     ScalarType m_UpperThreshold;
 
+    /** Thresholds and label the current preview is computed with. They are captured
+      in UpdatePrepare(), because the preview might be completed in the background
+      while the thresholds are already changed again.*/
+    ScalarType m_PreviewLowerThreshold = 1;
+    ScalarType m_PreviewUpperThreshold = 1;
+    Label::PixelType m_PreviewLabel = 1;
+
     /** Indicates if the tool should behave like a single threshold tool (true)
       or like a upper/lower threshold tool (false)*/
     bool m_LockedUpperThreshold = false;
@@ -22,6 +22,8 @@ found in the LICENSE file.
 
 #include <mitkImageStatisticsHolder.h>
 
+#include <algorithm>
+
 namespace mitk
 {
   MITK_TOOL_MACRO(MITKSEGMENTATION_EXPORT, OtsuTool3D, "Otsu Segmentation");
@@ -34,6 +36,17 @@ void mitk::OtsuTool3D::Activated()
   m_NumberOfBins = 128;
   m_NumberOfRegions = 2;
   m_UseValley = false;
+
+  m_Histograms.clear();
+  m_HistogramsInput = nullptr;
+}
+
+void mitk::OtsuTool3D::Deactivated()
+{
+  m_Histograms.clear();
+  m_HistogramsInput = nullptr;
+
+  Superclass::Deactivated();
 }
 
 const char **mitk::OtsuTool3D::GetXPM() const
@@ -53,7 +66,7 @@ const char* mitk::OtsuTool3D::GetName() const
   return "Otsu";
 }
 
-mitk::LabelSetImage::Pointer mitk::OtsuTool3D::ComputeMLPreview(const Image* inputAtTimeStep, TimeStepType /*timeStep*/)
+mitk::LabelSetImage::Pointer mitk::OtsuTool3D::ComputeMLPreview(const Image* inputAtTimeStep, TimeStepType timeStep)
 {
   int numberOfThresholds = m_NumberOfRegions - 1;
 
@@ -66,6 +79,8 @@ mitk::LabelSetImage::Pointer mitk::OtsuTool3D::ComputeMLPreview(const Image* inp
 
   try
   {
+    // changing the number of regions or the valley emphasis only searches the thresholds of the cached histogram
+    otsuFilter->SetHistogram(this->GetOtsuHistogram(inputAtTimeStep, timeStep));
     otsuFilter->Update();
   }
   catch (...)
@@ -78,6 +93,52 @@ mitk::LabelSetImage::Pointer mitk::OtsuTool3D::ComputeMLPreview(const Image* inp
   return otsuResultImage;
 }
 
+mitk::OtsuHistogram::ConstPointer mitk::OtsuTool3D::GetOtsuHistogram(const Image* inputAtTimeStep,
+  TimeStepType timeStep)
+{
+  const auto* input = this->GetSegmentationInput();
+
+  if (input != m_HistogramsInput || (nullptr != input && input->GetMTime() != m_HistogramsInputMTime))
+  {
+    m_Histograms.clear();
+    m_HistogramsInput = input;
+    m_HistogramsInputMTime = nullptr != input ? input->GetMTime() : 0;
+  }
+
+  const bool cacheable = nullptr == this->GetWorkingPlaneGeometry();
+
+  if (cacheable)
+  {
+    auto iter = std::find_if(m_Histograms.begin(), m_Histograms.end(),
+      [timeStep](const std::pair<TimeStepType, OtsuHistogram::ConstPointer>& entry) { return entry.first == timeStep; });
+
+    if (iter != m_Histograms.end())
+    {
+      if (iter->second->GetNumberOfBins() == m_NumberOfBins)
+      {
+        m_Histograms.splice(m_Histograms.begin(), m_Histograms, iter);
+        return m_Histograms.front().second;
+      }
+
+      m_Histograms.erase(iter);
+    }
+  }
+
+  auto histogram = OtsuHistogram::New();
+  histogram->SetNumberOfBins(m_NumberOfBins);
+  histogram->Initialize(inputAtTimeStep);
+
+  if (cacheable)
+  {
+    m_Histograms.emplace_front(timeStep, histogram.GetPointer());
+
+    if (m_Histograms.size() > MaximumNumberOfCachedHistograms)
+      m_Histograms.pop_back();
+  }
+
+  return histogram.GetPointer();
+}
+
 unsigned int mitk::OtsuTool3D::GetMaxNumberOfBins() const
 {
   const auto min = this->GetReferenceData()->GetStatistics()->GetScalarValueMin();
@@ -13,8 +13,11 @@ found in the LICENSE file.
 #define MITKOTSUTOOL3D_H
 
 #include "mitkAutoMLSegmentationWithPreviewTool.h"
+#include "mitkOtsuHistogram.h"
 #include <MitkSegmentationExports.h>
 
+#include <list>
+
 namespace us
 {
   class ModuleResource;
@@ -36,6 +39,7 @@ namespace mitk
     us::ModuleResource GetIconResource() const override;
 
     void Activated() override;
+    void Deactivated() override;
 
     itkSetMacro(NumberOfBins, unsigned int);
     itkGetConstMacro(NumberOfBins, unsigned int);
@@ -59,6 +63,20 @@ namespace mitk
     unsigned int m_NumberOfBins = 128;
     unsigned int m_NumberOfRegions = 2;
     bool m_UseValley = false;
+
+  private:
+    /** \brief Returns the cached histogram of the time step or computes it with the current number of bins.
+      * Histograms of slices of a working plane are not cached, as the plane changes with every update.
+      */
+    OtsuHistogram::ConstPointer GetOtsuHistogram(const Image* inputAtTimeStep, TimeStepType timeStep);
+
+    /** \brief Maximum number of time steps whose histograms are cached. */
+    static constexpr std::size_t MaximumNumberOfCachedHistograms = 10;
+
+    /** \brief Histograms of the time steps of m_HistogramsInput, the most recently used first. */
+    std::list<std::pair<TimeStepType, OtsuHistogram::ConstPointer>> m_Histograms;
+    Image::ConstPointer m_HistogramsInput;
+    itk::ModifiedTimeType m_HistogramsInputMTime = 0;
   }; // class
 } // namespace
 #endif
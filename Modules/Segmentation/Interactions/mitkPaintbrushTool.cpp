@@ -28,6 +28,7 @@ mitk::PaintbrushTool::PaintbrushTool(int paintingPixelValue)
 {
   m_MasterContour = ContourModel::New();
   m_MasterContour->Initialize();
+  m_Stamp = PaintbrushStamp::New();
   m_CurrentPlane = nullptr;
 
   m_WorkingNode = DataNode::New();
@@ -282,6 +283,7 @@ void mitk::PaintbrushTool::OnMousePressed(StateMachineAction *, InteractionEvent
     return;
 
   m_WorkingSlice->GetGeometry()->WorldToIndex(positionEvent->GetPositionInWorld(), m_LastPosition);
+  m_Stamp->ResetDirtyRegion();
 
   // create new working node
   // a fresh node is needed to only display the actual drawing process for
@@ -375,71 +377,23 @@ void mitk::PaintbrushTool::MouseMoved(mitk::InteractionEvent *interactionEvent,
 
   if (leftMouseButtonPressed)
   {
-    const double dist = indexCoordinates.EuclideanDistanceTo(m_LastPosition);
-    const double radius = static_cast<double>(m_Size) / 2.0;
-
     DataNode *workingNode(this->GetToolManager()->GetWorkingData(0));
     auto workingImage = dynamic_cast<Image*>(workingNode->GetData());
     int activePixelValue = ContourModelUtils::GetActivePixelValue(workingImage);
 
+    // stamp the brush along the line from the last position, so fast strokes have no gaps
+    PaintbrushStamp::IndexType from, to;
+    from[0] = static_cast<PaintbrushStamp::IndexType::IndexValueType>(std::round(m_LastPosition[0]));
+    from[1] = static_cast<PaintbrushStamp::IndexType::IndexValueType>(std::round(m_LastPosition[1]));
+    to[0] = static_cast<PaintbrushStamp::IndexType::IndexValueType>(indexCoordinates[0]);
+    to[1] = static_cast<PaintbrushStamp::IndexType::IndexValueType>(indexCoordinates[1]);
+
     // m_PaintingPixelValue only decides whether to paint or erase
-    mitk::ContourModelUtils::FillContourInSlice(
-      contour, m_WorkingSlice, workingImage, m_PaintingPixelValue * activePixelValue);
+    m_Stamp->SetSize(m_Size);
+    m_Stamp->Paint(m_WorkingSlice, workingImage, from, to, m_PaintingPixelValue * activePixelValue);
 
     m_WorkingNode->SetData(m_WorkingSlice);
     m_WorkingNode->Modified();
-
-    // if points are >= radius away draw rectangle to fill empty holes
-    // in between the 2 points
-    if (dist > radius)
-    {
-      const mitk::Point3D &currentPos = indexCoordinates;
-      mitk::Point3D direction;
-      mitk::Point3D vertex;
-      mitk::Point3D normal;
-
-      direction[0] = indexCoordinates[0] - m_LastPosition[0];
-      direction[1] = indexCoordinates[1] - m_LastPosition[1];
-      direction[2] = indexCoordinates[2] - m_LastPosition[2];
-
-      direction[0] = direction.GetVnlVector().normalize()[0];
-      direction[1] = direction.GetVnlVector().normalize()[1];
-      direction[2] = direction.GetVnlVector().normalize()[2];
-
-      // 90 degrees rotation of direction
-      normal[0] = -1.0 * direction[1];
-      normal[1] = direction[0];
-
-      contour->Clear();
-
-      // upper left corner
-      vertex[0] = m_LastPosition[0] + (normal[0] * radius);
-      vertex[1] = m_LastPosition[1] + (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      // upper right corner
-      vertex[0] = currentPos[0] + (normal[0] * radius);
-      vertex[1] = currentPos[1] + (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      // lower right corner
-      vertex[0] = currentPos[0] - (normal[0] * radius);
-      vertex[1] = currentPos[1] - (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      // lower left corner
-      vertex[0] = m_LastPosition[0] - (normal[0] * radius);
-      vertex[1] = m_LastPosition[1] - (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      mitk::ContourModelUtils::FillContourInSlice(contour, m_WorkingSlice, workingImage, m_PaintingPixelValue * activePixelValue);
-      m_WorkingNode->SetData(m_WorkingSlice);
-      m_WorkingNode->Modified();
-    }
   }
   else
   {
@@ -467,7 +421,9 @@ void mitk::PaintbrushTool::OnMouseReleased(StateMachineAction *, InteractionEven
   if (!positionEvent)
     return;
 
-  this->WriteBackSegmentationResult(positionEvent, m_WorkingSlice->Clone());
+  // nothing to write back if the whole stroke was outside of the slice
+  if (m_WorkingSlice.IsNotNull() && m_Stamp->IsDirty())
+    this->WriteBackDirtyRegion(positionEvent);
 
   // deactivate visibility of helper node
   m_WorkingNode->SetVisibility(false);
@@ -475,6 +431,29 @@ void mitk::PaintbrushTool::OnMouseReleased(StateMachineAction *, InteractionEven
   RenderingManager::GetInstance()->RequestUpdate(positionEvent->GetSender()->GetRenderWindow());
 }
 
+void mitk::PaintbrushTool::WriteBackDirtyRegion(const InteractionPositionEvent *positionEvent)
+{
+  const PlaneGeometry *planeGeometry = positionEvent->GetSender()->GetCurrentWorldPlaneGeometry();
+  if (nullptr == planeGeometry || nullptr != dynamic_cast<const AbstractTransformGeometry *>(planeGeometry))
+    return;
+
+  auto *workingImage = dynamic_cast<Image *>(this->GetWorkingDataNode()->GetData());
+  if (nullptr == workingImage)
+    return;
+
+  const auto timeStep = positionEvent->GetSender()->GetTimeStep(workingImage);
+
+  // Only the bounding box of the stroke is written into the volume and stored for undo. The world
+  // geometry of the region is no image geometry, its origin is the corner of the first pixel.
+  auto dirtySlice = PaintbrushStamp::ExtractRegion(m_WorkingSlice, m_Stamp->GetDirtyRegion());
+  auto dirtyPlane = dirtySlice->GetSlicedGeometry()->GetPlaneGeometry(0)->Clone();
+  dirtyPlane->ChangeImageGeometryConsideringOriginOffset(false);
+  SegTool2D::WriteSliceToVolume(workingImage, dirtyPlane, dirtySlice, timeStep, true);
+
+  // the surface interpolation needs the contours of the whole slice
+  this->WriteBackSegmentationResults({SliceInformation(m_WorkingSlice->Clone(), planeGeometry, timeStep)}, false);
+}
+
 /**
   Called when the CTRL key is pressed. Will change the painting pixel value from 0 to 1 or from 1 to 0.
   */
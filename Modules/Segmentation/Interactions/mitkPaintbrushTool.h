@@ -15,6 +15,7 @@ found in the LICENSE file.
 
 #include "mitkCommon.h"
 #include "mitkFeedbackContourTool.h"
+#include "mitkPaintbrushStamp.h"
 #include <MitkSegmentationExports.h>
 
 namespace mitk
@@ -33,6 +34,8 @@ namespace mitk
    \ingroup ToolManagerEtAl
 
    Simple paintbrush drawing tool. Right now there are only circular pens of varying size.
+   The pixels are painted by a PaintbrushStamp directly into the working slice, which is written back
+   into the segmentation once per stroke. Only the bounding box of the stroke is written back.
 
 
    \warning Only to be instantiated by mitk::ToolManager.
@@ -80,6 +83,11 @@ namespace mitk
       */
     void CheckIfCurrentSliceHasChanged(const InteractionPositionEvent *event);
 
+    /**
+      * Writes the dirty region of the working slice back into the segmentation.
+      */
+    void WriteBackDirtyRegion(const InteractionPositionEvent *positionEvent);
+
     void OnToolManagerWorkingDataModified();
 
     int m_PaintingPixelValue;
@@ -89,6 +97,8 @@ namespace mitk
 
     int m_LastContourSize;
 
+    PaintbrushStamp::Pointer m_Stamp;
+
     Image::Pointer m_WorkingSlice;
     PlaneGeometry::ConstPointer m_CurrentPlane;
     DataNode::Pointer m_WorkingNode;
@@ -26,13 +26,12 @@ found in the LICENSE file.
 // ITK
 #include "mitkITKImageImport.h"
 #include "mitkImageAccessByItk.h"
-#include <itkConnectedComponentImageFilter.h>
-#include <itkConnectedThresholdImageFilter.h>
-#include <itkNeighborhoodIterator.h>
-
-#include <itkImageDuplicator.h>
+#include "mitkIncrementalRegionGrower.h"
+#include <itkImageLinearIteratorWithIndex.h>
+#include <itkImageRegionIteratorWithIndex.h>
 
 #include <limits>
+#include <vector>
 
 namespace mitk
 {
@@ -160,7 +159,7 @@ void mitk::RegionGrowingTool::GetNeighborhoodAverage(const itk::Image<TPixel, im
   *result /= numberOfPixels;
 }
 
-// Do the region growing (i.e. call an ITK filter that does it)
+// Do the region growing (i.e. continue growing the region of the last call, if possible)
 template <typename TPixel, unsigned int imageDimension>
 void mitk::RegionGrowingTool::StartRegionGrowing(const itk::Image<TPixel, imageDimension> *inputImage,
                                                  const itk::Index<imageDimension>& seedIndex,
@@ -172,88 +171,132 @@ void mitk::RegionGrowingTool::StartRegionGrowing(const itk::Image<TPixel, imageD
 
   typedef itk::Image<TPixel, imageDimension> InputImageType;
   typedef itk::Image<DefaultSegmentationDataType, imageDimension> OutputImageType;
+  typedef itk::Image<unsigned int, imageDimension> VoteImageType;
+  typedef IncrementalRegionGrower<InputImageType> RegionGrowerType;
 
-  typedef itk::ConnectedThresholdImageFilter<InputImageType, OutputImageType> RegionGrowingFilterType;
-  typename RegionGrowingFilterType::Pointer regionGrower = RegionGrowingFilterType::New();
-
-  // perform region growing in desired segmented region
-  regionGrower->SetInput(inputImage);
-  regionGrower->SetSeed(seedIndex);
-
-  regionGrower->SetLower(thresholds[0]);
-  regionGrower->SetUpper(thresholds[1]);
+  // The region grower is kept while the mouse is dragged, so that only the changes of the
+  // threshold window have to be processed
+  auto *regionGrower = dynamic_cast<RegionGrowerType *>(m_RegionGrower.get());
 
-  try
+  if (nullptr == regionGrower || !regionGrower->IsInitialized(inputImage, seedIndex))
   {
-    regionGrower->Update();
+    m_RegionGrower = std::make_unique<RegionGrowerType>();
+    regionGrower = static_cast<RegionGrowerType *>(m_RegionGrower.get());
+    regionGrower->Initialize(inputImage, seedIndex);
   }
-  catch (...)
+
+  regionGrower->Update(static_cast<TPixel>(thresholds[0]), static_cast<TPixel>(thresholds[1]));
+
+  const auto &largestRegion = inputImage->GetLargestPossibleRegion();
+
+  auto resultImage = OutputImageType::New();
+  resultImage->CopyInformation(inputImage);
+  resultImage->SetRegions(largestRegion);
+  resultImage->Allocate();
+  resultImage->FillBuffer(0);
+
+  m_ConnectedComponentValue = 0;
+
+  if (0 == regionGrower->GetNumberOfPixels())
   {
-    return; // Should we do something?
+    MITK_DEBUG << "Region growing result is empty.";
+    outputImage = mitk::GrabItkImageMemory(resultImage);
+    return;
   }
 
-  typename OutputImageType::Pointer resultImage = regionGrower->GetOutput();
+  // Smooth result: Every pixel is replaced by the majority of the neighborhood.
+  // Only pixels close to the region can get a majority, so the rest of the slice is skipped.
+  const int radius = 2; // for now, maybe make this something the user can adjust in the preferences?
 
-  // Smooth result: Every pixel is replaced by the majority of the neighborhood
-  typedef itk::NeighborhoodIterator<OutputImageType> NeighborhoodIteratorType;
-  typedef itk::ImageRegionIterator<OutputImageType> ImageIteratorType;
+  auto smoothingRegion = regionGrower->GetBoundingBox();
+  smoothingRegion.PadByRadius(radius);
+  smoothingRegion.Crop(largestRegion);
 
-  typename NeighborhoodIteratorType::RadiusType radius;
-  radius.Fill(2); // for now, maybe make this something the user can adjust in the preferences?
+  auto votes = VoteImageType::New();
+  votes->SetRegions(smoothingRegion);
+  votes->Allocate();
 
-  typedef itk::ImageDuplicator< OutputImageType > DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage(resultImage);
-  duplicator->Update();
+  itk::ImageRegionIteratorWithIndex<VoteImageType> regionIterator(votes, smoothingRegion);
 
-  typename OutputImageType::Pointer resultDup = duplicator->GetOutput();
+  for (regionIterator.GoToBegin(); !regionIterator.IsAtEnd(); ++regionIterator)
+  {
+    regionIterator.Set(regionGrower->IsInside(regionIterator.GetIndex()) ? 1 : 0);
+  }
 
-  NeighborhoodIteratorType neighborhoodIterator(radius, resultDup, resultDup->GetRequestedRegion());
-  ImageIteratorType imageIterator(resultImage, resultImage->GetRequestedRegion());
+  // The neighborhood is a box, so the votes are summed up along one axis after the other
+  std::vector<unsigned int> line;
+  unsigned int neighborhoodSize = 1;
 
-  for (neighborhoodIterator.GoToBegin(), imageIterator.GoToBegin(); !neighborhoodIterator.IsAtEnd();
-       ++neighborhoodIterator, ++imageIterator)
+  for (unsigned int d = 0; d < imageDimension; ++d)
   {
-    DefaultSegmentationDataType voteYes(0);
-    DefaultSegmentationDataType voteNo(0);
+    const auto first = smoothingRegion.GetIndex(d);
+    const auto length = static_cast<itk::IndexValueType>(smoothingRegion.GetSize(d));
+    const auto imageFirst = largestRegion.GetIndex(d);
+    const auto imageLast = imageFirst + static_cast<itk::IndexValueType>(largestRegion.GetSize(d)) - 1;
+
+    itk::ImageLinearIteratorWithIndex<VoteImageType> iterator(votes, smoothingRegion);
+    iterator.SetDirection(d);
 
-    for (unsigned int i = 0; i < neighborhoodIterator.Size(); ++i)
+    for (iterator.GoToBegin(); !iterator.IsAtEnd(); iterator.NextLine())
     {
-      if (neighborhoodIterator.GetPixel(i) > 0)
-      {
-        voteYes += 1;
-      }
-      else
+      line.clear();
+      for (; !iterator.IsAtEndOfLine(); ++iterator)
+        line.push_back(iterator.Get());
+
+      iterator.GoToBeginOfLine();
+
+      for (itk::IndexValueType i = 0; i < length; ++i, ++iterator)
       {
-        voteNo += 1;
+        unsigned int sum = 0;
+
+        for (int k = -radius; k <= radius; ++k)
+        {
+          // Outside of the slice, its border pixels are repeated like by itk::NeighborhoodIterator
+          const auto j = std::min(std::max(first + i + k, imageFirst), imageLast) - first;
+
+          if (0 <= j && j < length)
+            sum += line[j];
+        }
+
+        iterator.Set(sum);
       }
     }
 
-    if (voteYes > voteNo)
-    {
-      imageIterator.Set(1);
-    }
-    else
-    {
-      imageIterator.Set(0);
-    }
+    neighborhoodSize *= 2 * radius + 1;
   }
 
-  if (resultImage.IsNull())
+  auto smoothedImage = OutputImageType::New();
+  smoothedImage->CopyInformation(inputImage);
+  smoothedImage->SetRegions(smoothingRegion);
+  smoothedImage->Allocate();
+
+  itk::ImageRegionConstIterator<VoteImageType> voteIterator(votes, smoothingRegion);
+  itk::ImageRegionIterator<OutputImageType> smoothedIterator(smoothedImage, smoothingRegion);
+
+  for (; !voteIterator.IsAtEnd(); ++voteIterator, ++smoothedIterator)
   {
-    MITK_DEBUG << "Region growing result is empty.";
+    smoothedIterator.Set(2 * voteIterator.Get() > neighborhoodSize ? 1 : 0);
   }
 
-  // Can potentially have multiple regions, use connected component image filter to label disjunct regions
-  typedef itk::ConnectedComponentImageFilter<OutputImageType, OutputImageType> ConnectedComponentImageFilterType;
-  typename ConnectedComponentImageFilterType::Pointer connectedComponentFilter =
-    ConnectedComponentImageFilterType::New();
-  connectedComponentFilter->SetInput(resultImage);
-  connectedComponentFilter->Update();
-  typename OutputImageType::Pointer resultImageCC = connectedComponentFilter->GetOutput();
-  m_ConnectedComponentValue = resultImageCC->GetPixel(seedIndex);
+  // Smoothing can split the region, only the part connected to the seed is kept
+  if (smoothingRegion.IsInside(seedIndex) && 0 != smoothedImage->GetPixel(seedIndex))
+  {
+    IncrementalRegionGrower<OutputImageType> connectedComponent;
+    connectedComponent.Initialize(smoothedImage, seedIndex);
+    connectedComponent.Update(1, 1);
+
+    itk::ImageRegionIteratorWithIndex<OutputImageType> resultIterator(resultImage, connectedComponent.GetBoundingBox());
 
-  outputImage = mitk::GrabItkImageMemory(resultImageCC);
+    for (resultIterator.GoToBegin(); !resultIterator.IsAtEnd(); ++resultIterator)
+    {
+      if (connectedComponent.IsInside(resultIterator.GetIndex()))
+        resultIterator.Set(1);
+    }
+
+    m_ConnectedComponentValue = 1;
+  }
+
+  outputImage = mitk::GrabItkImageMemory(resultImage);
 }
 
 template <typename TPixel, unsigned int imageDimension>
@@ -297,6 +340,9 @@ void mitk::RegionGrowingTool::OnMousePressed(StateMachineAction*, InteractionEve
   m_LastEventSlice = m_LastEventSender->GetSlice();
   m_LastScreenPosition = Point2I(positionEvent->GetPointerPositionOnScreen());
 
+  // The slices are extracted anew, so the region of the last click cannot be continued
+  m_RegionGrower.reset();
+
   // ReferenceSlice is from the underlying image, WorkingSlice from the active segmentation (can be empty)
   m_ReferenceSlice = FeedbackContourTool::GetAffectedReferenceSlice(positionEvent);
   m_WorkingSlice = FeedbackContourTool::GetAffectedWorkingSlice(positionEvent);
@@ -16,6 +16,7 @@ found in the LICENSE file.
 #include "mitkFeedbackContourTool.h"
 #include <MitkSegmentationExports.h>
 #include <array>
+#include <memory>
 
 namespace us
 {
@@ -24,6 +25,8 @@ namespace us
 
 namespace mitk
 {
+  class IncrementalRegionGrowerBase;
+
   /**
     \brief A slice based region growing tool.
 
@@ -100,7 +103,8 @@ namespace mitk
                                 unsigned int neighborhood = 1);
 
     /**
-     * @brief Template that calls an ITK filter to do the region growing.
+     * @brief Template that does the region growing.
+     * The region of the last call is grown or shrunk, as long as the slice and the seed stay the same.
      */
     template <typename TPixel, unsigned int imageDimension>
     void StartRegionGrowing(const itk::Image<TPixel, imageDimension> *itkImage,
@@ -131,6 +135,7 @@ namespace mitk
     int m_PaintingPixelValue;
     bool m_FillFeedbackContour;
     int m_ConnectedComponentValue;
+    std::unique_ptr<IncrementalRegionGrowerBase> m_RegionGrower;
   };
 
 } // namespace
@@ -38,7 +38,9 @@ found in the LICENSE file.
 
 #include <itkMacro.h>
 #include <itkGradientMagnitudeRecursiveGaussianImageFilter.h>
-#include <itkWatershedImageFilter.h>
+
+#include <algorithm>
+#include <iterator>
 
 namespace mitk
 {
@@ -53,9 +55,16 @@ void mitk::WatershedTool::Activated()
   m_Level = 0.0;
   m_Threshold = 0.0;
 
-  m_MagFilter = nullptr;
-  m_WatershedFilter = nullptr;
-  m_LastFilterInput = nullptr;
+  m_Hierarchies.clear();
+  m_HierarchiesInput = nullptr;
+}
+
+void mitk::WatershedTool::Deactivated()
+{
+  m_Hierarchies.clear();
+  m_HierarchiesInput = nullptr;
+
+  Superclass::Deactivated();
 }
 
 us::ModuleResource mitk::WatershedTool::GetIconResource() const
@@ -75,89 +84,95 @@ const char *mitk::WatershedTool::GetName() const
   return "Watershed";
 }
 
-mitk::LabelSetImage::Pointer mitk::WatershedTool::ComputeMLPreview(const Image* inputAtTimeStep, TimeStepType /*timeStep*/)
+mitk::LabelSetImage::Pointer mitk::WatershedTool::ComputeMLPreview(const Image* inputAtTimeStep, TimeStepType timeStep)
 {
   mitk::LabelSetImage::Pointer labelSetOutput;
 
   try
   {
-    mitk::Image::Pointer output;
-    bool inputChanged = inputAtTimeStep != m_LastFilterInput;
-    // create and run itk filter pipeline
-    AccessByItk_2(inputAtTimeStep, ITKWatershed, output, inputChanged);
+    auto hierarchy = this->GetWatershedHierarchy(inputAtTimeStep, timeStep);
+    auto output = hierarchy->GetSegmentation(m_Threshold, m_Level);
 
     labelSetOutput = mitk::LabelSetImage::New();
     labelSetOutput->InitializeByLabeledImage(output);
   }
   catch (itk::ExceptionObject & e)
   {
-    //force reset of filters as they might be in an invalid state now.
-    m_MagFilter = nullptr;
-    m_WatershedFilter = nullptr;
-    m_LastFilterInput = nullptr;
+    //force reset of the cache as it might be in an invalid state now.
+    m_Hierarchies.clear();
+    m_HierarchiesInput = nullptr;
 
     MITK_ERROR << "Watershed Filter Error: " << e.GetDescription();
   }
-  
-  m_LastFilterInput = inputAtTimeStep;
 
   return labelSetOutput;
 }
 
-template <typename TPixel, unsigned int VImageDimension>
-void mitk::WatershedTool::ITKWatershed(const itk::Image<TPixel, VImageDimension>* originalImage,
-  mitk::Image::Pointer& segmentation, bool inputChanged)
+mitk::WatershedHierarchy::Pointer mitk::WatershedTool::GetWatershedHierarchy(const Image* inputAtTimeStep,
+  TimeStepType timeStep)
 {
-  typedef itk::WatershedImageFilter<itk::Image<float, VImageDimension>> WatershedFilter;
-  typedef itk::GradientMagnitudeRecursiveGaussianImageFilter<itk::Image<TPixel, VImageDimension>,
-    itk::Image<float, VImageDimension>>
-    MagnitudeFilter;
+  const auto* input = this->GetSegmentationInput();
 
-  // We create the filter pipeline only once (if needed) and not everytime we
-  // generate the ml image preview.
-  // Reason: If only the levels are changed the update of the pipe line is very
-  // fast and we want to profit from this feature.
-
-  // at first add a gradient magnitude filter
-  typename MagnitudeFilter::Pointer magnitude = dynamic_cast<MagnitudeFilter*>(m_MagFilter.GetPointer());
-  if (magnitude.IsNull())
+  if (input != m_HierarchiesInput || (nullptr != input && input->GetMTime() != m_HierarchiesInputMTime))
   {
-    magnitude = MagnitudeFilter::New();
-    magnitude->SetSigma(1.0);
-    magnitude->AddObserver(itk::ProgressEvent(), m_ProgressCommand);
-    m_MagFilter = magnitude.GetPointer();
+    m_Hierarchies.clear();
+    m_HierarchiesInput = input;
+    m_HierarchiesInputMTime = nullptr != input ? input->GetMTime() : 0;
   }
 
-  if (inputChanged)
+  const bool cacheable = nullptr == this->GetWorkingPlaneGeometry();
+
+  if (cacheable)
   {
-    magnitude->SetInput(originalImage);
+    auto iter = std::find_if(m_Hierarchies.begin(), m_Hierarchies.end(),
+      [timeStep](const std::pair<TimeStepType, WatershedHierarchy::Pointer>& entry) { return entry.first == timeStep; });
+
+    if (iter != m_Hierarchies.end())
+    {
+      m_Hierarchies.splice(m_Hierarchies.begin(), m_Hierarchies, iter);
+      return m_Hierarchies.front().second;
+    }
   }
 
-  // then add the watershed filter to the pipeline
-  typename WatershedFilter::Pointer watershed = dynamic_cast<WatershedFilter*>(m_WatershedFilter.GetPointer());
-  if (watershed.IsNull())
+  mitk::Image::Pointer gradientMagnitude;
+  AccessByItk_1(inputAtTimeStep, ITKGradientMagnitude, gradientMagnitude);
+
+  auto hierarchy = WatershedHierarchy::New();
+  hierarchy->AddObserver(itk::ProgressEvent(), m_ProgressCommand);
+  hierarchy->Initialize(gradientMagnitude);
+
+  if (cacheable)
   {
-    watershed = WatershedFilter::New();
-    watershed->SetInput(magnitude->GetOutput());
-    watershed->AddObserver(itk::ProgressEvent(), m_ProgressCommand);
-    m_WatershedFilter = watershed.GetPointer();
+    m_Hierarchies.emplace_front(timeStep, hierarchy);
+
+    // the least recently used hierarchies are dropped, the one of the current time step is always kept
+    auto size = hierarchy->GetSize();
+    auto iter = std::next(m_Hierarchies.begin());
+
+    while (iter != m_Hierarchies.end() && (size += iter->second->GetSize()) <= MaximumSizeOfCachedHierarchies)
+      ++iter;
+
+    m_Hierarchies.erase(iter, m_Hierarchies.end());
   }
 
-  watershed->SetThreshold(m_Threshold);
-  watershed->SetLevel(m_Level);
-  watershed->Update();
+  return hierarchy;
+}
 
-  // then make sure, that the output has the desired pixel type
-  typedef itk::CastImageFilter<typename WatershedFilter::OutputImageType,
-    itk::Image<Tool::DefaultSegmentationDataType, VImageDimension>>
-    CastFilter;
-  typename CastFilter::Pointer cast = CastFilter::New();
-  cast->SetInput(watershed->GetOutput());
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::WatershedTool::ITKGradientMagnitude(const itk::Image<TPixel, VImageDimension>* originalImage,
+  mitk::Image::Pointer& gradientMagnitude)
+{
+  typedef itk::GradientMagnitudeRecursiveGaussianImageFilter<itk::Image<TPixel, VImageDimension>,
+    itk::Image<float, VImageDimension>>
+    MagnitudeFilter;
 
-  // start the whole pipeline
-  cast->Update();
+  typename MagnitudeFilter::Pointer magnitude = MagnitudeFilter::New();
+  magnitude->SetSigma(1.0);
+  magnitude->SetInput(originalImage);
+  magnitude->AddObserver(itk::ProgressEvent(), m_ProgressCommand);
+  magnitude->Update();
 
   // since we obtain a new image from our pipeline, we have to make sure, that our mitk::Image::Pointer
   // is responsible for the memory management of the output image
-  segmentation = mitk::GrabItkImageMemory(cast->GetOutput());
+  gradientMagnitude = mitk::GrabItkImageMemory(magnitude->GetOutput());
 }
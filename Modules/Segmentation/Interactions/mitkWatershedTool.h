@@ -15,8 +15,12 @@ found in the LICENSE file.
 
 #include "mitkAutoMLSegmentationWithPreviewTool.h"
 #include "mitkCommon.h"
+#include "mitkWatershedHierarchy.h"
 #include <MitkSegmentationExports.h>
 
+#include <list>
+#include <utility>
+
 namespace us
 {
   class ModuleResource;
@@ -30,7 +34,10 @@ namespace mitk
     \ingroup Interaction
     \ingroup ToolManagerEtAl
 
-    Wraps ITK Watershed Filter into tool concept of MITK. For more information look into ITK documentation.
+    Segments the gradient magnitude of the input by a WatershedHierarchy. Threshold and level have the meaning
+    of the ITK Watershed Image Filter. The hierarchies of the recently used time steps are cached, so changing
+    threshold or level, or going back to such a time step, does not segment the image again. The cache is bounded
+    by MaximumSizeOfCachedHierarchies, only the hierarchy of the current time step is kept beyond it.
 
     \warning Only to be instantiated by mitk::ToolManager.
   */
@@ -46,6 +53,7 @@ namespace mitk
     us::ModuleResource GetIconResource() const override;
 
     void Activated() override;
+    void Deactivated() override;
 
     itkSetMacro(Threshold, double);
     itkGetConstMacro(Threshold, double);
@@ -65,18 +73,26 @@ namespace mitk
     double m_Level = 0.0;
 
 private:
-    /** \brief Creates and runs an ITK filter pipeline consisting of the filters: GradientMagnitude-, Watershed- and
-     * CastImageFilter.
+    /** \brief Returns the cached hierarchy of the time step or segments the gradient magnitude of the input.
+      * Hierarchies of slices of a working plane are not cached, as the plane changes with every update.
+      */
+    WatershedHierarchy::Pointer GetWatershedHierarchy(const Image* inputAtTimeStep, TimeStepType timeStep);
+
+    /** \brief Computes the gradient magnitude of the input image.
       *
       * \param originalImage The input image, which is delivered by the AccessByItk macro.
-      * \param segmentation A pointer to the output image, which will point to the pipeline output after execution.
+      * \param gradientMagnitude A pointer to the output image, which will point to the gradient magnitude after execution.
       */
     template <typename TPixel, unsigned int VImageDimension>
-    void ITKWatershed(const itk::Image<TPixel, VImageDimension>* originalImage, itk::SmartPointer<mitk::Image>& segmentation, bool inputChanged);
+    void ITKGradientMagnitude(const itk::Image<TPixel, VImageDimension>* originalImage, itk::SmartPointer<mitk::Image>& gradientMagnitude);
+
+    /** \brief Maximum memory of the cached hierarchies in bytes (a hierarchy needs about 4 bytes per voxel). */
+    static constexpr std::size_t MaximumSizeOfCachedHierarchies = 512 * 1024 * 1024;
 
-    itk::ProcessObject::Pointer m_MagFilter;
-    itk::ProcessObject::Pointer m_WatershedFilter;
-    mitk::Image::ConstPointer m_LastFilterInput;
+    /** \brief Hierarchies of the time steps of m_HierarchiesInput, the most recently used first. */
+    std::list<std::pair<TimeStepType, WatershedHierarchy::Pointer>> m_Hierarchies;
+    mitk::Image::ConstPointer m_HierarchiesInput;
+    itk::ModifiedTimeType m_HierarchiesInputMTime = 0;
   };
 
 } // namespace
@@ -14,11 +14,13 @@ found in the LICENSE file.
 
 #include "mitkIOUtil.h"
 #include "mitkProcessExecutor.h"
+#include "mitknnUnetWorker.h"
 #include <itksys/SystemTools.hxx>
 #include <usGetModuleContext.h>
 #include <usModule.h>
 #include <usModuleContext.h>
 #include <usModuleResource.h>
+#include <usModuleResourceStream.h>
 
 namespace mitk
 {
@@ -32,6 +34,10 @@ mitk::nnUNetTool::nnUNetTool()
 
 mitk::nnUNetTool::~nnUNetTool()
 {
+  if (m_Worker.IsNotNull())
+  {
+    m_Worker->Stop();
+  }
   itksys::SystemTools::RemoveADirectory(this->GetMitkTempDir());
 }
 
@@ -113,6 +119,23 @@ mitk::DataNode *mitk::nnUNetTool::GetRefNode()
   return this->GetToolManager()->GetReferenceData(0);
 }
 
+void mitk::nnUNetTool::CancelPrediction()
+{
+  if (m_Worker.IsNotNull())
+  {
+    m_Worker->CancelPendingRequests();
+  }
+}
+
+void mitk::nnUNetTool::SetWaitCallback(const std::function<void()> &callback)
+{
+  m_WaitCallback = callback;
+  if (m_Worker.IsNotNull())
+  {
+    m_Worker->SetWaitCallback(callback);
+  }
+}
+
 namespace
 {
   void onPythonProcessEvent(itk::Object * /*pCaller*/, const itk::EventObject &e, void *)
@@ -143,6 +166,10 @@ mitk::LabelSetImage::Pointer mitk::nnUNetTool::ComputeMLPreview(const Image *inp
   {
     return m_OutputBuffer;
   }
+  if (this->GetUseWorker() && !this->GetEnsemble())
+  {
+    return this->ComputeMLPreviewWithWorker(inputAtTimeStep);
+  }
   std::string inDir, outDir, inputImagePath, outputImagePath, scriptPath;
 
   ProcessExecutor::Pointer spExec = ProcessExecutor::New();
@@ -332,3 +359,93 @@ mitk::LabelSetImage::Pointer mitk::nnUNetTool::ComputeMLPreview(const Image *inp
     return nullptr;
   }
 }
+
+mitk::LabelSetImage::Pointer mitk::nnUNetTool::ComputeMLPreviewWithWorker(const Image *inputAtTimeStep)
+{
+  try
+  {
+    if (m_ParamQ.empty())
+    {
+      mitkThrow() << "No nnUNet model selected.";
+    }
+
+    const std::string configuration = this->GetPythonPath() + "|" + this->GetModelDirectory() + "|" +
+                                      this->GetnnUNetDirectory() + "|" + std::to_string(this->GetGpuId());
+    if (m_Worker.IsNull() || !m_Worker->IsRunning() || configuration != m_WorkerConfiguration)
+    {
+      if (m_Worker.IsNull())
+      {
+        m_Worker = nnUNetWorker::New();
+        itk::CStyleCommand::Pointer spCommand = itk::CStyleCommand::New();
+        spCommand->SetCallback(&onPythonProcessEvent);
+        m_Worker->AddObserver(ExternalProcessOutputEvent(), spCommand);
+        m_Worker->SetWaitCallback(m_WaitCallback);
+      }
+      m_Worker->Stop();
+
+      // the worker script is shipped as module resource
+      std::string scriptPath = this->GetMitkTempDir() + IOUtil::GetDirectorySeparator() + "nnUNetWorker.py";
+      us::ModuleResource resource = us::GetModuleContext()->GetModule()->GetResource("nnUNetWorker.py");
+      us::ModuleResourceStream resourceStream(resource, std::ios_base::binary);
+      std::ofstream scriptStream(scriptPath, std::ios_base::binary);
+      scriptStream << resourceStream.rdbuf();
+      scriptStream.close();
+
+      // the environment is inherited by the worker process
+      std::string resultsFolderEnv = "RESULTS_FOLDER=" + this->GetModelDirectory();
+      itksys::SystemTools::PutEnv(resultsFolderEnv.c_str());
+      std::string cudaEnv = "CUDA_VISIBLE_DEVICES=" + std::to_string(this->GetGpuId());
+      itksys::SystemTools::PutEnv(cudaEnv.c_str());
+
+#ifdef _WIN32
+      std::string command = "python";
+#else
+      std::string command = "python3";
+#endif
+      ProcessExecutor::ArgumentListType args;
+      args.push_back(ProcessExecutor::GetOSDependendExecutableName(command));
+      args.push_back(scriptPath);
+      if (this->GetNoPip())
+      {
+        args.push_back("--nnunet_dir");
+        args.push_back(this->GetnnUNetDirectory());
+      }
+      m_Worker->Start(this->GetPythonPath(), args);
+      m_WorkerConfiguration = configuration;
+    }
+
+    nnUNetWorker::Request request;
+    if (this->GetMultiModal())
+    {
+      request.Modalities = m_OtherModalPaths;
+    }
+    else
+    {
+      request.Modalities.push_back(inputAtTimeStep);
+    }
+    request.Model = m_ParamQ.front();
+    request.Mirror = this->GetMirror();
+    request.MixedPrecision = this->GetMixedPrecision();
+
+    Image::Pointer outputImage = m_Worker->Predict(request);
+    if (outputImage.IsNull())
+    {
+      MITK_INFO << "nnUNet prediction was cancelled.";
+      return nullptr;
+    }
+
+    LabelSetImage::Pointer resultImage = LabelSetImage::New();
+    resultImage->InitializeByLabeledImage(outputImage);
+    resultImage->SetGeometry(inputAtTimeStep->GetGeometry());
+    m_InputBuffer = inputAtTimeStep;
+    return resultImage;
+  }
+  catch (const mitk::Exception &e)
+  {
+    /*
+    Can't throw mitk exception to the caller. Refer: T28691
+    */
+    MITK_ERROR << e.GetDescription();
+    return nullptr;
+  }
+}
@@ -18,6 +18,7 @@ found in the LICENSE file.
 #include "mitkToolManager.h"
 #include <MitkSegmentationExports.h>
 #include <mitkStandardFileLocations.h>
+#include <functional>
 #include <utility>
 #include <numeric>
 
@@ -28,6 +29,8 @@ namespace us
 
 namespace mitk
 {
+  class nnUNetWorker;
+
   /**
    * @brief nnUNet parameter request object holding all model parameters for input.
    * Also holds output temporary directory path.
@@ -120,6 +123,27 @@ namespace mitk
     itkSetMacro(GpuId, unsigned int);
     itkGetConstMacro(GpuId, unsigned int);
 
+    /**
+     * @brief Predict with a long-lived worker process instead of starting nnUNet_predict for every prediction.
+     * The worker keeps the models loaded between predictions and exchanges the images via shared memory.
+     * Ensemble predictions always use nnUNet_predict and nnUNet_ensemble.
+     */
+    itkSetMacro(UseWorker, bool);
+    itkGetConstMacro(UseWorker, bool);
+    itkBooleanMacro(UseWorker);
+
+    /**
+     * @brief Cancels the predictions that wait for the worker process.
+     * The cancelled predictions result in no output.
+     */
+    void CancelPrediction();
+
+    /**
+     * @brief Callback invoked regularly while a prediction waits for the worker process.
+     * Lets the GUI process its events during the prediction, so it can call CancelPrediction().
+     */
+    void SetWaitCallback(const std::function<void()> &callback);
+
     /**
      * @brief vector of ModelParams.
      * Size > 1 only for ensemble prediction.
@@ -193,6 +217,12 @@ namespace mitk
     void UpdateCleanUp() override;
 
   private:
+    /**
+     * @brief Predicts with the worker process. Starts the worker first, if it is not running or the python
+     * environment, the model directory or the GPU changed since it was started.
+     */
+    LabelSetImage::Pointer ComputeMLPreviewWithWorker(const Image *inputAtTimeStep);
+
     std::string m_MitkTempDir;
     std::string m_nnUNetDirectory;
     std::string m_ModelDirectory;
@@ -206,6 +236,10 @@ namespace mitk
     bool m_MultiModal;
     bool m_Ensemble = false;
     bool m_Predict;
+    bool m_UseWorker = false;
+    itk::SmartPointer<nnUNetWorker> m_Worker;
+    std::string m_WorkerConfiguration;
+    std::function<void()> m_WaitCallback;
     LabelSetImage::Pointer m_OutputBuffer;
     unsigned int m_GpuId;
     const std::string m_TEMPLATE_FILENAME = "XXXXXX_000_0000.nii.gz";
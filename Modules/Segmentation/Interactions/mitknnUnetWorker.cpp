@@ -0,0 +1,513 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitknnUnetWorker.h"
+
+#include <mitkIOUtil.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itksys/Process.h>
+#include <itksys/SystemTools.hxx>
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const double StopTimeout = 5.0;
+  const std::chrono::milliseconds PollInterval(5);
+  const std::chrono::milliseconds WaitCallbackInterval(50);
+  const std::string DoneMessage = "nnunet-worker: done ";
+
+  /**
+   * Creates the pipe connected to the stdin of the worker. The parent keeps the read end open until Stop(), so
+   * writing never fails with a broken pipe if the worker died; the write end does not block on a full pipe.
+   */
+  bool CreateNotificationPipe(itksysProcess_Pipe_Handle pipe[2])
+  {
+#ifdef _WIN32
+    return CreatePipe(&pipe[0], &pipe[1], nullptr, 0) != 0;
+#else
+    if (::pipe(pipe) != 0)
+    {
+      return false;
+    }
+    fcntl(pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(pipe[1], F_SETFL, fcntl(pipe[1], F_GETFL) | O_NONBLOCK);
+    return true;
+#endif
+  }
+
+  void WriteToPipe(itksysProcess_Pipe_Handle handle, const std::string &data)
+  {
+#ifdef _WIN32
+    DWORD written = 0;
+    WriteFile(handle, data.data(), static_cast<DWORD>(data.size()), &written, nullptr);
+#else
+    // lines are shorter than PIPE_BUF, so they are written completely or not at all
+    if (write(handle, data.data(), data.size()) < 0)
+    {
+      MITK_WARN << "Could not notify the nnUNet worker.";
+    }
+#endif
+  }
+
+  void ClosePipeHandle(itksysProcess_Pipe_Handle handle)
+  {
+#ifdef _WIN32
+    CloseHandle(handle);
+#else
+    close(handle);
+#endif
+  }
+
+  std::string GetNumpyTypeName(const mitk::PixelType &pixelType)
+  {
+    const std::string bits = std::to_string(pixelType.GetBitsPerComponent());
+    switch (pixelType.GetComponentType())
+    {
+      case itk::IOComponentEnum::FLOAT:
+      case itk::IOComponentEnum::DOUBLE:
+        return "float" + bits;
+      case itk::IOComponentEnum::UCHAR:
+      case itk::IOComponentEnum::USHORT:
+      case itk::IOComponentEnum::UINT:
+      case itk::IOComponentEnum::ULONG:
+      case itk::IOComponentEnum::ULONGLONG:
+        return "uint" + bits;
+      default:
+        return "int" + bits;
+    }
+  }
+
+  std::size_t GetNumberOfPixels(const mitk::Image *image)
+  {
+    return static_cast<std::size_t>(image->GetDimension(0)) * image->GetDimension(1) * image->GetDimension(2);
+  }
+
+  /** Writes the file under a temporary name first, so readers never see it incomplete. */
+  void WriteFileAtomically(const std::string &path, const std::string &content)
+  {
+    const std::string tmpPath = path + ".tmp";
+    {
+      std::ofstream stream(tmpPath, std::ios::binary);
+      stream << content;
+      if (!stream)
+      {
+        mitkThrow() << "Could not write " << tmpPath;
+      }
+    }
+    if (!itksys::SystemTools::RenameFile(tmpPath, path))
+    {
+      mitkThrow() << "Could not rename " << tmpPath << " to " << path;
+    }
+  }
+
+  std::string CreateRequestDescription(const mitk::nnUNetWorker::Request &request)
+  {
+    const mitk::Image *reference = request.Modalities.front();
+    const mitk::BaseGeometry *geometry = reference->GetGeometry();
+    const auto spacing = geometry->GetSpacing();
+    const auto origin = geometry->GetOrigin();
+    const auto matrix = geometry->GetIndexToWorldTransform()->GetMatrix();
+
+    std::ostringstream description;
+    description.imbue(std::locale::classic());
+    description << std::setprecision(17);
+    description << "task=" << request.Model.task << "\n";
+    description << "model=" << request.Model.model << "\n";
+    description << "trainer=" << request.Model.trainer << "\n";
+    description << "plans=" << request.Model.planId << "\n";
+    description << "folds=";
+    for (std::size_t i = 0; i < request.Model.folds.size(); ++i)
+    {
+      description << (i > 0 ? "," : "") << request.Model.folds[i];
+    }
+    description << "\n";
+    description << "mirror=" << request.Mirror << "\n";
+    description << "mixed_precision=" << request.MixedPrecision << "\n";
+    description << "modalities=" << request.Modalities.size() << "\n";
+    description << "pixel_type=" << GetNumpyTypeName(reference->GetPixelType()) << "\n";
+    description << "dimensions=" << reference->GetDimension(0) << "," << reference->GetDimension(1) << ","
+                << reference->GetDimension(2) << "\n";
+    description << "spacing=" << spacing[0] << "," << spacing[1] << "," << spacing[2] << "\n";
+    description << "origin=" << origin[0] << "," << origin[1] << "," << origin[2] << "\n";
+    // row-major direction cosines like SimpleITK
+    description << "direction=";
+    for (unsigned int row = 0; row < 3; ++row)
+    {
+      for (unsigned int column = 0; column < 3; ++column)
+      {
+        description << (row + column > 0 ? "," : "") << matrix[row][column] / spacing[column];
+      }
+    }
+    description << "\n";
+    return description.str();
+  }
+}
+
+mitk::nnUNetWorker::nnUNetWorker()
+  : m_OwnsSessionDirectory(false),
+    m_Timeout(0.0),
+    m_ProcessRunning(false),
+    m_KillRequested(false),
+    m_LastRequestId(0),
+    m_LastCancelledRequestId(0),
+    m_NotificationPipe(),
+    m_HasNotificationPipe(false)
+{
+}
+
+mitk::nnUNetWorker::~nnUNetWorker()
+{
+  this->Stop();
+}
+
+std::string mitk::nnUNetWorker::GetSharedMemoryDirectory()
+{
+#ifdef __linux__
+  if (itksys::SystemTools::FileIsDirectory("/dev/shm") && itksys::SystemTools::TestFileAccess("/dev/shm", itksys::TEST_FILE_WRITE))
+  {
+    return "/dev/shm";
+  }
+#endif
+  return IOUtil::GetTempPath();
+}
+
+void mitk::nnUNetWorker::Start(const std::string &workingDirectory, const ArgumentListType &argumentList)
+{
+  if (m_ProcessRunning || m_ProcessThread.joinable())
+  {
+    mitkThrow() << "nnUNet worker is already running.";
+  }
+
+  if (m_SessionDirectory.empty())
+  {
+    m_SessionDirectory = IOUtil::CreateTemporaryDirectory("nnunet-session-XXXXXX", GetSharedMemoryDirectory());
+    m_OwnsSessionDirectory = true;
+  }
+  itksys::SystemTools::RemoveFile(m_SessionDirectory + "/stop");
+
+  m_KillRequested = false;
+  m_ProcessRunning = true;
+
+  if (!argumentList.empty())
+  {
+    if (!CreateNotificationPipe(m_NotificationPipe))
+    {
+      m_ProcessRunning = false;
+      mitkThrow() << "Could not create the stdin pipe of the nnUNet worker.";
+    }
+    m_HasNotificationPipe = true;
+
+    ArgumentListType arguments = argumentList;
+    arguments.push_back("--session");
+    arguments.push_back(m_SessionDirectory);
+    m_ProcessThread = std::thread(&nnUNetWorker::RunProcess, this, arguments, workingDirectory);
+  }
+}
+
+void mitk::nnUNetWorker::Stop()
+{
+  if (m_ProcessThread.joinable())
+  {
+    std::ofstream(m_SessionDirectory + "/stop").close();
+    this->NotifyWorker("stop");
+
+    {
+      std::unique_lock<std::mutex> lock(m_StateMutex);
+      m_StateChanged.wait_for(lock, std::chrono::duration<double>(StopTimeout), [this] { return !m_ProcessRunning; });
+    }
+    m_KillRequested = true;
+    m_ProcessThread.join();
+  }
+  m_ProcessRunning = false;
+  this->CloseNotificationPipe();
+
+  if (m_OwnsSessionDirectory)
+  {
+    itksys::SystemTools::RemoveADirectory(m_SessionDirectory);
+    m_SessionDirectory.clear();
+    m_OwnsSessionDirectory = false;
+  }
+}
+
+void mitk::nnUNetWorker::SetWaitCallback(const WaitCallbackType &callback)
+{
+  m_WaitCallback = callback;
+}
+
+bool mitk::nnUNetWorker::IsRunning() const
+{
+  return m_ProcessRunning;
+}
+
+void mitk::nnUNetWorker::NotifyWorker(const std::string &message)
+{
+  std::lock_guard<std::mutex> lock(m_NotificationMutex);
+  if (m_HasNotificationPipe)
+  {
+    WriteToPipe(m_NotificationPipe[1], message + "\n");
+  }
+}
+
+void mitk::nnUNetWorker::CloseNotificationPipe()
+{
+  std::lock_guard<std::mutex> lock(m_NotificationMutex);
+  if (m_HasNotificationPipe)
+  {
+    ClosePipeHandle(m_NotificationPipe[0]);
+    ClosePipeHandle(m_NotificationPipe[1]);
+    m_HasNotificationPipe = false;
+  }
+}
+
+void mitk::nnUNetWorker::RunProcess(ArgumentListType argumentList, std::string workingDirectory)
+{
+  std::vector<const char *> arguments;
+  for (const auto &argument : argumentList)
+  {
+    arguments.push_back(argument.c_str());
+  }
+  arguments.push_back(nullptr); // terminating null element as required by ITK
+
+  itksysProcess *process = itksysProcess_New();
+  itksysProcess_SetCommand(process, arguments.data());
+  itksysProcess_SetWorkingDirectory(process, workingDirectory.c_str());
+  itksysProcess_SetPipeNative(process, itksysProcess_Pipe_STDIN, m_NotificationPipe);
+  itksysProcess_Execute(process);
+
+  char *rawOutput = nullptr;
+  int outputLength = 0;
+  std::string pendingOutput;
+  while (true)
+  {
+    // the timeout only bounds the reaction to a kill request
+    double timeout = 0.1;
+    int dataStatus = itksysProcess_WaitForData(process, &rawOutput, &outputLength, &timeout);
+
+    if (dataStatus == itksysProcess_Pipe_STDOUT)
+    {
+      const std::string output(rawOutput, outputLength);
+      this->InvokeEvent(ExternalProcessStdOutEvent(output));
+
+      pendingOutput += output;
+      bool requestDone = false;
+      for (auto lineEnd = pendingOutput.find('\n'); lineEnd != std::string::npos; lineEnd = pendingOutput.find('\n'))
+      {
+        requestDone = requestDone || pendingOutput.compare(0, DoneMessage.size(), DoneMessage) == 0;
+        pendingOutput.erase(0, lineEnd + 1);
+      }
+      if (requestDone)
+      {
+        std::lock_guard<std::mutex> lock(m_StateMutex);
+        m_StateChanged.notify_all();
+      }
+    }
+    else if (dataStatus == itksysProcess_Pipe_STDERR)
+    {
+      this->InvokeEvent(ExternalProcessStdErrEvent(std::string(rawOutput, outputLength)));
+    }
+    else if (dataStatus == itksysProcess_Pipe_Timeout)
+    {
+      if (m_KillRequested)
+      {
+        itksysProcess_Kill(process);
+      }
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  itksysProcess_WaitForExit(process, nullptr);
+  if (itksysProcess_GetState(process) == itksysProcess_State_Error)
+  {
+    MITK_ERROR << "nnUNet worker could not be started: " << itksysProcess_GetErrorString(process);
+  }
+  itksysProcess_Delete(process);
+
+  std::lock_guard<std::mutex> lock(m_StateMutex);
+  m_ProcessRunning = false;
+  m_StateChanged.notify_all();
+}
+
+std::string mitk::nnUNetWorker::GetRequestPath(const std::string &id, const std::string &suffix) const
+{
+  return m_SessionDirectory + "/" + id + suffix;
+}
+
+void mitk::nnUNetWorker::RemoveRequestFiles(const std::string &id, unsigned int numberOfModalities) const
+{
+  for (unsigned int modality = 0; modality < numberOfModalities; ++modality)
+  {
+    std::ostringstream suffix;
+    suffix << "_" << std::setw(4) << std::setfill('0') << modality << ".raw";
+    itksys::SystemTools::RemoveFile(this->GetRequestPath(id, suffix.str()));
+  }
+  itksys::SystemTools::RemoveFile(this->GetRequestPath(id, ".request"));
+  itksys::SystemTools::RemoveFile(this->GetRequestPath(id, "_seg.raw"));
+  itksys::SystemTools::RemoveFile(this->GetRequestPath(id, ".done"));
+}
+
+mitk::Image::Pointer mitk::nnUNetWorker::Predict(const Request &request)
+{
+  if (!m_ProcessRunning)
+  {
+    mitkThrow() << "nnUNet worker is not running.";
+  }
+  if (request.Modalities.empty())
+  {
+    mitkThrow() << "nnUNet worker request does not contain an image.";
+  }
+
+  const Image *reference = request.Modalities.front();
+  for (const auto &modality : request.Modalities)
+  {
+    if (modality.IsNull() || modality->GetPixelType() != reference->GetPixelType() ||
+        modality->GetPixelType().GetNumberOfComponents() != 1 ||
+        GetNumberOfPixels(modality) != GetNumberOfPixels(reference))
+    {
+      mitkThrow() << "nnUNet worker requires scalar modalities of equal pixel type and size.";
+    }
+  }
+
+  const unsigned long requestId = ++m_LastRequestId;
+  std::ostringstream idStream;
+  idStream << std::setw(8) << std::setfill('0') << requestId;
+  const std::string id = idStream.str();
+  const auto numberOfModalities = static_cast<unsigned int>(request.Modalities.size());
+  const std::size_t numberOfPixels = GetNumberOfPixels(reference);
+
+  try
+  {
+    for (unsigned int modality = 0; modality < numberOfModalities; ++modality)
+    {
+      std::ostringstream suffix;
+      suffix << "_" << std::setw(4) << std::setfill('0') << modality << ".raw";
+      const std::string path = this->GetRequestPath(id, suffix.str());
+
+      ImageReadAccessor readAccess(request.Modalities[modality]);
+      std::ofstream stream(path, std::ios::binary);
+      stream.write(static_cast<const char *>(readAccess.GetData()),
+                   numberOfPixels * reference->GetPixelType().GetSize());
+      if (!stream)
+      {
+        mitkThrow() << "Could not write " << path;
+      }
+    }
+    WriteFileAtomically(this->GetRequestPath(id, ".request"), CreateRequestDescription(request));
+  }
+  catch (...)
+  {
+    this->RemoveRequestFiles(id, numberOfModalities);
+    throw;
+  }
+
+  this->NotifyWorker("request " + id);
+
+  const std::string donePath = this->GetRequestPath(id, ".done");
+  const auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(m_StateMutex);
+  while (!itksys::SystemTools::FileExists(donePath, true))
+  {
+    if (requestId <= m_LastCancelledRequestId)
+    {
+      lock.unlock();
+      // the worker removes the files of the request
+      std::ofstream(this->GetRequestPath(id, ".cancel")).close();
+      this->NotifyWorker("cancel " + id);
+      return nullptr;
+    }
+    if (!m_ProcessRunning)
+    {
+      this->RemoveRequestFiles(id, numberOfModalities);
+      mitkThrow() << "nnUNet worker stopped before request " << id << " was finished.";
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (m_Timeout > 0.0 && elapsed.count() > m_Timeout)
+    {
+      lock.unlock();
+      std::ofstream(this->GetRequestPath(id, ".cancel")).close();
+      this->NotifyWorker("cancel " + id);
+      mitkThrow() << "nnUNet worker did not finish request " << id << " within " << m_Timeout << " s.";
+    }
+
+    // the .done file is written before the worker announces it, so no notification is missed
+    if (m_WaitCallback)
+    {
+      lock.unlock();
+      m_WaitCallback();
+      lock.lock();
+      m_StateChanged.wait_for(lock, m_HasNotificationPipe ? WaitCallbackInterval : PollInterval);
+    }
+    else if (!m_HasNotificationPipe)
+    {
+      m_StateChanged.wait_for(lock, PollInterval);
+    }
+    else if (m_Timeout > 0.0)
+    {
+      m_StateChanged.wait_for(lock, std::chrono::duration<double>(m_Timeout) - elapsed);
+    }
+    else
+    {
+      m_StateChanged.wait(lock);
+    }
+  }
+  lock.unlock();
+
+  std::string status;
+  {
+    std::ifstream stream(donePath);
+    std::getline(stream, status);
+  }
+  if (status != "ok")
+  {
+    this->RemoveRequestFiles(id, numberOfModalities);
+    mitkThrow() << "nnUNet worker failed to process request " << id << ": " << status;
+  }
+
+  auto result = Image::New();
+  result->Initialize(MakeScalarPixelType<unsigned short>(), *(reference->GetGeometry()));
+  {
+    ImageWriteAccessor writeAccess(result);
+    std::ifstream stream(this->GetRequestPath(id, "_seg.raw"), std::ios::binary);
+    stream.read(static_cast<char *>(writeAccess.GetData()), numberOfPixels * sizeof(unsigned short));
+    if (static_cast<std::size_t>(stream.gcount()) != numberOfPixels * sizeof(unsigned short))
+    {
+      this->RemoveRequestFiles(id, numberOfModalities);
+      mitkThrow() << "nnUNet worker returned an incomplete segmentation for request " << id;
+    }
+  }
+  this->RemoveRequestFiles(id, numberOfModalities);
+
+  return result;
+}
+
+void mitk::nnUNetWorker::CancelPendingRequests()
+{
+  std::lock_guard<std::mutex> lock(m_StateMutex);
+  m_LastCancelledRequestId = m_LastRequestId.load();
+  m_StateChanged.notify_all();
+}
@@ -0,0 +1,156 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitknnUnetWorker_h_Included
+#define mitknnUnetWorker_h_Included
+
+#include "mitkProcessExecutor.h"
+#include "mitknnUnetTool.h"
+
+#include <itksys/Process.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mitk
+{
+  /**
+   * @brief Client of a long-lived nnUNet inference process.
+   *
+   * In contrast to calling nnUNet_predict for every prediction, the worker process is started once and keeps
+   * the models it has loaded between requests. Requests are exchanged through a session directory, which is
+   * located in shared memory (/dev/shm) where available, so the pixel data never touches the disk:
+   *
+   * - The client writes the raw pixel buffers of all modalities as <id>_<modality>.raw (e.g. 00000001_0000.raw)
+   *   and afterwards the "key=value" request description <id>.request. Request IDs are zero-padded, so the
+   *   lexical order of the request files is the queue order.
+   * - The worker writes the label buffer (uint16, same grid as the input) as <id>_seg.raw followed by <id>.done,
+   *   which contains "ok" or "error: <message>".
+   * - The client writes <id>.cancel to cancel a queued or running request. The worker then removes all files of
+   *   the request.
+   * - The worker quits when the file "stop" appears or the session directory is removed.
+   *
+   * Neither side polls the session directory: the client wakes the idle worker with one line per request,
+   * cancellation or stop on its stdin, and the worker announces every .done file with the line
+   * "nnunet-worker: done <id>" on its stdout. Only requests of a worker started elsewhere are polled.
+   *
+   * .done and .request files are created under a temporary name and renamed, so they are complete once visible.
+   * The python implementation of the worker is the module resource "nnUNetWorker.py". It passes the modalities as
+   * NIfTI files in the session directory to the preprocessing, export and postprocessing of nnUNet, so the results
+   * equal the ones of nnUNet_predict.
+   */
+  class MITKSEGMENTATION_EXPORT nnUNetWorker : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(nnUNetWorker, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    using ArgumentListType = ProcessExecutor::ArgumentListType;
+
+    /** Parameters of a single prediction. */
+    struct Request
+    {
+      /** Scalar 3D images of all modalities in the order expected by the task. */
+      std::vector<Image::ConstPointer> Modalities;
+      ModelParams Model;
+      bool Mirror = true;
+      bool MixedPrecision = true;
+    };
+
+    /**
+     * Directory used to exchange requests. If it is not set, Start() creates a session directory in
+     * GetSharedMemoryDirectory(), which is removed again by Stop().
+     */
+    itkSetMacro(SessionDirectory, std::string);
+    itkGetConstMacro(SessionDirectory, std::string);
+
+    /** Maximum time in seconds Predict() waits for a result. 0 (default) waits without limit. */
+    itkSetMacro(Timeout, double);
+    itkGetConstMacro(Timeout, double);
+
+    using WaitCallbackType = std::function<void()>;
+
+    /**
+     * @brief Callback invoked about every 50 ms by a waiting Predict() in its calling thread.
+     * Allows a GUI thread to process its events, e.g. to call CancelPendingRequests(), while it waits for the
+     * worker. Without a callback Predict() sleeps until the worker announces the result.
+     */
+    void SetWaitCallback(const WaitCallbackType &callback);
+
+    /**
+     * @brief Starts the worker process.
+     * @param workingDirectory Working directory of the process.
+     * @param argumentList Command of the worker; the executable name is the first argument and already converted
+     * via ProcessExecutor::GetOSDependendExecutableName(). The session directory is passed as additional argument
+     * "--session <dir>". If the list is empty, no process is started and the requests have to be served by a worker
+     * started elsewhere (e.g. for testing).
+     */
+    void Start(const std::string &workingDirectory, const ArgumentListType &argumentList);
+
+    /** Asks the worker process to quit and kills it if it does not within a few seconds. */
+    void Stop();
+
+    /** True between Start() and Stop() as long as the worker process has not exited. */
+    bool IsRunning() const;
+
+    /**
+     * @brief Queues a prediction and blocks until the worker has processed it.
+     * Can be called from several threads, the worker processes the requests in the order they were issued.
+     * @return the label image or nullptr if the request was cancelled.
+     * @throw mitk::Exception if the request is invalid, the worker reports an error, exits or the timeout expires.
+     */
+    Image::Pointer Predict(const Request &request);
+
+    /** Cancels all requests issued so far. Waiting Predict() calls return nullptr. */
+    void CancelPendingRequests();
+
+    /** /dev/shm if it is available, the default temp path otherwise. */
+    static std::string GetSharedMemoryDirectory();
+
+  protected:
+    nnUNetWorker();
+    ~nnUNetWorker() override;
+
+  private:
+    void RunProcess(ArgumentListType argumentList, std::string workingDirectory);
+    /** Writes a line to the stdin of the worker process, if it was started by this client. */
+    void NotifyWorker(const std::string &message);
+    void CloseNotificationPipe();
+    std::string GetRequestPath(const std::string &id, const std::string &suffix) const;
+    void RemoveRequestFiles(const std::string &id, unsigned int numberOfModalities) const;
+
+    std::string m_SessionDirectory;
+    bool m_OwnsSessionDirectory;
+    double m_Timeout;
+    WaitCallbackType m_WaitCallback;
+
+    std::thread m_ProcessThread;
+    std::atomic<bool> m_ProcessRunning;
+    std::atomic<bool> m_KillRequested;
+
+    std::atomic<unsigned long> m_LastRequestId;
+    std::atomic<unsigned long> m_LastCancelledRequestId;
+
+    /** Guards the state Predict() waits for: finished requests, cancellation and process exit. */
+    std::mutex m_StateMutex;
+    std::condition_variable m_StateChanged;
+
+    std::mutex m_NotificationMutex;
+    itksysProcess_Pipe_Handle m_NotificationPipe[2];
+    bool m_HasNotificationPipe;
+  };
+} // namespace mitk
+
+#endif
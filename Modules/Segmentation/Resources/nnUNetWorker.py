@@ -0,0 +1,232 @@
+#============================================================================
+#
+# The Medical Imaging Interaction Toolkit (MITK)
+#
+# Copyright (c) German Cancer Research Center (DKFZ)
+# All rights reserved.
+#
+# Use of this source code is governed by a 3-clause BSD license that can be
+# found in the LICENSE file.
+#
+#============================================================================
+
+"""Long-lived nnUNet inference worker of the MITK nnUNet tool.
+
+Serves the requests of mitk::nnUNetWorker (see mitknnUnetWorker.h for the
+protocol) and keeps all models it has loaded, so that repeated predictions
+skip the start of python and the loading of the checkpoints. Apart from that,
+a prediction runs the same nnUNet functions as nnUNet_predict.
+"""
+
+import argparse
+import glob
+import os
+import sys
+import time
+
+import numpy as np
+
+DONE_MESSAGE = 'nnunet-worker: done'
+
+
+def read_request(path):
+    request = {}
+    with open(path) as f:
+        for line in f:
+            key, _, value = line.rstrip('\n').partition('=')
+            request[key] = value
+    return request
+
+
+def write_atomically(path, content):
+    with open(path + '.tmp', 'w') as f:
+        f.write(content)
+    os.replace(path + '.tmp', path)
+
+
+def remove_request_files(session, request_id):
+    for path in glob.glob(os.path.join(session, request_id + '*')):
+        try:
+            os.remove(path)
+        except OSError:
+            pass
+
+
+class ModelCache(object):
+    """Trainers, checkpoint parameters and folders of all models used so far."""
+
+    def __init__(self):
+        self.models = {}
+
+    def get(self, request):
+        key = (request['task'], request['model'], request['trainer'], request['plans'], request['folds'],
+               request['mixed_precision'])
+        if key not in self.models:
+            self.models[key] = self.load(request)
+        return self.models[key]
+
+    @staticmethod
+    def load(request):
+        from nnunet.paths import network_training_output_dir
+        from nnunet.training.model_restore import load_model_and_checkpoint_files
+        from nnunet.utilities.task_name_id_conversion import convert_id_to_task_name
+
+        task = request['task']
+        if not task.startswith('Task'):
+            task = convert_id_to_task_name(int(task))
+        trainer_folder = os.path.join(network_training_output_dir, request['model'], task,
+                                      request['trainer'] + '__' + request['plans'])
+        folds = [int(f) if f != 'all' else f for f in request['folds'].split(',') if f] or None
+        trainer, params = load_model_and_checkpoint_files(trainer_folder, folds,
+                                                          mixed_precision=request['mixed_precision'] == '1',
+                                                          checkpoint_name='model_final_checkpoint')
+        return trainer, params, trainer_folder
+
+
+def write_input(session, request_id, request):
+    """Writes the modalities as NIfTI files like nnUNet_predict expects them and returns their paths."""
+    import SimpleITK as sitk
+
+    dimensions = [int(d) for d in request['dimensions'].split(',')]
+    spacing = [float(s) for s in request['spacing'].split(',')]
+    origin = [float(o) for o in request['origin'].split(',')]
+    direction = [float(d) for d in request['direction'].split(',')]
+
+    paths = []
+    for m in range(int(request['modalities'])):
+        path = os.path.join(session, '%s_%04d.raw' % (request_id, m))
+        # x is the fastest index, so the array is indexed (z, y, x) like sitk.GetArrayFromImage
+        buffer = np.fromfile(path, dtype=request['pixel_type']).reshape(dimensions[::-1])
+        image = sitk.GetImageFromArray(buffer)
+        image.SetSpacing(spacing)
+        image.SetOrigin(origin)
+        image.SetDirection(direction)
+        paths.append(os.path.join(session, '%s_%04d.nii' % (request_id, m)))
+        sitk.WriteImage(image, paths[-1])
+    return paths
+
+
+def predict(trainer, params, trainer_folder, input_paths, output_path, request, is_cancelled):
+    """Runs the steps of nnunet.inference.predict.predict_cases with the cached trainer.
+
+    Preprocessing, export and postprocessing are done by the nnUNet functions themselves,
+    so the result equals the one of nnUNet_predict.
+    """
+    from nnunet.inference.segmentation_export import save_segmentation_nifti_from_softmax
+    from nnunet.postprocessing.connected_components import load_postprocessing, load_remove_save
+
+    if 'segmentation_export_params' in trainer.plans.keys():
+        force_separate_z = trainer.plans['segmentation_export_params']['force_separate_z']
+        interpolation_order = trainer.plans['segmentation_export_params']['interpolation_order']
+        interpolation_order_z = trainer.plans['segmentation_export_params']['interpolation_order_z']
+    else:
+        force_separate_z = None
+        interpolation_order = 1
+        interpolation_order_z = 0
+
+    data, _, properties = trainer.preprocess_patient(input_paths)
+
+    softmax = []
+    for checkpoint in params:
+        if is_cancelled():
+            return False
+        trainer.load_checkpoint_ram(checkpoint, False)
+        softmax.append(trainer.predict_preprocessed_data_return_seg_and_softmax(
+            data, do_mirroring=request['mirror'] == '1', mirror_axes=trainer.data_aug_params['mirror_axes'],
+            use_sliding_window=True, step_size=0.5, use_gaussian=True, all_in_gpu=False,
+            mixed_precision=request['mixed_precision'] == '1')[1][None])
+    softmax = np.vstack(softmax)
+    softmax_mean = np.mean(softmax, 0)
+
+    transpose_forward = trainer.plans.get('transpose_forward')
+    if transpose_forward is not None:
+        transpose_backward = trainer.plans.get('transpose_backward')
+        softmax_mean = softmax_mean.transpose([0] + [i + 1 for i in transpose_backward])
+
+    region_class_order = getattr(trainer, 'regions_class_order', None)
+    save_segmentation_nifti_from_softmax(softmax_mean, output_path, properties, interpolation_order,
+                                         region_class_order, None, None, None, None, force_separate_z,
+                                         interpolation_order_z)
+
+    postprocessing_path = os.path.join(trainer_folder, 'postprocessing.json')
+    if os.path.isfile(postprocessing_path):
+        for_which_classes, min_valid_obj_size = load_postprocessing(postprocessing_path)
+        load_remove_save(output_path, output_path, for_which_classes, min_valid_obj_size)
+    return True
+
+
+def write_output(output_path, raw_path):
+    import SimpleITK as sitk
+
+    segmentation = sitk.GetArrayFromImage(sitk.ReadImage(output_path))
+    segmentation.astype(np.uint16).tofile(raw_path)
+
+
+def wait_for_notification(poll_interval):
+    """Blocks until the client announces a new request, a cancellation or the stop on stdin.
+
+    Returns False if the worker should quit. Workers started without the MITK client
+    can poll the session directory instead.
+    """
+    if poll_interval > 0:
+        time.sleep(poll_interval)
+        return True
+    line = sys.stdin.readline()
+    return bool(line) and line.strip() != 'stop'
+
+
+def serve(session, poll_interval):
+    models = ModelCache()
+    stop_path = os.path.join(session, 'stop')
+    while os.path.isdir(session) and not os.path.exists(stop_path):
+        for cancel_path in glob.glob(os.path.join(session, '*.cancel')):
+            remove_request_files(session, os.path.basename(cancel_path)[:-len('.cancel')])
+
+        requests = sorted(glob.glob(os.path.join(session, '*.request')))
+        if not requests:
+            if not wait_for_notification(poll_interval):
+                break
+            continue
+
+        request_path = requests[0]
+        request_id = os.path.basename(request_path)[:-len('.request')]
+        cancel_path = os.path.join(session, request_id + '.cancel')
+        done_path = os.path.join(session, request_id + '.done')
+        try:
+            request = read_request(request_path)
+            os.remove(request_path)
+            trainer, params, trainer_folder = models.get(request)
+            input_paths = write_input(session, request_id, request)
+            output_path = os.path.join(session, request_id + '_seg.nii')
+            if predict(trainer, params, trainer_folder, input_paths, output_path, request,
+                       lambda: os.path.exists(cancel_path)):
+                write_output(output_path, os.path.join(session, request_id + '_seg.raw'))
+                write_atomically(done_path, 'ok\n')
+        except Exception as e:
+            write_atomically(done_path, 'error: %s\n' % str(e).replace('\n', ' '))
+        finally:
+            for path in glob.glob(os.path.join(session, request_id + '_*.nii')):
+                os.remove(path)
+
+        if os.path.exists(cancel_path):
+            remove_request_files(session, request_id)
+        elif os.path.exists(done_path):
+            print('%s %s' % (DONE_MESSAGE, request_id), flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--session', required=True, help='directory used to exchange the requests')
+    parser.add_argument('--nnunet_dir', default='', help='nnUNet code directory if it is not installed via pip')
+    parser.add_argument('--poll_interval', type=float, default=0.0,
+                        help='seconds between polls of the session directory; 0 (default) waits for the '
+                             'notifications of the client on stdin')
+    args = parser.parse_args()
+
+    if args.nnunet_dir:
+        sys.path.insert(0, args.nnunet_dir)
+    serve(args.session, args.poll_interval)
+
+
+if __name__ == '__main__':
+    main()
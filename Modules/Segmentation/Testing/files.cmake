@@ -12,6 +12,15 @@ set(MODULE_TESTS
   mitkToolManagerProviderTest.cpp
   mitkManualSegmentationToSurfaceFilterTest.cpp #new cpp unit style
   mitkToolInteractionTest.cpp
+  mitknnUnetWorkerTest.cpp
+  mitkPaintbrushStampTest.cpp
+  mitkSliceOccupancyIndexTest.cpp
+  mitkBlockwiseSurfaceGeneratorTest.cpp
+  mitkShapeBasedInterpolationAlgorithmTest.cpp
+  mitkIncrementalRegionGrowerTest.cpp
+  mitkWatershedHierarchyTest.cpp
+  mitkOtsuHistogramTest.cpp
+  mitkAutoSegmentationWithPreviewToolTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
@@ -0,0 +1,252 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkAutoSegmentationWithPreviewTool.h>
+#include <mitkCallbackFromGUIThread.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkToolManager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  /// Queues the callbacks, they are executed when the test calls ProcessCallbacks() (like an event loop would).
+  class QueuedCallbackFromGUIThread : public mitk::CallbackFromGUIThreadImplementation
+  {
+  public:
+    void CallThisFromGUIThread(itk::Command *command, itk::EventObject *event) override
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_Callbacks.emplace_back(command, std::unique_ptr<itk::EventObject>(event));
+    }
+
+    std::size_t GetNumberOfCallbacks()
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      return m_Callbacks.size();
+    }
+
+    void ProcessCallbacks()
+    {
+      std::vector<std::pair<itk::Command::Pointer, std::unique_ptr<itk::EventObject>>> callbacks;
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        callbacks.swap(m_Callbacks);
+      }
+
+      const itk::NoEvent dummyEvent;
+      for (const auto &callback : callbacks)
+      {
+        callback.first->Execute(static_cast<const itk::Object *>(nullptr), nullptr != callback.second ? *callback.second : dummyEvent);
+      }
+    }
+
+  private:
+    std::mutex m_Mutex;
+    std::vector<std::pair<itk::Command::Pointer, std::unique_ptr<itk::EventObject>>> m_Callbacks;
+  };
+
+  /// Labels every voxel. The first slice is "visible", the background blocks take some time.
+  class TestRegionalPreviewTool : public mitk::AutoSegmentationWithPreviewTool
+  {
+  public:
+    mitkClassMacro(TestRegionalPreviewTool, mitk::AutoSegmentationWithPreviewTool);
+    itkFactorylessNewMacro(Self);
+
+    const char **GetXPM() const override { return nullptr; }
+    const char *GetName() const override { return "Test regional preview"; }
+
+    void Initialize(mitk::ToolManager *toolManager) { this->SetToolManager(toolManager); }
+    mitk::Image *GetPreview() { return this->GetPreviewSegmentation(); }
+
+    std::shared_ptr<std::atomic<unsigned int>> ComputedBlocks = std::make_shared<std::atomic<unsigned int>>(0);
+
+  protected:
+    TestRegionalPreviewTool() = default;
+    ~TestRegionalPreviewTool() override { this->CancelBackgroundPreview(); }
+
+    bool SupportsRegionalPreview() const override { return true; }
+
+    std::vector<PreviewRegionType> GetVisiblePreviewRegions(const mitk::Image *inputAtTimeStep) const override
+    {
+      PreviewRegionType::SizeType size;
+      size[0] = inputAtTimeStep->GetDimension(0);
+      size[1] = inputAtTimeStep->GetDimension(1);
+      size[2] = 1;
+      return { PreviewRegionType(size) };
+    }
+
+    void DoUpdatePreview(const mitk::Image *, const mitk::Image *, mitk::Image *previewImage, mitk::TimeStepType timeStep) override
+    {
+      mitk::ImageWriteAccessor accessor(previewImage, previewImage->GetVolumeData(timeStep));
+      auto *buffer = static_cast<DefaultSegmentationDataType *>(accessor.GetData());
+      std::fill(buffer, buffer + previewImage->GetDimension(0) * previewImage->GetDimension(1) * previewImage->GetDimension(2), 1);
+    }
+
+    void DoUpdatePreviewRegion(const mitk::Image *, const mitk::Image *, mitk::Image *previewImage, mitk::TimeStepType timeStep, const PreviewRegionType &region) override
+    {
+      const auto isBackgroundBlock = region.GetSize(2) > 1;
+      if (isBackgroundBlock)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+
+      mitk::ImageWriteAccessor accessor(previewImage, previewImage->GetVolumeData(timeStep));
+      auto *buffer = static_cast<DefaultSegmentationDataType *>(accessor.GetData());
+      const auto sizeX = previewImage->GetDimension(0);
+      const auto sizeY = previewImage->GetDimension(1);
+      for (auto z = region.GetIndex(2); z < region.GetUpperIndex()[2] + 1; ++z)
+        for (auto y = region.GetIndex(1); y < region.GetUpperIndex()[1] + 1; ++y)
+          for (auto x = region.GetIndex(0); x < region.GetUpperIndex()[0] + 1; ++x)
+            buffer[x + sizeX * (y + sizeY * z)] = 1;
+
+      if (isBackgroundBlock)
+      {
+        ++(*ComputedBlocks);
+      }
+    }
+  };
+}
+
+class mitkAutoSegmentationWithPreviewToolTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkAutoSegmentationWithPreviewToolTestSuite);
+  MITK_TEST(BackgroundPreview_IsTransferredInGUIThread);
+  MITK_TEST(DestroyTool_WhileBackgroundPreviewIsRunning);
+  MITK_TEST(DestroyTool_BeforeCallbackOfBackgroundPreview);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  /// 8 blocks of the background computation
+  const unsigned int m_NumberOfSlices = 64;
+
+  QueuedCallbackFromGUIThread m_Callbacks;
+  mitk::StandaloneDataStorage::Pointer m_DataStorage;
+  mitk::ToolManager::Pointer m_ToolManager;
+  TestRegionalPreviewTool::Pointer m_Tool;
+
+  unsigned int CountLabeledVoxels(mitk::Image *image)
+  {
+    mitk::ImageReadAccessor accessor(image, image->GetVolumeData(0));
+    auto *buffer = static_cast<const mitk::Tool::DefaultSegmentationDataType *>(accessor.GetData());
+    const auto numberOfVoxels = image->GetDimension(0) * image->GetDimension(1) * image->GetDimension(2);
+    return static_cast<unsigned int>(std::count(buffer, buffer + numberOfVoxels, 1));
+  }
+
+  void WaitForCallback()
+  {
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (0 == m_Callbacks.GetNumberOfCallbacks() && std::chrono::steady_clock::now() < timeout)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CPPUNIT_ASSERT_MESSAGE("Background computation posts its result to the GUI thread.", 0 < m_Callbacks.GetNumberOfCallbacks());
+  }
+
+public:
+  void setUp() override
+  {
+    mitk::CallbackFromGUIThread::GetInstance()->RegisterImplementation(&m_Callbacks);
+
+    unsigned int dimensions[3] = { 4, 4, m_NumberOfSlices };
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<short>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor accessor(image);
+      std::fill_n(static_cast<short *>(accessor.GetData()), 4 * 4 * m_NumberOfSlices, 0);
+    }
+
+    m_DataStorage = mitk::StandaloneDataStorage::New();
+    m_ToolManager = mitk::ToolManager::New(m_DataStorage);
+    m_Tool = TestRegionalPreviewTool::New();
+    m_Tool->Initialize(m_ToolManager);
+
+    auto referenceNode = mitk::DataNode::New();
+    referenceNode->SetData(image);
+    mitk::Color color;
+    color.Set(1.0, 0.0, 0.0);
+    auto workingNode = m_Tool->CreateEmptySegmentationNode(image, "test", color);
+    m_DataStorage->Add(referenceNode);
+    m_DataStorage->Add(workingNode);
+    m_ToolManager->SetReferenceData(referenceNode);
+    m_ToolManager->SetWorkingData(workingNode);
+
+    m_Tool->Activated();
+  }
+
+  void tearDown() override
+  {
+    if (m_Tool.IsNotNull())
+    {
+      m_Tool->Deactivated();
+      m_Tool = nullptr;
+    }
+    m_Callbacks.ProcessCallbacks();
+    m_ToolManager = nullptr;
+    m_DataStorage = nullptr;
+    mitk::CallbackFromGUIThread::GetInstance()->RegisterImplementation(nullptr);
+  }
+
+  void BackgroundPreview_IsTransferredInGUIThread()
+  {
+    m_Tool->UpdatePreview();
+    CPPUNIT_ASSERT(m_Tool->IsUpdatingInBackground());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Only the visible slice is computed in the preview, the rest in a private buffer.", 4u * 4u, CountLabeledVoxels(m_Tool->GetPreview()));
+
+    WaitForCallback();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Preview is not changed before the GUI thread takes over the result.", 4u * 4u, CountLabeledVoxels(m_Tool->GetPreview()));
+
+    m_Callbacks.ProcessCallbacks();
+    CPPUNIT_ASSERT(!m_Tool->IsUpdatingInBackground());
+    CPPUNIT_ASSERT_EQUAL(4u * 4u * m_NumberOfSlices, CountLabeledVoxels(m_Tool->GetPreview()));
+  }
+
+  void DestroyTool_WhileBackgroundPreviewIsRunning()
+  {
+    auto computedBlocks = m_Tool->ComputedBlocks;
+    m_Tool->UpdatePreview();
+    CPPUNIT_ASSERT(m_Tool->IsUpdatingInBackground());
+
+    m_Tool = nullptr;
+    const auto blocksAtDestruction = computedBlocks->load();
+    CPPUNIT_ASSERT_MESSAGE("Destroying the tool stops the background computation.", blocksAtDestruction < m_NumberOfSlices / 8);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CPPUNIT_ASSERT_EQUAL(blocksAtDestruction, computedBlocks->load());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("A canceled computation posts no callback.", std::size_t(0), m_Callbacks.GetNumberOfCallbacks());
+  }
+
+  void DestroyTool_BeforeCallbackOfBackgroundPreview()
+  {
+    m_Tool->UpdatePreview();
+    WaitForCallback();
+
+    // The callback was posted while the tool existed and is executed after the tool was destroyed
+    m_Tool = nullptr;
+    m_Callbacks.ProcessCallbacks();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), m_Callbacks.GetNumberOfCallbacks());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkAutoSegmentationWithPreviewTool)
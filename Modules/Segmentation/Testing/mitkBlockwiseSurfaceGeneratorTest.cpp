@@ -0,0 +1,134 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkBlockwiseSurfaceGenerator.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <vtkFeatureEdges.h>
+#include <vtkMath.h>
+#include <vtkPointData.h>
+#include <vtkPointLocator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+class mitkBlockwiseSurfaceGeneratorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkBlockwiseSurfaceGeneratorTestSuite);
+  MITK_TEST(Generate_BlocksAreStitchedWatertight);
+  MITK_TEST(Generate_BlocksMatchSurfaceInOnePiece);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+
+  vtkSmartPointer<vtkPolyData> Generate(unsigned int blockSize, double &milliseconds)
+  {
+    auto generator = mitk::BlockwiseSurfaceGenerator::New();
+    generator->SetThreshold(50);
+    generator->SetDecimation(0.5);
+    generator->SetBlockSize(blockSize);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto polyData = generator->Generate(m_Image);
+    milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return polyData;
+  }
+
+  /** Largest distance of a vertex of one surface to the nearest vertex of the other one (both directions). */
+  double VertexHausdorffDistance(vtkPolyData *a, vtkPolyData *b)
+  {
+    double distance = 0.0;
+    for (auto pair : {std::make_pair(a, b), std::make_pair(b, a)})
+    {
+      auto locator = vtkSmartPointer<vtkPointLocator>::New();
+      locator->SetDataSet(pair.second);
+      locator->BuildLocator();
+
+      double point[3];
+      for (vtkIdType i = 0; i < pair.first->GetNumberOfPoints(); ++i)
+      {
+        pair.first->GetPoint(i, point);
+        const double *nearest = pair.second->GetPoint(locator->FindClosestPoint(point));
+        distance = std::max(distance, std::sqrt(vtkMath::Distance2BetweenPoints(point, nearest)));
+      }
+    }
+    return distance;
+  }
+
+public:
+  void setUp() override
+  {
+    // ellipsoid with semi-axes of 14, 12 and 30 pixels in the center of the image
+    unsigned int dimensions[3] = {40, 36, 80};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+
+    mitk::ImagePixelWriteAccessor<unsigned char, 3> accessor(m_Image);
+    itk::Index<3> index;
+    for (index[2] = 0; index[2] < 80; ++index[2])
+      for (index[1] = 0; index[1] < 36; ++index[1])
+        for (index[0] = 0; index[0] < 40; ++index[0])
+        {
+          const double x = (index[0] - 19.5) / 14.0;
+          const double y = (index[1] - 17.5) / 12.0;
+          const double z = (index[2] - 39.5) / 30.0;
+          accessor.SetPixelByIndex(index, x * x + y * y + z * z <= 1.0 ? 100 : 0);
+        }
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void Generate_BlocksAreStitchedWatertight()
+  {
+    double milliseconds = 0.0;
+    auto polyData = this->Generate(8, milliseconds);
+    CPPUNIT_ASSERT(polyData->GetNumberOfCells() > 0);
+
+    auto featureEdges = vtkSmartPointer<vtkFeatureEdges>::New();
+    featureEdges->SetInputData(polyData);
+    featureEdges->BoundaryEdgesOn();
+    featureEdges->NonManifoldEdgesOn();
+    featureEdges->FeatureEdgesOff();
+    featureEdges->ManifoldEdgesOff();
+    featureEdges->Update();
+
+    CPPUNIT_ASSERT_EQUAL(vtkIdType(0), featureEdges->GetOutput()->GetNumberOfCells());
+    CPPUNIT_ASSERT(nullptr != polyData->GetPointData()->GetNormals());
+  }
+
+  void Generate_BlocksMatchSurfaceInOnePiece()
+  {
+    double onePieceTime = 0.0;
+    auto onePiece = this->Generate(0, onePieceTime);
+
+    double blocksTime = 0.0;
+    auto blocks = this->Generate(8, blocksTime);
+
+    const double distance = this->VertexHausdorffDistance(onePiece, blocks);
+
+    MITK_INFO << "Surface in one piece: " << onePiece->GetNumberOfPolys() << " triangles, " << onePieceTime << " ms";
+    MITK_INFO << "Surface in blocks: " << blocks->GetNumberOfPolys() << " triangles, " << blocksTime << " ms";
+    MITK_INFO << "Vertex Hausdorff distance: " << distance;
+
+    CPPUNIT_ASSERT(onePiece->GetNumberOfPolys() > 0);
+    CPPUNIT_ASSERT(blocks->GetNumberOfPolys() > 0);
+    CPPUNIT_ASSERT(blocks->GetNumberOfPolys() < 2 * onePiece->GetNumberOfPolys());
+    CPPUNIT_ASSERT(distance < 2.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkBlockwiseSurfaceGenerator)
@@ -0,0 +1,141 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkIncrementalRegionGrower.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkConnectedThresholdImageFilter.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+class mitkIncrementalRegionGrowerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkIncrementalRegionGrowerTestSuite);
+  MITK_TEST(Update_2DWindowSequence_EqualsConnectedThresholdImageFilter);
+  MITK_TEST(Update_3DWindowSequence_EqualsConnectedThresholdImageFilter);
+  MITK_TEST(Update_SeedOutsideOfWindow_RegionIsEmpty);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  template <unsigned int VDimension>
+  typename itk::Image<short, VDimension>::Pointer CreateNoiseImage(unsigned int size)
+  {
+    using ImageType = itk::Image<short, VDimension>;
+
+    typename ImageType::SizeType imageSize;
+    imageSize.Fill(size);
+
+    auto image = ImageType::New();
+    image->SetRegions(imageSize);
+    image->Allocate();
+
+    // noise creates ragged regions with holes
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 99);
+
+    for (itk::ImageRegionIterator<ImageType> iterator(image, image->GetLargestPossibleRegion()); !iterator.IsAtEnd();
+         ++iterator)
+    {
+      iterator.Set(static_cast<short>(distribution(generator)));
+    }
+
+    return image;
+  }
+
+  template <unsigned int VDimension>
+  void CompareWindowSequence(unsigned int size)
+  {
+    using ImageType = itk::Image<short, VDimension>;
+    using MaskType = itk::Image<unsigned char, VDimension>;
+
+    auto image = this->CreateNoiseImage<VDimension>(size);
+
+    typename ImageType::IndexType seed;
+    seed.Fill(size / 2);
+    image->SetPixel(seed, 50);
+
+    mitk::IncrementalRegionGrower<ImageType> regionGrower;
+    regionGrower.Initialize(image, seed);
+    CPPUNIT_ASSERT(regionGrower.IsInitialized(image, seed));
+
+    // widening, narrowing and shifting windows like dragging the mouse in RegionGrowingTool
+    const std::vector<std::pair<short, short>> windows = {
+      {45, 55}, {40, 60}, {30, 70}, {20, 75}, {35, 65}, {35, 80}, {10, 90}, {50, 50}, {48, 99}, {0, 99}, {49, 51}};
+
+    for (const auto &window : windows)
+    {
+      regionGrower.Update(window.first, window.second);
+
+      auto filter = itk::ConnectedThresholdImageFilter<ImageType, MaskType>::New();
+      filter->SetInput(image);
+      filter->SetSeed(seed);
+      filter->SetLower(window.first);
+      filter->SetUpper(window.second);
+      filter->SetReplaceValue(1);
+      filter->Update();
+
+      const std::string message =
+        "Window [" + std::to_string(window.first) + ", " + std::to_string(window.second) + "]";
+
+      std::size_t numberOfPixels = 0;
+      itk::ImageRegionConstIteratorWithIndex<MaskType> iterator(filter->GetOutput(),
+                                                                filter->GetOutput()->GetLargestPossibleRegion());
+
+      for (; !iterator.IsAtEnd(); ++iterator)
+      {
+        const bool inside = 0 != iterator.Get();
+        CPPUNIT_ASSERT_EQUAL_MESSAGE(message, inside, regionGrower.IsInside(iterator.GetIndex()));
+
+        if (inside)
+        {
+          CPPUNIT_ASSERT_MESSAGE(message, regionGrower.GetBoundingBox().IsInside(iterator.GetIndex()));
+          ++numberOfPixels;
+        }
+      }
+
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(message, numberOfPixels, regionGrower.GetNumberOfPixels());
+    }
+  }
+
+public:
+  void Update_2DWindowSequence_EqualsConnectedThresholdImageFilter() { this->CompareWindowSequence<2>(128); }
+
+  void Update_3DWindowSequence_EqualsConnectedThresholdImageFilter() { this->CompareWindowSequence<3>(32); }
+
+  void Update_SeedOutsideOfWindow_RegionIsEmpty()
+  {
+    using ImageType = itk::Image<short, 2>;
+
+    auto image = this->CreateNoiseImage<2>(16);
+    ImageType::IndexType seed = {{8, 8}};
+    image->SetPixel(seed, 50);
+
+    mitk::IncrementalRegionGrower<ImageType> regionGrower;
+    regionGrower.Initialize(image, seed);
+
+    regionGrower.Update(60, 70);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), regionGrower.GetNumberOfPixels());
+    CPPUNIT_ASSERT_EQUAL(itk::SizeValueType(0), regionGrower.GetBoundingBox().GetNumberOfPixels());
+
+    // widening the window of an empty region starts at the seed
+    regionGrower.Update(40, 70);
+    CPPUNIT_ASSERT(regionGrower.IsInside(seed));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkIncrementalRegionGrower)
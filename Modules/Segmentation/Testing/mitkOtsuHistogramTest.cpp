@@ -0,0 +1,186 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImageCast.h>
+#include <mitkOtsuHistogram.h>
+#include <mitkOtsuSegmentationFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkOtsuMultipleThresholdsCalculator.h>
+#include <itkOtsuMultipleThresholdsImageFilter.h>
+
+#include <random>
+#include <string>
+
+class mitkOtsuHistogramTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkOtsuHistogramTestSuite);
+  MITK_TEST(ComputeThresholds_RandomHistograms_EqualsOtsuMultipleThresholdsCalculator);
+  MITK_TEST(Update_ChangedParameters_ReusesHistogramAndEqualsOtsuMultipleThresholdsImageFilter);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  using HistogramType = mitk::OtsuHistogram::HistogramType;
+  using InputImageType = itk::Image<short, 3>;
+  using OutputImageType = itk::Image<mitk::OtsuSegmentationFilter::OutputPixelType, 3>;
+
+  HistogramType::Pointer CreateRandomHistogram(unsigned int numberOfBins, unsigned int seed)
+  {
+    HistogramType::SizeType size(1);
+    size.Fill(numberOfBins);
+
+    HistogramType::MeasurementVectorType lowerBound(1);
+    HistogramType::MeasurementVectorType upperBound(1);
+    lowerBound.Fill(0.0);
+    upperBound.Fill(static_cast<double>(numberOfBins));
+
+    auto histogram = HistogramType::New();
+    histogram->SetMeasurementVectorSize(1);
+    histogram->Initialize(size, lowerBound, upperBound);
+
+    // no empty bins: moving an empty bin between classes keeps the objective, so the optimal thresholds would tie
+    // and the tie breaking would depend on the rounding of the two implementations
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(1, 1000);
+
+    for (unsigned int bin = 0; bin < numberOfBins; ++bin)
+      histogram->SetFrequency(bin, distribution(generator));
+
+    return histogram;
+  }
+
+  /** Three overlapping gray value clusters. */
+  mitk::Image::Pointer CreateImage()
+  {
+    InputImageType::SizeType size;
+    size.Fill(24);
+
+    auto image = InputImageType::New();
+    image->SetRegions(size);
+    image->Allocate();
+
+    using DistributionType = std::normal_distribution<double>;
+
+    std::mt19937 generator(42);
+    DistributionType clusters[3] = {
+      DistributionType(100.0, 20.0), DistributionType(300.0, 40.0), DistributionType(450.0, 15.0)};
+    std::uniform_int_distribution<int> cluster(0, 2);
+
+    for (itk::ImageRegionIterator<InputImageType> iterator(image, image->GetLargestPossibleRegion());
+         !iterator.IsAtEnd();
+         ++iterator)
+    {
+      iterator.Set(static_cast<short>(clusters[cluster(generator)](generator)));
+    }
+
+    mitk::Image::Pointer mitkImage;
+    mitk::CastToMitkImage(image, mitkImage);
+    return mitkImage;
+  }
+
+  void CompareWithOtsuMultipleThresholdsImageFilter(mitk::Image *image,
+                                                    mitk::OtsuSegmentationFilter *filter,
+                                                    unsigned int numberOfThresholds,
+                                                    bool valleyEmphasis)
+  {
+    InputImageType::Pointer itkImage;
+    mitk::CastToItkImage(image, itkImage);
+
+    auto itkFilter = itk::OtsuMultipleThresholdsImageFilter<InputImageType, OutputImageType>::New();
+    itkFilter->SetInput(itkImage);
+    itkFilter->SetNumberOfThresholds(numberOfThresholds);
+    itkFilter->SetValleyEmphasis(valleyEmphasis);
+    itkFilter->SetNumberOfHistogramBins(128);
+    itkFilter->Update();
+
+    OutputImageType::Pointer output;
+    mitk::CastToItkImage(filter->GetOutput(), output);
+
+    itk::ImageRegionConstIterator<OutputImageType> expected(itkFilter->GetOutput(),
+                                                            itkFilter->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<OutputImageType> actual(output, output->GetLargestPossibleRegion());
+
+    for (; !expected.IsAtEnd(); ++expected, ++actual)
+      CPPUNIT_ASSERT_EQUAL(expected.Get(), actual.Get());
+  }
+
+public:
+  void ComputeThresholds_RandomHistograms_EqualsOtsuMultipleThresholdsCalculator()
+  {
+    for (unsigned int seed = 0; seed < 4; ++seed)
+    {
+      auto histogram = this->CreateRandomHistogram(24 + 4 * seed, seed);
+
+      for (unsigned int numberOfThresholds = 1; numberOfThresholds <= 3; ++numberOfThresholds)
+      {
+        for (bool valleyEmphasis : {false, true})
+        {
+          auto calculator = itk::OtsuMultipleThresholdsCalculator<HistogramType>::New();
+          calculator->SetInputHistogram(histogram);
+          calculator->SetNumberOfThresholds(numberOfThresholds);
+          calculator->SetValleyEmphasis(valleyEmphasis);
+          calculator->Compute();
+
+          const auto &expected = calculator->GetOutput();
+          const auto actual = mitk::OtsuHistogram::ComputeThresholds(histogram, numberOfThresholds, valleyEmphasis);
+
+          const std::string message = "Seed " + std::to_string(seed) + ", " + std::to_string(numberOfThresholds) +
+                                      " thresholds, valley emphasis " + std::to_string(valleyEmphasis);
+
+          CPPUNIT_ASSERT_EQUAL_MESSAGE(message, expected.size(), actual.size());
+          for (std::size_t i = 0; i < expected.size(); ++i)
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(message, expected[i], actual[i], 1e-9);
+        }
+      }
+    }
+  }
+
+  void Update_ChangedParameters_ReusesHistogramAndEqualsOtsuMultipleThresholdsImageFilter()
+  {
+    auto image = this->CreateImage();
+
+    auto filter = mitk::OtsuSegmentationFilter::New();
+    filter->SetInput(image);
+    filter->SetNumberOfBins(128);
+    filter->SetNumberOfThresholds(1);
+    filter->Update();
+    this->CompareWithOtsuMultipleThresholdsImageFilter(image, filter, 1, false);
+
+    const auto *histogram = filter->GetHistogram();
+    CPPUNIT_ASSERT(nullptr != histogram);
+    CPPUNIT_ASSERT_EQUAL(128u, histogram->GetNumberOfBins());
+
+    filter->SetNumberOfThresholds(2);
+    filter->Update();
+    CPPUNIT_ASSERT(histogram == filter->GetHistogram());
+    this->CompareWithOtsuMultipleThresholdsImageFilter(image, filter, 2, false);
+
+    filter->SetValleyEmphasis(true);
+    filter->Update();
+    CPPUNIT_ASSERT(histogram == filter->GetHistogram());
+    this->CompareWithOtsuMultipleThresholdsImageFilter(image, filter, 2, true);
+
+    // a new filter can start with the histogram of the first one
+    auto otherFilter = mitk::OtsuSegmentationFilter::New();
+    otherFilter->SetInput(image);
+    otherFilter->SetHistogram(histogram);
+    otherFilter->SetNumberOfThresholds(3);
+    otherFilter->Update();
+    CPPUNIT_ASSERT(histogram == otherFilter->GetHistogram());
+    this->CompareWithOtsuMultipleThresholdsImageFilter(image, otherFilter, 3, false);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkOtsuHistogram)
@@ -0,0 +1,327 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkLabelSetImage.h>
+#include <mitkPaintbrushStamp.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+#include <cmath>
+
+class mitkPaintbrushStampTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPaintbrushStampTestSuite);
+  MITK_TEST(GetMask_MatchesCircleOfBrushContour);
+  MITK_TEST(Paint_SinglePosition_PaintsMask);
+  MITK_TEST(Paint_FastStroke_HasNoGaps);
+  MITK_TEST(Paint_OutsideOfSlice_IsClipped);
+  MITK_TEST(Paint_LabelSetImage_SkipsLockedLabels);
+  MITK_TEST(Paint_LabelSetImage_ErasesActiveLabelOnly);
+  MITK_TEST(Paint_SimulatedStrokes_DirtyRegionIsBoundingBoxOfStrokes);
+  MITK_TEST(ExtractRegion_CopiesPixelsAndGeometryOfRegion);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  using PixelType = mitk::Label::PixelType;
+
+  mitk::PaintbrushStamp::Pointer m_Stamp;
+
+  mitk::Image::Pointer CreateSlice(unsigned int width, unsigned int height, PixelType value = 0)
+  {
+    unsigned int dimensions[2] = {width, height};
+    auto slice = mitk::Image::New();
+    slice->Initialize(mitk::MakeScalarPixelType<PixelType>(), 2, dimensions);
+    mitk::ImagePixelWriteAccessor<PixelType, 2> writeAccess(slice);
+    std::fill(writeAccess.GetData(), writeAccess.GetData() + width * height, value);
+    return slice;
+  }
+
+  PixelType GetPixel(mitk::Image *slice, int x, int y)
+  {
+    mitk::ImagePixelReadAccessor<PixelType, 2> readAccess(slice);
+    return readAccess.GetData()[y * slice->GetDimension(0) + x];
+  }
+
+  unsigned int CountPixels(mitk::Image *slice, PixelType value)
+  {
+    mitk::ImagePixelReadAccessor<PixelType, 2> readAccess(slice);
+    const auto numberOfPixels = slice->GetDimension(0) * slice->GetDimension(1);
+    return static_cast<unsigned int>(std::count(readAccess.GetData(), readAccess.GetData() + numberOfPixels, value));
+  }
+
+  mitk::PaintbrushStamp::IndexType Index(int x, int y)
+  {
+    mitk::PaintbrushStamp::IndexType index = {{x, y}};
+    return index;
+  }
+
+  bool IsInBrush(int size, double x, double y)
+  {
+    // criterion of mitk::PaintbrushTool::UpdateContour()
+    const double center = size % 2 == 0 ? 0.5 : 0.0;
+    return std::sqrt((x - center) * (x - center) + (y - center) * (y - center)) <= size / 2.0;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Stamp = mitk::PaintbrushStamp::New();
+  }
+
+  void tearDown() override
+  {
+    m_Stamp = nullptr;
+  }
+
+  void GetMask_MatchesCircleOfBrushContour()
+  {
+    for (int size = 1; size <= 40; ++size)
+    {
+      m_Stamp->SetSize(size);
+      CPPUNIT_ASSERT_EQUAL(size, m_Stamp->GetSize());
+
+      unsigned int numberOfMaskPixels = 0;
+      for (const auto &span : m_Stamp->GetMask())
+      {
+        CPPUNIT_ASSERT(span.Begin < span.End);
+        CPPUNIT_ASSERT(!this->IsInBrush(size, span.Begin - 1, span.Row));
+        CPPUNIT_ASSERT(!this->IsInBrush(size, span.End, span.Row));
+        for (int x = span.Begin; x < span.End; ++x)
+        {
+          CPPUNIT_ASSERT(this->IsInBrush(size, x, span.Row));
+        }
+        numberOfMaskPixels += span.End - span.Begin;
+      }
+
+      unsigned int numberOfBrushPixels = 0;
+      for (int y = -size; y <= size; ++y)
+      {
+        for (int x = -size; x <= size; ++x)
+        {
+          numberOfBrushPixels += this->IsInBrush(size, x, y);
+        }
+      }
+      CPPUNIT_ASSERT_EQUAL(numberOfBrushPixels, numberOfMaskPixels);
+    }
+
+    // masks are shared between all brushes of the same size
+    auto otherStamp = mitk::PaintbrushStamp::New();
+    otherStamp->SetSize(40);
+    CPPUNIT_ASSERT(&m_Stamp->GetMask() == &otherStamp->GetMask());
+  }
+
+  void Paint_SinglePosition_PaintsMask()
+  {
+    auto slice = this->CreateSlice(20, 20);
+    m_Stamp->SetSize(2);
+    CPPUNIT_ASSERT(!m_Stamp->IsDirty());
+
+    auto region = m_Stamp->Paint(slice, nullptr, this->Index(5, 7), this->Index(5, 7), 3);
+    CPPUNIT_ASSERT_EQUAL(4u, this->CountPixels(slice, 3));
+    CPPUNIT_ASSERT_EQUAL(PixelType(3), this->GetPixel(slice, 5, 7));
+    CPPUNIT_ASSERT_EQUAL(PixelType(3), this->GetPixel(slice, 6, 8));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(5), region.GetIndex(0));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(7), region.GetIndex(1));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::SizeValueType(4), region.GetNumberOfPixels());
+    CPPUNIT_ASSERT(m_Stamp->IsDirty());
+    CPPUNIT_ASSERT(m_Stamp->GetDirtyRegion() == region);
+
+    m_Stamp->Paint(slice, nullptr, this->Index(12, 2), this->Index(12, 2), 3);
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(5), m_Stamp->GetDirtyRegion().GetIndex(0));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(2), m_Stamp->GetDirtyRegion().GetIndex(1));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::SizeValueType(9), m_Stamp->GetDirtyRegion().GetSize(0));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::SizeValueType(7), m_Stamp->GetDirtyRegion().GetSize(1));
+
+    m_Stamp->ResetDirtyRegion();
+    CPPUNIT_ASSERT(!m_Stamp->IsDirty());
+  }
+
+  void Paint_FastStroke_HasNoGaps()
+  {
+    auto slice = this->CreateSlice(100, 100);
+    m_Stamp->SetSize(5);
+
+    // a single event jumping across the slice
+    m_Stamp->Paint(slice, nullptr, this->Index(10, 20), this->Index(80, 65), 1);
+
+    // the brushes at both ends are complete
+    for (const auto &span : m_Stamp->GetMask())
+    {
+      for (int x = span.Begin; x < span.End; ++x)
+      {
+        CPPUNIT_ASSERT_EQUAL(PixelType(1), this->GetPixel(slice, 10 + x, 20 + span.Row));
+        CPPUNIT_ASSERT_EQUAL(PixelType(1), this->GetPixel(slice, 80 + x, 65 + span.Row));
+      }
+    }
+
+    // every pixel of the line is covered with the full brush width
+    for (int x = 10; x <= 80; ++x)
+    {
+      const int y = 20 + static_cast<int>(std::lround((x - 10) * 45.0 / 70.0));
+      CPPUNIT_ASSERT_EQUAL(PixelType(1), this->GetPixel(slice, x, y));
+      CPPUNIT_ASSERT_EQUAL(PixelType(1), this->GetPixel(slice, x, y - 1));
+      CPPUNIT_ASSERT_EQUAL(PixelType(1), this->GetPixel(slice, x, y + 1));
+    }
+  }
+
+  void Paint_OutsideOfSlice_IsClipped()
+  {
+    auto slice = this->CreateSlice(10, 10);
+    m_Stamp->SetSize(5);
+
+    // only the lower right part of the brush at (-1, -1) is within the slice
+    auto region = m_Stamp->Paint(slice, nullptr, this->Index(-1, -1), this->Index(-1, -1), 1);
+    CPPUNIT_ASSERT_EQUAL(3u, this->CountPixels(slice, 1));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(0), region.GetIndex(0));
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::SizeValueType(4), region.GetNumberOfPixels());
+
+    m_Stamp->ResetDirtyRegion();
+    region = m_Stamp->Paint(slice, nullptr, this->Index(-20, 5), this->Index(-20, 30), 1);
+    CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::SizeValueType(0), region.GetNumberOfPixels());
+    CPPUNIT_ASSERT(!m_Stamp->IsDirty());
+    CPPUNIT_ASSERT_EQUAL(3u, this->CountPixels(slice, 1));
+  }
+
+  void Paint_LabelSetImage_SkipsLockedLabels()
+  {
+    auto workingImage = mitk::LabelSetImage::New();
+    workingImage->Initialize(this->CreateSlice(10, 10).GetPointer());
+    auto label = mitk::Label::New();
+    label->SetValue(2);
+    workingImage->GetActiveLabelSet()->AddLabel(label);
+    workingImage->GetActiveLabelSet()->GetLabel(2)->SetLocked(true);
+
+    auto slice = this->CreateSlice(10, 10);
+    {
+      mitk::ImagePixelWriteAccessor<PixelType, 2> writeAccess(slice);
+      writeAccess.GetData()[5 * 10 + 5] = 2;
+      writeAccess.GetData()[5 * 10 + 6] = 7;
+    }
+
+    m_Stamp->SetSize(3);
+    m_Stamp->Paint(slice, workingImage, this->Index(5, 5), this->Index(5, 5), 1);
+    CPPUNIT_ASSERT_EQUAL(PixelType(2), this->GetPixel(slice, 5, 5));
+    CPPUNIT_ASSERT_EQUAL(PixelType(1), this->GetPixel(slice, 6, 5));
+    CPPUNIT_ASSERT_EQUAL(8u, this->CountPixels(slice, 1));
+  }
+
+  void Paint_LabelSetImage_ErasesActiveLabelOnly()
+  {
+    auto workingImage = mitk::LabelSetImage::New();
+    workingImage->Initialize(this->CreateSlice(10, 10).GetPointer());
+    auto label = mitk::Label::New();
+    label->SetValue(4);
+    workingImage->GetActiveLabelSet()->AddLabel(label);
+    workingImage->GetActiveLabelSet()->SetActiveLabel(4);
+
+    auto slice = this->CreateSlice(10, 10, 4);
+    {
+      mitk::ImagePixelWriteAccessor<PixelType, 2> writeAccess(slice);
+      writeAccess.GetData()[5 * 10 + 5] = 3;
+    }
+
+    m_Stamp->SetSize(3);
+    m_Stamp->Paint(slice, workingImage, this->Index(5, 5), this->Index(5, 5), workingImage->GetExteriorLabel()->GetValue());
+    CPPUNIT_ASSERT_EQUAL(PixelType(3), this->GetPixel(slice, 5, 5));
+    CPPUNIT_ASSERT_EQUAL(8u, this->CountPixels(slice, 0));
+  }
+
+  void Paint_SimulatedStrokes_DirtyRegionIsBoundingBoxOfStrokes()
+  {
+    for (int size : {5, 25, 100})
+    {
+      auto slice = this->CreateSlice(1024, 1024);
+      m_Stamp->SetSize(size);
+      m_Stamp->ResetDirtyRegion();
+
+      // a half circle with up to 12 pixels between two mouse events
+      auto last = this->Index(812, 512);
+      for (int i = 1; i <= 100; ++i)
+      {
+        const double angle = 0.03 * i;
+        auto position = this->Index(512 + static_cast<int>(300 * std::cos(angle)), 512 + static_cast<int>(300 * std::sin(angle)));
+        m_Stamp->Paint(slice, nullptr, last, position, 1);
+        last = position;
+      }
+
+      int minX = 1024, maxX = -1, minY = 1024, maxY = -1;
+      for (int y = 0; y < 1024; ++y)
+      {
+        for (int x = 0; x < 1024; ++x)
+        {
+          if (this->GetPixel(slice, x, y) == 1)
+          {
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+          }
+        }
+      }
+
+      const auto &dirtyRegion = m_Stamp->GetDirtyRegion();
+      CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(minX), dirtyRegion.GetIndex(0));
+      CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(minY), dirtyRegion.GetIndex(1));
+      CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(maxX), dirtyRegion.GetUpperIndex()[0]);
+      CPPUNIT_ASSERT_EQUAL(mitk::PaintbrushStamp::RegionType::IndexValueType(maxY), dirtyRegion.GetUpperIndex()[1]);
+      CPPUNIT_ASSERT_MESSAGE("The stroke only covers a part of the slice.", dirtyRegion.GetNumberOfPixels() < 1024u * 1024u / 2);
+
+      auto dirtySlice = mitk::PaintbrushStamp::ExtractRegion(slice, dirtyRegion);
+      CPPUNIT_ASSERT_EQUAL(this->CountPixels(slice, 1), this->CountPixels(dirtySlice, 1));
+    }
+  }
+
+  void ExtractRegion_CopiesPixelsAndGeometryOfRegion()
+  {
+    auto slice = this->CreateSlice(20, 10);
+    {
+      mitk::ImagePixelWriteAccessor<PixelType, 2> writeAccess(slice);
+      for (int i = 0; i < 20 * 10; ++i)
+        writeAccess.GetData()[i] = static_cast<PixelType>(i);
+    }
+    mitk::Vector3D spacing;
+    mitk::FillVector3D(spacing, 0.5, 2.0, 1.0);
+    slice->GetGeometry()->SetSpacing(spacing);
+
+    mitk::PaintbrushStamp::RegionType::IndexType index = {{3, 4}};
+    mitk::PaintbrushStamp::RegionType::SizeType size = {{5, 2}};
+    auto regionSlice = mitk::PaintbrushStamp::ExtractRegion(slice, mitk::PaintbrushStamp::RegionType(index, size));
+
+    CPPUNIT_ASSERT_EQUAL(2u, regionSlice->GetDimension());
+    CPPUNIT_ASSERT_EQUAL(5u, regionSlice->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(2u, regionSlice->GetDimension(1));
+    for (int y = 0; y < 2; ++y)
+    {
+      for (int x = 0; x < 5; ++x)
+      {
+        CPPUNIT_ASSERT_EQUAL(this->GetPixel(slice, 3 + x, 4 + y), this->GetPixel(regionSlice, x, y));
+      }
+    }
+
+    // the pixels of the copy are at the world positions of the original pixels
+    mitk::Point3D sliceIndex, sliceWorld, regionWorld;
+    mitk::FillVector3D(sliceIndex, 7, 5, 0);
+    slice->GetGeometry()->IndexToWorld(sliceIndex, sliceWorld);
+    mitk::FillVector3D(sliceIndex, 4, 1, 0);
+    regionSlice->GetGeometry()->IndexToWorld(sliceIndex, regionWorld);
+    CPPUNIT_ASSERT(mitk::Equal(sliceWorld, regionWorld));
+    CPPUNIT_ASSERT(mitk::Equal(slice->GetGeometry()->GetSpacing(), regionSlice->GetGeometry()->GetSpacing()));
+
+    index[0] = 18;
+    CPPUNIT_ASSERT_THROW(mitk::PaintbrushStamp::ExtractRegion(slice, mitk::PaintbrushStamp::RegionType(index, size)), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPaintbrushStamp)
@@ -0,0 +1,135 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkShapeBasedInterpolationAlgorithm.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkMultiThreaderBase.h>
+
+#include <algorithm>
+#include <vector>
+
+class mitkShapeBasedInterpolationAlgorithmTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkShapeBasedInterpolationAlgorithmTestSuite);
+  MITK_TEST(Interpolate_DiscsOfDifferentRadius_InterpolatesRadius);
+  MITK_TEST(Interpolate_Concurrently_EqualsSequentialResults);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int Size = 40;
+
+  mitk::Image::Pointer CreateSlice()
+  {
+    unsigned int dimensions[2] = {Size, Size};
+    auto slice = mitk::Image::New();
+    slice->Initialize(mitk::MakeScalarPixelType<unsigned short>(), 2, dimensions);
+
+    mitk::ImagePixelWriteAccessor<unsigned short, 2> accessor(slice);
+    std::fill(accessor.GetData(), accessor.GetData() + Size * Size, 0);
+    return slice;
+  }
+
+  mitk::Image::Pointer CreateDisc(int radius)
+  {
+    auto slice = this->CreateSlice();
+    mitk::ImagePixelWriteAccessor<unsigned short, 2> accessor(slice);
+
+    for (int y = 0; y < static_cast<int>(Size); ++y)
+      for (int x = 0; x < static_cast<int>(Size); ++x)
+      {
+        if ((x - 20) * (x - 20) + (y - 20) * (y - 20) <= radius * radius)
+        {
+          itk::Index<2> index = {{x, y}};
+          accessor.SetPixelByIndex(index, 1);
+        }
+      }
+
+    return slice;
+  }
+
+  std::vector<unsigned short> GetPixels(mitk::Image *slice)
+  {
+    mitk::ImagePixelReadAccessor<unsigned short, 2> accessor(slice);
+    return std::vector<unsigned short>(accessor.GetData(), accessor.GetData() + Size * Size);
+  }
+
+  unsigned short GetPixel(mitk::Image *slice, int x, int y)
+  {
+    mitk::ImagePixelReadAccessor<unsigned short, 2> accessor(slice);
+    itk::Index<2> index = {{x, y}};
+    return accessor.GetPixelByIndex(index);
+  }
+
+public:
+  void Interpolate_DiscsOfDifferentRadius_InterpolatesRadius()
+  {
+    auto algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+    auto result = algorithm->Interpolate(
+      this->CreateDisc(4), 10, this->CreateDisc(10), 14, 12, 2, this->CreateSlice(), 0, nullptr);
+
+    // the contours lie half a pixel outside of the discs, so the radius in between is 7.5
+    CPPUNIT_ASSERT_EQUAL((unsigned short)1, this->GetPixel(result, 20, 20));
+    CPPUNIT_ASSERT_EQUAL((unsigned short)1, this->GetPixel(result, 27, 20));
+    CPPUNIT_ASSERT_EQUAL((unsigned short)1, this->GetPixel(result, 20, 13));
+    CPPUNIT_ASSERT_EQUAL((unsigned short)0, this->GetPixel(result, 28, 20));
+    CPPUNIT_ASSERT_EQUAL((unsigned short)0, this->GetPixel(result, 20, 12));
+    CPPUNIT_ASSERT_EQUAL((unsigned short)0, this->GetPixel(result, 0, 0));
+
+    // near the segmented slices, the result equals them
+    result = algorithm->Interpolate(
+      this->CreateDisc(4), 10, this->CreateDisc(10), 14, 10, 2, this->CreateSlice(), 0, nullptr);
+    CPPUNIT_ASSERT(this->GetPixels(this->CreateDisc(4)) == this->GetPixels(result));
+  }
+
+  void Interpolate_Concurrently_EqualsSequentialResults()
+  {
+    // several pairs of segmented slices, more than the cache keeps per stripe
+    const unsigned int numberOfPairs = 40;
+    std::vector<mitk::Image::Pointer> discs;
+    for (unsigned int i = 0; i <= numberOfPairs; ++i)
+      discs.push_back(this->CreateDisc(3 + i % 7));
+
+    auto interpolate = [&discs](mitk::ShapeBasedInterpolationAlgorithm *algorithm, unsigned int requestedIndex) {
+      const unsigned int lower = requestedIndex / 4 * 4;
+      auto result = mitk::Image::New();
+      unsigned int dimensions[2] = {Size, Size};
+      result->Initialize(mitk::MakeScalarPixelType<unsigned short>(), 2, dimensions);
+      return algorithm->Interpolate(
+        discs[lower / 4], lower, discs[lower / 4 + 1], lower + 4, requestedIndex, 2, result, 0, nullptr);
+    };
+
+    const unsigned int numberOfSlices = 4 * numberOfPairs;
+    std::vector<std::vector<unsigned short>> expected(numberOfSlices);
+    auto sequentialAlgorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+    for (unsigned int i = 0; i < numberOfSlices; ++i)
+      expected[i] = this->GetPixels(interpolate(sequentialAlgorithm, i));
+
+    std::vector<std::vector<unsigned short>> results(numberOfSlices);
+    auto concurrentAlgorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
+    auto multiThreader = itk::MultiThreaderBase::New();
+    multiThreader->SetNumberOfWorkUnits(8);
+    multiThreader->ParallelizeArray(
+      0,
+      numberOfSlices,
+      [&](itk::SizeValueType i) { results[i] = this->GetPixels(interpolate(concurrentAlgorithm, i)); },
+      nullptr);
+
+    for (unsigned int i = 0; i < numberOfSlices; ++i)
+      CPPUNIT_ASSERT_MESSAGE("Slice " + std::to_string(i), expected[i] == results[i]);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkShapeBasedInterpolationAlgorithm)
@@ -0,0 +1,178 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkSegmentationInterpolationController.h>
+#include <mitkSliceOccupancyIndex.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+
+class mitkSliceOccupancyIndexTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkSliceOccupancyIndexTestSuite);
+  MITK_TEST(AddToSlice_CountsPerLabel);
+  MITK_TEST(FindSegmentedSlice_ReturnsNearestSlices);
+  MITK_TEST(SetSegmentationVolume_IndexesAllLabels);
+  MITK_TEST(SetChangedSlice_MovesCountsBetweenLabels);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Segmentation;
+  mitk::SegmentationInterpolationController::Pointer m_Controller;
+
+  void SetPixel(mitk::Image *image, unsigned int x, unsigned int y, unsigned int z, unsigned short value)
+  {
+    mitk::ImagePixelWriteAccessor<unsigned short, 3> writeAccess(image);
+    itk::Index<3> index;
+    index[0] = x;
+    index[1] = y;
+    index[2] = z;
+    writeAccess.SetPixelByIndex(index, value);
+  }
+
+  mitk::Image::Pointer CreateAxialDiff(const std::vector<std::pair<itk::Index<2>, short>> &differences)
+  {
+    unsigned int dimensions[2] = {m_Segmentation->GetDimension(0), m_Segmentation->GetDimension(1)};
+    auto diff = mitk::Image::New();
+    diff->Initialize(mitk::MakeScalarPixelType<short>(), 2, dimensions);
+    mitk::ImagePixelWriteAccessor<short, 2> writeAccess(diff);
+    std::fill(writeAccess.GetData(), writeAccess.GetData() + dimensions[0] * dimensions[1], 0);
+    for (const auto &difference : differences)
+      writeAccess.SetPixelByIndex(difference.first, difference.second);
+    return diff;
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[3] = {8, 9, 10};
+    m_Segmentation = mitk::Image::New();
+    m_Segmentation->Initialize(mitk::MakeScalarPixelType<unsigned short>(), 3, dimensions);
+    mitk::ImagePixelWriteAccessor<unsigned short, 3> writeAccess(m_Segmentation);
+    std::fill(writeAccess.GetData(), writeAccess.GetData() + 8 * 9 * 10, 0);
+
+    m_Controller = mitk::SegmentationInterpolationController::New();
+  }
+
+  void tearDown() override
+  {
+    m_Controller = nullptr;
+    m_Segmentation = nullptr;
+  }
+
+  void AddToSlice_CountsPerLabel()
+  {
+    mitk::SliceOccupancyIndex index;
+    index.Initialize(2);
+    CPPUNIT_ASSERT_EQUAL(2u, index.GetNumberOfTimeSteps());
+
+    index.AddToSlice(1, 2, 4, 1, 10);
+    index.AddToSlice(1, 2, 4, 3, 5);
+    index.AddToSlice(1, 2, 4, 0, 7); // background is not counted
+    CPPUNIT_ASSERT_EQUAL(15ull, index.GetCount(1, 2, 4));
+    CPPUNIT_ASSERT_EQUAL(10ull, index.GetCount(1, 2, 4, 1));
+    CPPUNIT_ASSERT_EQUAL(5ull, index.GetCount(1, 2, 4, 3));
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(0, 2, 4));
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(1, 1, 4));
+    CPPUNIT_ASSERT(std::vector<double>({1, 3}) == index.GetLabels(1));
+
+    index.AddToSlice(1, 2, 4, 3, -5);
+    CPPUNIT_ASSERT_EQUAL(10ull, index.GetCount(1, 2, 4));
+    CPPUNIT_ASSERT(std::vector<double>({1}) == index.GetLabels(1));
+
+    index.Initialize(2);
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(1, 2, 4));
+  }
+
+  void FindSegmentedSlice_ReturnsNearestSlices()
+  {
+    mitk::SliceOccupancyIndex index;
+    index.Initialize(1);
+    index.AddToSlice(0, 0, 2, 1, 1);
+    index.AddToSlice(0, 0, 9, 2, 1);
+    index.AddToSlice(0, 0, 30, 1, 1);
+
+    unsigned int slice = 0;
+    CPPUNIT_ASSERT(index.FindSegmentedSliceBelow(0, 0, 9, slice));
+    CPPUNIT_ASSERT_EQUAL(2u, slice);
+    CPPUNIT_ASSERT(index.FindSegmentedSliceAbove(0, 0, 9, slice));
+    CPPUNIT_ASSERT_EQUAL(30u, slice);
+    CPPUNIT_ASSERT(index.FindSegmentedSliceAbove(0, 0, 5, slice));
+    CPPUNIT_ASSERT_EQUAL(9u, slice);
+    CPPUNIT_ASSERT(!index.FindSegmentedSliceBelow(0, 0, 2, slice));
+    CPPUNIT_ASSERT(!index.FindSegmentedSliceAbove(0, 0, 30, slice));
+
+    // per label
+    CPPUNIT_ASSERT(index.FindSegmentedSliceAbove(0, 0, 5, 1, slice));
+    CPPUNIT_ASSERT_EQUAL(30u, slice);
+    CPPUNIT_ASSERT(!index.FindSegmentedSliceBelow(0, 0, 9, 2, slice));
+    CPPUNIT_ASSERT(!index.FindSegmentedSliceAbove(0, 0, 5, 7, slice));
+  }
+
+  void SetSegmentationVolume_IndexesAllLabels()
+  {
+    this->SetPixel(m_Segmentation, 1, 2, 3, 1);
+    this->SetPixel(m_Segmentation, 2, 2, 3, 1);
+    this->SetPixel(m_Segmentation, 5, 6, 8, 4);
+
+    m_Controller->SetSegmentationVolume(m_Segmentation);
+    const auto &index = m_Controller->GetSliceOccupancyIndex();
+
+    CPPUNIT_ASSERT_EQUAL(1u, index.GetNumberOfTimeSteps());
+    CPPUNIT_ASSERT(std::vector<double>({1, 4}) == index.GetLabels(0));
+    CPPUNIT_ASSERT_EQUAL(2ull, index.GetCount(0, 2, 3, 1));
+    CPPUNIT_ASSERT_EQUAL(2ull, index.GetCount(0, 1, 2, 1));
+    CPPUNIT_ASSERT_EQUAL(1ull, index.GetCount(0, 0, 1, 1));
+    CPPUNIT_ASSERT_EQUAL(1ull, index.GetCount(0, 0, 2, 1));
+    CPPUNIT_ASSERT_EQUAL(1ull, index.GetCount(0, 2, 8, 4));
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(0, 2, 8, 1));
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(0, 2, 4));
+
+    unsigned int slice = 0;
+    CPPUNIT_ASSERT(index.FindSegmentedSliceBelow(0, 2, 6, slice));
+    CPPUNIT_ASSERT_EQUAL(3u, slice);
+    CPPUNIT_ASSERT(index.FindSegmentedSliceAbove(0, 2, 6, slice));
+    CPPUNIT_ASSERT_EQUAL(8u, slice);
+  }
+
+  void SetChangedSlice_MovesCountsBetweenLabels()
+  {
+    this->SetPixel(m_Segmentation, 5, 6, 8, 4);
+    m_Controller->SetSegmentationVolume(m_Segmentation);
+
+    // paint label 1 in slice 5 and overwrite the label 4 pixel of slice 8 with label 1
+    this->SetPixel(m_Segmentation, 0, 0, 5, 1);
+    this->SetPixel(m_Segmentation, 1, 0, 5, 1);
+    m_Controller->SetChangedSlice(this->CreateAxialDiff({{{{0, 0}}, 1}, {{{1, 0}}, 1}}), 2, 5, 0);
+
+    this->SetPixel(m_Segmentation, 5, 6, 8, 1);
+    m_Controller->SetChangedSlice(this->CreateAxialDiff({{{{5, 6}}, -3}}), 2, 8, 0);
+
+    const auto &index = m_Controller->GetSliceOccupancyIndex();
+    CPPUNIT_ASSERT(std::vector<double>({1}) == index.GetLabels(0));
+    CPPUNIT_ASSERT_EQUAL(2ull, index.GetCount(0, 2, 5, 1));
+    CPPUNIT_ASSERT_EQUAL(1ull, index.GetCount(0, 2, 8, 1));
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(0, 2, 8, 4));
+    CPPUNIT_ASSERT_EQUAL(3ull, index.GetCount(0, 1, 0) + index.GetCount(0, 1, 6));
+
+    // erase the pixels of slice 5 again
+    this->SetPixel(m_Segmentation, 0, 0, 5, 0);
+    this->SetPixel(m_Segmentation, 1, 0, 5, 0);
+    m_Controller->SetChangedSlice(this->CreateAxialDiff({{{{0, 0}}, -1}, {{{1, 0}}, -1}}), 2, 5, 0);
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(0, 2, 5));
+    CPPUNIT_ASSERT_EQUAL(0ull, index.GetCount(0, 0, 0));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkSliceOccupancyIndex)
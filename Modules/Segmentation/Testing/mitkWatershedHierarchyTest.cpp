@@ -0,0 +1,197 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkLabel.h>
+#include <mitkStdFunctionCommand.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+#include <mitkWatershedHierarchy.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+class mitkWatershedHierarchyTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkWatershedHierarchyTestSuite);
+  MITK_TEST(GetSegmentation_ThreeBasins_LevelAndThresholdMergeBasins);
+  MITK_TEST(Initialize_DifferentTileSizes_EqualBasins);
+  MITK_TEST(Initialize_ReportsProgressAndSize);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int SizeX = 30;
+  static const unsigned int SizeY = 24;
+  static const unsigned int SizeZ = 40;
+
+  /** Three cones with their tips at the given centers and depths. */
+  mitk::Image::Pointer CreateThreeBasins()
+  {
+    unsigned int dimensions[3] = {SizeX, SizeY, SizeZ};
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+
+    mitk::ImagePixelWriteAccessor<float, 3> accessor(image);
+    itk::Index<3> index;
+
+    for (index[2] = 0; index[2] < static_cast<int>(SizeZ); ++index[2])
+      for (index[1] = 0; index[1] < static_cast<int>(SizeY); ++index[1])
+        for (index[0] = 0; index[0] < static_cast<int>(SizeX); ++index[0])
+        {
+          float value = std::numeric_limits<float>::max();
+
+          for (int i = 0; i < 3; ++i)
+          {
+            const double dx = index[0] - m_Centers[i][0];
+            const double dy = index[1] - m_Centers[i][1];
+            const double dz = index[2] - m_Centers[i][2];
+            value = std::min(value, static_cast<float>(std::sqrt(dx * dx + dy * dy + dz * dz) + m_Depths[i]));
+          }
+
+          accessor.SetPixelByIndex(index, value);
+        }
+
+    return image;
+  }
+
+  /** Noise with few different values, so that there are many flat regions. */
+  mitk::Image::Pointer CreateNoise(unsigned int seed)
+  {
+    unsigned int dimensions[3] = {SizeX, SizeY, SizeZ};
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> distribution(0, 3);
+
+    mitk::ImagePixelWriteAccessor<float, 3> accessor(image);
+    std::generate(accessor.GetData(), accessor.GetData() + SizeX * SizeY * SizeZ, [&]() {
+      return static_cast<float>(distribution(generator));
+    });
+
+    return image;
+  }
+
+  std::vector<mitk::Label::PixelType> GetLabels(mitk::Image *segmentation)
+  {
+    mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(segmentation);
+    return std::vector<mitk::Label::PixelType>(accessor.GetData(), accessor.GetData() + SizeX * SizeY * SizeZ);
+  }
+
+  std::vector<mitk::Label::PixelType> GetLabelsOfCenters(mitk::Image *segmentation)
+  {
+    mitk::ImagePixelReadAccessor<mitk::Label::PixelType, 3> accessor(segmentation);
+    std::vector<mitk::Label::PixelType> labels;
+
+    for (int i = 0; i < 3; ++i)
+    {
+      itk::Index<3> index = {{m_Centers[i][0], m_Centers[i][1], m_Centers[i][2]}};
+      labels.push_back(accessor.GetPixelByIndex(index));
+    }
+
+    return labels;
+  }
+
+  std::size_t GetNumberOfRegions(mitk::Image *segmentation)
+  {
+    const auto labels = this->GetLabels(segmentation);
+    return std::set<mitk::Label::PixelType>(labels.begin(), labels.end()).size();
+  }
+
+  const int m_Centers[3][3] = {{7, 8, 8}, {22, 12, 20}, {10, 16, 32}};
+  const float m_Depths[3] = {0.0f, 2.0f, 4.0f};
+
+public:
+  void GetSegmentation_ThreeBasins_LevelAndThresholdMergeBasins()
+  {
+    auto hierarchy = mitk::WatershedHierarchy::New();
+    hierarchy->SetTileSize(4);
+    hierarchy->Initialize(this->CreateThreeBasins());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), hierarchy->GetNumberOfBasins());
+
+    auto segmentation = hierarchy->GetSegmentation(0.0, 0.0);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), this->GetNumberOfRegions(segmentation));
+
+    auto labels = this->GetLabelsOfCenters(segmentation);
+    CPPUNIT_ASSERT(labels[0] != labels[1] && labels[1] != labels[2] && labels[0] != labels[2]);
+
+    // the passes lie less than a third of the maximum depth above the shallower basins
+    segmentation = hierarchy->GetSegmentation(0.0, 0.1);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), this->GetNumberOfRegions(segmentation));
+
+    segmentation = hierarchy->GetSegmentation(0.0, 0.5);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), this->GetNumberOfRegions(segmentation));
+
+    // the same hierarchy answers threshold queries, everything below the threshold is flat
+    segmentation = hierarchy->GetSegmentation(0.9, 0.0);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), this->GetNumberOfRegions(segmentation));
+
+    segmentation = hierarchy->GetSegmentation(0.0, 0.0);
+    CPPUNIT_ASSERT(labels == this->GetLabelsOfCenters(segmentation));
+  }
+
+  void Initialize_DifferentTileSizes_EqualBasins()
+  {
+    for (unsigned int seed = 0; seed < 3; ++seed)
+    {
+      auto image = this->CreateNoise(seed);
+
+      auto inOnePiece = mitk::WatershedHierarchy::New();
+      inOnePiece->SetTileSize(0);
+      inOnePiece->Initialize(image);
+
+      auto inTiles = mitk::WatershedHierarchy::New();
+      inTiles->SetTileSize(3);
+      inTiles->Initialize(image);
+
+      CPPUNIT_ASSERT(inOnePiece->GetNumberOfBasins() > 1);
+      CPPUNIT_ASSERT_EQUAL(inOnePiece->GetNumberOfBasins(), inTiles->GetNumberOfBasins());
+
+      for (double level : {0.0, 0.3})
+      {
+        CPPUNIT_ASSERT(this->GetLabels(inOnePiece->GetSegmentation(0.0, level)) ==
+                       this->GetLabels(inTiles->GetSegmentation(0.0, level)));
+      }
+    }
+  }
+
+  void Initialize_ReportsProgressAndSize()
+  {
+    auto hierarchy = mitk::WatershedHierarchy::New();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(0), hierarchy->GetSize());
+
+    std::vector<float> progress;
+    auto command = mitk::StdFunctionCommand::New();
+    command->SetCommandFilter([](const itk::EventObject &event) { return itk::ProgressEvent().CheckEvent(&event); });
+    command->SetCommandAction([&](const itk::EventObject &) { progress.push_back(hierarchy->GetProgress()); });
+    hierarchy->AddObserver(itk::ProgressEvent(), command);
+
+    hierarchy->Initialize(this->CreateThreeBasins());
+
+    CPPUNIT_ASSERT(progress.size() > 2);
+    CPPUNIT_ASSERT_EQUAL(0.0f, progress.front());
+    CPPUNIT_ASSERT_EQUAL(1.0f, progress.back());
+    CPPUNIT_ASSERT(std::is_sorted(progress.begin(), progress.end()));
+
+    // one basin id per voxel and the two merges of the three basins
+    const auto expectedSize = SizeX * SizeY * SizeZ * sizeof(mitk::WatershedHierarchy::BasinIdType);
+    CPPUNIT_ASSERT(hierarchy->GetSize() >= expectedSize);
+    CPPUNIT_ASSERT(hierarchy->GetSize() <= expectedSize + 2 * 16);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkWatershedHierarchy)
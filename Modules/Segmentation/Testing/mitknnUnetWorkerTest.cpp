@@ -0,0 +1,313 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkIOUtil.h>
+#include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+#include <mitknnUnetWorker.h>
+
+#include <itksys/Directory.hxx>
+#include <itksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+  /**
+   * Serves the requests of a session directory like the python worker, but without nnUNet: the "segmentation"
+   * is a copy of the first modality (uint8 only). The task "fail" reports an error, requests of the task "hold"
+   * are kept until they are cancelled.
+   */
+  class StubWorker
+  {
+  public:
+    explicit StubWorker(const std::string &sessionDirectory)
+      : m_SessionDirectory(sessionDirectory), m_Stop(false), m_Thread(&StubWorker::Serve, this)
+    {
+    }
+
+    ~StubWorker()
+    {
+      m_Stop = true;
+      m_Thread.join();
+    }
+
+    std::vector<std::string> GetProcessedRequests() const
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      return m_ProcessedRequests;
+    }
+
+    bool HasRequestFiles() const
+    {
+      itksys::Directory directory;
+      directory.Load(m_SessionDirectory);
+      for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+      {
+        if (itksys::SystemTools::FileExists(m_SessionDirectory + "/" + directory.GetFile(i), true))
+          return true;
+      }
+      return false;
+    }
+
+  private:
+    std::map<std::string, std::string> ReadRequest(const std::string &path) const
+    {
+      std::map<std::string, std::string> request;
+      std::ifstream stream(path);
+      std::string line;
+      while (std::getline(stream, line))
+      {
+        auto separator = line.find('=');
+        request[line.substr(0, separator)] = line.substr(separator + 1);
+      }
+      return request;
+    }
+
+    void RemoveRequestFiles(const std::string &id) const
+    {
+      itksys::Directory directory;
+      directory.Load(m_SessionDirectory);
+      for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+      {
+        std::string file = directory.GetFile(i);
+        if (file.compare(0, id.size(), id) == 0)
+          itksys::SystemTools::RemoveFile(m_SessionDirectory + "/" + file);
+      }
+    }
+
+    void WriteDone(const std::string &id, const std::string &status) const
+    {
+      const std::string path = m_SessionDirectory + "/" + id + ".done";
+      std::ofstream(path + ".tmp") << status << "\n";
+      itksys::SystemTools::RenameFile(path + ".tmp", path);
+    }
+
+    void Serve()
+    {
+      while (!m_Stop)
+      {
+        itksys::Directory directory;
+        directory.Load(m_SessionDirectory);
+        std::vector<std::string> requests;
+        for (unsigned long i = 0; i < directory.GetNumberOfFiles(); ++i)
+        {
+          std::string file = directory.GetFile(i);
+          if (itksys::SystemTools::GetFilenameLastExtension(file) == ".cancel")
+          {
+            this->RemoveRequestFiles(itksys::SystemTools::GetFilenameWithoutLastExtension(file));
+          }
+          else if (itksys::SystemTools::GetFilenameLastExtension(file) == ".request")
+          {
+            requests.push_back(itksys::SystemTools::GetFilenameWithoutLastExtension(file));
+          }
+        }
+        std::sort(requests.begin(), requests.end());
+
+        for (const auto &id : requests)
+        {
+          auto request = this->ReadRequest(m_SessionDirectory + "/" + id + ".request");
+          if (request["task"] == "hold")
+            continue;
+
+          itksys::SystemTools::RemoveFile(m_SessionDirectory + "/" + id + ".request");
+          {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ProcessedRequests.push_back(id);
+          }
+
+          if (request["task"] == "fail" || request["pixel_type"] != "uint8")
+          {
+            this->WriteDone(id, "error: unsupported request");
+            continue;
+          }
+
+          std::ifstream input(m_SessionDirectory + "/" + id + "_0000.raw", std::ios::binary);
+          std::vector<char> buffer((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+          std::vector<unsigned short> segmentation(buffer.begin(), buffer.end());
+          std::ofstream output(m_SessionDirectory + "/" + id + "_seg.raw", std::ios::binary);
+          output.write(reinterpret_cast<const char *>(segmentation.data()), segmentation.size() * sizeof(unsigned short));
+          output.close();
+          this->WriteDone(id, "ok");
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    }
+
+    std::string m_SessionDirectory;
+    std::atomic<bool> m_Stop;
+    mutable std::mutex m_Mutex;
+    std::vector<std::string> m_ProcessedRequests;
+    std::thread m_Thread;
+  };
+}
+
+class mitknnUnetWorkerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitknnUnetWorkerTestSuite);
+  MITK_TEST(Predict_NotStarted_Throws);
+  MITK_TEST(Predict_ReturnsSegmentationOfWorker);
+  MITK_TEST(Predict_ConcurrentRequests_ProcessedInOrder);
+  MITK_TEST(Predict_WorkerError_Throws);
+  MITK_TEST(CancelPendingRequests_PredictReturnsNullptr);
+  MITK_TEST(Predict_Timeout_Throws);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string m_SessionDirectory;
+  mitk::nnUNetWorker::Pointer m_Worker;
+  std::unique_ptr<StubWorker> m_StubWorker;
+
+  mitk::Image::Pointer CreateImage(unsigned char offset)
+  {
+    unsigned int dimensions[3] = {4, 3, 2};
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+    mitk::ImagePixelWriteAccessor<unsigned char, 3> writeAccess(image);
+    for (unsigned int i = 0; i < 24; ++i)
+    {
+      writeAccess.GetData()[i] = static_cast<unsigned char>(offset + i);
+    }
+    return image;
+  }
+
+  mitk::nnUNetWorker::Request CreateRequest(const std::string &task, unsigned char offset)
+  {
+    mitk::nnUNetWorker::Request request;
+    request.Modalities.push_back(this->CreateImage(offset).GetPointer());
+    request.Model.task = task;
+    request.Model.model = "3d_fullres";
+    request.Model.folds = {"0", "1"};
+    return request;
+  }
+
+  bool EqualsInput(const mitk::Image *segmentation, unsigned char offset)
+  {
+    mitk::ImagePixelReadAccessor<unsigned short, 3> readAccess(segmentation);
+    for (unsigned int i = 0; i < 24; ++i)
+    {
+      if (readAccess.GetData()[i] != offset + i)
+        return false;
+    }
+    return true;
+  }
+
+public:
+  void setUp() override
+  {
+    m_SessionDirectory = mitk::IOUtil::CreateTemporaryDirectory("nnunet-test-XXXXXX");
+    m_Worker = mitk::nnUNetWorker::New();
+    m_Worker->SetSessionDirectory(m_SessionDirectory);
+  }
+
+  void tearDown() override
+  {
+    m_StubWorker.reset();
+    m_Worker = nullptr;
+    itksys::SystemTools::RemoveADirectory(m_SessionDirectory);
+  }
+
+  void StartStubWorker()
+  {
+    m_Worker->Start("", mitk::nnUNetWorker::ArgumentListType());
+    m_StubWorker.reset(new StubWorker(m_SessionDirectory));
+  }
+
+  void Predict_NotStarted_Throws()
+  {
+    CPPUNIT_ASSERT(!m_Worker->IsRunning());
+    CPPUNIT_ASSERT_THROW(m_Worker->Predict(this->CreateRequest("copy", 0)), mitk::Exception);
+  }
+
+  void Predict_ReturnsSegmentationOfWorker()
+  {
+    this->StartStubWorker();
+    CPPUNIT_ASSERT(m_Worker->IsRunning());
+
+    auto request = this->CreateRequest("copy", 10);
+    auto segmentation = m_Worker->Predict(request);
+    CPPUNIT_ASSERT(segmentation.IsNotNull());
+    CPPUNIT_ASSERT(this->EqualsInput(segmentation, 10));
+    CPPUNIT_ASSERT(mitk::Equal(*(segmentation->GetGeometry()), *(request.Modalities.front()->GetGeometry()), mitk::eps, true));
+    CPPUNIT_ASSERT_MESSAGE("Files of finished requests are removed.", !m_StubWorker->HasRequestFiles());
+
+    // the worker is reused for further requests
+    CPPUNIT_ASSERT(this->EqualsInput(m_Worker->Predict(this->CreateRequest("copy", 20)), 20));
+  }
+
+  void Predict_ConcurrentRequests_ProcessedInOrder()
+  {
+    this->StartStubWorker();
+
+    std::vector<std::future<mitk::Image::Pointer>> results;
+    for (unsigned char i = 0; i < 4; ++i)
+    {
+      auto request = this->CreateRequest("copy", 30 * i);
+      results.push_back(std::async(std::launch::async, [this, request]() { return m_Worker->Predict(request); }));
+    }
+    for (unsigned char i = 0; i < 4; ++i)
+    {
+      CPPUNIT_ASSERT(this->EqualsInput(results[i].get(), 30 * i));
+    }
+
+    auto processedRequests = m_StubWorker->GetProcessedRequests();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), processedRequests.size());
+    CPPUNIT_ASSERT(std::is_sorted(processedRequests.begin(), processedRequests.end()));
+  }
+
+  void Predict_WorkerError_Throws()
+  {
+    this->StartStubWorker();
+    CPPUNIT_ASSERT_THROW(m_Worker->Predict(this->CreateRequest("fail", 0)), mitk::Exception);
+    CPPUNIT_ASSERT(!m_StubWorker->HasRequestFiles());
+  }
+
+  void CancelPendingRequests_PredictReturnsNullptr()
+  {
+    this->StartStubWorker();
+
+    auto request = this->CreateRequest("hold", 0);
+    auto result = std::async(std::launch::async, [this, request]() { return m_Worker->Predict(request); });
+    while (!m_StubWorker->HasRequestFiles())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    m_Worker->CancelPendingRequests();
+    CPPUNIT_ASSERT(result.get().IsNull());
+
+    // the worker removes the files of the cancelled request
+    while (m_StubWorker->HasRequestFiles())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // later requests are not affected
+    CPPUNIT_ASSERT(this->EqualsInput(m_Worker->Predict(this->CreateRequest("copy", 5)), 5));
+  }
+
+  void Predict_Timeout_Throws()
+  {
+    this->StartStubWorker();
+    m_Worker->SetTimeout(0.05);
+    CPPUNIT_ASSERT_THROW(m_Worker->Predict(this->CreateRequest("hold", 0)), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitknnUnetWorker)
@@ -1,4 +1,5 @@
 set(CPP_FILES
+  Algorithms/mitkBlockwiseSurfaceGenerator.cpp
   Algorithms/mitkCalculateSegmentationVolume.cpp
   Algorithms/mitkContourModelSetToImageFilter.cpp
   Algorithms/mitkContourSetToPointSetFilter.cpp
@@ -13,13 +14,17 @@ set(CPP_FILES
   #Algorithms/mitkImageToContourModelFilter.cpp
   Algorithms/mitkImageToLiveWireContourFilter.cpp
   Algorithms/mitkManualSegmentationToSurfaceFilter.cpp
+  Algorithms/mitkOtsuHistogram.cpp
   Algorithms/mitkOtsuSegmentationFilter.cpp
+  Algorithms/mitkPaintbrushStamp.cpp
   Algorithms/mitkSegmentationObjectFactory.cpp
   Algorithms/mitkShapeBasedInterpolationAlgorithm.cpp
   Algorithms/mitkShowSegmentationAsSmoothedSurface.cpp
   Algorithms/mitkShowSegmentationAsSurface.cpp
   Algorithms/mitkVtkImageOverwrite.cpp
+  Algorithms/mitkWatershedHierarchy.cpp
   Controllers/mitkSegmentationInterpolationController.cpp
+  Controllers/mitkSliceOccupancyIndex.cpp
   Controllers/mitkToolManager.cpp
   Controllers/mitkSegmentationModuleActivator.cpp
   Controllers/mitkToolManagerProvider.cpp
@@ -63,6 +68,7 @@ set(CPP_FILES
   Interactions/mitkWatershedTool.cpp
   Interactions/mitkPickingTool.cpp
   Interactions/mitknnUnetTool.cpp
+  Interactions/mitknnUnetWorker.cpp
   Interactions/mitkSegmentationInteractor.cpp #SO
   Interactions/mitkProcessExecutor.cpp
   Rendering/mitkContourMapper2D.cpp
@@ -103,6 +109,7 @@ set(RESOURCE_FILES
   Watershed_Cursor_32x32.png
   Wipe_48x48.png
   Wipe_Cursor_32x32.png
+  nnUNetWorker.py
 
   Interactions/dummy.xml
   Interactions/LiveWireTool.xml
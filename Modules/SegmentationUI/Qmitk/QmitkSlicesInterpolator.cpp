@@ -40,6 +40,7 @@ found in the LICENSE file.
 #include <mitkShapeBasedInterpolationAlgorithm.h>
 
 #include <itkCommand.h>
+#include <itkMultiThreaderBase.h>
 
 #include <QCheckBox>
 #include <QCursor>
@@ -53,7 +54,6 @@ found in the LICENSE file.
 
 #include <array>
 #include <atomic>
-#include <thread>
 #include <vector>
 
 namespace
@@ -773,70 +773,57 @@ void QmitkSlicesInterpolator::AcceptAllInterpolations(mitk::SliceNavigationContr
     const auto numSlices = m_Segmentation->GetDimension(sliceDimension);
     mitk::ProgressBar::GetInstance()->AddStepsToDo(numSlices);
 
-    std::atomic_uint totalChangedSlices;
+    std::atomic_uint totalChangedSlices(0);
 
     // Reuse interpolation algorithm instance for each slice to cache boundary calculations
     auto algorithm = mitk::ShapeBasedInterpolationAlgorithm::New();
 
-    // Distribute slice interpolations to multiple threads
-    const auto numThreads = std::min(std::thread::hardware_concurrency(), numSlices);
-    std::vector<std::vector<unsigned int>> sliceIndices(numThreads);
-
-    for (std::remove_const_t<decltype(numSlices)> sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
-      sliceIndices[sliceIndex % numThreads].push_back(sliceIndex);
-
-    std::vector<std::thread> threads;
-    threads.reserve(numThreads);
-
-    // This lambda will be executed by the threads
-    auto interpolate = [=, &interpolator = m_Interpolator, &totalChangedSlices](unsigned int threadIndex)
+    // This lambda will be executed by the threads of the pool
+    auto interpolate = [=, &interpolator = m_Interpolator, &totalChangedSlices](itk::SizeValueType sliceIndex)
     {
       auto clonedPlaneGeometry = planeGeometry->Clone();
       auto origin = clonedPlaneGeometry->GetOrigin();
 
-      for (auto sliceIndex : sliceIndices[threadIndex])
-      {
-        slicedGeometry->WorldToIndex(origin, origin);
-        origin[sliceDimension] = sliceIndex;
-        slicedGeometry->IndexToWorld(origin, origin);
-        clonedPlaneGeometry->SetOrigin(origin);
-
-        auto interpolation = interpolator->Interpolate(sliceDimension, sliceIndex, clonedPlaneGeometry, timeStep, algorithm);
+      slicedGeometry->WorldToIndex(origin, origin);
+      origin[sliceDimension] = sliceIndex;
+      slicedGeometry->IndexToWorld(origin, origin);
+      clonedPlaneGeometry->SetOrigin(origin);
 
-        if (interpolation.IsNotNull())
-        {
-          // Setting up the reslicing pipeline which allows us to write the interpolation results back into the image volume
-          auto reslicer = vtkSmartPointer<mitkVtkImageOverwrite>::New();
+      auto interpolation = interpolator->Interpolate(sliceDimension, sliceIndex, clonedPlaneGeometry, timeStep, algorithm);
 
-          // Set overwrite mode to true to write back to the image volume
-          reslicer->SetInputSlice(interpolation->GetSliceData()->GetVtkImageAccessor(interpolation)->GetVtkImageData());
-          reslicer->SetOverwriteMode(true);
-          reslicer->Modified();
+      if (interpolation.IsNotNull())
+      {
+        // Setting up the reslicing pipeline which allows us to write the interpolation results back into the image volume
+        auto reslicer = vtkSmartPointer<mitkVtkImageOverwrite>::New();
 
-          auto diffSliceWriter = mitk::ExtractSliceFilter::New(reslicer);
+        // Set overwrite mode to true to write back to the image volume
+        reslicer->SetInputSlice(interpolation->GetSliceData()->GetVtkImageAccessor(interpolation)->GetVtkImageData());
+        reslicer->SetOverwriteMode(true);
+        reslicer->Modified();
 
-          diffSliceWriter->SetInput(diffImage);
-          diffSliceWriter->SetTimeStep(0);
-          diffSliceWriter->SetWorldGeometry(clonedPlaneGeometry);
-          diffSliceWriter->SetVtkOutputRequest(true);
-          diffSliceWriter->SetResliceTransformByGeometry(diffImage->GetTimeGeometry()->GetGeometryForTimeStep(0));
-          diffSliceWriter->Modified();
-          diffSliceWriter->Update();
+        auto diffSliceWriter = mitk::ExtractSliceFilter::New(reslicer);
 
-          ++totalChangedSlices;
-        }
+        diffSliceWriter->SetInput(diffImage);
+        diffSliceWriter->SetTimeStep(0);
+        diffSliceWriter->SetWorldGeometry(clonedPlaneGeometry);
+        diffSliceWriter->SetVtkOutputRequest(true);
+        diffSliceWriter->SetResliceTransformByGeometry(diffImage->GetTimeGeometry()->GetGeometryForTimeStep(0));
+        diffSliceWriter->Modified();
+        diffSliceWriter->Update();
 
-        mitk::ProgressBar::GetInstance()->Progress();
+        ++totalChangedSlices;
       }
+
+      mitk::ProgressBar::GetInstance()->Progress();
     };
 
     m_Interpolator->EnableSliceImageCache();
 
-    for (std::remove_const_t<decltype(numThreads)> threadIndex = 0; threadIndex < numThreads; ++threadIndex)
-      threads.emplace_back(interpolate, threadIndex); // Run the interpolation
-
-    for (auto& thread : threads)
-      thread.join();
+    // Each work unit interpolates a contiguous range of slices, so the slices of a range mostly share
+    // their neighboring segmented slices and the distance maps cached by the algorithm
+    auto multiThreader = itk::MultiThreaderBase::New();
+    multiThreader->SetNumberOfWorkUnits(std::min(numSlices, 4 * itk::MultiThreaderBase::GetGlobalDefaultNumberOfThreads()));
+    multiThreader->ParallelizeArray(0, numSlices, interpolate, nullptr);
 
     m_Interpolator->DisableSliceImageCache();
 
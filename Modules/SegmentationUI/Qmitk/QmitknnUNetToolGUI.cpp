@@ -42,6 +42,12 @@ void QmitknnUNetToolGUI::ConnectNewTool(mitk::AutoSegmentationWithPreviewTool *n
 {
   Superclass::ConnectNewTool(newTool);
   newTool->IsTimePointChangeAwareOff();
+  auto *nnUNetTool = dynamic_cast<mitk::nnUNetTool *>(newTool);
+  if (nullptr != nnUNetTool)
+  {
+    // keeps the stop button responsive while the prediction waits for the persistent worker
+    nnUNetTool->SetWaitCallback([]() { qApp->processEvents(); });
+  }
 }
 
 void QmitknnUNetToolGUI::InitializeUI(QBoxLayout *mainLayout)
@@ -65,6 +71,7 @@ void QmitknnUNetToolGUI::InitializeUI(QBoxLayout *mainLayout)
     m_Controls.plannerBox, SIGNAL(currentTextChanged(const QString &)), this, SLOT(OnTrainerChanged(const QString &)));
   connect(m_Controls.nopipBox, SIGNAL(stateChanged(int)), this, SLOT(OnCheckBoxChanged(int)));
   connect(m_Controls.multiModalBox, SIGNAL(stateChanged(int)), this, SLOT(OnCheckBoxChanged(int)));
+  connect(m_Controls.useWorkerBox, SIGNAL(stateChanged(int)), this, SLOT(OnCheckBoxChanged(int)));
   connect(m_Controls.multiModalSpinBox, SIGNAL(valueChanged(int)), this, SLOT(OnModalitiesNumberChanged(int)));
   connect(m_Controls.pythonEnvComboBox,
 #if QT_VERSION >= 0x050F00 // 5.15
@@ -76,6 +83,7 @@ void QmitknnUNetToolGUI::InitializeUI(QBoxLayout *mainLayout)
           SLOT(OnPythonPathChanged(const QString &)));
   connect(m_Controls.refreshdirectoryBox, SIGNAL(clicked()), this, SLOT(OnRefreshPresssed()));
   connect(m_Controls.clearCacheButton, SIGNAL(clicked()), this, SLOT(OnClearCachePressed()));
+  connect(m_Controls.stopButton, SIGNAL(clicked()), this, SLOT(OnStopPressed()));
 
   m_Controls.codedirectoryBox->setVisible(false);
   m_Controls.nnUnetdirLabel->setVisible(false);
@@ -83,7 +91,8 @@ void QmitknnUNetToolGUI::InitializeUI(QBoxLayout *mainLayout)
   m_Controls.multiModalSpinLabel->setVisible(false);
   m_Controls.previewButton->setEnabled(false);
 
-  m_Controls.stopButton->setVisible(false); // Hidden for future
+  m_Controls.stopButton->setVisible(false); // Only predictions of the persistent worker can be stopped.
+  m_Controls.stopButton->setEnabled(false);
 
   QIcon refreshIcon =
     QmitkStyleManager::ThemeIcon(QStringLiteral(":/org_mitk_icons/icons/awesome/scalable/actions/view-refresh.svg"));
@@ -168,6 +177,7 @@ void QmitknnUNetToolGUI::OnPreviewRequested()
       tool->SetMirror(m_Controls.mirrorBox->isChecked());
       tool->SetMixedPrecision(m_Controls.mixedPrecisionBox->isChecked());
       tool->SetNoPip(isNoPip);
+      tool->SetUseWorker(m_Controls.useWorkerBox->isChecked());
       bool doCache = m_Controls.enableCachingCheckBox->isChecked();
       // Spinboxes
       tool->SetGpuId(FetchSelectedGPUFromUI());
@@ -196,10 +206,20 @@ void QmitknnUNetToolGUI::OnPreviewRequested()
       {
         tool->m_InputBuffer = nullptr;
         WriteStatusMessage(QString("<b>STATUS: </b><i>Starting Segmentation task... This might take a while.</i>"));
+        m_PredictionCancelled = false;
+        m_Controls.stopButton->setEnabled(true);
         tool->UpdatePreview();
+        m_Controls.stopButton->setEnabled(false);
         if (nullptr == tool->GetOutputBuffer())
         {
-          SegmentationProcessFailed();
+          if (m_PredictionCancelled)
+          {
+            WriteStatusMessage(QString("<b>STATUS: </b><i>Segmentation task stopped.</i>"));
+          }
+          else
+          {
+            SegmentationProcessFailed();
+          }
         }
         else
         {
@@ -231,6 +251,7 @@ void QmitknnUNetToolGUI::OnPreviewRequested()
       ShowErrorMessage(errorMsg.str());
       WriteErrorMessage(QString::fromStdString(errorMsg.str()));
       m_Controls.previewButton->setEnabled(true);
+      m_Controls.stopButton->setEnabled(false);
       tool->PredictOff();
       return;
     }
@@ -239,6 +260,7 @@ void QmitknnUNetToolGUI::OnPreviewRequested()
       std::string errorMsg = "Unkown error occured while generation nnUNet segmentation.";
       ShowErrorMessage(errorMsg);
       m_Controls.previewButton->setEnabled(true);
+      m_Controls.stopButton->setEnabled(false);
       tool->PredictOff();
       return;
     }
@@ -450,6 +472,17 @@ void QmitknnUNetToolGUI::OnClearCachePressed()
   UpdateCacheCountOnUI();
 }
 
+void QmitknnUNetToolGUI::OnStopPressed()
+{
+  mitk::nnUNetTool::Pointer tool = this->GetConnectedToolAs<mitk::nnUNetTool>();
+  if (nullptr != tool)
+  {
+    m_PredictionCancelled = true;
+    m_Controls.stopButton->setEnabled(false);
+    tool->CancelPrediction();
+  }
+}
+
 void QmitknnUNetToolGUI::UpdateCacheCountOnUI()
 {
   QString cacheText = m_CACHE_COUNT_BASE_LABEL + QString::number(m_Cache.size());
@@ -127,6 +127,12 @@ protected slots:
    */
   void OnClearCachePressed();
 
+  /**
+   * @brief Qt slot
+   *
+   */
+  void OnStopPressed();
+
 protected:
   QmitknnUNetToolGUI();
   ~QmitknnUNetToolGUI() = default;
@@ -290,6 +296,11 @@ private:
 
   const QString m_CACHE_COUNT_BASE_LABEL = "Cached Items: ";
 
+  /**
+   * @brief Set by the stop button, so a missing output is not reported as failure.
+   */
+  bool m_PredictionCancelled = false;
+
   /**
    * @brief For storing values across sessions. Currently, RESULTS_FOLDER value is cached using this.
    */
@@ -261,6 +261,10 @@ void QmitknnUNetToolGUI::OnCheckBoxChanged(int state)
         m_Modalities.pop_back();
       }
     }
+    else if (box->objectName() == QString("useWorkerBox"))
+    {
+      m_Controls.stopButton->setVisible(visibility);
+    }
   }
 }
 
@@ -26,6 +26,8 @@ found in the LICENSE file.
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 
+#include <itkTimeProbe.h>
+
 /**
  *  @brief Test for the class "ToFDistanceImageToSurfaceFilter".
  */
@@ -375,6 +377,70 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  //Persistent buffers have to result in the same surface with one point per pixel
+  filter->SetTriangulationThreshold(300.0);
+  filter->Modified();
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> compactMesh = vtkSmartPointer<vtkPolyData>::New();
+  compactMesh->DeepCopy(filter->GetOutput()->GetVtkPolyData());
+  vtkSmartPointer<vtkIdList> compactVertexIds = vtkSmartPointer<vtkIdList>::New();
+  compactVertexIds->DeepCopy(filter->GetVertexIdList());
+
+  filter->UsePersistentBuffersOn();
+  filter->Modified();
+  filter->Update();
+  vtkPolyData* persistentMesh = filter->GetOutput()->GetVtkPolyData();
+  MITK_TEST_CONDITION_REQUIRED(persistentMesh->GetNumberOfPoints() == static_cast<vtkIdType>(dimX*dimY),"Testing number of points with persistent buffers");
+  MITK_TEST_CONDITION_REQUIRED(persistentMesh->GetNumberOfPolys() == compactMesh->GetNumberOfPolys(),"Testing number of polys with persistent buffers");
+  MITK_TEST_CONDITION_REQUIRED(persistentMesh->GetNumberOfVerts() == compactMesh->GetNumberOfVerts(),"Testing number of vertices with persistent buffers");
+  bool persistentPointsEqual = true;
+  for (unsigned int pixelID = 0; pixelID < dimX*dimY; ++pixelID)
+  {
+    if (compactVertexIds->GetId(pixelID) == 0 && pixelID != 0)
+    {
+      continue; // invalid pixels are mapped to point 0 in the compact mesh
+    }
+    double* expected = compactMesh->GetPoint(compactVertexIds->GetId(pixelID));
+    double* res = persistentMesh->GetPoint(filter->GetVertexIdList()->GetId(pixelID));
+    if (!mitk::Equal(expected[0],res[0]) || !mitk::Equal(expected[1],res[1]) || !mitk::Equal(expected[2],res[2]))
+    {
+      persistentPointsEqual = false;
+    }
+  }
+  MITK_TEST_CONDITION_REQUIRED(persistentPointsEqual,"Testing points with persistent buffers");
+
+  //A second frame has to update the existing mesh in place
+  mitk::Image::Pointer secondFrame = mitk::ImageGenerator::GenerateRandomImage<float>(dimX,dimY);
+  filter->SetInput(secondFrame);
+  filter->Update();
+  MITK_TEST_CONDITION_REQUIRED(filter->GetOutput()->GetVtkPolyData() == persistentMesh,"Testing reuse of persistent mesh");
+
+  //Benchmark: frames per second against resolution
+  const unsigned int numberOfFrames = 10;
+  const unsigned int resolutions[3][2] = { { 176, 144 }, { 320, 240 }, { 640, 480 } };
+  for (const auto& resolution : resolutions)
+  {
+    mitk::Image::Pointer frame = mitk::ImageGenerator::GenerateRandomImage<float>(resolution[0],resolution[1]);
+    for (bool usePersistentBuffers : { false, true })
+    {
+      mitk::ToFDistanceImageToSurfaceFilter::Pointer benchmarkFilter = mitk::ToFDistanceImageToSurfaceFilter::New();
+      benchmarkFilter->SetCameraIntrinsics(cameraIntrinsics);
+      benchmarkFilter->SetUsePersistentBuffers(usePersistentBuffers);
+      benchmarkFilter->SetInput(frame);
+      itk::TimeProbe timeProbe;
+      for (unsigned int i = 0; i < numberOfFrames; ++i)
+      {
+        frame->Modified();
+        timeProbe.Start();
+        benchmarkFilter->Update();
+        timeProbe.Stop();
+      }
+      MITK_INFO << "Resolution " << resolution[0] << "x" << resolution[1]
+                << (usePersistentBuffers ? " (persistent buffers): " : ": ")
+                << numberOfFrames / timeProbe.GetTotal() << " fps";
+    }
+  }
+
   //clean up
   delete[] point;
   //  expectedResult->Delete();
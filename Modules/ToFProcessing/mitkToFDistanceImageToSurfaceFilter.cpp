@@ -26,11 +26,15 @@ found in the LICENSE file.
 #include <vtkIdList.h>
 
 #include <cmath>
+#include <memory>
 #include <vtkMath.h>
 
+#include <itkMultiThreaderBase.h>
+
 mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_IplScalarImage(nullptr), m_CameraIntrinsics(), m_TextureImageWidth(0), m_TextureImageHeight(0), m_InterPixelDistance(), m_TextureIndex(0),
-  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0)
+  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0), m_UsePersistentBuffers(false), m_PersistentMesh(nullptr),
+  m_BufferXDimension(0), m_BufferYDimension(0)
 {
   m_InterPixelDistance.Fill(0.045);
   m_CameraIntrinsics = mitk::CameraIntrinsics::New();
@@ -95,30 +99,29 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   int xDimension = input->GetDimension(0);
   int yDimension = input->GetDimension(1);
   unsigned int size = xDimension*yDimension; //size of the image-array
-  std::vector<bool> isPointValid;
-  isPointValid.resize(size);
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  points->SetDataTypeToDouble();
-  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
-  vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
-  textureCoords->SetNumberOfComponents(2);
-  textureCoords->Allocate(size);
 
-  //Make a vtkIdList to save the ID's of the polyData corresponding to the image
-  //pixel ID's. See below for more documentation.
-  m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
-  //Allocate the object once else it would automatically allocate new memory
-  //for every vertex and perform a copy which is expensive.
-  m_VertexIdList->Allocate(size);
-  m_VertexIdList->SetNumberOfIds(size);
-  for(unsigned int i = 0; i < size; ++i)
+  if ((m_ReconstructionMode != WithOutInterPixelDistance) && (m_ReconstructionMode != WithInterPixelDistance) && (m_ReconstructionMode != Kinect))
   {
-    m_VertexIdList->SetId(i, 0);
+    MITK_ERROR << "Incorrect reconstruction mode!";
+    return;
+  }
+
+  //The per-frame buffers are only reallocated if the resolution changes.
+  const bool resolutionChanged = (xDimension != m_BufferXDimension) || (yDimension != m_BufferYDimension);
+  if (resolutionChanged)
+  {
+    m_CartesianCoordinates.resize(3 * size);
+    m_IsPointValid.resize(size);
+    m_RowPointOffsets.resize(yDimension);
+    m_RowPolys.resize(yDimension);
+    m_RowVertices.resize(yDimension);
+    m_BufferXDimension = xDimension;
+    m_BufferYDimension = yDimension;
+    m_PersistentMesh = nullptr;
   }
 
   float* scalarFloatData = nullptr;
+  std::unique_ptr<ImageReadAccessor> scalarAcc;
 
   if (this->m_IplScalarImage) // if scalar image is defined use it for texturing
   {
@@ -126,8 +129,8 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   }
   else if (this->GetInput(m_TextureIndex)) // otherwise use intensity image (input(2))
   {
-    ImageReadAccessor inputAcc(this->GetInput(m_TextureIndex));
-    scalarFloatData = (float*)inputAcc.GetData();
+    scalarAcc = std::make_unique<ImageReadAccessor>(this->GetInput(m_TextureIndex));
+    scalarFloatData = (float*)scalarAcc->GetData();
   }
 
   ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
@@ -141,19 +144,13 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
     focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
     focalLengthInMm = 0.0;
   }
-  else if( m_ReconstructionMode == WithInterPixelDistance)
+  else
   {
     //convert focallength from pixel to mm
     focalLengthInPixelUnits[0] = 0.0;
     focalLengthInPixelUnits[1] = 0.0;
     focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
   }
-  else
-  {
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = 0.0;
-  }
 
   mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
   principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
@@ -162,8 +159,10 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   mitk::Point3D origin = input->GetGeometry()->GetOrigin();
   mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
 
-  for (int j=0; j<yDimension; j++)
+  //1st pass (parallel over image rows): back-project all pixels and count the valid ones per row.
+  auto backProjectRow = [&](itk::SizeValueType j)
   {
+    vtkIdType numberOfValidPointsInRow = 0;
     for (int i=0; i<xDimension; i++)
     {
       unsigned int pixelID = i+j*xDimension;
@@ -180,133 +179,284 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
       switch (m_ReconstructionMode)
       {
       case WithOutInterPixelDistance:
-      {
         cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
         break;
-      }
       case WithInterPixelDistance:
-      {
         cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
         break;
-      }
-      case Kinect:
-      {
+      default: // Kinect, other modes are rejected above
         cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
         break;
       }
-      default:
+      double* coordinates = &m_CartesianCoordinates[3*pixelID];
+      coordinates[0] = cartesianCoordinates[0];
+      coordinates[1] = cartesianCoordinates[1];
+      coordinates[2] = cartesianCoordinates[2];
+
+      //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
+      const bool isValid = distance > mitk::eps;
+      m_IsPointValid[pixelID] = isValid;
+      if (isValid)
+      {
+        ++numberOfValidPointsInRow;
+      }
+    }
+    m_RowPointOffsets[j] = numberOfValidPointsInRow;
+  };
+  this->GetMultiThreader()->ParallelizeArray(0, yDimension, backProjectRow, nullptr);
+
+  //VTK would insert empty points into the polydata if we use
+  //points->InsertPoint(pixelID, ...). Thus, only the valid points are
+  //stored and the ID's do not correspond to the image pixel ID's anymore.
+  //We have to save the mapping in the vertexIdList. The first point ID
+  //of each row is the number of valid points in all previous rows.
+  //With persistent buffers, every pixel has a point and the mapping is the identity.
+  vtkIdType numberOfPoints = 0;
+  for (int j=0; j<yDimension; j++)
+  {
+    const vtkIdType numberOfValidPointsInRow = m_RowPointOffsets[j];
+    m_RowPointOffsets[j] = m_UsePersistentBuffers ? j*xDimension : numberOfPoints;
+    numberOfPoints += m_UsePersistentBuffers ? xDimension : numberOfValidPointsInRow;
+  }
+
+  vtkSmartPointer<vtkPolyData> mesh;
+  bool writeTextureCoordinates = true;
+  if (m_UsePersistentBuffers)
+  {
+    if (m_PersistentMesh == nullptr)
+    {
+      this->InitializePersistentMesh(xDimension, yDimension);
+    }
+    else
+    {
+      //Texture coordinates only depend on the resolution, they are computed once.
+      writeTextureCoordinates = false;
+    }
+    mesh = m_PersistentMesh;
+
+    //Pass the scalars to the polydata (if they were set).
+    if (scalarFloatData == nullptr)
+    {
+      mesh->GetPointData()->SetScalars(nullptr);
+    }
+    else if (mesh->GetPointData()->GetScalars() == nullptr)
+    {
+      vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
+      scalarArray->SetNumberOfTuples(size);
+      mesh->GetPointData()->SetScalars(scalarArray);
+    }
+  }
+  else
+  {
+    m_PersistentMesh = nullptr;
+    mesh = vtkSmartPointer<vtkPolyData>::New();
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToDouble();
+    points->SetNumberOfPoints(numberOfPoints);
+    mesh->SetPoints(points);
+    mesh->SetPolys(vtkSmartPointer<vtkCellArray>::New());
+    mesh->SetVerts(vtkSmartPointer<vtkCellArray>::New());
+
+    //Pass the TextureCoords to the polydata anyway (to save them).
+    vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
+    textureCoords->SetNumberOfComponents(2);
+    textureCoords->SetNumberOfTuples(numberOfPoints);
+    mesh->GetPointData()->SetTCoords(textureCoords);
+
+    //Pass the scalars to the polydata (if they were set).
+    if (scalarFloatData)
+    {
+      vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
+      scalarArray->SetNumberOfTuples(numberOfPoints);
+      mesh->GetPointData()->SetScalars(scalarArray);
+    }
+
+    //Make a vtkIdList to save the ID's of the polyData corresponding to the image
+    //pixel ID's. This list is handed out and hence not reused across frames.
+    m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
+    m_VertexIdList->SetNumberOfIds(size);
+  }
+
+  double* pointData = static_cast<double*>(mesh->GetPoints()->GetVoidPointer(0));
+  float* textureCoordData = vtkFloatArray::SafeDownCast(mesh->GetPointData()->GetTCoords())->GetPointer(0);
+  float* scalarData = scalarFloatData ? vtkFloatArray::SafeDownCast(mesh->GetPointData()->GetScalars())->GetPointer(0) : nullptr;
+  vtkIdType* vertexIds = m_VertexIdList->GetPointer(0);
+
+  //2nd pass (parallel over image rows): write points, scalars and texture coordinates.
+  auto writePointDataOfRow = [&](itk::SizeValueType j)
+  {
+    vtkIdType pointID = m_RowPointOffsets[j];
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      if (!m_IsPointValid[pixelID] && !m_UsePersistentBuffers)
+      {
+        vertexIds[pixelID] = 0;
+        continue;
+      }
+      vertexIds[pixelID] = pointID;
+
+      const double* coordinates = &m_CartesianCoordinates[3*pixelID];
+      pointData[3*pointID] = coordinates[0];
+      pointData[3*pointID+1] = coordinates[1];
+      pointData[3*pointID+2] = coordinates[2];
+
+      //Scalar values are necessary for mapping colors/texture onto the surface
+      if (scalarData)
       {
-        MITK_ERROR << "Incorrect reconstruction mode!";
+        scalarData[pointID] = scalarFloatData[pixelID];
       }
+      //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
+      if (writeTextureCoordinates)
+      {
+        textureCoordData[2*pointID] = ((float)i)/xDimension; // correct video texture scale for kinect
+        textureCoordData[2*pointID+1] = ((float)j)/yDimension; //don't flip. we don't need to flip.
       }
-      //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
-      if (distance<=mitk::eps)
+      ++pointID;
+    }
+  };
+  this->GetMultiThreader()->ParallelizeArray(0, yDimension, writePointDataOfRow, nullptr);
+
+  //3rd pass (parallel over image rows): triangulate. Each row collects its own cells,
+  //they are concatenated in row order afterwards to keep the cell order deterministic.
+  auto triangulateRow = [&](itk::SizeValueType j)
+  {
+    std::vector<vtkIdType>& rowPolys = m_RowPolys[j];
+    std::vector<vtkIdType>& rowVertices = m_RowVertices[j];
+    rowPolys.clear();
+    rowVertices.clear();
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      if (!m_IsPointValid[pixelID])
+      {
+        continue;
+      }
+      if (!m_GenerateTriangularMesh)
       {
-        isPointValid[pixelID] = false;
+        //We dont want triangulation, we only want vertices
+        rowVertices.push_back(vertexIds[pixelID]);
+        continue;
       }
-      else
+      if((i >= 1) && (j >= 1))
       {
-        isPointValid[pixelID] = true;
-        //VTK would insert empty points into the polydata if we use
-        //points->InsertPoint(pixelID, cartesianCoordinates.GetDataPointer()).
-        //If we use points->InsertNextPoint(...) instead, the ID's do not
-        //correspond to the image pixel ID's. Thus, we have to save them
-        //in the vertexIdList.
-        m_VertexIdList->SetId(pixelID, points->InsertNextPoint(cartesianCoordinates.GetDataPointer()));
-
-        if (m_GenerateTriangularMesh)
+        //This little piece of art explains the ID's:
+        //
+        // P(x_1y_1)---P(xy_1)
+        // |           |
+        // |           |
+        // |           |
+        // P(x_1y)-----P(xy)
+        //
+        //We can only start triangulation if we are at vertex (1,1),
+        //because we need the other 3 vertices near this one.
+        //To go one pixel line back in the image array, we have to
+        //subtract 1x xDimension.
+        vtkIdType xy = pixelID;
+        vtkIdType x_1y = pixelID-1;
+        vtkIdType xy_1 = pixelID-xDimension;
+        vtkIdType x_1y_1 = xy_1-1;
+
+        if (m_IsPointValid[x_1y]&&m_IsPointValid[x_1y_1]&&m_IsPointValid[xy_1]) // check if points of cell are valid
         {
-          if((i >= 1) && (j >= 1))
+          const double* pointXY = &m_CartesianCoordinates[3*xy];
+          const double* pointX_1Y = &m_CartesianCoordinates[3*x_1y];
+          const double* pointXY_1 = &m_CartesianCoordinates[3*xy_1];
+          const double* pointX_1Y_1 = &m_CartesianCoordinates[3*x_1y_1];
+
+          //Find the corresponding vertex ID's in the saved vertexIdList:
+          vtkIdType xyV = vertexIds[xy];
+          vtkIdType x_1yV = vertexIds[x_1y];
+          vtkIdType xy_1V = vertexIds[xy_1];
+          vtkIdType x_1y_1V = vertexIds[x_1y_1];
+
+          if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
+                                                               && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
+                                                               && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
+                                                               && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
           {
-            //This little piece of art explains the ID's:
-            //
-            // P(x_1y_1)---P(xy_1)
-            // |           |
-            // |           |
-            // |           |
-            // P(x_1y)-----P(xy)
-            //
-            //We can only start triangulation if we are at vertex (1,1),
-            //because we need the other 3 vertices near this one.
-            //To go one pixel line back in the image array, we have to
-            //subtract 1x xDimension.
-            vtkIdType xy = pixelID;
-            vtkIdType x_1y = pixelID-1;
-            vtkIdType xy_1 = pixelID-xDimension;
-            vtkIdType x_1y_1 = xy_1-1;
-
-            //Find the corresponding vertex ID's in the saved vertexIdList:
-            vtkIdType xyV = m_VertexIdList->GetId(xy);
-            vtkIdType x_1yV = m_VertexIdList->GetId(x_1y);
-            vtkIdType xy_1V = m_VertexIdList->GetId(xy_1);
-            vtkIdType x_1y_1V = m_VertexIdList->GetId(x_1y_1);
-
-            if (isPointValid[xy]&&isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
-            {
-              double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
-
-              points->GetPoint(xyV, pointXY);
-              points->GetPoint(x_1yV, pointX_1Y);
-              points->GetPoint(xy_1V, pointXY_1);
-              points->GetPoint(x_1y_1V, pointX_1Y_1);
-
-              if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
-              {
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1yV);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(x_1y_1V);
-
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1y_1V);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(xy_1V);
-              }
-              else
-              {
-                //We dont want triangulation, but we want to keep the vertex
-                vertices->InsertNextCell(1);
-                vertices->InsertCellPoint(xyV);
-              }
-            }
+            rowPolys.insert(rowPolys.end(), { x_1yV, xyV, x_1y_1V, x_1y_1V, xyV, xy_1V });
+          }
+          else
+          {
+            //We dont want triangulation, but we want to keep the vertex
+            rowVertices.push_back(xyV);
           }
         }
-        else
-        {
-          //We dont want triangulation, we only want vertices
-          vertices->InsertNextCell(1);
-          vertices->InsertCellPoint(m_VertexIdList->GetId(pixelID));
-        }
-        //Scalar values are necessary for mapping colors/texture onto the surface
-        if (scalarFloatData)
-        {
-          scalarArray->InsertTuple1(m_VertexIdList->GetId(pixelID), scalarFloatData[pixelID]);
-        }
-        //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
-        float xNorm = (((float)i)/xDimension);// correct video texture scale for kinect
-        float yNorm = ((float)j)/yDimension; //don't flip. we don't need to flip.
-        textureCoords->InsertTuple2(m_VertexIdList->GetId(pixelID), xNorm, yNorm);
       }
     }
+  };
+  this->GetMultiThreader()->ParallelizeArray(0, yDimension, triangulateRow, nullptr);
+
+  vtkIdType numberOfPolys = 0;
+  vtkIdType numberOfVertices = 0;
+  for (int j=0; j<yDimension; j++)
+  {
+    numberOfPolys += m_RowPolys[j].size() / 3;
+    numberOfVertices += m_RowVertices[j].size();
+  }
+
+  vtkCellArray* polys = mesh->GetPolys();
+  vtkCellArray* vertices = mesh->GetVerts();
+  //AllocateExact does not reallocate if the cell arrays are already large enough.
+  polys->AllocateExact(numberOfPolys, 3 * numberOfPolys);
+  vertices->AllocateExact(numberOfVertices, numberOfVertices);
+  for (int j=0; j<yDimension; j++)
+  {
+    const std::vector<vtkIdType>& rowPolys = m_RowPolys[j];
+    for (std::size_t k=0; k<rowPolys.size(); k+=3)
+    {
+      polys->InsertNextCell(3, &rowPolys[k]);
+    }
+    for (vtkIdType vertexID : m_RowVertices[j])
+    {
+      vertices->InsertNextCell(1, &vertexID);
+    }
   }
 
-  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-  mesh->SetPoints(points);
-  mesh->SetPolys(polys);
-  mesh->SetVerts(vertices);
-  //Pass the scalars to the polydata (if they were set).
-  if (scalarArray->GetNumberOfTuples()>0)
+  if (m_UsePersistentBuffers)
   {
-    mesh->GetPointData()->SetScalars(scalarArray);
+    if (scalarData)
+    {
+      mesh->GetPointData()->GetScalars()->Modified();
+    }
+    mesh->GetPoints()->Modified();
+    mesh->Modified();
+    if (output->GetVtkPolyData() == mesh.GetPointer())
+    {
+      //Same polydata as in the last frame, SetVtkPolyData() would be a no-op.
+      output->CalculateBoundingBox();
+      output->Modified();
+      return;
+    }
   }
-  //Pass the TextureCoords to the polydata anyway (to save them).
-  mesh->GetPointData()->SetTCoords(textureCoords);
   output->SetVtkPolyData(mesh);
 }
 
+void mitk::ToFDistanceImageToSurfaceFilter::InitializePersistentMesh(int xDimension, int yDimension)
+{
+  const vtkIdType size = xDimension*yDimension;
+
+  m_PersistentMesh = vtkSmartPointer<vtkPolyData>::New();
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(size);
+  m_PersistentMesh->SetPoints(points);
+
+  vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
+  textureCoords->SetNumberOfComponents(2);
+  textureCoords->SetNumberOfTuples(size);
+  m_PersistentMesh->GetPointData()->SetTCoords(textureCoords);
+
+  m_PersistentMesh->SetPolys(vtkSmartPointer<vtkCellArray>::New());
+  m_PersistentMesh->SetVerts(vtkSmartPointer<vtkCellArray>::New());
+
+  m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
+  m_VertexIdList->SetNumberOfIds(size);
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
 {
   this->SetNumberOfIndexedOutputs(this->GetNumberOfInputs());  // create outputs for all inputs
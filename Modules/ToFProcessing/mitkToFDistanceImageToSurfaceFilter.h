@@ -23,6 +23,9 @@ found in the LICENSE file.
 
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
+#include <vtkPolyData.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -75,6 +78,20 @@ namespace mitk
     itkSetMacro(GenerateTriangularMesh,bool);
     itkGetMacro(GenerateTriangularMesh,bool);
 
+    /**
+     * @brief SetUsePersistentBuffers If enabled, the output vtkPolyData and its
+     * point, scalar and texture coordinate arrays are allocated only once and
+     * updated in place for each new frame as long as the input resolution does
+     * not change. This avoids all per-frame allocations for streaming ToF data.
+     * @note In this mode every pixel has a point (point ID == pixel ID), invalid
+     * pixels are simply not referenced by any cell. Hence, the vertex ID list is
+     * the identity and the number of points equals the number of pixels.
+     * Default is false, which creates a new compact polydata for every update.
+     */
+    itkSetMacro(UsePersistentBuffers,bool);
+    itkGetMacro(UsePersistentBuffers,bool);
+    itkBooleanMacro(UsePersistentBuffers);
+
 
     /**
      * @brief The ReconstructionModeType enum: Defines the reconstruction mode, if using no interpixeldistances and focal lenghts in pixel units  or interpixeldistances and focal length in mm. The Kinect option defines a special reconstruction mode for the kinect.
@@ -168,6 +185,11 @@ namespace mitk
     */
     void CreateOutputsForAllInputs();
 
+    /*!
+    \brief (Re)allocates the persistent output mesh for the given image resolution
+    */
+    void InitializePersistentMesh(int xDimension, int yDimension);
+
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
     mitk::CameraIntrinsics::Pointer m_CameraIntrinsics; ///< Specifies the intrinsic parameters
@@ -185,6 +207,17 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    bool m_UsePersistentBuffers; ///< Reuse the output mesh and its arrays across frames, see SetUsePersistentBuffers()
+    vtkSmartPointer<vtkPolyData> m_PersistentMesh; ///< Output mesh reused across frames if m_UsePersistentBuffers is enabled
+    int m_BufferXDimension; ///< Image width the per-frame buffers are currently allocated for
+    int m_BufferYDimension; ///< Image height the per-frame buffers are currently allocated for
+
+    std::vector<double> m_CartesianCoordinates; ///< Back-projected coordinates of all pixels (3 values per pixel)
+    std::vector<unsigned char> m_IsPointValid; ///< Validity flag of each pixel (distance > eps)
+    std::vector<vtkIdType> m_RowPointOffsets; ///< Number of valid points per image row, turned into the first point ID of each row
+    std::vector<std::vector<vtkIdType>> m_RowPolys; ///< Triangle point IDs generated per image row
+    std::vector<std::vector<vtkIdType>> m_RowVertices; ///< Vertex point IDs generated per image row
+
   };
 } //END mitk namespace
 #endif
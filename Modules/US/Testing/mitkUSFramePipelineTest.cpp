@@ -0,0 +1,141 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkUSFramePipeline.h"
+#include "mitkUSImageSource.h"
+#include "mitkAbstractOpenCVImageFilter.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkProperties.h"
+#include "mitkTestingMacros.h"
+
+#include <opencv2/core.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+namespace
+{
+  /**
+  * Image source delivering gray value images filled with the frame number. The
+  * images are converted by m_OpenCVToMitkFilter on the grab thread and converted
+  * back by the default GetNextRawImage(std::vector<cv::Mat>&).
+  */
+  class TestImageSource : public mitk::USImageSource
+  {
+  public:
+    mitkClassMacro(TestImageSource, mitk::USImageSource);
+    itkFactorylessNewMacro(Self);
+
+  protected:
+    void GetNextRawImage(std::vector<mitk::Image::Pointer>& images) override
+    {
+      cv::Mat cvImage(64, 64, CV_8UC1, cv::Scalar(m_FrameNumber++ % 256));
+      m_OpenCVToMitkFilter->SetOpenCVMat(cvImage);
+      m_OpenCVToMitkFilter->Update();
+      images.resize(1);
+      images[0] = m_OpenCVToMitkFilter->GetOutput();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    unsigned int m_FrameNumber = 0;
+  };
+
+  /**
+  * Filter which is much slower than the image source. It crops the images, so
+  * images converted on the grab thread are distinguishable from filtered ones.
+  */
+  class SlowOpenCVImageFilter : public mitk::AbstractOpenCVImageFilter
+  {
+  public:
+    mitkClassMacro(SlowOpenCVImageFilter, mitk::AbstractOpenCVImageFilter);
+    itkFactorylessNewMacro(Self);
+
+    bool OnFilterImage(cv::Mat& image) override
+    {
+      image = image(cv::Rect(0, 0, 32, 16)).clone();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      return true;
+    }
+  };
+}
+
+/**
+* This function is testing the pipelined acquisition of ultrasound images.
+*/
+int mitkUSFramePipelineTest(int /* argc */, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkUSFramePipelineTest");
+
+  TestImageSource::Pointer imageSource = TestImageSource::New();
+  imageSource->PushFilter(SlowOpenCVImageFilter::New().GetPointer());
+
+  mitk::USFramePipeline::Pointer pipeline = mitk::USFramePipeline::New();
+  pipeline->SetNumberOfFrameBuffers(2);
+  MITK_TEST_CONDITION_REQUIRED(pipeline->GetNumberOfFrameBuffers() == 4, "Number of frame buffers is at least four");
+
+  const unsigned int numberOfGrabbedFrames = 200;
+  std::atomic<unsigned int> grabCount(0);
+  auto grabCondition = [&grabCount]() { return grabCount++ < numberOfGrabbedFrames; };
+
+  std::vector<int> publishedIds;
+  std::set<mitk::Image*> publishedImages;
+  bool contentMatchesId = true;
+  bool allImagesFiltered = true;
+  auto publishFunction = [&](const std::vector<mitk::Image::Pointer>& images)
+  {
+    allImagesFiltered = allImagesFiltered && images[0]->GetDimension(0) == 32 && images[0]->GetDimension(1) == 16;
+
+    auto idProperty = dynamic_cast<mitk::IntProperty*>(images[0]->GetProperty(mitk::USImageSource::IMAGE_PROPERTY_IDENTIFIER).GetPointer());
+    publishedIds.push_back(idProperty != nullptr ? idProperty->GetValue() : -1);
+    publishedImages.insert(images[0].GetPointer());
+
+    mitk::ImageReadAccessor readAccess(images[0]);
+    const unsigned char* data = static_cast<const unsigned char*>(readAccess.GetData());
+    contentMatchesId = contentMatchesId && data[0] == publishedIds.back() % 256;
+  };
+
+  pipeline->Start(imageSource.GetPointer(), grabCondition, publishFunction);
+  MITK_TEST_CONDITION_REQUIRED(pipeline->GetIsRunning(), "Pipeline is running after start");
+  MITK_TEST_FOR_EXCEPTION(mitk::Exception, pipeline->Start(imageSource.GetPointer(), grabCondition, publishFunction));
+
+  // the pipeline ends itself when the grab condition fails
+  while (!pipeline->GetIsStopRequested())
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  pipeline->Stop();
+  MITK_TEST_CONDITION_REQUIRED(!pipeline->GetIsRunning(), "Pipeline is not running after stop");
+
+  std::vector<mitk::USFramePipeline::StageStatistics> statistics = pipeline->GetStageStatistics();
+  MITK_TEST_CONDITION_REQUIRED(statistics.size() == 4, "Statistics for grab, filter, publish and end-to-end");
+  MITK_TEST_CONDITION(statistics[0].ProcessedFrames == numberOfGrabbedFrames, "All frames were grabbed");
+  MITK_TEST_CONDITION(statistics[1].DroppedFrames > 0, "Slow filter leads to dropped frames instead of stalling acquisition");
+  MITK_TEST_CONDITION(statistics[2].ProcessedFrames == publishedIds.size(), "Publish statistics match published frames");
+  MITK_TEST_CONDITION(statistics[3].MeanLatency >= statistics[1].MeanLatency, "End-to-end latency includes the filter latency");
+
+  bool idsIncreasing = !publishedIds.empty();
+  for (size_t i = 1; i < publishedIds.size(); ++i)
+  {
+    idsIncreasing = idsIncreasing && publishedIds[i - 1] < publishedIds[i];
+  }
+  MITK_TEST_CONDITION(idsIncreasing, "Frames are published in acquisition order");
+  MITK_TEST_CONDITION(contentMatchesId, "Published images contain the data of their frame");
+  MITK_TEST_CONDITION(allImagesFiltered, "Conversions on the grab thread do not interfere with the filtered images");
+  MITK_TEST_CONDITION(publishedImages.size() <= pipeline->GetNumberOfFrameBuffers(), "Images of the frame buffers are reused");
+
+  pipeline->ResetStatistics();
+  MITK_TEST_CONDITION(pipeline->GetStageStatistics()[0].ProcessedFrames == 0, "Statistics can be reset");
+
+  MITK_TEST_END();
+}
@@ -12,12 +12,16 @@ found in the LICENSE file.
 
 #include "mitkUSImageSource.h"
 #include "mitkProperties.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <opencv2/imgproc.hpp>
 
 const char* mitk::USImageSource::IMAGE_PROPERTY_IDENTIFIER = "id_nummer";
 
 mitk::USImageSource::USImageSource()
   : m_OpenCVToMitkFilter(mitk::OpenCVToMitkImageFilter::New()),
   m_MitkToOpenCVFilter(nullptr),
+  m_ProcessFrameOpenCVToMitkFilter(mitk::OpenCVToMitkImageFilter::New()),
   m_ImageFilter(mitk::BasicCombinationOpenCVImageFilter::New()),
   m_CurrentImageId(0)
 {
@@ -76,21 +80,101 @@ std::vector<mitk::Image::Pointer> mitk::USImageSource::GetNextImage()
     this->GetNextRawImage(result);
   }
 
-  for (size_t i = 0; i < result.size(); ++i)
+  this->FinalizeImages(result, m_CurrentImageId);
+  m_CurrentImageId++;
+
+  return result;
+}
+
+void mitk::USImageSource::GrabFrame(Frame& frame)
+{
+  frame.Id = m_CurrentImageId++;
+  frame.NeedsFiltering = m_ImageFilter.IsNotNull() && !m_ImageFilter->GetIsEmpty();
+
+  if (frame.NeedsFiltering)
+  {
+    this->GetNextRawImage(frame.RawImages);
+  }
+  else
   {
-    if (result[i].IsNotNull())
+    this->GetNextRawImage(frame.Images);
+    this->FinalizeImages(frame.Images, frame.Id);
+  }
+}
+
+void mitk::USImageSource::ProcessFrame(Frame& frame)
+{
+  if (!frame.NeedsFiltering)
+  {
+    return;
+  }
+
+  frame.Images.resize(frame.RawImages.size());
+  frame.ImageTypes.resize(frame.RawImages.size(), -1);
+
+  for (size_t i = 0; i < frame.RawImages.size(); ++i)
+  {
+    if (frame.RawImages[i].empty())
     {
-      result[i]->SetProperty(IMAGE_PROPERTY_IDENTIFIER, mitk::IntProperty::New(m_CurrentImageId));
+      frame.Images[i] = nullptr;
+      continue;
+    }
+
+    m_ImageFilterMutex.lock();
+    m_ImageFilter->FilterImage(frame.RawImages[i], frame.Id);
+    m_ImageFilterMutex.unlock();
+
+    this->ConvertToMitkImage(frame.RawImages[i], frame.ImageTypes[i], frame.Images[i]);
+  }
+
+  this->FinalizeImages(frame.Images, frame.Id);
+}
+
+void mitk::USImageSource::ConvertToMitkImage(const cv::Mat& cvImage, int& lastType, mitk::Image::Pointer& image)
+{
+  if (image.IsNotNull() && image->IsInitialized() && lastType == cvImage.type() &&
+      image->GetDimension(0) == static_cast<unsigned int>(cvImage.cols) &&
+      image->GetDimension(1) == static_cast<unsigned int>(cvImage.rows))
+  {
+    // write directly into the buffer of the image, the conversion matches
+    // the one of mitk::OpenCVToMitkImageFilter (BGR is converted to RGB)
+    mitk::ImageWriteAccessor writeAccess(image);
+    cv::Mat target(cvImage.rows, cvImage.cols, cvImage.type(), writeAccess.GetData());
+    if (cvImage.channels() == 3)
+    {
+      cv::cvtColor(cvImage, target, cv::COLOR_BGR2RGB);
     }
     else
     {
-      //MITK_WARN("mitkUSImageSource") << "Result image " << i << " is not set.";
-      result[i] = mitk::Image::New();
+      cvImage.copyTo(target);
     }
+    image->Modified();
+    return;
   }
-  m_CurrentImageId++;
 
-  return result;
+  // convert to MITK image, GrabFrame() may use m_OpenCVToMitkFilter at the same time
+  this->m_ProcessFrameOpenCVToMitkFilter->SetOpenCVMat(cvImage);
+  this->m_ProcessFrameOpenCVToMitkFilter->Update();
+
+  // OpenCVToMitkImageFilter returns a standard mitk::image.
+  image = this->m_ProcessFrameOpenCVToMitkFilter->GetOutput();
+  lastType = cvImage.type();
+}
+
+void mitk::USImageSource::FinalizeImages(std::vector<mitk::Image::Pointer>& images, int id)
+{
+  for (size_t i = 0; i < images.size(); ++i)
+  {
+    if (images[i].IsNotNull())
+    {
+      images[i]->SetProperty(IMAGE_PROPERTY_IDENTIFIER, mitk::IntProperty::New(id));
+    }
+    else
+    {
+      //MITK_WARN("mitkUSImageSource") << "Result image " << i << " is not set.";
+      images[i] = mitk::Image::New();
+    }
+  }
 }
 
 void mitk::USImageSource::GetNextRawImage(std::vector<cv::Mat>& imageVector)
@@ -104,6 +188,7 @@ void mitk::USImageSource::GetNextRawImage(std::vector<cv::Mat>& imageVector)
   // get mitk image through virtual method of the subclass
   std::vector<mitk::Image::Pointer> mitkImg;
   this->GetNextRawImage(mitkImg);
+  imageVector.resize(mitkImg.size());
 
   for (unsigned int i = 0; i < mitkImg.size(); ++i)
   {
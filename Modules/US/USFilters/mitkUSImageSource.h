@@ -42,6 +42,20 @@ namespace mitk {
 
     mitkClassMacroItkParent(USImageSource, itk::Object);
 
+    /**
+    * \brief Buffers of one frame passing through the stages of a
+    * mitk::USFramePipeline. The buffers are kept across frames, so that
+    * images of unchanged size and type are overwritten in place.
+    */
+    struct Frame
+    {
+      std::vector<cv::Mat> RawImages;           ///< unfiltered OpenCV images, only used if NeedsFiltering is true
+      std::vector<int> ImageTypes;              ///< OpenCV types the images were converted from, used to decide if they can be reused
+      std::vector<mitk::Image::Pointer> Images; ///< resulting (filtered) images
+      bool NeedsFiltering = false;              ///< true if the raw images have to be filtered and converted by ProcessFrame()
+      int Id = 0;                               ///< id of the frame, which is also set as image property
+    };
+
     itkGetMacro(ImageFilter, mitk::BasicCombinationOpenCVImageFilter::Pointer);
 
     void PushFilter(AbstractOpenCVImageFilter::Pointer filter);
@@ -57,6 +71,21 @@ namespace mitk {
     */
     std::vector<mitk::Image::Pointer> GetNextImage();
 
+    /**
+    * \brief First half of GetNextImage(): retrieves the next frame without
+    * filtering it. If no filter is set, the frame is complete afterwards.
+    */
+    void GrabFrame(Frame& frame);
+
+    /**
+    * \brief Second half of GetNextImage(): applies the filter set by
+    * PushFilter() to a frame retrieved by GrabFrame() and converts it to MITK
+    * images. Images of the frame are reused if size and type did not change.
+    * It may be called on another thread while GrabFrame() retrieves the next
+    * frame, both use their own conversion filters.
+    */
+    void ProcessFrame(Frame& frame);
+
   protected:
     USImageSource();
     ~USImageSource() override;
@@ -87,6 +116,24 @@ namespace mitk {
 
   private:
     /**
+    * \brief Converts the OpenCV image into the given MITK image, which is
+    * overwritten in place if it was converted from an image of the same size
+    * and type before.
+    */
+    void ConvertToMitkImage(const cv::Mat& cvImage, int& lastType, mitk::Image::Pointer& image);
+
+    /**
+    * \brief Sets the frame id property on all images and replaces missing images.
+    */
+    void FinalizeImages(std::vector<mitk::Image::Pointer>& images, int id);
+
+    /**
+    * \brief Used by ProcessFrame() instead of m_OpenCVToMitkFilter, which
+    * subclasses use in GetNextRawImage() on the grab thread of a mitk::USFramePipeline.
+    */
+    mitk::OpenCVToMitkImageFilter::Pointer m_ProcessFrameOpenCVToMitkFilter;
+
+    /**
 * \brief Filter is executed during mitk::USImageVideoSource::GetNextImage().
 */
     BasicCombinationOpenCVImageFilter::Pointer m_ImageFilter;
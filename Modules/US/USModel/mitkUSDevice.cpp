@@ -59,8 +59,11 @@ mitk::USDevice::USDevice(std::string manufacturer, std::string model)
   m_Name(model),
   m_Comment(),
   m_SpawnAcquireThread(true),
+  m_UsePipelinedAcquisition(false),
   m_UnregisteringStarted(false)
 {
+  m_FramePipeline = mitk::USFramePipeline::New();
+
   USImageCropArea empty;
   empty.cropBottom = 0;
   empty.cropTop = 0;
@@ -89,8 +92,11 @@ mitk::USDevice::USDevice(mitk::USImageMetadata::Pointer metadata)
   m_ServiceProperties(),
   m_ServiceRegistration(),
   m_SpawnAcquireThread(true),
+  m_UsePipelinedAcquisition(false),
   m_UnregisteringStarted(false)
 {
+  m_FramePipeline = mitk::USFramePipeline::New();
+
   m_Manufacturer = metadata->GetDeviceManufacturer();
   m_Name = metadata->GetDeviceModel();
   m_Comment = metadata->GetDeviceComment();
@@ -115,6 +121,8 @@ mitk::USDevice::~USDevice()
   if (m_Thread.joinable())
     m_Thread.detach();
 
+  this->StopFramePipeline();
+
   // make sure that the us device is not registered at the micro service
   // anymore after it is destructed
   this->UnregisterOnService();
@@ -319,7 +327,14 @@ bool mitk::USDevice::Activate()
     // spawn thread for aquire images if us device is active
     if (m_SpawnAcquireThread)
     {
-      m_Thread = std::thread(&USDevice::Acquire, this);
+      if (m_UsePipelinedAcquisition)
+      {
+        this->StartFramePipeline();
+      }
+      else
+      {
+        m_Thread = std::thread(&USDevice::Acquire, this);
+      }
     }
 
     this->UpdateServiceProperty(
@@ -390,6 +405,8 @@ void mitk::USDevice::Deactivate()
   DisableOIGTL();
   m_DeviceState = State_Connected;
 
+  this->StopFramePipeline();
+
   this->UpdateServiceProperty(
     mitk::USDevice::GetPropertyKeys().US_PROPKEY_ISACTIVE, false);
   this->UpdateServiceProperty(
@@ -666,6 +683,41 @@ void mitk::USDevice::Acquire()
   }
 }
 
+void mitk::USDevice::StartFramePipeline()
+{
+  auto grabCondition = [this]()
+  {
+    // lock the grab stage when ultrasound device is freezed
+    std::unique_lock<std::mutex> lock(m_FreezeMutex);
+    m_FreezeBarrier.wait(lock, [this] { return !m_IsFreezed || !this->GetIsActive() || m_FramePipeline->GetIsStopRequested(); });
+    return this->GetIsActive() && !m_FramePipeline->GetIsStopRequested();
+  };
+
+  auto publishFunction = [this](const std::vector<mitk::Image::Pointer>& images)
+  {
+    std::lock_guard<std::mutex> lock(m_ImageMutex);
+    this->SetImageVector(images);
+  };
+
+  m_FramePipeline->Start(this->GetUSImageSource(), grabCondition, publishFunction);
+}
+
+void mitk::USDevice::StopFramePipeline()
+{
+  if (m_FramePipeline.IsNull() || !m_FramePipeline->GetIsRunning())
+    return;
+
+  {
+    // request the stop while holding the freeze mutex, so that a grab stage
+    // which waits for unfreezing cannot miss the notification
+    std::lock_guard<std::mutex> lock(m_FreezeMutex);
+    m_FramePipeline->RequestStop();
+  }
+  m_FreezeBarrier.notify_all();
+
+  m_FramePipeline->Stop();
+}
+
 void mitk::USDevice::ConnectThread()
 {
   this->Connect();
@@ -23,6 +23,7 @@ found in the LICENSE file.
 #include "mitkUSProbe.h"
 #include <MitkUSExports.h>
 #include "mitkUSImageSource.h"
+#include "mitkUSFramePipeline.h"
 
 // MitkIGTL
 #include "mitkIGTLMessageProvider.h"
@@ -81,6 +82,22 @@ namespace mitk {
     itkSetMacro(SpawnAcquireThread, bool);
     itkGetMacro(SpawnAcquireThread, bool);
 
+    /**
+    * \brief If enabled, images are acquired by a mitk::USFramePipeline
+    * instead of a single acquisition thread. Grabbing, filtering and
+    * publishing of the frames then run on separate threads with reusable
+    * frame buffers, so that slow filters do not stall the acquisition.
+    * Takes effect on the next call of Activate(). Default is false.
+    */
+    itkSetMacro(UsePipelinedAcquisition, bool);
+    itkGetMacro(UsePipelinedAcquisition, bool);
+
+    /**
+    * \return the frame pipeline used for pipelined acquisition, e.g. for
+    * querying latencies and dropped frames
+    */
+    itkGetMacro(FramePipeline, mitk::USFramePipeline::Pointer);
+
     struct USImageCropArea
     {
       int cropLeft;
@@ -384,6 +401,19 @@ namespace mitk {
     void Acquire();
     void ConnectThread();
 
+    /**
+    * \brief Starts the frame pipeline which replaces Acquire() if pipelined
+    * acquisition is enabled.
+    */
+    void StartFramePipeline();
+
+    /**
+    * \brief Stops the frame pipeline, also if it waits for the device being unfreezed.
+    */
+    void StopFramePipeline();
+
+    mitk::USFramePipeline::Pointer m_FramePipeline;
+
     std::vector<mitk::Image::Pointer> m_ImageVector;
 
     // Variables to determine if spacing was calibrated and needs to be applied to the incoming images
@@ -522,6 +552,8 @@ namespace mitk {
 
     bool m_SpawnAcquireThread;
 
+    bool m_UsePipelinedAcquisition;
+
     bool m_UnregisteringStarted;
   };
 } // namespace mitk
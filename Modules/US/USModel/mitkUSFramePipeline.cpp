@@ -0,0 +1,295 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkUSFramePipeline.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+
+namespace
+{
+  const unsigned int MinimumNumberOfFrameBuffers = 4;
+}
+
+mitk::USFramePipeline::USFramePipeline()
+  : m_NumberOfFrameBuffers(MinimumNumberOfFrameBuffers),
+  m_PublishedFrame(nullptr),
+  m_IsRunning(false),
+  m_StopRequested(false)
+{
+  this->ResetStatistics();
+}
+
+mitk::USFramePipeline::~USFramePipeline()
+{
+  this->Stop();
+}
+
+void mitk::USFramePipeline::SetNumberOfFrameBuffers(unsigned int numberOfFrameBuffers)
+{
+  numberOfFrameBuffers = std::max(numberOfFrameBuffers, MinimumNumberOfFrameBuffers);
+  if (m_NumberOfFrameBuffers != numberOfFrameBuffers)
+  {
+    m_NumberOfFrameBuffers = numberOfFrameBuffers;
+    this->Modified();
+  }
+}
+
+void mitk::USFramePipeline::Start(USImageSource::Pointer imageSource, GrabConditionType grabCondition, PublishFunctionType publishFunction)
+{
+  if (imageSource.IsNull())
+  {
+    mitkThrow() << "Cannot start frame pipeline without an image source.";
+  }
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if (m_IsRunning)
+  {
+    mitkThrow() << "Frame pipeline is already running.";
+  }
+
+  m_ImageSource = imageSource;
+  m_GrabCondition = grabCondition;
+  m_PublishFunction = publishFunction;
+
+  // the frame buffers are kept across restarts to reuse their images
+  while (m_FrameBuffers.size() < m_NumberOfFrameBuffers)
+  {
+    m_FrameBuffers.push_back(std::make_unique<PipelineFrame>());
+  }
+
+  m_FreeFrames.clear();
+  for (auto& frame : m_FrameBuffers)
+  {
+    m_FreeFrames.push_back(frame.get());
+  }
+  m_FilterQueue.clear();
+  m_PublishQueue.clear();
+  m_PublishedFrame = nullptr;
+
+  m_StopRequested = false;
+  m_IsRunning = true;
+
+  m_GrabThread = std::thread(&USFramePipeline::GrabLoop, this);
+  m_FilterThread = std::thread(&USFramePipeline::FilterLoop, this);
+  m_PublishThread = std::thread(&USFramePipeline::PublishLoop, this);
+}
+
+void mitk::USFramePipeline::RequestStop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_StopRequested = true;
+  }
+
+  m_FreeFrameCondition.notify_all();
+  m_FilterCondition.notify_all();
+  m_PublishCondition.notify_all();
+}
+
+void mitk::USFramePipeline::Stop()
+{
+  this->RequestStop();
+
+  if (m_GrabThread.joinable())
+    m_GrabThread.join();
+  if (m_FilterThread.joinable())
+    m_FilterThread.join();
+  if (m_PublishThread.joinable())
+    m_PublishThread.join();
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_IsRunning = false;
+  m_ImageSource = nullptr;
+}
+
+bool mitk::USFramePipeline::GetIsRunning() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_IsRunning;
+}
+
+bool mitk::USFramePipeline::GetIsStopRequested() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_StopRequested;
+}
+
+std::vector<mitk::USFramePipeline::StageStatistics> mitk::USFramePipeline::GetStageStatistics() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  std::vector<StageStatistics> statistics(m_Statistics, m_Statistics + NumberOfStages);
+  for (unsigned int stage = 0; stage < NumberOfStages; ++stage)
+  {
+    if (statistics[stage].ProcessedFrames > 0)
+    {
+      statistics[stage].MeanLatency = m_TotalLatency[stage] / statistics[stage].ProcessedFrames;
+    }
+  }
+  return statistics;
+}
+
+void mitk::USFramePipeline::ResetStatistics()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  const char* names[NumberOfStages] = { "grab", "filter", "publish", "end-to-end" };
+  for (unsigned int stage = 0; stage < NumberOfStages; ++stage)
+  {
+    m_Statistics[stage] = StageStatistics();
+    m_Statistics[stage].Name = names[stage];
+    m_TotalLatency[stage] = 0.0;
+  }
+}
+
+void mitk::USFramePipeline::AddLatency(Stage stage, ClockType::time_point start, ClockType::time_point end)
+{
+  const double latency = std::chrono::duration<double, std::milli>(end - start).count();
+  StageStatistics& statistics = m_Statistics[stage];
+  ++statistics.ProcessedFrames;
+  statistics.MaxLatency = std::max(statistics.MaxLatency, latency);
+  m_TotalLatency[stage] += latency;
+}
+
+mitk::USFramePipeline::PipelineFrame* mitk::USFramePipeline::AcquireFrameBuffer(std::unique_lock<std::mutex>& lock)
+{
+  while (!m_StopRequested)
+  {
+    if (!m_FreeFrames.empty())
+    {
+      PipelineFrame* frame = m_FreeFrames.back();
+      m_FreeFrames.pop_back();
+      return frame;
+    }
+
+    // drop the oldest frame which was not processed yet
+    if (!m_FilterQueue.empty())
+    {
+      PipelineFrame* frame = m_FilterQueue.front();
+      m_FilterQueue.pop_front();
+      ++m_Statistics[Stage_Filter].DroppedFrames;
+      return frame;
+    }
+
+    if (!m_PublishQueue.empty())
+    {
+      PipelineFrame* frame = m_PublishQueue.front();
+      m_PublishQueue.pop_front();
+      ++m_Statistics[Stage_Publish].DroppedFrames;
+      return frame;
+    }
+
+    // all buffers are currently in use by the other stages
+    m_FreeFrameCondition.wait(lock);
+  }
+
+  return nullptr;
+}
+
+void mitk::USFramePipeline::GrabLoop()
+{
+  while (true)
+  {
+    if (!m_GrabCondition())
+      break;
+
+    PipelineFrame* frame;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      frame = this->AcquireFrameBuffer(lock);
+    }
+    if (frame == nullptr)
+      break;
+
+    frame->GrabTime = ClockType::now();
+    m_ImageSource->GrabFrame(frame->Data);
+    const ClockType::time_point end = ClockType::now();
+
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      this->AddLatency(Stage_Grab, frame->GrabTime, end);
+      if (m_StopRequested)
+      {
+        m_FreeFrames.push_back(frame);
+        break;
+      }
+      m_FilterQueue.push_back(frame);
+    }
+    m_FilterCondition.notify_one();
+  }
+
+  // make sure the other stages end, too
+  this->RequestStop();
+}
+
+void mitk::USFramePipeline::FilterLoop()
+{
+  while (true)
+  {
+    PipelineFrame* frame;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_FilterCondition.wait(lock, [this] { return m_StopRequested || !m_FilterQueue.empty(); });
+      if (m_StopRequested)
+        break;
+
+      frame = m_FilterQueue.front();
+      m_FilterQueue.pop_front();
+    }
+
+    const ClockType::time_point start = ClockType::now();
+    m_ImageSource->ProcessFrame(frame->Data);
+    const ClockType::time_point end = ClockType::now();
+
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      this->AddLatency(Stage_Filter, start, end);
+      m_PublishQueue.push_back(frame);
+    }
+    m_PublishCondition.notify_one();
+  }
+}
+
+void mitk::USFramePipeline::PublishLoop()
+{
+  while (true)
+  {
+    PipelineFrame* frame;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_PublishCondition.wait(lock, [this] { return m_StopRequested || !m_PublishQueue.empty(); });
+      if (m_StopRequested)
+        break;
+
+      frame = m_PublishQueue.front();
+      m_PublishQueue.pop_front();
+    }
+
+    const ClockType::time_point start = ClockType::now();
+    m_PublishFunction(frame->Data.Images);
+    const ClockType::time_point end = ClockType::now();
+
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      this->AddLatency(Stage_Publish, start, end);
+      this->AddLatency(Stage_EndToEnd, frame->GrabTime, end);
+
+      // the previously published frame is not referenced anymore and can be reused
+      if (m_PublishedFrame != nullptr)
+      {
+        m_FreeFrames.push_back(m_PublishedFrame);
+      }
+      m_PublishedFrame = frame;
+    }
+    m_FreeFrameCondition.notify_one();
+  }
+}
@@ -0,0 +1,184 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKUSFramePipeline_H_HEADER_INCLUDED_
+#define MITKUSFramePipeline_H_HEADER_INCLUDED_
+
+// STL
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// MitkUS
+#include <MitkUSExports.h>
+#include "mitkUSImageSource.h"
+
+// MITK
+#include <mitkCommon.h>
+
+// ITK
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+namespace mitk {
+  /**
+  * \brief Pipelined image acquisition for mitk::USDevice.
+  *
+  * Frames are grabbed, filtered and published by three threads which are
+  * connected by bounded queues. The frames are taken from a fixed pool of
+  * reusable frame buffers (see mitk::USImageSource::Frame), so that no new
+  * images have to be allocated as long as size and type of the images do not
+  * change.
+  *
+  * The grab stage never waits for the later stages: if no frame buffer is
+  * free, the oldest frame which was not published yet is dropped and its
+  * buffer is reused. Hence, a slow filter reduces the rate of published
+  * frames, but does not stall the acquisition. The number of dropped frames
+  * and the time spent in each stage are available via GetStageStatistics().
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USFramePipeline : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(USFramePipeline, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /**
+    * \brief Is called by the grab stage before each frame. May block
+    * (e.g. while the device is freezed) and returns false if the acquisition
+    * should end.
+    */
+    typedef std::function<bool()> GrabConditionType;
+
+    /**
+    * \brief Is called by the publish stage for each frame in acquisition
+    * order. The images stay valid until the next frame was published.
+    */
+    typedef std::function<void(const std::vector<mitk::Image::Pointer>&)> PublishFunctionType;
+
+    /**
+    * \brief Timing and drop counters of one stage. Latencies are given in
+    * milliseconds. The "end-to-end" entry measures the time from the start
+    * of grabbing a frame until it was published.
+    */
+    struct StageStatistics
+    {
+      std::string Name;
+      unsigned long ProcessedFrames = 0;
+      unsigned long DroppedFrames = 0; ///< frames which were dropped while waiting for this stage
+      double MeanLatency = 0.0;
+      double MaxLatency = 0.0;
+    };
+
+    /**
+    * \brief Sets the number of frame buffers in the pool. At least four
+    * buffers are used: one per stage and one for the published frame.
+    * Changes take effect on the next call of Start().
+    */
+    void SetNumberOfFrameBuffers(unsigned int numberOfFrameBuffers);
+    itkGetConstMacro(NumberOfFrameBuffers, unsigned int);
+
+    /**
+    * \brief Starts the grab, filter and publish threads.
+    * \throw mitk::Exception if the pipeline is already running or no image source is given
+    */
+    void Start(USImageSource::Pointer imageSource, GrabConditionType grabCondition, PublishFunctionType publishFunction);
+
+    /**
+    * \brief Tells all stages to finish without waiting for them. Can be
+    * used to wake up a blocking GrabConditionType before calling Stop().
+    */
+    void RequestStop();
+
+    /**
+    * \brief Stops all stages and waits for the threads to finish. Frames
+    * which were not published yet are discarded.
+    */
+    void Stop();
+
+    bool GetIsRunning() const;
+    bool GetIsStopRequested() const;
+
+    /**
+    * \return statistics of the grab, filter and publish stage and the end-to-end statistics
+    */
+    std::vector<StageStatistics> GetStageStatistics() const;
+    void ResetStatistics();
+
+  protected:
+    USFramePipeline();
+    ~USFramePipeline() override;
+
+  private:
+    typedef std::chrono::steady_clock ClockType;
+
+    struct PipelineFrame
+    {
+      USImageSource::Frame Data;
+      ClockType::time_point GrabTime;
+    };
+
+    enum Stage { Stage_Grab = 0, Stage_Filter, Stage_Publish, Stage_EndToEnd, NumberOfStages };
+
+    void GrabLoop();
+    void FilterLoop();
+    void PublishLoop();
+
+    /**
+    * \brief Returns a free frame buffer or, if there is none, drops the
+    * oldest frame which was not published yet. Returns nullptr on stop.
+    * Has to be called with m_Mutex locked.
+    */
+    PipelineFrame* AcquireFrameBuffer(std::unique_lock<std::mutex>& lock);
+
+    /**
+    * \brief Has to be called with m_Mutex locked.
+    */
+    void AddLatency(Stage stage, ClockType::time_point start, ClockType::time_point end);
+
+    unsigned int m_NumberOfFrameBuffers;
+
+    USImageSource::Pointer m_ImageSource;
+    GrabConditionType m_GrabCondition;
+    PublishFunctionType m_PublishFunction;
+
+    std::vector<std::unique_ptr<PipelineFrame>> m_FrameBuffers;
+    std::vector<PipelineFrame*> m_FreeFrames;
+    std::deque<PipelineFrame*> m_FilterQueue;
+    std::deque<PipelineFrame*> m_PublishQueue;
+    PipelineFrame* m_PublishedFrame;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_FreeFrameCondition;
+    std::condition_variable m_FilterCondition;
+    std::condition_variable m_PublishCondition;
+
+    bool m_IsRunning;
+    bool m_StopRequested;
+
+    std::thread m_GrabThread;
+    std::thread m_FilterThread;
+    std::thread m_PublishThread;
+
+    StageStatistics m_Statistics[NumberOfStages];
+    double m_TotalLatency[NumberOfStages];
+  };
+} // namespace mitk
+
+#endif // MITKUSFramePipeline_H_HEADER_INCLUDED_
@@ -7,6 +7,7 @@ mitkUSActivator.cpp
 USModel/mitkUSImage.cpp
 USModel/mitkUSImageMetadata.cpp
 USModel/mitkUSDevice.cpp
+USModel/mitkUSFramePipeline.cpp
 USModel/mitkUSIGTLDevice.cpp
 USModel/mitkUSVideoDevice.cpp
 USModel/mitkUSVideoDeviceCustomControls.cpp